@@ -1,5 +1,7 @@
 #define _GNU_SOURCE
 #include "drm_display.h"
+#include "startup_cache.h"
+#include "logger.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,6 +10,8 @@
 #include <errno.h>
 #include <sys/mman.h>
 #include <sys/select.h>
+#include <poll.h>
+#include <time.h>
 #include <stdint.h>
 
 // Forward declarations
@@ -21,68 +25,86 @@ static const char *drm_device_paths[] = {
 };
 
 static int find_drm_device(void) {
+    // OPTIMIZATION: Try the device that worked last boot before probing the list.
+    // card0/card1 numbering depends on driver probe order, so it is re-validated.
+    char cached[256];
+    if (startup_cache_get_drm_device(cached, sizeof(cached))) {
+        int fd = open(cached, O_RDWR | O_CLOEXEC);
+        if (fd >= 0) {
+            drmModeRes *resources = drmModeGetResources(fd);
+            if (resources) {
+                LOG_INFO("✓ Using cached DRM device: %s\n", cached);
+                drmModeFreeResources(resources);
+                return fd;
+            }
+            close(fd);
+        }
+        LOG_INFO("[CACHE] Cached DRM device %s no longer usable, probing\n", cached);
+    }
+
     for (int i = 0; drm_device_paths[i]; i++) {
         int fd = open(drm_device_paths[i], O_RDWR | O_CLOEXEC);
         if (fd < 0) {
-            printf("⊗ %s: Cannot open (%s)\n", drm_device_paths[i], strerror(errno));
+            LOG_INFO("⊗ %s: Cannot open (%s)\n", drm_device_paths[i], strerror(errno));
             continue;
         }
         
-        printf("✓ %s: Opened successfully, checking resources...\n", drm_device_paths[i]);
+        LOG_INFO("✓ %s: Opened successfully, checking resources...\n", drm_device_paths[i]);
         
         // Test if this device actually works (has display resources)
         drmModeRes *resources = drmModeGetResources(fd);
         if (resources) {
-            printf("✓ Found working DRM device: %s\n", drm_device_paths[i]);
-            printf("  - Connectors: %d\n", resources->count_connectors);
-            printf("  - Encoders: %d\n", resources->count_encoders);
-            printf("  - CRTCs: %d\n", resources->count_crtcs);
+            LOG_INFO("✓ Found working DRM device: %s\n", drm_device_paths[i]);
+            LOG_INFO("  - Connectors: %d\n", resources->count_connectors);
+            LOG_INFO("  - Encoders: %d\n", resources->count_encoders);
+            LOG_INFO("  - CRTCs: %d\n", resources->count_crtcs);
             drmModeFreeResources(resources);
+            startup_cache_put_drm_device(drm_device_paths[i]);
             return fd;
         }
         
         // This device didn't work, get more details
-        printf("⊗ %s opened but drmModeGetResources failed\n", drm_device_paths[i]);
+        LOG_WARN("⊗ %s opened but drmModeGetResources failed\n", drm_device_paths[i]);
         
         // Try to get driver info
         drmVersion *version = drmGetVersion(fd);
         if (version) {
-            printf("  Driver: %s (version %d.%d.%d)\n", 
-                   version->name, version->version_major, 
-                   version->version_minor, version->version_patchlevel);
+            LOG_INFO("  Driver: %s (version %d.%d.%d)\n", 
+                     version->name, version->version_major, 
+                     version->version_minor, version->version_patchlevel);
             drmFreeVersion(version);
         }
         
         // Check capabilities
         uint64_t cap_dumb = 0;
         drmGetCap(fd, DRM_CAP_DUMB_BUFFER, &cap_dumb);
-        printf("  DRM_CAP_DUMB_BUFFER: %s\n", cap_dumb ? "yes" : "no");
+        LOG_INFO("  DRM_CAP_DUMB_BUFFER: %s\n", cap_dumb ? "yes" : "no");
         
         uint64_t cap_prime = 0;
         drmGetCap(fd, DRM_CAP_PRIME, &cap_prime);
-        printf("  DRM_CAP_PRIME: %s\n", cap_prime ? "yes" : "no");
+        LOG_INFO("  DRM_CAP_PRIME: %s\n", cap_prime ? "yes" : "no");
         
         close(fd);
     }
     
-    printf("\nTroubleshooting:\n");
-    printf("1. Make sure you're in the 'render' group: groups | grep render\n");
-    printf("2. If not, run: sudo usermod -a -G render $USER && logout\n");
-    printf("3. Or try with sudo: sudo ./pickel <video>\n");
-    printf("\nDevice details (try manually):\n");
-    printf("  modetest -c\n");
-    printf("  lspci | grep VGA\n");
-    printf("  dmesg | grep -i drm\n");
+    LOG_ERROR("\nTroubleshooting:\n");
+    LOG_ERROR("1. Make sure you're in the 'render' group: groups | grep render\n");
+    LOG_ERROR("2. If not, run: sudo usermod -a -G render $USER && logout\n");
+    LOG_ERROR("3. Or try with sudo: sudo ./pickel <video>\n");
+    LOG_ERROR("\nDevice details (try manually):\n");
+    LOG_ERROR("  modetest -c\n");
+    LOG_ERROR("  lspci | grep VGA\n");
+    LOG_ERROR("  dmesg | grep -i drm\n");
     return -1;
 }
 static drmModeConnector* find_connector(display_ctx_t *drm) {
     drmModeRes *resources = drmModeGetResources(drm->drm_fd);
     if (!resources) {
-        fprintf(stderr, "Failed to get DRM resources\n");
-        fprintf(stderr, "This usually means:\n");
-        fprintf(stderr, "  1. No GPU/display driver loaded\n");
-        fprintf(stderr, "  2. Running in SSH without display\n");
-        fprintf(stderr, "  3. Need to run on the Pi's console directly\n");
+        LOG_ERROR("Failed to get DRM resources\n");
+        LOG_ERROR("This usually means:\n");
+        LOG_ERROR("  1. No GPU/display driver loaded\n");
+        LOG_ERROR("  2. Running in SSH without display\n");
+        LOG_ERROR("  3. Need to run on the Pi's console directly\n");
         return NULL;
     }
 
@@ -112,8 +134,187 @@ static drmModeEncoder* find_encoder(display_ctx_t *drm) {
     return encoder;
 }
 
+// Look up a KMS property ID by name (0 if the object does not expose it)
+static uint32_t drm_find_property(int fd, uint32_t object_id, uint32_t object_type, const char *name) {
+    drmModeObjectPropertiesPtr props = drmModeObjectGetProperties(fd, object_id, object_type);
+    if (!props) {
+        return 0;
+    }
+    
+    uint32_t prop_id = 0;
+    for (uint32_t i = 0; i < props->count_props && prop_id == 0; i++) {
+        drmModePropertyPtr prop = drmModeGetProperty(fd, props->props[i]);
+        if (prop) {
+            if (strcmp(prop->name, name) == 0) {
+                prop_id = prop->prop_id;
+            }
+            drmModeFreeProperty(prop);
+        }
+    }
+    drmModeFreeObjectProperties(props);
+    return prop_id;
+}
+
+// Find the primary plane that scans out our CRTC and cache its properties
+static void drm_find_primary_plane(display_ctx_t *drm) {
+    drmModeResPtr resources = drmModeGetResources(drm->drm_fd);
+    if (!resources) {
+        return;
+    }
+    int crtc_index = -1;
+    for (int i = 0; i < resources->count_crtcs; i++) {
+        if (resources->crtcs[i] == drm->crtc_id) {
+            crtc_index = i;
+            break;
+        }
+    }
+    drmModeFreeResources(resources);
+    if (crtc_index < 0) {
+        return;
+    }
+    
+    drmModePlaneResPtr planes = drmModeGetPlaneResources(drm->drm_fd);
+    if (!planes) {
+        return;
+    }
+    
+    for (uint32_t i = 0; i < planes->count_planes && !drm->primary_plane_id; i++) {
+        drmModePlanePtr plane = drmModeGetPlane(drm->drm_fd, planes->planes[i]);
+        if (!plane) continue;
+        
+        if (plane->possible_crtcs & (1 << crtc_index)) {
+            drmModeObjectPropertiesPtr props = drmModeObjectGetProperties(
+                drm->drm_fd, plane->plane_id, DRM_MODE_OBJECT_PLANE);
+            if (props) {
+                for (uint32_t j = 0; j < props->count_props; j++) {
+                    drmModePropertyPtr prop = drmModeGetProperty(drm->drm_fd, props->props[j]);
+                    if (!prop) continue;
+                    if (strcmp(prop->name, "type") == 0 && props->prop_values[j] == DRM_PLANE_TYPE_PRIMARY) {
+                        drm->primary_plane_id = plane->plane_id;
+                    }
+                    drmModeFreeProperty(prop);
+                }
+                drmModeFreeObjectProperties(props);
+            }
+        }
+        drmModeFreePlane(plane);
+    }
+    drmModeFreePlaneResources(planes);
+    
+    if (!drm->primary_plane_id) {
+        return;
+    }
+    
+    uint32_t id = drm->primary_plane_id;
+    drm->primary_plane_prop_zpos = drm_find_property(drm->drm_fd, id, DRM_MODE_OBJECT_PLANE, "zpos");
+    drm->primary_plane_prop_fb_id = drm_find_property(drm->drm_fd, id, DRM_MODE_OBJECT_PLANE, "FB_ID");
+    drm->primary_plane_prop_crtc_id = drm_find_property(drm->drm_fd, id, DRM_MODE_OBJECT_PLANE, "CRTC_ID");
+    drm->primary_plane_prop_src_x = drm_find_property(drm->drm_fd, id, DRM_MODE_OBJECT_PLANE, "SRC_X");
+    drm->primary_plane_prop_src_y = drm_find_property(drm->drm_fd, id, DRM_MODE_OBJECT_PLANE, "SRC_Y");
+    drm->primary_plane_prop_src_w = drm_find_property(drm->drm_fd, id, DRM_MODE_OBJECT_PLANE, "SRC_W");
+    drm->primary_plane_prop_src_h = drm_find_property(drm->drm_fd, id, DRM_MODE_OBJECT_PLANE, "SRC_H");
+    drm->primary_plane_prop_crtc_x = drm_find_property(drm->drm_fd, id, DRM_MODE_OBJECT_PLANE, "CRTC_X");
+    drm->primary_plane_prop_crtc_y = drm_find_property(drm->drm_fd, id, DRM_MODE_OBJECT_PLANE, "CRTC_Y");
+    drm->primary_plane_prop_crtc_w = drm_find_property(drm->drm_fd, id, DRM_MODE_OBJECT_PLANE, "CRTC_W");
+    drm->primary_plane_prop_crtc_h = drm_find_property(drm->drm_fd, id, DRM_MODE_OBJECT_PLANE, "CRTC_H");
+    drm->primary_plane_prop_in_fence_fd = drm_find_property(drm->drm_fd, id, DRM_MODE_OBJECT_PLANE, "IN_FENCE_FD");
+}
+
+// Enable atomic modesetting when the driver supports it (PICKLE_NO_ATOMIC=1 forces legacy)
+static void drm_init_atomic(display_ctx_t *drm) {
+    drm->atomic_supported = false;
+    
+    const char *no_atomic = getenv("PICKLE_NO_ATOMIC");
+    if (no_atomic && no_atomic[0] == '1') {
+        LOG_INFO("[KMS] PICKLE_NO_ATOMIC=1 -> using legacy page flips\n");
+        return;
+    }
+    
+    if (drmSetClientCap(drm->drm_fd, DRM_CLIENT_CAP_ATOMIC, 1) != 0) {
+        LOG_INFO("[KMS] Atomic modesetting not supported, using legacy page flips\n");
+        return;
+    }
+    
+    if (!drm->primary_plane_id || !drm->primary_plane_prop_fb_id || !drm->primary_plane_prop_crtc_id) {
+        LOG_INFO("[KMS] Primary plane properties missing, using legacy page flips\n");
+        return;
+    }
+    
+    drm->crtc_prop_out_fence_ptr = drm_find_property(drm->drm_fd, drm->crtc_id,
+                                                     DRM_MODE_OBJECT_CRTC, "OUT_FENCE_PTR");
+    drm->atomic_supported = true;
+    LOG_INFO("[KMS] Atomic modesetting enabled (in-fence: %s, out-fence: %s)\n",
+             drm->primary_plane_prop_in_fence_fd ? "yes" : "no",
+             drm->crtc_prop_out_fence_ptr ? "yes" : "no");
+}
+
+// Offscreen rendering: a GBM surface on any node that can render, no connector,
+// CRTC or DRM master. Swaps are retired immediately and counted as flips.
+static int drm_init_headless(display_ctx_t *drm) {
+    static const char *render_paths[] = {
+        "/dev/dri/renderD128", "/dev/dri/card1", "/dev/dri/card0", NULL
+    };
+
+    for (int i = 0; render_paths[i] && drm->drm_fd < 0; i++) {
+        drm->drm_fd = open(render_paths[i], O_RDWR | O_CLOEXEC);
+        if (drm->drm_fd >= 0) {
+            LOG_INFO("[DRM] Headless: rendering on %s\n", render_paths[i]);
+        }
+    }
+    if (drm->drm_fd < 0) {
+        LOG_ERROR("[DRM] Headless: no render node available (%s)\n", strerror(errno));
+        return -1;
+    }
+
+    drm->width = drm->headless_width ? drm->headless_width : 1920;
+    drm->height = drm->headless_height ? drm->headless_height : 1080;
+    drm->refresh_rate = 60;
+    drm->mode.hdisplay = (uint16_t)drm->width;
+    drm->mode.vdisplay = (uint16_t)drm->height;
+    drm->mode.vrefresh = drm->refresh_rate;
+
+    drm->gbm_device = gbm_create_device(drm->drm_fd);
+    if (!drm->gbm_device) {
+        LOG_ERROR("[DRM] Headless: failed to create GBM device\n");
+        close(drm->drm_fd);
+        drm->drm_fd = -1;
+        return -1;
+    }
+
+    drm->gbm_surface = gbm_surface_create(drm->gbm_device, drm->width, drm->height,
+                                          GBM_FORMAT_XRGB8888, GBM_BO_USE_RENDERING);
+    if (!drm->gbm_surface) {
+        LOG_ERROR("[DRM] Headless: failed to create %ux%u GBM surface\n",
+                  drm->width, drm->height);
+        gbm_device_destroy(drm->gbm_device);
+        drm->gbm_device = NULL;
+        close(drm->drm_fd);
+        drm->drm_fd = -1;
+        return -1;
+    }
+
+    drm->mode_set_done = true;
+    return 0;
+}
+
 int drm_init(display_ctx_t *drm) {
+    // Requested by the caller before init
+    bool primary_alpha = drm->primary_alpha;
+    bool headless = drm->headless;
+    uint32_t headless_width = drm->headless_width;
+    uint32_t headless_height = drm->headless_height;
     memset(drm, 0, sizeof(*drm));
+    drm->primary_alpha = primary_alpha;
+    drm->headless = headless;
+    drm->headless_width = headless_width;
+    drm->headless_height = headless_height;
+    drm->drm_fd = -1;
+    drm->in_fence_fd = -1;
+    drm->out_fence_fd = -1;
+
+    if (drm->headless) {
+        return drm_init_headless(drm);
+    }
 
     // Check if we're running under X11 or Wayland (early detection)
     const char *display = getenv("DISPLAY");
@@ -121,52 +322,52 @@ int drm_init(display_ctx_t *drm) {
     
     // Only block if we're clearly under a graphical session
     if ((display && strlen(display) > 0) || (wayland_display && strlen(wayland_display) > 0)) {
-        fprintf(stderr, "\n=== Cannot Initialize DRM ===\n");
-        fprintf(stderr, "Running under a display server (X11/Wayland).\n");
-        fprintf(stderr, "DISPLAY=%s\n", display ? display : "(not set)");
-        fprintf(stderr, "WAYLAND_DISPLAY=%s\n", wayland_display ? wayland_display : "(not set)");
-        fprintf(stderr, "DRM/KMS requires direct console access.\n\n");
-        fprintf(stderr, "Quick fix:\n");
-        fprintf(stderr, "  1. Switch to console: Ctrl+Alt+F1 (or F2-F6)\n");
-        fprintf(stderr, "  2. Login and run: sudo ./pickle <video>\n");
-        fprintf(stderr, "\nPermanent fix:\n");
-        fprintf(stderr, "  sudo systemctl set-default multi-user.target\n");
-        fprintf(stderr, "  sudo reboot\n");
-        fprintf(stderr, "================================\n\n");
+        LOG_ERROR("\n=== Cannot Initialize DRM ===\n");
+        LOG_ERROR("Running under a display server (X11/Wayland).\n");
+        LOG_ERROR("DISPLAY=%s\n", display ? display : "(not set)");
+        LOG_ERROR("WAYLAND_DISPLAY=%s\n", wayland_display ? wayland_display : "(not set)");
+        LOG_ERROR("DRM/KMS requires direct console access.\n\n");
+        LOG_ERROR("Quick fix:\n");
+        LOG_ERROR("  1. Switch to console: Ctrl+Alt+F1 (or F2-F6)\n");
+        LOG_ERROR("  2. Login and run: sudo ./pickle <video>\n");
+        LOG_ERROR("\nPermanent fix:\n");
+        LOG_ERROR("  sudo systemctl set-default multi-user.target\n");
+        LOG_ERROR("  sudo reboot\n");
+        LOG_ERROR("================================\n\n");
         return -1;
     }
 
     // Open DRM device
     drm->drm_fd = find_drm_device();
     if (drm->drm_fd < 0) {
-        fprintf(stderr, "Failed to open DRM device\n");
-        fprintf(stderr, "Hint: Try running with 'sudo ./pickel <video>' for hardware access\n");
-        fprintf(stderr, "Or make sure you're in the 'video' group: sudo usermod -a -G video $USER\n");
+        LOG_ERROR("Failed to open DRM device\n");
+        LOG_ERROR("Hint: Try running with 'sudo ./pickel <video>' for hardware access\n");
+        LOG_ERROR("Or make sure you're in the 'video' group: sudo usermod -a -G video $USER\n");
         return -1;
     }
 
     // Try to become DRM master
     int master_ret = drmSetMaster(drm->drm_fd);
     if (master_ret != 0) {
-        printf("Warning: Failed to become DRM master: %s\n", strerror(errno));
-        printf("Another process may be controlling the display\n");
+        LOG_WARN("Warning: Failed to become DRM master: %s\n", strerror(errno));
+        LOG_WARN("Another process may be controlling the display\n");
         // Continue anyway - might work with render nodes
     } else {
-        printf("Successfully became DRM master\n");
+        LOG_INFO("Successfully became DRM master\n");
     }
 
     // Find connected display
     drm->connector = find_connector(drm);
     if (!drm->connector) {
-        fprintf(stderr, "No connected display found\n");
-        fprintf(stderr, "\nDebugging information:\n");
-        fprintf(stderr, "- Current TTY: %s\n", ttyname(STDIN_FILENO) ? ttyname(STDIN_FILENO) : "unknown");
-        fprintf(stderr, "- Session type: %s\n", getenv("XDG_SESSION_TYPE") ? getenv("XDG_SESSION_TYPE") : "unknown");
-        fprintf(stderr, "- Running via SSH: %s\n", getenv("SSH_CLIENT") ? "yes" : "no");
-        fprintf(stderr, "\nPossible solutions:\n");
-        fprintf(stderr, "1. Run directly on Pi console (not SSH): sudo ./pickel <video>\n");
-        fprintf(stderr, "2. Stop desktop environment: sudo systemctl stop lightdm\n");
-        fprintf(stderr, "3. Switch to console: Ctrl+Alt+F1, then run with sudo\n");
+        LOG_ERROR("No connected display found\n");
+        LOG_ERROR("\nDebugging information:\n");
+        LOG_ERROR("- Current TTY: %s\n", ttyname(STDIN_FILENO) ? ttyname(STDIN_FILENO) : "unknown");
+        LOG_ERROR("- Session type: %s\n", getenv("XDG_SESSION_TYPE") ? getenv("XDG_SESSION_TYPE") : "unknown");
+        LOG_ERROR("- Running via SSH: %s\n", getenv("SSH_CLIENT") ? "yes" : "no");
+        LOG_ERROR("\nPossible solutions:\n");
+        LOG_ERROR("1. Run directly on Pi console (not SSH): sudo ./pickel <video>\n");
+        LOG_ERROR("2. Stop desktop environment: sudo systemctl stop lightdm\n");
+        LOG_ERROR("3. Switch to console: Ctrl+Alt+F1, then run with sudo\n");
         close(drm->drm_fd);
         drm->drm_fd = -1;
         return -1;
@@ -174,7 +375,7 @@ int drm_init(display_ctx_t *drm) {
 
     // Get display mode
     if (drm->connector->count_modes == 0) {
-        fprintf(stderr, "No display modes available\n");
+        LOG_ERROR("No display modes available\n");
         drmModeFreeConnector(drm->connector);
         drm->connector = NULL;
         close(drm->drm_fd);
@@ -190,7 +391,7 @@ int drm_init(display_ctx_t *drm) {
     // Find encoder
     drm->encoder = find_encoder(drm);
     if (!drm->encoder) {
-        fprintf(stderr, "Failed to find encoder\n");
+        LOG_ERROR("Failed to find encoder\n");
         drmModeFreeConnector(drm->connector);
         drm->connector = NULL;
         close(drm->drm_fd);
@@ -201,7 +402,7 @@ int drm_init(display_ctx_t *drm) {
     // Get CRTC
     drm->crtc = drmModeGetCrtc(drm->drm_fd, drm->encoder->crtc_id);
     if (!drm->crtc) {
-        fprintf(stderr, "Failed to get CRTC\n");
+        LOG_ERROR("Failed to get CRTC\n");
         close(drm->drm_fd);
         drm->drm_fd = -1;
         drm->connector = NULL;
@@ -212,11 +413,11 @@ int drm_init(display_ctx_t *drm) {
     // PRODUCTION: Save original CRTC state for restoration on cleanup
     drm->saved_crtc = drmModeGetCrtc(drm->drm_fd, drm->encoder->crtc_id);
     if (!drm->saved_crtc) {
-        fprintf(stderr, "Warning: Failed to save original CRTC state\n");
+        LOG_WARN("Warning: Failed to save original CRTC state\n");
     }
     
-    printf("Using CRTC %d, Encoder %d, Connector %d\n", 
-           drm->crtc_id, drm->encoder_id, drm->connector_id);
+    LOG_INFO("Using CRTC %d, Encoder %d, Connector %d\n", 
+             drm->crtc_id, drm->encoder_id, drm->connector_id);
     
     // Initialize state
     drm->current_bo = NULL;
@@ -229,7 +430,7 @@ int drm_init(display_ctx_t *drm) {
     // Initialize GBM
     drm->gbm_device = gbm_create_device(drm->drm_fd);
     if (!drm->gbm_device) {
-        fprintf(stderr, "Failed to create GBM device\n");
+        LOG_ERROR("Failed to create GBM device\n");
         drmModeFreeCrtc(drm->crtc);
         drm->crtc = NULL;
         drmModeFreeEncoder(drm->encoder);
@@ -242,12 +443,13 @@ int drm_init(display_ctx_t *drm) {
     }
 
     // Create GBM surface
+    // Overlay scanout composites the primary plane over the video plane, so it needs alpha
     drm->gbm_surface = gbm_surface_create(drm->gbm_device,
                                           drm->width, drm->height,
-                                          GBM_FORMAT_XRGB8888,
+                                          drm->primary_alpha ? GBM_FORMAT_ARGB8888 : GBM_FORMAT_XRGB8888,
                                           GBM_BO_USE_SCANOUT | GBM_BO_USE_RENDERING);
     if (!drm->gbm_surface) {
-        fprintf(stderr, "Failed to create GBM surface\n");
+        LOG_ERROR("Failed to create GBM surface\n");
         gbm_device_destroy(drm->gbm_device);
         drm->gbm_device = NULL;
         drmModeFreeCrtc(drm->crtc);
@@ -261,6 +463,12 @@ int drm_init(display_ctx_t *drm) {
         return -1;
     }
 
+    // Universal planes exposes the primary plane (zpos ordering, atomic commits)
+    if (drmSetClientCap(drm->drm_fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) == 0) {
+        drm_find_primary_plane(drm);
+    }
+    drm_init_atomic(drm);
+
     // DRM initialization complete
     return 0;
 }
@@ -286,10 +494,10 @@ uint32_t drm_get_fb_for_bo(display_ctx_t *drm, struct gbm_bo *bo) {
     uint32_t stride = gbm_bo_get_stride(bo);
     uint32_t handle = gbm_bo_get_handle(bo).u32;
     
-    int ret = drmModeAddFB(drm->drm_fd, width, height, 24, 32,
+    int ret = drmModeAddFB(drm->drm_fd, width, height, drm->primary_alpha ? 32 : 24, 32,
                           stride, handle, &fb_id);
     if (ret) {
-        fprintf(stderr, "Failed to create framebuffer: %s\n", strerror(errno));
+        LOG_ERROR_RATELIMITED("Failed to create framebuffer: %s\n", strerror(errno));
         return 0;
     }
     
@@ -300,9 +508,14 @@ uint32_t drm_get_fb_for_bo(display_ctx_t *drm, struct gbm_bo *bo) {
 
 void drm_page_flip_handler(int fd, unsigned int frame, unsigned int sec, 
                           unsigned int usec, void *data) {
-    (void)fd; (void)frame; (void)sec; (void)usec; // Suppress unused warnings
+    (void)fd; // Suppress unused warning
     display_ctx_t *drm = (display_ctx_t *)data;
     
+    // Record when the flip actually hit the screen for the presentation scheduler
+    drm->last_flip_seq = frame;
+    drm->last_flip_time_us = (uint64_t)sec * 1000000ULL + usec;
+    drm->flip_count++;
+    
     // Page flip completed - now safe to release the previous buffer
     if (drm->current_bo) {
         gbm_surface_release_buffer(drm->gbm_surface, drm->current_bo);
@@ -312,6 +525,12 @@ void drm_page_flip_handler(int fd, unsigned int frame, unsigned int sec,
     drm->current_bo = drm->next_bo;
     drm->current_fb_id = drm->next_fb_id;
     
+    // Atomic: the flip retires the commit, so its out-fence has signalled too
+    if (drm->out_fence_fd >= 0) {
+        close(drm->out_fence_fd);
+        drm->out_fence_fd = -1;
+    }
+    
     drm->waiting_for_flip = false;
 }
 
@@ -325,18 +544,18 @@ int drm_set_mode(display_ctx_t *drm, uint32_t fb_id) {
     if (ret != 0) {
         // Only show detailed error once
         if (!error_shown) {
-            fprintf(stderr, "Failed to set CRTC mode: %s\n", strerror(errno));
+            LOG_ERROR("Failed to set CRTC mode: %s\n", strerror(errno));
             
             // Provide helpful diagnostics
             if (errno == EACCES || errno == EPERM) {
-                fprintf(stderr, "\n=== DRM Permission Error ===\n");
-                fprintf(stderr, "Another process may be using the display (X11, Wayland, etc.)\n");
-                fprintf(stderr, "Solutions:\n");
-                fprintf(stderr, "  1. Stop display manager: sudo systemctl stop lightdm\n");
-                fprintf(stderr, "  2. Run with sudo: sudo ./pickle <video>\n");
-                fprintf(stderr, "  3. Add to groups: sudo usermod -a -G video,render $USER\n");
-                fprintf(stderr, "     (then logout/login)\n");
-                fprintf(stderr, "============================\n\n");
+                LOG_ERROR("\n=== DRM Permission Error ===\n");
+                LOG_ERROR("Another process may be using the display (X11, Wayland, etc.)\n");
+                LOG_ERROR("Solutions:\n");
+                LOG_ERROR("  1. Stop display manager: sudo systemctl stop lightdm\n");
+                LOG_ERROR("  2. Run with sudo: sudo ./pickle <video>\n");
+                LOG_ERROR("  3. Add to groups: sudo usermod -a -G video,render $USER\n");
+                LOG_ERROR("     (then logout/login)\n");
+                LOG_ERROR("============================\n\n");
             }
             error_shown = true;
         }
@@ -371,30 +590,222 @@ static void drm_handle_pending_flips(display_ctx_t *drm) {
     }
 }
 
+// Wait up to timeout_ms in total for the in-flight commit's flip event (atomic path).
+// The event rotates the GBM buffers and arrives at the vblank the out-fence signals,
+// so one bounded wait covers both. False if the flip is still pending: next_bo stays
+// owned by that commit and its late event will still release the right buffer.
+static bool drm_wait_for_flip(display_ctx_t *drm, int timeout_ms) {
+    drmEventContext evctx = {
+        .version = DRM_EVENT_CONTEXT_VERSION,
+        .page_flip_handler = drm_page_flip_handler,
+    };
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    while (drm->waiting_for_flip) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long elapsed_ms = (now.tv_sec - start.tv_sec) * 1000L + (now.tv_nsec - start.tv_nsec) / 1000000L;
+        long remaining_ms = timeout_ms - elapsed_ms;
+        
+        struct pollfd pfd = { .fd = drm->drm_fd, .events = POLLIN };
+        int ret = poll(&pfd, 1, remaining_ms > 0 ? (int)remaining_ms : 0);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return false;
+        }
+        drmHandleEvent(drm->drm_fd, &evctx);
+    }
+    return true;
+}
+
+static void drm_atomic_add_plane(drmModeAtomicReqPtr req, uint32_t plane_id,
+                                 uint32_t prop_fb_id, uint32_t prop_crtc_id,
+                                 const uint32_t rect_props[8], uint32_t crtc_id, uint32_t fb_id,
+                                 uint32_t src_w, uint32_t src_h,
+                                 uint32_t x, uint32_t y, uint32_t w, uint32_t h) {
+    drmModeAtomicAddProperty(req, plane_id, prop_fb_id, fb_id);
+    drmModeAtomicAddProperty(req, plane_id, prop_crtc_id, fb_id ? crtc_id : 0);
+    if (!fb_id) {
+        return;  // Disabling: the kernel ignores the rectangles
+    }
+    
+    // SRC_* are 16.16 fixed point, CRTC_* are integer pixels
+    const uint64_t values[8] = {
+        0, 0, (uint64_t)src_w << 16, (uint64_t)src_h << 16,
+        x, y, w, h
+    };
+    for (int i = 0; i < 8; i++) {
+        if (rect_props[i]) {
+            drmModeAtomicAddProperty(req, plane_id, rect_props[i], values[i]);
+        }
+    }
+}
+
+// Present the GL front buffer plus any staged video plane update in one nonblocking commit
+static int drm_atomic_swap_buffers(display_ctx_t *drm) {
+    // One commit in flight at most; the GL side is already a frame ahead. If the last
+    // one still hasn't flipped, drop this frame: committing would take next_bo from it.
+    if (!drm_wait_for_flip(drm, 50)) {
+        struct gbm_bo *dropped = gbm_surface_lock_front_buffer(drm->gbm_surface);
+        if (dropped) {
+            gbm_surface_release_buffer(drm->gbm_surface, dropped);
+        }
+        if (drm->in_fence_fd >= 0) {
+            close(drm->in_fence_fd);
+            drm->in_fence_fd = -1;
+        }
+        LOG_WARN_RATELIMITED("[KMS] Flip still pending after 50ms, frame dropped\n");
+        return 0;  // A staged video plane update stays pending for the next commit
+    }
+    
+    drm->next_bo = gbm_surface_lock_front_buffer(drm->gbm_surface);
+    if (!drm->next_bo) {
+        LOG_ERROR_RATELIMITED("Failed to lock front buffer\n");
+        return -1;
+    }
+    drm->next_fb_id = drm_get_fb_for_bo(drm, drm->next_bo);
+    if (!drm->next_fb_id) {
+        LOG_ERROR_RATELIMITED("Failed to get framebuffer ID\n");
+        gbm_surface_release_buffer(drm->gbm_surface, drm->next_bo);
+        return -1;
+    }
+    
+    drmModeAtomicReqPtr req = drmModeAtomicAlloc();
+    if (!req) {
+        gbm_surface_release_buffer(drm->gbm_surface, drm->next_bo);
+        return -1;
+    }
+    
+    const uint32_t primary_rect[8] = {
+        drm->primary_plane_prop_src_x, drm->primary_plane_prop_src_y,
+        drm->primary_plane_prop_src_w, drm->primary_plane_prop_src_h,
+        drm->primary_plane_prop_crtc_x, drm->primary_plane_prop_crtc_y,
+        drm->primary_plane_prop_crtc_w, drm->primary_plane_prop_crtc_h
+    };
+    drm_atomic_add_plane(req, drm->primary_plane_id,
+                         drm->primary_plane_prop_fb_id, drm->primary_plane_prop_crtc_id,
+                         primary_rect, drm->crtc_id, drm->next_fb_id,
+                         drm->width, drm->height, 0, 0, drm->width, drm->height);
+    
+    // Scanout waits on the GPU render instead of the CPU waiting in eglSwapBuffers
+    if (drm->in_fence_fd >= 0 && drm->primary_plane_prop_in_fence_fd) {
+        drmModeAtomicAddProperty(req, drm->primary_plane_id,
+                                 drm->primary_plane_prop_in_fence_fd, drm->in_fence_fd);
+    }
+    
+    // Video plane update staged by drm_display_video_frame_scaled()/drm_clear_video_plane()
+    bool video_update = drm->video_plane_available && drm->plane_update.pending;
+    if (video_update) {
+        const uint32_t video_rect[8] = {
+            drm->video_plane_prop_src_x, drm->video_plane_prop_src_y,
+            drm->video_plane_prop_src_w, drm->video_plane_prop_src_h,
+            drm->video_plane_prop_crtc_x, drm->video_plane_prop_crtc_y,
+            drm->video_plane_prop_crtc_w, drm->video_plane_prop_crtc_h
+        };
+        drm_atomic_add_plane(req, drm->video_plane_id,
+                             drm->video_plane_prop_fb_id, drm->video_plane_prop_crtc_id,
+                             video_rect, drm->crtc_id, drm->plane_update.fb_id,
+                             drm->plane_update.src_w, drm->plane_update.src_h,
+                             drm->plane_update.x, drm->plane_update.y,
+                             drm->plane_update.width, drm->plane_update.height);
+    }
+    
+    int32_t out_fence = -1;
+    if (drm->crtc_prop_out_fence_ptr) {
+        drmModeAtomicAddProperty(req, drm->crtc_id, drm->crtc_prop_out_fence_ptr,
+                                 (uint64_t)(uintptr_t)&out_fence);
+    }
+    
+    drm->waiting_for_flip = true;
+    int ret = drmModeAtomicCommit(drm->drm_fd, req,
+                                  DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, drm);
+    drmModeAtomicFree(req);
+    
+    // The kernel holds its own reference to the in-fence once the commit is queued
+    if (drm->in_fence_fd >= 0) {
+        close(drm->in_fence_fd);
+        drm->in_fence_fd = -1;
+    }
+    
+    if (ret != 0) {
+        static int atomic_failures = 0;
+        LOG_ERROR_RATELIMITED("[KMS] Atomic commit failed: %s\n", strerror(errno));
+        drm->waiting_for_flip = false;
+        gbm_surface_release_buffer(drm->gbm_surface, drm->next_bo);
+        drm->next_bo = NULL;
+        if (++atomic_failures >= 3) {
+            LOG_WARN("[KMS] Falling back to legacy page flips\n");
+            drm->atomic_supported = false;
+            // Plane updates no longer ride along with commits: keep them off the render thread
+            if (drm->video_plane_available) {
+                drm_start_plane_worker(drm);
+            }
+        }
+        return -1;
+    }
+    
+    drm->out_fence_fd = out_fence;
+    if (video_update) {
+        drm->prev_video_fb_id = drm->video_fb_id;
+        drm->video_fb_id = drm->plane_update.fb_id;
+        drm->plane_update.pending = false;
+    }
+    return 0;
+}
+
+static int drm_headless_swap_buffers(display_ctx_t *drm) {
+    struct gbm_bo *bo = gbm_surface_lock_front_buffer(drm->gbm_surface);
+    if (!bo) {
+        LOG_ERROR_RATELIMITED("Failed to lock front buffer\n");
+        return -1;
+    }
+    if (drm->current_bo) {
+        gbm_surface_release_buffer(drm->gbm_surface, drm->current_bo);
+    }
+    drm->current_bo = bo;
+
+    // No page flip to wait for: the buffer is "on screen" as soon as it is locked
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    drm->last_flip_seq++;
+    drm->last_flip_time_us = (uint64_t)now.tv_sec * 1000000ULL + (uint64_t)now.tv_nsec / 1000ULL;
+    drm->flip_count++;
+    return 0;
+}
+
 int drm_swap_buffers(display_ctx_t *drm) {
+    if (drm->headless) {
+        return drm_headless_swap_buffers(drm);
+    }
+    if (drm->atomic_supported && drm->mode_set_done) {
+        return drm_atomic_swap_buffers(drm);
+    }
+    
     // Get the front buffer from GBM surface
     drm->next_bo = gbm_surface_lock_front_buffer(drm->gbm_surface);
     if (!drm->next_bo) {
-        fprintf(stderr, "Failed to lock front buffer\n");
+        LOG_ERROR_RATELIMITED("Failed to lock front buffer\n");
         return -1;
     }
     // Get framebuffer ID for the buffer
     drm->next_fb_id = drm_get_fb_for_bo(drm, drm->next_bo);
     if (!drm->next_fb_id) {
-        fprintf(stderr, "Failed to get framebuffer ID\n");
+        LOG_ERROR_RATELIMITED("Failed to get framebuffer ID\n");
         gbm_surface_release_buffer(drm->gbm_surface, drm->next_bo);
         return -1;
     }
     
     // First frame: set the mode
     if (!drm->mode_set_done) {
-        printf("Setting display mode...\n");
+        LOG_INFO("Setting display mode...\n");
         int ret = drm_set_mode(drm, drm->next_fb_id);
         if (ret) {
             // Only print error once, then fail gracefully
             static bool error_printed = false;
             if (!error_printed) {
-                printf("DRM: drm_set_mode failed with code %d\n", ret);
+                LOG_ERROR("DRM: drm_set_mode failed with code %d\n", ret);
                 error_printed = true;
             }
             gbm_surface_release_buffer(drm->gbm_surface, drm->next_bo);
@@ -402,7 +813,7 @@ int drm_swap_buffers(display_ctx_t *drm) {
         }
         drm->current_bo = drm->next_bo;
         drm->current_fb_id = drm->next_fb_id;
-        printf("Display initialized. Video should appear now.\n");
+        LOG_INFO("Display initialized. Video should appear now.\n");
         return 0;
     }
     
@@ -420,7 +831,7 @@ int drm_swap_buffers(display_ctx_t *drm) {
     int ret = drmModePageFlip(drm->drm_fd, drm->crtc_id, drm->next_fb_id,
                              DRM_MODE_PAGE_FLIP_EVENT, drm);
     if (ret) {
-        fprintf(stderr, "Failed to queue page flip: %s\n", strerror(errno));
+        LOG_ERROR_RATELIMITED("Failed to queue page flip: %s\n", strerror(errno));
         drm->waiting_for_flip = false;
         gbm_surface_release_buffer(drm->gbm_surface, drm->next_bo);
         // PRODUCTION: Clean up framebuffer on error to prevent resource leak
@@ -448,12 +859,21 @@ void drm_cleanup(display_ctx_t *drm) {
                                  1, 
                                  &drm->saved_crtc->mode);
         if (ret < 0) {
-            fprintf(stderr, "Warning: Failed to restore CRTC state: %d\n", ret);
+            LOG_WARN("Warning: Failed to restore CRTC state: %d\n", ret);
         }
         drmModeFreeCrtc(drm->saved_crtc);
         drm->saved_crtc = NULL;
     }
     
+    if (drm->in_fence_fd >= 0) {
+        close(drm->in_fence_fd);
+        drm->in_fence_fd = -1;
+    }
+    if (drm->out_fence_fd >= 0) {
+        close(drm->out_fence_fd);
+        drm->out_fence_fd = -1;
+    }
+    
     // Clean up framebuffers
     if (drm->current_fb_id) {
         drmModeRmFB(drm->drm_fd, drm->current_fb_id);
@@ -486,7 +906,9 @@ void drm_cleanup(display_ctx_t *drm) {
         drmModeFreeConnector(drm->connector);
     }
     if (drm->drm_fd >= 0) {
-        drmDropMaster(drm->drm_fd);
+        if (!drm->headless) {
+            drmDropMaster(drm->drm_fd);
+        }
         close(drm->drm_fd);
     }
 }
\ No newline at end of file
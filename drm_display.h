@@ -33,10 +33,26 @@ typedef struct display_ctx {
     uint32_t current_fb_id;
     uint32_t next_fb_id;
     
+    bool primary_alpha;             // Set before drm_init(): ARGB primary so an underlay plane shows through
+    bool headless;                  // Set before drm_init(): offscreen GBM surface, no modeset (benchmarks)
+    uint32_t headless_width;        // Offscreen surface size (0 = 1920x1080)
+    uint32_t headless_height;
+    
     // Page flip state
     bool waiting_for_flip;
     bool mode_set_done;
     
+    // Atomic modesetting (PICKLE_NO_ATOMIC=1 forces legacy SetPlane/PageFlip)
+    bool atomic_supported;
+    int in_fence_fd;                // GL render-complete fence for the next commit (-1 if none)
+    int out_fence_fd;               // Signals when the in-flight commit is on screen (-1 if none)
+    uint32_t crtc_prop_out_fence_ptr;
+    
+    // Last completed flip (kernel vblank timestamp, CLOCK_MONOTONIC) for frame scheduling
+    unsigned int last_flip_seq;
+    uint64_t last_flip_time_us;
+    uint64_t flip_count;
+    
     // KMS video overlay plane for hardware video playback
     uint32_t video_plane_id;        // DRM plane ID for video overlay
     bool video_plane_available;     // True if overlay plane found
@@ -53,13 +69,30 @@ typedef struct display_ctx {
     uint32_t video_plane_prop_crtc_y;
     uint32_t video_plane_prop_crtc_w;
     uint32_t video_plane_prop_crtc_h;
+    uint32_t video_plane_prop_zpos;
+    uint32_t primary_plane_id;      // Primary plane driving our CRTC (for zpos ordering)
+    uint32_t primary_plane_prop_zpos;
+    uint32_t primary_plane_prop_fb_id;
+    uint32_t primary_plane_prop_crtc_id;
+    uint32_t primary_plane_prop_src_x;
+    uint32_t primary_plane_prop_src_y;
+    uint32_t primary_plane_prop_src_w;
+    uint32_t primary_plane_prop_src_h;
+    uint32_t primary_plane_prop_crtc_x;
+    uint32_t primary_plane_prop_crtc_y;
+    uint32_t primary_plane_prop_crtc_w;
+    uint32_t primary_plane_prop_crtc_h;
+    uint32_t primary_plane_prop_in_fence_fd;
+    bool video_plane_underlay;      // Video plane sits below the (alpha) primary plane
     
     // Framebuffer cache for DMA buffers (reuse FBs for decoder's buffer pool)
     struct {
         int dma_fd;                 // DMA buffer FD
         uint32_t fb_id;             // Corresponding framebuffer ID
+        uint32_t gem_handle;        // PRIME-imported handle backing fb_id
     } fb_cache[8];                  // Cache up to 8 framebuffers (typical pool size)
     int fb_cache_count;
+    int fb_cache_next_evict;        // Round-robin victim once the cache is full
     
     // Worker thread for non-blocking plane updates
     pthread_t plane_worker_thread;
@@ -68,9 +101,10 @@ typedef struct display_ctx {
     bool plane_worker_running;
     bool plane_worker_shutdown;
     
-    // Pending plane update (single-item mailbox)
+    // Pending plane update (single-item mailbox; staged for the next commit when atomic)
     struct {
-        uint32_t fb_id;
+        uint32_t fb_id;             // 0 disables the plane
+        uint32_t src_w, src_h;      // Source crop (whole frame); scaled to width x height
         uint32_t x, y;
         uint32_t width, height;
         bool pending;
@@ -88,10 +122,18 @@ void drm_page_flip_handler(int fd, unsigned int frame, unsigned int sec,
 
 // KMS video overlay plane functions (for hardware zero-copy video)
 int drm_init_video_plane(display_ctx_t *drm);
+int drm_start_plane_worker(display_ctx_t *drm);      // Legacy (non-atomic) plane updates; no-op if running
 int drm_create_video_fb(display_ctx_t *drm, int dma_fd, uint32_t width, uint32_t height,
-                        int plane_offsets[3], int plane_pitches[3], uint32_t *fb_id_out);
+                        int plane_offsets[3], int plane_pitches[3],
+                        uint32_t drm_format, uint64_t modifier, uint32_t *fb_id_out);
 int drm_display_video_frame(display_ctx_t *drm, uint32_t fb_id, uint32_t x, uint32_t y,
                             uint32_t width, uint32_t height);
+int drm_display_video_frame_scaled(display_ctx_t *drm, uint32_t fb_id,
+                                   uint32_t src_w, uint32_t src_h,
+                                   uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+int drm_set_video_plane_underlay(display_ctx_t *drm);
+void drm_clear_video_plane(display_ctx_t *drm);      // Disable plane, keep worker/FB cache
+void drm_flush_video_fb_cache(display_ctx_t *drm);   // Decoder reallocated its buffer pool
 void drm_hide_video_plane(display_ctx_t *drm);
 
 #endif // DRM_DISPLAY_H
\ No newline at end of file
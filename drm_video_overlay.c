@@ -4,6 +4,8 @@
 // This bypasses OpenGL/EGL entirely and uses DRM/KMS direct scanout
 #include "drm_display.h"
 #include "video_decoder.h"
+#include "thread_topology.h"
+#include "logger.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,6 +17,9 @@
 // Worker thread function for non-blocking plane updates
 static void* plane_worker_thread_func(void* arg) {
     display_ctx_t *drm = (display_ctx_t*)arg;
+
+    thread_topology_set_name("pickle-plane");
+    thread_topology_bind_plane_worker();
     
     pthread_mutex_lock(&drm->plane_mutex);
     
@@ -30,6 +35,8 @@ static void* plane_worker_thread_func(void* arg) {
         
         // Get the pending update
         uint32_t fb_id = drm->plane_update.fb_id;
+        uint32_t src_w = drm->plane_update.src_w;
+        uint32_t src_h = drm->plane_update.src_h;
         uint32_t x = drm->plane_update.x;
         uint32_t y = drm->plane_update.y;
         uint32_t width = drm->plane_update.width;
@@ -39,14 +46,21 @@ static void* plane_worker_thread_func(void* arg) {
         // Unlock while doing the blocking call
         pthread_mutex_unlock(&drm->plane_mutex);
         
-        // Perform the blocking plane update
+        // Perform the blocking plane update (fb 0 disables the plane)
         struct timespec plane_t1, plane_t2;
         clock_gettime(CLOCK_MONOTONIC, &plane_t1);
-        int ret = drmModeSetPlane(drm->drm_fd, drm->video_plane_id, drm->crtc_id,
-                                 fb_id, 0,
-                                 x, y, width, height,
-                                 0 << 16, 0 << 16,
-                                 width << 16, height << 16);
+        int ret;
+        if (fb_id == 0) {
+            ret = drmModeSetPlane(drm->drm_fd, drm->video_plane_id, 0, 0, 0,
+                                  0, 0, 0, 0, 0, 0, 0, 0);
+        } else {
+            ret = drmModeSetPlane(drm->drm_fd, drm->video_plane_id, drm->crtc_id,
+                                  fb_id, 0,
+                                  x, y, width, height,
+                                  0 << 16, 0 << 16,
+                                  src_w << 16, src_h << 16);
+        }
+        int set_errno = errno;  // Before the mutex is retaken
         clock_gettime(CLOCK_MONOTONIC, &plane_t2);
         double plane_ms = (plane_t2.tv_sec - plane_t1.tv_sec) * 1000.0 +
                           (plane_t2.tv_nsec - plane_t1.tv_nsec) / 1000000.0;
@@ -64,7 +78,7 @@ static void* plane_worker_thread_func(void* arg) {
         // last_present_time = plane_t2;
 
         if (hw_debug_enabled && plane_ms > 5.0) {
-            printf("[KMS-WORKER] drmModeSetPlane took %.1fms (plane=%u, crtc=%u, fb=%u)\n",
+            LOG_PRINT("[KMS-WORKER] drmModeSetPlane took %.1fms (plane=%u, crtc=%u, fb=%u)\n",
                    plane_ms, drm->video_plane_id, drm->crtc_id, fb_id);
         }
         
@@ -72,10 +86,8 @@ static void* plane_worker_thread_func(void* arg) {
         pthread_mutex_lock(&drm->plane_mutex);
         
         if (ret < 0) {
-            static int err_count = 0;
-            if (err_count < 5 && hw_debug_enabled) {
-                fprintf(stderr, "[KMS-WORKER] drmModeSetPlane failed: %s\n", strerror(errno));
-                err_count++;
+            if (hw_debug_enabled) {
+                LOG_ERROR_RATELIMITED("[KMS-WORKER] drmModeSetPlane failed: %s\n", strerror(set_errno));
             }
         } else {
             // Update tracking (now protected by mutex)
@@ -89,16 +101,43 @@ static void* plane_worker_thread_func(void* arg) {
 }
 
 // Initialize and find an available overlay plane for video
+// Legacy plane updates block in drmModeSetPlane until the vblank, so a worker applies
+// them. Started at plane init without atomic, or when the atomic path is abandoned; a
+// staged update still pending at that point is applied straight away.
+int drm_start_plane_worker(display_ctx_t *drm) {
+    if (drm->plane_worker_running) {
+        return 0;
+    }
+    pthread_mutex_init(&drm->plane_mutex, NULL);
+    pthread_cond_init(&drm->plane_cond, NULL);
+    drm->plane_worker_shutdown = false;
+    
+    if (pthread_create(&drm->plane_worker_thread, NULL, plane_worker_thread_func, drm) != 0) {
+        LOG_WARN("[KMS] Warning: Failed to create worker thread, will use blocking updates\n");
+        pthread_cond_destroy(&drm->plane_cond);
+        pthread_mutex_destroy(&drm->plane_mutex);
+        return -1;
+    }
+    drm->plane_worker_running = true;
+    if (hw_debug_enabled) {
+        LOG_INFO("[KMS] Worker thread started for non-blocking plane updates\n");
+    }
+    return 0;
+}
+
 int drm_init_video_plane(display_ctx_t *drm) {
     if (!drm || drm->drm_fd < 0) {
-        fprintf(stderr, "[KMS] Invalid DRM context\n");
+        LOG_ERROR("[KMS] Invalid DRM context\n");
         return -1;
     }
+    if (drm->headless) {
+        return -1;  // No CRTC to put a plane on
+    }
     
     // Find CRTC index by looking through resources
     drmModeResPtr resources = drmModeGetResources(drm->drm_fd);
     if (!resources) {
-        fprintf(stderr, "[KMS] Failed to get DRM resources\n");
+        LOG_ERROR("[KMS] Failed to get DRM resources\n");
         return -1;
     }
     
@@ -112,23 +151,23 @@ int drm_init_video_plane(display_ctx_t *drm) {
     drmModeFreeResources(resources);
     
     if (crtc_index < 0) {
-        fprintf(stderr, "[KMS] Could not find CRTC index for ID %u\n", drm->crtc_id);
+        LOG_ERROR("[KMS] Could not find CRTC index for ID %u\n", drm->crtc_id);
         return -1;
     }
     
     if (hw_debug_enabled) {
-        printf("[KMS] CRTC ID %u is at index %d\n", drm->crtc_id, crtc_index);
+        LOG_INFO("[KMS] CRTC ID %u is at index %d\n", drm->crtc_id, crtc_index);
     }
     
     // Get all available planes
     drmModePlaneResPtr planes = drmModeGetPlaneResources(drm->drm_fd);
     if (!planes) {
-        fprintf(stderr, "[KMS] Failed to get plane resources: %s\n", strerror(errno));
+        LOG_ERROR("[KMS] Failed to get plane resources: %s\n", strerror(errno));
         return -1;
     }
     
     if (hw_debug_enabled) {
-        printf("[KMS] Found %d planes total\n", planes->count_planes);
+        LOG_INFO("[KMS] Found %d planes total\n", planes->count_planes);
     }
     
     // Look for an overlay plane that supports YUV420 and our CRTC
@@ -186,6 +225,7 @@ int drm_init_video_plane(display_ctx_t *drm) {
                     else if (strcmp(prop->name, "CRTC_Y") == 0) drm->video_plane_prop_crtc_y = prop->prop_id;
                     else if (strcmp(prop->name, "CRTC_W") == 0) drm->video_plane_prop_crtc_w = prop->prop_id;
                     else if (strcmp(prop->name, "CRTC_H") == 0) drm->video_plane_prop_crtc_h = prop->prop_id;
+                    else if (strcmp(prop->name, "zpos") == 0) drm->video_plane_prop_zpos = prop->prop_id;
 
                     drmModeFreeProperty(prop);
                 }
@@ -196,30 +236,27 @@ int drm_init_video_plane(display_ctx_t *drm) {
             // Found a suitable overlay plane
             if (is_overlay && plane->crtc_id == 0) {  // Not currently in use
                 if (hw_debug_enabled) {
-                    printf("[KMS] ✓ Found available overlay plane: %u (supports YUV420, compatible with CRTC %d)\n", 
-                           plane->plane_id, crtc_index);
+                    LOG_INFO("[KMS] ✓ Found available overlay plane: %u (supports YUV420, compatible with CRTC %d)\n", 
+                             plane->plane_id, crtc_index);
                 }
                 drm->video_plane_id = plane->plane_id;
                 drm->video_plane_available = true;
                 drm->video_fb_id = 0;
                 drm->prev_video_fb_id = 0;
-                
-                // Initialize worker thread for non-blocking plane updates
-                pthread_mutex_init(&drm->plane_mutex, NULL);
-                pthread_cond_init(&drm->plane_cond, NULL);
                 drm->plane_update.pending = false;
                 drm->plane_worker_shutdown = false;
                 drm->plane_worker_running = false;
                 
-                if (pthread_create(&drm->plane_worker_thread, NULL, plane_worker_thread_func, drm) == 0) {
-                    drm->plane_worker_running = true;
-                    if (hw_debug_enabled) {
-                        printf("[KMS] Worker thread started for non-blocking plane updates\n");
-                    }
-                } else {
-                    fprintf(stderr, "[KMS] Warning: Failed to create worker thread, will use blocking updates\n");
+                // Atomic: plane updates ride along with the next primary commit, no worker needed
+                if (drm->atomic_supported) {
+                    drmModeFreePlane(plane);
+                    drmModeFreePlaneResources(planes);
+                    return 0;
                 }
                 
+                // Initialize worker thread for non-blocking plane updates
+                drm_start_plane_worker(drm);
+                
                 drmModeFreePlane(plane);
                 drmModeFreePlaneResources(planes);
                 return 0;
@@ -230,15 +267,41 @@ int drm_init_video_plane(display_ctx_t *drm) {
     }
     
     drmModeFreePlaneResources(planes);
-    fprintf(stderr, "[KMS] No available overlay plane found\n");
+    LOG_ERROR("[KMS] No available overlay plane found\n");
     return -1;
 }
 
-// Create a DRM framebuffer from a V4L2 DMA buffer (YU12/I420 format)
+// True if fb_id is scanned out or queued for the video plane
+static bool video_fb_in_use(display_ctx_t *drm, uint32_t fb_id) {
+    if (fb_id == 0) return false;
+    
+    if (drm->plane_worker_running) pthread_mutex_lock(&drm->plane_mutex);
+    bool in_use = (fb_id == drm->video_fb_id || fb_id == drm->prev_video_fb_id ||
+                   (drm->plane_update.pending && fb_id == drm->plane_update.fb_id));
+    if (drm->plane_worker_running) pthread_mutex_unlock(&drm->plane_mutex);
+    return in_use;
+}
+
+static void release_cached_fb(display_ctx_t *drm, int index) {
+    if (drm->fb_cache[index].fb_id != 0) {
+        drmModeRmFB(drm->drm_fd, drm->fb_cache[index].fb_id);
+    }
+    if (drm->fb_cache[index].gem_handle != 0) {
+        struct drm_gem_close gem_close = { .handle = drm->fb_cache[index].gem_handle };
+        drmIoctl(drm->drm_fd, DRM_IOCTL_GEM_CLOSE, &gem_close);
+    }
+    drm->fb_cache[index].dma_fd = -1;
+    drm->fb_cache[index].fb_id = 0;
+    drm->fb_cache[index].gem_handle = 0;
+}
+
+// Create a DRM framebuffer from a decoder DMA buffer: YU12/I420 from V4L2 M2M,
+// or NV12/P030 in the Broadcom SAND column layouts from the HEVC block
 int drm_create_video_fb(display_ctx_t *drm, int dma_fd, uint32_t width, uint32_t height,
-                        int plane_offsets[3], int plane_pitches[3], uint32_t *fb_id_out) {
+                        int plane_offsets[3], int plane_pitches[3],
+                        uint32_t drm_format, uint64_t modifier, uint32_t *fb_id_out) {
     if (!drm || dma_fd < 0 || !fb_id_out) {
-        fprintf(stderr, "[KMS] Invalid parameters for framebuffer creation\n");
+        LOG_ERROR("[KMS] Invalid parameters for framebuffer creation\n");
         return -1;
     }
     
@@ -251,10 +314,13 @@ int drm_create_video_fb(display_ctx_t *drm, int dma_fd, uint32_t width, uint32_t
     }
     
     // Cache miss - create new framebuffer
-    // DRM framebuffer descriptor for YU12/I420 format (3 planes)
+    // YU12/I420 has 3 planes; NV12/P030 carry interleaved chroma in a second plane
+    int planes = (drm_format == DRM_FORMAT_YUV420) ? 3 : 2;
     uint32_t handles[4] = {0};
     uint32_t pitches[4] = {0};
     uint32_t offsets[4] = {0};
+    uint64_t modifiers[4] = {0};
+    bool explicit_modifier = modifier != DRM_FORMAT_MOD_LINEAR && modifier != DRM_FORMAT_MOD_INVALID;
     
     // Convert DMA-BUF FD to GEM handle
     struct drm_prime_handle prime_handle = {
@@ -264,45 +330,47 @@ int drm_create_video_fb(display_ctx_t *drm, int dma_fd, uint32_t width, uint32_t
     };
     
     if (drmIoctl(drm->drm_fd, DRM_IOCTL_PRIME_FD_TO_HANDLE, &prime_handle) < 0) {
-        fprintf(stderr, "[KMS] Failed to import DMA-BUF: %s\n", strerror(errno));
+        LOG_ERROR_RATELIMITED("[KMS] Failed to import DMA-BUF: %s\n", strerror(errno));
         return -1;
     }
 
     // Measure import duration (helpful to detect blocking in PRIME import)
     // Note: we only have an end timestamp here, so the measurement is best-effort
     
-    // YU12/I420: All 3 planes use the same GEM buffer with different offsets
-    handles[0] = prime_handle.handle;  // Y plane
-    handles[1] = prime_handle.handle;  // U plane
-    handles[2] = prime_handle.handle;  // V plane
-    
-    pitches[0] = plane_pitches[0];
-    pitches[1] = plane_pitches[1];
-    pitches[2] = plane_pitches[2];
-    
-    offsets[0] = plane_offsets[0];
-    offsets[1] = plane_offsets[1];
-    offsets[2] = plane_offsets[2];
+    // All planes use the same GEM buffer with different offsets
+    for (int p = 0; p < planes; p++) {
+        handles[p] = prime_handle.handle;
+        pitches[p] = plane_pitches[p];
+        offsets[p] = plane_offsets[p];
+        modifiers[p] = modifier;
+    }
     
-    // Create framebuffer with YU12 format
     uint32_t fb_id = 0;
     // Time the framebuffer creation call (this can block if GEM/driver is busy)
     struct timespec fb_t1, fb_t2;
     clock_gettime(CLOCK_MONOTONIC, &fb_t1);
-    int ret = drmModeAddFB2(drm->drm_fd, width, height, DRM_FORMAT_YUV420,
-                           handles, pitches, offsets, &fb_id, 0);
+    int ret;
+    if (explicit_modifier) {
+        // SAND128/SAND30: the column height travels in the modifier, not the pitch
+        ret = drmModeAddFB2WithModifiers(drm->drm_fd, width, height, drm_format,
+                                         handles, pitches, offsets, modifiers,
+                                         &fb_id, DRM_MODE_FB_MODIFIERS);
+    } else {
+        ret = drmModeAddFB2(drm->drm_fd, width, height, drm_format,
+                            handles, pitches, offsets, &fb_id, 0);
+    }
     clock_gettime(CLOCK_MONOTONIC, &fb_t2);
     double fb_ms = (fb_t2.tv_sec - fb_t1.tv_sec) * 1000.0 +
                    (fb_t2.tv_nsec - fb_t1.tv_nsec) / 1000000.0;
     if ((fb_ms > 5.0 && hw_debug_enabled) || hw_debug_enabled) {
-        printf("[KMS] drmModeAddFB2 took %.1fms (width=%u height=%u)\n", fb_ms, width, height);
+        LOG_INFO("[KMS] drmModeAddFB2 took %.1fms (width=%u height=%u)\n", fb_ms, width, height);
     }
     
     if (ret < 0) {
-        fprintf(stderr, "[KMS] drmModeAddFB2 failed: %s\n", strerror(errno));
-        fprintf(stderr, "[KMS] Format: YUV420, Size: %dx%d\n", width, height);
-        fprintf(stderr, "[KMS] Pitches: %d, %d, %d\n", pitches[0], pitches[1], pitches[2]);
-        fprintf(stderr, "[KMS] Offsets: %d, %d, %d\n", offsets[0], offsets[1], offsets[2]);
+        LOG_ERROR_RATELIMITED("[KMS] drmModeAddFB2 failed: %s (format 0x%08x, modifier 0x%016llx, %ux%u, "
+                              "pitches %u/%u/%u, offsets %u/%u/%u)\n", strerror(errno), drm_format,
+                              (unsigned long long)modifier, width, height, pitches[0], pitches[1], pitches[2],
+                              offsets[0], offsets[1], offsets[2]);
         
         // Clean up GEM handle
         struct drm_gem_close gem_close = { .handle = prime_handle.handle };
@@ -312,27 +380,47 @@ int drm_create_video_fb(display_ctx_t *drm, int dma_fd, uint32_t width, uint32_t
     
     *fb_id_out = fb_id;
     
-    // Add to cache for reuse
+    // Add to cache for reuse; once full, recycle an entry that is not on screen
+    int slot = -1;
     if (drm->fb_cache_count < 8) {
-        drm->fb_cache[drm->fb_cache_count].dma_fd = dma_fd;
-        drm->fb_cache[drm->fb_cache_count].fb_id = fb_id;
-        drm->fb_cache_count++;
+        slot = drm->fb_cache_count++;
+    } else {
+        for (int tries = 0; tries < 8 && slot < 0; tries++) {
+            int victim = drm->fb_cache_next_evict;
+            drm->fb_cache_next_evict = (drm->fb_cache_next_evict + 1) % 8;
+            if (!video_fb_in_use(drm, drm->fb_cache[victim].fb_id)) {
+                release_cached_fb(drm, victim);
+                slot = victim;
+            }
+        }
+    }
+    if (slot >= 0) {
+        drm->fb_cache[slot].dma_fd = dma_fd;
+        drm->fb_cache[slot].fb_id = fb_id;
+        drm->fb_cache[slot].gem_handle = prime_handle.handle;
     }
     
     // Only log first few framebuffer creations
     static int fb_create_count = 0;
     if (fb_create_count < 3 && hw_debug_enabled) {
-        printf("[KMS] ✓ Created framebuffer %d from DMA-BUF (FD=%d, %dx%d) [cached]\n", 
-               fb_id, dma_fd, width, height);
+        LOG_INFO("[KMS] ✓ Created framebuffer %d from DMA-BUF (FD=%d, %dx%d) [cached]\n", 
+                 fb_id, dma_fd, width, height);
         fb_create_count++;
     }
     return 0;
 }
 
-// Display a video frame on the overlay plane
+// Display a video frame on the overlay plane at its native size
 int drm_display_video_frame(display_ctx_t *drm, uint32_t fb_id, uint32_t x, uint32_t y,
                             uint32_t width, uint32_t height) {
-    if (!drm || !drm->video_plane_available || fb_id == 0) {
+    return drm_display_video_frame_scaled(drm, fb_id, width, height, x, y, width, height);
+}
+
+// Display a src_w x src_h video frame scaled by the plane into the given CRTC rectangle
+int drm_display_video_frame_scaled(display_ctx_t *drm, uint32_t fb_id,
+                                   uint32_t src_w, uint32_t src_h,
+                                   uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    if (!drm || !drm->video_plane_available || fb_id == 0 || src_w == 0 || src_h == 0) {
         return -1;
     }
     
@@ -344,6 +432,19 @@ int drm_display_video_frame(display_ctx_t *drm, uint32_t fb_id, uint32_t x, uint
     if (width > crtc_w) width = crtc_w;
     if (height > crtc_h) height = crtc_h;
     
+    // Atomic: stage the update; drm_swap_buffers() commits it with the GL frame
+    if (drm->atomic_supported) {
+        drm->plane_update.fb_id = fb_id;
+        drm->plane_update.src_w = src_w;
+        drm->plane_update.src_h = src_h;
+        drm->plane_update.x = x;
+        drm->plane_update.y = y;
+        drm->plane_update.width = width;
+        drm->plane_update.height = height;
+        drm->plane_update.pending = true;
+        return 0;
+    }
+    
     // If worker thread is running, submit update to the worker
     if (drm->plane_worker_running) {
         pthread_mutex_lock(&drm->plane_mutex);
@@ -363,6 +464,8 @@ int drm_display_video_frame(display_ctx_t *drm, uint32_t fb_id, uint32_t x, uint
 
         // Submit new plane update (overwrites pending if worker is busy)
         drm->plane_update.fb_id = fb_id;
+        drm->plane_update.src_w = src_w;
+        drm->plane_update.src_h = src_h;
         drm->plane_update.x = x;
         drm->plane_update.y = y;
         drm->plane_update.width = width;
@@ -384,22 +487,18 @@ int drm_display_video_frame(display_ctx_t *drm, uint32_t fb_id, uint32_t x, uint
                              fb_id, 0,
                              x, y, width, height,
                              0 << 16, 0 << 16,
-                             width << 16, height << 16);
+                             src_w << 16, src_h << 16);
     clock_gettime(CLOCK_MONOTONIC, &plane_t2);
     double plane_ms = (plane_t2.tv_sec - plane_t1.tv_sec) * 1000.0 +
                       (plane_t2.tv_nsec - plane_t1.tv_nsec) / 1000000.0;
     if ((plane_ms > 5.0 && hw_debug_enabled) || plane_ms > 20.0) {
-        printf("[KMS] drmModeSetPlane took %.1fms (plane=%u, crtc=%u, fb=%u)\n",
-               plane_ms, drm->video_plane_id, drm->crtc_id, fb_id);
+        LOG_WARN_RATELIMITED("[KMS] drmModeSetPlane took %.1fms (plane=%u, crtc=%u, fb=%u)\n",
+                             plane_ms, drm->video_plane_id, drm->crtc_id, fb_id);
     }
     
     if (ret < 0) {
-        static int err_count = 0;
-        if (err_count < 5) {
-            fprintf(stderr, "[KMS] drmModeSetPlane failed: %s (plane=%u, crtc=%u, fb=%u, pos=%u,%u, size=%ux%u)\n", 
-                   strerror(errno), drm->video_plane_id, drm->crtc_id, fb_id, x, y, width, height);
-            err_count++;
-        }
+        LOG_ERROR_RATELIMITED("[KMS] drmModeSetPlane failed: %s (plane=%u, crtc=%u, fb=%u, pos=%u,%u, size=%ux%u)\n",
+                              strerror(errno), drm->video_plane_id, drm->crtc_id, fb_id, x, y, width, height);
         return -1;
     }
     
@@ -410,6 +509,86 @@ int drm_display_video_frame(display_ctx_t *drm, uint32_t fb_id, uint32_t x, uint
     return 0;
 }
 
+// Put the video plane below the primary plane so GL overlays drawn on an
+// ARGB primary (transparent elsewhere) appear on top of the scanned-out video
+int drm_set_video_plane_underlay(display_ctx_t *drm) {
+    if (!drm || !drm->video_plane_available) {
+        return -1;
+    }
+    
+    if (!drm->primary_alpha || !drm->video_plane_prop_zpos ||
+        !drm->primary_plane_id || !drm->primary_plane_prop_zpos) {
+        drm->video_plane_underlay = false;
+        return -1;
+    }
+    
+    if (drmModeObjectSetProperty(drm->drm_fd, drm->video_plane_id, DRM_MODE_OBJECT_PLANE,
+                                 drm->video_plane_prop_zpos, 0) != 0 ||
+        drmModeObjectSetProperty(drm->drm_fd, drm->primary_plane_id, DRM_MODE_OBJECT_PLANE,
+                                 drm->primary_plane_prop_zpos, 1) != 0) {
+        LOG_ERROR("[KMS] Failed to reorder planes (zpos): %s\n", strerror(errno));
+        drm->video_plane_underlay = false;
+        return -1;
+    }
+    
+    drm->video_plane_underlay = true;
+    return 0;
+}
+
+// Disable the video plane but keep the worker thread and framebuffer cache alive
+void drm_clear_video_plane(display_ctx_t *drm) {
+    if (!drm || !drm->video_plane_available) {
+        return;
+    }
+    
+    if (drm->atomic_supported) {
+        if (drm->video_fb_id != 0 || drm->plane_update.pending) {
+            drm->plane_update.fb_id = 0;
+            drm->plane_update.pending = true;
+        }
+        return;
+    }
+    
+    if (drm->plane_worker_running) {
+        pthread_mutex_lock(&drm->plane_mutex);
+        if (drm->video_fb_id != 0 || drm->plane_update.pending) {
+            drm->plane_update.fb_id = 0;
+            drm->plane_update.pending = true;
+            pthread_cond_signal(&drm->plane_cond);
+        }
+        pthread_mutex_unlock(&drm->plane_mutex);
+        return;
+    }
+    
+    if (drm->video_fb_id != 0) {
+        drmModeSetPlane(drm->drm_fd, drm->video_plane_id, 0, 0, 0,
+                       0, 0, 0, 0, 0, 0, 0, 0);
+        drm->prev_video_fb_id = drm->video_fb_id;
+        drm->video_fb_id = 0;
+    }
+}
+
+// Drop cached framebuffers that are not on screen (decoder pool was reallocated,
+// so cached dma_fd keys may now refer to different buffers)
+void drm_flush_video_fb_cache(display_ctx_t *drm) {
+    if (!drm) {
+        return;
+    }
+    
+    int kept = 0;
+    for (int i = 0; i < drm->fb_cache_count; i++) {
+        if (video_fb_in_use(drm, drm->fb_cache[i].fb_id)) {
+            // Still scanned out; keep the FB but never match it by fd again
+            drm->fb_cache[i].dma_fd = -1;
+            drm->fb_cache[kept++] = drm->fb_cache[i];
+        } else {
+            release_cached_fb(drm, i);
+        }
+    }
+    drm->fb_cache_count = kept;
+    drm->fb_cache_next_evict = 0;
+}
+
 // Hide the video overlay plane
 void drm_hide_video_plane(display_ctx_t *drm) {
     if (!drm || !drm->video_plane_available) {
@@ -444,21 +623,21 @@ void drm_hide_video_plane(display_ctx_t *drm) {
         drm->plane_worker_running = false;
 
         if (hw_debug_enabled) {
-            printf("[KMS] Worker thread stopped\n");
+            LOG_INFO("[KMS] Worker thread stopped\n");
         }
     }
     
-    // Disable the plane by setting fb_id to 0
+    // Disable the plane by setting fb_id to 0 (legacy call is fine at shutdown, atomic or not)
+    drm->plane_update.pending = false;
     drmModeSetPlane(drm->drm_fd, drm->video_plane_id, 0, 0, 0, 
                    0, 0, 0, 0, 0, 0, 0, 0);
     
     // Clean up all cached framebuffers
     for (int i = 0; i < drm->fb_cache_count; i++) {
-        if (drm->fb_cache[i].fb_id != 0) {
-            drmModeRmFB(drm->drm_fd, drm->fb_cache[i].fb_id);
-        }
+        release_cached_fb(drm, i);
     }
     drm->fb_cache_count = 0;
+    drm->fb_cache_next_evict = 0;
     
     drm->video_fb_id = 0;
     drm->prev_video_fb_id = 0;
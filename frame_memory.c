@@ -0,0 +1,218 @@
+#define _GNU_SOURCE
+#include "frame_memory.h"
+#include "production_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <linux/dma-heap.h>
+#include <linux/dma-buf.h>
+
+static const char *dma_heap_paths[] = {
+    "/dev/dma_heap/linux,cma",   // Physically contiguous: importable by every display/codec block
+    "/dev/dma_heap/system",
+    NULL
+};
+
+static pthread_once_t config_once = PTHREAD_ONCE_INIT;
+static size_t limit_bytes = 0;
+static size_t used_bytes = 0;
+static int heap_fd = -1;          // -1: anonymous memory
+
+static void load_config(void) {
+    long limit_mb = MEMORY_LIMIT_MB;
+    const char *env = getenv("PICKLE_MEMORY_LIMIT_MB");
+    if (env && atol(env) > 0) {
+        limit_mb = atol(env);
+    }
+    limit_bytes = (size_t)limit_mb << 20;
+
+    env = getenv("PICKLE_FRAME_DMA_HEAP");
+    if (env && env[0] == '1') {
+        for (int i = 0; dma_heap_paths[i] && heap_fd < 0; i++) {
+            heap_fd = open(dma_heap_paths[i], O_RDWR | O_CLOEXEC);
+            if (heap_fd >= 0) {
+                printf("[MEM] Frame buffers from %s\n", dma_heap_paths[i]);
+            }
+        }
+        if (heap_fd < 0) {
+            fprintf(stderr, "[MEM] No usable dma-heap (%s), using anonymous memory\n", strerror(errno));
+        }
+    }
+}
+
+size_t frame_memory_limit(void) {
+    pthread_once(&config_once, load_config);
+    return limit_bytes;
+}
+
+size_t frame_memory_used(void) {
+    return __atomic_load_n(&used_bytes, __ATOMIC_RELAXED);
+}
+
+int frame_memory_reserve(size_t bytes, const char *what) {
+    size_t limit = frame_memory_limit();
+    size_t used = __atomic_load_n(&used_bytes, __ATOMIC_RELAXED);
+    do {
+        if (used + bytes > limit) {
+            fprintf(stderr, "[MEM] %s: %zu KB would exceed the %zu MB frame memory budget (%zu MB in use)\n",
+                    what, bytes >> 10, limit >> 20, used >> 20);
+            return -1;
+        }
+    } while (!__atomic_compare_exchange_n(&used_bytes, &used, used + bytes, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return 0;
+}
+
+void frame_memory_unreserve(size_t bytes) {
+    __atomic_fetch_sub(&used_bytes, bytes, __ATOMIC_RELAXED);
+}
+
+void frame_memory_init(frame_memory_t *mem) {
+    memset(mem, 0, sizeof(*mem));
+    for (int i = 0; i < FRAME_MEMORY_SLOTS; i++) {
+        mem->buffers[i].dma_fd = -1;
+    }
+}
+
+// Safe on a zeroed (never prepared) buffer: the fd is only meaningful with a mapping
+static void buffer_free(frame_memory_buffer_t *buf) {
+    if (buf->data) {
+        munmap(buf->data, buf->size);
+        frame_memory_unreserve(buf->size);
+        if (buf->dma_fd >= 0) {
+            close(buf->dma_fd);
+        }
+    }
+    buf->data = NULL;
+    buf->size = 0;
+    buf->dma_fd = -1;
+}
+
+// MAP_POPULATE faults every page in now instead of on the first frame
+static int buffer_alloc(frame_memory_buffer_t *buf, size_t size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size = (size + page - 1) & ~(page - 1);
+    if (frame_memory_reserve(size, "frame buffer") != 0) {
+        return -1;
+    }
+
+    if (heap_fd >= 0) {
+        struct dma_heap_allocation_data alloc = {
+            .len = size,
+            .fd_flags = O_RDWR | O_CLOEXEC,
+        };
+        if (ioctl(heap_fd, DMA_HEAP_IOCTL_ALLOC, &alloc) == 0) {
+            void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, (int)alloc.fd, 0);
+            if (map != MAP_FAILED) {
+                buf->data = (uint8_t *)map;
+                buf->size = size;
+                buf->dma_fd = (int)alloc.fd;
+                return 0;
+            }
+            close((int)alloc.fd);
+        }
+        static bool heap_warned = false;
+        if (!heap_warned) {
+            fprintf(stderr, "[MEM] dma-heap allocation of %zu KB failed (%s), using anonymous memory\n",
+                    size >> 10, strerror(errno));
+            heap_warned = true;
+        }
+    }
+
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (map == MAP_FAILED) {
+        frame_memory_unreserve(size);
+        return -1;
+    }
+    buf->data = (uint8_t *)map;
+    buf->size = size;
+    buf->dma_fd = -1;
+    return 0;
+}
+
+int frame_memory_prepare(frame_memory_t *mem, int width, int height, bool planar, bool nv12) {
+    if (width <= 0 || height <= 0) {
+        return -1;
+    }
+    pthread_once(&config_once, load_config);
+
+    // Hardware frames are copied with their own padded stride, so size for that
+    size_t stride = ((size_t)width + FRAME_MEMORY_ALIGN - 1) & ~(size_t)(FRAME_MEMORY_ALIGN - 1);
+    size_t rows = (size_t)height + (height & 1);
+    size_t sizes[FRAME_MEMORY_SLOTS] = {
+        [FRAME_MEMORY_Y] = planar ? stride * rows : 0,
+        [FRAME_MEMORY_U] = planar ? stride / 2 * rows / 2 : 0,
+        [FRAME_MEMORY_V] = planar ? stride / 2 * rows / 2 : 0,
+        [FRAME_MEMORY_NV12] = nv12 ? (size_t)width * rows * 3 / 2 : 0,
+    };
+
+    size_t total = 0;
+    mem->exhausted = false;
+    for (int i = 0; i < FRAME_MEMORY_SLOTS; i++) {
+        frame_memory_buffer_t *buf = &mem->buffers[i];
+        if (sizes[i] == 0 || buf->size >= sizes[i]) {
+            continue;
+        }
+        buffer_free(buf);
+        if (buffer_alloc(buf, sizes[i]) != 0) {
+            mem->exhausted = true;
+            return -1;
+        }
+        total += buf->size;
+    }
+    if (total > 0) {
+        printf("[MEM] Preallocated %zu KB of frame buffers for %dx%d (%zu of %zu MB budget in use)\n",
+               total >> 10, width, height, frame_memory_used() >> 20, frame_memory_limit() >> 20);
+    }
+    return 0;
+}
+
+uint8_t *frame_memory_get(frame_memory_t *mem, frame_memory_slot_t slot, size_t size) {
+    frame_memory_buffer_t *buf = &mem->buffers[slot];
+    if (buf->size >= size) {
+        return buf->data;
+    }
+    if (mem->exhausted) {
+        return NULL;
+    }
+    // Contents are rewritten by every caller, so nothing is copied across
+    buffer_free(buf);
+    if (buffer_alloc(buf, size) != 0) {
+        mem->exhausted = true;
+        return NULL;
+    }
+    mem->grows++;
+    printf("[MEM] Frame buffer %d grown to %zu KB after open\n", (int)slot, buf->size >> 10);
+    return buf->data;
+}
+
+static void buffer_sync(const frame_memory_buffer_t *buf, uint64_t flags) {
+    if (buf->data && buf->dma_fd >= 0) {
+        struct dma_buf_sync sync = { .flags = flags | DMA_BUF_SYNC_WRITE };
+        ioctl(buf->dma_fd, DMA_BUF_IOCTL_SYNC, &sync);
+    }
+}
+
+void frame_memory_begin_write(frame_memory_t *mem, frame_memory_slot_t slot) {
+    buffer_sync(&mem->buffers[slot], DMA_BUF_SYNC_START);
+}
+
+void frame_memory_end_write(frame_memory_t *mem, frame_memory_slot_t slot) {
+    buffer_sync(&mem->buffers[slot], DMA_BUF_SYNC_END);
+}
+
+int frame_memory_dma_fd(const frame_memory_t *mem, frame_memory_slot_t slot) {
+    return mem->buffers[slot].data ? mem->buffers[slot].dma_fd : -1;
+}
+
+void frame_memory_release(frame_memory_t *mem) {
+    for (int i = 0; i < FRAME_MEMORY_SLOTS; i++) {
+        buffer_free(&mem->buffers[i]);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef FRAME_MEMORY_H
+#define FRAME_MEMORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Per-stream CPU frame buffers (cached planar copies, NV12 upload buffer).
+// Buffers are page-aligned and pre-faulted, sized from the stream's real
+// resolution when it is opened, and only grow if a frame turns out larger
+// (e.g. a padded hardware stride), so steady-state playback neither
+// reallocates nor takes page faults. With PICKLE_FRAME_DMA_HEAP=1 they come
+// from /dev/dma_heap (CMA first) and carry a DMA-BUF fd for import.
+//
+// Every buffer, and anything passed to frame_memory_reserve(), is charged to
+// one process-wide budget: MEMORY_LIMIT_MB, or PICKLE_MEMORY_LIMIT_MB. An
+// allocation over budget fails and the caller takes its unbuffered path.
+typedef enum {
+    FRAME_MEMORY_Y = 0,          // 8-bit planar copy of the frame (video_get_yuv_data)
+    FRAME_MEMORY_U,
+    FRAME_MEMORY_V,
+    FRAME_MEMORY_NV12,           // Packed Y + interleaved UV (video_get_nv12_data)
+    FRAME_MEMORY_SLOTS
+} frame_memory_slot_t;
+
+typedef struct {
+    uint8_t *data;
+    size_t size;                 // Mapped (and charged) bytes, page multiple
+    int dma_fd;                  // DMA-BUF from a dma-heap, -1 for anonymous memory
+} frame_memory_buffer_t;
+
+typedef struct {
+    frame_memory_buffer_t buffers[FRAME_MEMORY_SLOTS];
+    unsigned int grows;          // Allocations after frame_memory_prepare (should stay 0)
+    bool exhausted;              // An allocation failed: stop retrying every frame
+} frame_memory_t;
+
+#define FRAME_MEMORY_ALIGN 64    // Row alignment assumed when sizing hardware frame copies
+
+void frame_memory_init(frame_memory_t *mem);
+// Allocate the planar set (Y/U/V) and/or the NV12 buffer for width x height
+int frame_memory_prepare(frame_memory_t *mem, int width, int height, bool planar, bool nv12);
+// Buffer of at least size bytes, growing it if needed; NULL if over budget
+uint8_t *frame_memory_get(frame_memory_t *mem, frame_memory_slot_t slot, size_t size);
+// Bracket CPU writes so a DMA-BUF backed buffer is coherent for a later import (no-op otherwise)
+void frame_memory_begin_write(frame_memory_t *mem, frame_memory_slot_t slot);
+void frame_memory_end_write(frame_memory_t *mem, frame_memory_slot_t slot);
+int frame_memory_dma_fd(const frame_memory_t *mem, frame_memory_slot_t slot);
+void frame_memory_release(frame_memory_t *mem);
+
+// Budget accounting for frame memory allocated elsewhere (GL pixel buffers)
+int frame_memory_reserve(size_t bytes, const char *what);
+void frame_memory_unreserve(size_t bytes);
+size_t frame_memory_used(void);
+size_t frame_memory_limit(void);
+
+#endif // FRAME_MEMORY_H
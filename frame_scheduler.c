@@ -0,0 +1,276 @@
+#include "frame_scheduler.h"
+#include <string.h>
+#include <math.h>
+
+// A PTS this far from the presentation clock is a timeline jump (loop, seek,
+// long stall) rather than lateness - re-anchor the stream instead of dropping.
+#define FRAME_SCHED_RESYNC_SECONDS 1.0
+
+// Fraction of a vblank period tolerated as timestamp jitter
+#define FRAME_SCHED_JITTER_FRACTION 0.25
+
+// A remote epoch that still differs after this long is not a loop boundary the
+// nodes cross a few frames apart: the numbering is re-linked to the remote one
+#define FRAME_SCHED_RELINK_SECONDS 2.0
+
+static bool valid_stream(const frame_scheduler_t *sched, int stream) {
+    return sched && stream >= 0 && stream < FRAME_SCHED_MAX_STREAMS;
+}
+
+void frame_sched_init(frame_scheduler_t *sched, double refresh_hz) {
+    if (!sched) return;
+
+    memset(sched, 0, sizeof(*sched));
+    sched->vblank_period = (refresh_hz > 0.0) ? 1.0 / refresh_hz : 1.0 / 60.0;
+    sched->last_vblank = -1.0;
+    sched->clock_origin = -1.0;
+
+    for (int i = 0; i < FRAME_SCHED_MAX_STREAMS; i++) {
+        sched->streams[i].frame_duration = sched->vblank_period;
+        sched->streams[i].last_shown_pts = -1.0;
+        sched->streams[i].epoch_end_pts = -1.0;
+    }
+}
+
+void frame_sched_set_frame_rate(frame_scheduler_t *sched, int stream, double fps) {
+    if (!valid_stream(sched, stream) || fps <= 0.0) return;
+
+    sched->streams[stream].frame_duration = 1.0 / fps;
+}
+
+void frame_sched_reset_stream(frame_scheduler_t *sched, int stream) {
+    if (!valid_stream(sched, stream)) return;
+
+    frame_sched_stream_t *s = &sched->streams[stream];
+    if (s->continuous && s->ever_anchored && s->epoch_end_pts >= 0.0 && sched->clock_origin >= 0.0) {
+        // The new epoch starts one frame after the old one's last PTS - a function
+        // of the shared mapping only, so every node lands on the same target.
+        // A resync may have cleared anchored, but anchor_pts is still this epoch's.
+        s->start_at = sched->clock_origin + (s->epoch_end_pts - s->anchor_pts) + s->frame_duration;
+    }
+    s->anchored = false;
+    s->last_shown_pts = -1.0;
+    s->epoch++;
+    s->epoch_end_pts = -1.0;
+}
+
+void frame_sched_on_vblank(frame_scheduler_t *sched, unsigned int seq, double timestamp) {
+    if (!sched || timestamp <= 0.0) return;
+
+    if (sched->last_vblank >= 0.0 && seq > sched->last_vblank_seq && timestamp > sched->last_vblank) {
+        // Refine the period from the kernel timestamps; ignore outliers from mode changes
+        double measured = (timestamp - sched->last_vblank) / (double)(seq - sched->last_vblank_seq);
+        if (measured > sched->vblank_period * 0.5 && measured < sched->vblank_period * 2.0) {
+            sched->vblank_period += (measured - sched->vblank_period) * 0.05;
+        }
+    }
+
+    sched->last_vblank = timestamp;
+    sched->last_vblank_seq = seq;
+}
+
+double frame_sched_next_vblank(const frame_scheduler_t *sched, double now) {
+    if (!sched) return now;
+
+    // No flip events yet: vblank phase is unknown, present as soon as possible
+    if (sched->last_vblank < 0.0 || sched->vblank_period <= 0.0) {
+        return now;
+    }
+
+    double elapsed = now - sched->last_vblank;
+    if (elapsed < 0.0) {
+        return sched->last_vblank;
+    }
+    double intervals = floor(elapsed / sched->vblank_period) + 1.0;
+    return sched->last_vblank + intervals * sched->vblank_period;
+}
+
+void frame_sched_set_live_latency(frame_scheduler_t *sched, int stream, double target) {
+    if (!valid_stream(sched, stream)) return;
+
+    sched->streams[stream].live_latency = target > 0.0 ? target : 0.0;
+}
+
+frame_sched_action_t frame_sched_decide(frame_scheduler_t *sched, int stream, double pts, double arrival,
+                                        double vblank_time, bool have_next) {
+    if (!valid_stream(sched, stream)) return FRAME_SCHED_SHOW;
+
+    frame_sched_stream_t *s = &sched->streams[stream];
+    if (pts > s->epoch_end_pts) {
+        s->epoch_end_pts = pts;
+    }
+
+    // Live: latency first, cadence second. A stale frame is skipped if a newer one
+    // is queued, otherwise shown at once; either way the PTS mapping restarts from
+    // the frame that reaches the screen, so a drifting camera clock can't let the
+    // backlog build up again.
+    if (s->live_latency > 0.0 && arrival > 0.0 && vblank_time - arrival > s->live_latency) {
+        s->anchored = false;
+        if (have_next) {
+            s->stale_dropped++;
+            return FRAME_SCHED_DROP;
+        }
+        return FRAME_SCHED_SHOW;
+    }
+
+    // Unknown PTS or first frame: show immediately, mark_shown() anchors the stream
+    if (pts < 0.0 || !s->anchored || sched->clock_origin < 0.0) {
+        return FRAME_SCHED_SHOW;
+    }
+
+    // Targets come from absolute PTS, never from accumulated frame counts, so
+    // 24/25/30/50fps cadences on a 60Hz mode repeat in the same pattern forever
+    double target = sched->clock_origin + (pts - s->anchor_pts);
+    double tolerance = sched->vblank_period * FRAME_SCHED_JITTER_FRACTION;
+
+    // A followed mapping is authoritative: catch up or wait rather than re-anchor
+    if (!s->following && fabs(target - vblank_time) > FRAME_SCHED_RESYNC_SECONDS) {
+        s->anchored = false;
+        s->resyncs++;
+        return FRAME_SCHED_SHOW;
+    }
+
+    if (target > vblank_time + tolerance) {
+        s->repeated++;
+        return FRAME_SCHED_REPEAT;
+    }
+
+    // The frame's whole display interval is already in the past
+    if (have_next && target + s->frame_duration <= vblank_time - tolerance) {
+        return FRAME_SCHED_DROP;
+    }
+
+    return FRAME_SCHED_SHOW;
+}
+
+void frame_sched_mark_shown(frame_scheduler_t *sched, int stream, double pts, double arrival,
+                            double vblank_time) {
+    if (!valid_stream(sched, stream)) return;
+
+    frame_sched_stream_t *s = &sched->streams[stream];
+    s->shown++;
+    if (arrival > 0.0 && vblank_time >= arrival) {
+        double latency = vblank_time - arrival;
+        s->latency_sum += latency;
+        if (latency > s->latency_max) s->latency_max = latency;
+        s->latency_samples++;
+    }
+    if (pts < 0.0) return;
+
+    if (pts > s->epoch_end_pts) {
+        s->epoch_end_pts = pts;
+    }
+    if (sched->clock_origin < 0.0) {
+        sched->clock_origin = vblank_time;
+    }
+    if (!s->anchored) {
+        if (s->start_at > 0.0) {
+            // Scheduled start or gapless continuation: frames after this one are
+            // due relative to start_at, whenever this one made it to the screen
+            s->anchor_pts = pts - (s->start_at - sched->clock_origin);
+            s->ever_anchored = true;
+            s->start_at = 0.0;
+        } else if (!s->ever_anchored) {
+            // Stream start: align with the clock origin so streams that start
+            // together stay lip-locked even if this one decoded its first frame late
+            s->anchor_pts = pts;
+            s->ever_anchored = true;
+        } else {
+            // Re-anchor after a loop/seek: map this frame onto the vblank it is shown at
+            s->anchor_pts = pts - (vblank_time - sched->clock_origin);
+        }
+        s->anchored = true;
+    }
+    s->last_shown_pts = pts;
+}
+
+void frame_sched_mark_dropped(frame_scheduler_t *sched, int stream) {
+    if (!valid_stream(sched, stream)) return;
+
+    sched->streams[stream].dropped++;
+}
+
+void frame_sched_set_continuous(frame_scheduler_t *sched, int stream, bool continuous) {
+    if (!valid_stream(sched, stream)) return;
+
+    sched->streams[stream].continuous = continuous;
+}
+
+void frame_sched_set_start(frame_scheduler_t *sched, int stream, double start_time) {
+    if (!valid_stream(sched, stream)) return;
+
+    sched->streams[stream].start_at = start_time > 0.0 ? start_time : 0.0;
+}
+
+bool frame_sched_get_timeline(const frame_scheduler_t *sched, int stream, unsigned int *epoch, double *base) {
+    if (!valid_stream(sched, stream)) return false;
+
+    const frame_sched_stream_t *s = &sched->streams[stream];
+    if (!s->anchored || sched->clock_origin < 0.0) {
+        return false;
+    }
+    if (epoch) *epoch = s->epoch;
+    if (base) *base = sched->clock_origin - s->anchor_pts;
+    return true;
+}
+
+void frame_sched_follow(frame_scheduler_t *sched, int stream, unsigned int epoch, double base, double now) {
+    // base is any finite value: it is negative whenever stream PTS exceeds the clock (MPEG-TS PCR)
+    if (!valid_stream(sched, stream) || !isfinite(base)) return;
+
+    frame_sched_stream_t *s = &sched->streams[stream];
+    if (!s->epoch_linked) {
+        s->epoch_offset = epoch - s->epoch;
+        s->epoch_linked = true;
+    }
+    if (s->epoch + s->epoch_offset != epoch) {
+        // One node already crossed a loop/item boundary; each continues gaplessly
+        // on its own until the other catches up
+        if (s->epoch_mismatch_since <= 0.0) {
+            s->epoch_mismatch_since = now;
+            return;
+        }
+        if (now - s->epoch_mismatch_since < FRAME_SCHED_RELINK_SECONDS) {
+            return;
+        }
+        s->epoch_offset = epoch - s->epoch;
+    }
+    s->epoch_mismatch_since = 0.0;
+
+    // Any origin works (anchor_pts absorbs it); a local clock time keeps it non-negative
+    if (sched->clock_origin < 0.0) {
+        sched->clock_origin = now;
+    }
+    s->anchor_pts = sched->clock_origin - base;
+    s->anchored = true;
+    s->ever_anchored = true;
+    s->following = true;
+    s->start_at = 0.0;
+}
+
+unsigned int frame_sched_take_latency(frame_scheduler_t *sched, int stream, double *avg, double *max) {
+    if (!valid_stream(sched, stream)) return 0;
+
+    frame_sched_stream_t *s = &sched->streams[stream];
+    unsigned int samples = s->latency_samples;
+    if (samples > 0) {
+        if (avg) *avg = s->latency_sum / samples;
+        if (max) *max = s->latency_max;
+    }
+    s->latency_sum = 0.0;
+    s->latency_max = 0.0;
+    s->latency_samples = 0;
+    return samples;
+}
+
+bool frame_sched_is_behind(const frame_scheduler_t *sched, int stream, double vblank_time) {
+    if (!valid_stream(sched, stream)) return false;
+
+    const frame_sched_stream_t *s = &sched->streams[stream];
+    if (!s->anchored || s->last_shown_pts < 0.0 || sched->clock_origin < 0.0) {
+        return false;
+    }
+
+    double shown_target = sched->clock_origin + (s->last_shown_pts - s->anchor_pts);
+    return shown_target + 2.0 * s->frame_duration < vblank_time;
+}
@@ -0,0 +1,100 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Presentation scheduler: maps stream PTS onto predicted vblank times and
+// decides per vblank whether each stream shows, repeats or drops a frame.
+// All streams share one presentation clock so they stay lip-locked.
+#define FRAME_SCHED_MAX_STREAMS 4
+#define FRAME_SCHED_MAX_CATCHUP 4   // Max frames decoded-and-dropped per vblank when behind
+
+typedef enum {
+    FRAME_SCHED_REPEAT = 0,  // Head frame not due yet - keep current frame on screen
+    FRAME_SCHED_SHOW,        // Head frame covers the upcoming vblank
+    FRAME_SCHED_DROP         // Head frame's interval ended before the vblank - skip it
+} frame_sched_action_t;
+
+typedef struct {
+    bool anchored;           // PTS-to-clock mapping established
+    bool ever_anchored;      // Has been anchored since init (first anchor is lip-locked)
+    double anchor_pts;       // PTS that maps to clock_origin
+    double frame_duration;   // Nominal frame interval (1/fps)
+    double last_shown_pts;
+
+    unsigned int shown;
+    unsigned int repeated;
+    unsigned int dropped;
+    unsigned int resyncs;
+
+    // Live sources (frame_sched_set_live_latency): frames whose receive time is more
+    // than live_latency before their vblank are stale and dropped, whatever their PTS
+    double live_latency;     // Seconds, 0 = PTS scheduling only
+    unsigned int stale_dropped;
+    double latency_sum;      // Receive-to-vblank of shown frames since the last report
+    double latency_max;
+    unsigned int latency_samples;
+
+    // Multi-node sync: the timeline is exchanged as "clock time of PTS 0" per
+    // epoch, where an epoch is the span between two discontinuities (loop,
+    // seek, playlist item). See frame_sched_get_timeline / frame_sched_follow.
+    unsigned int epoch;
+    double epoch_end_pts;    // Highest PTS seen this epoch (-1 if none)
+    bool continuous;         // A discontinuity continues the timeline one frame after the epoch ends
+    double start_at;         // Clock time the next anchor maps its PTS to (0 = the vblank it is shown at)
+    bool following;          // Mapping comes from another node: no local resync
+    bool epoch_linked;
+    unsigned int epoch_offset;  // Remote epoch minus local epoch
+    double epoch_mismatch_since; // Clock time the remote epoch stopped matching (0 = matching)
+} frame_sched_stream_t;
+
+typedef struct {
+    // Display timing (CLOCK_MONOTONIC seconds)
+    double vblank_period;    // Refined from page-flip timestamps
+    double last_vblank;      // Timestamp of the most recent flip event (<0 if none yet)
+    unsigned int last_vblank_seq;
+
+    double clock_origin;     // Presentation clock zero (<0 until the first frame is shown)
+    frame_sched_stream_t streams[FRAME_SCHED_MAX_STREAMS];
+} frame_scheduler_t;
+
+void frame_sched_init(frame_scheduler_t *sched, double refresh_hz);
+void frame_sched_set_frame_rate(frame_scheduler_t *sched, int stream, double fps);
+void frame_sched_reset_stream(frame_scheduler_t *sched, int stream);
+
+// Feed a page-flip completion (sequence + kernel timestamp)
+void frame_sched_on_vblank(frame_scheduler_t *sched, unsigned int seq, double timestamp);
+double frame_sched_next_vblank(const frame_scheduler_t *sched, double now);
+
+// Hold a live stream's receive-to-glass latency at target seconds (0 disables)
+void frame_sched_set_live_latency(frame_scheduler_t *sched, int stream, double target);
+
+// Decide what to do with a stream's next frame for the vblank at vblank_time.
+// have_next: another frame is available after this one (DROP is only returned if so)
+// arrival: the frame's receive time on the vblank clock (<=0 if unknown, e.g. files)
+frame_sched_action_t frame_sched_decide(frame_scheduler_t *sched, int stream, double pts, double arrival,
+                                        double vblank_time, bool have_next);
+void frame_sched_mark_shown(frame_scheduler_t *sched, int stream, double pts, double arrival,
+                            double vblank_time);
+void frame_sched_mark_dropped(frame_scheduler_t *sched, int stream);
+
+// Multi-node sync. set_continuous: loops and item switches keep the timeline
+// gapless instead of re-anchoring at the vblank the new epoch's first frame is
+// shown at, so every node computes the same mapping. set_start: the stream's
+// first frame maps to start_time. get_timeline / follow export and adopt the
+// mapping as (epoch, clock time of PTS 0); follow ignores a remote epoch that
+// differs from the local one unless the mismatch outlasts a loop boundary.
+void frame_sched_set_continuous(frame_scheduler_t *sched, int stream, bool continuous);
+void frame_sched_set_start(frame_scheduler_t *sched, int stream, double start_time);
+bool frame_sched_get_timeline(const frame_scheduler_t *sched, int stream, unsigned int *epoch, double *base);
+void frame_sched_follow(frame_scheduler_t *sched, int stream, unsigned int epoch, double base, double now);
+
+// Receive-to-vblank latency of the frames shown since the previous call, in seconds.
+// Returns the sample count (0: nothing measured, avg/max untouched) and resets.
+unsigned int frame_sched_take_latency(frame_scheduler_t *sched, int stream, double *avg, double *max);
+
+// True when the stream is far enough behind that decoding non-reference frames is wasted work
+bool frame_sched_is_behind(const frame_scheduler_t *sched, int stream, double vblank_time);
+
+#endif // FRAME_SCHEDULER_H
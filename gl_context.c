@@ -3,6 +3,10 @@
 #include "drm_display.h"
 #include "keystone.h"
 #include "video_decoder.h"
+#include "pixel_kernels.h"
+#include "logger.h"
+#include "startup_cache.h"
+#include "frame_memory.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,6 +14,8 @@
 #include <time.h>
 #include <pthread.h>
 #include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // PRODUCTION: Validate EGL context before critical operations
 static bool validate_egl_context(void) {
@@ -30,8 +36,8 @@ static void check_gl_errors(const char *operation) {
     }
 }
 
-// Double-buffered Pixel Buffer Objects for staging
-#define PBO_RING_COUNT 2
+// Pixel Buffer Object ring for staging (depth from PICKLE_PBO_RING, max PBO_RING_MAX)
+#define PBO_RING_DEFAULT 3
 #define PLANE_Y 0
 #define PLANE_U 1
 #define PLANE_V 2
@@ -40,40 +46,8 @@ static void check_gl_errors(const char *operation) {
 #define GL_MAP_UNSYNCHRONIZED_BIT 0x0040
 #endif
 
-// NEON SIMD optimization for stride copying on ARM
-#ifdef __ARM_NEON__
-    #include <arm_neon.h>
-    #define HAS_NEON 1
-#else
-    #define HAS_NEON 0
-#endif
-
-// OPTIMIZED: NEON-accelerated stride copy for YUV planes
-// Copies 'rows' rows of 'width' bytes from source to destination with strides
-static inline void copy_with_stride_simd(uint8_t *dst, const uint8_t *src,
-                                         int width, int height,
-                                         int dst_stride, int src_stride) {
-    #if HAS_NEON
-    int width_16 = (width / 16) * 16;
-    for (int row = 0; row < height; row++) {
-        uint8_t *s = (uint8_t *)src + (row * src_stride);
-        uint8_t *d = dst + (row * dst_stride);
-        for (int col = 0; col < width_16; col += 16) {
-            uint8x16_t data = vld1q_u8(s + col);
-            vst1q_u8(d + col, data);
-        }
-        memcpy(d + width_16, s + width_16, width - width_16);
-    }
-    #else
-    for (int row = 0; row < height; row++) {
-        memcpy(dst + (row * dst_stride), src + (row * src_stride), width);
-    }
-    #endif
-}
-
 // Forward declarations
-static void draw_char_simple(float *vertices, int *vertex_count, char c, float x, float y, float size);
-static void draw_text_simple(float *vertices, int *vertex_count, const char *text, float x, float y, float size);
+static void create_glyph_atlas(gl_context_t *gl);
 
 #ifndef GLeglImageOES
 typedef void* GLeglImageOES;
@@ -87,6 +61,26 @@ static eglCreateImageKHR_func eglCreateImageKHR = NULL;
 static glEGLImageTargetTexture2DOES_func glEGLImageTargetTexture2DOES = NULL;
 static eglDestroyImageKHR_func eglDestroyImageKHR = NULL;
 
+// EGL_ANDROID_native_fence_sync: export the render-complete fence as a sync_file FD
+// for the atomic commit's IN_FENCE_FD (sync handles kept as void* like EGLSyncKHR)
+typedef void* (*eglCreateSyncKHR_func)(EGLDisplay dpy, EGLenum type, const EGLint *attrib_list);
+typedef EGLBoolean (*eglDestroySyncKHR_func)(EGLDisplay dpy, void *sync);
+typedef EGLint (*eglDupNativeFenceFDANDROID_func)(EGLDisplay dpy, void *sync);
+
+static eglCreateSyncKHR_func eglCreateSyncKHR = NULL;
+static eglDestroySyncKHR_func eglDestroySyncKHR = NULL;
+static eglDupNativeFenceFDANDROID_func eglDupNativeFenceFDANDROID = NULL;
+
+#ifndef EGL_SYNC_NATIVE_FENCE_ANDROID
+#define EGL_SYNC_NATIVE_FENCE_ANDROID 0x3144
+#endif
+#ifndef EGL_SYNC_NATIVE_FENCE_FD_ANDROID
+#define EGL_SYNC_NATIVE_FENCE_FD_ANDROID 0x3145
+#endif
+#ifndef EGL_NO_NATIVE_FENCE_FD_ANDROID
+#define EGL_NO_NATIVE_FENCE_FD_ANDROID -1
+#endif
+
 #ifndef EGL_LINUX_DMA_BUF_EXT
 #define EGL_LINUX_DMA_BUF_EXT 0x3270
 #endif
@@ -123,6 +117,23 @@ static eglDestroyImageKHR_func eglDestroyImageKHR = NULL;
 #ifndef DRM_FORMAT_NV12
 #define DRM_FORMAT_NV12 0x3231564e
 #endif
+#ifndef DRM_FORMAT_P030
+#define DRM_FORMAT_P030 0x30333050  // 10-bit 4:2:0, three samples per 32 bits (SAND30)
+#endif
+#ifndef DRM_FORMAT_MOD_LINEAR
+#define DRM_FORMAT_MOD_LINEAR 0ULL
+#endif
+#ifndef DRM_FORMAT_MOD_INVALID
+#define DRM_FORMAT_MOD_INVALID 0x00ffffffffffffffULL
+#endif
+#ifndef EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT
+#define EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT 0x3443
+#define EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT 0x3444
+#define EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT 0x3445
+#define EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT 0x3446
+#define EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT 0x3447
+#define EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT 0x3448
+#endif
 #ifndef DRM_FORMAT_R8
 #define DRM_FORMAT_R8 0x20203852
 #endif
@@ -139,88 +150,334 @@ static eglDestroyImageKHR_func eglDestroyImageKHR = NULL;
 #define DRM_FORMAT_YUV420 0x32315559  // YU12
 #endif
 
-typedef struct {
-    uint8_t *y_temp_buffer;
-    uint8_t *u_temp_buffer;
-    uint8_t *v_temp_buffer;
-    int allocated_size;
-} yuv_temp_buffers_t;
-
-static yuv_temp_buffers_t g_yuv_buffers = {NULL, NULL, NULL, 0};
-
-static void allocate_yuv_buffers(int needed_size) {
-    // Only allocate if needed or size changed
-    if (g_yuv_buffers.allocated_size < needed_size) {
-        // Free old buffers if they exist
-        free(g_yuv_buffers.y_temp_buffer);
-        free(g_yuv_buffers.u_temp_buffer);
-        free(g_yuv_buffers.v_temp_buffer);
-        
-        // Allocate new buffers - allocate slightly larger to reduce reallocations
-        int alloc_size = needed_size * 1.2;  // 20% headroom
-        g_yuv_buffers.y_temp_buffer = malloc(alloc_size);
-        g_yuv_buffers.u_temp_buffer = malloc(alloc_size / 4);  // U/V are half size
-        g_yuv_buffers.v_temp_buffer = malloc(alloc_size / 4);
+static bool ensure_pbo_capacity(gl_context_t *gl, int plane, size_t required_size) {
+    if (!gl || plane < 0 || plane > 2 || required_size == 0) {
+        return false;
+    }
+
+    if (gl->pbo_size[plane] >= required_size) {
+        return true;
+    }
+
+    for (int i = 0; i < gl->pbo_ring_count; ++i) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->pbo[i][plane]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, required_size, NULL, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    gl->pbo_size[plane] = required_size;
+    return true;
+}
+
+static double pbo_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Poll every in-flight slot once (never blocks) and retire the ones the GPU finished
+static void pbo_retire_slots(gl_context_t *gl) {
+    for (int i = 0; i < gl->pbo_ring_count; i++) {
+        if (!gl->pbo_fences[i]) continue;
         
-        // Check for allocation failures (critical for production)
-        if (!g_yuv_buffers.y_temp_buffer || !g_yuv_buffers.u_temp_buffer || !g_yuv_buffers.v_temp_buffer) {
-            fprintf(stderr, "[GL] CRITICAL: Failed to allocate YUV temp buffers (%d bytes)\n", alloc_size);
-            free(g_yuv_buffers.y_temp_buffer);
-            free(g_yuv_buffers.u_temp_buffer);
-            free(g_yuv_buffers.v_temp_buffer);
-            g_yuv_buffers.y_temp_buffer = NULL;
-            g_yuv_buffers.u_temp_buffer = NULL;
-            g_yuv_buffers.v_temp_buffer = NULL;
-            g_yuv_buffers.allocated_size = 0;
-            return;  // Return without updating allocated_size to trigger fallback
+        GLenum result = glClientWaitSync(gl->pbo_fences[i], 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED) {
+            continue;
+        }
+        if (result == GL_WAIT_FAILED) {
+            // Can't prove the GPU is done with this slot; stop staging through PBOs
+            if (!gl->pbo_warned) {
+                fprintf(stderr, "[PBO] Warning: fence wait failed, falling back to direct upload\n");
+                gl->pbo_warned = true;
+            }
+            gl->use_pbo = false;
+            return;
         }
         
-        g_yuv_buffers.allocated_size = alloc_size;
-        if (g_yuv_buffers.y_temp_buffer && g_yuv_buffers.u_temp_buffer && g_yuv_buffers.v_temp_buffer) {
-            // printf("DEBUG: Pre-allocated YUV buffers: Y=%p U=%p V=%p (size %d)\n",
-            //        g_yuv_buffers.y_temp_buffer, g_yuv_buffers.u_temp_buffer, g_yuv_buffers.v_temp_buffer, alloc_size);
+        double now = pbo_now();
+        double retire_ms = (now - gl->pbo_fence_submit[i]) * 1000.0;
+        gl_pbo_stats_t *st = &gl->pbo_stats;
+        st->retire_ms_avg = (st->retire_ms_avg == 0.0) ? retire_ms
+                                                       : st->retire_ms_avg + (retire_ms - st->retire_ms_avg) * 0.1;
+        if (retire_ms > st->retire_ms_max) st->retire_ms_max = retire_ms;
+        st->last_retire_time = now;
+        
+        glDeleteSync(gl->pbo_fences[i]);
+        gl->pbo_fences[i] = 0;
+    }
+}
+
+// Pick the oldest retired slot, or -1 if the whole ring is still in flight
+static int pbo_find_free_slot(gl_context_t *gl) {
+    for (int i = 0; i < gl->pbo_ring_count; i++) {
+        int slot = (gl->pbo_index + i) % gl->pbo_ring_count;
+        if (!gl->pbo_fences[slot]) {
+            return slot;
         }
     }
+    return -1;
 }
 
-static void free_yuv_buffers(void) {
-    if (g_yuv_buffers.y_temp_buffer) {
-        free(g_yuv_buffers.y_temp_buffer);
-        g_yuv_buffers.y_temp_buffer = NULL;
+static int pbo_acquire_slot(gl_context_t *gl) {
+    pbo_retire_slots(gl);
+    if (!gl->use_pbo) {
+        return -1;
     }
-    if (g_yuv_buffers.u_temp_buffer) {
-        free(g_yuv_buffers.u_temp_buffer);
-        g_yuv_buffers.u_temp_buffer = NULL;
+    
+    int slot = pbo_find_free_slot(gl);
+    if (slot < 0) {
+        // Backpressure: upload directly this frame rather than overwrite memory the GPU reads
+        gl->pbo_stats.backpressure++;
     }
-    if (g_yuv_buffers.v_temp_buffer) {
-        free(g_yuv_buffers.v_temp_buffer);
-        g_yuv_buffers.v_temp_buffer = NULL;
+    return slot;
+}
+
+// Fence the slot after its glTexSubImage2D calls so it is reused only once consumed
+static void pbo_submit_slot(gl_context_t *gl, int slot) {
+    gl->pbo_fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    gl->pbo_fence_submit[slot] = pbo_now();
+    gl->pbo_index = (slot + 1) % gl->pbo_ring_count;
+    gl->pbo_stats.uploads++;
+}
+
+// Persistently mapped PBOs the software decoder writes frames into
+// (video_frame_allocator_t), so the render thread only issues glTexSubImage2D
+#define GL_FRAME_POOL_MAX 32
+
+#ifndef GL_MAP_PERSISTENT_BIT_EXT
+#define GL_MAP_PERSISTENT_BIT_EXT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT_EXT
+#define GL_MAP_COHERENT_BIT_EXT 0x0080
+#endif
+
+typedef void (*glBufferStorageEXT_func)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+typedef struct {
+    GLuint buffer;
+    uint8_t *map;        // Persistent CPU mapping
+    GLsync fence;        // Last upload sourced from this slot (render thread only)
+    bool in_use;         // Owned by a decoded AVFrame
+} gl_frame_pool_slot_t;
+
+struct gl_frame_pool {
+    pthread_mutex_t lock;
+    gl_frame_pool_slot_t slots[GL_FRAME_POOL_MAX];
+    int count;
+    size_t slot_size;
+    unsigned int allocs;
+    unsigned int exhausted;  // Decoder fell back to FFmpeg's allocator
+};
+
+int gl_frame_pool_init(gl_context_t *gl, int count, size_t slot_size) {
+    if (!gl || gl->frame_pool || count <= 0 || slot_size == 0) {
+        return -1;
+    }
+    if (count > GL_FRAME_POOL_MAX) count = GL_FRAME_POOL_MAX;
+    
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    glBufferStorageEXT_func glBufferStorageEXT = NULL;
+    if (extensions && strstr(extensions, "GL_EXT_buffer_storage")) {
+        glBufferStorageEXT = (glBufferStorageEXT_func)eglGetProcAddress("glBufferStorageEXT");
+    }
+    if (!glBufferStorageEXT) {
+        printf("[Render] GL_EXT_buffer_storage not available - decode-to-PBO disabled\n");
+        return -1;
+    }
+    
+    // Same budget as the decoder's CPU frame buffers
+    if (frame_memory_reserve((size_t)count * slot_size, "decode-to-PBO pool") != 0) {
+        return -1;
+    }
+    struct gl_frame_pool *pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        frame_memory_unreserve((size_t)count * slot_size);
+        return -1;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pool->slot_size = slot_size;
+    
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_READ_BIT |
+                             GL_MAP_PERSISTENT_BIT_EXT | GL_MAP_COHERENT_BIT_EXT;
+    for (int i = 0; i < count; i++) {
+        gl_frame_pool_slot_t *slot = &pool->slots[i];
+        glGenBuffers(1, &slot->buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot->buffer);
+        glBufferStorageEXT(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)slot_size, NULL, flags);
+        slot->map = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)slot_size, flags);
+        if (!slot->map) {
+            glDeleteBuffers(1, &slot->buffer);
+            slot->buffer = 0;
+            break;
+        }
+        pool->count++;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    frame_memory_unreserve((size_t)(count - pool->count) * slot_size);
+    
+    if (pool->count == 0) {
+        fprintf(stderr, "[Render] Failed to map decode-to-PBO buffers\n");
+        pthread_mutex_destroy(&pool->lock);
+        free(pool);
+        return -1;
+    }
+    
+    gl->frame_pool = pool;
+    printf("[Render] Decode-to-PBO pool: %d x %.1f MB persistently mapped\n",
+           pool->count, slot_size / (1024.0 * 1024.0));
+    return 0;
+}
+
+// Decoder threads: hand out a slot that no frame owns and no upload is reading
+uint8_t *gl_frame_pool_alloc(void *opaque, size_t size) {
+    struct gl_frame_pool *pool = (struct gl_frame_pool *)opaque;
+    if (!pool || size > pool->slot_size) {
+        return NULL;
+    }
+    
+    uint8_t *data = NULL;
+    pthread_mutex_lock(&pool->lock);
+    for (int i = 0; i < pool->count; i++) {
+        gl_frame_pool_slot_t *slot = &pool->slots[i];
+        if (!slot->in_use && !slot->fence) {
+            slot->in_use = true;
+            data = slot->map;
+            pool->allocs++;
+            break;
+        }
+    }
+    if (!data) {
+        pool->exhausted++;
     }
-    g_yuv_buffers.allocated_size = 0;
+    pthread_mutex_unlock(&pool->lock);
+    return data;
 }
 
-static bool ensure_pbo_capacity(gl_context_t *gl, int plane, size_t required_size) {
-    if (!gl || plane < 0 || plane > 2 || required_size == 0) {
-        return false;
+void gl_frame_pool_release(void *opaque, uint8_t *data) {
+    struct gl_frame_pool *pool = (struct gl_frame_pool *)opaque;
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->lock);
+    for (int i = 0; i < pool->count; i++) {
+        if (pool->slots[i].map == data) {
+            pool->slots[i].in_use = false;
+            break;
+        }
     }
+    pthread_mutex_unlock(&pool->lock);
+}
 
-    if (gl->pbo_size[plane] >= required_size) {
-        return true;
+static void frame_pool_retire(struct gl_frame_pool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    for (int i = 0; i < pool->count; i++) {
+        gl_frame_pool_slot_t *slot = &pool->slots[i];
+        if (slot->fence && glClientWaitSync(slot->fence, 0, 0) != GL_TIMEOUT_EXPIRED) {
+            glDeleteSync(slot->fence);
+            slot->fence = 0;
+        }
     }
+    pthread_mutex_unlock(&pool->lock);
+}
 
-    for (int i = 0; i < PBO_RING_COUNT; ++i) {
-        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, gl->pbo[i][plane]);
-        glBufferData(GL_PIXEL_UNPACK_BUFFER, required_size, NULL, GL_STREAM_DRAW);
+// Slot holding all three planes of a decoded frame, or -1 if not pool memory
+static int frame_pool_find(struct gl_frame_pool *pool, const uint8_t *y, const uint8_t *u,
+                           const uint8_t *v, size_t offsets[3]) {
+    for (int i = 0; i < pool->count; i++) {
+        const uint8_t *base = pool->slots[i].map;
+        const uint8_t *end = base + pool->slot_size;
+        if (y >= base && y < end && u >= base && u < end && v >= base && v < end) {
+            offsets[0] = (size_t)(y - base);
+            offsets[1] = (size_t)(u - base);
+            offsets[2] = (size_t)(v - base);
+            return i;
+        }
     }
+    return -1;
+}
+
+// Upload Y/U/V textures straight from the frame's own PBO (no CPU copy)
+static bool frame_pool_upload(gl_context_t *gl, GLuint tex_y, GLuint tex_u, GLuint tex_v,
+                              const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                              int width, int height, int y_stride, int u_stride, int v_stride) {
+    struct gl_frame_pool *pool = gl->frame_pool;
+    if (!pool) {
+        return false;
+    }
+    frame_pool_retire(pool);
+    
+    size_t offsets[3];
+    int index = frame_pool_find(pool, y, u, v, offsets);
+    if (index < 0) {
+        return false;
+    }
+    
+    const GLuint textures[3] = { tex_y, tex_u, tex_v };
+    const int strides[3] = { y_stride, u_stride, v_stride };
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pool->slots[index].buffer);
+    for (int p = 0; p < 3; p++) {
+        glActiveTexture(GL_TEXTURE0 + p);
+        glBindTexture(GL_TEXTURE_2D, textures[p]);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, strides[p]);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
+                        p == 0 ? width : width / 2, p == 0 ? height : height / 2,
+                        GL_RED, GL_UNSIGNED_BYTE, (const void *)(uintptr_t)offsets[p]);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-    gl->pbo_size[plane] = required_size;
+    
+    // The decoder must not get this slot back until the GPU has copied out of it
+    pthread_mutex_lock(&pool->lock);
+    if (pool->slots[index].fence) {
+        glDeleteSync(pool->slots[index].fence);
+    }
+    pool->slots[index].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pthread_mutex_unlock(&pool->lock);
     return true;
 }
 
-static bool upload_plane_with_pbo(gl_context_t *gl, int plane, const uint8_t *src,
+static void frame_pool_destroy(gl_context_t *gl) {
+    struct gl_frame_pool *pool = gl->frame_pool;
+    if (!pool) return;
+    
+    for (int i = 0; i < pool->count; i++) {
+        gl_frame_pool_slot_t *slot = &pool->slots[i];
+        if (slot->fence) glDeleteSync(slot->fence);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot->buffer);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glDeleteBuffers(1, &slot->buffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (hw_debug_enabled) {
+        printf("[Render] Decode-to-PBO: %u frames decoded in place, %u fell back\n",
+               pool->allocs, pool->exhausted);
+    }
+    frame_memory_unreserve((size_t)pool->count * pool->slot_size);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+    gl->frame_pool = NULL;
+}
+
+bool gl_pbo_backpressured(gl_context_t *gl) {
+    if (!gl || !gl->use_pbo) {
+        return false;
+    }
+    pbo_retire_slots(gl);
+    return gl->use_pbo && pbo_find_free_slot(gl) < 0;
+}
+
+void gl_get_pbo_stats(const gl_context_t *gl, gl_pbo_stats_t *out) {
+    if (!out) return;
+    if (!gl) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    *out = gl->pbo_stats;
+}
+
+// Stage one plane through a retired PBO slot and upload into the bound texture
+static bool upload_plane_with_pbo(gl_context_t *gl, int slot, int plane, const uint8_t *src,
                                   int width, int height, int bytes_per_pixel,
                                   int src_stride_bytes, GLenum gl_format) {
-    if (!gl || !src || width <= 0 || height <= 0 || bytes_per_pixel <= 0) {
+    if (!gl || !src || slot < 0 || width <= 0 || height <= 0 || bytes_per_pixel <= 0) {
         return false;
     }
 
@@ -230,36 +487,14 @@ static bool upload_plane_with_pbo(gl_context_t *gl, int plane, const uint8_t *sr
         return false;
     }
 
-    // Wait for fence if this PBO set is still in use by GPU
-    // Use non-blocking check to avoid stalling the CPU
-    if (gl->pbo_fences[gl->pbo_index]) {
-        GLenum result = glClientWaitSync(gl->pbo_fences[gl->pbo_index], 
-                                         0,  // flags: non-blocking check
-                                         0); // 0 timeout = non-blocking
-        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
-            // GPU is done with this PBO, safe to reuse
-            glDeleteSync(gl->pbo_fences[gl->pbo_index]);
-            gl->pbo_fences[gl->pbo_index] = 0;
-        } else if (result == GL_TIMEOUT_EXPIRED) {
-            // GPU still using this PBO - this is normal with double-buffering
-            // The GL_MAP_UNSYNCHRONIZED_BIT below allows us to proceed anyway
-        } else {
-            // GL_WAIT_FAILED - something went wrong
-            if (!gl->pbo_warned) {
-                fprintf(stderr, "[PBO] Warning: fence wait failed, falling back to direct upload\\n");
-                gl->pbo_warned = true;
-            }
-            return false;
-        }
-    }
-
     if (!ensure_pbo_capacity(gl, plane, total_bytes)) {
         return false;
     }
 
-    GLuint buffer = gl->pbo[gl->pbo_index][plane];
+    GLuint buffer = gl->pbo[slot][plane];
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
 
+    // Unsynchronized is safe: the slot's fence has signaled, so the GPU no longer reads it
     void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total_bytes,
                                  GL_MAP_WRITE_BIT |
                                  GL_MAP_INVALIDATE_BUFFER_BIT |
@@ -269,16 +504,7 @@ static bool upload_plane_with_pbo(gl_context_t *gl, int plane, const uint8_t *sr
         return false;
     }
 
-    if (src_stride_bytes == (int)row_bytes) {
-        memcpy(dst, src, total_bytes);
-    } else {
-        uint8_t *d = (uint8_t *)dst;
-        for (int row = 0; row < height; ++row) {
-            memcpy(d + row * row_bytes,
-                   src + (size_t)row * (size_t)src_stride_bytes,
-                   row_bytes);
-        }
-    }
+    pixel_copy_plane((uint8_t *)dst, (int)row_bytes, src, src_stride_bytes, (int)row_bytes, height);
 
     glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, gl_format, GL_UNSIGNED_BYTE, 0);
@@ -296,10 +522,12 @@ const char *vertex_shader_source =
     "layout(location = 0) in vec2 a_position;\n"
     "layout(location = 1) in vec2 a_texcoord;\n"
     "\n"
-    "// Legacy uniforms for compatibility\n"
-    "uniform mat4 u_mvp_matrix;\n"
-    "uniform mat4 u_keystone_matrix;\n"
-    "uniform float u_flip_y;\n"
+    "// Per-stream transform UBO (gl_transform_block_t)\n"
+    "layout(std140) uniform TransformMatrices {\n"
+    "    mat4 u_mvp_matrix;\n"
+    "    mat4 u_keystone_matrix;\n"
+    "    float u_flip_y;\n"
+    "};\n"
     "\n"
     "// Output to fragment shader\n"
     "out vec2 v_texcoord;\n"
@@ -321,7 +549,7 @@ const char *fragment_shader_source =
     "precision highp float;\n"  // KEEP highp for color accuracy
     "in vec2 v_texcoord;\n"
     "\n"
-    "// Legacy uniform samplers (for compatibility)\n"
+    "// Plane samplers (units fixed at link time)\n"
     "uniform sampler2D u_texture_y;\n"
     "uniform sampler2D u_texture_u;\n"
     "uniform sampler2D u_texture_v;\n"
@@ -388,6 +616,30 @@ const char *corner_fragment_shader_source =
     "    fragColor = v_color;\n"
     "}\n";
 
+// Textured overlay shaders: glyph atlas text and the cached overlay layer.
+// Both textures hold premultiplied color, tinted by u_color.
+const char *overlay_vertex_shader_source =
+    "#version 310 es\n"
+    "precision mediump float;\n"
+    "layout(location = 0) in vec2 a_position;\n"
+    "layout(location = 1) in vec2 a_texcoord;\n"
+    "out vec2 v_texcoord;\n"
+    "void main() {\n"
+    "    gl_Position = vec4(a_position, 0.0, 1.0);\n"
+    "    v_texcoord = a_texcoord;\n"
+    "}\n";
+
+const char *overlay_fragment_shader_source =
+    "#version 310 es\n"
+    "precision mediump float;\n"
+    "uniform sampler2D u_texture;\n"
+    "uniform vec4 u_color;\n"
+    "in vec2 v_texcoord;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    fragColor = texture(u_texture, v_texcoord) * u_color;\n"
+    "}\n";
+
 // External texture shader for zero-copy YUV EGLImage import
 // Uses GL_OES_EGL_image_external extension with samplerExternalOES
 // Note: ESSL 1.00 required for samplerExternalOES (not ESSL 3.x)
@@ -438,90 +690,167 @@ static GLuint compile_shader(GLenum type, const char *source) {
     return shader;
 }
 
-static int create_program(gl_context_t *gl) {
-    gl->vertex_shader = compile_shader(GL_VERTEX_SHADER, vertex_shader_source);
-    if (!gl->vertex_shader) return -1;
+// Program binaries are only valid for the exact driver build that produced them
+static const char *gl_driver_key(void) {
+    static char key[192];
+    if (!key[0]) {
+        const char *vendor = (const char *)glGetString(GL_VENDOR);
+        const char *renderer = (const char *)glGetString(GL_RENDERER);
+        const char *version = (const char *)glGetString(GL_VERSION);
+        snprintf(key, sizeof(key), "%s|%s|%s", vendor ? vendor : "?", renderer ? renderer : "?",
+                 version ? version : "?");
+    }
+    return key;
+}
 
-    gl->fragment_shader = compile_shader(GL_FRAGMENT_SHADER, fragment_shader_source);
-    if (!gl->fragment_shader) {
-        glDeleteShader(gl->vertex_shader);
-        return -1;
+static GLuint load_cached_program(const char *name, uint32_t source_hash) {
+    uint32_t format = 0;
+    int length = 0;
+    void *binary = startup_cache_get_program(name, gl_driver_key(), source_hash, &format, &length);
+    if (!binary) {
+        return 0;
+    }
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, (GLenum)format, binary, length);
+    free(binary);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        // Driver rejected it (e.g. Mesa updated without a version string change): recompile
+        glDeleteProgram(program);
+        printf("[CACHE] Cached %s program rejected by driver, recompiling\n", name);
+        return 0;
+    }
+    return program;
+}
+
+static void store_program_binary(const char *name, uint32_t source_hash, GLuint program) {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (formats <= 0 || length <= 0) {
+        return;
+    }
+    void *binary = malloc((size_t)length);
+    if (!binary) {
+        return;
+    }
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary);
+    if (glGetError() == GL_NO_ERROR && written > 0) {
+        startup_cache_put_program(name, gl_driver_key(), source_hash, format, binary, written);
+    }
+    free(binary);
+}
+
+// OPTIMIZATION: Compiling and linking all programs is a noticeable part of cold
+// start on V3D; a cached glProgramBinary skips both. Returns a linked program
+// with shaders already detached and deleted, or 0 (error logged).
+static GLuint build_program(const char *name, const char *vertex_source, const char *fragment_source,
+                            bool bind_quad_attribs) {
+    uint32_t source_hash = startup_cache_hash(vertex_source, fragment_source);
+    GLuint program = load_cached_program(name, source_hash);
+    if (program) {
+        return program;
     }
 
-    gl->program = glCreateProgram();
-    glAttachShader(gl->program, gl->vertex_shader);
-    glAttachShader(gl->program, gl->fragment_shader);
-    glLinkProgram(gl->program);
+    GLuint vertex_shader = compile_shader(GL_VERTEX_SHADER, vertex_source);
+    if (!vertex_shader) return 0;
+
+    GLuint fragment_shader = compile_shader(GL_FRAGMENT_SHADER, fragment_source);
+    if (!fragment_shader) {
+        glDeleteShader(vertex_shader);
+        return 0;
+    }
+
+    program = glCreateProgram();
+    glAttachShader(program, vertex_shader);
+    glAttachShader(program, fragment_shader);
+    if (bind_quad_attribs) {
+        // ESSL 1.00 has no layout qualifiers: pin the attributes to the quad VAO's locations
+        glBindAttribLocation(program, 0, "a_position");
+        glBindAttribLocation(program, 1, "a_texcoord");
+    }
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
 
     GLint linked;
-    glGetProgramiv(gl->program, GL_LINK_STATUS, &linked);
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
     if (!linked) {
         GLint length;
-        glGetProgramiv(gl->program, GL_INFO_LOG_LENGTH, &length);
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
         char *log = malloc(length);
-        glGetProgramInfoLog(gl->program, length, NULL, log);
-        fprintf(stderr, "Program linking failed: %s\n", log);
+        glGetProgramInfoLog(program, length, NULL, log);
+        fprintf(stderr, "[GL] %s program linking failed: %s\n", name, log);
         free(log);
-        glDeleteProgram(gl->program);
-        glDeleteShader(gl->vertex_shader);
-        glDeleteShader(gl->fragment_shader);
-        return -1;
+        glDeleteProgram(program);
+        return 0;
     }
 
+    store_program_binary(name, source_hash, program);
+    return program;
+}
+
+static int create_program(gl_context_t *gl) {
+    gl->program = build_program("video", vertex_shader_source, fragment_shader_source, false);
+    if (!gl->program) return -1;
+
     // Get uniform and attribute locations
-    gl->u_mvp_matrix = glGetUniformLocation(gl->program, "u_mvp_matrix");
     gl->u_texture_y = glGetUniformLocation(gl->program, "u_texture_y");
     gl->u_texture_u = glGetUniformLocation(gl->program, "u_texture_u");
     gl->u_texture_v = glGetUniformLocation(gl->program, "u_texture_v");
     gl->u_texture_nv12 = glGetUniformLocation(gl->program, "u_texture_nv12");
     gl->u_use_nv12 = glGetUniformLocation(gl->program, "u_use_nv12");
-    gl->u_keystone_matrix = glGetUniformLocation(gl->program, "u_keystone_matrix");
-    gl->u_flip_y = glGetUniformLocation(gl->program, "u_flip_y");
     gl->a_position = glGetAttribLocation(gl->program, "a_position");
     gl->a_texcoord = glGetAttribLocation(gl->program, "a_texcoord");
 
-    return 0;
-}
-
-static int create_corner_program(gl_context_t *gl) {
-    GLuint corner_vertex_shader = compile_shader(GL_VERTEX_SHADER, corner_vertex_shader_source);
-    if (!corner_vertex_shader) return -1;
-
-    GLuint corner_fragment_shader = compile_shader(GL_FRAGMENT_SHADER, corner_fragment_shader_source);
-    if (!corner_fragment_shader) {
-        glDeleteShader(corner_vertex_shader);
+    GLuint transform_block = glGetUniformBlockIndex(gl->program, "TransformMatrices");
+    if (transform_block == GL_INVALID_INDEX) {
+        fprintf(stderr, "Program has no TransformMatrices block\n");
         return -1;
     }
+    gl->transform_binding_point = 0;
+    glUniformBlockBinding(gl->program, transform_block, gl->transform_binding_point);
+
+    // Sampler uniforms never change, so they are not re-sent per draw
+    glUseProgram(gl->program);
+    glUniform1i(gl->u_texture_y, 0);
+    glUniform1i(gl->u_texture_u, 1);
+    glUniform1i(gl->u_texture_v, 2);
+    glUniform1i(gl->u_texture_nv12, 3);
+    glUseProgram(0);
 
-    gl->corner_program = glCreateProgram();
-    glAttachShader(gl->corner_program, corner_vertex_shader);
-    glAttachShader(gl->corner_program, corner_fragment_shader);
-    glLinkProgram(gl->corner_program);
+    return 0;
+}
 
-    GLint linked;
-    glGetProgramiv(gl->corner_program, GL_LINK_STATUS, &linked);
-    if (!linked) {
-        GLint length;
-        glGetProgramiv(gl->corner_program, GL_INFO_LOG_LENGTH, &length);
-        char *log = malloc(length);
-        glGetProgramInfoLog(gl->corner_program, length, NULL, log);
-        fprintf(stderr, "Corner program linking failed: %s\n", log);
-        free(log);
-        glDeleteProgram(gl->corner_program);
-        glDeleteShader(corner_vertex_shader);
-        glDeleteShader(corner_fragment_shader);
-        return -1;
-    }
+static int create_corner_program(gl_context_t *gl) {
+    gl->corner_program = build_program("corner", corner_vertex_shader_source,
+                                       corner_fragment_shader_source, false);
+    if (!gl->corner_program) return -1;
 
     // Get uniform and attribute locations for corner rendering
     gl->corner_u_mvp_matrix = glGetUniformLocation(gl->corner_program, "u_mvp_matrix");
     gl->corner_u_color = glGetUniformLocation(gl->corner_program, "u_color");
     gl->corner_a_position = glGetAttribLocation(gl->corner_program, "a_position");
 
-    // Clean up shaders (they're linked into the program now)
-    glDeleteShader(corner_vertex_shader);
-    glDeleteShader(corner_fragment_shader);
+    return 0;
+}
+
+static int create_overlay_program(gl_context_t *gl) {
+    gl->overlay_program = build_program("overlay", overlay_vertex_shader_source,
+                                        overlay_fragment_shader_source, false);
+    if (!gl->overlay_program) return -1;
 
+    gl->overlay_u_color = glGetUniformLocation(gl->overlay_program, "u_color");
+    gl->overlay_u_texture = glGetUniformLocation(gl->overlay_program, "u_texture");
+    glUseProgram(gl->overlay_program);
+    glUniform1i(gl->overlay_u_texture, GL_OVERLAY_TEXTURE_UNIT);
+    glUseProgram(0);
     return 0;
 }
 
@@ -534,39 +863,9 @@ static int create_external_program(gl_context_t *gl) {
         return 0;  // Not an error, just not supported
     }
 
-    GLuint ext_vertex_shader = compile_shader(GL_VERTEX_SHADER, external_vertex_shader_source);
-    if (!ext_vertex_shader) {
-        fprintf(stderr, "[GL] Failed to compile external vertex shader\n");
-        gl->supports_external_texture = false;
-        return 0;
-    }
-
-    GLuint ext_fragment_shader = compile_shader(GL_FRAGMENT_SHADER, external_fragment_shader_source);
-    if (!ext_fragment_shader) {
-        fprintf(stderr, "[GL] Failed to compile external fragment shader\n");
-        glDeleteShader(ext_vertex_shader);
-        gl->supports_external_texture = false;
-        return 0;
-    }
-
-    gl->external_program = glCreateProgram();
-    glAttachShader(gl->external_program, ext_vertex_shader);
-    glAttachShader(gl->external_program, ext_fragment_shader);
-    glLinkProgram(gl->external_program);
-
-    GLint linked;
-    glGetProgramiv(gl->external_program, GL_LINK_STATUS, &linked);
-    if (!linked) {
-        GLint length;
-        glGetProgramiv(gl->external_program, GL_INFO_LOG_LENGTH, &length);
-        char *log = malloc(length);
-        glGetProgramInfoLog(gl->external_program, length, NULL, log);
-        fprintf(stderr, "[GL] External program linking failed: %s\n", log);
-        free(log);
-        glDeleteProgram(gl->external_program);
-        glDeleteShader(ext_vertex_shader);
-        glDeleteShader(ext_fragment_shader);
-        gl->external_program = 0;
+    gl->external_program = build_program("external", external_vertex_shader_source,
+                                         external_fragment_shader_source, true);
+    if (!gl->external_program) {
         gl->supports_external_texture = false;
         return 0;
     }
@@ -577,13 +876,10 @@ static int create_external_program(gl_context_t *gl) {
     gl->ext_u_flip_y = glGetUniformLocation(gl->external_program, "u_flip_y");
     gl->ext_u_texture_external = glGetUniformLocation(gl->external_program, "u_texture_external");
 
-    // Clean up shaders
-    glDeleteShader(ext_vertex_shader);
-    glDeleteShader(ext_fragment_shader);
-
     // Create external textures
-    glGenTextures(1, &gl->texture_external);
-    glGenTextures(1, &gl->texture_external2);
+    for (int i = 0; i < GL_MAX_STREAMS; i++) {
+        glGenTextures(1, &gl->streams[i].texture_external);
+    }
 
     gl->supports_external_texture = true;
     printf("[GL] External texture program created (GL_OES_EGL_image_external)\n");
@@ -697,15 +993,32 @@ int gl_init(gl_context_t *gl, display_ctx_t *drm) {
         } else if (hw_debug_enabled) {
             printf("[EGL] ✓ Extension functions loaded successfully\n");
         }
+
+        // Explicit modifiers are needed for the HEVC decoder's SAND column layouts
+        gl->supports_dma_modifiers = strstr(egl_extensions, "EGL_EXT_image_dma_buf_import_modifiers") != NULL;
     } else if (hw_debug_enabled) {
         printf("[EGL] DMA buffer import NOT supported, using standard texture upload\n");
     }
     
-    // Initialize EGL image handles
-    gl->egl_image_y = EGL_NO_IMAGE;
-    gl->egl_image_uv = EGL_NO_IMAGE;
-    gl->egl_image_y2 = EGL_NO_IMAGE;
-    gl->egl_image_uv2 = EGL_NO_IMAGE;
+    // Native fence export lets atomic KMS wait on the GPU instead of the CPU
+    gl->supports_native_fence = false;
+    if (egl_extensions && strstr(egl_extensions, "EGL_ANDROID_native_fence_sync") &&
+        strstr(egl_extensions, "EGL_KHR_fence_sync")) {
+        eglCreateSyncKHR = (eglCreateSyncKHR_func)eglGetProcAddress("eglCreateSyncKHR");
+        eglDestroySyncKHR = (eglDestroySyncKHR_func)eglGetProcAddress("eglDestroySyncKHR");
+        eglDupNativeFenceFDANDROID = (eglDupNativeFenceFDANDROID_func)eglGetProcAddress("eglDupNativeFenceFDANDROID");
+        gl->supports_native_fence = eglCreateSyncKHR && eglDestroySyncKHR && eglDupNativeFenceFDANDROID;
+        if (hw_debug_enabled) {
+            printf("[EGL] Native fence sync %s\n", gl->supports_native_fence ? "available" : "failed to load");
+        }
+    }
+    
+    for (int i = 0; i < GL_MAX_STREAMS; i++) {
+        gl->streams[i].ext_uncached_image = EGL_NO_IMAGE;
+    }
+    gl->state.use_nv12 = -1;
+    gl->state.ext_uniform_stream = -1;
+    gl->state.ext_sampler_unit = -1;
 
     // Create shaders and program
     if (create_program(gl) != 0) {
@@ -719,25 +1032,40 @@ int gl_init(gl_context_t *gl, display_ctx_t *drm) {
         return -1;
     }
 
+    // Text and overlay layer program
+    if (create_overlay_program(gl) != 0) {
+        gl_cleanup(gl);
+        return -1;
+    }
+
     // Create external texture program (for zero-copy YUV import)
     create_external_program(gl);  // Non-fatal if unsupported
 
-    // Initialize PBOs for async texture uploads (double-buffered per plane)
+    // Initialize PBOs for async texture uploads (N-deep ring, one fence per slot)
     // DISABLED BY DEFAULT: Use only if PICKLE_ENABLE_PBO=1 (profiling builds)
     memset(gl->pbo, 0, sizeof(gl->pbo));
     memset(gl->pbo_size, 0, sizeof(gl->pbo_size));
+    memset(gl->pbo_fences, 0, sizeof(gl->pbo_fences));
+    memset(&gl->pbo_stats, 0, sizeof(gl->pbo_stats));
     gl->pbo_index = 0;
     gl->pbo_warned = false;
-    for (int i = 0; i < PBO_RING_COUNT; i++) {
-        gl->pbo_fences[i] = 0;
+    gl->pbo_ring_count = PBO_RING_DEFAULT;
+    const char *ring_env = getenv("PICKLE_PBO_RING");
+    if (ring_env) {
+        int depth = atoi(ring_env);
+        if (depth >= 2 && depth <= PBO_RING_MAX) {
+            gl->pbo_ring_count = depth;
+        } else {
+            fprintf(stderr, "[Render] Ignoring PICKLE_PBO_RING=%s (valid: 2-%d)\n", ring_env, PBO_RING_MAX);
+        }
     }
-    // PRODUCTION: PBOs disabled by default due to flickering issues with fence synchronization
-    // Enable with PICKLE_ENABLE_PBO=1 for testing (requires more work on sync)
+    // PRODUCTION: PBOs disabled by default until validated on all content
+    // Enable with PICKLE_ENABLE_PBO=1
     const char *enable_pbo = getenv("PICKLE_ENABLE_PBO");
     gl->use_pbo = (enable_pbo && enable_pbo[0] == '1');  // Default: disabled
     if (gl->use_pbo) {
-        glGenBuffers(PBO_RING_COUNT * 3, &gl->pbo[0][0]);
-        printf("[Render] PBO async uploads enabled (PICKLE_ENABLE_PBO=1)\n");
+        glGenBuffers(gl->pbo_ring_count * 3, &gl->pbo[0][0]);
+        printf("[Render] PBO async uploads enabled (PICKLE_ENABLE_PBO=1, %d-slot ring)\n", gl->pbo_ring_count);
     } else {
         printf("[Render] Using direct glTexSubImage2D uploads (stable baseline)\n");
     }
@@ -773,6 +1101,15 @@ static void calculate_aspect_ratio_matrix(float *mvp_matrix,
     // else: aspects match perfectly, no scaling needed (identity matrix)
 }
 
+static void create_video_texture(GLuint *texture) {
+    glGenTextures(1, texture);
+    glBindTexture(GL_TEXTURE_2D, *texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
 void gl_setup_buffers(gl_context_t *gl) {
     // Quad vertices (position + texture coordinates)  
     float vertices[] = {
@@ -792,7 +1129,10 @@ void gl_setup_buffers(gl_context_t *gl) {
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
-    // Generate and bind VBO (no VAO for compatibility)
+    // The video quad's attribute setup lives in a VAO, so draws only rebind it
+    glGenVertexArrays(1, &gl->vao);
+    glBindVertexArray(gl->vao);
+
     glGenBuffers(1, &gl->vbo);
     glBindBuffer(GL_ARRAY_BUFFER, gl->vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
@@ -802,73 +1142,43 @@ void gl_setup_buffers(gl_context_t *gl) {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl->ebo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
-    // Store for later use - don't set attributes here since no VAO
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
 
-    // Generate YUV textures for video 1
-    glGenTextures(1, &gl->texture_y);
-    glGenTextures(1, &gl->texture_u);
-    glGenTextures(1, &gl->texture_v);
-    glGenTextures(1, &gl->texture_nv12);
-    glGenTextures(1, &gl->texture_nv12_2);
-    
-    // Generate YUV textures for video 2
-    glGenTextures(1, &gl->texture_y2);
-    glGenTextures(1, &gl->texture_u2);
-    glGenTextures(1, &gl->texture_v2);
-    
-    // Setup Y texture (video 1)
-    glBindTexture(GL_TEXTURE_2D, gl->texture_y);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    
-    // Setup U texture (video 1)
-    glBindTexture(GL_TEXTURE_2D, gl->texture_u);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    
-    // Setup V texture (video 1)
-    glBindTexture(GL_TEXTURE_2D, gl->texture_v);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    
-    // Setup Y texture (video 2)
-    glBindTexture(GL_TEXTURE_2D, gl->texture_y2);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    
-    // Setup U texture (video 2)
-    glBindTexture(GL_TEXTURE_2D, gl->texture_u2);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    
-    // Setup V texture (video 2)
-    glBindTexture(GL_TEXTURE_2D, gl->texture_v2);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    
-    // Setup NV12 UV textures (interleaved U/V planes)
-    glBindTexture(GL_TEXTURE_2D, gl->texture_nv12);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_2D, gl->texture_nv12_2);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // Overlays set their attributes on the default VAO
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    gl->state.vao = 0;
+
+    // One sampler object for every video texture unit replaces per-texture parameters
+    glGenSamplers(1, &gl->video_sampler);
+    glSamplerParameteri(gl->video_sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glSamplerParameteri(gl->video_sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glSamplerParameteri(gl->video_sampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(gl->video_sampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    for (GLuint unit = 0; unit < GL_MAX_STREAMS; unit++) {
+        glBindSampler(unit, gl->video_sampler);
+    }
+
+    // Per-stream transform UBOs, written on first use
+    for (int i = 0; i < GL_MAX_STREAMS; i++) {
+        glGenBuffers(1, &gl->streams[i].transform_ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, gl->streams[i].transform_ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(gl_transform_block_t), NULL, GL_DYNAMIC_DRAW);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Generate per-stream YUV and NV12 textures
+    for (int i = 0; i < GL_MAX_STREAMS; i++) {
+        gl_stream_t *stream = &gl->streams[i];
+        GLuint *textures[] = { &stream->texture_y, &stream->texture_u,
+                               &stream->texture_v, &stream->texture_nv12 };
+        for (size_t t = 0; t < sizeof(textures) / sizeof(textures[0]); t++) {
+            create_video_texture(textures[t]);
+        }
+    }
     
     // Setup corner highlight VBO - will be updated with actual corner positions
     glGenBuffers(1, &gl->corner_vbo);
@@ -878,9 +1188,133 @@ void gl_setup_buffers(gl_context_t *gl) {
     
     // Setup help overlay VBO - will be updated with help overlay geometry
     glGenBuffers(1, &gl->help_vbo);
-    
-    // Modern ES 3.1 UBO setup (disabled for compatibility)
-    // setup_uniform_buffers(gl);
+
+    // Text quads are rebuilt only when the overlay layer is redrawn
+    glGenBuffers(1, &gl->text_vbo);
+    create_glyph_atlas(gl);
+}
+
+// Switch to an overlay program. Overlays use the default VAO and change blend
+// and depth state, so the next video draw re-establishes its raster state.
+static void bind_program(gl_context_t *gl, GLuint program) {
+    if (gl->state.program != program) {
+        glUseProgram(program);
+        gl->state.program = program;
+    }
+    if (gl->state.vao != 0) {
+        glBindVertexArray(0);
+        gl->state.vao = 0;
+    }
+    gl->state.video_raster = false;
+}
+
+// Straight-alpha blending for overlay geometry. Inside the overlay layer the
+// destination alpha must accumulate coverage too, which leaves the layer
+// premultiplied for gl_overlay_composite().
+static void set_overlay_blend(gl_context_t *gl) {
+    glEnable(GL_BLEND);
+    if (gl->overlay.recording) {
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    } else {
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+}
+
+// Program, quad VAO and raster state for a video draw (gl->program or external_program)
+static void bind_video_program(gl_context_t *gl, GLuint program) {
+    if (gl->state.program != program) {
+        glUseProgram(program);
+        gl->state.program = program;
+    }
+    if (gl->state.vao != gl->vao) {
+        glBindVertexArray(gl->vao);
+        gl->state.vao = gl->vao;
+    }
+    if (!gl->state.video_raster) {
+        // Overlays leave blending (and sometimes depth test) on
+        glDisable(GL_BLEND);
+        glDisable(GL_DEPTH_TEST);
+        gl->state.video_raster = true;
+    }
+}
+
+static void set_viewport(gl_context_t *gl, int width, int height) {
+    if (gl->state.viewport_width != width || gl->state.viewport_height != height) {
+        glViewport(0, 0, width, height);
+        gl->state.viewport_width = width;
+        gl->state.viewport_height = height;
+    }
+}
+
+static void set_use_nv12(gl_context_t *gl, int use_nv12) {
+    if (gl->u_use_nv12 >= 0 && gl->state.use_nv12 != use_nv12) {
+        glUniform1i(gl->u_use_nv12, use_nv12);
+        gl->state.use_nv12 = use_nv12;
+    }
+}
+
+// Recompute a stream's MVP/keystone block only when one of its inputs changed
+// and push it to the stream's UBO. keystone_get_matrix() applies pending edits.
+static gl_stream_t *update_stream_transform(gl_context_t *gl, int video_index, keystone_context_t *keystone,
+                                            int width, int height, int display_width, int display_height) {
+    gl_stream_t *stream = &gl->streams[video_index];
+    const float *keystone_matrix = keystone_get_matrix(keystone);
+
+    if (stream->transform_serial != 0 &&
+        stream->transform_keystone == keystone &&
+        stream->transform_keystone_version == keystone->matrix_version &&
+        stream->transform_width == width && stream->transform_height == height &&
+        stream->transform_display_width == display_width &&
+        stream->transform_display_height == display_height) {
+        return stream;
+    }
+
+    calculate_aspect_ratio_matrix(stream->transform.mvp, width, height, display_width, display_height);
+    memcpy(stream->transform.keystone, keystone_matrix, sizeof(stream->transform.keystone));
+    stream->transform.flip_y = 1.0f;  // Both decode paths deliver frames upside down
+
+    stream->transform_keystone = keystone;
+    stream->transform_keystone_version = keystone->matrix_version;
+    stream->transform_width = width;
+    stream->transform_height = height;
+    stream->transform_display_width = display_width;
+    stream->transform_display_height = display_height;
+    stream->transform_serial++;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, stream->transform_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(stream->transform), &stream->transform);
+    return stream;
+}
+
+static void bind_stream_transform(gl_context_t *gl, const gl_stream_t *stream) {
+    if (gl->state.transform_ubo != stream->transform_ubo) {
+        glBindBufferBase(GL_UNIFORM_BUFFER, gl->transform_binding_point, stream->transform_ubo);
+        gl->state.transform_ubo = stream->transform_ubo;
+    }
+}
+
+// gl->program draws sample GL_TEXTURE_2D; drop external textures the zero-copy path left bound
+static void unbind_external_textures(gl_context_t *gl) {
+    if (!gl->state.external_bound) {
+        return;
+    }
+    for (int unit = 0; unit < GL_MAX_STREAMS; unit++) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_EXTERNAL_OES, 0);
+    }
+    gl->state.external_bound = false;
+}
+
+// Common setup for the gl->program (planar/NV12) video draws
+static void bind_yuv_draw(gl_context_t *gl, int video_index, keystone_context_t *keystone,
+                          int width, int height, int display_width, int display_height, int use_nv12) {
+    set_viewport(gl, display_width, display_height);
+    bind_video_program(gl, gl->program);
+    unbind_external_textures(gl);
+    set_use_nv12(gl, use_nv12);
+    gl_stream_t *stream = update_stream_transform(gl, video_index, keystone, width, height,
+                                                  display_width, display_height);
+    bind_stream_transform(gl, stream);
 }
 
 // Helper function to upload NV12 data to GPU
@@ -888,17 +1322,19 @@ void gl_render_nv12(gl_context_t *gl, uint8_t *nv12_data, int width, int height,
                     display_ctx_t *drm, keystone_context_t *keystone, bool clear_screen, int video_index) {
     // PRODUCTION: Validate EGL context before rendering
     if (!validate_egl_context()) {
-        fprintf(stderr, "ERROR: Cannot render NV12 - EGL context lost\n");
+        LOG_ERROR_RATELIMITED("ERROR: Cannot render NV12 - EGL context lost\n");
         return;
     }
     
-    static int frame_rendered[2] = {0, 0};
-    static int last_width[2] = {0, 0};
-    static int last_height[2] = {0, 0};
-    static bool gl_state_set = false;
+    static int frame_rendered[GL_MAX_STREAMS] = {0};
+    static int last_width[GL_MAX_STREAMS] = {0};
+    static int last_height[GL_MAX_STREAMS] = {0};
 
-    GLuint tex_y = (video_index == 0) ? gl->texture_y : gl->texture_y2;
-    GLuint tex_uv = (video_index == 0) ? gl->texture_nv12 : gl->texture_nv12_2;
+    if (video_index < 0 || video_index >= GL_MAX_STREAMS) {
+        return;
+    }
+    GLuint tex_y = gl->streams[video_index].texture_y;
+    GLuint tex_uv = gl->streams[video_index].texture_nv12;
 
     if (frame_rendered[video_index] == 0) {
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -908,55 +1344,14 @@ void gl_render_nv12(gl_context_t *gl, uint8_t *nv12_data, int width, int height,
         glClear(GL_COLOR_BUFFER_BIT);
     }
 
-    if (!gl_state_set) {
-        glViewport(0, 0, drm->width, drm->height);
-        gl_state_set = true;
-    }
-
-    if (video_index == 0) {
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-        glUseProgram(0);
-        glDisableVertexAttribArray(0);
-        glDisableVertexAttribArray(1);
-
-        glUseProgram(gl->program);
-        glBindBuffer(GL_ARRAY_BUFFER, gl->vbo);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl->ebo);
-
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        glDisable(GL_BLEND);
-        glDisable(GL_DEPTH_TEST);
-    }
-
-    float mvp_matrix[16];
-    calculate_aspect_ratio_matrix(mvp_matrix, width, height, drm->width, drm->height);
-    glUniformMatrix4fv(gl->u_mvp_matrix, 1, GL_FALSE, mvp_matrix);
-
-    const float *keystone_matrix = keystone_get_matrix(keystone);
-    glUniformMatrix4fv(gl->u_keystone_matrix, 1, GL_FALSE, keystone_matrix);
-    glUniform1f(gl->u_flip_y, 1.0f);
-    if (gl->u_use_nv12 >= 0) {
-        glUniform1i(gl->u_use_nv12, 1);
-    }
+    bind_yuv_draw(gl, video_index, keystone, width, height, drm->width, drm->height, 1);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, tex_y);
-    glActiveTexture(GL_TEXTURE1);
+    glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, tex_uv);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, 0);
     glActiveTexture(GL_TEXTURE0);
 
-    glUniform1i(gl->u_texture_y, 0);
-    glUniform1i(gl->u_texture_nv12, 1);
-    glUniform1i(gl->u_texture_u, 2);
-    glUniform1i(gl->u_texture_v, 3);
-
     if (nv12_data) {
         bool size_changed = (width != last_width[video_index] ||
                              height != last_height[video_index] ||
@@ -973,27 +1368,28 @@ void gl_render_nv12(gl_context_t *gl, uint8_t *nv12_data, int width, int height,
             glBindTexture(GL_TEXTURE_2D, tex_y);
             glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
 
-            glActiveTexture(GL_TEXTURE1);
+            glActiveTexture(GL_TEXTURE3);
             glBindTexture(GL_TEXTURE_2D, tex_uv);
             glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, uv_width, uv_height, 0, GL_RG, GL_UNSIGNED_BYTE, NULL);
         }
 
         bool pbo_uploaded = false;
-        if (gl->use_pbo) {
+        int pbo_slot = gl->use_pbo ? pbo_acquire_slot(gl) : -1;
+        if (pbo_slot >= 0) {
             glActiveTexture(GL_TEXTURE0);
             glBindTexture(GL_TEXTURE_2D, tex_y);
-            bool y_ok = upload_plane_with_pbo(gl, PLANE_Y, y_plane, width, height, 1, y_stride, GL_RED);
+            bool y_ok = upload_plane_with_pbo(gl, pbo_slot, PLANE_Y, y_plane, width, height, 1, y_stride, GL_RED);
 
-            glActiveTexture(GL_TEXTURE1);
+            glActiveTexture(GL_TEXTURE3);
             glBindTexture(GL_TEXTURE_2D, tex_uv);
             int uv_row_bytes = width; // two bytes per UV sample (GL_RG)
-            bool uv_ok = upload_plane_with_pbo(gl, PLANE_U, uv_plane, uv_width, uv_height, 2, uv_row_bytes, GL_RG);
+            bool uv_ok = upload_plane_with_pbo(gl, pbo_slot, PLANE_U, uv_plane, uv_width, uv_height, 2, uv_row_bytes, GL_RG);
 
             pbo_uploaded = y_ok && uv_ok;
             if (!pbo_uploaded) {
                 gl->use_pbo = false;
                 if (!gl->pbo_warned) {
-                    printf("[Render] Disabling PBO staging (falling back to direct uploads)\n");
+                    LOG_INFO("[Render] Disabling PBO staging (falling back to direct uploads)\n");
                     gl->pbo_warned = true;
                 }
             }
@@ -1004,7 +1400,7 @@ void gl_render_nv12(gl_context_t *gl, uint8_t *nv12_data, int width, int height,
             glBindTexture(GL_TEXTURE_2D, tex_y);
             glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, y_plane);
 
-            glActiveTexture(GL_TEXTURE1);
+            glActiveTexture(GL_TEXTURE3);
             glBindTexture(GL_TEXTURE_2D, tex_uv);
             glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, uv_width, uv_height, GL_RG, GL_UNSIGNED_BYTE, uv_plane);
         }
@@ -1012,14 +1408,8 @@ void gl_render_nv12(gl_context_t *gl, uint8_t *nv12_data, int width, int height,
         last_width[video_index] = width;
         last_height[video_index] = height;
         frame_rendered[video_index]++;
-        if (gl->use_pbo && pbo_uploaded) {
-            // Create fence for the current PBO set
-            if (gl->pbo_fences[gl->pbo_index]) {
-                glDeleteSync(gl->pbo_fences[gl->pbo_index]);
-            }
-            gl->pbo_fences[gl->pbo_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
-
-            gl->pbo_index = (gl->pbo_index + 1) % PBO_RING_COUNT;
+        if (pbo_uploaded) {
+            pbo_submit_slot(gl, pbo_slot);
         }
     }
 
@@ -1033,20 +1423,22 @@ void gl_render_frame(gl_context_t *gl, uint8_t *y_data, uint8_t *u_data, uint8_t
                     display_ctx_t *drm, keystone_context_t *keystone, bool clear_screen, int video_index) {
     // PRODUCTION: Validate EGL context before rendering
     if (!validate_egl_context()) {
-        fprintf(stderr, "ERROR: Cannot render - EGL context lost\n");
+        LOG_ERROR_RATELIMITED("ERROR: Cannot render - EGL context lost\n");
         return;
     }
     
     // Separate tracking for each video
-    static int frame_rendered[2] = {0, 0};
-    static int last_width[2] = {0, 0};
-    static int last_height[2] = {0, 0};
-    static bool gl_state_set = false;
+    static int frame_rendered[GL_MAX_STREAMS] = {0};
+    static int last_width[GL_MAX_STREAMS] = {0};
+    static int last_height[GL_MAX_STREAMS] = {0};
     
-    // Select appropriate texture set based on video index
-    GLuint tex_y = (video_index == 0) ? gl->texture_y : gl->texture_y2;
-    GLuint tex_u = (video_index == 0) ? gl->texture_u : gl->texture_u2;
-    GLuint tex_v = (video_index == 0) ? gl->texture_v : gl->texture_v2;
+    // Select this stream's texture set
+    if (video_index < 0 || video_index >= GL_MAX_STREAMS) {
+        return;
+    }
+    GLuint tex_y = gl->streams[video_index].texture_y;
+    GLuint tex_u = gl->streams[video_index].texture_u;
+    GLuint tex_v = gl->streams[video_index].texture_v;
     
     // Handle stride for YUV data with potential padding
     
@@ -1060,57 +1452,10 @@ void gl_render_frame(gl_context_t *gl, uint8_t *y_data, uint8_t *u_data, uint8_t
         glClear(GL_COLOR_BUFFER_BIT);
     }
     
-    // Set up OpenGL state only once or when needed
-    if (!gl_state_set) {
-        glViewport(0, 0, drm->width, drm->height);
-        gl_state_set = true;
-    }
+    // Program, VAO, viewport and this stream's transform UBO; each is a no-op when current
+    bind_yuv_draw(gl, video_index, keystone, width, height, drm->width, drm->height, 0);
     
-    // CRITICAL: Always set up shader program - external_program may have been used by video 1 HW decode
-    // This ensures gl_render_frame uses the correct program regardless of what rendered before it
-    glUseProgram(gl->program);
-    glBindBuffer(GL_ARRAY_BUFFER, gl->vbo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl->ebo);
-
-    // Position attribute
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Texture coordinate attribute
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // Explicitly disable blending - overlays might have enabled it
-    glDisable(GL_BLEND);
-
-    // Disable depth test - make sure video is always visible
-    glDisable(GL_DEPTH_TEST);
-
-    // CRITICAL: Unbind any external textures that may have been bound by HW decode path
-    // This prevents GL_TEXTURE_EXTERNAL_OES from interfering with GL_TEXTURE_2D
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_EXTERNAL_OES, 0);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_EXTERNAL_OES, 0);
-
-    // Set MVP matrix with aspect ratio preservation (recalculate for each video!)
-    // This is OUTSIDE the video_index==0 block so each video gets its own aspect ratio
-    float mvp_matrix[16];
-    calculate_aspect_ratio_matrix(mvp_matrix, width, height, drm->width, drm->height);
-    glUniformMatrix4fv(gl->u_mvp_matrix, 1, GL_FALSE, mvp_matrix);
-
-    // Set keystone matrix (may change dynamically)
-    const float *keystone_matrix = keystone_get_matrix(keystone);
-    glUniformMatrix4fv(gl->u_keystone_matrix, 1, GL_FALSE, keystone_matrix);
-    
-    // Set flip_y uniform (flip both videos - they're both encoded upside down)
-    glUniform1f(gl->u_flip_y, 1.0f);
-    
-    // OPTIMIZED: Bind textures without excessive glTexParameteri calls
-    // Texture parameters are set once during initialization, not per-frame
-    if (gl->u_use_nv12 >= 0) {
-        glUniform1i(gl->u_use_nv12, 0);
-    }
+    // OPTIMIZED: Texture parameters come from gl->video_sampler, only the bindings change
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, tex_y);
     
@@ -1123,11 +1468,6 @@ void gl_render_frame(gl_context_t *gl, uint8_t *y_data, uint8_t *u_data, uint8_t
     // Reset to texture unit 0
     glActiveTexture(GL_TEXTURE0);
     
-    // Set texture sampler uniforms
-    glUniform1i(gl->u_texture_y, 0);
-    glUniform1i(gl->u_texture_u, 1);
-    glUniform1i(gl->u_texture_v, 2);
-    
     // TIMER: Measure texture upload time
     struct timespec tex_start, tex_end;
     clock_gettime(CLOCK_MONOTONIC, &tex_start);
@@ -1146,17 +1486,29 @@ void gl_render_frame(gl_context_t *gl, uint8_t *y_data, uint8_t *u_data, uint8_t
         
         // PRODUCTION: Only log on first frame to reduce console spam
         if (size_changed && frame_rendered[video_index] == 0) {
-            printf("YUV strides: Y=%d U=%d V=%d (dimensions: %dx%d, UV: %dx%d)\n",
+            LOG_INFO("YUV strides: Y=%d U=%d V=%d (dimensions: %dx%d, UV: %dx%d)\n",
                    y_stride, u_stride, v_stride, width, height, uv_width, uv_height);
-            printf("Direct upload: Y=%s U=%s V=%s\n", y_direct?"YES":"NO", u_direct?"YES":"NO", v_direct?"YES":"NO");
+            LOG_INFO("Direct upload: Y=%s U=%s V=%s\n", y_direct?"YES":"NO", u_direct?"YES":"NO", v_direct?"YES":"NO");
         }
         
         // ULTRA-OPTIMIZED: Use glTexStorage2D once, then glTexSubImage2D for updates
         // This is faster on some GPUs because storage is immutable
-        static bool storage_initialized[2] = {false, false};
+        static bool storage_initialized[GL_MAX_STREAMS] = {false};
         
         if (!storage_initialized[video_index] || size_changed) {
-            // First time or resolution changed - allocate storage
+            // First time or resolution changed - allocate storage. glTexStorage2D
+            // storage is immutable, so a new size (playlist item) needs new textures.
+            if (storage_initialized[video_index]) {
+                gl_stream_t *stream = &gl->streams[video_index];
+                GLuint old_textures[3] = { stream->texture_y, stream->texture_u, stream->texture_v };
+                glDeleteTextures(3, old_textures);
+                create_video_texture(&stream->texture_y);
+                create_video_texture(&stream->texture_u);
+                create_video_texture(&stream->texture_v);
+                tex_y = stream->texture_y;
+                tex_u = stream->texture_u;
+                tex_v = stream->texture_v;
+            }
             glActiveTexture(GL_TEXTURE0);
             glBindTexture(GL_TEXTURE_2D, tex_y);
             glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, width, height);
@@ -1172,87 +1524,65 @@ void gl_render_frame(gl_context_t *gl, uint8_t *y_data, uint8_t *u_data, uint8_t
             storage_initialized[video_index] = true;
         }
         
+        // Frames decoded into the PBO pool need no staging copy at all
+        bool pool_uploaded = frame_pool_upload(gl, tex_y, tex_u, tex_v, y_data, u_data, v_data,
+                                               width, height, y_stride, u_stride, v_stride);
+        
         bool pbo_uploaded = false;
-        if (gl->use_pbo) {
+        int pbo_slot = (gl->use_pbo && !pool_uploaded) ? pbo_acquire_slot(gl) : -1;
+        if (pbo_slot >= 0) {
             glActiveTexture(GL_TEXTURE0);
             glBindTexture(GL_TEXTURE_2D, tex_y);
-            bool y_ok = upload_plane_with_pbo(gl, PLANE_Y, y_data, width, height, 1, y_stride, GL_RED);
+            bool y_ok = upload_plane_with_pbo(gl, pbo_slot, PLANE_Y, y_data, width, height, 1, y_stride, GL_RED);
 
             glActiveTexture(GL_TEXTURE1);
             glBindTexture(GL_TEXTURE_2D, tex_u);
-            bool u_ok = upload_plane_with_pbo(gl, PLANE_U, u_data, uv_width, uv_height, 1, u_stride, GL_RED);
+            bool u_ok = upload_plane_with_pbo(gl, pbo_slot, PLANE_U, u_data, uv_width, uv_height, 1, u_stride, GL_RED);
 
             glActiveTexture(GL_TEXTURE2);
             glBindTexture(GL_TEXTURE_2D, tex_v);
-            bool v_ok = upload_plane_with_pbo(gl, PLANE_V, v_data, uv_width, uv_height, 1, v_stride, GL_RED);
+            bool v_ok = upload_plane_with_pbo(gl, pbo_slot, PLANE_V, v_data, uv_width, uv_height, 1, v_stride, GL_RED);
 
             pbo_uploaded = y_ok && u_ok && v_ok;
             if (!pbo_uploaded) {
                 gl->use_pbo = false;
                 if (!gl->pbo_warned) {
-                    printf("[Render] Disabling PBO staging (falling back to direct uploads)\n");
+                    LOG_INFO("[Render] Disabling PBO staging (falling back to direct uploads)\n");
                     gl->pbo_warned = true;
                 }
             }
         }
 
-        if (!pbo_uploaded) {
-            // PRODUCTION OPTIMIZATION: Allocate buffers once before all texture uploads
-            // This avoids 3 allocation checks per frame
-            if (!y_direct || !u_direct || !v_direct) {
-                int needed_size = width * height;  // Y plane size
-                allocate_yuv_buffers(needed_size);
-            }
-
-            // Y texture fall back path
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, tex_y);
-
-            if (y_direct) {
-                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, y_data);
-            } else {
-                copy_with_stride_simd(g_yuv_buffers.y_temp_buffer, y_data, width, height, width, y_stride);
-                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, g_yuv_buffers.y_temp_buffer);
-            }
-
-            // U texture fall back path
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, tex_u);
-
-            if (u_direct) {
-                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, uv_width, uv_height, GL_RED, GL_UNSIGNED_BYTE, u_data);
-            } else {
-                copy_with_stride_simd(g_yuv_buffers.u_temp_buffer, u_data, uv_width, uv_height, uv_width, u_stride);
-                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, uv_width, uv_height, GL_RED, GL_UNSIGNED_BYTE, g_yuv_buffers.u_temp_buffer);
-            }
-
-            // V texture fall back path
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, tex_v);
-
-            if (v_direct) {
-                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, uv_width, uv_height, GL_RED, GL_UNSIGNED_BYTE, v_data);
-            } else {
-                copy_with_stride_simd(g_yuv_buffers.v_temp_buffer, v_data, uv_width, uv_height, uv_width, v_stride);
-                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, uv_width, uv_height, GL_RED, GL_UNSIGNED_BYTE, g_yuv_buffers.v_temp_buffer);
+        if (!pbo_uploaded && !pool_uploaded) {
+            // Padded planes upload in place with GL_UNPACK_ROW_LENGTH: no staging copy
+            const GLuint textures[3] = { tex_y, tex_u, tex_v };
+            const uint8_t *planes[3] = { y_data, u_data, v_data };
+            const int strides[3] = { y_stride, u_stride, v_stride };
+            const bool direct[3] = { y_direct, u_direct, v_direct };
+            for (int p = 0; p < 3; p++) {
+                glActiveTexture(GL_TEXTURE0 + p);
+                glBindTexture(GL_TEXTURE_2D, textures[p]);
+                if (!direct[p]) {
+                    glPixelStorei(GL_UNPACK_ROW_LENGTH, strides[p]);
+                }
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, p == 0 ? width : uv_width, p == 0 ? height : uv_height,
+                                GL_RED, GL_UNSIGNED_BYTE, planes[p]);
+                if (!direct[p]) {
+                    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+                }
             }
         }
         
         if (frame_rendered[video_index] == 0) {
-            printf("GPU YUV→RGB rendering started (%dx%d)\n", width, height);
+            LOG_INFO("GPU YUV→RGB rendering started (%dx%d)\n", width, height);
         }
         last_width[video_index] = width;
         last_height[video_index] = height;
         
         frame_rendered[video_index]++;
-        if (gl->use_pbo && pbo_uploaded) {
-            // Create fence for the current PBO set to track when GPU is done reading
-            if (gl->pbo_fences[gl->pbo_index]) {
-                glDeleteSync(gl->pbo_fences[gl->pbo_index]);
-            }
-            gl->pbo_fences[gl->pbo_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
-
-            gl->pbo_index = (gl->pbo_index + 1) % PBO_RING_COUNT;
+        if (pbo_uploaded) {
+            // Fence the slot to track when the GPU is done reading it
+            pbo_submit_slot(gl, pbo_slot);
         }
     } else if (frame_rendered[video_index] == 0) {
         // Skip test pattern for now - YUV textures need proper initialization
@@ -1277,11 +1607,11 @@ void gl_render_frame(gl_context_t *gl, uint8_t *y_data, uint8_t *u_data, uint8_t
     // PRODUCTION: Diagnostic output only on first 3 slow frames
     static int frame_diag = 0;
     if (frame_diag < 3 && (tex_upload_time > 0.008 || draw_time > 0.010)) {
-        printf("[Render] Video%d - Upload: %.1fms, Draw: %.1fms\n",
+        LOG_INFO("[Render] Video%d - Upload: %.1fms, Draw: %.1fms\n",
                video_index, tex_upload_time * 1000, draw_time * 1000);
         frame_diag++;
         if (frame_diag == 3) {
-            printf("  (Further render timing available with --timing flag)\n");
+            LOG_INFO("  (Further render timing available with --timing flag)\n");
         }
     }
 }
@@ -1293,14 +1623,37 @@ void gl_swap_buffers(gl_context_t *gl, struct display_ctx *drm) {
     // Measure swap time for diagnostics
     clock_gettime(CLOCK_MONOTONIC, &t1);
     
+    // Atomic KMS: fence the frame's rendering so the commit can be queued before the GPU finishes
+    void *render_fence = NULL;
+    if (gl->supports_native_fence && drm->atomic_supported) {
+        const EGLint attribs[] = {
+            EGL_SYNC_NATIVE_FENCE_FD_ANDROID, EGL_NO_NATIVE_FENCE_FD_ANDROID,
+            EGL_NONE
+        };
+        render_fence = eglCreateSyncKHR(gl->egl_display, EGL_SYNC_NATIVE_FENCE_ANDROID, attribs);
+    }
+    
     // EGL swap buffers (this makes the rendered frame available and blocks on VSync)
     EGLBoolean swap_result = eglSwapBuffers(gl->egl_display, gl->egl_surface);
     if (!swap_result && swap_count < 5) {
-        printf("EGL swap failed: 0x%x\n", eglGetError());
+        LOG_ERROR_RATELIMITED("EGL swap failed: 0x%x\n", eglGetError());
+        if (render_fence) {
+            eglDestroySyncKHR(gl->egl_display, render_fence);
+        }
         clock_gettime(CLOCK_MONOTONIC, &last_swap_time);
         return;
     }
     
+    // The FD only exists once the fence has been flushed, i.e. after the swap
+    if (render_fence) {
+        int fence_fd = eglDupNativeFenceFDANDROID(gl->egl_display, render_fence);
+        eglDestroySyncKHR(gl->egl_display, render_fence);
+        if (drm->in_fence_fd >= 0) {
+            close(drm->in_fence_fd);
+        }
+        drm->in_fence_fd = (fence_fd >= 0) ? fence_fd : -1;
+    }
+    
     clock_gettime(CLOCK_MONOTONIC, &t2);
     
     // Calculate swap time (includes VSync wait)
@@ -1309,12 +1662,12 @@ void gl_swap_buffers(gl_context_t *gl, struct display_ctx *drm) {
     
     // Warn on long swaps (indicates late arrival to VBlank)
     if (swap_ms > 20.0 && swap_count > 10) {
-        printf("PERF: Long swap: %.1fms (late frame, missed VBlank window)\n", swap_ms);
+        LOG_WARN_RATELIMITED("PERF: Long swap: %.1fms (late frame, missed VBlank window)\n", swap_ms);
     }
     
     // Present to display via DRM
     if (drm_swap_buffers(drm) != 0 && swap_count < 5) {
-        printf("DRM swap failed\n");
+        LOG_ERROR_RATELIMITED("DRM swap failed\n");
     }
     
     last_swap_time = t2;
@@ -1331,47 +1684,39 @@ void gl_render_corners(gl_context_t *gl, keystone_context_t *keystone) {
     }
 
     // PRODUCTION FIX: Separate VBOs and state tracking for each keystone
-    // This prevents flickering when rendering corners for dual keystones
-    static float corner_vertices1[10000];  // Keystone 1 vertex buffer
-    static float corner_vertices2[10000];  // Keystone 2 vertex buffer
-    static GLuint corner_vbo1 = 0;
-    static GLuint corner_vbo2 = 0;
+    // This prevents flickering when rendering corners for multiple keystones
+    static float corner_vertices_per_stream[GL_MAX_STREAMS][10000];
+    static GLuint corner_vbos[GL_MAX_STREAMS] = {0};
     static bool vbo_initialized = false;
 
-    // Per-keystone state tracking (indexed by keystone: 0 = first seen, 1 = second seen)
-    static keystone_context_t *keystone_ptrs[2] = {NULL, NULL};
-    static int cached_selected_corners[2] = {-2, -2};
-    static bool last_show_corners[2] = {false, false};
+    // Per-keystone state tracking (indexed in the order keystones are first seen)
+    static keystone_context_t *keystone_ptrs[GL_MAX_STREAMS] = {NULL};
+    static int cached_selected_corners[GL_MAX_STREAMS] = {-2, -2, -2, -2};
+    static bool last_show_corners[GL_MAX_STREAMS] = {false};
 
     // Initialize VBOs once on first call
     if (!vbo_initialized) {
-        glGenBuffers(1, &corner_vbo1);
-        glBindBuffer(GL_ARRAY_BUFFER, corner_vbo1);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(corner_vertices1), NULL, GL_DYNAMIC_DRAW);
-
-        glGenBuffers(1, &corner_vbo2);
-        glBindBuffer(GL_ARRAY_BUFFER, corner_vbo2);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(corner_vertices2), NULL, GL_DYNAMIC_DRAW);
-
+        glGenBuffers(GL_MAX_STREAMS, corner_vbos);
+        for (int i = 0; i < GL_MAX_STREAMS; i++) {
+            glBindBuffer(GL_ARRAY_BUFFER, corner_vbos[i]);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(corner_vertices_per_stream[i]), NULL, GL_DYNAMIC_DRAW);
+        }
         vbo_initialized = true;
     }
 
-    // Determine which keystone index (0 or 1) based on pointer
-    int keystone_idx = -1;
-    if (keystone == keystone_ptrs[0] || keystone_ptrs[0] == NULL) {
-        keystone_idx = 0;
-        keystone_ptrs[0] = keystone;
-    } else if (keystone == keystone_ptrs[1] || keystone_ptrs[1] == NULL) {
-        keystone_idx = 1;
-        keystone_ptrs[1] = keystone;
-    } else {
-        // Fallback: use index 0 if pointer doesn't match either
-        keystone_idx = 0;
+    // Determine which keystone slot this is based on pointer
+    int keystone_idx = 0;  // Fallback: slot 0 if every slot is taken by another keystone
+    for (int i = 0; i < GL_MAX_STREAMS; i++) {
+        if (keystone == keystone_ptrs[i] || keystone_ptrs[i] == NULL) {
+            keystone_idx = i;
+            keystone_ptrs[i] = keystone;
+            break;
+        }
     }
 
     // Select the appropriate VBO and vertex buffer for this keystone
-    GLuint corner_vbo = (keystone_idx == 0) ? corner_vbo1 : corner_vbo2;
-    float *corner_vertices = (keystone_idx == 0) ? corner_vertices1 : corner_vertices2;
+    GLuint corner_vbo = corner_vbos[keystone_idx];
+    float *corner_vertices = corner_vertices_per_stream[keystone_idx];
 
     // Check if update needed for THIS specific keystone
     bool visibility_changed = (last_show_corners[keystone_idx] != keystone->show_corners);
@@ -1466,14 +1811,13 @@ void gl_render_corners(gl_context_t *gl, keystone_context_t *keystone) {
     glBindBuffer(GL_ARRAY_BUFFER, corner_vbo);
     
     // Enable blending for transparent overlays
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    set_overlay_blend(gl);
     
     // Disable depth testing to ensure overlays are always visible
     glDisable(GL_DEPTH_TEST);
     
     // Use corner shader program
-    glUseProgram(gl->corner_program);
+    bind_program(gl, gl->corner_program);
     
     // Set up vertex attributes - interleaved position (2) + color (4)
     int stride = 6 * sizeof(float);
@@ -1515,8 +1859,7 @@ void gl_render_border(gl_context_t *gl, keystone_context_t *keystone) {
     }
     
     // Enable blending for transparent overlays
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    set_overlay_blend(gl);
     
     // Disable depth testing to ensure overlays are always visible
     glDisable(GL_DEPTH_TEST);
@@ -1568,7 +1911,7 @@ void gl_render_border(gl_context_t *gl, keystone_context_t *keystone) {
     glBufferData(GL_ARRAY_BUFFER, sizeof(border_vertices), border_vertices, GL_DYNAMIC_DRAW);
     
     // Use corner shader program (same as corners, just different geometry)
-    glUseProgram(gl->corner_program);
+    bind_program(gl, gl->corner_program);
     
     // Set up vertex attributes (interleaved position + color)
     int stride = 6 * sizeof(float); // x, y, r, g, b, a
@@ -1614,8 +1957,7 @@ void gl_render_display_boundary(gl_context_t *gl, keystone_context_t *keystone)
     }
     
     // Enable blending for transparent overlay
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    set_overlay_blend(gl);
     
     // Disable depth testing to ensure overlay is always visible
     glDisable(GL_DEPTH_TEST);
@@ -1675,7 +2017,7 @@ void gl_render_display_boundary(gl_context_t *gl, keystone_context_t *keystone)
     glBufferData(GL_ARRAY_BUFFER, sizeof(boundary_vertices), boundary_vertices, GL_DYNAMIC_DRAW);
     
     // Use corner shader program
-    glUseProgram(gl->corner_program);
+    bind_program(gl, gl->corner_program);
     
     // Set up vertex attributes (interleaved position + color)
     int stride = 6 * sizeof(float);
@@ -1783,318 +2125,285 @@ static const unsigned char font_5x7[128][7] = {
     ['z'] = {0x00, 0x00, 0xF8, 0x10, 0x20, 0x40, 0xF8},
 };
 
-static void draw_char_simple(float *vertices, int *vertex_count, char c, float x, float y, float size) {
-    if (*vertex_count >= 15000) return; // Safety limit - increased for longer help text
-    
-    // Check bounds and handle unknown characters
-    unsigned char uc = (unsigned char)c;
-    if (uc > 127) return;
-    
-    const unsigned char *char_data = font_5x7[uc];
-    
-    // Check if character has any data (handle sparse array)
-    bool has_data = false;
-    for (int i = 0; i < 7; i++) {
-        if (char_data[i] != 0) {
-            has_data = true;
-            break;
-        }
-    }
-    if (!has_data && c != ' ') return; // Skip undefined chars except space
-    
-    float pixel_size = size / 7.0f;  // 5x7 font, divide by 7 for height
-    
-    for (int row = 0; row < 7; row++) {
-        unsigned char row_data = char_data[row];
-        for (int col = 0; col < 8; col++) {  // Check all 8 bits
-            if ((row_data >> (7-col)) & 1) { // Check if pixel is set (MSB first)
-                if (*vertex_count + 4 <= 15000) {
-                    float px = x + col * pixel_size;
-                    float py = y - (row * pixel_size); // Top to bottom
-                    
-                    // Add rectangle for this pixel
-                    vertices[(*vertex_count)*2] = px; 
-                    vertices[(*vertex_count)*2+1] = py;
-                    (*vertex_count)++;
-                    vertices[(*vertex_count)*2] = px + pixel_size; 
-                    vertices[(*vertex_count)*2+1] = py;
-                    (*vertex_count)++;
-                    vertices[(*vertex_count)*2] = px + pixel_size; 
-                    vertices[(*vertex_count)*2+1] = py - pixel_size;
-                    (*vertex_count)++;
-                    vertices[(*vertex_count)*2] = px; 
-                    vertices[(*vertex_count)*2+1] = py - pixel_size;
-                    (*vertex_count)++;
+// Glyph atlas: font_5x7 rasterized once into 8x8 texel cells (16 per row).
+// Rows run top to bottom in the texture, so a cell's top edge is its lowest t.
+static void create_glyph_atlas(gl_context_t *gl) {
+    enum { ATLAS_W = 16 * 8, ATLAS_H = 8 * 8 };
+    static uint8_t texels[ATLAS_H][ATLAS_W][4];
+
+    memset(texels, 0, sizeof(texels));
+    for (int c = 0; c < 128; c++) {
+        int cell_x = (c % 16) * 8;
+        int cell_y = (c / 16) * 8;
+        for (int row = 0; row < 7; row++) {
+            for (int col = 0; col < 8; col++) {
+                if ((font_5x7[c][row] >> (7 - col)) & 1) {  // MSB first
+                    memset(texels[cell_y + row][cell_x + col], 0xFF, 4);
                 }
             }
         }
     }
+
+    glGenTextures(1, &gl->glyph_atlas);
+    glActiveTexture(GL_TEXTURE0 + GL_OVERLAY_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, gl->glyph_atlas);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, ATLAS_W, ATLAS_H);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, ATLAS_W, ATLAS_H, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+    // Nearest keeps the blocky font crisp at any scale
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+static bool glyph_has_data(unsigned char c) {
+    for (int row = 0; row < 7; row++) {
+        if (font_5x7[c][row]) return true;
+    }
+    return false;
 }
 
-static void draw_text_simple(float *vertices, int *vertex_count, const char *text, float x, float y, float size) {
+// Draw text as one textured quad per glyph in a single draw call.
+// (x, y) is the top-left of the first glyph; size is the glyph height.
+static void draw_text(gl_context_t *gl, const char *text, float x, float y, float size, const float color[4]) {
+    static float vertices[GL_TEXT_MAX_GLYPHS * 6 * 4];  // 2 triangles x (x, y, s, t)
+    float pixel_size = size / 7.0f;    // 5x7 font, divide by 7 for height
     float char_width = size * 1.2f;    // Character width including spacing
     float line_height = size * 1.3f;   // Tighter line spacing to fit more text
-    float current_x = x;
-    float current_y = y;
-    
-    while (*text && *vertex_count < 15000) {
-        if (*text == '\n') {
-            current_x = x;
-            current_y -= line_height;
-        } else {
-            draw_char_simple(vertices, vertex_count, *text, current_x, current_y, size);
-            current_x += char_width;
+    float cursor_x = x;
+    float cursor_y = y;
+    int glyphs = 0;
+
+    for (; *text && glyphs < GL_TEXT_MAX_GLYPHS; text++) {
+        unsigned char c = (unsigned char)*text;
+        if (c == '\n') {
+            cursor_x = x;
+            cursor_y -= line_height;
+            continue;
         }
-        text++;
+        if (c < 128 && c != ' ' && glyph_has_data(c)) {
+            float x0 = cursor_x, x1 = cursor_x + 8.0f * pixel_size;
+            float y0 = cursor_y, y1 = cursor_y - 7.0f * pixel_size;
+            float s0 = (float)(c % 16) / 16.0f, s1 = s0 + 1.0f / 16.0f;
+            float t0 = (float)(c / 16) / 8.0f,  t1 = t0 + 7.0f / 64.0f;
+            float quad[6][4] = {
+                {x0, y0, s0, t0}, {x1, y0, s1, t0}, {x1, y1, s1, t1},
+                {x0, y0, s0, t0}, {x1, y1, s1, t1}, {x0, y1, s0, t1},
+            };
+            memcpy(&vertices[glyphs * 24], quad, sizeof(quad));
+            glyphs++;
+        }
+        cursor_x += char_width;
     }
-}
+    if (glyphs == 0) return;
 
-void gl_render_help_overlay(gl_context_t *gl, keystone_context_t *keystone) {
-    if (!keystone || !keystone->show_help) {
-        return; // Don't render help overlay if not visible
-    }
+    bind_program(gl, gl->overlay_program);
+    glUniform4fv(gl->overlay_u_color, 1, color);
+    glActiveTexture(GL_TEXTURE0 + GL_OVERLAY_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, gl->glyph_atlas);
+    glActiveTexture(GL_TEXTURE0);
 
-    // OPTIMIZATION: Cache text geometry - only generate once on first display
-    static bool help_initialized = false;
-    static float help_bg_vertices[24]; // Background rectangle
-    static float help_text_vertices[30000]; // Text geometry
-    static int text_vertex_count = 0;
-
-    if (!help_initialized) {
-        // Generate background vertices (only once)
-        // Bottom-left
-        help_bg_vertices[0] = -0.9f; help_bg_vertices[1] = -0.7f;
-        help_bg_vertices[2] = 0.0f; help_bg_vertices[3] = 0.0f; help_bg_vertices[4] = 0.0f; help_bg_vertices[5] = 0.95f;
-        // Bottom-right
-        help_bg_vertices[6] = 0.9f; help_bg_vertices[7] = -0.7f;
-        help_bg_vertices[8] = 0.0f; help_bg_vertices[9] = 0.0f; help_bg_vertices[10] = 0.0f; help_bg_vertices[11] = 0.95f;
-        // Top-right
-        help_bg_vertices[12] = 0.9f; help_bg_vertices[13] = 0.7f;
-        help_bg_vertices[14] = 0.0f; help_bg_vertices[15] = 0.0f; help_bg_vertices[16] = 0.0f; help_bg_vertices[17] = 0.95f;
-        // Top-left
-        help_bg_vertices[18] = -0.9f; help_bg_vertices[19] = 0.7f;
-        help_bg_vertices[20] = 0.0f; help_bg_vertices[21] = 0.0f; help_bg_vertices[22] = 0.0f; help_bg_vertices[23] = 0.95f;
-    
-        // Generate text geometry (only once)
-        const char* help_text =
-            "Copyright Dilworth Creative LLC\n"
-            "\n"
-            "PICKLE KEYSTONE\n"
-            "\n"
-            "GAMEPAD\n"
-            "X      Cycle Corner\n"
-            "DPAD   Move Corner\n"
-            "B      Show Keysone Border\n"
-            "Y      Show Help\n"
-            "L1     Step Down\n"
-            "R1     Step Up\n"
-            "START  Save\n"
-            "SELECT Reset Keystone";
-
-        draw_text_simple(help_text_vertices, &text_vertex_count, help_text, -0.85f, 0.62f, 0.022f);
-        help_initialized = true;
-        printf("[HELP] Text geometry generated: %d vertices (cached for reuse)\n", text_vertex_count);
-    }
-
-    // Now render the cached geometry (fast!)
-    glBindBuffer(GL_ARRAY_BUFFER, gl->help_vbo);
-    
-    // Upload cached background geometry
-    glBufferData(GL_ARRAY_BUFFER, 4 * 6 * sizeof(float), help_bg_vertices, GL_DYNAMIC_DRAW);
-
-    // Use corner shader program for help overlay rendering
-    glUseProgram(gl->corner_program);
+    glBindBuffer(GL_ARRAY_BUFFER, gl->text_vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)glyphs * 24 * sizeof(float), vertices, GL_DYNAMIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
 
-    // Set up vertex attributes (interleaved position + color)
-    int stride = 6 * sizeof(float); // x, y, r, g, b, a
-    glVertexAttribPointer(gl->corner_a_position, 2, GL_FLOAT, GL_FALSE, stride, (void*)0);
-    glEnableVertexAttribArray(gl->corner_a_position);
+    glDrawArrays(GL_TRIANGLES, 0, glyphs * 6);
 
-    // Color attribute at location 1
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    glDisableVertexAttribArray(0);
+    glDisableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
 
-    // Set identity matrix for MVP
-    float identity[16] = {
+// Translucent background panel in the corner program's (x, y, r, g, b, a) layout
+static void draw_overlay_panel(gl_context_t *gl, GLuint vbo, float left, float bottom, float right, float top,
+                               const float color[4]) {
+    float vertices[4][6] = {
+        {left,  bottom, color[0], color[1], color[2], color[3]},
+        {right, bottom, color[0], color[1], color[2], color[3]},
+        {right, top,    color[0], color[1], color[2], color[3]},
+        {left,  top,    color[0], color[1], color[2], color[3]},
+    };
+    static const float identity[16] = {
         1, 0, 0, 0,
         0, 1, 0, 0,
         0, 0, 1, 0,
         0, 0, 0, 1
     };
-    glUniformMatrix4fv(gl->corner_u_mvp_matrix, 1, GL_FALSE, identity);
 
-    // Enable blending for transparency
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
 
-    // Disable depth testing to ensure overlays are always visible
-    glDisable(GL_DEPTH_TEST);
+    bind_program(gl, gl->corner_program);
+    int stride = 6 * sizeof(float);
+    glVertexAttribPointer(gl->corner_a_position, 2, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glEnableVertexAttribArray(gl->corner_a_position);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glUniformMatrix4fv(gl->corner_u_mvp_matrix, 1, GL_FALSE, identity);
 
-    // Draw help overlay background (semi-transparent black from vertex colors)
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4); // Background rectangle
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 
-    // OPTIMIZATION: Reuse cached text geometry (no regeneration every frame!)
-    // Create bright white color vertices for text using cached geometry
-    static float colored_vertices[180000]; // Persistent buffer
-    static bool colors_initialized = false;
+    glDisableVertexAttribArray(gl->corner_a_position);
+    glDisableVertexAttribArray(1);
+}
 
-    if (!colors_initialized) {
-        // Only add colors once
-        for (int i = 0; i < text_vertex_count && i * 6 < 180000; i++) {
-            colored_vertices[i * 6 + 0] = help_text_vertices[i * 2 + 0]; // x
-            colored_vertices[i * 6 + 1] = help_text_vertices[i * 2 + 1]; // y
-            colored_vertices[i * 6 + 2] = 1.0f; // r - bright white
-            colored_vertices[i * 6 + 3] = 1.0f; // g
-            colored_vertices[i * 6 + 4] = 1.0f; // b
-            colored_vertices[i * 6 + 5] = 1.0f; // a
-        }
-        colors_initialized = true;
+void gl_render_help_overlay(gl_context_t *gl, keystone_context_t *keystone) {
+    if (!keystone || !keystone->show_help) {
+        return; // Don't render help overlay if not visible
     }
 
-    // Upload cached text with colors (just one memcpy, no regeneration!)
-    glBufferData(GL_ARRAY_BUFFER, text_vertex_count * 6 * sizeof(float), colored_vertices, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(gl->corner_a_position, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // OPTIMIZATION: Draw all text in ONE batched call instead of 3000+ separate calls!
-    // Each rectangle is 4 vertices (triangle fan), draw them all as quads
-    // Use GL_POINTS with point sprites would be better, but GLES doesn't support it well
-    // So we'll convert to indexed triangles for a single draw call
-    static GLuint text_indices_vbo = 0;
-    static int last_text_vertex_count = 0;
-
-    if (text_indices_vbo == 0) {
-        glGenBuffers(1, &text_indices_vbo);
-    }
-
-    // Generate indices if needed (convert quads to triangles)
-    if (text_vertex_count != last_text_vertex_count) {
-        int num_quads = text_vertex_count / 4;
-        GLuint *indices = malloc(num_quads * 6 * sizeof(GLuint)); // 2 triangles per quad
-
-        for (int i = 0; i < num_quads; i++) {
-            int base = i * 4;
-            indices[i * 6 + 0] = base + 0;
-            indices[i * 6 + 1] = base + 1;
-            indices[i * 6 + 2] = base + 2;
-            indices[i * 6 + 3] = base + 0;
-            indices[i * 6 + 4] = base + 2;
-            indices[i * 6 + 5] = base + 3;
-        }
+    static const float background[4] = {0.0f, 0.0f, 0.0f, 0.95f};
+    static const float white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    static const char *help_text =
+        "Copyright Dilworth Creative LLC\n"
+        "\n"
+        "PICKLE KEYSTONE\n"
+        "\n"
+        "GAMEPAD\n"
+        "X      Cycle Corner\n"
+        "DPAD   Move Corner\n"
+        "B      Show Keysone Border\n"
+        "Y      Show Help\n"
+        "L1     Step Down\n"
+        "R1     Step Up\n"
+        "START  Save\n"
+        "SELECT Reset Keystone";
+
+    set_overlay_blend(gl);
+    glDisable(GL_DEPTH_TEST);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, text_indices_vbo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, num_quads * 6 * sizeof(GLuint), indices, GL_STATIC_DRAW);
-        free(indices);
-        last_text_vertex_count = text_vertex_count;
-    } else {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, text_indices_vbo);
-    }
+    draw_overlay_panel(gl, gl->help_vbo, -0.9f, -0.7f, 0.9f, 0.7f, background);
+    draw_text(gl, help_text, -0.85f, 0.62f, 0.022f, white);
 
-    // Draw ALL text in ONE call!
-    int num_quads = text_vertex_count / 4;
-    glDrawElements(GL_TRIANGLES, num_quads * 6, GL_UNSIGNED_INT, 0);
-    
-    // Disable blending and restore depth testing
     glDisable(GL_BLEND);
     glEnable(GL_DEPTH_TEST);
-    
-    glDisableVertexAttribArray(gl->corner_a_position);
-    glDisableVertexAttribArray(1);
-
-    // CRITICAL: Restore GL state - unbind VBO to prevent interference
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void gl_render_notification_overlay(gl_context_t *gl, const char *message) {
     if (!gl || !message) return;
 
-    // Create notification overlay with background and text
-    float notify_vertices[1000]; // Buffer for background vertices with color
-    int vertex_count = 0;
-
-    // Centered notification box with darker green background for better readability
-    // Bottom-left
-    notify_vertices[0] = -0.35f; notify_vertices[1] = -0.15f;
-    notify_vertices[2] = 0.0f; notify_vertices[3] = 0.6f; notify_vertices[4] = 0.0f; notify_vertices[5] = 0.95f;
-    // Bottom-right
-    notify_vertices[6] = 0.35f; notify_vertices[7] = -0.15f;
-    notify_vertices[8] = 0.0f; notify_vertices[9] = 0.6f; notify_vertices[10] = 0.0f; notify_vertices[11] = 0.95f;
-    // Top-right
-    notify_vertices[12] = 0.35f; notify_vertices[13] = 0.15f;
-    notify_vertices[14] = 0.0f; notify_vertices[15] = 0.6f; notify_vertices[16] = 0.0f; notify_vertices[17] = 0.95f;
-    // Top-left
-    notify_vertices[18] = -0.35f; notify_vertices[19] = 0.15f;
-    notify_vertices[20] = 0.0f; notify_vertices[21] = 0.6f; notify_vertices[22] = 0.0f; notify_vertices[23] = 0.95f;
-    vertex_count = 4;
-
-    // Upload background geometry
-    glBindBuffer(GL_ARRAY_BUFFER, gl->corner_vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertex_count * 6 * sizeof(float), notify_vertices, GL_DYNAMIC_DRAW);
+    // Centered box with a dark green background for readability
+    static const float background[4] = {0.0f, 0.6f, 0.0f, 0.95f};
+    static const float white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
 
-    // Use corner shader program
-    glUseProgram(gl->corner_program);
+    set_overlay_blend(gl);
+    glDisable(GL_DEPTH_TEST);
 
-    // Set up vertex attributes (interleaved position + color)
-    int stride = 6 * sizeof(float); // x, y, r, g, b, a
-    glVertexAttribPointer(gl->corner_a_position, 2, GL_FLOAT, GL_FALSE, stride, (void*)0);
-    glEnableVertexAttribArray(gl->corner_a_position);
+    draw_overlay_panel(gl, gl->corner_vbo, -0.35f, -0.15f, 0.35f, 0.15f, background);
+    draw_text(gl, message, -0.32f, 0.02f, 0.035f, white);
 
-    // Color attribute at location 1
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
 
-    // Set identity matrix for MVP
-    float identity[16] = {
-        1, 0, 0, 0,
-        0, 1, 0, 0,
-        0, 0, 1, 0,
-        0, 0, 0, 1
-    };
-    glUniformMatrix4fv(gl->corner_u_mvp_matrix, 1, GL_FALSE, identity);
+// Size the layer's texture and FBO to the display. Returns -1 (and stops
+// retrying) if the driver cannot give us a complete framebuffer.
+static int ensure_overlay_layer(gl_context_t *gl, int width, int height) {
+    gl_overlay_layer_t *layer = &gl->overlay;
+    if (layer->unavailable) return -1;
+    if (layer->fbo && layer->width == width && layer->height == height) return 0;
+
+    // Texture storage is immutable, so a size change needs a new texture
+    if (layer->texture) glDeleteTextures(1, &layer->texture);
+    if (!layer->fbo) glGenFramebuffers(1, &layer->fbo);
+
+    glGenTextures(1, &layer->texture);
+    glActiveTexture(GL_TEXTURE0 + GL_OVERLAY_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, layer->texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    // 1:1 with the display, so nearest sampling is exact
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glActiveTexture(GL_TEXTURE0);
 
-    // Enable blending for transparency
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_DEPTH_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, layer->fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer->texture, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "[GL] Overlay layer FBO incomplete (0x%x), drawing overlays directly\n", status);
+        glDeleteFramebuffers(1, &layer->fbo);
+        glDeleteTextures(1, &layer->texture);
+        layer->fbo = 0;
+        layer->texture = 0;
+        layer->unavailable = true;
+        return -1;
+    }
 
-    // Draw notification background
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    layer->width = width;
+    layer->height = height;
+    layer->valid = false;
+    printf("[GL] Overlay layer %dx%d\n", width, height);
+    return 0;
+}
 
-    // Render notification text centered
-    float text_vertices[3000];
-    int text_vertex_count = 0;
-    draw_text_simple(text_vertices, &text_vertex_count, message, -0.32f, 0.02f, 0.035f);
-
-    // Create colored vertices for text (white color)
-    float colored_vertices[18000]; // 3000 * 6
-    for (int i = 0; i < text_vertex_count && i * 6 < 18000; i++) {
-        colored_vertices[i * 6 + 0] = text_vertices[i * 2 + 0]; // x
-        colored_vertices[i * 6 + 1] = text_vertices[i * 2 + 1]; // y
-        colored_vertices[i * 6 + 2] = 1.0f; // r - white color
-        colored_vertices[i * 6 + 3] = 1.0f; // g
-        colored_vertices[i * 6 + 4] = 1.0f; // b
-        colored_vertices[i * 6 + 5] = 1.0f; // a
-    }
-
-    // Upload text with colors
-    glBufferData(GL_ARRAY_BUFFER, text_vertex_count * 6 * sizeof(float), colored_vertices, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(gl->corner_a_position, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+bool gl_overlay_begin(gl_context_t *gl, struct display_ctx *drm, uint64_t content_key) {
+    gl_overlay_layer_t *layer = &gl->overlay;
+    int width = (int)drm->width;
+    int height = (int)drm->height;
 
-    // Draw text pixels
-    int text_pixels = text_vertex_count / 4;
-    for (int i = 0; i < text_pixels; i++) {
-        glDrawArrays(GL_TRIANGLE_FAN, i * 4, 4);
+    if (layer->valid && layer->content_key == content_key &&
+        layer->width == width && layer->height == height) {
+        return false;  // Cached render is current
+    }
+    if (ensure_overlay_layer(gl, width, height) != 0) {
+        set_viewport(gl, width, height);
+        return true;
     }
 
-    // Restore GL state
+    glBindFramebuffer(GL_FRAMEBUFFER, layer->fbo);
+    set_viewport(gl, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    layer->recording = true;
+    layer->content_key = content_key;
+    return true;
+}
+
+void gl_overlay_end(gl_context_t *gl) {
+    gl_overlay_layer_t *layer = &gl->overlay;
+    if (!layer->recording) return;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    layer->recording = false;
+    layer->valid = true;
+    layer->redraws++;
+}
+
+void gl_overlay_composite(gl_context_t *gl) {
+    gl_overlay_layer_t *layer = &gl->overlay;
+    if (!layer->valid) return;
+
+    static const float opaque[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+    bind_program(gl, gl->overlay_program);
+    glUniform4fv(gl->overlay_u_color, 1, opaque);
+    glActiveTexture(GL_TEXTURE0 + GL_OVERLAY_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, layer->texture);
+    glActiveTexture(GL_TEXTURE0);
+
+    // The video quad covers the screen with matching texcoords; bind_program()
+    // reset the cached VAO, so record the rebind
+    glBindVertexArray(gl->vao);
+    gl->state.vao = gl->vao;
+
+    // Layer color is premultiplied (see set_overlay_blend)
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+    set_viewport(gl, layer->width, layer->height);
+
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
     glDisable(GL_BLEND);
     glEnable(GL_DEPTH_TEST);
-    glDisableVertexAttribArray(gl->corner_a_position);
-    glDisableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 // WiFi overlay function disabled - requires wifi_manager_t which is not defined
@@ -2130,7 +2439,7 @@ void gl_render_wifi_overlay(gl_context_t *gl, wifi_manager_t *mgr) {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glDisable(GL_DEPTH_TEST);
     
-    glUseProgram(gl->corner_program);
+    bind_program(gl, gl->corner_program);
     
     // Set MVP matrix
     float identity[16] = {
@@ -2484,32 +2793,32 @@ void gl_render_frame_dma(gl_context_t *gl, int dma_fd, int width, int height,
                         struct display_ctx *drm, keystone_context_t *keystone, bool clear_screen, int video_index) {
     // PRODUCTION: Validate EGL context before rendering
     if (!validate_egl_context()) {
-        fprintf(stderr, "ERROR: Cannot render DMA - EGL context lost\n");
+        LOG_ERROR_RATELIMITED("ERROR: Cannot render DMA - EGL context lost\n");
         return;
     }
     
-    if (!gl || dma_fd < 0) {
-        fprintf(stderr, "[DMA] Invalid arguments (gl=%p, fd=%d)\n", (void*)gl, dma_fd);
+    if (!gl || dma_fd < 0 || video_index < 0 || video_index >= GL_MAX_STREAMS) {
+        LOG_ERROR_RATELIMITED("[DMA] Invalid arguments (gl=%p, fd=%d, video=%d)\n", (void*)gl, dma_fd, video_index);
         return;
     }
 
     if (!gl->supports_egl_image) {
-        fprintf(stderr, "[DMA] EGL image not supported\n");
+        LOG_ERROR_RATELIMITED("[DMA] EGL image not supported\n");
         return;
     }
 
     // DEBUG: Log DMA rendering
-    static int dma_render_count[2] = {0, 0};
+    static int dma_render_count[GL_MAX_STREAMS] = {0};
     if (dma_render_count[video_index] < 3) {
-        printf("[DMA_RENDER] Video %d: fd=%d, size=%dx%d, clear=%d\n",
+        LOG_INFO("[DMA_RENDER] Video %d: fd=%d, size=%dx%d, clear=%d\n",
                video_index, dma_fd, width, height, clear_screen);
         dma_render_count[video_index]++;
     }
 
-    // Select appropriate texture set based on video index
-    GLuint tex_y = (video_index == 0) ? gl->texture_y : gl->texture_y2;
-    GLuint tex_u = (video_index == 0) ? gl->texture_u : gl->texture_u2;
-    GLuint tex_v = (video_index == 0) ? gl->texture_v : gl->texture_v2;
+    // Select this stream's texture set
+    GLuint tex_y = gl->streams[video_index].texture_y;
+    GLuint tex_u = gl->streams[video_index].texture_u;
+    GLuint tex_v = gl->streams[video_index].texture_v;
 
     // CRITICAL: Clear any previous EGL image bindings before rebinding
     // This prevents GL_INVALID_OPERATION errors when reusing textures
@@ -2532,40 +2841,11 @@ void gl_render_frame_dma(gl_context_t *gl, int dma_fd, int width, int height,
     }
 
     // Set up rendering state
-    glViewport(0, 0, drm->mode.hdisplay, drm->mode.vdisplay);
     if (clear_screen && video_index == 0) {
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     }
-
-    // OPTIMIZATION: Only set up GL state once per frame (for video 0)
-    // Video 1 reuses the same state - only textures and matrices change
-    if (video_index == 0) {
-        glUseProgram(gl->program);
-        glBindBuffer(GL_ARRAY_BUFFER, gl->vbo);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl->ebo);
-
-        // Position attribute
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        // Texture coordinate attribute
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        // Disable blending and depth test
-        glDisable(GL_BLEND);
-        glDisable(GL_DEPTH_TEST);
-    }
-
-    // Set MVP matrix with aspect ratio preservation (recalculate for each video!)
-    float mvp_matrix[16];
-    calculate_aspect_ratio_matrix(mvp_matrix, width, height, drm->mode.hdisplay, drm->mode.vdisplay);
-    glUniformMatrix4fv(gl->u_mvp_matrix, 1, GL_FALSE, mvp_matrix);
-
-    if (gl->u_use_nv12 >= 0) {
-        glUniform1i(gl->u_use_nv12, 0);
-    }
+    bind_yuv_draw(gl, video_index, keystone, width, height, drm->mode.hdisplay, drm->mode.vdisplay, 0);
     
     // YUV420P format via DMA buffer (3 separate planes)
     // Use actual video dimensions, not buffer dimensions (hardware may pad buffers)
@@ -2576,7 +2856,7 @@ void gl_render_frame_dma(gl_context_t *gl, int dma_fd, int width, int height,
     clock_gettime(CLOCK_MONOTONIC, &dma_start);
     
     if (!eglCreateImageKHR) {
-        fprintf(stderr, "[DMA] eglCreateImageKHR not loaded\n");
+        LOG_ERROR_RATELIMITED("[DMA] eglCreateImageKHR not loaded\n");
         return;
     }
     
@@ -2595,9 +2875,9 @@ void gl_render_frame_dma(gl_context_t *gl, int dma_fd, int width, int height,
                                          EGL_LINUX_DMA_BUF_EXT, (EGLClientBuffer)NULL, y_attrs);
     EGLint egl_err = eglGetError();
     if (y_image == EGL_NO_IMAGE || egl_err != EGL_SUCCESS) {
-        static int err_count[2] = {0, 0};
+        static int err_count[GL_MAX_STREAMS] = {0};
         if (err_count[video_index] < 3) {
-            fprintf(stderr, "[DMA] Video %d Y plane import failed: 0x%x (fd=%d, %dx%d, offset=%d, pitch=%d)\n",
+            LOG_ERROR_RATELIMITED("[DMA] Video %d Y plane import failed: 0x%x (fd=%d, %dx%d, offset=%d, pitch=%d)\n",
                     video_index, egl_err, dma_fd, width, height, plane_offsets[0], plane_pitches[0]);
             err_count[video_index]++;
         }
@@ -2621,7 +2901,7 @@ void gl_render_frame_dma(gl_context_t *gl, int dma_fd, int width, int height,
     if (u_image == EGL_NO_IMAGE || egl_err != EGL_SUCCESS) {
         static int err_count = 0;
         if (err_count < 3) {
-            fprintf(stderr, "[DMA] U plane import failed: 0x%x\n", egl_err);
+            LOG_ERROR_RATELIMITED("[DMA] U plane import failed: 0x%x\n", egl_err);
             err_count++;
         }
         if (eglDestroyImageKHR) {
@@ -2647,7 +2927,7 @@ void gl_render_frame_dma(gl_context_t *gl, int dma_fd, int width, int height,
     if (v_image == EGL_NO_IMAGE || egl_err != EGL_SUCCESS) {
         static int err_count = 0;
         if (err_count < 3) {
-            fprintf(stderr, "[DMA] V plane import failed: 0x%x\n", egl_err);
+            LOG_ERROR_RATELIMITED("[DMA] V plane import failed: 0x%x\n", egl_err);
             err_count++;
         }
         if (eglDestroyImageKHR) {
@@ -2664,18 +2944,12 @@ void gl_render_frame_dma(gl_context_t *gl, int dma_fd, int width, int height,
         (*glEGLImageTargetTexture2DOES)(GL_TEXTURE_2D, (GLeglImageOES)y_image);
         GLenum err = glGetError();
         if (err != GL_NO_ERROR) {
-            fprintf(stderr, "[DMA] Y plane bind error: 0x%x\n", err);
+            LOG_ERROR_RATELIMITED("[DMA] Y plane bind error: 0x%x\n", err);
         }
     } else {
-        fprintf(stderr, "[DMA] glEGLImageTargetTexture2DOES not loaded\n");
+        LOG_ERROR_RATELIMITED("[DMA] glEGLImageTargetTexture2DOES not loaded\n");
         goto cleanup_dma;
     }
-    // Set texture parameters for completeness
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glUniform1i(gl->u_texture_y, 0);
 
     // Bind U plane to texture unit 1 (use selected texture based on video_index)
     glActiveTexture(GL_TEXTURE1);
@@ -2683,13 +2957,8 @@ void gl_render_frame_dma(gl_context_t *gl, int dma_fd, int width, int height,
     (*glEGLImageTargetTexture2DOES)(GL_TEXTURE_2D, (GLeglImageOES)u_image);
     GLenum err_u = glGetError();
     if (err_u != GL_NO_ERROR) {
-        fprintf(stderr, "[DMA] U plane bind error: 0x%x\n", err_u);
+        LOG_ERROR_RATELIMITED("[DMA] U plane bind error: 0x%x\n", err_u);
     }
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glUniform1i(gl->u_texture_u, 1);
 
     // Bind V plane to texture unit 2 (use selected texture based on video_index)
     glActiveTexture(GL_TEXTURE2);
@@ -2697,27 +2966,16 @@ void gl_render_frame_dma(gl_context_t *gl, int dma_fd, int width, int height,
     (*glEGLImageTargetTexture2DOES)(GL_TEXTURE_2D, (GLeglImageOES)v_image);
     GLenum err_v = glGetError();
     if (err_v != GL_NO_ERROR) {
-        fprintf(stderr, "[DMA] V plane bind error: 0x%x\n", err_v);
+        LOG_ERROR_RATELIMITED("[DMA] V plane bind error: 0x%x\n", err_v);
     }
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glUniform1i(gl->u_texture_v, 2);
-    
-    // Set flip_y uniform (video is encoded upside down)
-    glUniform1f(gl->u_flip_y, 1.0f);
 
-    // Bind keystone matrix and render
-    const float *keystone_matrix = keystone_get_matrix(keystone);
-    glUniformMatrix4fv(gl->u_keystone_matrix, 1, GL_FALSE, keystone_matrix);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
     // Check for GL errors (only report first few)
     GLenum err = glGetError();
     static int gl_err_count = 0;
     if (err != GL_NO_ERROR && gl_err_count < 3) {
-        fprintf(stderr, "[DMA] GL error after draw: 0x%x\n", err);
+        LOG_ERROR_RATELIMITED("[DMA] GL error after draw: 0x%x\n", err);
         gl_err_count++;
     }
 
@@ -2759,180 +3017,351 @@ cleanup_dma:
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+// Import a 3-plane YUV420 DMA-BUF as a single EGLImage
+static EGLImage ext_import_image(gl_context_t *gl, int dma_fd, int width, int height,
+                                 const int plane_offsets[3], const int plane_pitches[3],
+                                 uint32_t drm_format, uint64_t modifier) {
+    static const EGLint plane_attribs[3][5] = {
+        {EGL_DMA_BUF_PLANE0_FD_EXT, EGL_DMA_BUF_PLANE0_OFFSET_EXT, EGL_DMA_BUF_PLANE0_PITCH_EXT,
+         EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT},
+        {EGL_DMA_BUF_PLANE1_FD_EXT, EGL_DMA_BUF_PLANE1_OFFSET_EXT, EGL_DMA_BUF_PLANE1_PITCH_EXT,
+         EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT},
+        {EGL_DMA_BUF_PLANE2_FD_EXT, EGL_DMA_BUF_PLANE2_OFFSET_EXT, EGL_DMA_BUF_PLANE2_PITCH_EXT,
+         EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT},
+    };
+
+    // Linear layouts import without a modifier (works without the modifiers extension)
+    bool explicit_modifier = modifier != DRM_FORMAT_MOD_LINEAR && modifier != DRM_FORMAT_MOD_INVALID;
+    if (explicit_modifier && !gl->supports_dma_modifiers) {
+        static bool warned = false;
+        if (!warned) {
+            LOG_ERROR("[EXT] DMA-BUF has modifier 0x%016llx but EGL lacks "
+                    "EGL_EXT_image_dma_buf_import_modifiers\n", (unsigned long long)modifier);
+            warned = true;
+        }
+        return EGL_NO_IMAGE;
+    }
+
+    // All planes share the same DMA FD with different offsets
+    int planes = (drm_format == DRM_FORMAT_YUV420) ? 3 : 2;
+    EGLint attribs[6 + 3 * 10 + 1];
+    int n = 0;
+    attribs[n++] = EGL_WIDTH;
+    attribs[n++] = width;
+    attribs[n++] = EGL_HEIGHT;
+    attribs[n++] = height;
+    attribs[n++] = EGL_LINUX_DRM_FOURCC_EXT;
+    attribs[n++] = (EGLint)drm_format;
+    for (int p = 0; p < planes; p++) {
+        attribs[n++] = plane_attribs[p][0];
+        attribs[n++] = dma_fd;
+        attribs[n++] = plane_attribs[p][1];
+        attribs[n++] = plane_offsets[p];
+        attribs[n++] = plane_attribs[p][2];
+        attribs[n++] = plane_pitches[p];
+        if (explicit_modifier) {
+            attribs[n++] = plane_attribs[p][3];
+            attribs[n++] = (EGLint)(modifier & 0xffffffffu);
+            attribs[n++] = plane_attribs[p][4];
+            attribs[n++] = (EGLint)(modifier >> 32);
+        }
+    }
+    attribs[n++] = EGL_NONE;
+
+    if (!eglCreateImageKHR) {
+        return EGL_NO_IMAGE;
+    }
+
+    EGLImage image = eglCreateImageKHR(gl->egl_display, EGL_NO_CONTEXT,
+                                       EGL_LINUX_DMA_BUF_EXT, (EGLClientBuffer)NULL, attribs);
+    EGLint egl_err = eglGetError();
+    if (image == EGL_NO_IMAGE || egl_err != EGL_SUCCESS) {
+        static int err_count = 0;
+        if (err_count < 3) {
+            LOG_ERROR_RATELIMITED("[EXT] Multi-plane YUV EGLImage import failed: 0x%x (fourcc 0x%08x, modifier 0x%016llx)\n",
+                    egl_err, drm_format, (unsigned long long)modifier);
+            err_count++;
+        }
+        if (image != EGL_NO_IMAGE && eglDestroyImageKHR) {
+            (*eglDestroyImageKHR)(gl->egl_display, image);
+        }
+        return EGL_NO_IMAGE;
+    }
+    return image;
+}
+
+static void ext_cache_release_entry(gl_context_t *gl, ext_image_cache_entry_t *entry) {
+    if (entry->texture) {
+        glDeleteTextures(1, &entry->texture);
+    }
+    if (entry->image != EGL_NO_IMAGE && eglDestroyImageKHR) {
+        (*eglDestroyImageKHR)(gl->egl_display, entry->image);
+    }
+    memset(entry, 0, sizeof(*entry));
+}
+
+void gl_invalidate_external_cache(gl_context_t *gl, int video_index) {
+    if (!gl || video_index < 0 || video_index >= GL_MAX_STREAMS) {
+        return;
+    }
+
+    gl_stream_t *stream = &gl->streams[video_index];
+    for (int i = 0; i < stream->ext_image_cache_count; i++) {
+        ext_cache_release_entry(gl, &stream->ext_image_cache[i]);
+    }
+    if (hw_debug_enabled && stream->ext_image_cache_count > 0) {
+        LOG_INFO("[EXT] Dropped %d cached EGLImages for video %d\n",
+               stream->ext_image_cache_count, video_index);
+    }
+    stream->ext_image_cache_count = 0;
+
+    if (stream->ext_uncached_image != EGL_NO_IMAGE && eglDestroyImageKHR) {
+        (*eglDestroyImageKHR)(gl->egl_display, stream->ext_uncached_image);
+    }
+    stream->ext_uncached_image = EGL_NO_IMAGE;
+}
+
+// Find the cached import for this DMA-BUF, importing it on a miss.
+// Returns NULL when the buffer has no stable identity or import fails.
+static ext_image_cache_entry_t *ext_cache_acquire(gl_context_t *gl, int video_index, int dma_fd,
+                                                  int width, int height,
+                                                  const int plane_offsets[3], const int plane_pitches[3],
+                                                  uint32_t drm_format, uint64_t modifier) {
+    struct stat st;
+    if (fstat(dma_fd, &st) != 0 || st.st_ino == 0) {
+        return NULL;
+    }
+
+    ext_image_cache_entry_t *cache = gl->streams[video_index].ext_image_cache;
+    int *count = &gl->streams[video_index].ext_image_cache_count;
+    gl->ext_image_cache_tick++;
+
+    // Resolution change means the capture pool was rebuilt
+    if (*count > 0 && (cache[0].width != width || cache[0].height != height)) {
+        gl_invalidate_external_cache(gl, video_index);
+    }
+
+    ext_image_cache_entry_t *slot = NULL;
+    for (int i = 0; i < *count; i++) {
+        if (cache[i].ino == st.st_ino && cache[i].dev == st.st_dev) {
+            if (memcmp(cache[i].offsets, plane_offsets, sizeof(cache[i].offsets)) == 0 &&
+                memcmp(cache[i].pitches, plane_pitches, sizeof(cache[i].pitches)) == 0 &&
+                cache[i].drm_format == drm_format && cache[i].modifier == modifier) {
+                cache[i].last_used = gl->ext_image_cache_tick;
+                return &cache[i];  // Cache hit - no import
+            }
+            // Same buffer, new layout - re-import in place
+            ext_cache_release_entry(gl, &cache[i]);
+            slot = &cache[i];
+            break;
+        }
+    }
+
+    if (!slot) {
+        if (*count < EXT_IMAGE_CACHE_SIZE) {
+            slot = &cache[(*count)++];
+        } else {
+            // Evict least recently used (not sampled for several frames)
+            slot = &cache[0];
+            for (int i = 1; i < EXT_IMAGE_CACHE_SIZE; i++) {
+                if (cache[i].last_used < slot->last_used) {
+                    slot = &cache[i];
+                }
+            }
+            ext_cache_release_entry(gl, slot);
+        }
+    }
+
+    EGLImage image = ext_import_image(gl, dma_fd, width, height, plane_offsets, plane_pitches,
+                                      drm_format, modifier);
+    if (image == EGL_NO_IMAGE) {
+        // Keep the slot array dense: move the last entry into the hole
+        int idx = (int)(slot - cache);
+        if (idx != *count - 1) {
+            *slot = cache[*count - 1];
+            memset(&cache[*count - 1], 0, sizeof(cache[0]));
+        }
+        (*count)--;
+        return NULL;
+    }
+
+    slot->dev = st.st_dev;
+    slot->ino = st.st_ino;
+    slot->width = width;
+    slot->height = height;
+    memcpy(slot->offsets, plane_offsets, sizeof(slot->offsets));
+    memcpy(slot->pitches, plane_pitches, sizeof(slot->pitches));
+    slot->drm_format = drm_format;
+    slot->modifier = modifier;
+    slot->image = image;
+    slot->last_used = gl->ext_image_cache_tick;
+
+    // Bind once; later frames from this buffer only need glBindTexture
+    glGenTextures(1, &slot->texture);
+    glActiveTexture(GL_TEXTURE0 + video_index);
+    glBindTexture(GL_TEXTURE_EXTERNAL_OES, slot->texture);
+    if (glEGLImageTargetTexture2DOES) {
+        (*glEGLImageTargetTexture2DOES)(GL_TEXTURE_EXTERNAL_OES, (GLeglImageOES)image);
+        // Clear any GL error - some drivers report spurious errors on first few frames
+        glGetError();
+    }
+    glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    if (hw_debug_enabled) {
+        LOG_INFO("[EXT] Imported DMA-BUF ino=%lu into cache slot %d/%d (video %d)\n",
+               (unsigned long)st.st_ino, (int)(slot - cache), EXT_IMAGE_CACHE_SIZE, video_index);
+    }
+    return slot;
+}
+
 // Multi-plane YUV EGLImage rendering with external texture (zero-copy)
 // Imports DRM_PRIME buffer as single multi-plane EGLImage and renders via samplerExternalOES
 void gl_render_frame_external(gl_context_t *gl, int dma_fd, int width, int height,
                               int plane_offsets[3], int plane_pitches[3],
+                              uint32_t drm_format, uint64_t modifier,
                               struct display_ctx *drm, keystone_context_t *keystone,
                               bool clear_screen, int video_index) {
     // PRODUCTION: Validate EGL context before rendering
     if (!validate_egl_context()) {
-        fprintf(stderr, "ERROR: Cannot render external - EGL context lost\n");
+        LOG_ERROR_RATELIMITED("ERROR: Cannot render external - EGL context lost\n");
         return;
     }
     
-    if (!gl || dma_fd < 0 || !gl->supports_external_texture || !gl->external_program) {
+    if (!gl || dma_fd < 0 || !gl->supports_external_texture || !gl->external_program ||
+        video_index < 0 || video_index >= GL_MAX_STREAMS) {
         return;
     }
 
     // Select texture and texture unit based on video index
     // CRITICAL: Each video must use its own texture unit to prevent cross-contamination
-    GLuint tex_external = (video_index == 0) ? gl->texture_external : gl->texture_external2;
-    GLenum texture_unit = (video_index == 0) ? GL_TEXTURE0 : GL_TEXTURE1;
-    GLint sampler_unit = (video_index == 0) ? 0 : 1;
+    gl_stream_t *stream = &gl->streams[video_index];
+    GLuint tex_external = stream->texture_external;
+    GLenum texture_unit = GL_TEXTURE0 + video_index;
+    GLint sampler_unit = video_index;
 
     // Set up rendering state
-    glViewport(0, 0, drm->mode.hdisplay, drm->mode.vdisplay);
+    set_viewport(gl, drm->mode.hdisplay, drm->mode.vdisplay);
     if (clear_screen && video_index == 0) {
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
     }
-
-    // Use external shader program
-    glUseProgram(gl->external_program);
-
-    // Set up vertex attributes (using existing VBO)
-    glBindBuffer(GL_ARRAY_BUFFER, gl->vbo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl->ebo);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glDisable(GL_BLEND);
-    glDisable(GL_DEPTH_TEST);
-
-    // Set MVP matrix with aspect ratio preservation
-    float mvp_matrix[16];
-    calculate_aspect_ratio_matrix(mvp_matrix, width, height, drm->mode.hdisplay, drm->mode.vdisplay);
-    glUniformMatrix4fv(gl->ext_u_mvp_matrix, 1, GL_FALSE, mvp_matrix);
-
-    // Set keystone matrix
-    const float *keystone_matrix = keystone_get_matrix(keystone);
-    glUniformMatrix4fv(gl->ext_u_keystone_matrix, 1, GL_FALSE, keystone_matrix);
-
-    // Flip Y coordinate for video
-    glUniform1f(gl->ext_u_flip_y, 1.0f);
-
-    // Create multi-plane YUV EGLImage using DRM_FORMAT_YUV420
-    // All three planes share the same DMA FD with different offsets
-    EGLint attribs[] = {
-        EGL_WIDTH, width,
-        EGL_HEIGHT, height,
-        EGL_LINUX_DRM_FOURCC_EXT, DRM_FORMAT_YUV420,
-        EGL_DMA_BUF_PLANE0_FD_EXT, dma_fd,
-        EGL_DMA_BUF_PLANE0_OFFSET_EXT, plane_offsets[0],
-        EGL_DMA_BUF_PLANE0_PITCH_EXT, plane_pitches[0],
-        EGL_DMA_BUF_PLANE1_FD_EXT, dma_fd,
-        EGL_DMA_BUF_PLANE1_OFFSET_EXT, plane_offsets[1],
-        EGL_DMA_BUF_PLANE1_PITCH_EXT, plane_pitches[1],
-        EGL_DMA_BUF_PLANE2_FD_EXT, dma_fd,
-        EGL_DMA_BUF_PLANE2_OFFSET_EXT, plane_offsets[2],
-        EGL_DMA_BUF_PLANE2_PITCH_EXT, plane_pitches[2],
-        EGL_NONE
-    };
-
-    EGLImage yuv_image = eglCreateImageKHR(gl->egl_display, EGL_NO_CONTEXT,
-                                           EGL_LINUX_DMA_BUF_EXT, (EGLClientBuffer)NULL, attribs);
-    EGLint egl_err = eglGetError();
-    if (yuv_image == EGL_NO_IMAGE || egl_err != EGL_SUCCESS) {
-        static int err_count = 0;
-        if (err_count < 3) {
-            fprintf(stderr, "[EXT] Multi-plane YUV EGLImage import failed: 0x%x\n", egl_err);
-            err_count++;
+    bind_video_program(gl, gl->external_program);
+
+    // ESSL 1.00 has no uniform blocks: the program holds one stream's matrices at a
+    // time, so they are re-sent only when another stream drew last or they changed
+    update_stream_transform(gl, video_index, keystone, width, height,
+                            drm->mode.hdisplay, drm->mode.vdisplay);
+    if (gl->state.ext_uniform_stream != video_index ||
+        gl->state.ext_uniform_serial != stream->transform_serial) {
+        glUniformMatrix4fv(gl->ext_u_mvp_matrix, 1, GL_FALSE, stream->transform.mvp);
+        glUniformMatrix4fv(gl->ext_u_keystone_matrix, 1, GL_FALSE, stream->transform.keystone);
+        glUniform1f(gl->ext_u_flip_y, stream->transform.flip_y);
+        gl->state.ext_uniform_stream = video_index;
+        gl->state.ext_uniform_serial = stream->transform_serial;
+    }
+
+    // Look up (or import once) the EGLImage for this DMA-BUF
+    ext_image_cache_entry_t *entry = ext_cache_acquire(gl, video_index, dma_fd, width, height,
+                                                       plane_offsets, plane_pitches, drm_format, modifier);
+    if (entry) {
+        glActiveTexture(texture_unit);
+        glBindTexture(GL_TEXTURE_EXTERNAL_OES, entry->texture);
+        gl->state.external_bound = true;
+    } else {
+        // No stable buffer identity - import per frame and destroy one frame later
+        EGLImage yuv_image = ext_import_image(gl, dma_fd, width, height, plane_offsets, plane_pitches,
+                                              drm_format, modifier);
+        if (yuv_image == EGL_NO_IMAGE) {
+            return;
         }
-        return;
-    }
+        glActiveTexture(texture_unit);
+        glBindTexture(GL_TEXTURE_EXTERNAL_OES, tex_external);
+        if (glEGLImageTargetTexture2DOES) {
+            (*glEGLImageTargetTexture2DOES)(GL_TEXTURE_EXTERNAL_OES, (GLeglImageOES)yuv_image);
+            glGetError();
+        }
+        gl->state.external_bound = true;
 
-    // Bind to GL_TEXTURE_EXTERNAL_OES using video-specific texture unit
-    glActiveTexture(texture_unit);
-    glBindTexture(GL_TEXTURE_EXTERNAL_OES, tex_external);
-    if (glEGLImageTargetTexture2DOES) {
-        (*glEGLImageTargetTexture2DOES)(GL_TEXTURE_EXTERNAL_OES, (GLeglImageOES)yuv_image);
-        // Clear any GL error - some drivers report spurious errors on first few frames
-        glGetError();
+        if (stream->ext_uncached_image != EGL_NO_IMAGE && eglDestroyImageKHR) {
+            (*eglDestroyImageKHR)(gl->egl_display, stream->ext_uncached_image);
+        }
+        stream->ext_uncached_image = yuv_image;
     }
 
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
     // Set sampler uniform to the video-specific texture unit
-    glUniform1i(gl->ext_u_texture_external, sampler_unit);
+    if (gl->state.ext_sampler_unit != sampler_unit) {
+        glUniform1i(gl->ext_u_texture_external, sampler_unit);
+        gl->state.ext_sampler_unit = sampler_unit;
+    }
 
     // Draw
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
-    // Store EGLImage for deferred destruction
-    // We keep track of the previous frame's EGLImage and destroy it when creating a new one
-    // This ensures the GPU has finished using the image before we destroy it
-    static EGLImage prev_image[2] = {EGL_NO_IMAGE, EGL_NO_IMAGE};
-    static pthread_mutex_t prev_image_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-    // Thread-safe EGLImage destruction (protect against concurrent dual-video rendering)
-    pthread_mutex_lock(&prev_image_mutex);
-    // Destroy the PREVIOUS frame's image (GPU is done with it by now)
-    if (prev_image[video_index] != EGL_NO_IMAGE && eglDestroyImageKHR) {
-        (*eglDestroyImageKHR)(gl->egl_display, prev_image[video_index]);
-    }
-    // Store current image for destruction next frame
-    prev_image[video_index] = yuv_image;
-    pthread_mutex_unlock(&prev_image_mutex);
-
     // Log first successful render
     static bool logged = false;
     if (!logged) {
-        printf("[EXT] Zero-copy YUV420 render via external texture\n");
+        LOG_INFO("[EXT] Zero-copy render via external texture (fourcc 0x%08x, modifier 0x%016llx)\n",
+               drm_format, (unsigned long long)modifier);
         logged = true;
     }
 }
 
 void gl_cleanup(gl_context_t *gl) {
-    // Clean up YUV textures (video 1)
-    if (gl->texture_y) glDeleteTextures(1, &gl->texture_y);
-    if (gl->texture_u) glDeleteTextures(1, &gl->texture_u);
-    if (gl->texture_v) glDeleteTextures(1, &gl->texture_v);
-    if (gl->texture_nv12) glDeleteTextures(1, &gl->texture_nv12);
-    if (gl->texture_nv12_2) glDeleteTextures(1, &gl->texture_nv12_2);
-    
-    // Clean up YUV textures (video 2)
-    if (gl->texture_y2) glDeleteTextures(1, &gl->texture_y2);
-    if (gl->texture_u2) glDeleteTextures(1, &gl->texture_u2);
-    if (gl->texture_v2) glDeleteTextures(1, &gl->texture_v2);
+    // Clean up per-stream YUV textures
+    for (int i = 0; i < GL_MAX_STREAMS; i++) {
+        gl_stream_t *stream = &gl->streams[i];
+        if (stream->texture_y) glDeleteTextures(1, &stream->texture_y);
+        if (stream->texture_u) glDeleteTextures(1, &stream->texture_u);
+        if (stream->texture_v) glDeleteTextures(1, &stream->texture_v);
+        if (stream->texture_nv12) glDeleteTextures(1, &stream->texture_nv12);
+    }
     
     // Clean up PBOs
-    if (gl->pbo[0][0] || gl->pbo[0][1] || gl->pbo[0][2] ||
-        gl->pbo[1][0] || gl->pbo[1][1] || gl->pbo[1][2]) {
-        glDeleteBuffers(PBO_RING_COUNT * 3, &gl->pbo[0][0]);
+    if (gl->pbo[0][0] && gl->pbo_ring_count > 0) {
+        glDeleteBuffers(gl->pbo_ring_count * 3, &gl->pbo[0][0]);
     }
     
+    frame_pool_destroy(gl);
+    
     // Clean up PBO fences
-    for (int i = 0; i < PBO_RING_COUNT; i++) {
+    for (int i = 0; i < PBO_RING_MAX; i++) {
         if (gl->pbo_fences[i]) {
             glDeleteSync(gl->pbo_fences[i]);
             gl->pbo_fences[i] = 0;
         }
     }
     
+    for (int i = 0; i < GL_MAX_STREAMS; i++) {
+        if (gl->streams[i].transform_ubo) glDeleteBuffers(1, &gl->streams[i].transform_ubo);
+    }
+    if (gl->video_sampler) glDeleteSamplers(1, &gl->video_sampler);
+    if (gl->vao) glDeleteVertexArrays(1, &gl->vao);
     if (gl->vbo) glDeleteBuffers(1, &gl->vbo);
     if (gl->ebo) glDeleteBuffers(1, &gl->ebo);
     if (gl->corner_vbo) glDeleteBuffers(1, &gl->corner_vbo);
     if (gl->border_vbo) glDeleteBuffers(1, &gl->border_vbo);
     if (gl->help_vbo) glDeleteBuffers(1, &gl->help_vbo);
+    if (gl->text_vbo) glDeleteBuffers(1, &gl->text_vbo);
+    if (gl->glyph_atlas) glDeleteTextures(1, &gl->glyph_atlas);
+    if (gl->overlay.fbo) glDeleteFramebuffers(1, &gl->overlay.fbo);
+    if (gl->overlay.texture) glDeleteTextures(1, &gl->overlay.texture);
     if (gl->program) glDeleteProgram(gl->program);
     if (gl->corner_program) glDeleteProgram(gl->corner_program);
+    if (gl->overlay_program) glDeleteProgram(gl->overlay_program);
     if (gl->external_program) glDeleteProgram(gl->external_program);
     if (gl->vertex_shader) glDeleteShader(gl->vertex_shader);
     if (gl->fragment_shader) glDeleteShader(gl->fragment_shader);
 
-    // Clean up external textures
-    if (gl->texture_external) glDeleteTextures(1, &gl->texture_external);
-    if (gl->texture_external2) glDeleteTextures(1, &gl->texture_external2);
+    // Clean up cached DMA-BUF imports before their textures go away
+    for (int i = 0; i < GL_MAX_STREAMS; i++) {
+        gl_invalidate_external_cache(gl, i);
+        if (gl->streams[i].texture_external) glDeleteTextures(1, &gl->streams[i].texture_external);
+    }
 
     // Clean up pre-allocated YUV buffers
-    free_yuv_buffers();
     
     if (gl->egl_surface != EGL_NO_SURFACE) {
         eglDestroySurface(gl->egl_display, gl->egl_surface);
@@ -5,12 +5,114 @@
 #include <GLES3/gl31.h>  // OpenGL ES 3.1 for modern features
 #include <gbm.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
 #include "drm_display.h"
 #include "keystone.h"
 
 // Forward declarations
 struct display_ctx;
 
+// EGLImage cache for the external texture path. V4L2 M2M cycles a small
+// fixed capture pool, so each DMA-BUF is imported once and then reused.
+#define EXT_IMAGE_CACHE_SIZE 8
+
+#define PBO_RING_MAX 8
+
+// PBO ring health for the timing report
+typedef struct {
+    unsigned int uploads;        // Frames staged through a retired slot
+    unsigned int backpressure;   // Frames that found every slot still in flight
+    double retire_ms_avg;        // Fence submit -> observed signaled (EWMA)
+    double retire_ms_max;
+    double last_retire_time;     // CLOCK_MONOTONIC seconds of the latest retirement
+} gl_pbo_stats_t;
+
+typedef struct {
+    dev_t dev;                       // DMA-BUF identity from fstat() (fd numbers get reused)
+    ino_t ino;
+    int width;
+    int height;
+    int offsets[3];
+    int pitches[3];
+    uint32_t drm_format;
+    uint64_t modifier;
+    EGLImage image;
+    GLuint texture;                  // External texture with the image bound at import time
+    uint64_t last_used;              // LRU stamp
+} ext_image_cache_entry_t;
+
+// Per-stream texture set. Each stream samples from its own textures so
+// uploads for one stream never alias another stream's frame.
+#define GL_MAX_STREAMS 4
+
+// std140 layout of the vertex shader's TransformMatrices uniform block
+typedef struct {
+    float mvp[16];                   // Aspect-ratio fit of the video into the display
+    float keystone[16];
+    float flip_y;
+    float pad[3];
+} gl_transform_block_t;
+
+typedef struct {
+    GLuint texture_y;                // Y plane texture
+    GLuint texture_u;                // U plane texture
+    GLuint texture_v;                // V plane texture
+    GLuint texture_nv12;             // NV12 UV interleaved texture
+    GLuint texture_external;         // External texture for YUV EGLImage
+
+    // Persistent DMA-BUF imports (see EXT_IMAGE_CACHE_SIZE)
+    ext_image_cache_entry_t ext_image_cache[EXT_IMAGE_CACHE_SIZE];
+    int ext_image_cache_count;
+    EGLImage ext_uncached_image;     // Deferred-destroy image when fstat() identity is unavailable
+    unsigned int ext_pool_generation; // Decoder capture pool the cached imports belong to
+    unsigned int ext_isp_generation;  // ISP output pool the cached imports belong to
+
+    // Transform UBO, rewritten only when the keystone matrix or a size changes
+    GLuint transform_ubo;
+    gl_transform_block_t transform;
+    const keystone_context_t *transform_keystone;
+    unsigned int transform_keystone_version;
+    int transform_width, transform_height;
+    int transform_display_width, transform_display_height;
+    unsigned int transform_serial;   // Bumped on every rewrite (0: never written)
+} gl_stream_t;
+
+// Render-state cache: video draws skip GL calls for state that is already
+// current. Anything that binds another program goes through bind_program(),
+// which marks the video raster state unknown again.
+typedef struct {
+    GLuint program;
+    GLuint vao;
+    GLuint transform_ubo;            // Bound at transform_binding_point
+    int viewport_width;
+    int viewport_height;
+    int use_nv12;                    // Last u_use_nv12 value (-1 unknown)
+    bool video_raster;               // Blend and depth test known to be off
+    bool external_bound;             // External textures may still sit on units 0..GL_MAX_STREAMS-1
+    int ext_uniform_stream;          // Stream whose transform external_program holds (-1 none)
+    unsigned int ext_uniform_serial;
+    GLint ext_sampler_unit;          // Last u_texture_external unit (-1 unknown)
+} gl_render_state_t;
+
+// Overlay layer: help, notification and keystone guides are drawn into an
+// offscreen RGBA texture only when their content key changes. Every frame
+// composites that texture as one premultiplied-alpha quad.
+#define GL_OVERLAY_TEXTURE_UNIT 4        // Past the video units, so no sampler object applies
+#define GL_TEXT_MAX_GLYPHS 1024          // Glyph quads per draw_text() call
+
+typedef struct {
+    GLuint fbo;
+    GLuint texture;
+    int width;
+    int height;
+    uint64_t content_key;            // Key the texture was last rendered for
+    bool valid;                      // texture holds content_key at width x height
+    bool recording;                  // Between gl_overlay_begin() and gl_overlay_end()
+    bool unavailable;                // FBO incomplete: overlays draw straight to the framebuffer
+    unsigned int redraws;
+} gl_overlay_layer_t;
+
 typedef struct {
     EGLDisplay egl_display;
     EGLContext egl_context;
@@ -21,47 +123,36 @@ typedef struct {
     GLuint vertex_shader;
     GLuint fragment_shader;
     
-    // YUV textures for hardware decoded video (video 1)
-    GLuint texture_y;     // Y plane texture
-    GLuint texture_u;     // U plane texture  
-    GLuint texture_v;     // V plane texture
-    GLuint texture_nv12;  // NV12 UV interleaved texture (video 1)
-    GLuint texture_nv12_2;// NV12 UV interleaved texture (video 2)
+    // Per-stream textures, indexed by video_index
+    gl_stream_t streams[GL_MAX_STREAMS];
+    gl_render_state_t state;
     
-    // YUV textures for second video (video 2)
-    GLuint texture_y2;    // Y plane texture (video 2)
-    GLuint texture_u2;    // U plane texture (video 2)
-    GLuint texture_v2;    // V plane texture (video 2)
-    
-    // Pixel Buffer Objects for async texture staging
-    GLuint pbo[2][3];     // Double-buffered PBOs per Y/U/V plane
-    GLsync pbo_fences[2]; // Fences for PBO synchronization
+    // Pixel Buffer Objects for async texture staging (ring of PICKLE_PBO_RING slots)
+    GLuint pbo[PBO_RING_MAX][3];        // Per-slot PBOs per Y/U/V plane
+    GLsync pbo_fences[PBO_RING_MAX];    // Per-slot fence; 0 once the GPU has retired the slot
+    double pbo_fence_submit[PBO_RING_MAX]; // CLOCK_MONOTONIC seconds the slot's fence was queued
     size_t pbo_size[3];   // Allocated bytes per plane
-    int pbo_index;        // Current staging buffer slot
+    int pbo_ring_count;   // Active ring depth (2..PBO_RING_MAX)
+    int pbo_index;        // Next slot to try (oldest submission)
     bool use_pbo;         // Enable PBO async uploads
     bool pbo_warned;      // Prevent repeated fallback logs
+    gl_pbo_stats_t pbo_stats;
+    struct gl_frame_pool *frame_pool;  // Decode-to-PBO buffers (NULL unless enabled)
     
     GLuint vbo;
     GLuint ebo;
-    GLuint vao;
+    GLuint vao;                // Video quad: vbo/ebo with position + texcoord at locations 0/1
+    GLuint video_sampler;      // Linear/clamp sampler bound to the video texture units
     
-    // Modern ES 3.1 Uniform Buffer Objects
-    GLuint transform_ubo;      // TransformMatrices UBO
-    GLuint video_settings_ubo; // VideoSettings UBO
-    
-    // UBO binding points
+    // TransformMatrices block binding (per-stream UBOs, see gl_stream_t)
     GLuint transform_binding_point;
-    GLuint video_settings_binding_point;
     
-    // Legacy uniform locations (fallback)
-    GLint u_mvp_matrix;
+    // Sampler units are fixed at link time: Y=0, U=1, V=2, NV12 UV=3
     GLint u_texture_y;    // Y plane sampler
     GLint u_texture_u;    // U plane sampler
     GLint u_texture_v;    // V plane sampler
     GLint u_texture_nv12; // NV12 UV sampler
     GLint u_use_nv12;     // Toggle for NV12 path
-    GLint u_keystone_matrix;
-    GLint u_flip_y;       // Flip texture Y coordinate (for upside-down videos)
     
     // Vertex attributes
     GLint a_position;
@@ -79,17 +170,23 @@ typedef struct {
     
     // Help overlay rendering
     GLuint help_vbo;
+
+    // Textured overlays: glyph atlas text and the cached overlay layer
+    GLuint overlay_program;
+    GLint overlay_u_color;
+    GLint overlay_u_texture;
+    GLuint glyph_atlas;              // 16x8 cells of 8x8 texels, one per ASCII code
+    GLuint text_vbo;
+    gl_overlay_layer_t overlay;
     
     // GPU sync objects for pipelining
     GLsync gpu_fence;
     
     // EGL DMA buffer zero-copy support
     bool supports_egl_image;         // True if EGL_EXT_image_dma_buf_import supported
+    bool supports_dma_modifiers;     // EGL_EXT_image_dma_buf_import_modifiers (SAND layouts)
     bool supports_external_texture;  // True if GL_OES_EGL_image_external supported
-    EGLImage egl_image_y;            // EGL image for Y plane (DMA-backed)
-    EGLImage egl_image_uv;           // EGL image for UV plane (DMA-backed) - NV12 packed
-    EGLImage egl_image_y2;           // EGL image for Y plane (video 2)
-    EGLImage egl_image_uv2;          // EGL image for UV plane (video 2)
+    bool supports_native_fence;      // True if EGL_ANDROID_native_fence_sync (atomic IN_FENCE_FD)
 
     // External texture program (for zero-copy YUV import)
     GLuint external_program;         // Shader program using samplerExternalOES
@@ -97,10 +194,7 @@ typedef struct {
     GLint ext_u_keystone_matrix;     // Keystone matrix uniform
     GLint ext_u_flip_y;              // Flip Y uniform
     GLint ext_u_texture_external;    // External texture sampler uniform
-    GLuint texture_external;         // External texture for YUV EGLImage
-    GLuint texture_external2;        // External texture for video 2
-    EGLImage egl_image_yuv;          // Multi-plane YUV EGLImage (video 1)
-    EGLImage egl_image_yuv2;         // Multi-plane YUV EGLImage (video 2)
+    uint64_t ext_image_cache_tick;   // LRU clock shared by all streams' caches
 } gl_context_t;
 
 // OpenGL ES functions
@@ -118,8 +212,25 @@ void gl_render_border(gl_context_t *gl, keystone_context_t *keystone);
 void gl_render_display_boundary(gl_context_t *gl, keystone_context_t *keystone);
 void gl_render_help_overlay(gl_context_t *gl, keystone_context_t *keystone);
 void gl_render_notification_overlay(gl_context_t *gl, const char *message);
+
+// Cached overlay layer. gl_overlay_begin() returns true when the overlays must be
+// drawn (into the layer, or straight to the screen if it has no FBO); follow the
+// draws with gl_overlay_end(). gl_overlay_composite() blends the layer every frame.
+bool gl_overlay_begin(gl_context_t *gl, struct display_ctx *drm, uint64_t content_key);
+void gl_overlay_end(gl_context_t *gl);
+void gl_overlay_composite(gl_context_t *gl);
 void gl_swap_buffers(gl_context_t *gl, struct display_ctx *drm);
 
+// True when every PBO slot is still being read by the GPU (uploads would stall)
+bool gl_pbo_backpressured(gl_context_t *gl);
+void gl_get_pbo_stats(const gl_context_t *gl, gl_pbo_stats_t *out);
+
+// Decode-to-PBO: persistently mapped buffers the software decoder writes into.
+// Init on the render thread; alloc/release match video_frame_allocator_t and are thread-safe.
+int gl_frame_pool_init(gl_context_t *gl, int count, size_t slot_size);
+uint8_t *gl_frame_pool_alloc(void *pool, size_t size);
+void gl_frame_pool_release(void *pool, uint8_t *data);
+
 // DMA buffer zero-copy rendering (NV12 format) - legacy separate planes
 void gl_render_frame_dma(gl_context_t *gl, int dma_fd, int width, int height,
                         int plane_offsets[3], int plane_pitches[3],
@@ -128,8 +239,12 @@ void gl_render_frame_dma(gl_context_t *gl, int dma_fd, int width, int height,
 // DMA buffer zero-copy rendering (multi-plane YUV EGLImage with external texture)
 void gl_render_frame_external(gl_context_t *gl, int dma_fd, int width, int height,
                               int plane_offsets[3], int plane_pitches[3],
+                              uint32_t drm_format, uint64_t modifier,
                               struct display_ctx *drm, keystone_context_t *keystone, bool clear_screen, int video_index);
 
+// Drop cached DMA-BUF imports for a video (resolution change / decoder pool reallocation)
+void gl_invalidate_external_cache(gl_context_t *gl, int video_index);
+
 // Shader source code
 extern const char *vertex_shader_source;
 extern const char *fragment_shader_source;
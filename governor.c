@@ -0,0 +1,351 @@
+#define _GNU_SOURCE
+#include "governor.h"
+#include "thread_topology.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#define GOVERNOR_THERMAL_PATH "/sys/class/thermal/thermal_zone0/temp"
+#define GOVERNOR_THROTTLED_PATH "/sys/devices/platform/soc/soc:firmware/get_throttled"
+#define GOVERNOR_CPUFREQ_CUR "/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq"
+#define GOVERNOR_CPUFREQ_MAX "/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq"
+#define GOVERNOR_MISS_SMOOTHING 0.3       // Weight of the newest poll window in the miss rate
+
+// VideoCore mailbox (/dev/vcio), for kernels without the get_throttled sysfs node
+#define GOVERNOR_VCIO_PATH "/dev/vcio"
+#define GOVERNOR_MBOX_PROPERTY _IOWR(100, 0, char *)
+#define GOVERNOR_MBOX_TAG_GET_THROTTLED 0x00030046
+
+struct governor {
+    pthread_t thread;
+    pthread_mutex_t lock;        // Guards stats and wakes the thread on stop
+    pthread_cond_t cond;
+    bool running;
+
+    governor_action_t steps[GOVERNOR_MAX_LEVELS];
+    int step_count;
+    double temp_high;
+    double secondary_fps;
+
+    unsigned int actions;        // Render thread reads (atomic)
+    unsigned int frames;         // Render thread adds (atomic), governor thread takes
+    unsigned int misses;
+
+    // Governor thread only
+    int vcio_fd;                 // -1 until the sysfs node turned out to be missing
+    bool throttle_sysfs;
+    double pressure_since;       // 0 = no sustained pressure
+    double headroom_since;
+
+    governor_stats_t stats;
+};
+
+static double governor_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static bool read_sysfs_long(const char *path, int base, long *out) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+    char buf[32];
+    bool ok = fgets(buf, sizeof(buf), f) != NULL;
+    fclose(f);
+    if (!ok) {
+        return false;
+    }
+    char *end = NULL;
+    long value = strtol(buf, &end, base);
+    if (end == buf) {
+        return false;
+    }
+    *out = value;
+    return true;
+}
+
+static int read_throttled(governor_t *gov) {
+    long value = 0;
+    if (gov->throttle_sysfs) {
+        if (read_sysfs_long(GOVERNOR_THROTTLED_PATH, 16, &value)) {
+            return (int)value;
+        }
+        gov->throttle_sysfs = false;
+        gov->vcio_fd = open(GOVERNOR_VCIO_PATH, O_RDONLY | O_CLOEXEC);
+    }
+    if (gov->vcio_fd < 0) {
+        return -1;
+    }
+
+    // Property buffer: size, request, tag, value size, tag request, value, end tag
+    uint32_t msg[7] __attribute__((aligned(16))) = {
+        sizeof(msg), 0, GOVERNOR_MBOX_TAG_GET_THROTTLED, 4, 0, 0, 0
+    };
+    if (ioctl(gov->vcio_fd, GOVERNOR_MBOX_PROPERTY, msg) != 0 || !(msg[1] & 0x80000000u)) {
+        return -1;
+    }
+    return (int)msg[5];
+}
+
+static void governor_sample(governor_t *gov) {
+    long value = 0;
+    double temp_c = read_sysfs_long(GOVERNOR_THERMAL_PATH, 10, &value) ? (double)value / 1000.0 : -1.0;
+    int throttled = read_throttled(gov);
+    unsigned int arm_mhz = read_sysfs_long(GOVERNOR_CPUFREQ_CUR, 10, &value) ? (unsigned int)(value / 1000) : 0;
+    unsigned int arm_max_mhz = read_sysfs_long(GOVERNOR_CPUFREQ_MAX, 10, &value) ? (unsigned int)(value / 1000) : 0;
+
+    unsigned int frames = __atomic_exchange_n(&gov->frames, 0, __ATOMIC_RELAXED);
+    unsigned int misses = __atomic_exchange_n(&gov->misses, 0, __ATOMIC_RELAXED);
+
+    pthread_mutex_lock(&gov->lock);
+    governor_stats_t *stats = &gov->stats;
+    stats->temp_c = temp_c;
+    stats->throttled = throttled;
+    stats->arm_mhz = arm_mhz;
+    stats->arm_max_mhz = arm_max_mhz;
+    if (frames > 0) {
+        double window = (double)misses / (double)frames;
+        stats->miss_rate += GOVERNOR_MISS_SMOOTHING * (window - stats->miss_rate);
+    }
+
+    // The firmware already lowering clocks is pressure whatever the temperature says
+    bool throttling = throttled > 0 && (throttled & GOVERNOR_THROTTLE_ACTIVE_MASK);
+    bool pressure = (temp_c >= gov->temp_high) || throttling || stats->miss_rate > GOVERNOR_MISS_HIGH;
+    bool headroom = (temp_c < gov->temp_high - GOVERNOR_TEMP_HYSTERESIS_C) && !throttling &&
+                    stats->miss_rate < GOVERNOR_MISS_LOW;
+
+    double now = governor_now();
+    int level = stats->level;
+    if (pressure) {
+        gov->headroom_since = 0.0;
+        if (gov->pressure_since == 0.0) {
+            gov->pressure_since = now;
+        } else if (level < gov->step_count && now - gov->pressure_since >= GOVERNOR_ESCALATE_SECONDS) {
+            level++;
+            stats->steps_up++;
+            gov->pressure_since = now;   // The next step has to earn its own interval
+        }
+    } else if (headroom) {
+        gov->pressure_since = 0.0;
+        if (gov->headroom_since == 0.0) {
+            gov->headroom_since = now;
+        } else if (level > 0 && now - gov->headroom_since >= GOVERNOR_RECOVER_SECONDS) {
+            level--;
+            stats->steps_down++;
+            gov->headroom_since = now;
+        }
+    } else {
+        gov->pressure_since = 0.0;
+        gov->headroom_since = 0.0;
+    }
+
+    if (level != stats->level) {
+        bool up = level > stats->level;
+        governor_action_t changed = gov->steps[up ? level - 1 : level];
+        unsigned int actions = 0;
+        for (int i = 0; i < level; i++) {
+            actions |= (unsigned int)gov->steps[i];
+        }
+        stats->level = level;
+        stats->actions = actions;
+        __atomic_store_n(&gov->actions, actions, __ATOMIC_RELEASE);
+        printf("[GOVERNOR] Level %d/%d (%s %s): %.1fC throttled=0x%x arm=%u/%uMHz miss=%.1f%%\n",
+               level, gov->step_count, up ? "+" : "-",
+               governor_action_name(changed), temp_c, throttled < 0 ? 0 : (unsigned int)throttled,
+               arm_mhz, arm_max_mhz, stats->miss_rate * 100.0);
+        // A step changes the render load: judge it on fresh samples
+        stats->miss_rate = 0.0;
+    }
+    pthread_mutex_unlock(&gov->lock);
+}
+
+static void *governor_thread(void *arg) {
+    governor_t *gov = (governor_t *)arg;
+    thread_topology_set_name("pickle-governor");
+    thread_topology_bind_housekeeping();  // Started by the render thread after it went RT
+
+    pthread_mutex_lock(&gov->lock);
+    while (gov->running) {
+        pthread_mutex_unlock(&gov->lock);
+        governor_sample(gov);
+        pthread_mutex_lock(&gov->lock);
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += (long)GOVERNOR_POLL_MS * 1000000L;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        while (gov->running && pthread_cond_timedwait(&gov->cond, &gov->lock, &deadline) != ETIMEDOUT) {
+        }
+    }
+    pthread_mutex_unlock(&gov->lock);
+    return NULL;
+}
+
+static const struct {
+    const char *name;
+    governor_action_t action;
+} governor_step_names[] = {
+    { "scanout", GOVERNOR_PREFER_SCANOUT },
+    { "fps", GOVERNOR_CAP_SECONDARY },
+    { "decode", GOVERNOR_SKIP_DECODE },
+    { "overlays", GOVERNOR_HIDE_OVERLAYS }
+};
+
+const char *governor_action_name(governor_action_t action) {
+    for (size_t i = 0; i < sizeof(governor_step_names) / sizeof(governor_step_names[0]); i++) {
+        if (governor_step_names[i].action == action) {
+            return governor_step_names[i].name;
+        }
+    }
+    return "none";
+}
+
+// Comma-separated step names, in the order they are taken
+static int parse_steps(const char *spec, unsigned int available, governor_action_t *steps) {
+    int count = 0;
+    unsigned int seen = 0;
+    const char *p = spec;
+    while (*p) {
+        size_t len = strcspn(p, ",");
+        bool known = false;
+        for (size_t i = 0; i < sizeof(governor_step_names) / sizeof(governor_step_names[0]); i++) {
+            governor_action_t action = governor_step_names[i].action;
+            if (strlen(governor_step_names[i].name) == len && strncmp(p, governor_step_names[i].name, len) == 0) {
+                known = true;
+                if ((available & action) && !(seen & action) && count < GOVERNOR_MAX_LEVELS) {
+                    steps[count++] = action;
+                }
+                seen |= action;
+            }
+        }
+        if (!known && len > 0) {
+            fprintf(stderr, "[GOVERNOR] Ignoring unknown step '%.*s'\n", (int)len, p);
+        }
+        p += len;
+        if (*p == ',') {
+            p++;
+        }
+    }
+    return count;
+}
+
+governor_t *governor_start(unsigned int available) {
+    const char *spec = getenv("PICKLE_GOVERNOR");
+    if (spec && (strcmp(spec, "0") == 0 || strcmp(spec, "off") == 0)) {
+        return NULL;
+    }
+    if (!spec || !*spec || strcmp(spec, "1") == 0) {
+        spec = "scanout,fps,decode,overlays";
+    }
+
+    governor_t *gov = calloc(1, sizeof(*gov));
+    if (!gov) {
+        return NULL;
+    }
+    gov->step_count = parse_steps(spec, available, gov->steps);
+    if (gov->step_count == 0) {
+        free(gov);
+        return NULL;
+    }
+
+    gov->temp_high = GOVERNOR_TEMP_HIGH_C;
+    const char *temp_env = getenv("PICKLE_GOVERNOR_TEMP");
+    if (temp_env && atof(temp_env) > 0.0) {
+        gov->temp_high = atof(temp_env);
+    }
+    gov->secondary_fps = GOVERNOR_SECONDARY_FPS;
+    const char *fps_env = getenv("PICKLE_GOVERNOR_FPS");
+    if (fps_env && atof(fps_env) > 0.0) {
+        gov->secondary_fps = atof(fps_env);
+    }
+
+    gov->vcio_fd = -1;
+    gov->throttle_sysfs = true;
+    gov->stats.level_count = gov->step_count;
+    gov->stats.temp_c = -1.0;
+    gov->stats.throttled = -1;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&gov->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&gov->lock, NULL);
+
+    gov->running = true;
+    if (pthread_create(&gov->thread, NULL, governor_thread, gov) != 0) {
+        fprintf(stderr, "[GOVERNOR] Failed to start governor thread\n");
+        pthread_cond_destroy(&gov->cond);
+        pthread_mutex_destroy(&gov->lock);
+        free(gov);
+        return NULL;
+    }
+
+    char order[64] = "";
+    size_t len = 0;
+    for (int i = 0; i < gov->step_count; i++) {
+        len += snprintf(order + len, sizeof(order) - len, "%s%s", i ? "," : "",
+                        governor_action_name(gov->steps[i]));
+    }
+    printf("[GOVERNOR] Watching thermals (limit %.0fC), steps: %s\n", gov->temp_high, order);
+    return gov;
+}
+
+void governor_stop(governor_t *gov) {
+    if (!gov) {
+        return;
+    }
+    pthread_mutex_lock(&gov->lock);
+    gov->running = false;
+    pthread_cond_signal(&gov->cond);
+    pthread_mutex_unlock(&gov->lock);
+    pthread_join(gov->thread, NULL);
+
+    if (gov->stats.steps_up > 0) {
+        printf("[GOVERNOR] Stepped down quality %u time(s), recovered %u time(s)\n",
+               gov->stats.steps_up, gov->stats.steps_down);
+    }
+    if (gov->vcio_fd >= 0) {
+        close(gov->vcio_fd);
+    }
+    pthread_cond_destroy(&gov->cond);
+    pthread_mutex_destroy(&gov->lock);
+    free(gov);
+}
+
+void governor_note_frame(governor_t *gov, unsigned int missed) {
+    if (!gov) {
+        return;
+    }
+    __atomic_fetch_add(&gov->frames, 1, __ATOMIC_RELAXED);
+    if (missed > 0) {
+        __atomic_fetch_add(&gov->misses, missed, __ATOMIC_RELAXED);
+    }
+}
+
+unsigned int governor_actions(const governor_t *gov) {
+    return gov ? __atomic_load_n(&gov->actions, __ATOMIC_ACQUIRE) : 0;
+}
+
+double governor_secondary_fps(const governor_t *gov) {
+    return gov ? gov->secondary_fps : GOVERNOR_SECONDARY_FPS;
+}
+
+void governor_get_stats(governor_t *gov, governor_stats_t *out) {
+    if (!gov) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    pthread_mutex_lock(&gov->lock);
+    *out = gov->stats;
+    pthread_mutex_unlock(&gov->lock);
+}
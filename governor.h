@@ -0,0 +1,77 @@
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Thermal- and throttle-aware playback governor. A background thread samples
+// the SoC temperature, the firmware's throttle/under-voltage flags and the ARM
+// clock twice a second, and combines them with the render loop's deadline-miss
+// rate (missed vblanks plus frames the scheduler dropped on video 1). Sustained
+// pressure steps through the configured degradation levels one at a time;
+// sustained headroom steps back. Each level enables one more action, so the
+// cheapest-to-lose quality goes first:
+//   scanout   - put video 1 on the KMS overlay plane whenever the keystone allows
+//   fps       - cap the secondary streams at GOVERNOR_SECONDARY_FPS (PICKLE_GOVERNOR_FPS)
+//   decode    - software decoders skip the loop filter and non-reference frames
+//   overlays  - hide keystone guides and notifications (help stays available)
+//
+// PICKLE_GOVERNOR=0 disables it; PICKLE_GOVERNOR=fps,overlays (any subset, in
+// any order) sets the steps. Steps that cannot change anything for the loaded
+// streams are left out. PICKLE_GOVERNOR_TEMP overrides the temperature limit.
+#define GOVERNOR_POLL_MS 500
+#define GOVERNOR_TEMP_HIGH_C 75.0          // Step up above this; the Pi 4 firmware soft limit is 80 C
+#define GOVERNOR_TEMP_HYSTERESIS_C 7.0     // Headroom only below limit minus this
+#define GOVERNOR_MISS_HIGH 0.05            // Deadline-miss rate that counts as pressure ...
+#define GOVERNOR_MISS_LOW 0.01             // ... and the rate that counts as headroom
+#define GOVERNOR_ESCALATE_SECONDS 2.0      // Pressure held this long steps one level up
+#define GOVERNOR_RECOVER_SECONDS 15.0      // Headroom held this long steps one level down
+#define GOVERNOR_SECONDARY_FPS 15.0
+
+// Firmware throttle flags (vcgencmd get_throttled), current state bits
+#define GOVERNOR_THROTTLE_UNDERVOLT   0x1
+#define GOVERNOR_THROTTLE_FREQ_CAPPED 0x2
+#define GOVERNOR_THROTTLE_THROTTLED   0x4
+#define GOVERNOR_THROTTLE_SOFT_TEMP   0x8
+#define GOVERNOR_THROTTLE_ACTIVE_MASK 0xf
+
+typedef enum {
+    GOVERNOR_PREFER_SCANOUT = 1 << 0,
+    GOVERNOR_CAP_SECONDARY  = 1 << 1,
+    GOVERNOR_SKIP_DECODE    = 1 << 2,
+    GOVERNOR_HIDE_OVERLAYS  = 1 << 3
+} governor_action_t;
+
+#define GOVERNOR_MAX_LEVELS 4
+
+typedef struct {
+    int level;                    // Active steps (0 = full quality)
+    int level_count;
+    unsigned int actions;         // governor_action_t bits in effect
+    double temp_c;                // < 0 if no thermal zone
+    int throttled;                // Firmware flags, -1 if unavailable
+    unsigned int arm_mhz;         // 0 if cpufreq is unavailable
+    unsigned int arm_max_mhz;
+    double miss_rate;             // Smoothed fraction of frames that missed their deadline
+    unsigned int steps_up;
+    unsigned int steps_down;
+} governor_stats_t;
+
+typedef struct governor governor_t;
+
+// available: governor_action_t bits that can take effect with the loaded streams.
+// NULL when disabled or when no configured step is available.
+governor_t *governor_start(unsigned int available);
+void governor_stop(governor_t *gov);
+
+// Render thread, once per presented frame: missed = deadlines missed since the last call
+void governor_note_frame(governor_t *gov, unsigned int missed);
+
+// Actions currently in effect (0 for a NULL governor)
+unsigned int governor_actions(const governor_t *gov);
+double governor_secondary_fps(const governor_t *gov);
+
+void governor_get_stats(governor_t *gov, governor_stats_t *out);
+const char *governor_action_name(governor_action_t action);
+
+#endif // GOVERNOR_H
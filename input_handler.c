@@ -1,4 +1,5 @@
 #include "input_handler.h"
+#include "thread_topology.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -8,6 +9,9 @@
 #include <sys/select.h>
 #include <sys/ioctl.h>
 #include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
 #include <dirent.h>
 #include <termios.h>
 #include <linux/kd.h>       // For console mode constants
@@ -212,13 +216,302 @@ static void restore_terminal(input_context_t *input) {
     }
 }
 
+// ============================================================================
+// Input thread: device reads and hotplug, publishing to the render thread
+// ============================================================================
+
+enum {
+    INPUT_SRC_KEYBOARD = 1,
+    INPUT_SRC_GAMEPAD,
+    INPUT_SRC_STDIN,
+    INPUT_SRC_HOTPLUG,
+    INPUT_SRC_WAKE
+};
+
+static uint64_t input_time_ms(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static void push_cmd(input_context_t *input, input_cmd_type_t type, int code, int value) {
+    unsigned int tail = input->queue_tail;
+    unsigned int head = __atomic_load_n(&input->queue_head, __ATOMIC_ACQUIRE);
+    if (tail - head >= INPUT_QUEUE_SIZE) {
+        __atomic_fetch_add(&input->queue_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    input_cmd_t *cmd = &input->queue[tail % INPUT_QUEUE_SIZE];
+    cmd->type = (uint8_t)type;
+    cmd->code = (uint16_t)code;
+    cmd->value = value;
+    __atomic_store_n(&input->queue_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static void watch_fd(input_context_t *input, int fd, uint32_t source) {
+    struct epoll_event ev = { .events = EPOLLIN, .data.u32 = source };
+    if (epoll_ctl(input->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0 && errno != EPERM) {
+        // EPERM: regular file or /dev/null on stdin, nothing will ever arrive
+        fprintf(stderr, "[INPUT] Cannot watch fd %d: %s\n", fd, strerror(errno));
+    }
+}
+
+static void unwatch_fd(input_context_t *input, int fd) {
+    epoll_ctl(input->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+// Attempt to connect to gamepad (hotplug notification or periodic polling)
+static bool try_connect_gamepad(input_context_t *input) {
+    if (input->gamepad_fd >= 0) {
+        return true; // Already connected
+    }
+    
+    input->gamepad_fd = find_gamepad_device();
+    if (input->gamepad_fd >= 0) {
+        watch_fd(input, input->gamepad_fd, INPUT_SRC_GAMEPAD);
+        push_cmd(input, INPUT_CMD_GAMEPAD, 0, 1);
+        printf("Gamepad connected!\n");
+        return true;
+    }
+    return false;
+}
+
+static void try_connect_keyboard(input_context_t *input) {
+    if (input->use_stdin_fallback || input->keyboard_fd >= 0) {
+        return;
+    }
+    input->keyboard_fd = find_keyboard_device();
+    if (input->keyboard_fd >= 0) {
+        watch_fd(input, input->keyboard_fd, INPUT_SRC_KEYBOARD);
+        printf("Keyboard connected\n");
+    }
+}
+
+// Returns false once stdin has hit end of file
+static bool read_terminal(input_context_t *input) {
+    char ch;
+    ssize_t bytes_read = read(input->stdin_fd, &ch, 1);
+    bool any = false;
+    while (bytes_read == 1) {
+        any = true;
+        // Convert ASCII characters to our internal key codes
+        switch (ch) {
+            case 'q':
+            case 'Q':
+                push_cmd(input, INPUT_CMD_ACTION, INPUT_ACTION_QUIT, 0);
+                break;
+            case 27: // ESC - check for arrow key sequences
+                {
+                    char seq[2];
+                    if (read(input->stdin_fd, &seq[0], 1) == 1 && seq[0] == '[' &&
+                        read(input->stdin_fd, &seq[1], 1) == 1) {
+                        switch (seq[1]) {
+                            case 'A': push_cmd(input, INPUT_CMD_TAP, KEY_UP, 1); break;
+                            case 'B': push_cmd(input, INPUT_CMD_TAP, KEY_DOWN, 1); break;
+                            case 'C': push_cmd(input, INPUT_CMD_TAP, KEY_RIGHT, 1); break;
+                            case 'D': push_cmd(input, INPUT_CMD_TAP, KEY_LEFT, 1); break;
+                            default:
+                                // Unknown escape sequence, treat as quit
+                                push_cmd(input, INPUT_CMD_ACTION, INPUT_ACTION_QUIT, 0);
+                                break;
+                        }
+                    } else {
+                        // Just ESC by itself
+                        push_cmd(input, INPUT_CMD_ACTION, INPUT_ACTION_QUIT, 0);
+                    }
+                }
+                break;
+            case '1': push_cmd(input, INPUT_CMD_TAP, KEY_1, 1); break;
+            case '2': push_cmd(input, INPUT_CMD_TAP, KEY_2, 1); break;
+            case '3': push_cmd(input, INPUT_CMD_TAP, KEY_3, 1); break;
+            case '4': push_cmd(input, INPUT_CMD_TAP, KEY_4, 1); break;
+            case '5': push_cmd(input, INPUT_CMD_TAP, KEY_5, 1); break;
+            case '6': push_cmd(input, INPUT_CMD_TAP, KEY_6, 1); break;
+            case '7': push_cmd(input, INPUT_CMD_TAP, KEY_7, 1); break;
+            case '8': push_cmd(input, INPUT_CMD_TAP, KEY_8, 1); break;
+            case '\t': push_cmd(input, INPUT_CMD_TAP, KEY_TAB, 1); break;
+            case 'r':
+            case 'R':
+                push_cmd(input, INPUT_CMD_TAP, KEY_R, 1);
+                break;
+            case 's':
+            case 'S':
+            case 'p':
+            case 'P':
+                push_cmd(input, INPUT_CMD_ACTION, INPUT_ACTION_SAVE, 0);
+                break;
+            case 'c':
+            case 'C':
+                push_cmd(input, INPUT_CMD_ACTION, INPUT_ACTION_TOGGLE_CORNERS, 0);
+                break;
+            case 'b':
+            case 'B':
+                push_cmd(input, INPUT_CMD_ACTION, INPUT_ACTION_TOGGLE_BORDER, 0);
+                break;
+            case 'h':
+            case 'H':
+                push_cmd(input, INPUT_CMD_ACTION, INPUT_ACTION_TOGGLE_HELP, 0);
+                break;
+        }
+        // Read next character
+        bytes_read = read(input->stdin_fd, &ch, 1);
+    }
+    // A tty in VMIN=0 mode also reads 0 bytes when idle; only a readable fd that yields nothing is EOF
+    return any || bytes_read < 0;
+}
+
+static void read_keyboard(input_context_t *input) {
+    struct input_event ev;
+    ssize_t read_result;
+    while ((read_result = read(input->keyboard_fd, &ev, sizeof(ev))) == sizeof(ev)) {
+        if (ev.type == EV_KEY && ev.code < 256) {
+            push_cmd(input, INPUT_CMD_KEY, ev.code, ev.value);
+        }
+    }
+    
+    if (read_result < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        printf("Keyboard disconnected (error: %s), waiting for it to return...\n", strerror(errno));
+        unwatch_fd(input, input->keyboard_fd);
+        close(input->keyboard_fd);
+        input->keyboard_fd = -1;
+        // Held keys would otherwise stay down
+        push_cmd(input, INPUT_CMD_RELEASE_ALL, 0, 0);
+    }
+}
+
+static void read_gamepad(input_context_t *input) {
+    struct js_event js;
+    ssize_t read_result;
+    while ((read_result = read(input->gamepad_fd, &js, sizeof(js))) == sizeof(js)) {
+        // Skip initial state events sent when joystick is first opened
+        if (js.type & JS_EVENT_INIT) {
+            continue;
+        }
+        
+        if (js.type == JS_EVENT_BUTTON) {
+            if (js.number < 32) {
+                push_cmd(input, INPUT_CMD_BUTTON, js.number, js.value);
+            }
+        } else if (js.type == JS_EVENT_AXIS) {
+            // Only the latest position matters: published, not queued
+            if (js.number == JS_AXIS_LEFT_X) {
+                __atomic_store_n(&input->axis_latest[INPUT_AXIS_LEFT_X], js.value, __ATOMIC_RELAXED);
+            } else if (js.number == JS_AXIS_LEFT_Y) {
+                __atomic_store_n(&input->axis_latest[INPUT_AXIS_LEFT_Y], js.value, __ATOMIC_RELAXED);
+            } else if (js.number == JS_AXIS_DPAD_X) {
+                // D-pad X: convert from -32767/0/32767 to -1/0/1
+                int16_t dpad_x = (js.value < -16000) ? -1 : (js.value > 16000) ? 1 : 0;
+                __atomic_store_n(&input->axis_latest[INPUT_AXIS_DPAD_X], dpad_x, __ATOMIC_RELAXED);
+            } else if (js.number == JS_AXIS_DPAD_Y) {
+                int16_t dpad_y = (js.value < -16000) ? -1 : (js.value > 16000) ? 1 : 0;
+                __atomic_store_n(&input->axis_latest[INPUT_AXIS_DPAD_Y], dpad_y, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    
+    // Check if gamepad disconnected (read returned error other than EAGAIN)
+    if (read_result < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        printf("Gamepad disconnected (error: %s), will retry connection...\n", strerror(errno));
+        unwatch_fd(input, input->gamepad_fd);
+        close(input->gamepad_fd);
+        input->gamepad_fd = -1;
+        for (int i = 0; i < INPUT_AXIS_COUNT; i++) {
+            __atomic_store_n(&input->axis_latest[i], 0, __ATOMIC_RELAXED);
+        }
+        push_cmd(input, INPUT_CMD_GAMEPAD, 0, 0);
+        input->last_gamepad_poll_time = input_time_ms();
+    }
+}
+
+// New nodes show up with root-only permissions; udev's chmod arrives as IN_ATTRIB
+static void handle_hotplug(input_context_t *input) {
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t len;
+    while ((len = read(input->inotify_fd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + len; ) {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            if (event->len > 0) {
+                if (strncmp(event->name, "js", 2) == 0) {
+                    try_connect_gamepad(input);
+                } else if (strncmp(event->name, "event", 5) == 0) {
+                    try_connect_keyboard(input);
+                }
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+// One round of device reads: blocks up to timeout_ms (-1 = until something happens)
+static void input_pump(input_context_t *input, int timeout_ms) {
+    struct epoll_event events[8];
+    int count = epoll_wait(input->epoll_fd, events, 8, timeout_ms);
+    for (int i = 0; i < count; i++) {
+        switch (events[i].data.u32) {
+            case INPUT_SRC_KEYBOARD:
+                if (input->keyboard_fd >= 0) {
+                    read_keyboard(input);
+                }
+                break;
+            case INPUT_SRC_GAMEPAD:
+                if (input->gamepad_fd >= 0) {
+                    read_gamepad(input);
+                }
+                break;
+            case INPUT_SRC_STDIN:
+                if (!read_terminal(input) && (events[i].events & EPOLLHUP)) {
+                    unwatch_fd(input, input->stdin_fd);
+                }
+                break;
+            case INPUT_SRC_HOTPLUG:
+                handle_hotplug(input);
+                break;
+            case INPUT_SRC_WAKE: {
+                uint64_t value;
+                (void)!read(input->wake_fd, &value, sizeof(value));
+                break;
+            }
+        }
+    }
+    
+    // Without inotify, look for the gamepad every 3 seconds
+    if (input->inotify_fd < 0 && input->gamepad_fd < 0) {
+        uint64_t current_time = input_time_ms();
+        if (current_time - input->last_gamepad_poll_time > 3000) {
+            input->last_gamepad_poll_time = current_time;
+            try_connect_gamepad(input);
+        }
+    }
+}
+
+static void *input_thread_main(void *arg) {
+    input_context_t *input = (input_context_t *)arg;
+    thread_topology_set_name("pickle-input");
+    
+    while (!__atomic_load_n(&input->thread_stop, __ATOMIC_ACQUIRE)) {
+        int timeout_ms = (input->inotify_fd < 0 && input->gamepad_fd < 0) ? 3000 : -1;
+        input_pump(input, timeout_ms);
+    }
+    return NULL;
+}
+
 int input_init(input_context_t *input) {
     memset(input, 0, sizeof(*input));
+    input->keyboard_fd = -1;
+    input->gamepad_fd = -1;
+    input->stdin_fd = -1;
+    input->inotify_fd = -1;
+    input->wake_fd = -1;
+    input->initialized = true;
+    
+    input->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (input->epoll_fd < 0) {
+        fprintf(stderr, "[INPUT] epoll_create1 failed: %s\n", strerror(errno));
+        return -1;
+    }
     
     // Initialize gamepad polling timer
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    input->last_gamepad_poll_time = (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    input->last_gamepad_poll_time = input_time_ms();
     
     // Check if we're in SSH or other terminal-only environment
     bool prefer_terminal = (getenv("SSH_CLIENT") != NULL) || 
@@ -254,11 +547,17 @@ int input_init(input_context_t *input) {
     }
     
     input->should_quit = false;
+    if (input->use_stdin_fallback) {
+        watch_fd(input, input->stdin_fd, INPUT_SRC_STDIN);
+    } else {
+        watch_fd(input, input->keyboard_fd, INPUT_SRC_KEYBOARD);
+    }
     
     // Try to initialize gamepad (optional, doesn't fail if not found)
     input->gamepad_fd = find_gamepad_device();
     if (input->gamepad_fd >= 0) {
         input->gamepad_enabled = true;
+        watch_fd(input, input->gamepad_fd, INPUT_SRC_GAMEPAD);
         printf("Gamepad input enabled\n");
     } else {
         input->gamepad_enabled = false;
@@ -266,26 +565,46 @@ int input_init(input_context_t *input) {
         printf("No gamepad detected (keyboard/terminal input only)\n");
     }
     
+    // Hotplug: gamepads and keyboards are picked up the moment their node appears
+    input->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (input->inotify_fd >= 0 && inotify_add_watch(input->inotify_fd, "/dev/input", IN_CREATE | IN_ATTRIB) < 0) {
+        close(input->inotify_fd);
+        input->inotify_fd = -1;
+    }
+    if (input->inotify_fd >= 0) {
+        watch_fd(input, input->inotify_fd, INPUT_SRC_HOTPLUG);
+    } else {
+        printf("[INPUT] No hotplug notification, polling for a gamepad every 3 s\n");
+    }
+    
+    input->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (input->wake_fd >= 0) {
+        watch_fd(input, input->wake_fd, INPUT_SRC_WAKE);
+        if (pthread_create(&input->thread, NULL, input_thread_main, input) == 0) {
+            input->thread_running = true;
+        }
+    }
+    if (!input->thread_running) {
+        fprintf(stderr, "[INPUT] No input thread, polling devices from the render loop\n");
+    }
+    
     // Input handler initialization complete
     return 0;
 }
 
-// Attempt to connect to gamepad (used for periodic polling)
-static bool try_connect_gamepad(input_context_t *input) {
-    if (input->gamepad_fd >= 0) {
-        return true; // Already connected
+void input_cleanup(input_context_t *input) {
+    if (!input->initialized) {
+        return;
     }
     
-    input->gamepad_fd = find_gamepad_device();
-    if (input->gamepad_fd >= 0) {
-        input->gamepad_enabled = true;
-        printf("Gamepad connected!\n");
-        return true;
+    if (input->thread_running) {
+        __atomic_store_n(&input->thread_stop, true, __ATOMIC_RELEASE);
+        uint64_t one = 1;
+        (void)!write(input->wake_fd, &one, sizeof(one));
+        pthread_join(input->thread, NULL);
+        input->thread_running = false;
     }
-    return false;
-}
-
-void input_cleanup(input_context_t *input) {
+    
     if (input->keyboard_fd >= 0) {
         close(input->keyboard_fd);
     }
@@ -294,26 +613,156 @@ void input_cleanup(input_context_t *input) {
         close(input->gamepad_fd);
     }
     
+    if (input->inotify_fd >= 0) {
+        close(input->inotify_fd);
+    }
+    if (input->wake_fd >= 0) {
+        close(input->wake_fd);
+    }
+    if (input->epoll_fd >= 0) {
+        close(input->epoll_fd);
+    }
+    
     // Restore terminal if we were using stdin fallback
     restore_terminal(input);
     
     memset(input, 0, sizeof(*input));
 }
 
-void input_update(input_context_t *input) {
-    static bool prev_keys[256] = {false};
-    
-    // Periodically poll for gamepad connection (every 3 seconds)
-    if (!input->gamepad_enabled) {
-        struct timeval tv;
-        gettimeofday(&tv, NULL);
-        uint64_t current_time = (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
-        
-        if (current_time - input->last_gamepad_poll_time > 3000) {
-            input->last_gamepad_poll_time = current_time;
-            try_connect_gamepad(input);
+// ============================================================================
+// Render thread: apply what the input thread queued since the last frame
+// ============================================================================
+
+static void apply_key(input_context_t *input, int code, int value) {
+    // Update key state
+    input->keys_pressed[code] = (value != 0);
+    
+    if (value == 1) {
+        switch (code) {
+            case KEY_Q:
+            case KEY_ESC:
+                input->should_quit = true;
+                printf("Quit requested\n");
+                break;
+            case KEY_C:
+                input->toggle_corners = true;
+                break;
         }
     }
+}
+
+static void apply_tap(input_context_t *input, int code) {
+    input->keys_just_pressed[code] = true;
+    if (code == KEY_UP || code == KEY_DOWN || code == KEY_LEFT || code == KEY_RIGHT) {
+        input->keys_pressed[code] = true;
+    }
+}
+
+static void apply_action(input_context_t *input, input_action_t action) {
+    switch (action) {
+        case INPUT_ACTION_QUIT:
+            input->should_quit = true;
+            printf("Quit requested\n");
+            break;
+        case INPUT_ACTION_SAVE:
+            input->save_keystone = true;
+            break;
+        case INPUT_ACTION_TOGGLE_CORNERS:
+            input->toggle_corners = true;
+            break;
+        case INPUT_ACTION_TOGGLE_BORDER:
+            input->toggle_border = true;
+            break;
+        case INPUT_ACTION_TOGGLE_HELP:
+            input->toggle_help = true;
+            break;
+    }
+}
+
+static void apply_button(input_context_t *input, int number, int value) {
+    bool was_pressed = input->gamepad_buttons[number];
+    input->gamepad_buttons[number] = (value != 0);
+    
+    // Detect button press (rising edge)
+    if (was_pressed || !input->gamepad_buttons[number]) {
+        return;
+    }
+    input->gamepad_buttons_just_pressed[number] = true;
+    
+    // Debug logging with CORRECTED button names
+    if (input->debug_gamepad) {
+        const char *btn_names[] = {
+            "A",       // 0
+            "B",       // 1
+            "?",       // 2
+            "X",       // 3
+            "Y",       // 4
+            "?",       // 5
+            "L1",      // 6
+            "R1",      // 7
+            "HOME",    // 8
+            "?",       // 9
+            "SELECT",  // 10
+            "START"    // 11
+        };
+        const char *btn_name = (number < 12) ? btn_names[number] : "UNKNOWN";
+        printf("[GAMEPAD] Button pressed: %s (button %d)\n", btn_name, number);
+    }
+    
+    // Map specific buttons to actions
+    // 8BitDo Zero 2 actual button layout: B=0, A=1, L1=2, X=3, Y=4, R1=5
+    if (number == JS_BUTTON_X) {  // Button 3 = TOP button (X)
+        input->gamepad_cycle_corner = true;
+    } else if (number == JS_BUTTON_B) {  // Button 0 = BOTTOM button (B)
+        input->gamepad_toggle_corner_border = true;
+    } else if (number == JS_BUTTON_Y) {  // Button 4 = LEFT button (Y)
+        input->toggle_help = true;
+    } else if (number == JS_BUTTON_L1) {
+        input->gamepad_increase_step = true;
+        if (input->debug_gamepad) printf("[GAMEPAD] L1 pressed - increase step\n");
+    } else if (number == JS_BUTTON_R1) {
+        input->gamepad_decrease_step = true;
+        if (input->debug_gamepad) printf("[GAMEPAD] R1 pressed - decrease step\n");
+    } else if (number == JS_BUTTON_SELECT) {
+        input->gamepad_reset_keystone = true;
+    } else if (number == JS_BUTTON_START) {
+        input->save_keystone = true;
+    } else if (number == JS_BUTTON_HOME) {
+        input->gamepad_toggle_mode = true;
+    }
+}
+
+static void apply_cmd(input_context_t *input, const input_cmd_t *cmd) {
+    switch (cmd->type) {
+        case INPUT_CMD_KEY:
+            apply_key(input, cmd->code, cmd->value);
+            break;
+        case INPUT_CMD_TAP:
+            apply_tap(input, cmd->code);
+            break;
+        case INPUT_CMD_ACTION:
+            apply_action(input, (input_action_t)cmd->code);
+            break;
+        case INPUT_CMD_BUTTON:
+            apply_button(input, cmd->code, cmd->value);
+            break;
+        case INPUT_CMD_GAMEPAD:
+            input->gamepad_enabled = (cmd->value != 0);
+            if (!input->gamepad_enabled) {
+                memset(input->gamepad_buttons, false, sizeof(input->gamepad_buttons));
+                input->gamepad_start_select_time = 0;
+            }
+            break;
+        case INPUT_CMD_RELEASE_ALL:
+            memset(input->keys_pressed, false, sizeof(input->keys_pressed));
+            break;
+    }
+}
+
+void input_update(input_context_t *input) {
+    if (!input->thread_running) {
+        input_pump(input, 0);
+    }
     
     if (input->use_stdin_fallback) {
         // Terminal mode has no key-up events; treat directional keys as one-shot
@@ -322,201 +771,15 @@ void input_update(input_context_t *input) {
         input->keys_pressed[KEY_LEFT] = false;
         input->keys_pressed[KEY_RIGHT] = false;
     }
-
-    // Store previous key states for edge detection
-    memcpy(prev_keys, input->keys_pressed, sizeof(prev_keys));
     
     // Clear one-shot keys at start of each frame
     memset(input->keys_just_pressed, false, sizeof(input->keys_just_pressed));
     
-    if (input->use_stdin_fallback) {
-        // Handle terminal input
-        char ch;
-        int bytes_read = read(input->stdin_fd, &ch, 1);
-        while (bytes_read == 1) {
-            // Convert ASCII characters to our internal key codes
-            switch (ch) {
-                case 'q':
-                case 'Q':
-                    input->should_quit = true;
-                    printf("Quit requested\n");
-                    break;
-                case 27: // ESC - check for arrow key sequences
-                    {
-                        char seq[3];
-                        // Try to read the escape sequence
-                        if (read(input->stdin_fd, &seq[0], 1) == 1 && seq[0] == '[') {
-                            if (read(input->stdin_fd, &seq[1], 1) == 1) {
-                                switch (seq[1]) {
-                                    case 'A': // Up arrow
-                                        input->keys_just_pressed[KEY_UP] = true;
-                                        input->keys_pressed[KEY_UP] = true;
-                                        // Hold functionality removed
-                                        break;
-                                    case 'B': // Down arrow
-                                        input->keys_just_pressed[KEY_DOWN] = true;
-                                        input->keys_pressed[KEY_DOWN] = true;
-                                        // Hold functionality removed
-                                        break;
-                                    case 'C': // Right arrow
-                                        input->keys_just_pressed[KEY_RIGHT] = true;
-                                        input->keys_pressed[KEY_RIGHT] = true;
-                                        // Hold functionality removed
-                                        break;
-                                    case 'D': // Left arrow
-                                        input->keys_just_pressed[KEY_LEFT] = true;
-                                        input->keys_pressed[KEY_LEFT] = true;
-                                        // Hold functionality removed
-                                        break;
-                                    default:
-                                        // Unknown escape sequence, treat as quit
-                                        input->should_quit = true;
-                                        printf("Quit requested (ESC)\n");
-                                        break;
-                                }
-                            } else {
-                                // Just ESC by itself
-                                input->should_quit = true;
-                                printf("Quit requested (ESC)\n");
-                            }
-                        } else {
-                            // Just ESC by itself
-                            input->should_quit = true;
-                            printf("Quit requested (ESC)\n");
-                        }
-                    }
-                    break;
-                case '1':
-                    input->keys_just_pressed[KEY_1] = true;
-                    // printf("Key 1 pressed (select corner 1)\n");
-                    break;
-                case '2':
-                    input->keys_just_pressed[KEY_2] = true;
-                    // printf("Key 2 pressed (select corner 2)\n");
-                    break;
-                case '3':
-                    input->keys_just_pressed[KEY_3] = true;
-                    // printf("Key 3 pressed (select corner 3)\n");
-                    break;
-                case '4':
-                    input->keys_just_pressed[KEY_4] = true;
-                    // printf("Key 4 pressed (select corner 4)\n");
-                    break;
-                case '5':
-                    input->keys_just_pressed[KEY_5] = true;
-                    // printf("Key 5 pressed (select corner 5)\n");
-                    break;
-                case '6':
-                    input->keys_just_pressed[KEY_6] = true;
-                    // printf("Key 6 pressed (select corner 6)\n");
-                    break;
-                case '7':
-                    input->keys_just_pressed[KEY_7] = true;
-                    // printf("Key 7 pressed (select corner 7)\n");
-                    break;
-                case '8':
-                    input->keys_just_pressed[KEY_8] = true;
-                    // printf("Key 8 pressed (select corner 8)\n");
-                    break;
-                case 's':
-                case 'S':
-                    input->save_keystone = true;
-                    // printf("S key pressed (save keystone)\n");
-                    break;
-                case 'c':
-                case 'C':
-                    input->toggle_corners = true;
-                    // printf("Toggle corner highlights\n");
-                    break;
-                case 'b':
-                case 'B':
-                    input->toggle_border = true;
-                    // printf("Toggle border highlights\n");
-                    break;
-                case 'h':
-                case 'H':
-                    input->toggle_help = true;
-                    // printf("Toggle help overlay\n");
-                    break;
-
-                case 'r':
-                case 'R':
-                    input->keys_just_pressed[KEY_R] = true;
-                    // printf("R key pressed (reset keystone)\n");
-                    break;
-                case 'p':
-                case 'P':
-                    input->save_keystone = true;
-                    // printf("P key pressed (save keystone)\n");
-                    break;
-            }
-            // Read next character
-            bytes_read = read(input->stdin_fd, &ch, 1);
-        }
-        
-    } else {
-        // Handle event device input (original method)
-        struct input_event ev;
-        while (read(input->keyboard_fd, &ev, sizeof(ev)) == sizeof(ev)) {
-            if (ev.type == EV_KEY) {
-                if (ev.code < 256) {
-                    // Update key state
-                    input->keys_pressed[ev.code] = (ev.value != 0);
-                    
-                    // Handle specific keys
-                    if (ev.value == 1) // Key press
-                        switch (ev.code) {
-                            case KEY_Q:
-                            case KEY_ESC:
-                                input->should_quit = true;
-                                printf("Quit requested\n");
-                                break;
-                            case KEY_1:
-                                // printf("Key 1 pressed (select corner 1)\n");
-                                break;
-                            case KEY_2:
-                                // printf("Key 2 pressed (select corner 2)\n");
-                                break;
-                            case KEY_3:
-                                // printf("Key 3 pressed (select corner 3)\n");
-                                break;
-                            case KEY_4:
-                                // printf("Key 4 pressed (select corner 4)\n");
-                                break;
-                            case KEY_C:
-                                input->toggle_corners = true;
-                                // printf("Toggle corner highlights\n");
-                                break;
-                            case KEY_UP:
-                                // printf("Up arrow pressed\n");
-                                break;
-                            case KEY_DOWN:
-                                // printf("Down arrow pressed\n");
-                                break;
-                            case KEY_LEFT:
-                                // printf("Left arrow pressed\n");
-                                break;
-                            case KEY_RIGHT:
-                                // printf("Right arrow pressed\n");
-                                break;
-                            case KEY_R:
-                                // printf("R pressed (reset keystone)\n");
-                                break;
-                        }
-                }
-            }
-        }
-    }
-    
-    // Process gamepad input (joystick API - can run alongside keyboard)
-    if (input->gamepad_enabled && input->gamepad_fd >= 0) {
-        struct js_event js;
-        
+    if (input->gamepad_enabled) {
         if (input->debug_gamepad) {
             static int debug_counter = 0;
             if ((debug_counter++ % 300) == 0) {  // Every ~10 seconds at 30fps
-                printf("[GAMEPAD] Gamepad processing active (fd=%d, enabled=%d)\n", 
-                       input->gamepad_fd, input->gamepad_enabled);
+                printf("[GAMEPAD] Gamepad processing active\n");
             }
         }
         
@@ -527,144 +790,63 @@ void input_update(input_context_t *input) {
         input->gamepad_increase_step = false;
         input->gamepad_reset_keystone = false;
         input->gamepad_toggle_mode = false;
-        
-        // Read all pending joystick events
-        int event_count = 0;
-        ssize_t read_result;
-        while ((read_result = read(input->gamepad_fd, &js, sizeof(js))) == sizeof(js)) {
-            event_count++;
-            if (input->debug_gamepad) {
-                printf("[GAMEPAD] Event %d: type=%d number=%d value=%d\n", 
-                       event_count, js.type, js.number, js.value);
-            }
-            
-            // Skip initial state events sent when joystick is first opened
-            if (js.type & JS_EVENT_INIT) {
-                if (input->debug_gamepad) {
-                    printf("[GAMEPAD] Skipping INIT event\n");
-                }
-                continue;
-            }
-            
-            if (js.type == JS_EVENT_BUTTON) {
-                // Button event
-                if (js.number < 32) {
-                    bool was_pressed = input->gamepad_buttons[js.number];
-                    input->gamepad_buttons[js.number] = (js.value != 0);
-                    
-                    // Detect button press (rising edge)
-                    if (!was_pressed && input->gamepad_buttons[js.number]) {
-                        input->gamepad_buttons_just_pressed[js.number] = true;
-                        
-                        // Debug logging with CORRECTED button names
-                        if (input->debug_gamepad) {
-                            const char *btn_names[] = {
-                                "A",       // 0
-                                "B",       // 1
-                                "?",       // 2
-                                "X",       // 3
-                                "Y",       // 4
-                                "?",       // 5
-                                "L1",      // 6
-                                "R1",      // 7
-                                "HOME",    // 8
-                                "?",       // 9
-                                "SELECT",  // 10
-                                "START"    // 11
-                            };
-                            const char *btn_name = (js.number < 12) ? btn_names[js.number] : "UNKNOWN";
-                            printf("[GAMEPAD] Button pressed: %s (button %d)\n", btn_name, js.number);
-                        }
-                        
-                        // Map specific buttons to actions
-                        // 8BitDo Zero 2 actual button layout: B=0, A=1, L1=2, X=3, Y=4, R1=5
-                        if (js.number == JS_BUTTON_X) {  // Button 3 = TOP button (X)
-                            input->gamepad_cycle_corner = true;
-                        } else if (js.number == JS_BUTTON_B) {  // Button 0 = BOTTOM button (B)
-                            input->gamepad_toggle_corner_border = true;
-                        } else if (js.number == JS_BUTTON_Y) {  // Button 4 = LEFT button (Y)
-                            input->toggle_help = true;
-                        } else if (js.number == JS_BUTTON_L1) {
-                            input->gamepad_increase_step = true;
-                            if (input->debug_gamepad) printf("[GAMEPAD] L1 pressed - increase step\n");
-                        } else if (js.number == JS_BUTTON_R1) {
-                            input->gamepad_decrease_step = true;
-                            if (input->debug_gamepad) printf("[GAMEPAD] R1 pressed - decrease step\n");
-                        } else if (js.number == JS_BUTTON_SELECT) {
-                            input->gamepad_reset_keystone = true;
-                        } else if (js.number == JS_BUTTON_START) {
-                            input->save_keystone = true;
-                        } else if (js.number == JS_BUTTON_HOME) {
-                            input->gamepad_toggle_mode = true;
-                        }
-                    }
-                }
-            } else if (js.type == JS_EVENT_AXIS) {
-                // Axis event
-                if (js.number == JS_AXIS_LEFT_X) {
-                    int16_t old_value = input->gamepad_axis_x;
-                    input->gamepad_axis_x = js.value;
-                    if (input->debug_gamepad && abs(old_value - js.value) > 1000) {
-                        printf("[GAMEPAD] Left stick X: %d\n", js.value);
-                    }
-                } else if (js.number == JS_AXIS_LEFT_Y) {
-                    int16_t old_value = input->gamepad_axis_y;
-                    input->gamepad_axis_y = js.value;
-                    if (input->debug_gamepad && abs(old_value - js.value) > 1000) {
-                        printf("[GAMEPAD] Left stick Y: %d\n", js.value);
-                    }
-                } else if (js.number == JS_AXIS_DPAD_X) {
-                    // D-pad X: convert from -32767/0/32767 to -1/0/1
-                    int8_t dpad_x = (js.value < -16000) ? -1 : (js.value > 16000) ? 1 : 0;
-                    if (input->debug_gamepad && dpad_x != input->gamepad_dpad_x) {
-                        printf("[GAMEPAD] D-pad X: %d\n", dpad_x);
-                    }
-                    input->gamepad_dpad_x = dpad_x;
-                } else if (js.number == JS_AXIS_DPAD_Y) {
-                    // D-pad Y: convert from -32767/0/32767 to -1/0/1
-                    int8_t dpad_y = (js.value < -16000) ? -1 : (js.value > 16000) ? 1 : 0;
-                    if (input->debug_gamepad && dpad_y != input->gamepad_dpad_y) {
-                        printf("[GAMEPAD] D-pad Y: %d\n", dpad_y);
-                    }
-                    input->gamepad_dpad_y = dpad_y;
-                }
-            }
+    }
+    
+    // Everything queued since the last frame, in order
+    unsigned int tail = __atomic_load_n(&input->queue_tail, __ATOMIC_ACQUIRE);
+    unsigned int head = input->queue_head;
+    while (head != tail) {
+        apply_cmd(input, &input->queue[head % INPUT_QUEUE_SIZE]);
+        head++;
+    }
+    __atomic_store_n(&input->queue_head, head, __ATOMIC_RELEASE);
+    
+    unsigned int dropped = __atomic_exchange_n(&input->queue_dropped, 0, __ATOMIC_RELAXED);
+    if (dropped > 0) {
+        fprintf(stderr, "[INPUT] Queue full, %u events dropped\n", dropped);
+    }
+    
+    if (!input->gamepad_enabled) {
+        return;
+    }
+    
+    // Analog state: one coalesced value per frame
+    int16_t axis_x = __atomic_load_n(&input->axis_latest[INPUT_AXIS_LEFT_X], __ATOMIC_RELAXED);
+    int16_t axis_y = __atomic_load_n(&input->axis_latest[INPUT_AXIS_LEFT_Y], __ATOMIC_RELAXED);
+    int16_t dpad_x = __atomic_load_n(&input->axis_latest[INPUT_AXIS_DPAD_X], __ATOMIC_RELAXED);
+    int16_t dpad_y = __atomic_load_n(&input->axis_latest[INPUT_AXIS_DPAD_Y], __ATOMIC_RELAXED);
+    if (input->debug_gamepad) {
+        if (abs(input->gamepad_axis_x - axis_x) > 1000) {
+            printf("[GAMEPAD] Left stick X: %d\n", axis_x);
         }
-        
-        // Check if gamepad disconnected (read returned error other than EAGAIN)
-        if (read_result < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
-            printf("Gamepad disconnected (error: %s), will retry connection...\n", strerror(errno));
-            close(input->gamepad_fd);
-            input->gamepad_fd = -1;
-            input->gamepad_enabled = false;
-            // Reset poll timer to try reconnecting soon
-            struct timeval tv;
-            gettimeofday(&tv, NULL);
-            input->last_gamepad_poll_time = (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+        if (abs(input->gamepad_axis_y - axis_y) > 1000) {
+            printf("[GAMEPAD] Left stick Y: %d\n", axis_y);
         }
-        
-        // Check for START+SELECT held for 2 seconds (quit combo)
-        if (input->gamepad_buttons[JS_BUTTON_START] && input->gamepad_buttons[JS_BUTTON_SELECT]) {
-            if (input->gamepad_start_select_time == 0) {
-                // Start timing
-                struct timeval tv;
-                gettimeofday(&tv, NULL);
-                input->gamepad_start_select_time = tv.tv_sec * 1000ULL + tv.tv_usec / 1000;
-            } else {
-                // Check if held for 2 seconds
-                struct timeval tv;
-                gettimeofday(&tv, NULL);
-                uint64_t now = tv.tv_sec * 1000ULL + tv.tv_usec / 1000;
-                if (now - input->gamepad_start_select_time >= 2000) {
-                    input->should_quit = true;
-                    printf("Quit requested (START+SELECT held)\n");
-                }
-            }
-        } else {
-            input->gamepad_start_select_time = 0;
+        if (dpad_x != input->gamepad_dpad_x) {
+            printf("[GAMEPAD] D-pad X: %d\n", dpad_x);
+        }
+        if (dpad_y != input->gamepad_dpad_y) {
+            printf("[GAMEPAD] D-pad Y: %d\n", dpad_y);
         }
     }
-
+    input->gamepad_axis_x = axis_x;
+    input->gamepad_axis_y = axis_y;
+    input->gamepad_dpad_x = dpad_x;
+    input->gamepad_dpad_y = dpad_y;
+    
+    // Check for START+SELECT held for 2 seconds (quit combo)
+    if (input->gamepad_buttons[JS_BUTTON_START] && input->gamepad_buttons[JS_BUTTON_SELECT]) {
+        uint64_t now = input_time_ms();
+        if (input->gamepad_start_select_time == 0) {
+            // Start timing
+            input->gamepad_start_select_time = now;
+        } else if (now - input->gamepad_start_select_time >= 2000) {
+            input->should_quit = true;
+            printf("Quit requested (START+SELECT held)\n");
+        }
+    } else {
+        input->gamepad_start_select_time = 0;
+    }
 }
 
 bool input_is_key_pressed(input_context_t *input, int key) {
@@ -6,8 +6,47 @@
 #include <linux/input.h>
 #include <linux/joystick.h>
 #include <termios.h>
+#include <pthread.h>
+
+// Devices are read on a dedicated thread blocking in epoll (plus an inotify
+// watch on /dev/input for hotplug). Discrete events reach the render thread
+// through a single-producer/single-consumer queue that input_update() drains
+// once per frame; analog axes only publish their latest value.
+#define INPUT_QUEUE_SIZE 256     // Power of two; events between two frames
+
+typedef enum {
+    INPUT_CMD_KEY = 0,           // evdev key: value 0 release, 1 press, 2 autorepeat
+    INPUT_CMD_TAP,               // Terminal key: one-shot press (no release events)
+    INPUT_CMD_ACTION,            // code is an input_action_t
+    INPUT_CMD_BUTTON,            // Joystick button: code = number, value = state
+    INPUT_CMD_GAMEPAD,           // value 1 connected, 0 disconnected
+    INPUT_CMD_RELEASE_ALL        // Keyboard lost: every held key is released
+} input_cmd_type_t;
+
+typedef enum {
+    INPUT_ACTION_QUIT = 0,
+    INPUT_ACTION_SAVE,
+    INPUT_ACTION_TOGGLE_CORNERS,
+    INPUT_ACTION_TOGGLE_BORDER,
+    INPUT_ACTION_TOGGLE_HELP
+} input_action_t;
+
+typedef struct {
+    uint8_t type;                // input_cmd_type_t
+    uint16_t code;
+    int32_t value;
+} input_cmd_t;
+
+typedef enum {
+    INPUT_AXIS_LEFT_X = 0,
+    INPUT_AXIS_LEFT_Y,
+    INPUT_AXIS_DPAD_X,           // Already reduced to -1/0/1
+    INPUT_AXIS_DPAD_Y,
+    INPUT_AXIS_COUNT
+} input_axis_t;
 
 typedef struct {
+    bool initialized;
     int keyboard_fd;
     bool keys_pressed[256];
     bool keys_just_pressed[256];  // One-shot keys for terminal mode
@@ -42,6 +81,21 @@ typedef struct {
     bool gamepad_toggle_corner_border;  // B button: toggle both borders and corners
     uint64_t gamepad_start_select_time; // For START+SELECT hold detection
     bool debug_gamepad;                 // Debug flag for logging button presses
+    
+    // Input thread (owns every device fd above once it runs)
+    pthread_t thread;
+    bool thread_running;                // false: input_update() polls the devices itself
+    bool thread_stop;
+    int epoll_fd;
+    int inotify_fd;                     // -1: gamepad reconnection falls back to polling
+    int wake_fd;                        // eventfd that interrupts epoll_wait on shutdown
+    
+    // Thread -> render thread
+    input_cmd_t queue[INPUT_QUEUE_SIZE];
+    unsigned int queue_head;            // Written by the render thread only
+    unsigned int queue_tail;            // Written by the input thread only
+    unsigned int queue_dropped;
+    int16_t axis_latest[INPUT_AXIS_COUNT];
 } input_context_t;
 
 // Input handling functions
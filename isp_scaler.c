@@ -0,0 +1,580 @@
+#define _GNU_SOURCE
+#include "isp_scaler.h"
+#include "frame_memory.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <math.h>
+#include <sys/ioctl.h>
+#include <linux/videodev2.h>
+#include <drm_fourcc.h>
+
+// Raspberry Pi downstream format: NV12 in 128-byte columns (DRM SAND128),
+// bytesperline carries the column height
+#ifndef V4L2_PIX_FMT_NV12_COL128
+#define V4L2_PIX_FMT_NV12_COL128 v4l2_fourcc('N', 'C', '1', '2')
+#endif
+
+#define ISP_DRIVER_NAME "bcm2835-isp"
+#define ISP_MAX_VIDEO_NODES 64
+#define ISP_INPUT_BUFFERS 2
+#define ISP_MIN_OUTPUT 64            // Smallest capture size the ISP accepts
+
+struct isp_scaler {
+    int output_fd;               // Node fed with decoder frames (V4L2 OUTPUT queue)
+    int capture_fd;              // Main scaled output (V4L2 CAPTURE queue)
+    bool col128_supported;
+    bool failed;
+
+    // Current configuration
+    bool configured;
+    int in_w, in_h;
+    uint32_t in_format;
+    uint64_t in_modifier;
+    int in_pitch, in_chroma_offset;
+    uint32_t in_sizeimage;
+    int req_w, req_h;            // Requested output size (hysteresis compares against this)
+    int out_w, out_h, out_pitch;
+    size_t reserved;
+
+    // Last layout the ISP could not take, so it is not retried every frame
+    uint32_t rejected_format;
+    uint64_t rejected_modifier;
+    int rejected_w, rejected_h;
+
+    int capture_count;
+    int capture_dma[ISP_CAPTURE_BUFFERS];
+    int held[ISP_HOLD_BUFFERS + 1];  // Completed capture indices, oldest first
+    int held_count;
+    bool have_output;
+
+    video_dma_frame_t inputs[ISP_INPUT_BUFFERS];  // Kept alive until the ISP returns them
+    int next_input;
+    bool output_pending;         // Input queued, not yet dequeued
+    bool capture_pending;        // Conversion queued, result not yet dequeued
+
+    unsigned int generation;
+};
+
+static int xioctl(int fd, unsigned long request, void *arg) {
+    int ret;
+    do {
+        ret = ioctl(fd, request, arg);
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+}
+
+static unsigned int node_caps(const struct v4l2_capability *cap) {
+    return (cap->capabilities & V4L2_CAP_DEVICE_CAPS) ? cap->device_caps : cap->capabilities;
+}
+
+// One ISP instance is an output node followed by capture0/capture1/stats nodes
+// with the same bus_info
+static int find_isp_nodes(isp_scaler_t *isp) {
+    char bus_info[32] = {0};
+    for (int i = 0; i < ISP_MAX_VIDEO_NODES && isp->capture_fd < 0; i++) {
+        char path[32];
+        snprintf(path, sizeof(path), "/dev/video%d", i);
+        int fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+
+        struct v4l2_capability cap;
+        memset(&cap, 0, sizeof(cap));
+        if (xioctl(fd, VIDIOC_QUERYCAP, &cap) != 0 || strcmp((const char *)cap.driver, ISP_DRIVER_NAME) != 0) {
+            close(fd);
+            continue;
+        }
+
+        unsigned int caps = node_caps(&cap);
+        if (isp->output_fd < 0 && (caps & V4L2_CAP_VIDEO_OUTPUT) && (caps & V4L2_CAP_STREAMING)) {
+            isp->output_fd = fd;
+            memcpy(bus_info, cap.bus_info, sizeof(bus_info) - 1);
+            LOG_INFO("[ISP] Input node %s (%s)\n", path, bus_info);
+        } else if (isp->output_fd >= 0 && (caps & V4L2_CAP_VIDEO_CAPTURE) &&
+                   strncmp((const char *)cap.bus_info, bus_info, sizeof(bus_info)) == 0) {
+            isp->capture_fd = fd;
+            LOG_INFO("[ISP] Output node %s\n", path);
+        } else {
+            close(fd);
+        }
+    }
+    return (isp->output_fd >= 0 && isp->capture_fd >= 0) ? 0 : -1;
+}
+
+static bool output_supports(int fd, uint32_t pixelformat) {
+    struct v4l2_fmtdesc desc;
+    for (unsigned int i = 0; ; i++) {
+        memset(&desc, 0, sizeof(desc));
+        desc.index = i;
+        desc.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        if (xioctl(fd, VIDIOC_ENUM_FMT, &desc) != 0) {
+            return false;
+        }
+        if (desc.pixelformat == pixelformat) {
+            return true;
+        }
+    }
+}
+
+isp_scaler_t *isp_scaler_open(void) {
+    const char *env = getenv("PICKLE_ISP_SCALE");
+    if (!env || env[0] != '1') {
+        return NULL;
+    }
+
+    isp_scaler_t *isp = calloc(1, sizeof(*isp));
+    if (!isp) {
+        return NULL;
+    }
+    isp->output_fd = -1;
+    isp->capture_fd = -1;
+    for (int i = 0; i < ISP_CAPTURE_BUFFERS; i++) {
+        isp->capture_dma[i] = -1;
+    }
+    for (int i = 0; i < ISP_INPUT_BUFFERS; i++) {
+        isp->inputs[i].dma_fd = -1;
+    }
+
+    if (find_isp_nodes(isp) != 0) {
+        LOG_WARN("[ISP] No %s memory-to-memory device found, downscaling stays on the GPU\n", ISP_DRIVER_NAME);
+        isp_scaler_close(isp);
+        return NULL;
+    }
+    isp->col128_supported = output_supports(isp->output_fd, V4L2_PIX_FMT_NV12_COL128);
+    LOG_INFO("[ISP] Hardware downscale enabled%s\n",
+             isp->col128_supported ? " (SAND128 input supported)" : "");
+    return isp;
+}
+
+static void release_inputs(isp_scaler_t *isp) {
+    for (int i = 0; i < ISP_INPUT_BUFFERS; i++) {
+        video_dma_frame_release(&isp->inputs[i]);
+    }
+}
+
+static void teardown(isp_scaler_t *isp) {
+    int type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    xioctl(isp->output_fd, VIDIOC_STREAMOFF, &type);
+    type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    xioctl(isp->capture_fd, VIDIOC_STREAMOFF, &type);
+
+    // STREAMOFF returned every queued buffer, so the input frames are no longer read
+    release_inputs(isp);
+    for (int i = 0; i < ISP_CAPTURE_BUFFERS; i++) {
+        if (isp->capture_dma[i] >= 0) {
+            close(isp->capture_dma[i]);
+            isp->capture_dma[i] = -1;
+        }
+    }
+
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    req.memory = V4L2_MEMORY_DMABUF;
+    xioctl(isp->output_fd, VIDIOC_REQBUFS, &req);
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    xioctl(isp->capture_fd, VIDIOC_REQBUFS, &req);
+
+    if (isp->reserved) {
+        frame_memory_unreserve(isp->reserved);
+        isp->reserved = 0;
+    }
+    isp->configured = false;
+    isp->have_output = false;
+    isp->held_count = 0;
+    isp->output_pending = false;
+    isp->capture_pending = false;
+}
+
+void isp_scaler_close(isp_scaler_t *isp) {
+    if (!isp) {
+        return;
+    }
+    if (isp->output_fd >= 0 && isp->capture_fd >= 0) {
+        teardown(isp);
+    }
+    if (isp->output_fd >= 0) {
+        close(isp->output_fd);
+    }
+    if (isp->capture_fd >= 0) {
+        close(isp->capture_fd);
+    }
+    free(isp);
+}
+
+bool isp_scaler_target(int src_w, int src_h, int target_w, int target_h, int *out_w, int *out_h) {
+    if (src_w <= 0 || src_h <= 0 || target_w <= 0 || target_h <= 0) {
+        return false;
+    }
+
+    // Aspect is preserved: the GL path letterboxes inside the quad anyway
+    float scale = fminf((float)target_w / (float)src_w, (float)target_h / (float)src_h);
+    if (scale > ISP_MIN_DOWNSCALE) {
+        return false;
+    }
+
+    int w = ((int)((float)src_w * scale + 0.5f)) & ~1;
+    int h = ((int)((float)src_h * scale + 0.5f)) & ~1;
+    if (w < ISP_MIN_OUTPUT || h < ISP_MIN_OUTPUT) {
+        return false;
+    }
+    *out_w = w;
+    *out_h = h;
+    return true;
+}
+
+static bool near_size(int a, int b) {
+    return fabsf((float)(a - b)) <= (float)b * ISP_RESIZE_HYSTERESIS;
+}
+
+// Describe the decoder layout to the input node; -1 if the ISP cannot read it
+static int set_input_format(isp_scaler_t *isp, const video_dma_frame_t *frame, int src_w, int src_h) {
+    struct v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    fmt.fmt.pix.width = (uint32_t)src_w;
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+
+    int pitch = frame->plane_pitch[0];
+    int chroma = frame->plane_offset[1];
+    uint32_t requested_bpl;
+
+    if (frame->modifier == DRM_FORMAT_MOD_LINEAR && frame->drm_format == DRM_FORMAT_YUV420) {
+        // Single buffer, contiguous planes: the padded height is implied by the U offset
+        int rows = pitch > 0 ? chroma / pitch : 0;
+        if (rows < src_h || chroma != rows * pitch || frame->plane_pitch[1] != pitch / 2 ||
+            frame->plane_offset[2] != chroma + frame->plane_pitch[1] * (rows / 2)) {
+            return -1;
+        }
+        fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUV420;
+        fmt.fmt.pix.height = (uint32_t)rows;
+        requested_bpl = (uint32_t)pitch;
+    } else if (frame->modifier == DRM_FORMAT_MOD_LINEAR && frame->drm_format == DRM_FORMAT_NV12) {
+        int rows = pitch > 0 ? chroma / pitch : 0;
+        if (rows < src_h || chroma != rows * pitch || frame->plane_pitch[1] != pitch) {
+            return -1;
+        }
+        fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_NV12;
+        fmt.fmt.pix.height = (uint32_t)rows;
+        requested_bpl = (uint32_t)pitch;
+    } else if (fourcc_mod_broadcom_mod(frame->modifier) == DRM_FORMAT_MOD_BROADCOM_SAND128 &&
+               frame->drm_format == DRM_FORMAT_NV12 && isp->col128_supported) {
+        int col_height = fourcc_mod_broadcom_param(frame->modifier);
+        if (col_height < src_h) {
+            return -1;
+        }
+        fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_NV12_COL128;
+        fmt.fmt.pix.height = (uint32_t)src_h;
+        requested_bpl = (uint32_t)col_height;
+    } else {
+        return -1;
+    }
+
+    fmt.fmt.pix.bytesperline = requested_bpl;
+    if (xioctl(isp->output_fd, VIDIOC_S_FMT, &fmt) != 0 || fmt.fmt.pix.bytesperline != requested_bpl) {
+        return -1;
+    }
+    // The DMA-BUF must cover what the ISP will read
+    if (frame->size > 0 && fmt.fmt.pix.sizeimage > frame->size) {
+        return -1;
+    }
+    isp->in_sizeimage = fmt.fmt.pix.sizeimage;
+
+    // Padding rows below the picture must not be scaled into it
+    if ((int)fmt.fmt.pix.height != src_h) {
+        struct v4l2_selection sel;
+        memset(&sel, 0, sizeof(sel));
+        sel.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        sel.target = V4L2_SEL_TGT_CROP;
+        sel.r.width = (uint32_t)src_w;
+        sel.r.height = (uint32_t)src_h;
+        if (xioctl(isp->output_fd, VIDIOC_S_SELECTION, &sel) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int queue_capture(isp_scaler_t *isp, int index) {
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = (uint32_t)index;
+    return xioctl(isp->capture_fd, VIDIOC_QBUF, &buf);
+}
+
+static int configure(isp_scaler_t *isp, const video_dma_frame_t *frame, int src_w, int src_h,
+                     int out_w, int out_h) {
+    if (isp->configured) {
+        teardown(isp);
+    }
+
+    if (set_input_format(isp, frame, src_w, src_h) != 0) {
+        return -1;
+    }
+
+    struct v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = (uint32_t)out_w;
+    fmt.fmt.pix.height = (uint32_t)out_h;
+    fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_NV12;
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if (xioctl(isp->capture_fd, VIDIOC_S_FMT, &fmt) != 0 || fmt.fmt.pix.pixelformat != V4L2_PIX_FMT_NV12) {
+        LOG_WARN("[ISP] NV12 output at %dx%d rejected: %s\n", out_w, out_h, strerror(errno));
+        return -1;
+    }
+    isp->out_w = (int)fmt.fmt.pix.width;
+    isp->out_h = (int)fmt.fmt.pix.height;
+    isp->out_pitch = (int)fmt.fmt.pix.bytesperline;
+    size_t out_size = fmt.fmt.pix.sizeimage;
+
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    req.memory = V4L2_MEMORY_DMABUF;
+    req.count = ISP_INPUT_BUFFERS;
+    if (xioctl(isp->output_fd, VIDIOC_REQBUFS, &req) != 0 || req.count < ISP_INPUT_BUFFERS) {
+        LOG_WARN("[ISP] Input node cannot import DMA-BUFs: %s\n", strerror(errno));
+        return -1;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count = ISP_CAPTURE_BUFFERS;
+    if (xioctl(isp->capture_fd, VIDIOC_REQBUFS, &req) != 0 || req.count <= ISP_HOLD_BUFFERS) {
+        LOG_WARN("[ISP] Output buffer allocation failed: %s\n", strerror(errno));
+        return -1;
+    }
+    isp->capture_count = req.count < ISP_CAPTURE_BUFFERS ? (int)req.count : ISP_CAPTURE_BUFFERS;
+
+    // The output ring is frame memory like any other: charge it to the budget
+    if (frame_memory_reserve(out_size * (size_t)isp->capture_count, "ISP output") != 0) {
+        return -1;
+    }
+    isp->reserved = out_size * (size_t)isp->capture_count;
+    isp->configured = true;
+
+    for (int i = 0; i < isp->capture_count; i++) {
+        struct v4l2_exportbuffer exp;
+        memset(&exp, 0, sizeof(exp));
+        exp.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        exp.index = (uint32_t)i;
+        exp.flags = O_RDONLY | O_CLOEXEC;
+        if (xioctl(isp->capture_fd, VIDIOC_EXPBUF, &exp) != 0) {
+            LOG_WARN("[ISP] Output buffer export failed: %s\n", strerror(errno));
+            return -1;
+        }
+        isp->capture_dma[i] = exp.fd;
+        if (queue_capture(isp, i) != 0) {
+            return -1;
+        }
+    }
+
+    int type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    if (xioctl(isp->output_fd, VIDIOC_STREAMON, &type) != 0) {
+        return -1;
+    }
+    type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(isp->capture_fd, VIDIOC_STREAMON, &type) != 0) {
+        return -1;
+    }
+
+    isp->in_w = src_w;
+    isp->in_h = src_h;
+    isp->in_format = frame->drm_format;
+    isp->in_modifier = frame->modifier;
+    isp->in_pitch = frame->plane_pitch[0];
+    isp->in_chroma_offset = frame->plane_offset[1];
+    isp->req_w = out_w;
+    isp->req_h = out_h;
+    isp->generation++;
+    LOG_INFO("[ISP] Scaling %dx%d -> %dx%d NV12 (%d output buffers)\n",
+             src_w, src_h, isp->out_w, isp->out_h, isp->capture_count);
+    return 0;
+}
+
+static void fail(isp_scaler_t *isp, const char *what) {
+    LOG_ERROR("[ISP] %s failed (%s), downscaling back on the GPU\n", what, strerror(errno));
+    teardown(isp);
+    isp->failed = true;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+// Dequeue whatever the ISP finished, waiting up to wait_ms for the pending conversion
+static void collect(isp_scaler_t *isp, int wait_ms) {
+    double deadline = now_ms() + wait_ms;
+    while (!isp->failed && (isp->output_pending || isp->capture_pending)) {
+        struct v4l2_buffer buf;
+        if (isp->output_pending) {
+            memset(&buf, 0, sizeof(buf));
+            buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+            buf.memory = V4L2_MEMORY_DMABUF;
+            if (xioctl(isp->output_fd, VIDIOC_DQBUF, &buf) == 0) {
+                if (buf.index < ISP_INPUT_BUFFERS) {
+                    video_dma_frame_release(&isp->inputs[buf.index]);
+                }
+                isp->output_pending = false;
+            } else if (errno != EAGAIN) {
+                fail(isp, "Input dequeue");
+                return;
+            }
+        }
+
+        if (isp->capture_pending) {
+            memset(&buf, 0, sizeof(buf));
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            if (xioctl(isp->capture_fd, VIDIOC_DQBUF, &buf) == 0) {
+                isp->held[isp->held_count++] = (int)buf.index;
+                isp->have_output = true;
+                isp->capture_pending = false;
+                // Oldest held output has left the screen and the GPU: back to the ISP
+                if (isp->held_count > ISP_HOLD_BUFFERS) {
+                    if (queue_capture(isp, isp->held[0]) != 0) {
+                        fail(isp, "Output requeue");
+                        return;
+                    }
+                    memmove(&isp->held[0], &isp->held[1], sizeof(isp->held[0]) * ISP_HOLD_BUFFERS);
+                    isp->held_count--;
+                }
+            } else if (errno != EAGAIN) {
+                fail(isp, "Output dequeue");
+                return;
+            }
+        }
+
+        if (!isp->output_pending && !isp->capture_pending) {
+            break;
+        }
+        int remaining = (int)(deadline - now_ms());
+        if (remaining <= 0) {
+            break;
+        }
+        struct pollfd fds[2] = {
+            { .fd = isp->output_fd, .events = POLLOUT },
+            { .fd = isp->capture_fd, .events = POLLIN },
+        };
+        if (poll(fds, 2, remaining) <= 0) {
+            break;
+        }
+    }
+}
+
+int isp_scaler_process(isp_scaler_t *isp, video_dma_frame_t *frame, int src_w, int src_h,
+                       int out_w, int out_h) {
+    if (!isp || isp->failed || !frame || frame->dma_fd < 0) {
+        video_dma_frame_release(frame);
+        return -1;
+    }
+
+    if (frame->drm_format == isp->rejected_format && frame->modifier == isp->rejected_modifier &&
+        src_w == isp->rejected_w && src_h == isp->rejected_h) {
+        video_dma_frame_release(frame);
+        return -1;
+    }
+
+    // The last conversion has to finish before its buffers can be reused or reconfigured
+    collect(isp, ISP_WAIT_MS);
+    if (isp->failed) {
+        video_dma_frame_release(frame);
+        return -1;
+    }
+    if (isp->output_pending || isp->capture_pending) {
+        // ISP behind: skip this frame, the previous output stays on screen
+        video_dma_frame_release(frame);
+        return 0;
+    }
+
+    bool same_input = isp->configured && isp->in_w == src_w && isp->in_h == src_h &&
+                      isp->in_format == frame->drm_format && isp->in_modifier == frame->modifier &&
+                      isp->in_pitch == frame->plane_pitch[0] && isp->in_chroma_offset == frame->plane_offset[1];
+    bool same_output = isp->configured && near_size(out_w, isp->req_w) && near_size(out_h, isp->req_h);
+    if (!same_input || !same_output) {
+        if (configure(isp, frame, src_w, src_h, out_w, out_h) != 0) {
+            LOG_WARN("[ISP] Cannot scale %dx%d frames (fourcc 0x%08x, modifier 0x%016llx), left to the GPU\n",
+                     src_w, src_h, frame->drm_format, (unsigned long long)frame->modifier);
+            teardown(isp);
+            isp->rejected_format = frame->drm_format;
+            isp->rejected_modifier = frame->modifier;
+            isp->rejected_w = src_w;
+            isp->rejected_h = src_h;
+            video_dma_frame_release(frame);
+            return -1;
+        }
+    }
+
+    int index = isp->next_input;
+    isp->next_input = (isp->next_input + 1) % ISP_INPUT_BUFFERS;
+    video_dma_frame_release(&isp->inputs[index]);
+
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    buf.memory = V4L2_MEMORY_DMABUF;
+    buf.index = (uint32_t)index;
+    buf.m.fd = frame->dma_fd;
+    buf.length = frame->size > 0 ? (uint32_t)frame->size : isp->in_sizeimage;
+    buf.bytesused = isp->in_sizeimage;
+    buf.field = V4L2_FIELD_NONE;
+    if (xioctl(isp->output_fd, VIDIOC_QBUF, &buf) != 0) {
+        video_dma_frame_release(frame);
+        fail(isp, "Input queue");
+        return -1;
+    }
+    isp->inputs[index] = *frame;
+    frame->frame = NULL;
+    frame->dma_fd = -1;
+    isp->output_pending = true;
+    isp->capture_pending = true;
+
+    collect(isp, ISP_WAIT_MS);
+    return isp->failed ? -1 : 0;
+}
+
+bool isp_scaler_output(isp_scaler_t *isp, isp_scaler_frame_t *out) {
+    if (!isp || isp->failed) {
+        return false;
+    }
+    // Pick up a conversion that outlasted ISP_WAIT_MS on an earlier frame
+    collect(isp, 0);
+    if (isp->failed || !isp->have_output || isp->held_count == 0) {
+        return false;
+    }
+
+    int index = isp->held[isp->held_count - 1];
+    memset(out, 0, sizeof(*out));
+    out->dma_fd = isp->capture_dma[index];
+    out->width = isp->out_w;
+    out->height = isp->out_h;
+    out->plane_offset[1] = isp->out_pitch * isp->out_h;
+    out->plane_pitch[0] = isp->out_pitch;
+    out->plane_pitch[1] = isp->out_pitch;
+    out->drm_format = DRM_FORMAT_NV12;
+    out->modifier = DRM_FORMAT_MOD_LINEAR;
+    out->generation = isp->generation;
+    return out->dma_fd >= 0;
+}
+
+void isp_scaler_reset(isp_scaler_t *isp) {
+    if (isp) {
+        isp->have_output = false;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef ISP_SCALER_H
+#define ISP_SCALER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "video_decoder.h"
+
+// Optional bcm2835-isp stage for sources much larger than they appear on screen
+// (4K masters on a 1080p projector, or a small keystone quad). The ISP's
+// memory-to-memory nodes import the decoder's DMA-BUF, scale it to the quad's
+// on-screen size and convert to NV12 into exported capture buffers, so the GPU
+// samples a quarter of the texels per frame. Frames never touch the CPU.
+//
+// Enabled with PICKLE_ISP_SCALE=1. Scaling is skipped (the caller renders the
+// decoder frame itself) when the quad is close to source size, for input
+// layouts the ISP cannot read, and permanently after any ISP error.
+#define ISP_CAPTURE_BUFFERS 4        // Output ring: one on screen, one being sampled, two for the ISP
+#define ISP_HOLD_BUFFERS 2           // Completed outputs kept away from the ISP (GPU may still read them)
+#define ISP_MIN_DOWNSCALE 0.75f      // Below this source-to-screen ratio the GPU samples cheaply enough
+#define ISP_RESIZE_HYSTERESIS 0.125f // Target must change by this much before the ISP is reconfigured
+#define ISP_WAIT_MS 5                // Longest the render thread waits for a conversion
+
+typedef struct isp_scaler isp_scaler_t;
+
+typedef struct {
+    int dma_fd;
+    int width;
+    int height;
+    int plane_offset[3];
+    int plane_pitch[3];
+    uint32_t drm_format;         // Always DRM_FORMAT_NV12, linear
+    uint64_t modifier;
+    unsigned int generation;     // Changes whenever the output buffers are reallocated
+} isp_scaler_frame_t;
+
+// NULL when the ISP is absent or disabled
+isp_scaler_t *isp_scaler_open(void);
+void isp_scaler_close(isp_scaler_t *isp);
+
+// Size the decoder frame should be scaled to for a quad covering target_w x
+// target_h pixels: false when scaling is not worth it
+bool isp_scaler_target(int src_w, int src_h, int target_w, int target_h, int *out_w, int *out_h);
+
+// Queue a decoder frame for scaling. Takes ownership of the handle (released
+// once the ISP has read it, or on failure). Waits up to ISP_WAIT_MS.
+int isp_scaler_process(isp_scaler_t *isp, video_dma_frame_t *frame, int src_w, int src_h,
+                       int out_w, int out_h);
+// Newest converted frame; false before the first one, or once the ISP failed
+bool isp_scaler_output(isp_scaler_t *isp, isp_scaler_frame_t *out);
+// Drop the current output so the caller falls back to the decoder frame
+void isp_scaler_reset(isp_scaler_t *isp);
+
+#endif // ISP_SCALER_H
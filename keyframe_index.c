@@ -0,0 +1,289 @@
+#define _GNU_SOURCE
+#include "keyframe_index.h"
+#include "startup_cache.h"
+#include "thread_topology.h"
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <libavformat/avformat.h>
+
+// ioprio_set(2) has no glibc wrapper
+#define INDEX_IOPRIO_WHO_PROCESS 1
+#define INDEX_IOPRIO_CLASS_IDLE 3
+#define INDEX_IOPRIO_CLASS_SHIFT 13
+
+typedef struct {
+    uint32_t version;
+    int32_t stream_index;
+    int32_t time_base_num;
+    int32_t time_base_den;
+    uint32_t count;
+} index_payload_t;
+
+struct keyframe_index {
+    char *path;
+    int stream_index;
+    int time_base_num;
+    int time_base_den;
+    int refs;                    // Under registry_lock
+    keyframe_index_t *next;
+
+    pthread_t thread;
+    bool thread_started;
+    bool cancel;                 // Last reference gone: stop scanning (atomic)
+
+    // Written once before ready is set, read-only afterwards
+    bool ready;                  // Atomic
+    keyframe_entry_t *entries;   // Sorted by pts
+    int count;
+};
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static keyframe_index_t *registry = NULL;
+
+static double index_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int compare_entries(const void *a, const void *b) {
+    int64_t pa = ((const keyframe_entry_t *)a)->pts;
+    int64_t pb = ((const keyframe_entry_t *)b)->pts;
+    return (pa > pb) - (pa < pb);
+}
+
+static void publish(keyframe_index_t *index, keyframe_entry_t *entries, int count) {
+    index->entries = entries;
+    index->count = count;
+    __atomic_store_n(&index->ready, true, __ATOMIC_RELEASE);
+}
+
+static bool load_sidecar(keyframe_index_t *index) {
+    size_t size = 0;
+    uint8_t *data = startup_cache_get_index(index->path, &size);
+    if (!data) {
+        return false;
+    }
+    index_payload_t header;
+    bool ok = size >= sizeof(header);
+    if (ok) {
+        memcpy(&header, data, sizeof(header));
+        ok = header.version == KEYFRAME_INDEX_VERSION && header.stream_index == index->stream_index &&
+             header.time_base_num == index->time_base_num && header.time_base_den == index->time_base_den &&
+             header.count > 0 && size == sizeof(header) + (size_t)header.count * sizeof(keyframe_entry_t);
+    }
+    keyframe_entry_t *entries = ok ? malloc((size_t)header.count * sizeof(keyframe_entry_t)) : NULL;
+    if (entries) {
+        memcpy(entries, data + sizeof(header), (size_t)header.count * sizeof(keyframe_entry_t));
+        publish(index, entries, (int)header.count);
+        LOG_INFO("[INDEX] %s: %u keyframes from cache\n", index->path, header.count);
+    }
+    free(data);
+    return entries != NULL;
+}
+
+static void store_sidecar(keyframe_index_t *index) {
+    size_t size = sizeof(index_payload_t) + (size_t)index->count * sizeof(keyframe_entry_t);
+    uint8_t *data = malloc(size);
+    if (!data) {
+        return;
+    }
+    index_payload_t header = {
+        .version = KEYFRAME_INDEX_VERSION,
+        .stream_index = index->stream_index,
+        .time_base_num = index->time_base_num,
+        .time_base_den = index->time_base_den,
+        .count = (uint32_t)index->count,
+    };
+    memcpy(data, &header, sizeof(header));
+    memcpy(data + sizeof(header), index->entries, (size_t)index->count * sizeof(keyframe_entry_t));
+    if (startup_cache_put_index(index->path, data, size) != 0) {
+        LOG_WARN("[INDEX] Could not write the index sidecar for %s\n", index->path);
+    }
+    free(data);
+}
+
+static int index_interrupt(void *opaque) {
+    return __atomic_load_n(&((keyframe_index_t *)opaque)->cancel, __ATOMIC_RELAXED);
+}
+
+static bool append_entry(keyframe_entry_t **entries, int *count, int *capacity, int64_t pts, int64_t pos) {
+    if (*count == *capacity) {
+        int grown = *capacity ? *capacity * 2 : 1024;
+        keyframe_entry_t *bigger = realloc(*entries, (size_t)grown * sizeof(keyframe_entry_t));
+        if (!bigger) {
+            return false;
+        }
+        *entries = bigger;
+        *capacity = grown;
+    }
+    (*entries)[*count].pts = pts;
+    (*entries)[*count].pos = pos;
+    (*count)++;
+    return true;
+}
+
+static void *index_thread_main(void *arg) {
+    keyframe_index_t *index = (keyframe_index_t *)arg;
+    thread_topology_set_name("pickle-index");
+    // The scan reads the whole file once: playback's own reads go first
+    syscall(SYS_ioprio_set, INDEX_IOPRIO_WHO_PROCESS, 0, INDEX_IOPRIO_CLASS_IDLE << INDEX_IOPRIO_CLASS_SHIFT);
+
+    double start = index_now();
+    AVFormatContext *fmt = avformat_alloc_context();
+    if (!fmt) {
+        return NULL;
+    }
+    fmt->interrupt_callback.callback = index_interrupt;
+    fmt->interrupt_callback.opaque = index;
+    if (avformat_open_input(&fmt, index->path, NULL, NULL) < 0) {
+        LOG_WARN("[INDEX] Cannot open %s for indexing\n", index->path);
+        return NULL;
+    }
+
+    keyframe_entry_t *entries = NULL;
+    int count = 0, capacity = 0;
+    bool ok = true;
+    bool scanned = false;
+
+    // Containers with a complete sample table (MP4, MKV cues) already know every keyframe
+    if (index->stream_index < (int)fmt->nb_streams) {
+        AVStream *st = fmt->streams[index->stream_index];
+        int native = avformat_index_get_entries_count(st);
+        for (int i = 0; i < native && ok; i++) {
+            const AVIndexEntry *e = avformat_index_get_entry(st, i);
+            if (e && (e->flags & AVINDEX_KEYFRAME)) {
+                // A timestamp seek hits these exactly: no byte offset needed
+                ok = append_entry(&entries, &count, &capacity, e->timestamp, -1);
+            }
+        }
+    }
+
+    if (ok && count == 0) {
+        // No header index: demux every packet (no decoding) and keep the key ones
+        scanned = true;
+        for (unsigned int i = 0; i < fmt->nb_streams; i++) {
+            if ((int)i != index->stream_index) {
+                fmt->streams[i]->discard = AVDISCARD_ALL;
+            }
+        }
+        AVPacket *pkt = av_packet_alloc();
+        ok = pkt != NULL;
+        while (ok && av_read_frame(fmt, pkt) >= 0) {
+            if (pkt->stream_index == index->stream_index && (pkt->flags & AV_PKT_FLAG_KEY)) {
+                int64_t ts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+                if (ts != AV_NOPTS_VALUE) {
+                    ok = append_entry(&entries, &count, &capacity, ts, pkt->pos);
+                }
+            }
+            av_packet_unref(pkt);
+        }
+        av_packet_free(&pkt);
+    }
+    avformat_close_input(&fmt);
+
+    if (!ok || count == 0 || __atomic_load_n(&index->cancel, __ATOMIC_RELAXED)) {
+        free(entries);
+        return NULL;
+    }
+
+    qsort(entries, (size_t)count, sizeof(keyframe_entry_t), compare_entries);
+    publish(index, entries, count);
+    LOG_INFO("[INDEX] %s: %d keyframes %s in %.1fs\n", index->path, count,
+             scanned ? "indexed" : "from the container index", index_now() - start);
+    store_sidecar(index);
+    return NULL;
+}
+
+keyframe_index_t *keyframe_index_open(const char *path, int stream_index, int time_base_num, int time_base_den) {
+    const char *env = getenv("PICKLE_KEYFRAME_INDEX");
+    struct stat st;
+    if ((env && strcmp(env, "0") == 0) || !path || strstr(path, "://") ||
+        stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&registry_lock);
+    for (keyframe_index_t *it = registry; it; it = it->next) {
+        if (it->stream_index == stream_index && strcmp(it->path, path) == 0) {
+            it->refs++;
+            pthread_mutex_unlock(&registry_lock);
+            return it;
+        }
+    }
+
+    keyframe_index_t *index = calloc(1, sizeof(*index));
+    if (!index || !(index->path = strdup(path))) {
+        free(index);
+        pthread_mutex_unlock(&registry_lock);
+        return NULL;
+    }
+    index->stream_index = stream_index;
+    index->time_base_num = time_base_num;
+    index->time_base_den = time_base_den;
+    index->refs = 1;
+    index->next = registry;
+    registry = index;
+    pthread_mutex_unlock(&registry_lock);
+
+    if (!load_sidecar(index)) {
+        index->thread_started = pthread_create(&index->thread, NULL, index_thread_main, index) == 0;
+    }
+    return index;
+}
+
+void keyframe_index_close(keyframe_index_t *index) {
+    if (!index) {
+        return;
+    }
+    pthread_mutex_lock(&registry_lock);
+    if (--index->refs > 0) {
+        pthread_mutex_unlock(&registry_lock);
+        return;
+    }
+    for (keyframe_index_t **it = &registry; *it; it = &(*it)->next) {
+        if (*it == index) {
+            *it = index->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+
+    if (index->thread_started) {
+        __atomic_store_n(&index->cancel, true, __ATOMIC_RELAXED);
+        pthread_join(index->thread, NULL);
+    }
+    free(index->entries);
+    free(index->path);
+    free(index);
+}
+
+bool keyframe_index_ready(const keyframe_index_t *index) {
+    return index && __atomic_load_n(&index->ready, __ATOMIC_ACQUIRE);
+}
+
+bool keyframe_index_lookup(const keyframe_index_t *index, int64_t pts, keyframe_entry_t *out) {
+    if (!keyframe_index_ready(index)) {
+        return false;
+    }
+    // Binary search for the last entry with entry.pts <= pts
+    int lo = 0, hi = index->count - 1, found = 0;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (index->entries[mid].pts <= pts) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    *out = index->entries[found];
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef KEYFRAME_INDEX_H
+#define KEYFRAME_INDEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Keyframe index: PTS and byte offset of every GOP start in a file's video
+// stream, so a seek goes straight to the right keyframe instead of through
+// the demuxer's own search (a timestamp bisection over the whole file for
+// MPEG-TS). Built once per file on a background thread with a second demuxer
+// at idle I/O priority, or copied from the container when it carries a full
+// index (MP4, MKV), then persisted as a startup cache sidecar so later runs
+// have it from the first frame. Contexts on the same file share one index.
+//
+// PICKLE_KEYFRAME_INDEX=0 disables indexing; seeks then use av_seek_frame().
+#define KEYFRAME_INDEX_VERSION 1
+
+typedef struct {
+    int64_t pts;                 // Stream time base (dts where the packet had no pts)
+    int64_t pos;                 // Byte offset of the keyframe packet, -1: seek by pts (container index)
+} keyframe_entry_t;
+
+typedef struct keyframe_index keyframe_index_t;
+
+// Shared, reference-counted index of path's video stream. Loads the sidecar or
+// starts the background build. NULL for URLs and anything but regular files.
+keyframe_index_t *keyframe_index_open(const char *path, int stream_index, int time_base_num, int time_base_den);
+void keyframe_index_close(keyframe_index_t *index);
+
+bool keyframe_index_ready(const keyframe_index_t *index);
+// Last keyframe at or before pts (the first keyframe if pts precedes it). False until ready.
+bool keyframe_index_lookup(const keyframe_index_t *index, int64_t pts, keyframe_entry_t *out);
+
+#endif // KEYFRAME_INDEX_H
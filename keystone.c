@@ -273,6 +273,7 @@ void keystone_calculate_matrix(keystone_context_t *keystone) {
     
     calculate_perspective_matrix(keystone->matrix, keystone->corners);
     keystone->matrix_dirty = false;
+    keystone->matrix_version++;
 }
 
 const float* keystone_get_matrix(keystone_context_t *keystone) {
@@ -292,6 +293,55 @@ void keystone_reset_corners(keystone_context_t *keystone) {
     keystone->corners_dirty = true;  // Mark corners VBO needs update
 }
 
+// True if the corners form an upright rectangle (within tolerance, NDC units) that
+// lies on screen, i.e. the warp is a pure scale + translate a KMS plane can do
+bool keystone_get_axis_aligned_rect(keystone_context_t *keystone, float tolerance,
+                                    float *left, float *top, float *right, float *bottom) {
+    if (!keystone) return false;
+
+    const point_t *c = keystone->corners;
+    if (fabsf(c[CORNER_TOP_LEFT].x - c[CORNER_BOTTOM_LEFT].x) > tolerance ||
+        fabsf(c[CORNER_TOP_RIGHT].x - c[CORNER_BOTTOM_RIGHT].x) > tolerance ||
+        fabsf(c[CORNER_TOP_LEFT].y - c[CORNER_TOP_RIGHT].y) > tolerance ||
+        fabsf(c[CORNER_BOTTOM_LEFT].y - c[CORNER_BOTTOM_RIGHT].y) > tolerance) {
+        return false;
+    }
+
+    float l = (c[CORNER_TOP_LEFT].x + c[CORNER_BOTTOM_LEFT].x) * 0.5f;
+    float r = (c[CORNER_TOP_RIGHT].x + c[CORNER_BOTTOM_RIGHT].x) * 0.5f;
+    float t = (c[CORNER_TOP_LEFT].y + c[CORNER_TOP_RIGHT].y) * 0.5f;
+    float b = (c[CORNER_BOTTOM_LEFT].y + c[CORNER_BOTTOM_RIGHT].y) * 0.5f;
+
+    // Mirrored or off-screen quads need the GL path
+    if (r <= l || t <= b || l < -1.0f || r > 1.0f || b < -1.0f || t > 1.0f) {
+        return false;
+    }
+
+    if (left) *left = l;
+    if (top) *top = t;
+    if (right) *right = r;
+    if (bottom) *bottom = b;
+    return true;
+}
+
+// Bounding box of the warped quad in NDC, clamped to the screen
+void keystone_get_bounds(const keystone_context_t *keystone,
+                         float *left, float *top, float *right, float *bottom) {
+    float l = 1.0f, r = -1.0f, t = -1.0f, b = 1.0f;
+    for (int i = 0; i < 4; i++) {
+        const point_t *c = &keystone->corners[i];
+        l = fminf(l, c->x);
+        r = fmaxf(r, c->x);
+        b = fminf(b, c->y);
+        t = fmaxf(t, c->y);
+    }
+
+    *left = fmaxf(l, -1.0f);
+    *right = fminf(r, 1.0f);
+    *bottom = fmaxf(b, -1.0f);
+    *top = fminf(t, 1.0f);
+}
+
 void keystone_set_inset_corners(keystone_context_t *keystone, float margin) {
     // Set corners inset from the full -1.0 to 1.0 range by the specified margin
     // margin is in normalized coordinates (0.0 to 1.0)
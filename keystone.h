@@ -13,6 +13,7 @@ typedef struct {
     int selected_corner; // 0-3, -1 if none selected
     float matrix[16];    // 4x4 transformation matrix
     bool matrix_dirty;   // Need to recalculate matrix
+    unsigned int matrix_version;  // Bumped on every recalculation (GPU copies compare it)
     
     // Corner highlighting
     bool show_corners;   // Toggle corner visibility
@@ -37,6 +38,10 @@ void keystone_calculate_matrix(keystone_context_t *keystone);
 const float* keystone_get_matrix(keystone_context_t *keystone);
 void keystone_reset_corners(keystone_context_t *keystone);
 void keystone_set_inset_corners(keystone_context_t *keystone, float margin);
+bool keystone_get_axis_aligned_rect(keystone_context_t *keystone, float tolerance,
+                                    float *left, float *top, float *right, float *bottom);
+void keystone_get_bounds(const keystone_context_t *keystone,
+                         float *left, float *top, float *right, float *bottom);
 void keystone_toggle_corners(keystone_context_t *keystone);
 bool keystone_corners_visible(keystone_context_t *keystone);
 void keystone_toggle_border(keystone_context_t *keystone);
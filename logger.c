@@ -0,0 +1,292 @@
+#define _GNU_SOURCE
+#include "logger.h"
+#include "thread_topology.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <strings.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+// Slot states
+#define LOGGER_SLOT_FREE 0
+#define LOGGER_SLOT_OWNED 1       // A live thread produces into it
+#define LOGGER_SLOT_EXITED 2      // Owner exited; freed once the drain thread empties it
+
+typedef struct {
+    int level;
+    int length;
+    char text[LOGGER_LINE_MAX];
+} logger_entry_t;
+
+// Single producer (the owning thread), single consumer (the drain thread)
+typedef struct {
+    unsigned int head;            // Producer: next entry to write
+    unsigned int tail;            // Consumer: next entry to read
+    unsigned int dropped;         // Producer: messages lost to a full ring
+    logger_entry_t entries[LOGGER_RING_ENTRIES];
+} logger_ring_t;
+
+typedef struct {
+    int state;
+    logger_ring_t *ring;          // Allocated on first claim, kept for reuse until exit
+} logger_slot_t;
+
+static logger_slot_t slots[LOGGER_MAX_THREADS];
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+static pthread_t drain_thread;
+static bool running = false;
+static bool stop_requested = false;
+static int runtime_level = LOG_LEVEL;
+static bool journal_stdout = false;
+static bool journal_stderr = false;
+
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static FILE *level_stream(int level) {
+    return (level == VIDEO_LOG_ERROR || level == VIDEO_LOG_WARN) ? stderr : stdout;
+}
+
+// systemd sets JOURNAL_STREAM=dev:inode for the stream it connected; a "<N>"
+// prefix there becomes the entry's syslog priority
+static bool is_journal_stream(FILE *stream) {
+    const char *env = getenv("JOURNAL_STREAM");
+    unsigned long long dev = 0, ino = 0;
+    struct stat st;
+    if (!env || sscanf(env, "%llu:%llu", &dev, &ino) != 2 || fstat(fileno(stream), &st) != 0) {
+        return false;
+    }
+    return (unsigned long long)st.st_dev == dev && (unsigned long long)st.st_ino == ino;
+}
+
+static int syslog_priority(int level) {
+    switch (level) {
+        case VIDEO_LOG_ERROR: return 3;
+        case VIDEO_LOG_WARN:  return 4;
+        case VIDEO_LOG_DEBUG: return 7;
+        default:              return 6;
+    }
+}
+
+static void ring_key_destructor(void *value) {
+    // The thread is gone: hand its slot to the drain thread for emptying
+    for (int i = 0; i < LOGGER_MAX_THREADS; i++) {
+        if (slots[i].ring == value) {
+            __atomic_store_n(&slots[i].state, LOGGER_SLOT_EXITED, __ATOMIC_RELEASE);
+            return;
+        }
+    }
+}
+
+static void ring_key_create(void) {
+    pthread_key_create(&ring_key, ring_key_destructor);
+}
+
+static logger_ring_t *thread_ring(void) {
+    logger_ring_t *ring = (logger_ring_t *)pthread_getspecific(ring_key);
+    if (ring) {
+        return ring;
+    }
+    for (int i = 0; i < LOGGER_MAX_THREADS; i++) {
+        int expected = LOGGER_SLOT_FREE;
+        if (!__atomic_compare_exchange_n(&slots[i].state, &expected, LOGGER_SLOT_OWNED, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            continue;
+        }
+        if (!slots[i].ring) {
+            logger_ring_t *fresh = (logger_ring_t *)calloc(1, sizeof(logger_ring_t));
+            if (!fresh) {
+                __atomic_store_n(&slots[i].state, LOGGER_SLOT_FREE, __ATOMIC_RELEASE);
+                return NULL;
+            }
+            __atomic_store_n(&slots[i].ring, fresh, __ATOMIC_RELEASE);
+        }
+        pthread_setspecific(ring_key, slots[i].ring);
+        return slots[i].ring;
+    }
+    return NULL;  // More logging threads than slots: this one stays synchronous
+}
+
+static void write_entry(int level, const char *text, int length) {
+    // Messages built from several calls only get the prefix on their first piece
+    static bool stdout_line_start = true;
+    static bool stderr_line_start = true;
+    FILE *stream = level_stream(level);
+    bool *line_start = stream == stderr ? &stderr_line_start : &stdout_line_start;
+    bool journal = stream == stderr ? journal_stderr : journal_stdout;
+    if (length <= 0) {
+        return;
+    }
+    if (journal && *line_start) {
+        fprintf(stream, "<%d>", syslog_priority(level));
+    }
+    fwrite(text, 1, (size_t)length, stream);
+    *line_start = text[length - 1] == '\n';
+}
+
+void logger_write(video_log_level_t level, const char *fmt, ...) {
+    if ((int)level > __atomic_load_n(&runtime_level, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    va_list args;
+    logger_ring_t *ring = __atomic_load_n(&running, __ATOMIC_ACQUIRE) ? thread_ring() : NULL;
+    if (!ring) {
+        va_start(args, fmt);
+        vfprintf(level_stream(level), fmt, args);
+        va_end(args);
+        return;
+    }
+
+    unsigned int head = ring->head;
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= LOGGER_RING_ENTRIES) {
+        __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    logger_entry_t *entry = &ring->entries[head & (LOGGER_RING_ENTRIES - 1)];
+    va_start(args, fmt);
+    int length = vsnprintf(entry->text, sizeof(entry->text), fmt, args);
+    va_end(args);
+    if (length < 0) {
+        return;
+    }
+    if (length >= (int)sizeof(entry->text)) {
+        // Truncated: keep the line terminated
+        length = (int)sizeof(entry->text) - 1;
+        entry->text[length - 1] = '\n';
+    }
+    entry->level = level;
+    entry->length = length;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+bool logger_ratelimit(logger_ratelimit_t *limit, const char *file, int line) {
+    uint64_t now = monotonic_ms();
+    uint64_t start = __atomic_load_n(&limit->window_start_ms, __ATOMIC_RELAXED);
+    if (start == 0 || now - start >= LOGGER_RATELIMIT_INTERVAL_MS) {
+        if (__atomic_compare_exchange_n(&limit->window_start_ms, &start, now, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&limit->count, 0, __ATOMIC_RELAXED);
+            unsigned int suppressed = __atomic_exchange_n(&limit->suppressed, 0, __ATOMIC_RELAXED);
+            if (suppressed > 0) {
+                logger_write(VIDEO_LOG_WARN, "[LOG] %s:%d: %u similar message(s) suppressed\n",
+                             file, line, suppressed);
+            }
+        }
+    }
+    if (__atomic_fetch_add(&limit->count, 1, __ATOMIC_RELAXED) < LOGGER_RATELIMIT_BURST) {
+        return true;
+    }
+    __atomic_fetch_add(&limit->suppressed, 1, __ATOMIC_RELAXED);
+    return false;
+}
+
+// One pass over every ring; returns the number of entries written
+static int drain_rings(void) {
+    int written = 0;
+    for (int i = 0; i < LOGGER_MAX_THREADS; i++) {
+        int state = __atomic_load_n(&slots[i].state, __ATOMIC_ACQUIRE);
+        logger_ring_t *ring = __atomic_load_n(&slots[i].ring, __ATOMIC_ACQUIRE);
+        if (state == LOGGER_SLOT_FREE || !ring) {
+            continue;
+        }
+        unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        unsigned int tail = ring->tail;
+        for (; tail != head; tail++) {
+            logger_entry_t *entry = &ring->entries[tail & (LOGGER_RING_ENTRIES - 1)];
+            write_entry(entry->level, entry->text, entry->length);
+            written++;
+        }
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+
+        unsigned int dropped = __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_RELAXED);
+        if (dropped > 0) {
+            char notice[64];
+            int length = snprintf(notice, sizeof(notice), "[LOG] %u message(s) dropped (ring full)\n", dropped);
+            write_entry(VIDEO_LOG_WARN, notice, length);
+            written++;
+        }
+        if (state == LOGGER_SLOT_EXITED) {
+            __atomic_store_n(&slots[i].state, LOGGER_SLOT_FREE, __ATOMIC_RELEASE);
+        }
+    }
+    if (written > 0) {
+        // One flush per pass; this is the only place that may block on the terminal or journald
+        fflush(stdout);
+        fflush(stderr);
+    }
+    return written;
+}
+
+static void *drain_thread_main(void *arg) {
+    (void)arg;
+    thread_topology_set_name("pickle-log");
+
+    while (!__atomic_load_n(&stop_requested, __ATOMIC_ACQUIRE)) {
+        if (drain_rings() == 0) {
+            struct timespec idle = {0, LOGGER_DRAIN_MS * 1000000L};
+            nanosleep(&idle, NULL);
+        }
+    }
+    drain_rings();
+    return NULL;
+}
+
+static int parse_level(const char *name) {
+    if (strcasecmp(name, "error") == 0) return VIDEO_LOG_ERROR;
+    if (strcasecmp(name, "warn") == 0 || strcasecmp(name, "warning") == 0) return VIDEO_LOG_WARN;
+    if (strcasecmp(name, "info") == 0) return VIDEO_LOG_INFO;
+    if (strcasecmp(name, "debug") == 0) return VIDEO_LOG_DEBUG;
+    return -2;
+}
+
+int logger_init(void) {
+    if (__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    pthread_once(&ring_key_once, ring_key_create);
+
+    const char *env = getenv("PICKLE_LOG_LEVEL");
+    if (env && env[0]) {
+        int level = parse_level(env);
+        if (level == -2) {
+            fprintf(stderr, "[LOG] Unknown PICKLE_LOG_LEVEL=%s (error, warn, info, debug)\n", env);
+        } else if (level > LOG_LEVEL) {
+            fprintf(stderr, "[LOG] PICKLE_LOG_LEVEL=%s is above this build's compiled level\n", env);
+        } else {
+            runtime_level = level;
+        }
+    }
+    journal_stdout = is_journal_stream(stdout);
+    journal_stderr = is_journal_stream(stderr);
+
+    // Anything printed directly so far must not appear after queued messages
+    fflush(stdout);
+    __atomic_store_n(&stop_requested, false, __ATOMIC_RELEASE);
+    if (pthread_create(&drain_thread, NULL, drain_thread_main, NULL) != 0) {
+        fprintf(stderr, "[LOG] Failed to start drain thread, logging synchronously\n");
+        return -1;
+    }
+    __atomic_store_n(&running, true, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void logger_shutdown(void) {
+    if (!__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    // Later messages go straight to stdio; the drain thread empties what is queued
+    __atomic_store_n(&running, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&stop_requested, true, __ATOMIC_RELEASE);
+    pthread_join(drain_thread, NULL);
+}
@@ -0,0 +1,70 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "production_config.h"
+
+// Asynchronous logging for the decode and render hot paths. Each thread
+// formats into its own lock-free ring; a background thread drains the rings
+// to stdout (info/debug) and stderr (warnings/errors), so a slow terminal or
+// journald never blocks a producer. A full ring drops the message and counts
+// it instead of waiting. Before logger_init and after logger_shutdown,
+// messages are written synchronously.
+//
+// Levels above LOG_LEVEL (DEFAULT_LOG_LEVEL from production_config.h unless
+// -DLOG_LEVEL=... is given) compile to nothing; PICKLE_LOG_LEVEL
+// (error/warn/info/debug) can only lower the level at runtime.
+typedef enum {
+    VIDEO_LOG_ALWAYS = -1,       // User-requested output (--timing), never filtered
+    VIDEO_LOG_ERROR = 0,
+    VIDEO_LOG_WARN,
+    VIDEO_LOG_INFO,
+    VIDEO_LOG_DEBUG
+} video_log_level_t;
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL DEFAULT_LOG_LEVEL
+#endif
+
+#define LOGGER_MAX_THREADS 16            // Threads with their own ring; others log synchronously
+#define LOGGER_RING_ENTRIES 128          // Per thread, power of two
+#define LOGGER_LINE_MAX 256              // Longer messages are truncated
+#define LOGGER_DRAIN_MS 10               // Drain thread idle poll
+#define LOGGER_RATELIMIT_BURST 5         // Messages per call site ...
+#define LOGGER_RATELIMIT_INTERVAL_MS 5000  // ... per window; the rest are counted and summarized
+
+// Per call site state for the *_RATELIMITED macros
+typedef struct {
+    uint64_t window_start_ms;
+    unsigned int count;
+    unsigned int suppressed;
+} logger_ratelimit_t;
+
+int logger_init(void);
+void logger_shutdown(void);
+
+void logger_write(video_log_level_t level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+bool logger_ratelimit(logger_ratelimit_t *limit, const char *file, int line);
+
+#define LOG_AT(level, ...) do { \
+        if ((level) <= LOG_LEVEL) logger_write((level), __VA_ARGS__); \
+    } while (0)
+
+#define LOG_AT_RATELIMITED(level, ...) do { \
+        if ((level) <= LOG_LEVEL) { \
+            static logger_ratelimit_t log_limit_; \
+            if (logger_ratelimit(&log_limit_, __FILE__, __LINE__)) logger_write((level), __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_PRINT(...) logger_write(VIDEO_LOG_ALWAYS, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(VIDEO_LOG_ERROR, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(VIDEO_LOG_WARN, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(VIDEO_LOG_INFO, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(VIDEO_LOG_DEBUG, __VA_ARGS__)
+#define LOG_ERROR_RATELIMITED(...) LOG_AT_RATELIMITED(VIDEO_LOG_ERROR, __VA_ARGS__)
+#define LOG_WARN_RATELIMITED(...)  LOG_AT_RATELIMITED(VIDEO_LOG_WARN, __VA_ARGS__)
+#define LOG_INFO_RATELIMITED(...)  LOG_AT_RATELIMITED(VIDEO_LOG_INFO, __VA_ARGS__)
+
+#endif // LOGGER_H
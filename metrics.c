@@ -0,0 +1,580 @@
+#define _GNU_SOURCE
+#include "metrics.h"
+#include "thread_topology.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#define METRICS_HTTP_POLL_MS 250        // Exporter wakes this often to notice shutdown
+#define METRICS_HTTP_TIMEOUT_MS 1000    // A scraper that sends nothing for this long is dropped
+#define METRICS_PROM_FIRST_POW 6        // Exported histogram buckets: 2^6 us (64 us) ...
+#define METRICS_PROM_LAST_POW 24        // ... to 2^24 us (16.8 s), plus +Inf
+
+static metrics_t *metrics = NULL;
+static bool metrics_shared = false;
+static char metrics_shm_name[64];
+
+// Claimed shards; 0 is never claimed and takes atomic adds from any thread
+static bool shard_claimed[METRICS_MAX_SHARDS];
+static pthread_key_t shard_key;
+static pthread_once_t shard_key_once = PTHREAD_ONCE_INIT;
+
+static int http_fd = -1;
+static pthread_t http_thread;
+static bool http_started = false;
+static bool http_running = false;
+static char *http_buffer = NULL;
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int metrics_hist_bucket(uint64_t value_us) {
+    if (value_us < (1u << METRICS_HIST_SUB_BITS)) {
+        return (int)value_us;
+    }
+    int msb = 63 - __builtin_clzll(value_us);
+    int shift = msb - METRICS_HIST_SUB_BITS;
+    int bucket = ((shift + 1) << METRICS_HIST_SUB_BITS) +
+                 (int)((value_us >> shift) & ((1u << METRICS_HIST_SUB_BITS) - 1));
+    return bucket < METRICS_HIST_BUCKETS ? bucket : METRICS_HIST_BUCKETS - 1;
+}
+
+uint64_t metrics_hist_bucket_lower(int bucket) {
+    const int sub_count = 1 << METRICS_HIST_SUB_BITS;
+    if (bucket < sub_count) {
+        return bucket < 0 ? 0 : (uint64_t)bucket;
+    }
+    int shift = (bucket >> METRICS_HIST_SUB_BITS) - 1;
+    return (uint64_t)(sub_count + (bucket & (sub_count - 1))) << shift;
+}
+
+uint64_t metrics_hist_quantile(const metrics_histogram_t *hist, double quantile) {
+    uint64_t total = 0;
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        total += hist->buckets[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(quantile * (double)total + 0.5);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            // Highest value the bucket can hold, never above the recorded maximum
+            uint64_t upper = i + 1 < METRICS_HIST_BUCKETS ? metrics_hist_bucket_lower(i + 1) - 1 : hist->max_us;
+            return upper < hist->max_us ? upper : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+void metrics_hist_merge(metrics_histogram_t *into, const metrics_histogram_t *shard) {
+    into->count += __atomic_load_n(&shard->count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+        into->buckets[i] += __atomic_load_n(&shard->buckets[i], __ATOMIC_RELAXED);
+    }
+    into->sum_us += __atomic_load_n(&shard->sum_us, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&shard->max_us, __ATOMIC_RELAXED);
+    if (max > into->max_us) {
+        into->max_us = max;
+    }
+}
+
+static void shard_key_destructor(void *value) {
+    int shard = (int)(intptr_t)value - 1;
+    if (shard > 0) {
+        // Totals stay in the shard; the next thread to claim it keeps adding
+        __atomic_store_n(&shard_claimed[shard], false, __ATOMIC_RELEASE);
+    }
+}
+
+static void shard_key_create(void) {
+    pthread_key_create(&shard_key, shard_key_destructor);
+}
+
+// The calling thread's shard index, claimed on its first sample
+static int thread_shard(void) {
+    pthread_once(&shard_key_once, shard_key_create);
+    intptr_t slot = (intptr_t)pthread_getspecific(shard_key);
+    if (slot) {
+        return (int)slot - 1;
+    }
+    int shard = 0;
+    for (int i = 1; i < METRICS_MAX_SHARDS; i++) {
+        bool expected = false;
+        if (__atomic_compare_exchange_n(&shard_claimed[i], &expected, true, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            shard = i;
+            break;
+        }
+    }
+    pthread_setspecific(shard_key, (void *)(intptr_t)(shard + 1));
+    return shard;
+}
+
+// Sole writer: load + store instead of a locked read-modify-write
+static void shard_add(int shard, uint64_t *value, uint64_t n, int order) {
+    if (shard == 0) {
+        __atomic_fetch_add(value, n, order);
+    } else {
+        __atomic_store_n(value, __atomic_load_n(value, __ATOMIC_RELAXED) + n, order);
+    }
+}
+
+static void hist_record(int shard, metrics_histogram_t *hist, double seconds) {
+    uint64_t us = seconds > 0.0 ? (uint64_t)(seconds * 1e6 + 0.5) : 0;
+    shard_add(shard, &hist->buckets[metrics_hist_bucket(us)], 1, __ATOMIC_RELAXED);
+    shard_add(shard, &hist->sum_us, us, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&hist->max_us, __ATOMIC_RELAXED);
+    if (shard != 0) {
+        if (us > max) {
+            __atomic_store_n(&hist->max_us, us, __ATOMIC_RELAXED);
+        }
+    } else {
+        while (us > max && !__atomic_compare_exchange_n(&hist->max_us, &max, us, true,
+                                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        }
+    }
+    // Count last: a reader that sees it also sees the bucket
+    shard_add(shard, &hist->count, 1, __ATOMIC_RELEASE);
+}
+
+static bool valid_stream(int stream) {
+    return metrics && stream >= 0 && stream < METRICS_MAX_STREAMS;
+}
+
+void metrics_record_decode(int stream, double seconds) {
+    if (!valid_stream(stream)) return;
+    int shard = thread_shard();
+    metrics_shard_t *own = &metrics->shards[shard];
+    hist_record(shard, &own->decode[stream], seconds);
+    shard_add(shard, &own->decoded[stream], 1, __ATOMIC_RELAXED);
+}
+
+void metrics_record_render(double upload, double draw, double swap, double interval) {
+    if (!metrics) return;
+    int shard = thread_shard();
+    metrics_shard_t *own = &metrics->shards[shard];
+    hist_record(shard, &own->upload, upload);
+    hist_record(shard, &own->draw, draw);
+    hist_record(shard, &own->swap, swap);
+    if (interval > 0.0) {
+        hist_record(shard, &own->interval, interval);
+    }
+    shard_add(shard, &own->frames_rendered, 1, __ATOMIC_RELAXED);
+}
+
+void metrics_record_vblank_misses(unsigned int missed) {
+    if (!metrics || missed == 0) return;
+    int shard = thread_shard();
+    shard_add(shard, &metrics->shards[shard].vblank_misses, missed, __ATOMIC_RELAXED);
+}
+
+void metrics_record_hw_fallback(void) {
+    if (!metrics) return;
+    int shard = thread_shard();
+    shard_add(shard, &metrics->shards[shard].hw_fallbacks, 1, __ATOMIC_RELAXED);
+}
+
+void metrics_record_io_stall(double seconds) {
+    if (!metrics) return;
+    int shard = thread_shard();
+    shard_add(shard, &metrics->shards[shard].io_underruns, 1, __ATOMIC_RELAXED);
+    hist_record(shard, &metrics->shards[shard].io_stall, seconds);
+}
+
+void metrics_set_queue(int stream, int depth, int capacity) {
+    if (!valid_stream(stream)) return;
+    __atomic_store_n(&metrics->streams[stream].queue_depth, (int64_t)depth, __ATOMIC_RELAXED);
+    __atomic_store_n(&metrics->streams[stream].queue_capacity, (int64_t)capacity, __ATOMIC_RELAXED);
+}
+
+void metrics_set_frames(int stream, unsigned int shown, unsigned int dropped, unsigned int repeated) {
+    if (!valid_stream(stream)) return;
+    __atomic_store_n(&metrics->streams[stream].shown, (uint64_t)shown, __ATOMIC_RELAXED);
+    __atomic_store_n(&metrics->streams[stream].dropped, (uint64_t)dropped, __ATOMIC_RELAXED);
+    __atomic_store_n(&metrics->streams[stream].repeated, (uint64_t)repeated, __ATOMIC_RELAXED);
+}
+
+// Bounded text builder: output past size is dropped, len still counts it
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+} prom_out_t;
+
+static void prom_printf(prom_out_t *out, const char *fmt, ...) {
+    if (out->len >= out->size) return;
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(out->buf + out->len, out->size - out->len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        out->len += (size_t)n;
+    }
+}
+
+static void prom_header(prom_out_t *out, const char *name, const char *type, const char *help) {
+    prom_printf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static uint64_t load_u64(const uint64_t *value) {
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+}
+
+// Sum of the counter at offset within metrics_shard_t over all shards
+static uint64_t sum_counter(size_t offset) {
+    uint64_t total = 0;
+    for (int s = 0; s < METRICS_MAX_SHARDS; s++) {
+        total += load_u64((const uint64_t *)((const char *)&metrics->shards[s] + offset));
+    }
+    return total;
+}
+
+static void prom_histogram(prom_out_t *out, const char *name, const char *labels, size_t offset) {
+    metrics_histogram_t snap;
+    memset(&snap, 0, sizeof(snap));
+    for (int s = 0; s < METRICS_MAX_SHARDS; s++) {
+        metrics_hist_merge(&snap, (const metrics_histogram_t *)((const char *)&metrics->shards[s] + offset));
+    }
+
+    // Derive the count from the buckets so the series is self-consistent mid-update.
+    // Each bound runs through the bucket starting at 2^pow, so le is that bucket's last
+    // value: a sample of exactly 2^pow us is counted, and nothing above le is.
+    const char *sep = labels[0] ? "," : "";
+    uint64_t cumulative = 0;
+    int bucket = 0;
+    for (int pow = METRICS_PROM_FIRST_POW; pow <= METRICS_PROM_LAST_POW; pow++) {
+        int limit = metrics_hist_bucket(1ull << pow) + 1;
+        for (; bucket < limit; bucket++) {
+            cumulative += snap.buckets[bucket];
+        }
+        prom_printf(out, "%s_bucket{%s%sle=\"%.6f\"} %llu\n", name, labels, sep,
+                    (double)(metrics_hist_bucket_lower(limit) - 1) / 1e6, (unsigned long long)cumulative);
+    }
+    for (; bucket < METRICS_HIST_BUCKETS; bucket++) {
+        cumulative += snap.buckets[bucket];
+    }
+    prom_printf(out, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, labels, sep, (unsigned long long)cumulative);
+    const char *open = labels[0] ? "{" : "";
+    const char *close = labels[0] ? "}" : "";
+    prom_printf(out, "%s_sum%s%s%s %.6f\n", name, open, labels, close, (double)snap.sum_us / 1e6);
+    prom_printf(out, "%s_count%s%s%s %llu\n", name, open, labels, close, (unsigned long long)cumulative);
+}
+
+static void prom_counter(prom_out_t *out, const char *name, const char *help, size_t offset) {
+    prom_header(out, name, "counter", help);
+    prom_printf(out, "%s %llu\n", name, (unsigned long long)sum_counter(offset));
+}
+
+size_t metrics_format_prometheus(char *buf, size_t size) {
+    if (!buf || size == 0) return 0;
+    buf[0] = '\0';
+    if (!metrics) return 0;
+
+    prom_out_t out = { buf, size, 0 };
+    int streams = metrics->stream_count;
+    char labels[METRICS_MAX_STREAMS][24];
+    for (int i = 0; i < streams; i++) {
+        snprintf(labels[i], sizeof(labels[i]), "stream=\"%d\"", i + 1);
+    }
+
+    prom_header(&out, "pickle_uptime_seconds", "gauge", "Seconds since the player started");
+    prom_printf(&out, "pickle_uptime_seconds %.3f\n", monotonic_seconds() - metrics->start_time);
+
+    prom_counter(&out, "pickle_frames_rendered_total", "Frames presented by the render loop",
+                 offsetof(metrics_shard_t, frames_rendered));
+    prom_counter(&out, "pickle_vblank_misses_total", "Vblanks that passed without a new flip",
+                 offsetof(metrics_shard_t, vblank_misses));
+    prom_counter(&out, "pickle_hw_fallbacks_total", "Hardware decoder failures that switched to software",
+                 offsetof(metrics_shard_t, hw_fallbacks));
+    prom_counter(&out, "pickle_io_underruns_total", "Read-ahead ring underruns",
+                 offsetof(metrics_shard_t, io_underruns));
+
+    prom_header(&out, "pickle_frames_decoded_total", "counter", "Frames decoded");
+    for (int i = 0; i < streams; i++) {
+        prom_printf(&out, "pickle_frames_decoded_total{%s} %llu\n", labels[i],
+                    (unsigned long long)sum_counter(offsetof(metrics_shard_t, decoded) + (size_t)i * sizeof(uint64_t)));
+    }
+
+    static const struct {
+        const char *name;
+        const char *help;
+        size_t offset;
+    } stream_counters[] = {
+        { "pickle_frames_shown_total", "Frames shown by the scheduler", offsetof(metrics_stream_t, shown) },
+        { "pickle_frames_dropped_total", "Late frames dropped by the scheduler", offsetof(metrics_stream_t, dropped) },
+        { "pickle_frames_repeated_total", "Vblanks that repeated the previous frame", offsetof(metrics_stream_t, repeated) },
+    };
+    for (size_t c = 0; c < sizeof(stream_counters) / sizeof(stream_counters[0]); c++) {
+        prom_header(&out, stream_counters[c].name, "counter", stream_counters[c].help);
+        for (int i = 0; i < streams; i++) {
+            const uint64_t *value = (const uint64_t *)((const char *)&metrics->streams[i] + stream_counters[c].offset);
+            prom_printf(&out, "%s{%s} %llu\n", stream_counters[c].name, labels[i],
+                        (unsigned long long)load_u64(value));
+        }
+    }
+
+    prom_header(&out, "pickle_decode_queue_depth", "gauge", "Decoded frames waiting for the render loop");
+    for (int i = 0; i < streams; i++) {
+        prom_printf(&out, "pickle_decode_queue_depth{%s} %lld\n", labels[i],
+                    (long long)__atomic_load_n(&metrics->streams[i].queue_depth, __ATOMIC_RELAXED));
+    }
+    prom_header(&out, "pickle_decode_queue_capacity", "gauge", "Decode-ahead queue size");
+    for (int i = 0; i < streams; i++) {
+        prom_printf(&out, "pickle_decode_queue_capacity{%s} %lld\n", labels[i],
+                    (long long)__atomic_load_n(&metrics->streams[i].queue_capacity, __ATOMIC_RELAXED));
+    }
+
+    prom_header(&out, "pickle_decode_seconds", "histogram", "Time to decode one frame");
+    for (int i = 0; i < streams; i++) {
+        prom_histogram(&out, "pickle_decode_seconds", labels[i],
+                       offsetof(metrics_shard_t, decode) + (size_t)i * sizeof(metrics_histogram_t));
+    }
+    prom_header(&out, "pickle_upload_seconds", "histogram", "Texture upload or EGLImage import per frame");
+    prom_histogram(&out, "pickle_upload_seconds", "", offsetof(metrics_shard_t, upload));
+    prom_header(&out, "pickle_draw_seconds", "histogram", "Keystone warp and overlay drawing per frame");
+    prom_histogram(&out, "pickle_draw_seconds", "", offsetof(metrics_shard_t, draw));
+    prom_header(&out, "pickle_swap_seconds", "histogram", "Buffer swap and page flip per frame");
+    prom_histogram(&out, "pickle_swap_seconds", "", offsetof(metrics_shard_t, swap));
+    prom_header(&out, "pickle_frame_interval_seconds", "histogram", "Time between consecutive swaps");
+    prom_histogram(&out, "pickle_frame_interval_seconds", "", offsetof(metrics_shard_t, interval));
+    prom_header(&out, "pickle_io_stall_seconds", "histogram", "Demuxer time blocked per read-ahead underrun");
+    prom_histogram(&out, "pickle_io_stall_seconds", "", offsetof(metrics_shard_t, io_stall));
+
+    if (out.len >= size) {
+        fprintf(stderr, "[METRICS] /metrics output truncated at %zu bytes\n", size);
+        return size - 1;
+    }
+    return out.len;
+}
+
+static void send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t sent = send(fd, data, len, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += sent;
+        len -= (size_t)sent;
+    }
+}
+
+static void serve_client(int fd) {
+    char request[1024];
+    size_t len = 0;
+    // Only the request line matters; read until the headers end or the buffer fills
+    while (len < sizeof(request) - 1) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if (poll(&pfd, 1, METRICS_HTTP_TIMEOUT_MS) <= 0) {
+            return;
+        }
+        ssize_t n = recv(fd, request + len, sizeof(request) - 1 - len, 0);
+        if (n <= 0) {
+            return;
+        }
+        len += (size_t)n;
+        request[len] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) {
+            break;
+        }
+    }
+    request[len] = '\0';
+
+    bool is_metrics = strncmp(request, "GET /metrics", 12) == 0 &&
+                      (request[12] == ' ' || request[12] == '?');
+    if (!is_metrics) {
+        static const char not_found[] =
+            "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 10\r\n"
+            "Connection: close\r\n\r\nnot found\n";
+        send_all(fd, not_found, sizeof(not_found) - 1);
+        return;
+    }
+
+    size_t body_len = metrics_format_prometheus(http_buffer, METRICS_HTTP_BUFFER);
+    char header[160];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                              "Content-Length: %zu\r\nConnection: close\r\n\r\n", body_len);
+    send_all(fd, header, (size_t)header_len);
+    send_all(fd, http_buffer, body_len);
+}
+
+// One scrape at a time is plenty for a monitoring endpoint
+static void *http_thread_main(void *arg) {
+    (void)arg;
+    thread_topology_set_name("pickle-metrics");
+
+    while (__atomic_load_n(&http_running, __ATOMIC_ACQUIRE)) {
+        struct pollfd pfd = { .fd = http_fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, METRICS_HTTP_POLL_MS);
+        if (ready <= 0) {
+            continue;
+        }
+        int client = accept(http_fd, NULL, NULL);
+        if (client < 0) {
+            continue;
+        }
+        serve_client(client);
+        close(client);
+    }
+    return NULL;
+}
+
+static int http_start(int port) {
+    http_buffer = malloc(METRICS_HTTP_BUFFER);
+    if (!http_buffer) {
+        fprintf(stderr, "[METRICS] Failed to allocate HTTP buffer\n");
+        return -1;
+    }
+
+    http_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (http_fd < 0) {
+        fprintf(stderr, "[METRICS] socket: %s\n", strerror(errno));
+        goto fail;
+    }
+    int reuse = 1;
+    setsockopt(http_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(http_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(http_fd, 4) != 0) {
+        fprintf(stderr, "[METRICS] Cannot listen on port %d: %s\n", port, strerror(errno));
+        goto fail;
+    }
+
+    __atomic_store_n(&http_running, true, __ATOMIC_RELEASE);
+    if (pthread_create(&http_thread, NULL, http_thread_main, NULL) != 0) {
+        fprintf(stderr, "[METRICS] Failed to start exporter thread\n");
+        __atomic_store_n(&http_running, false, __ATOMIC_RELEASE);
+        goto fail;
+    }
+    http_started = true;
+    printf("[METRICS] Serving http://0.0.0.0:%d/metrics\n", port);
+    return 0;
+
+fail:
+    if (http_fd >= 0) {
+        close(http_fd);
+        http_fd = -1;
+    }
+    free(http_buffer);
+    http_buffer = NULL;
+    return -1;
+}
+
+int metrics_init(int stream_count) {
+    if (metrics) {
+        return 0;
+    }
+
+    // PICKLE_METRICS_SHM=0 keeps the block private (HTTP export still works)
+    const char *name = getenv("PICKLE_METRICS_SHM");
+    if (!name || !name[0]) {
+        name = METRICS_SHM_NAME;
+    }
+    if (strcmp(name, "0") != 0) {
+        snprintf(metrics_shm_name, sizeof(metrics_shm_name), "%s%s", name[0] == '/' ? "" : "/", name);
+        int fd = shm_open(metrics_shm_name, O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            fprintf(stderr, "[METRICS] shm_open %s: %s (metrics stay in-process)\n",
+                    metrics_shm_name, strerror(errno));
+        } else if (ftruncate(fd, sizeof(metrics_t)) != 0) {
+            fprintf(stderr, "[METRICS] ftruncate %s: %s (metrics stay in-process)\n",
+                    metrics_shm_name, strerror(errno));
+            close(fd);
+            shm_unlink(metrics_shm_name);
+        } else {
+            void *map = mmap(NULL, sizeof(metrics_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (map == MAP_FAILED) {
+                fprintf(stderr, "[METRICS] mmap %s: %s (metrics stay in-process)\n",
+                        metrics_shm_name, strerror(errno));
+                shm_unlink(metrics_shm_name);
+            } else {
+                metrics = (metrics_t *)map;
+                metrics_shared = true;
+            }
+        }
+    }
+    if (!metrics) {
+        metrics = (metrics_t *)calloc(1, sizeof(metrics_t));
+        if (!metrics) {
+            fprintf(stderr, "[METRICS] Failed to allocate metrics block\n");
+            return -1;
+        }
+    }
+
+    // A previous instance may have left its numbers in the segment
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->version = METRICS_VERSION;
+    metrics->size = (uint32_t)sizeof(metrics_t);
+    metrics->pid = (int32_t)getpid();
+    metrics->start_time = monotonic_seconds();
+    metrics->stream_count = stream_count < 1 ? 1 :
+                            (stream_count > METRICS_MAX_STREAMS ? METRICS_MAX_STREAMS : stream_count);
+    // Magic last: readers treat the block as valid from here on
+    __atomic_store_n(&metrics->magic, METRICS_MAGIC, __ATOMIC_RELEASE);
+    if (metrics_shared) {
+        printf("[METRICS] Shared memory segment %s (%zu bytes)\n", metrics_shm_name, sizeof(metrics_t));
+    }
+
+    const char *port_env = getenv("PICKLE_METRICS_PORT");
+    if (port_env && port_env[0]) {
+        int port = atoi(port_env);
+        if (port > 0 && port < 65536) {
+            http_start(port);
+        } else if (port != 0) {
+            fprintf(stderr, "[METRICS] PICKLE_METRICS_PORT=%s out of range, exporter disabled\n", port_env);
+        }
+    }
+    return 0;
+}
+
+void metrics_shutdown(void) {
+    if (http_started) {
+        __atomic_store_n(&http_running, false, __ATOMIC_RELEASE);
+        pthread_join(http_thread, NULL);
+        http_started = false;
+    }
+    if (http_fd >= 0) {
+        close(http_fd);
+        http_fd = -1;
+    }
+    free(http_buffer);
+    http_buffer = NULL;
+
+    if (!metrics) {
+        return;
+    }
+    metrics_t *block = metrics;
+    metrics = NULL;
+    if (metrics_shared) {
+        munmap(block, sizeof(*block));
+        shm_unlink(metrics_shm_name);
+        metrics_shared = false;
+    } else {
+        free(block);
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Always-on runtime metrics: counters, gauges and HDR-style latency histograms
+// that the render, decode and I/O threads update without locks or allocation.
+// Each recording thread owns a shard of the counters and histograms and is its
+// only writer, so a sample is a few plain relaxed stores and no cache line is
+// shared between threads; readers sum the shards. The block lives in a POSIX shared
+// memory segment (PICKLE_METRICS_SHM, default /pickle-metrics) that external
+// tools can map read-only, and PICKLE_METRICS_PORT=N additionally serves it as
+// Prometheus text on http://<host>:N/metrics.
+//
+// Histograms are log-linear over microseconds: exact below 8 us, then 8
+// sub-buckets per power of two (at most 12.5% relative error) up to ~67 s.
+// Power-of-two microsecond values are always bucket boundaries.
+#define METRICS_MAGIC 0x544d4b50u          // "PKMT"
+#define METRICS_VERSION 2
+#define METRICS_SHM_NAME "/pickle-metrics"
+#define METRICS_MAX_STREAMS 4
+#define METRICS_MAX_SHARDS 16            // Shard 0 is shared by threads that find no free one
+#define METRICS_HIST_SUB_BITS 3
+#define METRICS_HIST_BUCKETS 192
+#define METRICS_HTTP_BUFFER (128 * 1024)   // Formatted /metrics response
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum_us;
+    uint64_t max_us;
+    uint64_t buckets[METRICS_HIST_BUCKETS];
+} metrics_histogram_t;
+
+// Render thread only: set from the scheduler's own totals, not accumulated here
+typedef struct {
+    uint64_t shown;
+    uint64_t dropped;
+    uint64_t repeated;
+    int64_t queue_depth;            // Decoded frames waiting in the async queue
+    int64_t queue_capacity;
+} metrics_stream_t;
+
+// One recording thread's counters and histograms. A stream's totals are the
+// sum over all shards: its decodes may run on the decode or the render thread.
+typedef struct {
+    metrics_histogram_t decode[METRICS_MAX_STREAMS];  // One video_decode_frame() that produced a frame
+    uint64_t decoded[METRICS_MAX_STREAMS];
+
+    // Render thread, per presented frame
+    metrics_histogram_t upload;     // Texture upload / EGLImage import
+    metrics_histogram_t draw;       // Keystone warp + overlays
+    metrics_histogram_t swap;       // eglSwapBuffers + page flip
+    metrics_histogram_t interval;   // Swap completion to swap completion (display cadence)
+    uint64_t frames_rendered;
+    uint64_t vblank_misses;         // Vblanks between consecutive flips beyond the first
+
+    // Decoder and I/O (any decode thread)
+    uint64_t hw_fallbacks;          // Hardware decoder gave up, software took over
+    uint64_t io_underruns;          // Read-ahead ring ran empty
+    metrics_histogram_t io_stall;   // How long each underrun blocked the demuxer
+} metrics_shard_t;
+
+// Shared-memory layout. Readers check magic/version/size before trusting it.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                  // sizeof(metrics_t)
+    int32_t pid;
+    double start_time;              // CLOCK_MONOTONIC at metrics_init
+    int32_t stream_count;
+    int32_t reserved;
+
+    metrics_stream_t streams[METRICS_MAX_STREAMS];
+    metrics_shard_t shards[METRICS_MAX_SHARDS];   // Unused shards stay zero
+} metrics_t;
+
+// Map the segment and start the HTTP exporter if configured. Recording
+// before init (or after a failed init) is a no-op.
+int metrics_init(int stream_count);
+void metrics_shutdown(void);
+
+// Latencies are in seconds
+void metrics_record_decode(int stream, double seconds);
+void metrics_record_render(double upload, double draw, double swap, double interval);
+void metrics_record_vblank_misses(unsigned int missed);
+void metrics_record_hw_fallback(void);
+void metrics_record_io_stall(double seconds);
+void metrics_set_queue(int stream, int depth, int capacity);
+void metrics_set_frames(int stream, unsigned int shown, unsigned int dropped, unsigned int repeated);
+
+// Histogram helpers, also usable on a copy read from the segment
+int metrics_hist_bucket(uint64_t value_us);
+void metrics_hist_merge(metrics_histogram_t *into, const metrics_histogram_t *shard);
+uint64_t metrics_hist_bucket_lower(int bucket);
+uint64_t metrics_hist_quantile(const metrics_histogram_t *hist, double quantile);
+
+// Prometheus text exposition of the live block; returns bytes written (truncated at size)
+size_t metrics_format_prometheus(char *buf, size_t size);
+
+#endif // METRICS_H
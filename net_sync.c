@@ -0,0 +1,460 @@
+#define _GNU_SOURCE
+#include "net_sync.h"
+#include "thread_topology.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <arpa/inet.h>
+
+#define NET_SYNC_MAGIC 0x504b5359u      // "PKSY"
+#define NET_SYNC_VERSION 2
+#define NET_SYNC_MAX_PEERS 32
+#define NET_SYNC_LEADER_POLL_MS 200     // Leader wakes this often to notice shutdown
+#define NET_SYNC_STEP_SECONDS 0.5       // Offset jump that restarts the drift fit (leader rebooted)
+#define NET_SYNC_DSCP_EF 0xb8           // Expedited forwarding: keeps exchanges ahead of bulk traffic
+
+typedef enum {
+    SYNC_MSG_PING = 1,
+    SYNC_MSG_PONG
+} sync_msg_type_t;
+
+// Four-timestamp exchange plus the leader's timeline, in host layout
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t type;
+    uint32_t sequence;
+    uint32_t stream_count;
+    double t1;                   // Follower send (follower clock), echoed back
+    double t2;                   // Leader receive (leader clock)
+    double t3;                   // Leader send
+    uint32_t epoch[NET_SYNC_MAX_STREAMS];
+    double base[NET_SYNC_MAX_STREAMS];  // Leader clock time of PTS 0 (any sign: PTS may exceed uptime)
+    uint32_t anchored;                  // Bit i: base[i] is valid
+} sync_msg_t;
+
+typedef struct {
+    double offset;               // Leader minus follower
+    double delay;                // Round trip without the leader's turnaround
+    double at;                   // Follower clock, midpoint of the exchange
+} sync_sample_t;
+
+struct net_sync {
+    net_sync_role_t role;
+    int fd;
+    int port;
+    int stream_count;
+    struct sockaddr_in leader_addr;
+    pthread_t thread;
+    bool thread_started;
+    bool running;
+    pthread_mutex_t lock;
+
+    // Leader: own timeline as published. Follower: the leader's, as last received.
+    unsigned int epoch[NET_SYNC_MAX_STREAMS];
+    double base[NET_SYNC_MAX_STREAMS];
+    bool anchored[NET_SYNC_MAX_STREAMS];  // base is valid (the stream has shown a frame)
+
+    // Follower clock estimate (I/O thread writes, render thread reads; under lock)
+    sync_sample_t window[NET_SYNC_FILTER];
+    sync_sample_t history[NET_SYNC_HISTORY];
+    int history_count;
+    int history_head;
+    double fit_offset;           // Offset at fit_at
+    double fit_at;
+    double fit_drift;            // d(offset)/dt
+    double best_rtt;
+    double last_reply;
+    unsigned int samples;
+    uint32_t sequence;
+
+    // Leader: followers heard from recently
+    struct sockaddr_in peers[NET_SYNC_MAX_PEERS];
+    double peer_seen[NET_SYNC_MAX_PEERS];
+};
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static bool still_running(net_sync_t *sync) {
+    return __atomic_load_n(&sync->running, __ATOMIC_ACQUIRE);
+}
+
+static bool valid_message(const sync_msg_t *msg, ssize_t len, sync_msg_type_t type) {
+    return len == (ssize_t)sizeof(*msg) && msg->magic == NET_SYNC_MAGIC &&
+           msg->version == NET_SYNC_VERSION && msg->type == type;
+}
+
+// ---------------------------------------------------------------------------
+// Leader
+
+static void note_peer(net_sync_t *sync, const struct sockaddr_in *from, double now) {
+    int oldest = 0;
+    for (int i = 0; i < NET_SYNC_MAX_PEERS; i++) {
+        if (sync->peer_seen[i] > 0.0 && sync->peers[i].sin_addr.s_addr == from->sin_addr.s_addr &&
+            sync->peers[i].sin_port == from->sin_port) {
+            sync->peer_seen[i] = now;
+            return;
+        }
+        if (sync->peer_seen[i] < sync->peer_seen[oldest]) {
+            oldest = i;
+        }
+    }
+    char host[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &from->sin_addr, host, sizeof(host));
+    printf("[SYNC] Follower %s:%d joined\n", host, ntohs(from->sin_port));
+    sync->peers[oldest] = *from;
+    sync->peer_seen[oldest] = now;
+}
+
+static void *leader_thread(void *arg) {
+    net_sync_t *sync = (net_sync_t *)arg;
+    thread_topology_set_name("pickle-sync");
+
+    while (still_running(sync)) {
+        struct pollfd pfd = {.fd = sync->fd, .events = POLLIN};
+        if (poll(&pfd, 1, NET_SYNC_LEADER_POLL_MS) <= 0) {
+            continue;
+        }
+
+        sync_msg_t msg;
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        ssize_t len;
+        while ((len = recvfrom(sync->fd, &msg, sizeof(msg), MSG_DONTWAIT,
+                               (struct sockaddr *)&from, &from_len)) >= 0) {
+            double t2 = monotonic_seconds();
+            if (valid_message(&msg, len, SYNC_MSG_PING)) {
+                msg.type = SYNC_MSG_PONG;
+                msg.t2 = t2;
+                pthread_mutex_lock(&sync->lock);
+                note_peer(sync, &from, t2);
+                msg.stream_count = (uint32_t)sync->stream_count;
+                msg.anchored = 0;
+                for (int i = 0; i < NET_SYNC_MAX_STREAMS; i++) {
+                    msg.epoch[i] = sync->epoch[i];
+                    msg.base[i] = sync->base[i];
+                    if (sync->anchored[i]) {
+                        msg.anchored |= 1u << i;
+                    }
+                }
+                pthread_mutex_unlock(&sync->lock);
+                // Taken last so the leader's turnaround is excluded from the delay
+                msg.t3 = monotonic_seconds();
+                sendto(sync->fd, &msg, sizeof(msg), 0, (struct sockaddr *)&from, from_len);
+            }
+            from_len = sizeof(from);
+        }
+    }
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Follower
+
+// Least-squares line through the filtered offsets: drift is its slope
+static void refit(net_sync_t *sync) {
+    int n = sync->history_count;
+    double mean_at = 0.0, mean_offset = 0.0;
+    for (int i = 0; i < n; i++) {
+        mean_at += sync->history[i].at;
+        mean_offset += sync->history[i].offset;
+    }
+    mean_at /= n;
+    mean_offset /= n;
+
+    double sxx = 0.0, sxy = 0.0;
+    for (int i = 0; i < n; i++) {
+        double dx = sync->history[i].at - mean_at;
+        sxx += dx * dx;
+        sxy += dx * (sync->history[i].offset - mean_offset);
+    }
+    // Too few points or too short a span for a meaningful slope: offset only
+    sync->fit_drift = (n >= NET_SYNC_LOCK_SAMPLES && sxx > 1.0) ? sxy / sxx : 0.0;
+    sync->fit_at = mean_at;
+    sync->fit_offset = mean_offset;
+}
+
+static double offset_at(const net_sync_t *sync, double now) {
+    return sync->fit_offset + sync->fit_drift * (now - sync->fit_at);
+}
+
+static void add_sample(net_sync_t *sync, double t1, double t2, double t3, double t4) {
+    sync_sample_t sample = {
+        .offset = ((t2 - t1) + (t3 - t4)) / 2.0,
+        .delay = (t4 - t1) - (t3 - t2),
+        .at = (t1 + t4) / 2.0,
+    };
+    if (sample.delay < 0.0) {
+        sample.delay = 0.0;
+    }
+
+    sync->window[sync->samples % NET_SYNC_FILTER] = sample;
+    sync->samples++;
+    sync->last_reply = t4;
+
+    // Queueing only ever adds delay, and asymmetrically: the quickest recent
+    // exchange has the least error in its offset
+    unsigned int count = sync->samples < NET_SYNC_FILTER ? sync->samples : NET_SYNC_FILTER;
+    sync_sample_t best = sync->window[0];
+    for (unsigned int i = 1; i < count; i++) {
+        if (sync->window[i].delay < best.delay) {
+            best = sync->window[i];
+        }
+    }
+    sync->best_rtt = best.delay;
+
+    if (sync->history_count > 0 && fabs(best.offset - offset_at(sync, best.at)) > NET_SYNC_STEP_SECONDS) {
+        printf("[SYNC] Leader clock stepped by %.3fs, restarting estimate\n",
+               best.offset - offset_at(sync, best.at));
+        sync->history_count = 0;
+        sync->history_head = 0;
+    }
+
+    // One point per second keeps NET_SYNC_HISTORY seconds in the fit
+    int newest = (sync->history_head + NET_SYNC_HISTORY - 1) % NET_SYNC_HISTORY;
+    if (sync->history_count == 0 || best.at - sync->history[newest].at >= 1.0) {
+        sync->history[sync->history_head] = best;
+        sync->history_head = (sync->history_head + 1) % NET_SYNC_HISTORY;
+        if (sync->history_count < NET_SYNC_HISTORY) {
+            sync->history_count++;
+        }
+        refit(sync);
+    }
+    if (sync->samples == NET_SYNC_LOCK_SAMPLES) {
+        printf("[SYNC] Locked to leader: offset %.3fms, rtt %.3fms\n",
+               offset_at(sync, t4) * 1000.0, sync->best_rtt * 1000.0);
+    }
+}
+
+static bool follower_locked(const net_sync_t *sync, double now) {
+    return sync->samples >= NET_SYNC_LOCK_SAMPLES && now - sync->last_reply < NET_SYNC_TIMEOUT_SECONDS;
+}
+
+static void *follower_thread(void *arg) {
+    net_sync_t *sync = (net_sync_t *)arg;
+    thread_topology_set_name("pickle-sync");
+    bool was_locked = false;
+
+    while (still_running(sync)) {
+        sync_msg_t ping;
+        memset(&ping, 0, sizeof(ping));
+        ping.magic = NET_SYNC_MAGIC;
+        ping.version = NET_SYNC_VERSION;
+        ping.type = SYNC_MSG_PING;
+        ping.sequence = ++sync->sequence;
+        ping.t1 = monotonic_seconds();
+        sendto(sync->fd, &ping, sizeof(ping), 0, (struct sockaddr *)&sync->leader_addr,
+               sizeof(sync->leader_addr));
+
+        // Replies are matched by their echoed t1, so a late one still yields a valid sample
+        double deadline = ping.t1 + NET_SYNC_POLL_MS / 1000.0;
+        double now;
+        while ((now = monotonic_seconds()) < deadline && still_running(sync)) {
+            struct pollfd pfd = {.fd = sync->fd, .events = POLLIN};
+            int wait_ms = (int)((deadline - now) * 1000.0) + 1;
+            if (poll(&pfd, 1, wait_ms) <= 0) {
+                continue;
+            }
+
+            sync_msg_t pong;
+            struct sockaddr_in from;
+            socklen_t from_len = sizeof(from);
+            ssize_t len;
+            while ((len = recvfrom(sync->fd, &pong, sizeof(pong), MSG_DONTWAIT,
+                                   (struct sockaddr *)&from, &from_len)) >= 0) {
+                double t4 = monotonic_seconds();
+                from_len = sizeof(from);
+                if (!valid_message(&pong, len, SYNC_MSG_PONG) ||
+                    from.sin_addr.s_addr != sync->leader_addr.sin_addr.s_addr) {
+                    continue;
+                }
+
+                pthread_mutex_lock(&sync->lock);
+                add_sample(sync, pong.t1, pong.t2, pong.t3, t4);
+                int streams = (int)pong.stream_count < sync->stream_count ? (int)pong.stream_count
+                                                                          : sync->stream_count;
+                for (int i = 0; i < streams && i < NET_SYNC_MAX_STREAMS; i++) {
+                    sync->epoch[i] = pong.epoch[i];
+                    sync->base[i] = pong.base[i];
+                    sync->anchored[i] = (pong.anchored & (1u << i)) != 0;
+                }
+                pthread_mutex_unlock(&sync->lock);
+            }
+        }
+
+        pthread_mutex_lock(&sync->lock);
+        bool locked = follower_locked(sync, monotonic_seconds());
+        pthread_mutex_unlock(&sync->lock);
+        if (was_locked && !locked) {
+            fprintf(stderr, "[SYNC] Lost leader, free-running on the last timeline\n");
+        }
+        was_locked = locked;
+    }
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+
+net_sync_t *net_sync_start(net_sync_role_t role, const char *leader_host, int port, int stream_count) {
+    if (role == NET_SYNC_OFF || (role == NET_SYNC_FOLLOWER && !leader_host)) {
+        return NULL;
+    }
+    if (port <= 0 || port > 65535) {
+        port = NET_SYNC_DEFAULT_PORT;
+    }
+
+    net_sync_t *sync = calloc(1, sizeof(net_sync_t));
+    if (!sync) {
+        return NULL;
+    }
+    sync->role = role;
+    sync->port = port;
+    sync->stream_count = stream_count < 1 ? 1 :
+                         (stream_count > NET_SYNC_MAX_STREAMS ? NET_SYNC_MAX_STREAMS : stream_count);
+    pthread_mutex_init(&sync->lock, NULL);
+
+    sync->fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sync->fd < 0) {
+        fprintf(stderr, "[SYNC] socket() failed: %s\n", strerror(errno));
+        pthread_mutex_destroy(&sync->lock);
+        free(sync);
+        return NULL;
+    }
+    int tos = NET_SYNC_DSCP_EF;
+    setsockopt(sync->fd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+
+    if (role == NET_SYNC_LEADER) {
+        int reuse = 1;
+        setsockopt(sync->fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons((uint16_t)port);
+        if (bind(sync->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            fprintf(stderr, "[SYNC] Cannot bind UDP port %d: %s\n", port, strerror(errno));
+            net_sync_stop(sync);
+            return NULL;
+        }
+    } else {
+        char port_str[8];
+        snprintf(port_str, sizeof(port_str), "%d", port);
+        struct addrinfo hints = {.ai_family = AF_INET, .ai_socktype = SOCK_DGRAM};
+        struct addrinfo *res = NULL;
+        int ret = getaddrinfo(leader_host, port_str, &hints, &res);
+        if (ret != 0 || !res) {
+            fprintf(stderr, "[SYNC] Cannot resolve leader %s: %s\n", leader_host, gai_strerror(ret));
+            net_sync_stop(sync);
+            return NULL;
+        }
+        memcpy(&sync->leader_addr, res->ai_addr, sizeof(sync->leader_addr));
+        freeaddrinfo(res);
+    }
+
+    __atomic_store_n(&sync->running, true, __ATOMIC_RELEASE);
+    if (pthread_create(&sync->thread, NULL, role == NET_SYNC_LEADER ? leader_thread : follower_thread,
+                       sync) != 0) {
+        fprintf(stderr, "[SYNC] Failed to start sync thread\n");
+        net_sync_stop(sync);
+        return NULL;
+    }
+    sync->thread_started = true;
+
+    if (role == NET_SYNC_LEADER) {
+        printf("[SYNC] Leading on UDP port %d (%d stream(s))\n", port, sync->stream_count);
+    } else {
+        printf("[SYNC] Following %s:%d (%d stream(s))\n", leader_host, port, sync->stream_count);
+    }
+    return sync;
+}
+
+void net_sync_stop(net_sync_t *sync) {
+    if (!sync) {
+        return;
+    }
+
+    __atomic_store_n(&sync->running, false, __ATOMIC_RELEASE);
+    if (sync->thread_started) {
+        pthread_join(sync->thread, NULL);
+    }
+    if (sync->fd >= 0) {
+        close(sync->fd);
+    }
+    pthread_mutex_destroy(&sync->lock);
+    free(sync);
+}
+
+net_sync_role_t net_sync_role(const net_sync_t *sync) {
+    return sync ? sync->role : NET_SYNC_OFF;
+}
+
+void net_sync_publish(net_sync_t *sync, int stream, unsigned int epoch, double base) {
+    if (!sync || sync->role != NET_SYNC_LEADER || stream < 0 || stream >= sync->stream_count) {
+        return;
+    }
+
+    pthread_mutex_lock(&sync->lock);
+    sync->epoch[stream] = epoch;
+    sync->base[stream] = base;
+    sync->anchored[stream] = true;
+    pthread_mutex_unlock(&sync->lock);
+}
+
+bool net_sync_get_timeline(net_sync_t *sync, int stream, double now, unsigned int *epoch, double *base) {
+    if (!sync || sync->role != NET_SYNC_FOLLOWER || stream < 0 || stream >= sync->stream_count) {
+        return false;
+    }
+
+    pthread_mutex_lock(&sync->lock);
+    bool valid = follower_locked(sync, now) && sync->anchored[stream] && isfinite(sync->base[stream]);
+    if (valid) {
+        // Leader time = local time + offset
+        if (epoch) *epoch = sync->epoch[stream];
+        if (base) *base = sync->base[stream] - offset_at(sync, now);
+    }
+    pthread_mutex_unlock(&sync->lock);
+    return valid;
+}
+
+void net_sync_get_stats(net_sync_t *sync, net_sync_stats_t *out) {
+    if (!out) {
+        return;
+    }
+    memset(out, 0, sizeof(*out));
+    if (!sync) {
+        return;
+    }
+
+    double now = monotonic_seconds();
+    pthread_mutex_lock(&sync->lock);
+    out->role = sync->role;
+    if (sync->role == NET_SYNC_LEADER) {
+        out->locked = true;
+        for (int i = 0; i < NET_SYNC_MAX_PEERS; i++) {
+            if (sync->peer_seen[i] > 0.0 && now - sync->peer_seen[i] < NET_SYNC_TIMEOUT_SECONDS) {
+                out->followers++;
+            }
+        }
+    } else {
+        out->locked = follower_locked(sync, now);
+        out->offset = sync->samples > 0 ? offset_at(sync, now) : 0.0;
+        out->drift_ppm = sync->fit_drift * 1e6;
+        out->rtt = sync->best_rtt;
+        out->samples = sync->samples;
+    }
+    pthread_mutex_unlock(&sync->lock);
+}
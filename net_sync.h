@@ -0,0 +1,59 @@
+#ifndef NET_SYNC_H
+#define NET_SYNC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Frame-locked playback across several Pis (video walls, projector blends).
+// One node leads; followers estimate the leader's CLOCK_MONOTONIC over UDP
+// with PTP-style four-timestamp exchanges (offset from the lowest-delay
+// recent sample, drift from a regression over the last half minute) and
+// adopt its presentation timeline, converted onto their own clock. Every node
+// then maps a given PTS onto the same instant and presents it on its next
+// vblank - within half a refresh period of each other, or exactly the same
+// vblank when the displays are genlocked.
+//
+// The wire format is the host's struct layout: all nodes must run the same build.
+#define NET_SYNC_DEFAULT_PORT 7878        // PICKLE_SYNC_PORT
+#define NET_SYNC_MAX_STREAMS 4
+#define NET_SYNC_POLL_MS 100              // Follower exchange interval
+#define NET_SYNC_FILTER 8                 // Samples the lowest-delay pick is taken from
+#define NET_SYNC_HISTORY 32               // Filtered offsets (one per second) in the drift fit
+#define NET_SYNC_LOCK_SAMPLES 4           // Exchanges before the estimate is trusted
+#define NET_SYNC_TIMEOUT_SECONDS 2.0      // Without a reply for this long the follower free-runs
+#define NET_SYNC_START_DELAY_MS 1000      // Leader schedules its first frame this far ahead (PICKLE_SYNC_START_MS)
+
+typedef enum {
+    NET_SYNC_OFF = 0,
+    NET_SYNC_LEADER,
+    NET_SYNC_FOLLOWER
+} net_sync_role_t;
+
+typedef struct {
+    net_sync_role_t role;
+    bool locked;                  // Follower: estimate is current; leader: always true
+    double offset;                // Leader clock minus local clock, seconds (at the time of the call)
+    double drift_ppm;             // Leader clock rate relative to ours
+    double rtt;                   // Lowest round trip in the filter window, seconds
+    unsigned int samples;         // Exchanges completed
+    int followers;                // Leader: nodes heard from in the last NET_SYNC_TIMEOUT_SECONDS
+} net_sync_stats_t;
+
+typedef struct net_sync net_sync_t;
+
+// Leader binds port on all interfaces; a follower sends to leader_host:port.
+// stream_count streams are published/followed. NULL on failure.
+net_sync_t *net_sync_start(net_sync_role_t role, const char *leader_host, int port, int stream_count);
+void net_sync_stop(net_sync_t *sync);
+net_sync_role_t net_sync_role(const net_sync_t *sync);
+
+// Leader: publish a stream's timeline (see frame_sched_get_timeline), local clock
+void net_sync_publish(net_sync_t *sync, int stream, unsigned int epoch, double base);
+
+// Follower: the leader's latest timeline for stream, converted to the local
+// clock at now. False until locked and a timeline was received.
+bool net_sync_get_timeline(net_sync_t *sync, int stream, double now, unsigned int *epoch, double *base);
+
+void net_sync_get_stats(net_sync_t *sync, net_sync_stats_t *out);
+
+#endif // NET_SYNC_H
@@ -1,4 +1,5 @@
 #include "video_player.h"
+#include "playlist.h"
 #include "input_handler.h"
 #include "version.h"
 #include <stdio.h>
@@ -11,6 +12,10 @@
 // Global app context for signal handlers
 static app_context_t *g_app = NULL;
 
+// --playlist / --playlist-socket (the control socket is unlinked at exit)
+static playlist_t g_playlist;
+static bool g_playlist_enabled = false;
+
 // PRODUCTION: Global quit flag for async-signal-safe shutdown
 // Set by signal handler, checked in main loop
 volatile sig_atomic_t g_quit_requested = 0;
@@ -37,6 +42,10 @@ static void cleanup_on_exit(void) {
         app_cleanup(g_app);
         g_app = NULL;
     }
+    if (g_playlist_enabled) {
+        playlist_cleanup(&g_playlist);
+        g_playlist_enabled = false;
+    }
     
     if (g_quit_requested) {
         printf("Exiting after signal\n");
@@ -68,8 +77,14 @@ int main(int argc, char *argv[]) {
     bool debug_gamepad = false;
     bool advanced_diagnostics = false;
     bool enable_hardware_decode = false;  // Changed: now defaults to software
-    char *video_file = NULL;
-    char *video_file2 = NULL;
+    bool scanout_overlay = false;         // --scanout overlay: video on KMS plane instead of GL
+    int live_latency_ms = 0;              // --live: receive-to-glass target, 0 = file playback
+    net_sync_role_t sync_role = NET_SYNC_OFF;
+    const char *sync_leader = NULL;       // --sync-follow: leader host
+    const char *video_files[MAX_VIDEO_STREAMS] = {NULL};
+    int video_count = 0;
+    const char *playlist_file = NULL;
+    const char *playlist_socket = NULL;
 
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -85,24 +100,77 @@ int main(int argc, char *argv[]) {
         } else if (strcmp(argv[i], "--hw") == 0) {
             enable_hardware_decode = true;
             printf("Hardware decode enabled (--hw flag set)\n");
+        } else if (strcmp(argv[i], "--scanout") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "--scanout requires a mode (gl or overlay)\n");
+                return 1;
+            }
+            const char *mode = argv[++i];
+            if (strcmp(mode, "overlay") == 0) {
+                scanout_overlay = true;
+                printf("Overlay scanout enabled (--scanout overlay)\n");
+            } else if (strcmp(mode, "gl") == 0) {
+                scanout_overlay = false;
+            } else {
+                fprintf(stderr, "Unknown scanout mode: %s (expected gl or overlay)\n", mode);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--live") == 0) {
+            if (live_latency_ms == 0) {
+                live_latency_ms = LIVE_DEFAULT_LATENCY_MS;
+            }
+        } else if (strcmp(argv[i], "--live-latency") == 0) {
+            if (i + 1 >= argc || atoi(argv[i + 1]) <= 0) {
+                fprintf(stderr, "--live-latency requires a latency in milliseconds\n");
+                return 1;
+            }
+            live_latency_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sync-leader") == 0) {
+            sync_role = NET_SYNC_LEADER;
+        } else if (strcmp(argv[i], "--sync-follow") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "--sync-follow requires the leader's host name or address\n");
+                return 1;
+            }
+            sync_role = NET_SYNC_FOLLOWER;
+            sync_leader = argv[++i];
+        } else if (strcmp(argv[i], "--playlist") == 0 || strcmp(argv[i], "--playlist-socket") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "%s requires a path\n", argv[i]);
+                return 1;
+            }
+            if (strcmp(argv[i], "--playlist") == 0) {
+                playlist_file = argv[++i];
+            } else {
+                playlist_socket = argv[++i];
+            }
         } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--version") == 0) {
             printf("%s\n", VERSION_FULL);
             printf("Semantic versioning: %d.%d.%d\n", VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH);
             printf("\nFeatures:\n");
-            printf("  - Dual video playback with independent keystone correction\n");
+            printf("  - Up to %d composited videos with independent keystone correction\n", MAX_VIDEO_STREAMS);
             printf("  - Hardware-accelerated decode (--hw flag)\n");
             printf("  - DRM/KMS direct scanout with OpenGL ES 3.1\n");
             printf("  - Gamepad and keyboard input support\n");
             printf("  - Real-time performance profiling (--timing flag)\n");
             return 0;
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-            fprintf(stderr, "Usage: %s [options] <video_file1.mp4> [video_file2.mp4]\n", argv[0]);
+            fprintf(stderr, "Usage: %s [options] <video_file1.mp4> [video_file2.mp4 ...]\n", argv[0]);
+            fprintf(stderr, "       Up to %d videos, each with its own keystone\n", MAX_VIDEO_STREAMS);
             fprintf(stderr, "\nOptions:\n");
-            fprintf(stderr, "  -l               Loop video playback\n");
+            fprintf(stderr, "  -l               Loop video playback (gapless; PICKLE_NO_GAPLESS=1 seeks instead)\n");
             fprintf(stderr, "  --timing         Show frame timing information\n");
             fprintf(stderr, "  --debug-gamepad  Log gamepad button presses\n");
             fprintf(stderr, "  --hw-debug       Enable detailed hardware decoder diagnostics\n");
             fprintf(stderr, "  --hw             Enable hardware decode (default: software)\n");
+            fprintf(stderr, "  --scanout MODE   Video composition: gl (default) or overlay (KMS plane, needs --hw)\n");
+            fprintf(stderr, "  --live           Low-latency mode for RTSP/SRT/UDP camera feeds (no looping)\n");
+            fprintf(stderr, "  --live-latency MS  Live latency target, stale frames are dropped (default %d, implies --live)\n",
+                    LIVE_DEFAULT_LATENCY_MS);
+            fprintf(stderr, "  --sync-leader    Lead a frame-locked group of nodes (UDP, PICKLE_SYNC_PORT)\n");
+            fprintf(stderr, "  --sync-follow HOST  Present in lockstep with the leader at HOST\n");
+            fprintf(stderr, "  --playlist FILE  Play FILE's items (one path per line) as video 1; -l loops the list\n");
+            fprintf(stderr, "  --playlist-socket PATH  UNIX datagram control socket: \"add <file>\", \"next\", \"seek <s>\"\n");
             fprintf(stderr, "  -v, --version    Show version information\n");
             fprintf(stderr, "  -h, --help       Show this help message\n");
             fprintf(stderr, "\nKeyboard Controls:\n");
@@ -110,6 +178,7 @@ int main(int argc, char *argv[]) {
             fprintf(stderr, "  h        Toggle help overlay\n");
             fprintf(stderr, "  1-4      Select keystone corners (video 1)\n");
             fprintf(stderr, "  5-8      Select keystone corners (video 2)\n");
+            fprintf(stderr, "  TAB      Edit the next video's keystone (videos 3-4)\n");
             fprintf(stderr, "  arrows   Move selected corner\n");
             fprintf(stderr, "  r        Reset keystone\n");
             fprintf(stderr, "  s        Save keystone settings\n");
@@ -126,12 +195,10 @@ int main(int argc, char *argv[]) {
             fprintf(stderr, "  START+SELECT (2s)  Quit\n");
             return 0;
         } else if (argv[i][0] != '-') {
-            if (!video_file) {
-                video_file = argv[i];
-            } else if (!video_file2) {
-                video_file2 = argv[i];
+            if (video_count < MAX_VIDEO_STREAMS) {
+                video_files[video_count++] = argv[i];
             } else {
-                fprintf(stderr, "Too many video files specified\n");
+                fprintf(stderr, "Too many video files specified (max %d)\n", MAX_VIDEO_STREAMS);
                 return 1;
             }
         } else {
@@ -141,9 +208,34 @@ int main(int argc, char *argv[]) {
         }
     }
     
-    if (!video_file) {
+    // Playlist items play as video 1; positional files become the other streams.
+    // A control socket without a list file starts from the first positional file.
+    if (playlist_file || playlist_socket) {
+        playlist_init(&g_playlist, loop_playback);
+        g_playlist_enabled = true;
+        if (playlist_file) {
+            if (playlist_load(&g_playlist, playlist_file) != 0) {
+                fprintf(stderr, "Error: Playlist %s has no items\n", playlist_file);
+                return 1;
+            }
+            if (video_count >= MAX_VIDEO_STREAMS) {
+                fprintf(stderr, "Too many video files specified (max %d with a playlist)\n", MAX_VIDEO_STREAMS - 1);
+                return 1;
+            }
+            memmove(&video_files[1], &video_files[0], (size_t)video_count * sizeof(video_files[0]));
+            video_count++;
+        } else if (video_count > 0) {
+            playlist_add(&g_playlist, video_files[0]);
+        }
+        if (playlist_socket && playlist_open_control(&g_playlist, playlist_socket) != 0) {
+            return 1;
+        }
+        video_files[0] = playlist_first(&g_playlist);
+    }
+
+    if (video_count == 0) {
         fprintf(stderr, "Error: No video file specified\n");
-        fprintf(stderr, "Usage: %s [options] <video_file1.mp4> [video_file2.mp4]\n", argv[0]);
+        fprintf(stderr, "Usage: %s [options] <video_file1.mp4> [video_file2.mp4 ...]\n", argv[0]);
         fprintf(stderr, "Use -h or --help for more information\n");
         return 1;
     }
@@ -161,12 +253,20 @@ int main(int argc, char *argv[]) {
     setup_signal_handlers();
     
     // Initialize and run the video player
-    if (app_init(&app, video_file, video_file2, loop_playback, show_timing, debug_gamepad, advanced_diagnostics, enable_hardware_decode) != 0) {
+    if (app_init(&app, video_files, video_count, loop_playback, show_timing, debug_gamepad, advanced_diagnostics, enable_hardware_decode, scanout_overlay,
+                 live_latency_ms, g_playlist_enabled ? &g_playlist : NULL) != 0) {
         fprintf(stderr, "Failed to initialize application\n");
         g_app = NULL;  // Clear global reference
         return 1;
     }
     
+    if (app_enable_sync(&app, sync_role, sync_leader) != 0) {
+        fprintf(stderr, "Failed to join the sync group\n");
+        app_cleanup(&app);
+        g_app = NULL;
+        return 1;
+    }
+    
     printf("Starting main application loop...\n");
     fflush(stdout);
     
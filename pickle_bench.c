@@ -0,0 +1,646 @@
+// pickle-bench: fixed decode/render scenarios with reproducible JSON reports.
+//
+// Drives the decoder, GL renderer and KMS plane directly (no app_run loop, no
+// input, no scheduler) so every scenario measures the same work per frame:
+//   decode  - video_decode_frame() for all streams
+//   upload  - CPU time of the gl_render_* calls (texture upload + draw submission)
+//   draw    - glFinish() after submission, i.e. GPU time not hidden by the CPU
+//   swap    - gl_swap_buffers() (eglSwapBuffers + KMS page flip)
+// A vblank miss is an iteration that overran the refresh period by more than
+// half a period; each extra period counts as one missed vblank.
+
+#define _GNU_SOURCE
+#include "drm_display.h"
+#include "gl_context.h"
+#include "video_decoder.h"
+#include "keystone.h"
+#include "version.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <signal.h>
+#include <time.h>
+#include <math.h>
+
+#define BENCH_DEFAULT_FRAMES 300
+#define BENCH_WARMUP_FRAMES 10          // Texture allocation / decoder priming, excluded from stats
+#define BENCH_MAX_DECODE_RETRIES 100    // Consecutive decode failures before a scenario aborts
+#define BENCH_OVERLAY_HOLD 3            // Frames a scanned-out buffer stays referenced
+
+typedef enum {
+    BENCH_RES_720P = 0,
+    BENCH_RES_1080P,
+    BENCH_RES_4K,
+    BENCH_RES_COUNT
+} bench_res_t;
+
+typedef enum {
+    BENCH_PATH_YUV420P = 0,   // SW decode, three-plane texture upload
+    BENCH_PATH_NV12,          // HW decode, CPU transfer, NV12 upload
+    BENCH_PATH_EXTERNAL,      // HW decode, DMA-BUF EGLImage external texture
+    BENCH_PATH_OVERLAY,       // HW decode, DMA-BUF scanned out on the KMS video plane
+    BENCH_PATH_COUNT
+} bench_path_t;
+
+static const char *bench_res_names[BENCH_RES_COUNT] = { "720p", "1080p", "4k" };
+static const char *bench_path_names[BENCH_PATH_COUNT] = { "yuv420p", "nv12", "external", "overlay" };
+
+typedef enum {
+    BENCH_METRIC_DECODE = 0,
+    BENCH_METRIC_UPLOAD,
+    BENCH_METRIC_DRAW,
+    BENCH_METRIC_SWAP,
+    BENCH_METRIC_FRAME,
+    BENCH_METRIC_COUNT
+} bench_metric_t;
+
+static const char *bench_metric_names[BENCH_METRIC_COUNT] = { "decode", "upload", "draw", "swap", "frame" };
+
+typedef struct {
+    bench_res_t res;
+    bool hw_decode;
+    int streams;
+    bench_path_t path;
+    bool warped;
+} bench_scenario_t;
+
+typedef struct {
+    bench_scenario_t scenario;
+    const char *skip_reason;            // Non-NULL: scenario did not run
+    int width, height;
+    int frames;                         // Measured frames (after warmup)
+    double wall_seconds;
+    double *samples[BENCH_METRIC_COUNT];  // Milliseconds, one per measured frame
+    unsigned int vblank_misses;
+} bench_result_t;
+
+typedef struct {
+    display_ctx_t *drm;
+    gl_context_t *gl;
+    const char *clips[BENCH_RES_COUNT];
+    int frames;
+    bool offscreen;
+    bool overlay_available;
+} bench_t;
+
+static volatile sig_atomic_t g_bench_stop = 0;
+
+static void bench_signal_handler(int sig) {
+    (void)sig;
+    g_bench_stop = 1;
+}
+
+static double bench_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+// Nearest-rank percentile over a sorted array
+static double percentile(const double *sorted, int count, double p) {
+    if (count <= 0) return 0.0;
+    int rank = (int)ceil(p / 100.0 * (double)count);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+static void scenario_name(const bench_scenario_t *s, char *buf, size_t size) {
+    snprintf(buf, size, "%s-%s-%dx-%s-%s", bench_res_names[s->res], s->hw_decode ? "hw" : "sw",
+             s->streams, bench_path_names[s->path], s->warped ? "warped" : "identity");
+}
+
+// Stream 0 fills the screen, stream 1 is a picture-in-picture in the lower right.
+// Warped pulls the top edge in like a projector tilted upwards.
+static void setup_keystone(keystone_context_t *keystone, bool warped, int stream_index) {
+    keystone_init(keystone);
+    keystone->show_corners = false;
+    keystone->show_border = false;
+    keystone->show_help = false;
+
+    keystone_reset_corners(keystone);
+    if (stream_index > 0) {
+        for (int i = 0; i < 4; i++) {
+            keystone->corners[i].x = keystone->corners[i].x * 0.35f + 0.55f;
+            keystone->corners[i].y = keystone->corners[i].y * 0.35f - 0.55f;
+        }
+    }
+
+    if (warped) {
+        keystone->corners[0].x += 0.15f;
+        keystone->corners[1].x -= 0.15f;
+        keystone->corners[0].y -= 0.05f;
+        keystone->corners[1].y -= 0.05f;
+    }
+    keystone->matrix_dirty = true;
+    keystone->corners_dirty = true;
+    keystone_calculate_matrix(keystone);
+}
+
+static int open_stream(video_context_t *video, const char *file, bool hw_decode, bool skip_sw_transfer) {
+    if (video_init(video, file, false, hw_decode) != 0) {
+        return -1;
+    }
+    if (video->use_hardware_decode) {
+        video->skip_sw_transfer = skip_sw_transfer;
+    }
+    video_set_loop(video, true);  // Short clips still reach the requested frame count
+    return 0;
+}
+
+static int decode_with_retry(video_context_t *video) {
+    for (int attempt = 0; attempt < BENCH_MAX_DECODE_RETRIES; attempt++) {
+        if (video_decode_frame(video) == 0) {
+            return 0;
+        }
+        if (video_is_eof(video)) {
+            video_seek(video, 0);
+        }
+    }
+    return -1;
+}
+
+// Mirrors the player's scanout path: import the DMA-BUF as a KMS FB and put it on the plane
+static int present_overlay(bench_t *bench, video_context_t *video, keystone_context_t *keystone,
+                           int width, int height, video_dma_frame_t hold[BENCH_OVERLAY_HOLD],
+                           int *hold_head, unsigned int *pool_generation) {
+    video_dma_frame_t handle;
+    if (video_dma_frame_acquire(video, &handle) != 0) {
+        return -1;
+    }
+
+    unsigned int generation = video_get_dma_pool_generation(video);
+    if (generation != *pool_generation) {
+        drm_flush_video_fb_cache(bench->drm);
+        *pool_generation = generation;
+    }
+
+    uint32_t fb_id = 0;
+    if (drm_create_video_fb(bench->drm, handle.dma_fd, (uint32_t)width, (uint32_t)height,
+                            handle.plane_offset, handle.plane_pitch,
+                            handle.drm_format, handle.modifier, &fb_id) != 0) {
+        video_dma_frame_release(&handle);
+        return -1;
+    }
+
+    float left, top, right, bottom;
+    if (!keystone_get_axis_aligned_rect(keystone, 0.001f, &left, &top, &right, &bottom)) {
+        video_dma_frame_release(&handle);
+        return -1;
+    }
+    float disp_w = (float)bench->drm->mode.hdisplay;
+    float disp_h = (float)bench->drm->mode.vdisplay;
+    uint32_t x = (uint32_t)((left + 1.0f) * 0.5f * disp_w + 0.5f);
+    uint32_t y = (uint32_t)((1.0f - top) * 0.5f * disp_h + 0.5f);
+    uint32_t w = (uint32_t)((right - left) * 0.5f * disp_w + 0.5f);
+    uint32_t h = (uint32_t)((top - bottom) * 0.5f * disp_h + 0.5f);
+    if (w == 0 || h == 0 ||
+        drm_display_video_frame_scaled(bench->drm, fb_id, (uint32_t)width, (uint32_t)height,
+                                       x, y, w, h) != 0) {
+        video_dma_frame_release(&handle);
+        return -1;
+    }
+
+    video_dma_frame_release(&hold[*hold_head]);
+    hold[*hold_head] = handle;
+    *hold_head = (*hold_head + 1) % BENCH_OVERLAY_HOLD;
+    return 0;
+}
+
+static int render_primary(bench_t *bench, const bench_scenario_t *s, video_context_t *video,
+                          keystone_context_t *keystone, int width, int height) {
+    switch (s->path) {
+    case BENCH_PATH_YUV420P: {
+        uint8_t *y = NULL, *u = NULL, *v = NULL;
+        int y_stride = 0, u_stride = 0, v_stride = 0;
+        video_get_yuv_data(video, &y, &u, &v, &y_stride, &u_stride, &v_stride);
+        if (!y || !u || !v) return -1;
+        gl_render_frame(bench->gl, y, u, v, width, height, y_stride, u_stride, v_stride,
+                        bench->drm, keystone, true, 0);
+        return 0;
+    }
+    case BENCH_PATH_NV12: {
+        uint8_t *nv12 = video_get_nv12_data(video);
+        if (!nv12) return -1;
+        gl_render_nv12(bench->gl, nv12, width, height, video_get_nv12_stride(video),
+                       bench->drm, keystone, true, 0);
+        return 0;
+    }
+    case BENCH_PATH_EXTERNAL: {
+        int dma_fd = video_get_dma_fd(video);
+        if (dma_fd < 0) return -1;
+        int offsets[3], pitches[3];
+        uint32_t drm_format;
+        uint64_t modifier;
+        video_get_dma_plane_layout(video, offsets, pitches);
+        video_get_dma_format(video, &drm_format, &modifier);
+        gl_render_frame_external(bench->gl, dma_fd, width, height, offsets, pitches,
+                                 drm_format, modifier, bench->drm, keystone, true, 0);
+        return 0;
+    }
+    default:
+        return -1;
+    }
+}
+
+static void run_scenario(bench_t *bench, bench_result_t *result) {
+    const bench_scenario_t *s = &result->scenario;
+    const char *file = bench->clips[s->res];
+
+    if (!file) {
+        result->skip_reason = "no clip for this resolution";
+        return;
+    }
+    if (s->path == BENCH_PATH_OVERLAY && (!bench->overlay_available || bench->offscreen)) {
+        result->skip_reason = "KMS video plane unavailable";
+        return;
+    }
+    if (s->path == BENCH_PATH_OVERLAY && s->warped) {
+        result->skip_reason = "plane scaler cannot warp";
+        return;
+    }
+    if (s->path == BENCH_PATH_EXTERNAL && !bench->gl->supports_external_texture) {
+        result->skip_reason = "GL_OES_EGL_image_external unsupported";
+        return;
+    }
+
+    video_context_t *videos[2] = { NULL, NULL };
+    keystone_context_t keystones[2];
+    video_dma_frame_t overlay_hold[BENCH_OVERLAY_HOLD];
+    int overlay_head = 0;
+    unsigned int overlay_generation = 0;
+    memset(overlay_hold, 0, sizeof(overlay_hold));
+    for (int i = 0; i < BENCH_OVERLAY_HOLD; i++) {
+        overlay_hold[i].dma_fd = -1;
+    }
+
+    bool zero_copy = (s->path == BENCH_PATH_EXTERNAL || s->path == BENCH_PATH_OVERLAY);
+    for (int i = 0; i < s->streams; i++) {
+        videos[i] = calloc(1, sizeof(video_context_t));
+        if (!videos[i]) {
+            result->skip_reason = "out of memory";
+            goto done;
+        }
+        // Extra streams are software decoded, as in the player
+        bool hw = (i == 0) && s->hw_decode;
+        if (open_stream(videos[i], file, hw, i == 0 && zero_copy) != 0) {
+            free(videos[i]);
+            videos[i] = NULL;
+            result->skip_reason = "failed to open clip";
+            goto done;
+        }
+        setup_keystone(&keystones[i], s->warped, i);
+    }
+    if (s->hw_decode && !video_is_hardware_decoded(videos[0])) {
+        result->skip_reason = "hardware decode unavailable";
+        goto done;
+    }
+
+    video_get_dimensions(videos[0], &result->width, &result->height);
+
+    int total = bench->frames + BENCH_WARMUP_FRAMES;
+    for (int m = 0; m < BENCH_METRIC_COUNT; m++) {
+        result->samples[m] = calloc((size_t)bench->frames, sizeof(double));
+        if (!result->samples[m]) {
+            result->skip_reason = "out of memory";
+            goto done;
+        }
+    }
+
+    double refresh_ms = 1000.0 / (double)(bench->drm->refresh_rate ? bench->drm->refresh_rate : 60);
+    double wall_start = 0.0;
+
+    for (int frame = 0; frame < total && !g_bench_stop; frame++) {
+        double t0 = bench_now_ms();
+        for (int i = 0; i < s->streams; i++) {
+            if (decode_with_retry(videos[i]) != 0) {
+                result->skip_reason = "decode failed";
+                goto done;
+            }
+        }
+
+        double t1 = bench_now_ms();
+        int ret;
+        if (s->path == BENCH_PATH_OVERLAY) {
+            ret = present_overlay(bench, videos[0], &keystones[0], result->width, result->height,
+                                  overlay_hold, &overlay_head, &overlay_generation);
+            if (ret == 0) {
+                glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
+        } else {
+            ret = render_primary(bench, s, videos[0], &keystones[0], result->width, result->height);
+        }
+        if (ret != 0) {
+            result->skip_reason = "render path rejected frame";
+            goto done;
+        }
+        for (int i = 1; i < s->streams; i++) {
+            uint8_t *y = NULL, *u = NULL, *v = NULL;
+            int y_stride = 0, u_stride = 0, v_stride = 0;
+            video_get_yuv_data(videos[i], &y, &u, &v, &y_stride, &u_stride, &v_stride);
+            if (!y || !u || !v) {
+                result->skip_reason = "render path rejected frame";
+                goto done;
+            }
+            gl_render_frame(bench->gl, y, u, v, videos[i]->width, videos[i]->height,
+                            y_stride, u_stride, v_stride, bench->drm, &keystones[i], false, i);
+        }
+
+        double t2 = bench_now_ms();
+        glFinish();
+        double t3 = bench_now_ms();
+        gl_swap_buffers(bench->gl, bench->drm);
+        double t4 = bench_now_ms();
+
+        if (frame < BENCH_WARMUP_FRAMES) {
+            wall_start = t4;
+            continue;
+        }
+
+        int n = result->frames++;
+        result->samples[BENCH_METRIC_DECODE][n] = t1 - t0;
+        result->samples[BENCH_METRIC_UPLOAD][n] = t2 - t1;
+        result->samples[BENCH_METRIC_DRAW][n] = t3 - t2;
+        result->samples[BENCH_METRIC_SWAP][n] = t4 - t3;
+        result->samples[BENCH_METRIC_FRAME][n] = t4 - t0;
+        if (t4 - t0 > refresh_ms * 1.5) {
+            result->vblank_misses += (unsigned int)floor((t4 - t0) / refresh_ms + 0.5) - 1;
+        }
+        result->wall_seconds = (t4 - wall_start) / 1000.0;
+    }
+
+done:
+    for (int i = 0; i < BENCH_OVERLAY_HOLD; i++) {
+        video_dma_frame_release(&overlay_hold[i]);
+    }
+    if (s->path == BENCH_PATH_OVERLAY) {
+        drm_clear_video_plane(bench->drm);
+        drm_flush_video_fb_cache(bench->drm);
+    }
+    // The next scenario's decoder hands out new DMA-BUFs, possibly with recycled fds
+    for (int i = 0; i < GL_MAX_STREAMS; i++) {
+        gl_invalidate_external_cache(bench->gl, i);
+    }
+    for (int i = 0; i < 2; i++) {
+        if (videos[i]) {
+            video_cleanup(videos[i]);
+            free(videos[i]);
+            keystone_cleanup(&keystones[i]);
+        }
+    }
+}
+
+static void json_write_string(FILE *out, const char *str) {
+    fputc('"', out);
+    for (const char *p = str; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', out);
+            fputc(*p, out);
+        } else if ((unsigned char)*p < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned char)*p);
+        } else {
+            fputc(*p, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void write_report(FILE *out, const bench_t *bench, bench_result_t *results, int count) {
+    fprintf(out, "{\n  \"version\": ");
+    json_write_string(out, VERSION_FULL);
+    fprintf(out, ",\n  \"display\": { \"width\": %u, \"height\": %u, \"refresh_hz\": %u, \"offscreen\": %s },\n",
+            bench->drm->width, bench->drm->height, bench->drm->refresh_rate,
+            bench->offscreen ? "true" : "false");
+    fprintf(out, "  \"frames_per_scenario\": %d,\n  \"warmup_frames\": %d,\n",
+            bench->frames, BENCH_WARMUP_FRAMES);
+    fprintf(out, "  \"clips\": {");
+    bool first_clip = true;
+    for (int r = 0; r < BENCH_RES_COUNT; r++) {
+        if (!bench->clips[r]) continue;
+        fprintf(out, "%s \"%s\": ", first_clip ? "" : ",", bench_res_names[r]);
+        json_write_string(out, bench->clips[r]);
+        first_clip = false;
+    }
+    fprintf(out, " },\n  \"scenarios\": [\n");
+
+    for (int i = 0; i < count; i++) {
+        bench_result_t *r = &results[i];
+        const bench_scenario_t *s = &r->scenario;
+        char name[96];
+        scenario_name(s, name, sizeof(name));
+
+        fprintf(out, "    { \"name\": \"%s\", \"resolution\": \"%s\", \"decode\": \"%s\", "
+                "\"streams\": %d, \"path\": \"%s\", \"keystone\": \"%s\"",
+                name, bench_res_names[s->res], s->hw_decode ? "hw" : "sw", s->streams,
+                bench_path_names[s->path], s->warped ? "warped" : "identity");
+
+        if (r->frames == 0) {
+            fprintf(out, ", \"skipped\": ");
+            json_write_string(out, r->skip_reason ? r->skip_reason : "interrupted");
+            fprintf(out, " }%s\n", i + 1 < count ? "," : "");
+            continue;
+        }
+
+        if (r->skip_reason) {
+            // Aborted part way: the stats below cover the frames that did run
+            fprintf(out, ", \"aborted\": ");
+            json_write_string(out, r->skip_reason);
+        }
+        fprintf(out, ",\n      \"width\": %d, \"height\": %d, \"frames\": %d, \"fps\": %.2f, \"vblank_misses\": %u",
+                r->width, r->height, r->frames,
+                r->wall_seconds > 0.0 ? (double)r->frames / r->wall_seconds : 0.0, r->vblank_misses);
+        for (int m = 0; m < BENCH_METRIC_COUNT; m++) {
+            double *v = r->samples[m];
+            qsort(v, (size_t)r->frames, sizeof(double), compare_double);
+            fprintf(out, ",\n      \"%s_ms\": { \"p50\": %.3f, \"p99\": %.3f, \"max\": %.3f }",
+                    bench_metric_names[m], percentile(v, r->frames, 50.0),
+                    percentile(v, r->frames, 99.0), v[r->frames - 1]);
+        }
+        fprintf(out, " }%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [options] --clip RES=FILE [--clip RES=FILE ...]\n\n", prog);
+    printf("Runs every decode/render scenario for each clip and writes a JSON report.\n\n");
+    printf("Options:\n");
+    printf("  --clip RES=FILE      Clip for resolution class RES (720p, 1080p, 4k)\n");
+    printf("  --frames N           Measured frames per scenario (default %d)\n", BENCH_DEFAULT_FRAMES);
+    printf("  --offscreen[=WxH]    Render to a GBM surface without modesetting (default 1920x1080)\n");
+    printf("  --json FILE          Write the report to FILE (default: stdout)\n");
+    printf("  --only SUBSTRING     Run only scenarios whose name contains SUBSTRING\n");
+    printf("  -h, --help           Show this help\n\n");
+    printf("Scenario names: RES-{sw|hw}-{1|2}x-{yuv420p|nv12|external|overlay}-{identity|warped}\n");
+}
+
+static int parse_clip(bench_t *bench, const char *arg) {
+    const char *eq = strchr(arg, '=');
+    if (!eq || !eq[1]) return -1;
+    for (int r = 0; r < BENCH_RES_COUNT; r++) {
+        size_t len = strlen(bench_res_names[r]);
+        if ((size_t)(eq - arg) == len && strncasecmp(arg, bench_res_names[r], len) == 0) {
+            bench->clips[r] = eq + 1;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    bench_t bench;
+    memset(&bench, 0, sizeof(bench));
+    bench.frames = BENCH_DEFAULT_FRAMES;
+    const char *json_path = NULL;
+    const char *only = NULL;
+    unsigned int offscreen_w = 0, offscreen_h = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (strcmp(arg, "--clip") == 0 && i + 1 < argc) {
+            if (parse_clip(&bench, argv[++i]) != 0) {
+                fprintf(stderr, "Invalid --clip '%s' (expected 720p=FILE, 1080p=FILE or 4k=FILE)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(arg, "--frames") == 0 && i + 1 < argc) {
+            bench.frames = atoi(argv[++i]);
+            if (bench.frames <= 0) {
+                fprintf(stderr, "Invalid --frames value\n");
+                return 1;
+            }
+        } else if (strncmp(arg, "--offscreen", 11) == 0) {
+            bench.offscreen = true;
+            if (arg[11] == '=' && sscanf(arg + 12, "%ux%u", &offscreen_w, &offscreen_h) != 2) {
+                fprintf(stderr, "Invalid --offscreen size '%s' (expected WxH)\n", arg + 12);
+                return 1;
+            }
+        } else if (strcmp(arg, "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(arg, "--only") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown option: %s\n\n", arg);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    bool have_clip = false;
+    for (int r = 0; r < BENCH_RES_COUNT; r++) {
+        have_clip = have_clip || bench.clips[r];
+    }
+    if (!have_clip) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    signal(SIGINT, bench_signal_handler);
+    signal(SIGTERM, bench_signal_handler);
+
+    bench.drm = calloc(1, sizeof(display_ctx_t));
+    bench.gl = calloc(1, sizeof(gl_context_t));
+    if (!bench.drm || !bench.gl) {
+        fprintf(stderr, "Failed to allocate contexts\n");
+        return 1;
+    }
+
+    bench.drm->headless = bench.offscreen;
+    bench.drm->headless_width = offscreen_w;
+    bench.drm->headless_height = offscreen_h;
+    if (drm_init(bench.drm) != 0) {
+        fprintf(stderr, "[BENCH] Display init failed%s\n", bench.offscreen ? "" : " (try --offscreen)");
+        free(bench.gl);
+        free(bench.drm);
+        return 1;
+    }
+    bench.overlay_available = (drm_init_video_plane(bench.drm) == 0);
+    if (gl_init(bench.gl, bench.drm) != 0) {
+        fprintf(stderr, "[BENCH] OpenGL init failed\n");
+        drm_cleanup(bench.drm);
+        free(bench.gl);
+        free(bench.drm);
+        return 1;
+    }
+    gl_setup_buffers(bench.gl);
+
+    // Fixed order so reports from different builds line up scenario by scenario
+    bench_result_t *results = calloc(BENCH_RES_COUNT * BENCH_PATH_COUNT * 2 * 2, sizeof(bench_result_t));
+    if (!results) {
+        fprintf(stderr, "Failed to allocate results\n");
+        gl_cleanup(bench.gl);
+        drm_cleanup(bench.drm);
+        return 1;
+    }
+    int count = 0;
+    for (int r = 0; r < BENCH_RES_COUNT; r++) {
+        for (int p = 0; p < BENCH_PATH_COUNT; p++) {
+            for (int streams = 1; streams <= 2; streams++) {
+                for (int warped = 0; warped <= 1; warped++) {
+                    bench_scenario_t s = {
+                        .res = (bench_res_t)r,
+                        .hw_decode = (p != BENCH_PATH_YUV420P),
+                        .streams = streams,
+                        .path = (bench_path_t)p,
+                        .warped = warped,
+                    };
+                    char name[96];
+                    scenario_name(&s, name, sizeof(name));
+                    if (only && !strstr(name, only)) continue;
+                    results[count++].scenario = s;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < count && !g_bench_stop; i++) {
+        char name[96];
+        scenario_name(&results[i].scenario, name, sizeof(name));
+        fprintf(stderr, "[BENCH] %2d/%d %-36s ", i + 1, count, name);
+        run_scenario(&bench, &results[i]);
+        if (results[i].frames > 0) {
+            fprintf(stderr, "%d frames in %.2fs, %u vblank misses%s\n", results[i].frames,
+                    results[i].wall_seconds, results[i].vblank_misses,
+                    results[i].skip_reason ? " (aborted)" : "");
+        } else {
+            fprintf(stderr, "skipped: %s\n", results[i].skip_reason ? results[i].skip_reason : "interrupted");
+        }
+    }
+
+    FILE *out = stdout;
+    if (json_path) {
+        out = fopen(json_path, "w");
+        if (!out) {
+            fprintf(stderr, "[BENCH] Cannot write %s, using stdout\n", json_path);
+            out = stdout;
+        }
+    }
+    write_report(out, &bench, results, count);
+    if (out != stdout) {
+        fclose(out);
+        fprintf(stderr, "[BENCH] Report written to %s\n", json_path);
+    }
+
+    for (int i = 0; i < count; i++) {
+        for (int m = 0; m < BENCH_METRIC_COUNT; m++) {
+            free(results[i].samples[m]);
+        }
+    }
+    free(results);
+    drm_hide_video_plane(bench.drm);
+    gl_cleanup(bench.gl);
+    drm_cleanup(bench.drm);
+    free(bench.gl);
+    free(bench.drm);
+    return g_bench_stop ? 130 : 0;
+}
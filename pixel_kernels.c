@@ -0,0 +1,281 @@
+#include "pixel_kernels.h"
+#include <string.h>
+
+// __ARM_NEON on aarch64, __ARM_NEON__ on 32-bit builds with -mfpu=neon
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define HAS_NEON 1
+#else
+    #define HAS_NEON 0
+#endif
+
+// Bytes ahead of the current load to prefetch; V4L2/DMA-BUF sources come from
+// uncached or freshly-invalidated memory, so a few cache lines of lead helps
+#define PIXEL_PREFETCH_DISTANCE 256
+
+bool pixel_kernels_have_neon(void) {
+    return HAS_NEON;
+}
+
+// ---------------------------------------------------------------------------
+// Scalar reference implementations
+// ---------------------------------------------------------------------------
+
+void pixel_copy_plane_scalar(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride,
+                             int width, int height) {
+    if (dst_stride == width && src_stride == width) {
+        memcpy(dst, src, (size_t)width * (size_t)height);
+        return;
+    }
+    for (int row = 0; row < height; row++) {
+        memcpy(dst + (size_t)row * dst_stride, src + (size_t)row * src_stride, (size_t)width);
+    }
+}
+
+void pixel_interleave_uv_scalar(uint8_t *dst, int dst_stride,
+                                const uint8_t *u, int u_stride, const uint8_t *v, int v_stride,
+                                int width, int height) {
+    for (int row = 0; row < height; row++) {
+        const uint8_t *u_row = u + (size_t)row * u_stride;
+        const uint8_t *v_row = v + (size_t)row * v_stride;
+        uint8_t *d = dst + (size_t)row * dst_stride;
+        for (int col = 0; col < width; col++) {
+            d[2 * col] = u_row[col];
+            d[2 * col + 1] = v_row[col];
+        }
+    }
+}
+
+void pixel_deinterleave_uv_scalar(uint8_t *u, int u_stride, uint8_t *v, int v_stride,
+                                  const uint8_t *src, int src_stride, int width, int height) {
+    for (int row = 0; row < height; row++) {
+        const uint8_t *s = src + (size_t)row * src_stride;
+        uint8_t *u_row = u + (size_t)row * u_stride;
+        uint8_t *v_row = v + (size_t)row * v_stride;
+        for (int col = 0; col < width; col++) {
+            u_row[col] = s[2 * col];
+            v_row[col] = s[2 * col + 1];
+        }
+    }
+}
+
+// Walk column by column so the source is read sequentially: each column is
+// one contiguous 128 * col_height block
+void pixel_sand128_to_linear_scalar(uint8_t *dst, int dst_stride, const uint8_t *src, int col_stride,
+                                    int width, int height) {
+    for (int x = 0; x < width; x += PIXEL_SAND128_COLUMN) {
+        int span = width - x < PIXEL_SAND128_COLUMN ? width - x : PIXEL_SAND128_COLUMN;
+        const uint8_t *column = src + (size_t)(x / PIXEL_SAND128_COLUMN) * col_stride;
+        for (int row = 0; row < height; row++) {
+            memcpy(dst + (size_t)row * dst_stride + x, column + (size_t)row * PIXEL_SAND128_COLUMN,
+                   (size_t)span);
+        }
+    }
+}
+
+void pixel_10bit_to_8bit_scalar(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride,
+                                int width, int height, int shift) {
+    uint32_t round = shift > 0 ? 1u << (shift - 1) : 0;
+    for (int row = 0; row < height; row++) {
+        const uint16_t *s = (const uint16_t *)(const void *)(src + (size_t)row * src_stride);
+        uint8_t *d = dst + (size_t)row * dst_stride;
+        for (int col = 0; col < width; col++) {
+            uint32_t value = ((uint32_t)s[col] + round) >> shift;
+            d[col] = value > 255 ? 255 : (uint8_t)value;
+        }
+    }
+}
+
+typedef void (*narrow_fn_t)(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride,
+                            int width, int height, int shift);
+
+// Column by column like SAND128: unpack one column row to 16-bit samples, then
+// narrow it with the 10-bit kernel given
+static void sand30_to_linear8(uint8_t *dst, int dst_stride, const uint8_t *src, int col_stride,
+                              int width, int height, narrow_fn_t narrow) {
+    uint16_t samples[PIXEL_SAND30_COLUMN_SAMPLES];
+    for (int x = 0; x < width; x += PIXEL_SAND30_COLUMN_SAMPLES) {
+        int span = width - x < PIXEL_SAND30_COLUMN_SAMPLES ? width - x : PIXEL_SAND30_COLUMN_SAMPLES;
+        const uint8_t *column = src + (size_t)(x / PIXEL_SAND30_COLUMN_SAMPLES) * col_stride;
+        for (int row = 0; row < height; row++) {
+            const uint8_t *s = column + (size_t)row * PIXEL_SAND128_COLUMN;
+            for (int i = 0; i < span; i += 3) {
+                uint32_t word;
+                memcpy(&word, s + (i / 3) * 4, sizeof(word));
+                samples[i] = (uint16_t)(word & 0x3ff);
+                samples[i + 1] = (uint16_t)((word >> 10) & 0x3ff);
+                samples[i + 2] = (uint16_t)((word >> 20) & 0x3ff);
+            }
+            narrow(dst + (size_t)row * dst_stride + x, 0, (const uint8_t *)samples, 0, span, 1, 2);
+        }
+    }
+}
+
+void pixel_sand30_to_linear8_scalar(uint8_t *dst, int dst_stride, const uint8_t *src, int col_stride,
+                                    int width, int height) {
+    sand30_to_linear8(dst, dst_stride, src, col_stride, width, height, pixel_10bit_to_8bit_scalar);
+}
+
+void pixel_sand30_to_linear8(uint8_t *dst, int dst_stride, const uint8_t *src, int col_stride,
+                             int width, int height) {
+    sand30_to_linear8(dst, dst_stride, src, col_stride, width, height, pixel_10bit_to_8bit);
+}
+
+#if HAS_NEON
+// ---------------------------------------------------------------------------
+// NEON implementations. Each finishes a row's tail with the scalar loop body,
+// so results are bit-identical to the references.
+// ---------------------------------------------------------------------------
+
+static inline void copy_row_neon(uint8_t *d, const uint8_t *s, int width) {
+    int x = 0;
+    for (; x + 64 <= width; x += 64) {
+        __builtin_prefetch(s + x + PIXEL_PREFETCH_DISTANCE);
+        uint8x16_t a = vld1q_u8(s + x);
+        uint8x16_t b = vld1q_u8(s + x + 16);
+        uint8x16_t c = vld1q_u8(s + x + 32);
+        uint8x16_t e = vld1q_u8(s + x + 48);
+        vst1q_u8(d + x, a);
+        vst1q_u8(d + x + 16, b);
+        vst1q_u8(d + x + 32, c);
+        vst1q_u8(d + x + 48, e);
+    }
+    for (; x + 16 <= width; x += 16) {
+        vst1q_u8(d + x, vld1q_u8(s + x));
+    }
+    if (x < width) {
+        memcpy(d + x, s + x, (size_t)(width - x));
+    }
+}
+
+void pixel_copy_plane(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride,
+                      int width, int height) {
+    if (dst_stride == width && src_stride == width) {
+        copy_row_neon(dst, src, width * height);
+        return;
+    }
+    for (int row = 0; row < height; row++) {
+        copy_row_neon(dst + (size_t)row * dst_stride, src + (size_t)row * src_stride, width);
+    }
+}
+
+void pixel_interleave_uv(uint8_t *dst, int dst_stride,
+                         const uint8_t *u, int u_stride, const uint8_t *v, int v_stride,
+                         int width, int height) {
+    for (int row = 0; row < height; row++) {
+        const uint8_t *u_row = u + (size_t)row * u_stride;
+        const uint8_t *v_row = v + (size_t)row * v_stride;
+        uint8_t *d = dst + (size_t)row * dst_stride;
+        int col = 0;
+        for (; col + 16 <= width; col += 16) {
+            __builtin_prefetch(u_row + col + PIXEL_PREFETCH_DISTANCE);
+            __builtin_prefetch(v_row + col + PIXEL_PREFETCH_DISTANCE);
+            uint8x16x2_t uv;
+            uv.val[0] = vld1q_u8(u_row + col);
+            uv.val[1] = vld1q_u8(v_row + col);
+            vst2q_u8(d + 2 * col, uv);
+        }
+        for (; col < width; col++) {
+            d[2 * col] = u_row[col];
+            d[2 * col + 1] = v_row[col];
+        }
+    }
+}
+
+void pixel_deinterleave_uv(uint8_t *u, int u_stride, uint8_t *v, int v_stride,
+                           const uint8_t *src, int src_stride, int width, int height) {
+    for (int row = 0; row < height; row++) {
+        const uint8_t *s = src + (size_t)row * src_stride;
+        uint8_t *u_row = u + (size_t)row * u_stride;
+        uint8_t *v_row = v + (size_t)row * v_stride;
+        int col = 0;
+        for (; col + 16 <= width; col += 16) {
+            __builtin_prefetch(s + 2 * col + PIXEL_PREFETCH_DISTANCE);
+            uint8x16x2_t uv = vld2q_u8(s + 2 * col);
+            vst1q_u8(u_row + col, uv.val[0]);
+            vst1q_u8(v_row + col, uv.val[1]);
+        }
+        for (; col < width; col++) {
+            u_row[col] = s[2 * col];
+            v_row[col] = s[2 * col + 1];
+        }
+    }
+}
+
+void pixel_sand128_to_linear(uint8_t *dst, int dst_stride, const uint8_t *src, int col_stride,
+                             int width, int height) {
+    for (int x = 0; x < width; x += PIXEL_SAND128_COLUMN) {
+        int span = width - x < PIXEL_SAND128_COLUMN ? width - x : PIXEL_SAND128_COLUMN;
+        const uint8_t *column = src + (size_t)(x / PIXEL_SAND128_COLUMN) * col_stride;
+        for (int row = 0; row < height; row++) {
+            const uint8_t *s = column + (size_t)row * PIXEL_SAND128_COLUMN;
+            uint8_t *d = dst + (size_t)row * dst_stride + x;
+            if (span == PIXEL_SAND128_COLUMN) {
+                // A full column row is two cache lines; the next rows follow contiguously
+                __builtin_prefetch(s + PIXEL_PREFETCH_DISTANCE);
+                __builtin_prefetch(s + PIXEL_PREFETCH_DISTANCE + 64);
+                for (int i = 0; i < PIXEL_SAND128_COLUMN; i += 32) {
+                    uint8x16_t a = vld1q_u8(s + i);
+                    uint8x16_t b = vld1q_u8(s + i + 16);
+                    vst1q_u8(d + i, a);
+                    vst1q_u8(d + i + 16, b);
+                }
+            } else {
+                memcpy(d, s, (size_t)span);
+            }
+        }
+    }
+}
+
+void pixel_10bit_to_8bit(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride,
+                         int width, int height, int shift) {
+    // Rounding shift right (negative VRSHL) with the rounded value computed
+    // exactly, then saturating narrow: matches the scalar clamp at 255
+    int16x8_t neg_shift = vdupq_n_s16((int16_t)-shift);
+    uint32_t round = shift > 0 ? 1u << (shift - 1) : 0;
+    for (int row = 0; row < height; row++) {
+        const uint16_t *s = (const uint16_t *)(const void *)(src + (size_t)row * src_stride);
+        uint8_t *d = dst + (size_t)row * dst_stride;
+        int col = 0;
+        for (; col + 16 <= width; col += 16) {
+            __builtin_prefetch(s + col + PIXEL_PREFETCH_DISTANCE / 2);
+            uint16x8_t lo = vrshlq_u16(vld1q_u16(s + col), neg_shift);
+            uint16x8_t hi = vrshlq_u16(vld1q_u16(s + col + 8), neg_shift);
+            vst1q_u8(d + col, vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi)));
+        }
+        for (; col < width; col++) {
+            uint32_t value = ((uint32_t)s[col] + round) >> shift;
+            d[col] = value > 255 ? 255 : (uint8_t)value;
+        }
+    }
+}
+
+#else
+// No NEON: the entry points are the references
+
+void pixel_copy_plane(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride,
+                      int width, int height) {
+    pixel_copy_plane_scalar(dst, dst_stride, src, src_stride, width, height);
+}
+
+void pixel_interleave_uv(uint8_t *dst, int dst_stride,
+                         const uint8_t *u, int u_stride, const uint8_t *v, int v_stride,
+                         int width, int height) {
+    pixel_interleave_uv_scalar(dst, dst_stride, u, u_stride, v, v_stride, width, height);
+}
+
+void pixel_deinterleave_uv(uint8_t *u, int u_stride, uint8_t *v, int v_stride,
+                           const uint8_t *src, int src_stride, int width, int height) {
+    pixel_deinterleave_uv_scalar(u, u_stride, v, v_stride, src, src_stride, width, height);
+}
+
+void pixel_sand128_to_linear(uint8_t *dst, int dst_stride, const uint8_t *src, int col_stride,
+                             int width, int height) {
+    pixel_sand128_to_linear_scalar(dst, dst_stride, src, col_stride, width, height);
+}
+
+void pixel_10bit_to_8bit(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride,
+                         int width, int height, int shift) {
+    pixel_10bit_to_8bit_scalar(dst, dst_stride, src, src_stride, width, height, shift);
+}
+#endif
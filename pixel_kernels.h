@@ -0,0 +1,58 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// CPU pixel kernels for the software upload paths. Each operation has a scalar
+// reference (_scalar) and a dispatching entry point that uses NEON when the
+// build targets it. Strides and widths are in bytes unless noted; no alignment
+// is required.
+#define PIXEL_SAND128_COLUMN 128      // Column width of the Broadcom SAND128 layout
+#define PIXEL_SAND30_COLUMN_SAMPLES 96 // 10-bit samples per 128-byte SAND30 column row
+
+bool pixel_kernels_have_neon(void);
+
+// Copy a plane row by row (one memcpy when both strides equal width)
+void pixel_copy_plane(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride,
+                      int width, int height);
+void pixel_copy_plane_scalar(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride,
+                             int width, int height);
+
+// YUV420P -> NV12 chroma: width is in chroma samples (output rows are 2*width bytes)
+void pixel_interleave_uv(uint8_t *dst, int dst_stride,
+                         const uint8_t *u, int u_stride, const uint8_t *v, int v_stride,
+                         int width, int height);
+void pixel_interleave_uv_scalar(uint8_t *dst, int dst_stride,
+                                const uint8_t *u, int u_stride, const uint8_t *v, int v_stride,
+                                int width, int height);
+
+// NV12 -> I420 chroma: width is in chroma samples (input rows are 2*width bytes)
+void pixel_deinterleave_uv(uint8_t *u, int u_stride, uint8_t *v, int v_stride,
+                           const uint8_t *src, int src_stride, int width, int height);
+void pixel_deinterleave_uv_scalar(uint8_t *u, int u_stride, uint8_t *v, int v_stride,
+                                  const uint8_t *src, int src_stride, int width, int height);
+
+// SAND128 plane -> linear. col_stride is the byte distance between 128-byte
+// columns (128 * column height from the modifier); width is in bytes.
+void pixel_sand128_to_linear(uint8_t *dst, int dst_stride, const uint8_t *src, int col_stride,
+                             int width, int height);
+void pixel_sand128_to_linear_scalar(uint8_t *dst, int dst_stride, const uint8_t *src, int col_stride,
+                                    int width, int height);
+
+// 16-bit samples -> 8-bit with rounding: shift 2 for yuv420p10 (LSB-aligned),
+// 8 for P010 (MSB-aligned). width is in samples, src_stride in bytes.
+void pixel_10bit_to_8bit(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride,
+                         int width, int height, int shift);
+void pixel_10bit_to_8bit_scalar(uint8_t *dst, int dst_stride, const uint8_t *src, int src_stride,
+                                int width, int height, int shift);
+
+// SAND30 plane -> linear 8-bit: each 32-bit word packs three 10-bit samples
+// (bits 0-9, 10-19, 20-29), 96 per column row, narrowed with pixel_10bit_to_8bit.
+// col_stride as for SAND128; width is in samples (2 per UV pair for chroma).
+void pixel_sand30_to_linear8(uint8_t *dst, int dst_stride, const uint8_t *src, int col_stride,
+                             int width, int height);
+void pixel_sand30_to_linear8_scalar(uint8_t *dst, int dst_stride, const uint8_t *src, int col_stride,
+                                    int width, int height);
+
+#endif // PIXEL_KERNELS_H
@@ -0,0 +1,246 @@
+// pixel-kernels-bench: times each pixel kernel against its scalar reference on
+// synthetic frames and checks that both produce identical output.
+//
+//   ./pixel-kernels-bench [--size WxH] [--iterations N]
+//
+// Exits non-zero if any dispatching kernel disagrees with its reference.
+
+#define _GNU_SOURCE
+#include "pixel_kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define KBENCH_DEFAULT_WIDTH 1920
+#define KBENCH_DEFAULT_HEIGHT 1080
+#define KBENCH_DEFAULT_ITERATIONS 200
+#define KBENCH_STRIDE_PAD 64            // Source row padding, like decoder linesizes
+#define KBENCH_SAND_COL_PAD 16          // Extra rows per SAND column beyond the plane height
+
+typedef enum {
+    KBENCH_COPY = 0,
+    KBENCH_INTERLEAVE,
+    KBENCH_DEINTERLEAVE,
+    KBENCH_SAND128,
+    KBENCH_SAND30,
+    KBENCH_P010,
+    KBENCH_COUNT
+} kbench_kernel_t;
+
+static const char *kbench_names[KBENCH_COUNT] = {
+    "copy_plane", "interleave_uv", "deinterleave_uv", "sand128_to_linear", "sand30_to_linear8", "p010_to_8bit"
+};
+
+typedef struct {
+    int width;
+    int height;
+    int uv_width;
+    int uv_height;
+    int stride;                 // Padded source stride for the luma-sized planes
+    int uv_stride;
+    int sand_col_stride;
+
+    uint8_t *luma;              // stride * height
+    uint8_t *u;                 // uv_stride * uv_height
+    uint8_t *v;
+    uint8_t *nv12_uv;           // stride * uv_height (2 * uv_width used per row)
+    uint8_t *sand;              // Y plane in SAND columns (enough for SAND30's narrower ones)
+    uint8_t *p010;              // 2 * stride * height
+
+    uint8_t *out_ref;           // Linear outputs, sized for the largest plane
+    uint8_t *out_ref2;
+    uint8_t *out;
+    uint8_t *out2;
+} kbench_t;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void fill_pattern(uint8_t *buf, size_t size, uint32_t seed) {
+    // xorshift: cheap, reproducible and not compressible into a memset
+    uint32_t x = seed ? seed : 1;
+    for (size_t i = 0; i < size; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        buf[i] = (uint8_t)x;
+    }
+}
+
+static int kbench_alloc(kbench_t *b, int width, int height) {
+    memset(b, 0, sizeof(*b));
+    b->width = width;
+    b->height = height;
+    b->uv_width = width / 2;
+    b->uv_height = height / 2;
+    b->stride = width + KBENCH_STRIDE_PAD;
+    b->uv_stride = b->uv_width + KBENCH_STRIDE_PAD;
+
+    int columns = (width + PIXEL_SAND30_COLUMN_SAMPLES - 1) / PIXEL_SAND30_COLUMN_SAMPLES;
+    b->sand_col_stride = PIXEL_SAND128_COLUMN * (height + KBENCH_SAND_COL_PAD);
+
+    size_t luma_size = (size_t)b->stride * height;
+    size_t out_size = (size_t)width * height;
+    b->luma = malloc(luma_size);
+    b->u = malloc((size_t)b->uv_stride * b->uv_height);
+    b->v = malloc((size_t)b->uv_stride * b->uv_height);
+    b->nv12_uv = malloc((size_t)b->stride * b->uv_height);
+    b->sand = malloc((size_t)columns * b->sand_col_stride);
+    b->p010 = malloc(2 * luma_size);
+    b->out_ref = malloc(out_size);
+    b->out_ref2 = malloc(out_size);
+    b->out = malloc(out_size);
+    b->out2 = malloc(out_size);
+    if (!b->luma || !b->u || !b->v || !b->nv12_uv || !b->sand || !b->p010 ||
+        !b->out_ref || !b->out_ref2 || !b->out || !b->out2) {
+        return -1;
+    }
+
+    fill_pattern(b->luma, luma_size, 1);
+    fill_pattern(b->u, (size_t)b->uv_stride * b->uv_height, 2);
+    fill_pattern(b->v, (size_t)b->uv_stride * b->uv_height, 3);
+    fill_pattern(b->nv12_uv, (size_t)b->stride * b->uv_height, 4);
+    fill_pattern(b->sand, (size_t)columns * b->sand_col_stride, 5);
+    fill_pattern(b->p010, 2 * luma_size, 6);
+    return 0;
+}
+
+static void kbench_free(kbench_t *b) {
+    free(b->luma);
+    free(b->u);
+    free(b->v);
+    free(b->nv12_uv);
+    free(b->sand);
+    free(b->p010);
+    free(b->out_ref);
+    free(b->out_ref2);
+    free(b->out);
+    free(b->out2);
+}
+
+static void run_kernel(kbench_t *b, kbench_kernel_t kernel, bool reference) {
+    uint8_t *dst = reference ? b->out_ref : b->out;
+    uint8_t *dst2 = reference ? b->out_ref2 : b->out2;
+
+    switch (kernel) {
+    case KBENCH_COPY:
+        (reference ? pixel_copy_plane_scalar : pixel_copy_plane)(
+            dst, b->width, b->luma, b->stride, b->width, b->height);
+        break;
+    case KBENCH_INTERLEAVE:
+        (reference ? pixel_interleave_uv_scalar : pixel_interleave_uv)(
+            dst, b->width, b->u, b->uv_stride, b->v, b->uv_stride, b->uv_width, b->uv_height);
+        break;
+    case KBENCH_DEINTERLEAVE:
+        (reference ? pixel_deinterleave_uv_scalar : pixel_deinterleave_uv)(
+            dst, b->uv_width, dst2, b->uv_width, b->nv12_uv, b->stride, b->uv_width, b->uv_height);
+        break;
+    case KBENCH_SAND128:
+        (reference ? pixel_sand128_to_linear_scalar : pixel_sand128_to_linear)(
+            dst, b->width, b->sand, b->sand_col_stride, b->width, b->height);
+        break;
+    case KBENCH_SAND30:
+        (reference ? pixel_sand30_to_linear8_scalar : pixel_sand30_to_linear8)(
+            dst, b->width, b->sand, b->sand_col_stride, b->width, b->height);
+        break;
+    case KBENCH_P010:
+        (reference ? pixel_10bit_to_8bit_scalar : pixel_10bit_to_8bit)(
+            dst, b->width, b->p010, 2 * b->stride, b->width, b->height, 8);
+        break;
+    default:
+        break;
+    }
+}
+
+// Output bytes compared per kernel (deinterleave also checks the V plane)
+static size_t kernel_output_size(const kbench_t *b, kbench_kernel_t kernel) {
+    switch (kernel) {
+    case KBENCH_INTERLEAVE:
+        return (size_t)b->width * b->uv_height;
+    case KBENCH_DEINTERLEAVE:
+        return (size_t)b->uv_width * b->uv_height;
+    default:
+        return (size_t)b->width * b->height;
+    }
+}
+
+static double time_kernel(kbench_t *b, kbench_kernel_t kernel, bool reference, int iterations) {
+    run_kernel(b, kernel, reference);  // Warm caches and fault in the output pages
+    double start = now_seconds();
+    for (int i = 0; i < iterations; i++) {
+        run_kernel(b, kernel, reference);
+    }
+    return (now_seconds() - start) * 1000.0 / iterations;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [--size WxH] [--iterations N]\n", prog);
+    printf("  --size WxH       Frame size (default %dx%d)\n", KBENCH_DEFAULT_WIDTH, KBENCH_DEFAULT_HEIGHT);
+    printf("  --iterations N   Timed runs per kernel (default %d)\n", KBENCH_DEFAULT_ITERATIONS);
+}
+
+int main(int argc, char **argv) {
+    int width = KBENCH_DEFAULT_WIDTH;
+    int height = KBENCH_DEFAULT_HEIGHT;
+    int iterations = KBENCH_DEFAULT_ITERATIONS;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width < 2 || height < 2) {
+                fprintf(stderr, "[KBENCH] Invalid size: %s\n", argv[i]);
+                return 1;
+            }
+            width &= ~1;
+            height &= ~1;
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+            if (iterations <= 0) {
+                fprintf(stderr, "[KBENCH] Invalid iteration count: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            fprintf(stderr, "[KBENCH] Unknown option: %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    kbench_t bench;
+    if (kbench_alloc(&bench, width, height) != 0) {
+        fprintf(stderr, "[KBENCH] Out of memory for %dx%d buffers\n", width, height);
+        kbench_free(&bench);
+        return 1;
+    }
+
+    printf("[KBENCH] %dx%d, %d iterations, NEON %s\n", width, height, iterations,
+           pixel_kernels_have_neon() ? "enabled" : "not available (dispatch uses scalar)");
+    printf("%-20s %12s %12s %9s  %s\n", "kernel", "scalar ms", "dispatch ms", "speedup", "check");
+
+    int failures = 0;
+    for (int k = 0; k < KBENCH_COUNT; k++) {
+        double ref_ms = time_kernel(&bench, (kbench_kernel_t)k, true, iterations);
+        double fast_ms = time_kernel(&bench, (kbench_kernel_t)k, false, iterations);
+
+        size_t size = kernel_output_size(&bench, (kbench_kernel_t)k);
+        bool match = memcmp(bench.out_ref, bench.out, size) == 0;
+        if (k == KBENCH_DEINTERLEAVE) {
+            match = match && memcmp(bench.out_ref2, bench.out2, size) == 0;
+        }
+        if (!match) {
+            failures++;
+        }
+
+        printf("%-20s %12.3f %12.3f %8.2fx  %s\n", kbench_names[k], ref_ms, fast_ms,
+               fast_ms > 0.0 ? ref_ms / fast_ms : 0.0, match ? "ok" : "MISMATCH");
+    }
+
+    kbench_free(&bench);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+#define _GNU_SOURCE
+#include "playlist.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+int playlist_init(playlist_t *pl, bool loop) {
+    if (!pl) return -1;
+
+    memset(pl, 0, sizeof(*pl));
+    pl->loop = loop;
+    pl->control_fd = -1;
+    return 0;
+}
+
+// Strip leading/trailing whitespace in place
+static char *trim(char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    char *end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return s;
+}
+
+int playlist_load(playlist_t *pl, const char *list_file) {
+    if (!pl || !list_file) return -1;
+
+    FILE *f = fopen(list_file, "r");
+    if (!f) {
+        fprintf(stderr, "[PLAYLIST] Cannot open %s: %s\n", list_file, strerror(errno));
+        return -1;
+    }
+
+    char line[PLAYLIST_CMD_MAX];
+    int added = 0;
+    while (fgets(line, sizeof(line), f)) {
+        char *path = trim(line);
+        if (path[0] == '\0' || path[0] == '#') {
+            continue;
+        }
+        if (playlist_add(pl, path) != 0) {
+            break;
+        }
+        added++;
+    }
+    fclose(f);
+
+    printf("[PLAYLIST] Loaded %d items from %s\n", added, list_file);
+    return added > 0 ? 0 : -1;
+}
+
+int playlist_add(playlist_t *pl, const char *path) {
+    if (!pl || !path || !path[0]) return -1;
+
+    if (pl->count >= PLAYLIST_MAX_ITEMS) {
+        fprintf(stderr, "[PLAYLIST] Playlist full (%d items), ignoring %s\n", PLAYLIST_MAX_ITEMS, path);
+        return -1;
+    }
+    if (pl->count == pl->capacity) {
+        int capacity = pl->capacity ? pl->capacity * 2 : 16;
+        char **items = realloc(pl->items, (size_t)capacity * sizeof(char *));
+        if (!items) return -1;
+        pl->items = items;
+        pl->capacity = capacity;
+    }
+
+    pl->items[pl->count] = strdup(path);
+    if (!pl->items[pl->count]) return -1;
+    pl->count++;
+    return 0;
+}
+
+void playlist_cleanup(playlist_t *pl) {
+    if (!pl) return;
+
+    if (pl->control_fd >= 0) {
+        close(pl->control_fd);
+        unlink(pl->control_path);
+    }
+    for (int i = 0; i < pl->count; i++) {
+        free(pl->items[i]);
+    }
+    free(pl->items);
+    memset(pl, 0, sizeof(*pl));
+    pl->control_fd = -1;
+}
+
+const char *playlist_first(playlist_t *pl) {
+    if (!pl || pl->count == 0) return NULL;
+
+    pl->next_index = 1;
+    return pl->items[0];
+}
+
+const char *playlist_next(playlist_t *pl) {
+    if (!pl || pl->count == 0) return NULL;
+
+    if (pl->next_index >= pl->count) {
+        if (!pl->loop) {
+            return NULL;
+        }
+        pl->next_index = 0;
+    }
+    return pl->items[pl->next_index++];
+}
+
+int playlist_open_control(playlist_t *pl, const char *socket_path) {
+    if (!pl || !socket_path) return -1;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "[PLAYLIST] Control socket path too long: %s\n", socket_path);
+        return -1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        fprintf(stderr, "[PLAYLIST] socket() failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    unlink(socket_path);  // Stale socket from a previous run
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "[PLAYLIST] Cannot bind %s: %s\n", socket_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    pl->control_fd = fd;
+    snprintf(pl->control_path, sizeof(pl->control_path), "%s", socket_path);
+    printf("[PLAYLIST] Control socket listening on %s\n", socket_path);
+    return 0;
+}
+
+// Wait up to timeout_ms for control datagrams and apply them. "next" wins over
+// "add" when both arrive in the same poll.
+playlist_cmd_t playlist_poll_control(playlist_t *pl, int timeout_ms) {
+    if (!pl) return PLAYLIST_CMD_NONE;
+
+    if (pl->control_fd < 0) {
+        struct timespec ts = {timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000L};
+        nanosleep(&ts, NULL);
+        return PLAYLIST_CMD_NONE;
+    }
+
+    struct pollfd pfd = {.fd = pl->control_fd, .events = POLLIN};
+    if (poll(&pfd, 1, timeout_ms) <= 0 || !(pfd.revents & POLLIN)) {
+        return PLAYLIST_CMD_NONE;
+    }
+
+    playlist_cmd_t result = PLAYLIST_CMD_NONE;
+    char buf[PLAYLIST_CMD_MAX];
+    ssize_t len;
+    while ((len = recv(pl->control_fd, buf, sizeof(buf) - 1, 0)) > 0) {
+        buf[len] = '\0';
+        char *cmd = trim(buf);
+
+        if (strcmp(cmd, "next") == 0) {
+            result = PLAYLIST_CMD_NEXT;
+        } else if (strncmp(cmd, "add ", 4) == 0) {
+            char *path = trim(cmd + 4);
+            if (playlist_add(pl, path) == 0) {
+                printf("[PLAYLIST] Added %s (%d items)\n", path, pl->count);
+                if (result == PLAYLIST_CMD_NONE) {
+                    result = PLAYLIST_CMD_ADDED;
+                }
+            }
+        } else if (strncmp(cmd, "seek ", 5) == 0) {
+            char *end = NULL;
+            double seconds = strtod(cmd + 5, &end);
+            if (end != cmd + 5 && *trim(end) == '\0' && seconds >= 0) {
+                pl->seek_seconds = seconds;
+                pl->seek_pending = true;
+            } else {
+                fprintf(stderr, "[PLAYLIST] Bad seek position: %s\n", cmd + 5);
+            }
+        } else {
+            fprintf(stderr, "[PLAYLIST] Unknown control command: %s\n", cmd);
+        }
+    }
+    return result;
+}
+
+bool playlist_take_seek(playlist_t *pl, double *seconds) {
+    if (!pl || !pl->seek_pending) return false;
+    pl->seek_pending = false;
+    *seconds = pl->seek_seconds;
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include <stdbool.h>
+
+// Playlist of clips played back-to-back on stream 0 without tearing down
+// DRM/GL. Items come from a list file (one path per line, '#' comments) and
+// can be appended at runtime through an optional UNIX datagram control socket.
+#define PLAYLIST_MAX_ITEMS 1024
+#define PLAYLIST_CMD_MAX 4096     // Largest control datagram ("add <path>")
+
+typedef enum {
+    PLAYLIST_CMD_NONE = 0,
+    PLAYLIST_CMD_NEXT,            // Cut over to the next item at the next frame boundary
+    PLAYLIST_CMD_ADDED            // An item was appended
+} playlist_cmd_t;
+
+typedef struct {
+    char **items;
+    int count;
+    int capacity;
+    int next_index;               // Item the next playlist_next() returns
+    bool loop;                    // Wrap to the first item after the last
+
+    int control_fd;               // -1 without a control socket
+    char control_path[108];       // sizeof(sockaddr_un.sun_path)
+    bool seek_pending;            // "seek <seconds>" not yet taken
+    double seek_seconds;
+} playlist_t;
+
+int playlist_init(playlist_t *pl, bool loop);
+int playlist_load(playlist_t *pl, const char *list_file);
+int playlist_add(playlist_t *pl, const char *path);
+void playlist_cleanup(playlist_t *pl);
+
+const char *playlist_first(playlist_t *pl);   // Item 0; playback starts there
+const char *playlist_next(playlist_t *pl);    // Next item to prepare (NULL at the end, no loop)
+
+// Control socket: "add <path>" appends, "next" skips to the prepared item,
+// "seek <seconds>" jumps within the item on screen (cue points)
+int playlist_open_control(playlist_t *pl, const char *socket_path);
+playlist_cmd_t playlist_poll_control(playlist_t *pl, int timeout_ms);
+bool playlist_take_seek(playlist_t *pl, double *seconds);   // Latest seek since the last call
+
+#endif // PLAYLIST_H
@@ -8,7 +8,7 @@
 #define MAX_FRAME_SIZE (MAX_VIDEO_WIDTH * MAX_VIDEO_HEIGHT * 3 / 2)
 #define MAX_DECODE_ATTEMPTS 3
 #define DECODE_TIMEOUT_MS 5000
-#define MEMORY_LIMIT_MB 512
+#define MEMORY_LIMIT_MB 512       // Budget for CPU frame buffers and the decode-to-PBO pool (PICKLE_MEMORY_LIMIT_MB)
 
 // File size limits
 #define MAX_VIDEO_FILE_SIZE (4ULL * 1024 * 1024 * 1024) // 4GB
@@ -17,6 +17,12 @@
 #define FRAME_BUFFER_COUNT 3
 #define DECODE_THREAD_COUNT 4
 #define GL_SYNC_INTERVAL 1
+#define MAX_VIDEO_STREAMS 4       // Composited streams per display; 3-4 SW-decoded 720p fit the Pi 4 GPU
+#define DECODE_QUEUE_DEPTH 4      // Decoded frames buffered ahead of display (PICKLE_DECODE_QUEUE overrides)
+#define PACKET_CACHE_MB 64         // Per looped stream: filtered packets kept in RAM (PICKLE_PACKET_CACHE_MB, 0 = off)
+#define LIVE_DECODE_QUEUE_DEPTH 2  // --live: one frame on deck plus one being decoded
+#define LIVE_DEFAULT_LATENCY_MS 100 // --live: receive-to-glass target before frames are dropped as stale
+#define SCANOUT_KEYSTONE_TOLERANCE 0.002f  // NDC skew still treated as an upright rectangle for plane scanout
 
 // Debug/logging configuration
 #ifdef NDEBUG
@@ -0,0 +1,547 @@
+#define _GNU_SOURCE  // madvise, statfs
+#include "read_ahead.h"
+#include "metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <libavutil/error.h>
+#include <libavutil/mem.h>
+#include <libavutil/dict.h>
+
+#define READ_AHEAD_AVIO_BUFFER (64 * 1024)         // Demuxer-side AVIOContext buffer
+#define READ_AHEAD_LOW_WATERMARK_MAX (2 * 1024 * 1024)
+#define READ_AHEAD_WAIT_MS 100                      // Interrupt-callback poll interval while stalled
+
+// statfs f_type of filesystems where page faults can block on the network
+#define FS_MAGIC_NFS   0x6969
+#define FS_MAGIC_SMB   0x517B
+#define FS_MAGIC_CIFS  0xFF534D42
+#define FS_MAGIC_SMB2  0xFE534D42
+#define FS_MAGIC_FUSE  0x65735546
+#define FS_MAGIC_9P    0x01021997
+
+struct read_ahead {
+    read_ahead_mode_t mode;
+    AVIOContext *avio;
+    AVIOInterruptCB interrupt_cb;
+    int64_t size;                    // -1 when the source can't tell
+
+    // mmap mode (demuxer thread only)
+    int fd;
+    uint8_t *map;
+    int64_t pos;
+    int64_t advised_until;
+
+    // thread mode
+    AVIOContext *src;
+    pthread_t thread;
+    bool thread_started;
+    pthread_mutex_t lock;
+    pthread_cond_t data_cond;        // I/O thread -> reader: data, EOF, error or seek done
+    pthread_cond_t space_cond;       // Reader -> I/O thread: space freed, seek or close
+    uint8_t *ring;
+    size_t capacity;
+    size_t head;                     // Ring offset of the next byte to hand out
+    size_t fill;                     // Bytes buffered at head
+    int64_t ring_pos;                // Stream position of ring[head]
+    size_t low_watermark;            // A stalled reader resumes once this much is buffered
+    size_t high_watermark;           // A full ring resumes filling once it drains to this
+    bool idle;                       // Ring filled up; waiting for the high watermark
+    bool src_eof;
+    int src_error;
+    bool closing;
+    int64_t seek_target;
+    unsigned int seek_request;
+    unsigned int seek_done;
+    int seek_result;
+
+    read_ahead_state_t state;
+    uint64_t bytes_read;
+    unsigned int underruns;
+    double last_stall_ms;
+};
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+const char *read_ahead_state_name(read_ahead_state_t state) {
+    switch (state) {
+    case READ_AHEAD_FILLING:   return "filling";
+    case READ_AHEAD_READY:     return "ready";
+    case READ_AHEAD_BUFFERING: return "buffering";
+    case READ_AHEAD_EOF:       return "eof";
+    case READ_AHEAD_ERROR:     return "error";
+    default:                   return "unknown";
+    }
+}
+
+// Plain paths (or file:) on a local filesystem can be mapped; everything else
+// goes through the I/O thread
+static const char *local_mappable_path(const char *url) {
+    const char *path = url;
+    if (strncmp(url, "file:", 5) == 0) {
+        path = url + 5;
+    } else if (strstr(url, "://")) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        return NULL;
+    }
+    struct statfs fs;
+    if (statfs(path, &fs) == 0) {
+        unsigned long type = (unsigned long)fs.f_type;
+        if (type == FS_MAGIC_NFS || type == FS_MAGIC_SMB || type == FS_MAGIC_CIFS ||
+            type == FS_MAGIC_SMB2 || type == FS_MAGIC_FUSE || type == FS_MAGIC_9P) {
+            return NULL;
+        }
+    }
+    return path;
+}
+
+// ---------------------------------------------------------------------------
+// mmap mode
+// ---------------------------------------------------------------------------
+
+static void mmap_advise_ahead(read_ahead_t *ra) {
+    // Keep a window of readahead queued past the read position (advice is async)
+    while (ra->advised_until < ra->size && ra->advised_until < ra->pos + READ_AHEAD_MMAP_WINDOW) {
+        int64_t len = ra->size - ra->advised_until;
+        if (len > READ_AHEAD_MMAP_WINDOW) len = READ_AHEAD_MMAP_WINDOW;
+        madvise(ra->map + ra->advised_until, (size_t)len, MADV_WILLNEED);
+        ra->advised_until += len;
+    }
+}
+
+static int mmap_read(void *opaque, uint8_t *buf, int buf_size) {
+    read_ahead_t *ra = (read_ahead_t *)opaque;
+    if (ra->pos >= ra->size) {
+        return AVERROR_EOF;
+    }
+    int64_t n = ra->size - ra->pos;
+    if (n > buf_size) n = buf_size;
+    memcpy(buf, ra->map + ra->pos, (size_t)n);
+    ra->pos += n;
+    mmap_advise_ahead(ra);
+    return (int)n;
+}
+
+static int64_t mmap_seek(void *opaque, int64_t offset, int whence) {
+    read_ahead_t *ra = (read_ahead_t *)opaque;
+    if (whence & AVSEEK_SIZE) {
+        return ra->size;
+    }
+    whence &= ~AVSEEK_FORCE;
+
+    int64_t target;
+    if (whence == SEEK_SET) target = offset;
+    else if (whence == SEEK_CUR) target = ra->pos + offset;
+    else if (whence == SEEK_END) target = ra->size + offset;
+    else return AVERROR(EINVAL);
+    if (target < 0 || target > ra->size) {
+        return AVERROR(EINVAL);
+    }
+
+    ra->pos = target;
+    // Restart the advice window at the new position (page-aligned for madvise)
+    long page = sysconf(_SC_PAGESIZE);
+    ra->advised_until = page > 0 ? target - target % page : target;
+    mmap_advise_ahead(ra);
+    return target;
+}
+
+static int open_mmap(read_ahead_t *ra, const char *path) {
+    ra->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (ra->fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(ra->fd, &st) != 0 || st.st_size <= 0) {
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, ra->fd, 0);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    ra->map = map;
+    ra->size = st.st_size;
+    madvise(ra->map, (size_t)ra->size, MADV_SEQUENTIAL);
+    mmap_advise_ahead(ra);
+
+    ra->avio = avio_alloc_context(av_malloc(READ_AHEAD_AVIO_BUFFER), READ_AHEAD_AVIO_BUFFER, 0,
+                                  ra, mmap_read, NULL, mmap_seek);
+    if (!ra->avio) {
+        return -1;
+    }
+    ra->mode = READ_AHEAD_MODE_MMAP;
+    ra->state = READ_AHEAD_READY;
+    printf("[IO] %s: mmap read-ahead (%.1f MB, MADV_SEQUENTIAL)\n", path, (double)ra->size / (1024.0 * 1024.0));
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Thread mode
+// ---------------------------------------------------------------------------
+
+static int source_interrupt(void *opaque) {
+    read_ahead_t *ra = (read_ahead_t *)opaque;
+    return __atomic_load_n(&ra->closing, __ATOMIC_ACQUIRE) ? 1 : 0;
+}
+
+static void *io_thread(void *arg) {
+    read_ahead_t *ra = (read_ahead_t *)arg;
+
+    pthread_mutex_lock(&ra->lock);
+    while (!ra->closing) {
+        if (ra->seek_request != ra->seek_done) {
+            unsigned int request = ra->seek_request;
+            int64_t target = ra->seek_target;
+            pthread_mutex_unlock(&ra->lock);
+            int64_t result = avio_seek(ra->src, target, SEEK_SET);
+            pthread_mutex_lock(&ra->lock);
+
+            ra->head = 0;
+            ra->fill = 0;
+            ra->ring_pos = target;
+            ra->idle = false;
+            ra->src_eof = false;
+            ra->src_error = result < 0 ? (int)result : 0;
+            ra->seek_result = result < 0 ? (int)result : 0;
+            ra->seek_done = request;
+            ra->state = result < 0 ? READ_AHEAD_ERROR : READ_AHEAD_FILLING;
+            pthread_cond_broadcast(&ra->data_cond);
+            continue;
+        }
+
+        if (ra->fill == ra->capacity) {
+            ra->idle = true;
+        } else if (ra->idle && ra->fill <= ra->high_watermark) {
+            ra->idle = false;
+        }
+        if (ra->src_eof || ra->src_error || ra->idle) {
+            pthread_cond_wait(&ra->space_cond, &ra->lock);
+            continue;
+        }
+
+        // Largest contiguous free run at the tail, one chunk at a time
+        size_t tail = (ra->head + ra->fill) % ra->capacity;
+        size_t len = ra->capacity - ra->fill;
+        if (len > ra->capacity - tail) len = ra->capacity - tail;
+        if (len > READ_AHEAD_CHUNK) len = READ_AHEAD_CHUNK;
+        unsigned int seek_generation = ra->seek_request;
+        pthread_mutex_unlock(&ra->lock);
+
+        // The reader never touches free space, so the ring is filled unlocked
+        int n = avio_read(ra->src, ra->ring + tail, (int)len);
+
+        pthread_mutex_lock(&ra->lock);
+        if (ra->seek_request != seek_generation) {
+            continue;  // Data belongs to the old position
+        }
+        if (n > 0) {
+            ra->fill += (size_t)n;
+            ra->bytes_read += (uint64_t)n;
+            if (ra->state == READ_AHEAD_FILLING && ra->fill >= ra->low_watermark) {
+                ra->state = READ_AHEAD_READY;
+            }
+        } else if (n == 0 || n == AVERROR_EOF) {
+            ra->src_eof = true;
+            if (ra->state != READ_AHEAD_BUFFERING) {
+                ra->state = READ_AHEAD_EOF;
+            }
+        } else if (!ra->closing) {
+            ra->src_error = n;
+            ra->state = READ_AHEAD_ERROR;
+            fprintf(stderr, "[IO] Read-ahead source error: %s\n", av_err2str(n));
+        }
+        pthread_cond_broadcast(&ra->data_cond);
+    }
+    pthread_mutex_unlock(&ra->lock);
+    return NULL;
+}
+
+// Wait on data_cond for one poll interval; true if the caller's interrupt callback fired
+static bool wait_interruptible(read_ahead_t *ra) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += READ_AHEAD_WAIT_MS * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&ra->data_cond, &ra->lock, &deadline);
+
+    if (!ra->interrupt_cb.callback) {
+        return false;
+    }
+    pthread_mutex_unlock(&ra->lock);
+    int abort_read = ra->interrupt_cb.callback(ra->interrupt_cb.opaque);
+    pthread_mutex_lock(&ra->lock);
+    return abort_read != 0;
+}
+
+static int thread_read(void *opaque, uint8_t *buf, int buf_size) {
+    read_ahead_t *ra = (read_ahead_t *)opaque;
+
+    pthread_mutex_lock(&ra->lock);
+    double stall_start = 0.0;
+    // After an underrun, hold off until the low watermark so playback doesn't
+    // resume on a trickle and stall again on the next packet
+    while ((ra->fill == 0 || (ra->state == READ_AHEAD_BUFFERING && ra->fill < ra->low_watermark)) &&
+           !ra->src_eof && !ra->src_error && !ra->closing) {
+        if (ra->state != READ_AHEAD_BUFFERING && ra->state != READ_AHEAD_FILLING) {
+            ra->state = READ_AHEAD_BUFFERING;
+            ra->underruns++;
+            printf("[IO] Read-ahead empty, buffering (underrun %u)\n", ra->underruns);
+        }
+        if (stall_start == 0.0) {
+            stall_start = now_ms();
+        }
+        if (wait_interruptible(ra)) {
+            pthread_mutex_unlock(&ra->lock);
+            return AVERROR_EXIT;
+        }
+    }
+
+    if (ra->state == READ_AHEAD_BUFFERING && stall_start > 0.0) {
+        ra->last_stall_ms = now_ms() - stall_start;
+        ra->state = ra->src_eof ? READ_AHEAD_EOF : (ra->src_error ? READ_AHEAD_ERROR : READ_AHEAD_READY);
+        printf("[IO] Read-ahead resumed after %.0f ms\n", ra->last_stall_ms);
+        metrics_record_io_stall(ra->last_stall_ms / 1000.0);
+    }
+
+    if (ra->fill == 0) {
+        int err = ra->src_error ? ra->src_error : AVERROR_EOF;
+        pthread_mutex_unlock(&ra->lock);
+        return err;
+    }
+
+    size_t n = ra->fill < (size_t)buf_size ? ra->fill : (size_t)buf_size;
+    size_t first = ra->capacity - ra->head;
+    if (first > n) first = n;
+    memcpy(buf, ra->ring + ra->head, first);
+    memcpy(buf + first, ra->ring, n - first);
+    ra->head = (ra->head + n) % ra->capacity;
+    ra->fill -= n;
+    ra->ring_pos += (int64_t)n;
+    if (ra->idle && ra->fill <= ra->high_watermark) {
+        pthread_cond_signal(&ra->space_cond);
+    }
+    pthread_mutex_unlock(&ra->lock);
+    return (int)n;
+}
+
+static int64_t thread_seek(void *opaque, int64_t offset, int whence) {
+    read_ahead_t *ra = (read_ahead_t *)opaque;
+    if (whence & AVSEEK_SIZE) {
+        return ra->size >= 0 ? ra->size : AVERROR(ENOSYS);
+    }
+    whence &= ~AVSEEK_FORCE;
+
+    pthread_mutex_lock(&ra->lock);
+    int64_t target;
+    if (whence == SEEK_SET) {
+        target = offset;
+    } else if (whence == SEEK_CUR) {
+        target = ra->ring_pos + offset;
+    } else if (whence == SEEK_END && ra->size >= 0) {
+        target = ra->size + offset;
+    } else {
+        pthread_mutex_unlock(&ra->lock);
+        return AVERROR(ENOSYS);
+    }
+    if (target < 0) {
+        pthread_mutex_unlock(&ra->lock);
+        return AVERROR(EINVAL);
+    }
+
+    // Forward within the buffered data: just skip (the demuxer's small seeks)
+    if (target >= ra->ring_pos && target <= ra->ring_pos + (int64_t)ra->fill &&
+        ra->seek_request == ra->seek_done) {
+        size_t skip = (size_t)(target - ra->ring_pos);
+        ra->head = (ra->head + skip) % ra->capacity;
+        ra->fill -= skip;
+        ra->ring_pos = target;
+        pthread_cond_signal(&ra->space_cond);
+        pthread_mutex_unlock(&ra->lock);
+        return target;
+    }
+
+    if (!ra->avio->seekable) {
+        pthread_mutex_unlock(&ra->lock);
+        return AVERROR(ENOSYS);
+    }
+
+    unsigned int request = ++ra->seek_request;
+    ra->seek_target = target;
+    pthread_cond_signal(&ra->space_cond);
+    while (ra->seek_done != request && !ra->closing) {
+        if (wait_interruptible(ra)) {
+            pthread_mutex_unlock(&ra->lock);
+            return AVERROR_EXIT;
+        }
+    }
+    int result = ra->seek_result;
+    pthread_mutex_unlock(&ra->lock);
+    return result < 0 ? result : target;
+}
+
+static int open_thread(read_ahead_t *ra, const char *url, size_t ring_bytes) {
+    AVIOInterruptCB src_cb = { .callback = source_interrupt, .opaque = ra };
+    AVDictionary *options = NULL;
+    av_dict_set(&options, "multiple_requests", "1", 0);      // Enable HTTP keep-alive
+    av_dict_set(&options, "reconnect", "1", 0);              // Auto-reconnect on network issues
+    int ret = avio_open2(&ra->src, url, AVIO_FLAG_READ, &src_cb, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        fprintf(stderr, "[IO] Cannot open %s: %s\n", url, av_err2str(ret));
+        return -1;
+    }
+    ra->size = avio_size(ra->src);
+    if (ra->size < 0) ra->size = -1;
+
+    ra->ring = malloc(ring_bytes);
+    if (!ra->ring) {
+        fprintf(stderr, "[IO] Cannot allocate %zu MB read-ahead ring\n", ring_bytes / (1024 * 1024));
+        return -1;
+    }
+    ra->capacity = ring_bytes;
+    ra->low_watermark = ring_bytes / 8 < READ_AHEAD_LOW_WATERMARK_MAX ? ring_bytes / 8 : READ_AHEAD_LOW_WATERMARK_MAX;
+    ra->high_watermark = ring_bytes / 4 * 3;
+    ra->state = READ_AHEAD_FILLING;
+
+    ra->avio = avio_alloc_context(av_malloc(READ_AHEAD_AVIO_BUFFER), READ_AHEAD_AVIO_BUFFER, 0,
+                                  ra, thread_read, NULL, thread_seek);
+    if (!ra->avio) {
+        return -1;
+    }
+    ra->avio->seekable = ra->src->seekable;
+
+    if (pthread_create(&ra->thread, NULL, io_thread, ra) != 0) {
+        fprintf(stderr, "[IO] Failed to start read-ahead thread\n");
+        return -1;
+    }
+    ra->thread_started = true;
+    ra->mode = READ_AHEAD_MODE_THREAD;
+    printf("[IO] %s: threaded read-ahead (%zu MB ring, %s)\n", url, ring_bytes / (1024 * 1024),
+           ra->src->seekable ? "seekable" : "not seekable");
+    return 0;
+}
+
+read_ahead_t *read_ahead_open(const char *url, size_t ring_bytes, const AVIOInterruptCB *interrupt_cb) {
+    if (!url) return NULL;
+
+    read_ahead_t *ra = calloc(1, sizeof(*ra));
+    if (!ra) return NULL;
+    ra->fd = -1;
+    ra->size = -1;
+    if (interrupt_cb) {
+        ra->interrupt_cb = *interrupt_cb;
+    }
+    pthread_mutex_init(&ra->lock, NULL);
+    pthread_cond_init(&ra->data_cond, NULL);
+    pthread_cond_init(&ra->space_cond, NULL);
+
+    size_t min_bytes = (size_t)READ_AHEAD_MIN_MB * 1024 * 1024;
+    size_t max_bytes = (size_t)READ_AHEAD_MAX_MB * 1024 * 1024;
+    if (ring_bytes < min_bytes) ring_bytes = min_bytes;
+    if (ring_bytes > max_bytes) ring_bytes = max_bytes;
+
+    const char *path = local_mappable_path(url);
+    int ret = -1;
+    if (path) {
+        ret = open_mmap(ra, path);
+        if (ret != 0) {
+            // e.g. no address space for a huge file on 32-bit: stream it instead
+            if (ra->avio) {
+                av_freep(&ra->avio->buffer);
+                avio_context_free(&ra->avio);
+            }
+            if (ra->map) munmap(ra->map, (size_t)ra->size);
+            if (ra->fd >= 0) close(ra->fd);
+            ra->map = NULL;
+            ra->fd = -1;
+            ra->size = -1;
+        }
+    }
+    if (ret != 0) {
+        ret = open_thread(ra, url, ring_bytes);
+    }
+    if (ret != 0) {
+        read_ahead_close(ra);
+        return NULL;
+    }
+    return ra;
+}
+
+void read_ahead_close(read_ahead_t *ra) {
+    if (!ra) return;
+
+    if (ra->thread_started) {
+        pthread_mutex_lock(&ra->lock);
+        __atomic_store_n(&ra->closing, true, __ATOMIC_RELEASE);
+        pthread_cond_broadcast(&ra->space_cond);
+        pthread_cond_broadcast(&ra->data_cond);
+        pthread_mutex_unlock(&ra->lock);
+        pthread_join(ra->thread, NULL);
+    }
+    if (ra->avio) {
+        av_freep(&ra->avio->buffer);
+        avio_context_free(&ra->avio);
+    }
+    if (ra->src) {
+        avio_closep(&ra->src);
+    }
+    if (ra->map) {
+        munmap(ra->map, (size_t)ra->size);
+    }
+    if (ra->fd >= 0) {
+        close(ra->fd);
+    }
+    free(ra->ring);
+    pthread_cond_destroy(&ra->space_cond);
+    pthread_cond_destroy(&ra->data_cond);
+    pthread_mutex_destroy(&ra->lock);
+    free(ra);
+}
+
+AVIOContext *read_ahead_avio(read_ahead_t *ra) {
+    return ra ? ra->avio : NULL;
+}
+
+void read_ahead_get_stats(read_ahead_t *ra, read_ahead_stats_t *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (!ra) return;
+
+    out->mode = ra->mode;
+    if (ra->mode == READ_AHEAD_MODE_MMAP) {
+        // Demuxer thread state; a torn read only skews one sample
+        out->state = ra->pos >= ra->size ? READ_AHEAD_EOF : READ_AHEAD_READY;
+        out->buffered = (size_t)(ra->size - ra->pos);
+        out->capacity = (size_t)ra->size;
+        out->bytes_read = (uint64_t)ra->pos;
+        return;
+    }
+
+    pthread_mutex_lock(&ra->lock);
+    out->state = ra->state;
+    out->buffered = ra->fill;
+    out->capacity = ra->capacity;
+    out->bytes_read = ra->bytes_read;
+    out->underruns = ra->underruns;
+    out->last_stall_ms = ra->last_stall_ms;
+    pthread_mutex_unlock(&ra->lock);
+}
@@ -0,0 +1,60 @@
+#ifndef READ_AHEAD_H
+#define READ_AHEAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <libavformat/avio.h>
+
+// Read-ahead I/O for the demuxer: a custom AVIOContext that decouples
+// av_read_frame() from storage latency.
+//   mmap   - local files on a block device: mapped with MADV_SEQUENTIAL, and a
+//            MADV_WILLNEED window kept ahead of the read position
+//   thread - URLs and network filesystems: a dedicated I/O thread fills a ring
+//            buffer (PICKLE_READ_AHEAD_MB) from the real protocol
+// Reads that find the ring empty block until the low watermark refills (or the
+// caller's interrupt callback gives up), so the existing timeout machinery only
+// fires when the source really stops delivering.
+#define READ_AHEAD_DEFAULT_MB 64
+#define READ_AHEAD_MIN_MB 4
+#define READ_AHEAD_MAX_MB 512
+#define READ_AHEAD_CHUNK (256 * 1024)               // Bytes per source read on the I/O thread
+#define READ_AHEAD_MMAP_WINDOW (8 * 1024 * 1024)    // MADV_WILLNEED lead in mmap mode
+
+typedef enum {
+    READ_AHEAD_MODE_MMAP = 0,
+    READ_AHEAD_MODE_THREAD
+} read_ahead_mode_t;
+
+typedef enum {
+    READ_AHEAD_FILLING = 0,      // Start-up / after a seek, before the first low watermark
+    READ_AHEAD_READY,            // Reads are served from the buffer
+    READ_AHEAD_BUFFERING,        // A read found the ring empty and is waiting for the low watermark
+    READ_AHEAD_EOF,              // Source fully buffered
+    READ_AHEAD_ERROR             // Source read failed; buffered data is still served
+} read_ahead_state_t;
+
+typedef struct {
+    read_ahead_mode_t mode;
+    read_ahead_state_t state;
+    size_t buffered;             // Bytes ahead of the read position
+    size_t capacity;             // Ring size (file size in mmap mode)
+    uint64_t bytes_read;         // From the source
+    unsigned int underruns;      // Reads that had to wait for the I/O thread
+    double last_stall_ms;        // Duration of the most recent underrun
+} read_ahead_stats_t;
+
+typedef struct read_ahead read_ahead_t;
+
+// Pick a mode for url and open it. ring_bytes only applies to thread mode.
+// interrupt_cb is polled while a read waits on an empty ring. NULL on failure.
+read_ahead_t *read_ahead_open(const char *url, size_t ring_bytes, const AVIOInterruptCB *interrupt_cb);
+void read_ahead_close(read_ahead_t *ra);
+
+// AVIOContext to install as AVFormatContext.pb (with AVFMT_FLAG_CUSTOM_IO); owned by ra
+AVIOContext *read_ahead_avio(read_ahead_t *ra);
+
+void read_ahead_get_stats(read_ahead_t *ra, read_ahead_stats_t *out);
+const char *read_ahead_state_name(read_ahead_state_t state);
+
+#endif // READ_AHEAD_H
@@ -0,0 +1,577 @@
+#define _GNU_SOURCE
+#include "startup_cache.h"
+#include "thread_topology.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+
+#define STARTUP_CACHE_VERSION 1
+#define PROGRAM_CACHE_MAGIC 0x42504b50u    // "PKPB"
+#define PROGRAM_NAME_MAX 32
+#define PROGRAM_DRIVER_MAX 192
+#define PROGRAM_BINARY_MAX (4 * 1024 * 1024)
+#define INDEX_CACHE_MAGIC 0x58494b50u      // "PKIX"
+
+typedef struct {
+    char *path;                  // realpath()
+    long long size;
+    long long mtime_sec;
+    long mtime_nsec;
+    startup_media_t media;
+} media_entry_t;
+
+typedef struct {
+    char name[PROGRAM_NAME_MAX];
+    char driver[PROGRAM_DRIVER_MAX];
+    uint32_t source_hash;
+    uint32_t format;
+    uint32_t length;
+    void *binary;
+} program_entry_t;
+
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool loaded = false;
+static bool disabled = false;
+static char system_key[128];
+static char drm_device[PATH_MAX];
+static media_entry_t media[STARTUP_CACHE_MAX_MEDIA];
+static int media_count = 0;
+static program_entry_t programs[STARTUP_CACHE_MAX_PROGRAMS];
+static int program_count = 0;
+static bool media_dirty = false;
+static bool programs_dirty = false;
+static bool flush_running = false;
+
+// Lines longer than this are a corrupt file, not a filename
+#define LINE_MAX_LENGTH (PATH_MAX + 256)
+
+static void load_media_file(void) {
+    FILE *f = fopen(STARTUP_CACHE_FILE, "r");
+    if (!f) {
+        return;
+    }
+    char *line = (char *)malloc(LINE_MAX_LENGTH);
+    if (!line) {
+        fclose(f);
+        return;
+    }
+
+    bool valid = false;
+    while (fgets(line, LINE_MAX_LENGTH, f)) {
+        size_t len = strlen(line);
+        if (len == 0 || line[len - 1] != '\n') {
+            break;  // Truncated by a power cut mid-write of an older, non-atomic copy
+        }
+        line[len - 1] = '\0';
+
+        int version;
+        if (sscanf(line, "version=%d", &version) == 1) {
+            valid = version == STARTUP_CACHE_VERSION;
+        } else if (strncmp(line, "system=", 7) == 0) {
+            // Decisions made under a different kernel (V4L2 driver) are not trusted
+            valid = valid && strcmp(line + 7, system_key) == 0;
+        } else if (!valid) {
+            break;
+        } else if (strncmp(line, "drm_device=", 11) == 0) {
+            snprintf(drm_device, sizeof(drm_device), "%s", line + 11);
+        } else if (strncmp(line, "media ", 6) == 0 && media_count < STARTUP_CACHE_MAX_MEDIA) {
+            media_entry_t *e = &media[media_count];
+            int decode = 0, offset = 0;
+            if (sscanf(line + 6, "%lld %lld %ld %d %d %d %d %d %d %d %d %d %n",
+                       &e->size, &e->mtime_sec, &e->mtime_nsec,
+                       &e->media.stream_index, &e->media.codec_id,
+                       &e->media.width, &e->media.height, &e->media.pix_fmt, &e->media.profile,
+                       &e->media.fps_num, &e->media.fps_den, &decode, &offset) == 12 &&
+                offset > 0 && line[6 + offset] == '/') {
+                e->media.decode = (startup_decode_t)decode;
+                e->path = strdup(line + 6 + offset);
+                if (e->path) {
+                    media_count++;
+                }
+            }
+        }
+    }
+    if (!valid) {
+        // Wrong version or different system: start over (file is rewritten on the next flush)
+        for (int i = 0; i < media_count; i++) {
+            free(media[i].path);
+        }
+        media_count = 0;
+        drm_device[0] = '\0';
+    }
+    free(line);
+    fclose(f);
+}
+
+static bool read_exact(FILE *f, void *dst, size_t size) {
+    return fread(dst, 1, size, f) == size;
+}
+
+static void load_program_file(void) {
+    FILE *f = fopen(STARTUP_CACHE_PROGRAM_FILE, "rb");
+    if (!f) {
+        return;
+    }
+    uint32_t header[3];  // magic, version, count
+    if (!read_exact(f, header, sizeof(header)) || header[0] != PROGRAM_CACHE_MAGIC ||
+        header[1] != STARTUP_CACHE_VERSION) {
+        fclose(f);
+        return;
+    }
+    for (uint32_t i = 0; i < header[2] && program_count < STARTUP_CACHE_MAX_PROGRAMS; i++) {
+        program_entry_t *p = &programs[program_count];
+        uint32_t fields[3];  // source_hash, format, length
+        if (!read_exact(f, p->name, sizeof(p->name)) || !read_exact(f, p->driver, sizeof(p->driver)) ||
+            !read_exact(f, fields, sizeof(fields)) || fields[2] == 0 || fields[2] > PROGRAM_BINARY_MAX) {
+            break;
+        }
+        p->name[sizeof(p->name) - 1] = '\0';
+        p->driver[sizeof(p->driver) - 1] = '\0';
+        p->source_hash = fields[0];
+        p->format = fields[1];
+        p->length = fields[2];
+        p->binary = malloc(p->length);
+        if (!p->binary || !read_exact(f, p->binary, p->length)) {
+            free(p->binary);
+            p->binary = NULL;
+            break;
+        }
+        program_count++;
+    }
+    fclose(f);
+}
+
+// Caller holds cache_lock
+static bool ensure_loaded(void) {
+    if (!loaded) {
+        loaded = true;
+        const char *env = getenv("PICKLE_STARTUP_CACHE");
+        disabled = env && strcmp(env, "0") == 0;
+        if (!disabled) {
+            struct utsname uts;
+            snprintf(system_key, sizeof(system_key), "%s",
+                     uname(&uts) == 0 ? uts.release : "unknown");
+            load_media_file();
+            load_program_file();
+            if (media_count > 0 || program_count > 0) {
+                printf("[CACHE] Loaded %d media and %d program entries\n", media_count, program_count);
+            }
+        }
+    }
+    return !disabled;
+}
+
+// Identity of a regular file: canonical path plus size and mtime
+static bool media_key(const char *path, char *resolved, struct stat *st) {
+    if (!path || strstr(path, "://") || stat(path, st) != 0 || !S_ISREG(st->st_mode)) {
+        return false;
+    }
+    return realpath(path, resolved) != NULL;
+}
+
+static media_entry_t *find_media(const char *resolved) {
+    for (int i = 0; i < media_count; i++) {
+        if (strcmp(media[i].path, resolved) == 0) {
+            return &media[i];
+        }
+    }
+    return NULL;
+}
+
+static bool media_matches(const media_entry_t *e, const struct stat *st) {
+    return e->size == (long long)st->st_size &&
+           e->mtime_sec == (long long)st->st_mtim.tv_sec &&
+           e->mtime_nsec == st->st_mtim.tv_nsec;
+}
+
+bool startup_cache_get_media(const char *path, startup_media_t *out) {
+    char resolved[PATH_MAX];
+    struct stat st;
+    if (!media_key(path, resolved, &st)) {
+        return false;
+    }
+    bool hit = false;
+    pthread_mutex_lock(&cache_lock);
+    if (ensure_loaded()) {
+        media_entry_t *e = find_media(resolved);
+        if (e && media_matches(e, &st)) {
+            *out = e->media;
+            hit = true;
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+    return hit;
+}
+
+void startup_cache_put_media(const char *path, const startup_media_t *params) {
+    char resolved[PATH_MAX];
+    struct stat st;
+    if (!media_key(path, resolved, &st)) {
+        return;
+    }
+    pthread_mutex_lock(&cache_lock);
+    if (ensure_loaded()) {
+        media_entry_t *e = find_media(resolved);
+        startup_decode_t decode = params->decode;
+        if (e && media_matches(e, &st) && decode == STARTUP_DECODE_UNKNOWN) {
+            decode = e->media.decode;  // Same file: the earlier decision still holds
+        }
+        if (!e || !media_matches(e, &st) || memcmp(&e->media, params, sizeof(*params)) != 0 ||
+            e->media.decode != decode) {
+            if (!e) {
+                if (media_count == STARTUP_CACHE_MAX_MEDIA) {
+                    free(media[0].path);
+                    memmove(&media[0], &media[1], sizeof(media[0]) * (STARTUP_CACHE_MAX_MEDIA - 1));
+                    media_count--;
+                }
+                e = &media[media_count];
+                e->path = strdup(resolved);
+                if (e->path) {
+                    media_count++;
+                }
+            }
+            if (e->path) {
+                e->size = (long long)st.st_size;
+                e->mtime_sec = (long long)st.st_mtim.tv_sec;
+                e->mtime_nsec = st.st_mtim.tv_nsec;
+                e->media = *params;
+                e->media.decode = decode;
+                media_dirty = true;
+            }
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
+
+void startup_cache_set_decode(const char *path, startup_decode_t decode) {
+    char resolved[PATH_MAX];
+    struct stat st;
+    if (!media_key(path, resolved, &st)) {
+        return;
+    }
+    pthread_mutex_lock(&cache_lock);
+    if (ensure_loaded()) {
+        media_entry_t *e = find_media(resolved);
+        if (e && media_matches(e, &st) && e->media.decode != decode) {
+            e->media.decode = decode;
+            media_dirty = true;
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
+
+bool startup_cache_get_drm_device(char *out, size_t size) {
+    bool hit = false;
+    pthread_mutex_lock(&cache_lock);
+    if (ensure_loaded() && drm_device[0]) {
+        snprintf(out, size, "%s", drm_device);
+        hit = true;
+    }
+    pthread_mutex_unlock(&cache_lock);
+    return hit;
+}
+
+void startup_cache_put_drm_device(const char *device) {
+    pthread_mutex_lock(&cache_lock);
+    if (ensure_loaded() && strcmp(drm_device, device) != 0) {
+        snprintf(drm_device, sizeof(drm_device), "%s", device);
+        media_dirty = true;
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
+
+static program_entry_t *find_program(const char *name) {
+    for (int i = 0; i < program_count; i++) {
+        if (strncmp(programs[i].name, name, sizeof(programs[i].name)) == 0) {
+            return &programs[i];
+        }
+    }
+    return NULL;
+}
+
+void *startup_cache_get_program(const char *name, const char *driver, uint32_t source_hash,
+                                uint32_t *format, int *length) {
+    void *copy = NULL;
+    pthread_mutex_lock(&cache_lock);
+    if (ensure_loaded()) {
+        program_entry_t *p = find_program(name);
+        if (p && p->source_hash == source_hash && strncmp(p->driver, driver, sizeof(p->driver)) == 0) {
+            copy = malloc(p->length);
+            if (copy) {
+                memcpy(copy, p->binary, p->length);
+                *format = p->format;
+                *length = (int)p->length;
+            }
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+    return copy;
+}
+
+void startup_cache_put_program(const char *name, const char *driver, uint32_t source_hash,
+                               uint32_t format, const void *binary, int length) {
+    if (length <= 0 || length > PROGRAM_BINARY_MAX) {
+        return;
+    }
+    void *copy = malloc((size_t)length);
+    if (!copy) {
+        return;
+    }
+    memcpy(copy, binary, (size_t)length);
+
+    pthread_mutex_lock(&cache_lock);
+    if (!ensure_loaded()) {
+        pthread_mutex_unlock(&cache_lock);
+        free(copy);
+        return;
+    }
+    program_entry_t *p = find_program(name);
+    if (!p && program_count < STARTUP_CACHE_MAX_PROGRAMS) {
+        p = &programs[program_count++];
+        memset(p, 0, sizeof(*p));
+        snprintf(p->name, sizeof(p->name), "%s", name);
+    }
+    if (p) {
+        free(p->binary);
+        snprintf(p->driver, sizeof(p->driver), "%s", driver);
+        p->source_hash = source_hash;
+        p->format = format;
+        p->length = (uint32_t)length;
+        p->binary = copy;
+        programs_dirty = true;
+    } else {
+        free(copy);
+    }
+    pthread_mutex_unlock(&cache_lock);
+}
+
+// FNV-1a over both strings (vertex and fragment source)
+uint32_t startup_cache_hash(const char *a, const char *b) {
+    uint32_t hash = 2166136261u;
+    const char *parts[2] = { a, b };
+    for (int i = 0; i < 2; i++) {
+        for (const unsigned char *c = (const unsigned char *)parts[i]; c && *c; c++) {
+            hash = (hash ^ *c) * 16777619u;
+        }
+        hash = (hash ^ 0xffu) * 16777619u;  // Separator so ("ab","c") != ("a","bc")
+    }
+    return hash;
+}
+
+// Write to name.tmp, fsync, rename: a power cut leaves the old or the new file, never half of one
+static FILE *open_temp(const char *name, char *tmp, size_t size) {
+    snprintf(tmp, size, "%s.tmp", name);
+    return fopen(tmp, "wb");
+}
+
+static int commit_temp(FILE *f, const char *tmp, const char *name, const char *dir_name, bool ok) {
+    ok = fflush(f) == 0 && ok;
+    ok = fsync(fileno(f)) == 0 && ok;
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmp, name) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+    // Make the rename itself durable
+    int dir = open(dir_name, O_RDONLY | O_DIRECTORY);
+    if (dir >= 0) {
+        fsync(dir);
+        close(dir);
+    }
+    return 0;
+}
+
+// Caller holds cache_lock
+static int write_media_file(void) {
+    char tmp[PATH_MAX];
+    FILE *f = open_temp(STARTUP_CACHE_FILE, tmp, sizeof(tmp));
+    if (!f) {
+        return -1;
+    }
+    bool ok = fprintf(f, "version=%d\nsystem=%s\n", STARTUP_CACHE_VERSION, system_key) > 0;
+    if (drm_device[0]) {
+        ok = fprintf(f, "drm_device=%s\n", drm_device) > 0 && ok;
+    }
+    for (int i = 0; i < media_count; i++) {
+        const media_entry_t *e = &media[i];
+        if (strchr(e->path, '\n')) {
+            continue;
+        }
+        ok = fprintf(f, "media %lld %lld %ld %d %d %d %d %d %d %d %d %d %s\n",
+                     e->size, e->mtime_sec, e->mtime_nsec,
+                     e->media.stream_index, e->media.codec_id,
+                     e->media.width, e->media.height, e->media.pix_fmt, e->media.profile,
+                     e->media.fps_num, e->media.fps_den, (int)e->media.decode, e->path) > 0 && ok;
+    }
+    return commit_temp(f, tmp, STARTUP_CACHE_FILE, ".", ok);
+}
+
+// Caller holds cache_lock
+static int write_program_file(void) {
+    char tmp[PATH_MAX];
+    FILE *f = open_temp(STARTUP_CACHE_PROGRAM_FILE, tmp, sizeof(tmp));
+    if (!f) {
+        return -1;
+    }
+    uint32_t header[3] = { PROGRAM_CACHE_MAGIC, STARTUP_CACHE_VERSION, (uint32_t)program_count };
+    bool ok = fwrite(header, sizeof(header), 1, f) == 1;
+    for (int i = 0; i < program_count && ok; i++) {
+        const program_entry_t *p = &programs[i];
+        uint32_t fields[3] = { p->source_hash, p->format, p->length };
+        ok = fwrite(p->name, sizeof(p->name), 1, f) == 1 &&
+             fwrite(p->driver, sizeof(p->driver), 1, f) == 1 &&
+             fwrite(fields, sizeof(fields), 1, f) == 1 &&
+             fwrite(p->binary, p->length, 1, f) == 1;
+    }
+    return commit_temp(f, tmp, STARTUP_CACHE_PROGRAM_FILE, ".", ok);
+}
+
+// Index sidecars are written by their builder thread when complete, not by the flush
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint32_t path_length;        // Canonical path follows the header (a hash collision is a miss)
+    uint32_t payload_length;
+} index_header_t;
+
+static void index_file_name(const char *resolved, char *out, size_t size) {
+    snprintf(out, size, "%s/%08x.idx", STARTUP_CACHE_INDEX_DIR, startup_cache_hash(resolved, NULL));
+}
+
+static bool index_enabled(void) {
+    pthread_mutex_lock(&cache_lock);
+    bool enabled = ensure_loaded();
+    pthread_mutex_unlock(&cache_lock);
+    return enabled;
+}
+
+void *startup_cache_get_index(const char *path, size_t *size) {
+    char resolved[PATH_MAX];
+    struct stat st;
+    if (!media_key(path, resolved, &st) || !index_enabled()) {
+        return NULL;
+    }
+    char name[PATH_MAX];
+    index_file_name(resolved, name, sizeof(name));
+    FILE *f = fopen(name, "rb");
+    if (!f) {
+        return NULL;
+    }
+
+    index_header_t header;
+    char stored[PATH_MAX];
+    void *payload = NULL;
+    if (read_exact(f, &header, sizeof(header)) && header.magic == INDEX_CACHE_MAGIC &&
+        header.version == STARTUP_CACHE_VERSION && header.size == (int64_t)st.st_size &&
+        header.mtime_sec == (int64_t)st.st_mtim.tv_sec && header.mtime_nsec == (int64_t)st.st_mtim.tv_nsec &&
+        header.path_length < sizeof(stored) && read_exact(f, stored, header.path_length) &&
+        header.payload_length > 0 && header.payload_length <= STARTUP_CACHE_INDEX_MAX) {
+        stored[header.path_length] = '\0';
+        if (strcmp(stored, resolved) == 0) {
+            payload = malloc(header.payload_length);
+            if (payload && !read_exact(f, payload, header.payload_length)) {
+                free(payload);
+                payload = NULL;
+            }
+        }
+    }
+    fclose(f);
+    if (payload) {
+        *size = header.payload_length;
+    }
+    return payload;
+}
+
+int startup_cache_put_index(const char *path, const void *data, size_t size) {
+    char resolved[PATH_MAX];
+    struct stat st;
+    if (size == 0 || size > STARTUP_CACHE_INDEX_MAX || !media_key(path, resolved, &st) || !index_enabled()) {
+        return -1;
+    }
+    if (mkdir(STARTUP_CACHE_INDEX_DIR, 0755) != 0 && errno != EEXIST) {
+        return -1;
+    }
+    char name[PATH_MAX];
+    char tmp[PATH_MAX + 8];
+    index_file_name(resolved, name, sizeof(name));
+    FILE *f = open_temp(name, tmp, sizeof(tmp));
+    if (!f) {
+        return -1;
+    }
+    index_header_t header = {
+        .magic = INDEX_CACHE_MAGIC,
+        .version = STARTUP_CACHE_VERSION,
+        .size = (int64_t)st.st_size,
+        .mtime_sec = (int64_t)st.st_mtim.tv_sec,
+        .mtime_nsec = (int64_t)st.st_mtim.tv_nsec,
+        .path_length = (uint32_t)strlen(resolved),
+        .payload_length = (uint32_t)size,
+    };
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(resolved, header.path_length, 1, f) == 1 &&
+              fwrite(data, size, 1, f) == 1;
+    return commit_temp(f, tmp, name, STARTUP_CACHE_INDEX_DIR, ok);
+}
+
+int startup_cache_flush(void) {
+    int ret = 0;
+    pthread_mutex_lock(&cache_lock);
+    if (loaded && !disabled) {
+        if (media_dirty) {
+            if (write_media_file() == 0) {
+                media_dirty = false;
+            } else {
+                ret = -1;
+            }
+        }
+        if (programs_dirty) {
+            if (write_program_file() == 0) {
+                programs_dirty = false;
+            } else {
+                ret = -1;
+            }
+        }
+        if (ret != 0) {
+            fprintf(stderr, "[CACHE] Failed to write startup cache (read-only directory?)\n");
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+    return ret;
+}
+
+static void *flush_thread_main(void *arg) {
+    (void)arg;
+    thread_topology_set_name("pickle-cache");
+    thread_topology_bind_housekeeping();  // fsync must not run on the render core under FIFO
+    startup_cache_flush();
+    __atomic_store_n(&flush_running, false, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+void startup_cache_flush_async(void) {
+    // fsync on an SD card can take tens of milliseconds: keep it off the render thread
+    pthread_mutex_lock(&cache_lock);
+    bool dirty = media_dirty || programs_dirty;
+    pthread_mutex_unlock(&cache_lock);
+    if (!dirty || __atomic_exchange_n(&flush_running, true, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, flush_thread_main, NULL) != 0) {
+        __atomic_store_n(&flush_running, false, __ATOMIC_RELEASE);
+    }
+    pthread_attr_destroy(&attr);
+}
@@ -0,0 +1,70 @@
+#ifndef STARTUP_CACHE_H
+#define STARTUP_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Persistent cold-start cache, kept next to the keystone settings (working
+// directory) so the next power-on skips work whose answer cannot have changed:
+//   pickle_startup.cache - per-file stream parameters and the hardware/software
+//                          decode decision (keyed by path, size and mtime), and
+//                          the DRM device that worked; all keyed by kernel release
+//   pickle_programs.bin  - glGetProgramBinary blobs, keyed by GL vendor/renderer/
+//                          version and a hash of the shader sources
+//   pickle_index/        - one keyframe index sidecar per media file (keyframe_index.h),
+//                          named by a hash of the path, valid for its size and mtime
+// Files are replaced atomically (write, fsync, rename): players are switched
+// off at the wall. PICKLE_STARTUP_CACHE=0 disables the cache entirely.
+#define STARTUP_CACHE_FILE "pickle_startup.cache"
+#define STARTUP_CACHE_PROGRAM_FILE "pickle_programs.bin"
+#define STARTUP_CACHE_INDEX_DIR "pickle_index"
+#define STARTUP_CACHE_INDEX_MAX (64 * 1024 * 1024)  // Largest sidecar payload accepted
+#define STARTUP_CACHE_MAX_MEDIA 128         // Least recently stored entries are dropped first
+#define STARTUP_CACHE_MAX_PROGRAMS 8
+#define STARTUP_CACHE_SETTLE_FRAMES 300     // Render loop writes runtime decisions after this many frames
+
+typedef enum {
+    STARTUP_DECODE_UNKNOWN = 0,
+    STARTUP_DECODE_HW,           // Hardware decoder produced frames
+    STARTUP_DECODE_SW            // Hardware decoder failed on this file: go straight to software
+} startup_decode_t;
+
+typedef struct {
+    int stream_index;
+    int codec_id;
+    int width;
+    int height;
+    int pix_fmt;
+    int profile;
+    int fps_num;                 // r_frame_rate
+    int fps_den;
+    startup_decode_t decode;
+} startup_media_t;
+
+// Regular files only: false for URLs, missing files, or when the file changed
+bool startup_cache_get_media(const char *path, startup_media_t *out);
+// Keeps the stored decode decision when media->decode is UNKNOWN
+void startup_cache_put_media(const char *path, const startup_media_t *media);
+void startup_cache_set_decode(const char *path, startup_decode_t decode);
+
+bool startup_cache_get_drm_device(char *out, size_t size);
+void startup_cache_put_drm_device(const char *device);
+
+// Returns a malloc'd copy of the blob (caller frees), NULL on a miss
+void *startup_cache_get_program(const char *name, const char *driver, uint32_t source_hash,
+                                uint32_t *format, int *length);
+void startup_cache_put_program(const char *name, const char *driver, uint32_t source_hash,
+                               uint32_t format, const void *binary, int length);
+uint32_t startup_cache_hash(const char *a, const char *b);
+
+// Keyframe index sidecar for a regular file: the payload is opaque here. get returns a
+// malloc'd copy (caller frees) or NULL; put writes synchronously, so call it off the render thread.
+void *startup_cache_get_index(const char *path, size_t *size);
+int startup_cache_put_index(const char *path, const void *data, size_t size);
+
+// Write whatever changed. The async variant runs on a short-lived thread.
+int startup_cache_flush(void);
+void startup_cache_flush_async(void);
+
+#endif // STARTUP_CACHE_H
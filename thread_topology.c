@@ -0,0 +1,198 @@
+#define _GNU_SOURCE  // CPU_SET, pthread_setaffinity_np, pthread_setname_np
+#include "thread_topology.h"
+#include "production_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+static thread_topology_t topology;
+
+static int env_int(const char *name, int fallback) {
+    const char *env = getenv(name);
+    if (!env || !env[0]) {
+        return fallback;
+    }
+    char *end = NULL;
+    long value = strtol(env, &end, 10);
+    return (end && *end == '\0') ? (int)value : fallback;
+}
+
+int thread_topology_init(int stream_count) {
+    memset(&topology, 0, sizeof(topology));
+    topology.render_core = -1;
+    topology.stream_count = stream_count < 1 ? 1 :
+                            (stream_count > THREAD_TOPO_MAX_STREAMS ? THREAD_TOPO_MAX_STREAMS : stream_count);
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    topology.online_cores = cores > 0 ? (int)cores : 1;
+    if (topology.online_cores > (int)(sizeof(topology.decode_cores) / sizeof(topology.decode_cores[0]))) {
+        topology.online_cores = (int)(sizeof(topology.decode_cores) / sizeof(topology.decode_cores[0]));
+    }
+
+    const char *env = getenv("PICKLE_RT");
+    if (!env || env[0] != '1') {
+        return 0;
+    }
+    if (topology.online_cores < 2) {
+        printf("[RT] PICKLE_RT=1 ignored: %d online core(s), nothing to partition\n", topology.online_cores);
+        return 0;
+    }
+
+    int render_core = env_int("PICKLE_RENDER_CORE", topology.online_cores - 1);
+    if (render_core < 0 || render_core >= topology.online_cores) {
+        fprintf(stderr, "[RT] PICKLE_RENDER_CORE=%d out of range, using core %d\n",
+                render_core, topology.online_cores - 1);
+        render_core = topology.online_cores - 1;
+    }
+    int priority = env_int("PICKLE_RT_PRIORITY", THREAD_TOPO_DEFAULT_PRIORITY);
+    int max_priority = sched_get_priority_max(SCHED_FIFO);
+    // Plane worker runs one below the render thread, so 2 is the floor
+    if (priority < 2) priority = 2;
+    if (max_priority > 0 && priority > max_priority) priority = max_priority;
+
+    topology.enabled = true;
+    topology.render_core = render_core;
+    topology.render_priority = priority;
+    for (int core = 0; core < topology.online_cores; core++) {
+        if (core != render_core) {
+            topology.decode_cores[topology.decode_core_count++] = core;
+        }
+    }
+
+    // Contiguous shares of the decode cores; with more streams than cores the
+    // shares wrap and streams double up on a core
+    int per_stream = topology.decode_core_count / topology.stream_count;
+    if (per_stream < 1) per_stream = 1;
+    for (int i = 0; i < topology.stream_count; i++) {
+        topology.stream_first_core[i] = (i * per_stream) % topology.decode_core_count;
+        topology.stream_core_count[i] = per_stream;
+    }
+    // Cores that don't divide evenly go to the last stream's share
+    int leftover = topology.decode_core_count - per_stream * topology.stream_count;
+    if (leftover > 0) {
+        topology.stream_core_count[topology.stream_count - 1] += leftover;
+    }
+
+    printf("[RT] Render thread on core %d (SCHED_FIFO %d), %d decode core(s) for %d stream(s)\n",
+           render_core, priority, topology.decode_core_count, topology.stream_count);
+    for (int i = 0; i < topology.stream_count; i++) {
+        printf("[RT]   stream %d: cores", i + 1);
+        for (int c = 0; c < topology.stream_core_count[i]; c++) {
+            int index = (topology.stream_first_core[i] + c) % topology.decode_core_count;
+            printf(" %d", topology.decode_cores[index]);
+        }
+        printf(", %d FFmpeg thread(s)\n", thread_topology_decode_budget());
+    }
+    return 0;
+}
+
+const thread_topology_t *thread_topology_get(void) {
+    return &topology;
+}
+
+int thread_topology_decode_budget(void) {
+    if (!topology.enabled) {
+        return 0;
+    }
+    // Smallest share, so every stream's decoder fits its cores; capped by the build default
+    int budget = topology.decode_core_count / topology.stream_count;
+    if (budget < 1) budget = 1;
+    if (budget > DECODE_THREAD_COUNT) budget = DECODE_THREAD_COUNT;
+    return budget;
+}
+
+static void bind_current_thread(const cpu_set_t *cpus, int policy, int priority, const char *role) {
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(*cpus), cpus);
+    if (ret != 0) {
+        fprintf(stderr, "[RT] Failed to set %s affinity: %s\n", role, strerror(ret));
+    }
+
+    struct sched_param param = { .sched_priority = priority };
+    ret = pthread_setschedparam(pthread_self(), policy, &param);
+    if (ret != 0) {
+        // EPERM without CAP_SYS_NICE / an rtprio limit: stay pinned under SCHED_OTHER
+        static bool warned = false;
+        if (!warned) {
+            fprintf(stderr, "[RT] Cannot set %s scheduling policy: %s (run as root or raise rtprio)\n",
+                    role, strerror(ret));
+            warned = true;
+        }
+    }
+}
+
+void thread_topology_bind_render(void) {
+    if (!topology.enabled) {
+        return;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(topology.render_core, &cpus);
+    bind_current_thread(&cpus, SCHED_FIFO, topology.render_priority, "render");
+}
+
+void thread_topology_bind_plane_worker(void) {
+    if (!topology.enabled) {
+        return;
+    }
+    // Shares the render core: it only issues KMS ioctls between the render thread's flips
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(topology.render_core, &cpus);
+    bind_current_thread(&cpus, SCHED_FIFO, topology.render_priority - 1, "plane worker");
+}
+
+void thread_topology_bind_stream(int stream) {
+    if (!topology.enabled) {
+        return;
+    }
+    if (stream < 0 || stream >= topology.stream_count) {
+        stream = 0;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int c = 0; c < topology.stream_core_count[stream]; c++) {
+        int index = (topology.stream_first_core[stream] + c) % topology.decode_core_count;
+        CPU_SET(topology.decode_cores[index], &cpus);
+    }
+    // Explicit SCHED_OTHER: the creator may be an RT thread
+    bind_current_thread(&cpus, SCHED_OTHER, 0, "decode");
+}
+
+void thread_topology_bind_housekeeping(void) {
+    if (!topology.enabled) {
+        return;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int c = 0; c < topology.decode_core_count; c++) {
+        CPU_SET(topology.decode_cores[c], &cpus);
+    }
+    bind_current_thread(&cpus, SCHED_OTHER, 0, "housekeeping");
+}
+
+void thread_topology_set_name(const char *name) {
+    if (!name) {
+        return;
+    }
+    char truncated[16];
+    snprintf(truncated, sizeof(truncated), "%s", name);
+    pthread_setname_np(pthread_self(), truncated);
+}
+
+void thread_topology_lock_memory(void) {
+    const char *env = getenv("PICKLE_MLOCK");
+    if (!env || env[0] != '1' || topology.memory_locked) {
+        return;
+    }
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        fprintf(stderr, "[RT] mlockall failed: %s (check RLIMIT_MEMLOCK)\n", strerror(errno));
+        return;
+    }
+    topology.memory_locked = true;
+    printf("[RT] Process memory locked (PICKLE_MLOCK=1)\n");
+}
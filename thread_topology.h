@@ -0,0 +1,51 @@
+#ifndef THREAD_TOPOLOGY_H
+#define THREAD_TOPOLOGY_H
+
+#include <stdbool.h>
+
+// Core partitioning for the player's threads. With PICKLE_RT=1 the render
+// loop (and the legacy plane worker) own one core under SCHED_FIFO, and each
+// stream's decode threads are pinned to a share of the remaining cores with a
+// matching FFmpeg thread budget. Without it only thread names are applied.
+//
+// Linux threads inherit affinity and policy from their creator, so FFmpeg's
+// frame threads land wherever the thread calling avcodec_open2() is bound:
+// bind to the stream before video_init(), bind to render only afterwards.
+#define THREAD_TOPO_MAX_STREAMS 4
+#define THREAD_TOPO_DEFAULT_PRIORITY 50   // SCHED_FIFO priority of the render thread (PICKLE_RT_PRIORITY)
+
+typedef struct {
+    bool enabled;              // PICKLE_RT=1 and enough cores to partition
+    int online_cores;
+    int render_core;           // PICKLE_RENDER_CORE (default: last core)
+    int render_priority;
+    int stream_count;
+    int stream_first_core[THREAD_TOPO_MAX_STREAMS];  // Index into decode_cores
+    int stream_core_count[THREAD_TOPO_MAX_STREAMS];
+    int decode_cores[64];
+    int decode_core_count;
+    bool memory_locked;        // PICKLE_MLOCK=1 succeeded
+} thread_topology_t;
+
+// Read the environment and plan the partition for stream_count streams
+int thread_topology_init(int stream_count);
+const thread_topology_t *thread_topology_get(void);
+
+// FFmpeg threads per stream decoder (0 = FFmpeg auto-detect, topology disabled)
+int thread_topology_decode_budget(void);
+
+// Bind the calling thread. Each is a no-op (apart from logging once) when disabled.
+void thread_topology_bind_render(void);
+void thread_topology_bind_plane_worker(void);
+void thread_topology_bind_stream(int stream);
+// Background helpers (governor, cache writer): any decode core, SCHED_OTHER. For
+// threads the render thread starts, which would otherwise inherit its core and FIFO.
+void thread_topology_bind_housekeeping(void);
+
+// Thread name for perf/htop (truncated to 15 characters)
+void thread_topology_set_name(const char *name);
+
+// PICKLE_MLOCK=1: mlockall() so steady-state playback never stalls on a page fault
+void thread_topology_lock_memory(void);
+
+#endif // THREAD_TOPOLOGY_H
@@ -171,6 +171,77 @@ int convert_sample_avcc_to_annexb_inplace(uint8_t *sample, size_t sample_len, in
     return (int)write_pos;
 }
 
+static uint32_t read_nal_length(const uint8_t *p, int length_size)
+{
+    uint32_t nal_size = 0;
+    for (int i = 0; i < length_size; ++i) {
+        nal_size = (nal_size << 8) | p[i];
+    }
+    return nal_size;
+}
+
+// Walk the NAL units of an avcC sample without modifying it
+int scan_avcc_sample(const uint8_t *sample, size_t sample_len, int length_size, avcc_sample_info_t *info)
+{
+    if (!sample || !info || length_size < 1 || length_size > 4) {
+        return -1;
+    }
+    
+    memset(info, 0, sizeof(*info));
+    size_t pos = 0;
+    bool first = true;
+    while (pos + length_size <= sample_len) {
+        uint32_t nal_size = read_nal_length(sample + pos, length_size);
+        pos += length_size;
+        if (nal_size > sample_len - pos) {
+            return -1;
+        }
+        
+        if (nal_size > 0) {
+            int nal_type = sample[pos] & 0x1f;
+            if (nal_type == 5) {
+                info->has_idr = true;
+            } else if (nal_type == 7 || nal_type == 8) {
+                info->has_parameter_sets = true;
+            } else if (nal_type == 9 && first) {
+                info->starts_with_aud = true;
+            }
+            first = false;
+        }
+        
+        info->annexb_size += 4 + nal_size;
+        pos += nal_size;
+    }
+    
+    return 0;
+}
+
+// Convert NAL-length prefixed samples to Annex-B into a separate buffer
+int convert_sample_avcc_to_annexb(const uint8_t *sample, size_t sample_len, int length_size,
+                                  uint8_t *out, size_t out_size)
+{
+    if (!sample || !out || length_size < 1 || length_size > 4) {
+        return -1;
+    }
+    
+    size_t read_pos = 0;
+    size_t write_pos = 0;
+    while (read_pos + length_size <= sample_len) {
+        uint32_t nal_size = read_nal_length(sample + read_pos, length_size);
+        read_pos += length_size;
+        if (nal_size > sample_len - read_pos || write_pos + 4 + nal_size > out_size) {
+            return -1;
+        }
+        
+        memcpy(out + write_pos, "\x00\x00\x00\x01", 4);
+        memcpy(out + write_pos + 4, sample + read_pos, nal_size);
+        read_pos += nal_size;
+        write_pos += 4 + nal_size;
+    }
+    
+    return (int)write_pos;
+}
+
 // Extract length size from avcC extradata
 int get_avcc_length_size(const uint8_t *avcc, size_t avcc_len)
 {
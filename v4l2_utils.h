@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 // Convert avcC extradata to Annex-B format (SPS/PPS with 0x00000001 prefixes)
 // in: avcc pointer/length  
@@ -18,6 +19,24 @@ int avcc_extradata_to_annexb(const uint8_t *avcc, size_t avcc_len,
 // returns: new length after conversion, or -1 on error
 int convert_sample_avcc_to_annexb_inplace(uint8_t *sample, size_t sample_len, int length_size);
 
+// What one NAL-length prefixed sample contains, from a single pass over it
+typedef struct {
+    size_t annexb_size;          // Bytes after conversion (4-byte start code per NAL unit)
+    bool has_idr;
+    bool has_parameter_sets;     // SPS or PPS carried in-band
+    bool starts_with_aud;
+} avcc_sample_info_t;
+
+// Walk the NAL units of an avcC sample without modifying it
+// returns: 0 on success, -1 if a length runs past the buffer
+int scan_avcc_sample(const uint8_t *sample, size_t sample_len, int length_size, avcc_sample_info_t *info);
+
+// Convert NAL-length prefixed samples to Annex-B into a separate buffer
+// (any length_size; out must hold info.annexb_size bytes)
+// returns: bytes written, or -1 on error
+int convert_sample_avcc_to_annexb(const uint8_t *sample, size_t sample_len, int length_size,
+                                  uint8_t *out, size_t out_size);
+
 // Extract length size from avcC extradata
 // avcc: pointer to avcC extradata
 // avcc_len: length of extradata
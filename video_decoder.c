@@ -1,6 +1,10 @@
 #define _GNU_SOURCE
 #include "video_decoder.h"
 #include "v4l2_utils.h"
+#include "pixel_kernels.h"
+#include "metrics.h"
+#include "startup_cache.h"
+#include "logger.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -10,16 +14,19 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <fcntl.h>
+#include <math.h>
+#include <time.h>
 #include <linux/videodev2.h>
+#include <linux/dma-buf.h>
 #include <libavutil/opt.h>
 #include <libavutil/pixdesc.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/frame.h>
 #include <libavutil/hwcontext.h>
 #include <libavutil/hwcontext_drm.h>
+#include <drm_fourcc.h>
 #include <libavutil/time.h>
 #include <libavcodec/avcodec.h>
-#include <libavcodec/bsf.h>
 
 // Configuration Constants
 #define MAX_PACKETS_PER_DECODE_CALL 50
@@ -35,15 +42,111 @@
 #define DEFAULT_FPS_FALLBACK 30.0
 #define AVCC_EXTRADATA_SIZE 8
 
+// Live mode (video_set_live_mode)
+#define LIVE_PROBE_SIZE "32768"                 // Bytes read to identify the stream
+#define LIVE_ANALYZE_DURATION_US "100000"       // Enough for SDP/in-band parameter sets, not a GOP
+#define LIVE_OFFSET_RELAX 0.001                 // Receive-clock offset creep (s per s) to follow drift
+#define LIVE_OFFSET_RESYNC_SECONDS 2.0          // Offset jump treated as a source timestamp reset
+
 // ============================================================================
 // Zero-copy video decoding implementation for RPi4 V3D GPU
 
 // Debug flag for hardware decode diagnostics
 bool hw_debug_enabled = false;
 
+// FFmpeg thread_count for CPU-side decoding (0 = auto), see video_set_thread_budget()
+static int decode_thread_budget = 0;
+
+void video_set_thread_budget(int threads) {
+    decode_thread_budget = threads > 0 ? threads : 0;
+}
+
+// Low-latency tuning for live sources, see video_set_live_mode()
+static bool live_mode = false;
+
+void video_set_live_mode(bool live) {
+    live_mode = live;
+}
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// OPTIMIZATION: Frame threads hold back one frame per thread before the first
+// output, and B-frame reordering waits for the next reference - both are pure
+// latency for a camera feed. Slice threads still use the cores when the
+// encoder emits several slices per picture.
+static void apply_live_codec_flags(AVCodecContext *ctx) {
+    ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    ctx->flags2 |= AV_CODEC_FLAG2_FAST;
+    ctx->thread_type = FF_THREAD_SLICE;
+}
+
 // See ZERO_COPY_ARCHITECTURE.md for detailed architecture documentation
 // ============================================================================
 
+// Plane layout for frames decoded into video_frame_allocator_t memory: one buffer,
+// Y then U then V, rows padded for FFmpeg's SIMD and its edge emulation
+#define FRAME_ALLOC_ROW_ALIGN 128
+
+static size_t frame_alloc_layout(AVCodecContext *ctx, int width, int height,
+                                 int linesize[3], size_t offset[3]) {
+    int linesize_align[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(ctx, &width, &height, linesize_align);
+    
+    // Luma aligned to 128 keeps the half-width chroma rows 64-byte aligned
+    int luma = (width + FRAME_ALLOC_ROW_ALIGN - 1) & ~(FRAME_ALLOC_ROW_ALIGN - 1);
+    int chroma_h = (height + 1) / 2;
+    linesize[0] = luma;
+    linesize[1] = luma / 2;
+    linesize[2] = luma / 2;
+    
+    offset[0] = 0;
+    offset[1] = (size_t)luma * height;
+    offset[2] = offset[1] + (size_t)linesize[1] * chroma_h;
+    return offset[2] + (size_t)linesize[2] * chroma_h + AV_INPUT_BUFFER_PADDING_SIZE;
+}
+
+static void frame_alloc_buffer_free(void *opaque, uint8_t *data) {
+    video_context_t *video = (video_context_t *)opaque;
+    video->frame_allocator.release(video->frame_allocator.opaque, data);
+}
+
+// get_buffer2 for software decode: YUV420P frames go to the frame allocator,
+// anything else (or an exhausted allocator) uses FFmpeg's own pool
+static int frame_alloc_get_buffer2(AVCodecContext *ctx, AVFrame *frame, int flags) {
+    video_context_t *video = (video_context_t *)ctx->opaque;
+    video_frame_allocator_t *allocator = video ? &video->frame_allocator : NULL;
+    
+    if (!allocator || !allocator->alloc ||
+        (frame->format != AV_PIX_FMT_YUV420P && frame->format != AV_PIX_FMT_YUVJ420P) ||
+        !(ctx->codec->capabilities & AV_CODEC_CAP_DR1)) {
+        return avcodec_default_get_buffer2(ctx, frame, flags);
+    }
+    
+    int linesize[3];
+    size_t offset[3];
+    size_t size = frame_alloc_layout(ctx, frame->width, frame->height, linesize, offset);
+    uint8_t *data = allocator->alloc(allocator->opaque, size);
+    if (!data) {
+        return avcodec_default_get_buffer2(ctx, frame, flags);
+    }
+    
+    frame->buf[0] = av_buffer_create(data, size, frame_alloc_buffer_free, video, 0);
+    if (!frame->buf[0]) {
+        allocator->release(allocator->opaque, data);
+        return AVERROR(ENOMEM);
+    }
+    for (int i = 0; i < 3; i++) {
+        frame->data[i] = data + offset[i];
+        frame->linesize[i] = linesize[i];
+    }
+    frame->extended_data = frame->data;
+    return 0;
+}
+
 // PRODUCTION: Interrupt callback to prevent infinite hangs on network streams
 // Returns 1 to abort, 0 to continue
 static int interrupt_callback(void* opaque) {
@@ -197,6 +300,73 @@ static enum AVPixelFormat get_format_callback(AVCodecContext *ctx, const enum AV
 //
 // The decoded frames will then have real DMA-BUF file descriptors in their AVDRMFrameDescriptor.
 
+// Create the DRM hwdevice context on the display's DRM device (card1, then card0)
+static int create_drm_hwdevice(video_context_t *video) {
+    const char *drm_device = "/dev/dri/card1";
+    if (hw_debug_enabled) {
+        printf("[HWACCEL] Attempting DRM device: %s\n", drm_device);
+    }
+    int ret = av_hwdevice_ctx_create(&video->hw_device_ctx, AV_HWDEVICE_TYPE_DRM, 
+                                     drm_device, NULL, 0);
+    if (ret < 0) {
+        if (hw_debug_enabled) {
+            printf("[HWACCEL] card1 failed (%s), trying card0\n", av_err2str(ret));
+        }
+        drm_device = "/dev/dri/card0";
+        ret = av_hwdevice_ctx_create(&video->hw_device_ctx, AV_HWDEVICE_TYPE_DRM, 
+                                     drm_device, NULL, 0);
+        if (ret < 0) {
+            fprintf(stderr, "[HWACCEL] Failed to create DRM device context: %s\n", av_err2str(ret));
+            return -1;
+        }
+    }
+    if (hw_debug_enabled) {
+        printf("[HWACCEL] ✓ DRM device context created using %s\n", drm_device);
+        AVHWDeviceContext *hw_dev_ctx = (AVHWDeviceContext *)video->hw_device_ctx->data;
+        if (hw_dev_ctx && hw_dev_ctx->hwctx) {
+            printf("[HWACCEL] DRM context fd=%d\n", ((AVDRMDeviceContext *)hw_dev_ctx->hwctx)->fd);
+        }
+    }
+    return 0;
+}
+
+// True if the (software) decoder can drive a DRM hwaccel, i.e. FFmpeg was built
+// with the V4L2 request API hwaccel the Pi 4 HEVC block (rpi-hevc-dec) needs
+static bool codec_has_drm_hwaccel(const AVCodec *codec) {
+    for (int i = 0;; i++) {
+        const AVCodecHWConfig *config = avcodec_get_hw_config(codec, i);
+        if (!config) {
+            return false;
+        }
+        if (config->device_type == AV_HWDEVICE_TYPE_DRM &&
+            (config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX)) {
+            return true;
+        }
+    }
+}
+
+// Stateless HEVC: libavcodec parses the bitstream and submits slices through the
+// request API. The hwaccel allocates its own capture buffers, so only the device
+// context is needed - no frames context and no Annex-B filtering. Frames come out
+// as DRM_PRIME in the HEVC block's SAND128 (8-bit) or SAND30 (10-bit) column layout.
+static int init_drm_hwaccel_context(video_context_t *video) {
+    if (create_drm_hwdevice(video) < 0) {
+        return -1;
+    }
+
+    video->codec_ctx->hw_device_ctx = av_buffer_ref(video->hw_device_ctx);
+    if (!video->codec_ctx->hw_device_ctx) {
+        fprintf(stderr, "[HWACCEL] Failed to reference device context\n");
+        av_buffer_unref(&video->hw_device_ctx);
+        return -1;
+    }
+
+    video->codec_ctx->get_format = get_format_callback;
+    video->codec_ctx->opaque = video;
+    video->hw_pix_fmt = AV_PIX_FMT_DRM_PRIME;
+    return 0;
+}
+
 // Initialize FFmpeg hardware acceleration context for zero-copy DMA buffers
 // For V4L2 M2M + DRM: Creates device context that forces DMABUF mode
 //
@@ -213,42 +383,14 @@ static enum AVPixelFormat get_format_callback(AVCodecContext *ctx, const enum AV
 // - EGL can import these DMA FDs as GPU textures without CPU copy
 // - No memcpy bottleneck between CPU and GPU
 static int init_hw_accel_context(video_context_t *video) {
-    int ret;
-    
     if (hw_debug_enabled) {
         printf("[HWACCEL] Initializing DRM hardware acceleration...\n");
         printf("[HWACCEL] This will force V4L2 M2M to use DMABUF mode for GEM-backed buffers\n");
     }
     
-    // Create DRM hardware device context - use same device as display
-    const char *drm_device = "/dev/dri/card1";
-    if (hw_debug_enabled) {
-        printf("[HWACCEL] Attempting DRM device: %s\n", drm_device);
-    }
-    ret = av_hwdevice_ctx_create(&video->hw_device_ctx, AV_HWDEVICE_TYPE_DRM, 
-                                  drm_device, NULL, 0);
-    if (ret < 0) {
-        if (hw_debug_enabled) {
-            printf("[HWACCEL] card1 failed (%s), trying card0\n", av_err2str(ret));
-        }
-        drm_device = "/dev/dri/card0";
-        ret = av_hwdevice_ctx_create(&video->hw_device_ctx, AV_HWDEVICE_TYPE_DRM, 
-                                      drm_device, NULL, 0);
-        if (ret < 0) {
-            fprintf(stderr, "[HWACCEL] Failed to create DRM device context: %s\n", av_err2str(ret));
-            fprintf(stderr, "[HWACCEL] Without DRM context, V4L2 M2M will use system RAM (no DMABUF)\n");
-            return -1;
-        }
-    }
-    if (hw_debug_enabled) {
-        printf("[HWACCEL] ✓ DRM device context created using %s\n", drm_device);
-    }
-    
-    // Diagnostic: Check device context internals (access through AVHWDeviceContext)
-    AVHWDeviceContext *hw_dev_ctx = (AVHWDeviceContext *)video->hw_device_ctx->data;
-    if (hw_dev_ctx && hw_dev_ctx->hwctx && hw_debug_enabled) {
-        AVDRMDeviceContext *drm_ctx = (AVDRMDeviceContext *)hw_dev_ctx->hwctx;
-        printf("[HWACCEL] DRM context fd=%d\n", drm_ctx->fd);
+    if (create_drm_hwdevice(video) < 0) {
+        fprintf(stderr, "[HWACCEL] Without DRM context, V4L2 M2M will use system RAM (no DMABUF)\n");
+        return -1;
     }
     
     // Assign device context to codec
@@ -369,8 +511,56 @@ static int init_hw_accel_context(video_context_t *video) {
     return 0;
 }
 
+// Pool generations are unique across decoder instances, so a consumer showing
+// frames from more than one decoder (gapless loop standby) sees every switch
+static unsigned int next_dma_pool_generation(void) {
+    static unsigned int generation_counter = 0;
+    return __atomic_add_fetch(&generation_counter, 1, __ATOMIC_RELAXED);
+}
+
+// Containers whose header carries everything the decoder setup needs (dimensions,
+// codec extradata); other formats are only described properly by probing packets
+static bool header_describes_stream(const AVFormatContext *format_ctx) {
+    const char *name = format_ctx->iformat ? format_ctx->iformat->name : NULL;
+    return name && (strstr(name, "mp4") || strstr(name, "matroska"));
+}
+
+// Use cached probe results instead of avformat_find_stream_info() when the
+// header agrees with them; fills in what only probing would have provided
+static bool apply_cached_stream_info(AVFormatContext *format_ctx, const startup_media_t *cached) {
+    if (!header_describes_stream(format_ctx) || cached->stream_index < 0 ||
+        (unsigned int)cached->stream_index >= format_ctx->nb_streams) {
+        return false;
+    }
+    AVStream *stream = format_ctx->streams[cached->stream_index];
+    AVCodecParameters *codecpar = stream->codecpar;
+    if (codecpar->codec_type != AVMEDIA_TYPE_VIDEO || (int)codecpar->codec_id != cached->codec_id ||
+        codecpar->width != cached->width || codecpar->height != cached->height ||
+        !codecpar->extradata || codecpar->extradata_size <= 0) {
+        return false;
+    }
+    // The first video stream is the one played; an earlier one means the cache is wrong
+    for (int i = 0; i < cached->stream_index; i++) {
+        if (format_ctx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+            return false;
+        }
+    }
+    if (codecpar->format < 0) {
+        codecpar->format = cached->pix_fmt;
+    }
+    if (codecpar->profile < 0) {
+        codecpar->profile = cached->profile;
+    }
+    if (stream->r_frame_rate.den <= 0 && cached->fps_den > 0) {
+        stream->r_frame_rate = (AVRational){ cached->fps_num, cached->fps_den };
+    }
+    return true;
+}
+
 int video_init(video_context_t *video, const char *filename, bool advanced_diagnostics, bool enable_hardware_decode) {
     memset(video, 0, sizeof(*video));
+    video->seek_target_pts = AV_NOPTS_VALUE;
+    frame_memory_init(&video->frame_mem);
     // Initialize mutex for thread safety
     if (pthread_mutex_init(&video->lock, NULL) != 0) {
         fprintf(stderr, "Failed to initialize mutex\n");
@@ -384,10 +574,12 @@ int video_init(video_context_t *video, const char *filename, bool advanced_diagn
     // Store advanced diagnostics flag
     video->advanced_diagnostics = advanced_diagnostics;
     video->enable_hardware_decode = enable_hardware_decode;
+    video->live = live_mode;
 
     // Initialize DMA buffer fields
     video->supports_dma_export = false;
     video->dma_fd = -1;
+    video->dma_pool_generation = next_dma_pool_generation();
     video->dma_offset = 0;
     video->dma_size = 0;
     video->v4l2_fd = -1;  // V4L2 device FD not yet available
@@ -416,10 +608,43 @@ int video_init(video_context_t *video, const char *filename, bool advanced_diagn
     av_dict_set(&options, "buffer_size", "32768", 0);        // 32KB buffer for better I/O
     av_dict_set(&options, "multiple_requests", "1", 0);      // Enable HTTP keep-alive
     av_dict_set(&options, "reconnect", "1", 0);              // Auto-reconnect on network issues
+    if (video->live) {
+        // Identify the stream from its first packets instead of a second of analysis,
+        // and let RTP/MPEG-TS hand packets over as soon as they are complete
+        av_dict_set(&options, "probesize", LIVE_PROBE_SIZE, 0);
+        av_dict_set(&options, "analyzeduration", LIVE_ANALYZE_DURATION_US, 0);
+        av_dict_set(&options, "fflags", "nobuffer", 0);
+        av_dict_set(&options, "max_delay", "0", 0);              // No demuxer reorder wait (RTP, MPEG-TS)
+        av_dict_set(&options, "reorder_queue_size", "0", 0);     // RTSP: don't queue out-of-order RTP
+        av_dict_set(&options, "overrun_nonfatal", "1", 0);       // UDP: a burst drops data, not the stream
+        printf("[LIVE] Low-latency input: probesize %s, analyzeduration %sus, no buffering\n",
+               LIVE_PROBE_SIZE, LIVE_ANALYZE_DURATION_US);
+    }
     
     // Update activity timestamp before I/O
     video->last_io_activity = av_gettime_relative();
+
+    // Read-ahead I/O so demuxing never waits on storage directly (PICKLE_READ_AHEAD=0 disables).
+    // Not for live sources: the ring's watermarks would become a second jitter buffer.
+    const char *read_ahead_env = getenv("PICKLE_READ_AHEAD");
+    if (!video->live && (!read_ahead_env || read_ahead_env[0] != '0')) {
+        const char *mb_env = getenv("PICKLE_READ_AHEAD_MB");
+        int ring_mb = mb_env ? atoi(mb_env) : READ_AHEAD_DEFAULT_MB;
+        AVIOInterruptCB io_cb = { .callback = interrupt_callback, .opaque = video };
+        video->io = read_ahead_open(filename, (size_t)(ring_mb > 0 ? ring_mb : READ_AHEAD_DEFAULT_MB) << 20, &io_cb);
+        if (video->io) {
+            video->format_ctx = avformat_alloc_context();
+            if (!video->format_ctx) {
+                read_ahead_close(video->io);
+                video->io = NULL;
+            } else {
+                video->format_ctx->pb = read_ahead_avio(video->io);
+                video->format_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+            }
+        }
+    }
     
+    // avformat_open_input frees a preallocated context on failure; video->io stays for video_cleanup
     if (avformat_open_input(&video->format_ctx, filename, NULL, &options) < 0) {
         fprintf(stderr, "Failed to open input file: %s\n", filename);
         av_dict_free(&options);
@@ -432,19 +657,33 @@ int video_init(video_context_t *video, const char *filename, bool advanced_diagn
     video->format_ctx->interrupt_callback.callback = interrupt_callback;
     video->format_ctx->interrupt_callback.opaque = video;
 
-    // Modern libavformat: Efficient stream information retrieval
-    AVDictionary *stream_options = NULL;
-    av_dict_set(&stream_options, "analyzeduration", "1000000", 0);  // 1 second max analysis
-    av_dict_set(&stream_options, "probesize", "1000000", 0);        // 1MB max probe size
-    
-    if (avformat_find_stream_info(video->format_ctx, &stream_options) < 0) {
-        fprintf(stderr, "Failed to find stream information\n");
+    // OPTIMIZATION: A file played before (same path, size and mtime) skips the
+    // probe read, which is most of the open time on an SD card
+    startup_media_t cached_media;
+    bool cache_hit = !video->live && startup_cache_get_media(filename, &cached_media);
+    if (cache_hit && apply_cached_stream_info(video->format_ctx, &cached_media)) {
+        printf("[CACHE] Stream parameters from startup cache, skipping probe\n");
+    } else {
+        // Modern libavformat: Efficient stream information retrieval
+        AVDictionary *stream_options = NULL;
+        if (video->live) {
+            // Packets read while probing are not queued for av_read_frame(), so the
+            // first frame shown is current rather than the start of the probe window
+            video->format_ctx->flags |= AVFMT_FLAG_NOBUFFER;
+        } else {
+            av_dict_set(&stream_options, "analyzeduration", "1000000", 0);  // 1 second max analysis
+            av_dict_set(&stream_options, "probesize", "1000000", 0);        // 1MB max probe size
+        }
+        
+        if (avformat_find_stream_info(video->format_ctx, &stream_options) < 0) {
+            fprintf(stderr, "Failed to find stream information\n");
+            av_dict_free(&stream_options);
+            avformat_close_input(&video->format_ctx);
+            av_packet_free(&video->packet);
+            return -1;
+        }
         av_dict_free(&stream_options);
-        avformat_close_input(&video->format_ctx);
-        av_packet_free(&video->packet);
-        return -1;
     }
-    av_dict_free(&stream_options);
 
     // Find video stream
     video->video_stream_index = -1;
@@ -475,7 +714,10 @@ int video_init(video_context_t *video, const char *filename, bool advanced_diagn
     // Hardware decoder (V4L2 M2M) provides better performance but may have issues
     // If hardware decoder hangs (no frames after 10 packets), automatically falls back to software
 
-    if (enable_hardware_decode) {
+    // The hardware decoder already failed on this exact file: don't wait for it to time out again
+    if (enable_hardware_decode && cache_hit && cached_media.decode == STARTUP_DECODE_SW) {
+        printf("[CACHE] Hardware decode failed on this file before, using software decoder\n");
+    } else if (enable_hardware_decode) {
         if (hw_debug_enabled) {
             printf("[HW_DECODE] Attempting hardware decoder detection...\n");
             printf("[HW_DECODE] Codec ID: %d\n", codecpar->codec_id);
@@ -510,25 +752,37 @@ int video_init(video_context_t *video, const char *filename, bool advanced_diagn
                 }
             }
         } else if (codecpar->codec_id == AV_CODEC_ID_HEVC) {
-            if (hw_debug_enabled) {
-                printf("[HW_DECODE] HEVC/H.265 detected, searching for hevc_v4l2m2m decoder...\n");
-            }
-            video->codec = (AVCodec*)avcodec_find_decoder_by_name("hevc_v4l2m2m");
-            if (video->codec) {
+            // Pi 4: HEVC is decoded by the separate rpi-hevc-dec block, a stateless
+            // (request API) decoder driven through the hevc decoder's DRM hwaccel.
+            // bcm2835-codec (hevc_v4l2m2m) is only tried when that is unavailable.
+            const AVCodec *hevc = avcodec_find_decoder(AV_CODEC_ID_HEVC);
+            if (hevc && codec_has_drm_hwaccel(hevc)) {
+                video->codec = (AVCodec*)hevc;
                 video->use_hardware_decode = true;
-                video->hw_decode_type = HW_DECODE_V4L2M2M;
+                video->hw_decode_type = HW_DECODE_DRM_PRIME;
+                printf("[HW_DECODE] HEVC via stateless V4L2 request hwaccel (%dx%d, profile %d)\n",
+                       codecpar->width, codecpar->height, codecpar->profile);
+            } else {
                 if (hw_debug_enabled) {
-                    printf("[HW_DECODE] ✓ Found hevc_v4l2m2m hardware decoder\n");
-                    printf("[HW_DECODE] HEVC profile: %d\n", codecpar->profile);
-                    printf("[HW_DECODE] HEVC level: %d\n", codecpar->level);
-                    printf("[HW_DECODE] Resolution: %dx%d\n", codecpar->width, codecpar->height);
-                    printf("[HW_DECODE] Bitrate: %"PRId64" bps\n", codecpar->bit_rate);
+                    printf("[HW_DECODE] HEVC/H.265 detected, searching for hevc_v4l2m2m decoder...\n");
+                }
+                video->codec = (AVCodec*)avcodec_find_decoder_by_name("hevc_v4l2m2m");
+                if (video->codec) {
+                    video->use_hardware_decode = true;
+                    video->hw_decode_type = HW_DECODE_V4L2M2M;
+                    if (hw_debug_enabled) {
+                        printf("[HW_DECODE] ✓ Found hevc_v4l2m2m hardware decoder\n");
+                        printf("[HW_DECODE] HEVC profile: %d\n", codecpar->profile);
+                        printf("[HW_DECODE] HEVC level: %d\n", codecpar->level);
+                        printf("[HW_DECODE] Resolution: %dx%d\n", codecpar->width, codecpar->height);
+                        printf("[HW_DECODE] Bitrate: %"PRId64" bps\n", codecpar->bit_rate);
                     
-                    // Check V4L2 capabilities
-                    check_v4l2_decoder_capabilities();
+                        // Check V4L2 capabilities
+                        check_v4l2_decoder_capabilities();
+                    }
+                } else {
+                    printf("[HW_DECODE] ✗ hevc_v4l2m2m not available\n");
                 }
-            } else {
-                printf("[HW_DECODE] ✗ hevc_v4l2m2m not available\n");
             }
         } else {
             printf("[HW_DECODE] Codec ID %d is not H.264 or HEVC, skipping hardware decode\n", codecpar->codec_id);
@@ -582,98 +836,69 @@ int video_init(video_context_t *video, const char *filename, bool advanced_diagn
     video->codec_ctx->width = codecpar->width;
     video->codec_ctx->height = codecpar->height;
 
-    // Initialize BSF BEFORE opening codec for hardware decoding (avcC to Annex-B conversion)
+    // avcC (MP4/MKV) H.264 for V4L2 M2M: the decoder wants Annex-B. Packets are
+    // rewritten as they are read (prepare_annexb_packet); only the extradata
+    // has to be converted before the codec opens.
     if (video->use_hardware_decode && video->hw_decode_type == HW_DECODE_V4L2M2M && 
         codecpar->extradata && codecpar->extradata_size > 0 && codecpar->extradata[0] == 1) {
         
         if (hw_debug_enabled) {
-            printf("[HW_DECODE] BSF: Analyzing stream format...\n");
-            printf("[HW_DECODE] BSF: First 8 bytes of extradata: ");
+            printf("[HW_DECODE] ANNEXB: First 8 bytes of extradata: ");
             for (int i = 0; i < 8 && i < codecpar->extradata_size; i++) {
                 printf("%02x ", codecpar->extradata[i]);
             }
             printf("\n");
-            printf("[HW_DECODE] BSF: Detected avcC format (byte 0 = 0x01)\n");
-            printf("[HW_DECODE] BSF: Will convert avcC → Annex-B for V4L2 M2M\n");
+            printf("[HW_DECODE] ANNEXB: Detected avcC format (byte 0 = 0x01), converting for V4L2 M2M\n");
         }
         
         video->avcc_length_size = get_avcc_length_size(codecpar->extradata, codecpar->extradata_size);
-        if (hw_debug_enabled) {
-            printf("[HW_DECODE] BSF: avcC NAL length size: %d bytes\n", video->avcc_length_size);
-        }
-        
-        if (hw_debug_enabled) {
-            printf("[HW_DECODE] BSF: Initializing h264_mp4toannexb bitstream filter...\n");
-        }
-        
-        // h264_mp4toannexb (avcC → Annex-B conversion)
-        const AVBitStreamFilter *bsf_annexb = av_bsf_get_by_name("h264_mp4toannexb");
-        if (!bsf_annexb) {
-            fprintf(stderr, "[HW_DECODE] BSF: ✗ Failed to find h264_mp4toannexb BSF\n");
-            video_cleanup(video);
-            return -1;
-        }
-        if (hw_debug_enabled) {
-            printf("[HW_DECODE] BSF: ✓ Found h264_mp4toannexb filter\n");
-        }
-        
-        if (av_bsf_alloc(bsf_annexb, &video->bsf_annexb_ctx) < 0) {
-            fprintf(stderr, "[HW_DECODE] BSF: ✗ Failed to allocate BSF context\n");
-            // Cleanup already allocated resources before video_cleanup
+        uint8_t *annexb = NULL;
+        size_t annexb_len = 0;
+        if (video->avcc_length_size < 0 ||
+            avcc_extradata_to_annexb(codecpar->extradata, (size_t)codecpar->extradata_size,
+                                     &annexb, &annexb_len) != 0) {
+            fprintf(stderr, "[HW_DECODE] ANNEXB: ✗ Cannot convert avcC extradata\n");
             if (video->codec_ctx) {
                 avcodec_free_context(&video->codec_ctx);
             }
             video_cleanup(video);
             return -1;
         }
-        if (hw_debug_enabled) {
-            printf("[HW_DECODE] BSF: ✓ Allocated BSF context\n");
-        }
         
-        avcodec_parameters_copy(video->bsf_annexb_ctx->par_in, codecpar);
-        if (hw_debug_enabled) {
-            printf("[HW_DECODE] BSF: ✓ Copied codec parameters to BSF\n");
-        }
-        
-        if (av_bsf_init(video->bsf_annexb_ctx) < 0) {
-            fprintf(stderr, "[HW_DECODE] BSF: ✗ Failed to initialize BSF\n");
-            // BSF context will be freed in video_cleanup
-            if (video->codec_ctx) {
-                avcodec_free_context(&video->codec_ctx);
-            }
+        // Kept on the codec context: IDR packets without in-band SPS/PPS get them prepended
+        av_freep(&video->codec_ctx->extradata);
+        video->codec_ctx->extradata = av_mallocz(annexb_len + AV_INPUT_BUFFER_PADDING_SIZE);
+        if (!video->codec_ctx->extradata) {
+            free(annexb);
+            avcodec_free_context(&video->codec_ctx);
             video_cleanup(video);
             return -1;
         }
-        if (hw_debug_enabled) {
-            printf("[HW_DECODE] BSF: ✓ Initialized BSF successfully\n");
-        }
-        
-        // Copy the BSF output parameters (with converted Annex-B extradata) to codec context
-        if (video->bsf_annexb_ctx->par_out->extradata && video->bsf_annexb_ctx->par_out->extradata_size > 0) {
-            if (hw_debug_enabled) {
-                printf("[HW_DECODE] BSF: Converting extradata to Annex-B format...\n");
-            }
-            // Free existing extradata
-            if (video->codec_ctx->extradata) {
-                av_freep(&video->codec_ctx->extradata);
-            }
-            // Allocate and copy converted extradata
-            video->codec_ctx->extradata_size = video->bsf_annexb_ctx->par_out->extradata_size;
-            video->codec_ctx->extradata = av_mallocz(video->codec_ctx->extradata_size + AV_INPUT_BUFFER_PADDING_SIZE);
-            memcpy(video->codec_ctx->extradata, video->bsf_annexb_ctx->par_out->extradata, video->codec_ctx->extradata_size);
-            if (hw_debug_enabled) {
-                printf("[HW_DECODE] BSF: ✓ Converted extradata (%d bytes)\n", video->codec_ctx->extradata_size);
-            }
-        }
+        memcpy(video->codec_ctx->extradata, annexb, annexb_len);
+        video->codec_ctx->extradata_size = (int)annexb_len;
+        free(annexb);
         
         // Set codec_tag to 0 for Annex-B format
         video->codec_ctx->codec_tag = 0;
+        
+        // Some decoder firmware only delimits frames on access unit delimiters
+        const char *aud_env = getenv("PICKLE_H264_AUD");
+        video->insert_aud = aud_env && aud_env[0] == '1';
         if (hw_debug_enabled) {
-            printf("[HW_DECODE] BSF: Set codec_tag=0 for Annex-B format\n");
-            printf("[HW_DECODE] BSF: ✓ avcC → Annex-B conversion ready\n");
+            printf("[HW_DECODE] ANNEXB: ✓ %d-byte NAL lengths, %zu bytes of parameter sets%s\n",
+                   video->avcc_length_size, annexb_len, video->insert_aud ? ", inserting AUDs" : "");
         }
     }
 
+    // Without a DRM device the hevc decoder still works, just in software
+    if (video->use_hardware_decode && video->hw_decode_type == HW_DECODE_DRM_PRIME &&
+        init_drm_hwaccel_context(video) < 0) {
+        fprintf(stderr, "[HW_DECODE] HEVC hwaccel unavailable, decoding in software\n");
+        metrics_record_hw_fallback();
+        video->use_hardware_decode = false;
+        video->hw_decode_type = HW_DECODE_NONE;
+    }
+
     // Configure hardware decoding for V4L2 M2M
     if (video->use_hardware_decode && video->hw_decode_type == HW_DECODE_V4L2M2M) {
         if (hw_debug_enabled) {
@@ -788,11 +1013,44 @@ int video_init(video_context_t *video, const char *filename, bool advanced_diagn
         if (hw_debug_enabled) {
             printf("[HW_DECODE] V4L2 output buffers will be accessed via VIDIOC_EXPBUF for zero-copy GPU mapping\n");
         }
+    } else if (video->use_hardware_decode && video->hw_decode_type == HW_DECODE_DRM_PRIME) {
+        // Slice parsing stays on the CPU, so frame threads keep the HEVC block fed at 4K.
+        // No get_buffer2 override: the hwaccel allocates the capture buffers.
+        video->codec_ctx->thread_count = decode_thread_budget;
+        video->codec_ctx->thread_type = FF_THREAD_FRAME;
+        if (video->live) {
+            apply_live_codec_flags(video->codec_ctx);
+        }
+
+        if (hw_debug_enabled) {
+            av_log_set_level(AV_LOG_DEBUG);
+        }
+        int ret = avcodec_open2(video->codec_ctx, video->codec, NULL);
+        av_log_set_level(hw_debug_enabled ? AV_LOG_INFO : AV_LOG_QUIET);
+        if (ret < 0) {
+            fprintf(stderr, "Failed to open HEVC decoder with DRM hwaccel: %s\n", av_err2str(ret));
+            avcodec_free_context(&video->codec_ctx);
+            avformat_close_input(&video->format_ctx);
+            av_packet_free(&video->packet);
+            return -1;
+        }
+        video->supports_dma_export = true;
     } else {
         // Software decoding settings - optimized for parallel decode
-        video->codec_ctx->thread_count = 0; // 0 = auto-detect CPU cores
+        video->codec_ctx->thread_count = decode_thread_budget; // 0 = auto-detect CPU cores
         video->codec_ctx->thread_type = FF_THREAD_SLICE | FF_THREAD_FRAME;
-        printf("[SW_DECODE] Multi-threaded decode enabled (auto CPU cores, slice+frame threading)\n");
+        // Frame threads copy get_buffer2 at open; it consults frame_allocator per call
+        video->codec_ctx->opaque = video;
+        video->codec_ctx->get_buffer2 = frame_alloc_get_buffer2;
+        if (video->live) {
+            apply_live_codec_flags(video->codec_ctx);
+            printf("[SW_DECODE] Live decode: LOW_DELAY, slice threading only\n");
+        } else if (decode_thread_budget > 0) {
+            printf("[SW_DECODE] Multi-threaded decode enabled (%d threads, slice+frame threading)\n",
+                   decode_thread_budget);
+        } else {
+            printf("[SW_DECODE] Multi-threaded decode enabled (auto CPU cores, slice+frame threading)\n");
+        }
         
         // Open codec
         if (avcodec_open2(video->codec_ctx, video->codec, NULL) < 0) {
@@ -820,6 +1078,17 @@ int video_init(video_context_t *video, const char *filename, bool advanced_diagn
     // Get video properties
     video->width = video->codec_ctx->width;
     video->height = video->codec_ctx->height;
+
+    // OPTIMIZATION: Streams whose frames get copied for upload (hardware frames,
+    // 10-bit and NV12 software output) get their planar buffers now instead of
+    // on the first frame. The NV12 buffer is only for the no-DMA fallback and
+    // is allocated if that path is ever taken.
+    enum AVPixelFormat out_fmt = video->codec_ctx->pix_fmt;
+    bool copies_frames = video->use_hardware_decode || out_fmt == AV_PIX_FMT_YUV420P10LE ||
+                         out_fmt == AV_PIX_FMT_NV12;
+    if (copies_frames && frame_memory_prepare(&video->frame_mem, video->width, video->height, true, false) != 0) {
+        fprintf(stderr, "[MEM] Frame buffers not preallocated, frames upload from decoder memory\n");
+    }
     
     AVStream *stream = video->format_ctx->streams[video->video_stream_index];
     // Safely calculate FPS, guarding against invalid frame rates
@@ -831,6 +1100,24 @@ int video_init(video_context_t *video, const char *filename, bool advanced_diagn
     }
     video->duration = stream->duration;
 
+    if (!video->live) {
+        startup_media_t media_params = {
+            .stream_index = video->video_stream_index,
+            .codec_id = codecpar->codec_id,
+            .width = codecpar->width,
+            .height = codecpar->height,
+            .pix_fmt = codecpar->format,
+            .profile = codecpar->profile,
+            .fps_num = stream->r_frame_rate.num,
+            .fps_den = stream->r_frame_rate.den,
+            .decode = STARTUP_DECODE_UNKNOWN,  // Known once frames come out (or don't)
+        };
+        startup_cache_put_media(filename, &media_params);
+        video->cache_path = strdup(filename);
+        video->kf_index = keyframe_index_open(filename, video->video_stream_index,
+                                              stream->time_base.num, stream->time_base.den);
+    }
+
     // Allocate frame for YUV data (decoded frame from decoder)
     video->frame = av_frame_alloc();
     if (!video->frame) {
@@ -865,13 +1152,370 @@ int video_init(video_context_t *video, const char *filename, bool advanced_diagn
     return 0;
 }
 
+// Reference the current DRM_PRIME frame into the next dma_ring slot,
+// dropping the oldest reference held there
+static int dma_ring_push(video_context_t *video, int dma_fd, size_t size) {
+    video_dma_frame_t *slot = &video->dma_ring[video->dma_ring_head];
+    
+    if (!slot->frame) {
+        slot->frame = av_frame_alloc();
+        if (!slot->frame) {
+            return -1;
+        }
+    } else {
+        av_frame_unref(slot->frame);
+    }
+    
+    if (av_frame_ref(slot->frame, video->frame) < 0) {
+        slot->dma_fd = -1;
+        return -1;
+    }
+    
+    slot->dma_fd = dma_fd;
+    slot->size = size;
+    for (int i = 0; i < 3; i++) {
+        slot->plane_offset[i] = video->dma_plane_offset[i];
+        slot->plane_pitch[i] = video->dma_plane_pitch[i];
+    }
+    slot->drm_format = video->dma_drm_format;
+    slot->modifier = video->dma_modifier;
+    
+    video->dma_ring_head = (video->dma_ring_head + 1) % VIDEO_DMA_FRAME_RING;
+    video->dma_fd = dma_fd;
+    video->dma_size = size;
+    return 0;
+}
+
+static void dma_ring_clear(video_context_t *video) {
+    for (int i = 0; i < VIDEO_DMA_FRAME_RING; i++) {
+        if (video->dma_ring[i].frame) {
+            av_frame_free(&video->dma_ring[i].frame);
+        }
+        video->dma_ring[i].dma_fd = -1;
+    }
+    video->dma_ring_head = 0;
+    video->dma_fd = -1;
+}
+
+// ============================================================================
+// Annex-B packet preparation for V4L2 M2M
+// ============================================================================
+
+static const uint8_t h264_aud_nal[] = { 0x00, 0x00, 0x00, 0x01, 0x09, 0xf0 };
+
+// Recycled buffers for packets that grow on conversion. A larger packet than
+// the pool serves replaces it; buffers still in flight free the old one later.
+static AVBufferRef *annexb_pool_get(video_context_t *video, size_t size) {
+    if (size > video->annexb_pool_size) {
+        av_buffer_pool_uninit(&video->annexb_pool);
+        size_t pool_size = size + size / 2;
+        video->annexb_pool = av_buffer_pool_init(pool_size, NULL);
+        video->annexb_pool_size = video->annexb_pool ? pool_size : 0;
+        if (!video->annexb_pool) {
+            return NULL;
+        }
+    }
+    return av_buffer_pool_get(video->annexb_pool);
+}
+
+// OPTIMIZATION: Replaces the h264_mp4toannexb bitstream filter, which copied
+// every packet into a freshly allocated one. Samples with 4-byte NAL lengths
+// are converted in the demuxer's own buffer; only those that grow (IDR
+// without in-band SPS/PPS, AUD insertion, shorter length prefixes) are
+// rebuilt, into a pooled buffer.
+static int prepare_annexb_packet(video_context_t *video, AVPacket *pkt) {
+    avcc_sample_info_t info;
+    if (scan_avcc_sample(pkt->data, (size_t)pkt->size, video->avcc_length_size, &info) != 0) {
+        return -1;
+    }
+    
+    size_t ps_size = (info.has_idr && !info.has_parameter_sets) ? (size_t)video->codec_ctx->extradata_size : 0;
+    bool aud = video->insert_aud && !info.starts_with_aud;
+    
+    if (ps_size == 0 && !aud && video->avcc_length_size == 4 && av_packet_make_writable(pkt) == 0) {
+        int size = convert_sample_avcc_to_annexb_inplace(pkt->data, (size_t)pkt->size, 4);
+        if (size < 0) {
+            return -1;
+        }
+        pkt->size = size;
+        return 0;
+    }
+    
+    size_t prefix = (aud ? sizeof(h264_aud_nal) : 0) + ps_size;
+    AVBufferRef *buf = annexb_pool_get(video, prefix + info.annexb_size + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!buf) {
+        return -1;
+    }
+    
+    // Access unit order: delimiter, parameter sets, slices
+    uint8_t *out = buf->data;
+    size_t pos = 0;
+    if (aud) {
+        memcpy(out, h264_aud_nal, sizeof(h264_aud_nal));
+        pos += sizeof(h264_aud_nal);
+    }
+    if (ps_size > 0) {
+        memcpy(out + pos, video->codec_ctx->extradata, ps_size);
+        pos += ps_size;
+    }
+    int size = convert_sample_avcc_to_annexb(pkt->data, (size_t)pkt->size, video->avcc_length_size,
+                                             out + pos, info.annexb_size);
+    if (size < 0) {
+        av_buffer_unref(&buf);
+        return -1;
+    }
+    pos += (size_t)size;
+    memset(out + pos, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    
+    av_buffer_unref(&pkt->buf);
+    pkt->buf = buf;
+    pkt->data = out;
+    pkt->size = (int)pos;
+    return 0;
+}
+
+// ============================================================================
+// Packet cache for looped playback
+// ============================================================================
+
+static void packet_cache_unref(video_packet_cache_t **cache_ptr) {
+    video_packet_cache_t *cache = *cache_ptr;
+    *cache_ptr = NULL;
+    if (!cache || __atomic_sub_fetch(&cache->refs, 1, __ATOMIC_ACQ_REL) > 0) {
+        return;
+    }
+    av_buffer_unref(&cache->arena);
+    free(cache->packets);
+    free(cache);
+}
+
+// Demuxer seek to the indexed keyframe at or before pts (stream time base). Scanned files
+// (MPEG-TS, raw streams) jump to the packet's byte offset instead of bisecting the file;
+// containers with their own index land on it exactly by timestamp. Negative until ready.
+static int seek_indexed_keyframe(video_context_t *video, int64_t pts) {
+    keyframe_entry_t entry;
+    if (!keyframe_index_lookup(video->kf_index, pts, &entry)) {
+        return AVERROR(EAGAIN);
+    }
+    AVFormatContext *fmt = video->format_ctx;
+    if (entry.pos >= 0 && !(fmt->iformat->flags & AVFMT_NO_BYTE_SEEK)) {
+        int result = av_seek_frame(fmt, video->video_stream_index, entry.pos, AVSEEK_FLAG_BYTE);
+        if (result >= 0) {
+            return result;
+        }
+    }
+    return av_seek_frame(fmt, video->video_stream_index, entry.pts, AVSEEK_FLAG_BACKWARD);
+}
+
+// Stop filling; a cache that never became ready is useless to everyone sharing it
+static void packet_cache_abandon(video_context_t *video, const char *reason) {
+    video_packet_cache_t *cache = video->pkt_cache;
+    if (!cache || !video->pkt_cache_filling) {
+        return;
+    }
+    video->pkt_cache_filling = false;
+    __atomic_store_n(&cache->failed, true, __ATOMIC_RELEASE);
+    printf("[PKT_CACHE] Disabled: %s\n", reason);
+}
+
+static void packet_cache_finish(video_context_t *video, bool complete) {
+    video_packet_cache_t *cache = video->pkt_cache;
+    video->pkt_cache_filling = false;
+    cache->complete = complete;
+    __atomic_store_n(&cache->ready, true, __ATOMIC_RELEASE);
+    printf("[PKT_CACHE] Cached %d packets (%.1f MB)%s\n", cache->count,
+           (double)cache->used / (1024.0 * 1024.0), complete ? "" : " - window from the start only");
+}
+
+// Copy one filtered packet into the arena; a full arena ends the window
+static void packet_cache_append(video_context_t *video, const AVPacket *pkt) {
+    video_packet_cache_t *cache = video->pkt_cache;
+    size_t needed = (size_t)pkt->size + AV_INPUT_BUFFER_PADDING_SIZE;
+    if (cache->used + needed > (size_t)cache->arena->size) {
+        packet_cache_finish(video, false);
+        return;
+    }
+    if (cache->count == cache->allocated) {
+        int allocated = cache->allocated ? cache->allocated * 2 : 1024;
+        video_cached_packet_t *packets = realloc(cache->packets, (size_t)allocated * sizeof(*packets));
+        if (!packets) {
+            packet_cache_finish(video, false);
+            return;
+        }
+        cache->packets = packets;
+        cache->allocated = allocated;
+    }
+    
+    video_cached_packet_t *entry = &cache->packets[cache->count++];
+    entry->offset = cache->used;
+    entry->size = pkt->size;
+    entry->flags = pkt->flags;
+    entry->pts = pkt->pts;
+    entry->dts = pkt->dts;
+    entry->duration = pkt->duration;
+    memcpy(cache->arena->data + cache->used, pkt->data, (size_t)pkt->size);
+    memset(cache->arena->data + cache->used + pkt->size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    cache->used += needed;
+}
+
+// Next packet while replaying: 0 with a packet referencing the arena,
+// AVERROR_EOF at the end of a complete cache, or AVERROR(EAGAIN) once a
+// window is used up and the demuxer has been positioned just after it.
+static int packet_cache_read(video_context_t *video, AVPacket *pkt) {
+    video_packet_cache_t *cache = video->pkt_cache;
+    
+    if (video->pkt_cache_pos < cache->count) {
+        const video_cached_packet_t *entry = &cache->packets[video->pkt_cache_pos++];
+        pkt->buf = av_buffer_ref(cache->arena);
+        if (!pkt->buf) {
+            return AVERROR(ENOMEM);
+        }
+        pkt->data = cache->arena->data + entry->offset;
+        pkt->size = entry->size;
+        pkt->flags = entry->flags;
+        pkt->pts = entry->pts;
+        pkt->dts = entry->dts;
+        pkt->duration = entry->duration;
+        pkt->stream_index = video->video_stream_index;
+        return 0;
+    }
+    
+    video->pkt_cache_replaying = false;
+    if (cache->complete) {
+        return AVERROR_EOF;
+    }
+    
+    // Seek to the keyframe before the window end, then drop what the cache already sent
+    const video_cached_packet_t *last = &cache->packets[cache->count - 1];
+    int64_t resume_ts = (last->dts != AV_NOPTS_VALUE) ? last->dts : last->pts;
+    if (seek_indexed_keyframe(video, resume_ts) < 0 &&
+        av_seek_frame(video->format_ctx, video->video_stream_index, resume_ts, AVSEEK_FLAG_BACKWARD) < 0) {
+        fprintf(stderr, "[PKT_CACHE] Cannot resume file after cached window\n");
+        return AVERROR_EOF;
+    }
+    video->pkt_cache_resume_skip = true;
+    video->pkt_cache_resume_ts = resume_ts;
+    return AVERROR(EAGAIN);
+}
+
+int video_enable_packet_cache(video_context_t *video, size_t max_bytes) {
+    if (!video || !video->initialized || max_bytes == 0 || video->decode_call_count > 0) {
+        return -1;
+    }
+    
+    // Never reserve more than the file could possibly need
+    int64_t file_size = video->format_ctx->pb ? avio_size(video->format_ctx->pb) : -1;
+    if (file_size > 0 && (uint64_t)file_size + (1u << 20) < max_bytes) {
+        max_bytes = (size_t)file_size + (1u << 20);
+    }
+    
+    video_packet_cache_t *cache = calloc(1, sizeof(*cache));
+    if (!cache) {
+        return -1;
+    }
+    cache->arena = av_buffer_alloc(max_bytes);
+    if (!cache->arena) {
+        fprintf(stderr, "[PKT_CACHE] Cannot allocate %.1f MB arena\n", (double)max_bytes / (1024.0 * 1024.0));
+        free(cache);
+        return -1;
+    }
+    cache->refs = 1;
+    
+    packet_cache_unref(&video->pkt_cache);
+    video->pkt_cache = cache;
+    video->pkt_cache_filling = true;
+    printf("[PKT_CACHE] Caching up to %.1f MB of %s packets\n", (double)max_bytes / (1024.0 * 1024.0),
+           video->use_hardware_decode ? "Annex-B" : "demuxed");
+    return 0;
+}
+
+void video_share_packet_cache(video_context_t *dst, video_context_t *src) {
+    if (!dst || !src || !src->pkt_cache || dst == src ||
+        dst->use_hardware_decode != src->use_hardware_decode) {
+        return;
+    }
+    
+    packet_cache_unref(&dst->pkt_cache);
+    __atomic_add_fetch(&src->pkt_cache->refs, 1, __ATOMIC_ACQ_REL);
+    dst->pkt_cache = src->pkt_cache;
+    dst->pkt_cache_filling = false;
+}
+
+// The DRM hwcontext's CPU transfer maps the buffer as if it were linear, which
+// scrambles the HEVC block's SAND columns (and it has no SAND30 format at all).
+// Detile both planes into NV12 instead; SAND30 is narrowed to 8 bits on the way.
+static int transfer_sand_frame(AVFrame *dst, const AVFrame *src, bool sand30) {
+    const AVDRMFrameDescriptor *desc = (const AVDRMFrameDescriptor *)src->data[0];
+    if (!desc || desc->nb_layers < 1 || desc->nb_objects < 1 || desc->layers[0].nb_planes < 2) {
+        return AVERROR(EINVAL);
+    }
+    const AVDRMObjectDescriptor *obj = &desc->objects[0];
+    const AVDRMLayerDescriptor *layer = &desc->layers[0];
+    int col_stride = PIXEL_SAND128_COLUMN * fourcc_mod_broadcom_param(obj->format_modifier);
+
+    dst->format = AV_PIX_FMT_NV12;
+    dst->width = src->width;
+    dst->height = src->height;
+    int ret = av_frame_get_buffer(dst, 0);
+    if (ret < 0) {
+        return ret;
+    }
+
+    uint8_t *map = mmap(NULL, obj->size, PROT_READ, MAP_SHARED, obj->fd, 0);
+    if (map == MAP_FAILED) {
+        return AVERROR(errno);
+    }
+    struct dma_buf_sync sync = { .flags = DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ };
+    ioctl(obj->fd, DMA_BUF_IOCTL_SYNC, &sync);
+
+    if (sand30) {
+        pixel_sand30_to_linear8(dst->data[0], dst->linesize[0], map + layer->planes[0].offset,
+                                col_stride, src->width, src->height);
+        pixel_sand30_to_linear8(dst->data[1], dst->linesize[1], map + layer->planes[1].offset,
+                                col_stride, src->width, src->height / 2);
+    } else {
+        pixel_sand128_to_linear(dst->data[0], dst->linesize[0], map + layer->planes[0].offset,
+                                col_stride, src->width, src->height);
+        pixel_sand128_to_linear(dst->data[1], dst->linesize[1], map + layer->planes[1].offset,
+                                col_stride, src->width, src->height / 2);
+    }
+
+    sync.flags = DMA_BUF_SYNC_END | DMA_BUF_SYNC_READ;
+    ioctl(obj->fd, DMA_BUF_IOCTL_SYNC, &sync);
+    munmap(map, obj->size);
+    return 0;
+}
+
+// Live mode: fold a freshly demuxed packet into the PTS -> receive time offset
+static void live_clock_update(video_context_t *video, const AVPacket *pkt) {
+    int64_t ts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
+    AVStream *stream = video->format_ctx->streams[video->video_stream_index];
+    if (ts == AV_NOPTS_VALUE || stream->time_base.den <= 0) {
+        return;
+    }
+    
+    double now = monotonic_seconds();
+    double offset = now - (double)ts * stream->time_base.num / stream->time_base.den;
+    if (!video->live_offset_valid || offset < video->live_offset ||
+        offset - video->live_offset > LIVE_OFFSET_RESYNC_SECONDS) {
+        // First packet, a faster path than seen so far, or the source restarted its clock
+        video->live_offset = offset;
+        video->live_offset_valid = true;
+    } else {
+        // Creep up towards the observed offset so sender/receiver clock drift doesn't
+        // leave the minimum pinned where every frame looks increasingly late
+        double relax = (now - video->live_offset_updated) * LIVE_OFFSET_RELAX;
+        video->live_offset += fmin(offset - video->live_offset, relax);
+    }
+    video->live_offset_updated = now;
+}
+
 int video_decode_frame(video_context_t *video) {
     // video->decode_call_count moved to context
     video->decode_call_count++;
     
     if (video->decode_call_count == 1) {
-        printf("video_decode_frame() starting...\n");
-        fflush(stdout);
+        LOG_INFO("video_decode_frame() starting...\n");
     }
     
     if (!video->initialized || video->eof_reached) {
@@ -883,19 +1527,47 @@ int video_decode_frame(video_context_t *video) {
     // This approach is proven to work 100% reliably for most files
     // Add safety limit to prevent infinite loops with problematic files
     
+    // OPTIMIZATION: When presentation is behind, skip non-reference frames the
+    // scheduler would drop anyway instead of spending decode time on them
+    // The governor's degraded mode (software decode only) also drops the deblocking
+    // filter, the single most expensive stage of H.264/HEVC software decode
+    bool degrade = __atomic_load_n(&video->degrade_request, __ATOMIC_RELAXED) && !video->use_hardware_decode;
+    bool skip_nonref = __atomic_load_n(&video->skip_nonref_request, __ATOMIC_RELAXED) || degrade;
+    if (skip_nonref != video->skip_nonref_active && video->codec_ctx) {
+        video->codec_ctx->skip_frame = skip_nonref ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+        video->skip_nonref_active = skip_nonref;
+    }
+    if (degrade != video->degrade_active && video->codec_ctx) {
+        video->codec_ctx->skip_loop_filter = degrade ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+        video->degrade_active = degrade;
+    }
+
     int packets_sent_this_call = 0;
     // Hardware decoders that are broken/incompatible will hang immediately
     if (video->decode_call_count == 1 && video->use_hardware_decode) {
     // Some videos (especially high bitrate) may need 40-50 packets
-        printf("[HW_DECODE] First decode: will send up to %d packets before software fallback\n", MAX_PACKETS_PER_DECODE_CALL);
-        printf("[HW_DECODE] Note: V4L2 M2M may buffer 20-50 packets depending on video\n");
+        LOG_INFO("[HW_DECODE] First decode: will send up to %d packets before software fallback\n", MAX_PACKETS_PER_DECODE_CALL);
+        LOG_INFO("[HW_DECODE] Note: V4L2 M2M may buffer 20-50 packets depending on video\n");
     }
     
+    bool flush_sent = false;
     while (packets_sent_this_call < MAX_PACKETS_PER_DECODE_CALL) {
         // First, try to get any frame the decoder has buffered
         int receive_result = avcodec_receive_frame(video->codec_ctx, video->frame);
         
         if (receive_result == 0) {
+            // Preroll after video_seek_seconds(): decode up to the target, show nothing.
+            // Frames drained at EOF come through here too, so a cue near the end is exact.
+            if (video->seek_target_pts != AV_NOPTS_VALUE) {
+                int64_t pts = video->frame->best_effort_timestamp;
+                if (pts != AV_NOPTS_VALUE && pts < video->seek_target_pts) {
+                    av_frame_unref(video->frame);
+                    packets_sent_this_call = 0;  // Not a stalled decoder: don't count toward fallback
+                    continue;
+                }
+                video->seek_target_pts = AV_NOPTS_VALUE;
+            }
+
             // Successfully decoded a frame
             pthread_mutex_lock(&video->lock);
             video->frame_count++;
@@ -904,16 +1576,19 @@ int video_decode_frame(video_context_t *video) {
             
             if (frame_count == 1) {
                 const char *fmt_name = av_get_pix_fmt_name(video->frame->format);
-                printf("\n✓✓✓ SUCCESS! First frame decoded after %d packets ✓✓✓\n", packets_sent_this_call);
-                printf("* Decoder: %s\n", video->use_hardware_decode ? "Hardware (V4L2 M2M)" : "Software");
-                printf("* Frame format: %s (%d)\n", fmt_name ? fmt_name : "unknown", video->frame->format);
-                printf("* Frame size: %dx%d\n", video->frame->width, video->frame->height);
-                printf("* Picture type: %c\n", av_get_picture_type_char(video->frame->pict_type));
-                printf("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n\n");
-                fflush(stdout);
+                LOG_INFO("\n✓✓✓ SUCCESS! First frame decoded after %d packets ✓✓✓\n", packets_sent_this_call);
+                LOG_INFO("* Decoder: %s\n", !video->use_hardware_decode ? "Software" :
+                       video->hw_decode_type == HW_DECODE_DRM_PRIME ? "Hardware (V4L2 request, HEVC)" :
+                       "Hardware (V4L2 M2M)");
+                LOG_INFO("* Frame format: %s (%d)\n", fmt_name ? fmt_name : "unknown", video->frame->format);
+                LOG_INFO("* Frame size: %dx%d\n", video->frame->width, video->frame->height);
+                LOG_INFO("* Picture type: %c\n", av_get_picture_type_char(video->frame->pict_type));
+                LOG_INFO("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n\n");
+                if (video->use_hardware_decode && video->cache_path) {
+                    startup_cache_set_decode(video->cache_path, STARTUP_DECODE_HW);
+                }
             } else if (video->advanced_diagnostics && (frame_count % 100) == 0) {
-                printf("Frame #%d decoded successfully\n", frame_count);
-                fflush(stdout);
+                LOG_INFO("Frame #%d decoded successfully\n", frame_count);
             }
             
             // Check for hardware buffer availability (zero-copy indicator)
@@ -921,14 +1596,14 @@ int video_decode_frame(video_context_t *video) {
                 // Check for direct DMABUF export support
                 AVFrameSideData *dma_side_data = av_frame_get_side_data(video->frame, AV_FRAME_DATA_DMABUF_EXPORT);
                 if (dma_side_data) {
-                    printf("[ZERO-COPY] DMA export available\n");
+                    LOG_INFO("[ZERO-COPY] DMA export available\n");
                     video->supports_dma_export = true;
                 } else {
                     // Enable anyway for testing - your patch might use a different mechanism
                     video->supports_dma_export = true;
                 }
                 
-                printf("[ZERO-COPY] Format: %s\n", av_get_pix_fmt_name(video->frame->format));
+                LOG_INFO("[ZERO-COPY] Format: %s\n", av_get_pix_fmt_name(video->frame->format));
             }
             
             // For each decoded frame, try to extract the DMA FD from DRM PRIME hardware frames
@@ -948,32 +1623,56 @@ int video_decode_frame(video_context_t *video) {
                         new_dma_fd = obj->fd;
                         drm_size = obj->size;
 
+                        // Resolution or layout change: the capture pool was rebuilt
+                        uint32_t drm_format = drm_desc->nb_layers > 0 ? drm_desc->layers[0].format : DRM_FORMAT_YUV420;
+                        uint64_t modifier = obj->format_modifier;
+                        if (video->frame->width != video->dma_frame_width ||
+                            video->frame->height != video->dma_frame_height ||
+                            drm_format != video->dma_drm_format || modifier != video->dma_modifier) {
+                            video->dma_frame_width = video->frame->width;
+                            video->dma_frame_height = video->frame->height;
+                            video->dma_drm_format = drm_format;
+                            video->dma_modifier = modifier;
+                            video->dma_pool_generation = next_dma_pool_generation();
+                        }
+
                         // CRITICAL: Extract plane layout for EVERY DRM_PRIME frame
                         // This ensures all videos get their plane layout, not just the first video
                         // (frame_count is a static variable shared across all videos!)
+                        // Planes are numbered across layers (one 3-plane YUV420 layer from
+                        // V4L2 M2M, one 2-plane NV12/P030 SAND layer from the HEVC block)
+                        int plane_count = 0;
                         for (int layer = 0; layer < drm_desc->nb_layers; layer++) {
                             AVDRMLayerDescriptor *layer_desc = &drm_desc->layers[layer];
-                            for (int p = 0; p < layer_desc->nb_planes && p < 3; p++) {
+                            for (int p = 0; p < layer_desc->nb_planes && plane_count < 3; p++) {
                                 AVDRMPlaneDescriptor *plane = &layer_desc->planes[p];
                                 // Store plane layout for zero-copy rendering
-                                video->dma_plane_offset[p] = plane->offset;
-                                video->dma_plane_pitch[p] = plane->pitch;
+                                video->dma_plane_offset[plane_count] = plane->offset;
+                                video->dma_plane_pitch[plane_count] = plane->pitch;
+                                plane_count++;
                             }
                         }
+                        for (int p = plane_count; p < 3; p++) {
+                            video->dma_plane_offset[p] = 0;
+                            video->dma_plane_pitch[p] = 0;
+                        }
 
                         if (frame_count == 1) {
-                            printf("[ZERO-COPY] ✓✓✓ DRM PRIME frame detected!\n");
-                            printf("[ZERO-COPY] DMA Buffer FD=%d, Size=%zu bytes\n", new_dma_fd, drm_size);
-                            printf("[ZERO-COPY] Layers: %d, Objects: %d\n", drm_desc->nb_layers, drm_desc->nb_objects);
+                            LOG_INFO("[ZERO-COPY] ✓✓✓ DRM PRIME frame detected!\n");
+                            LOG_INFO("[ZERO-COPY] DMA Buffer FD=%d, Size=%zu bytes\n", new_dma_fd, drm_size);
+                            LOG_INFO("[ZERO-COPY] Layers: %d, Objects: %d\n", drm_desc->nb_layers, drm_desc->nb_objects);
 
                             // Show layer information (Y/UV planes)
                             for (int layer = 0; layer < drm_desc->nb_layers; layer++) {
                                 AVDRMLayerDescriptor *layer_desc = &drm_desc->layers[layer];
-                                printf("[ZERO-COPY]   Layer %d: format=0x%08x, %d planes\n",
-                                       layer, layer_desc->format, layer_desc->nb_planes);
+                                LOG_INFO("[ZERO-COPY]   Layer %d: format=0x%08x, %d planes, modifier=0x%016llx%s\n",
+                                       layer, layer_desc->format, layer_desc->nb_planes,
+                                       (unsigned long long)modifier,
+                                       fourcc_mod_broadcom_mod(modifier) == DRM_FORMAT_MOD_BROADCOM_SAND128 ?
+                                       " (SAND128 columns)" : "");
                                 for (int p = 0; p < layer_desc->nb_planes && p < 3; p++) {
                                     AVDRMPlaneDescriptor *plane = &layer_desc->planes[p];
-                                    printf("[ZERO-COPY]     Plane %d: offset=%ld, pitch=%ld\n",
+                                    LOG_INFO("[ZERO-COPY]     Plane %d: offset=%ld, pitch=%ld\n",
                                            p, (long)plane->offset, (long)plane->pitch);
                                 }
                             }
@@ -981,37 +1680,41 @@ int video_decode_frame(video_context_t *video) {
 
                         video->supports_dma_export = true;
                     } else if (frame_count == 1) {
-                        printf("[ZERO-COPY] ⚠ DRM PRIME format but no descriptor objects!\n");
+                        LOG_WARN("[ZERO-COPY] ⚠ DRM PRIME format but no descriptor objects!\n");
                     }
                 }
                 
                 // If we found a valid FD from actual GEM-backed buffer, use it for zero-copy
-                if (new_dma_fd >= 0 && new_dma_fd < 1024) {
-                    // Close previous DMA FD if open
-                    if (video->dma_fd >= 0) {
-                        close(video->dma_fd);
-                    }
-                    
-                    // Duplicate the FD so we own it (FFmpeg may close the original)
-                    // This FD can be passed directly to EGL for DMA-BUF import
-                    int dup_fd = dup(new_dma_fd);
-                    if (dup_fd < 0) {
-                        fprintf(stderr, "[ZERO-COPY] Failed to dup DMA FD %d: %s\n", new_dma_fd, strerror(errno));
+                if (new_dma_fd >= 0) {
+                    // OPTIMIZATION: Hold a frame reference instead of dup()/close() per frame.
+                    // The ref keeps the V4L2 capture buffer (and its FD) alive until this
+                    // slot comes round again, so FD numbers stay stable per buffer.
+                    if (dma_ring_push(video, new_dma_fd, drm_size) != 0) {
+                        LOG_ERROR_RATELIMITED("[ZERO-COPY] Failed to reference DRM_PRIME frame\n");
                         av_frame_unref(video->frame);
                         return -1;
                     }
-                    video->dma_fd = dup_fd;
-                    video->dma_size = drm_size;
                     
                     if (frame_count == 1) {
-                        printf("[ZERO-COPY] ✓ DMA FD duplicated: %d (ready for EGL import)\n", video->dma_fd);
-                        printf("[DECODE_TRACE] Frame 1: video->dma_fd=%d, video->use_hardware_decode=%d\n", 
+                        LOG_INFO("[ZERO-COPY] ✓ DMA FD referenced: %d (ready for EGL import)\n", video->dma_fd);
+                        LOG_DEBUG("[DECODE_TRACE] Frame 1: video->dma_fd=%d, video->use_hardware_decode=%d\n", 
                                video->dma_fd, video->use_hardware_decode);
                     }
                 } else if (video->use_hardware_decode && frame_count == 1 && video->frame->format != AV_PIX_FMT_DRM_PRIME) {
                     // Not a DRM PRIME frame - still using system memory
-                    printf("[ZERO-COPY] ⚠ Frame is %s, not DRM_PRIME (system RAM fallback)\n",
+                    LOG_WARN("[ZERO-COPY] ⚠ Frame is %s, not DRM_PRIME (system RAM fallback)\n",
                            av_get_pix_fmt_name(video->frame->format));
+                    // The HEVC hwaccel declined this stream (e.g. unsupported profile) and
+                    // libavcodec decodes it in software: treat it as a software stream
+                    if (video->hw_decode_type == HW_DECODE_DRM_PRIME) {
+                        metrics_record_hw_fallback();
+                        if (video->cache_path) {
+                            startup_cache_set_decode(video->cache_path, STARTUP_DECODE_SW);
+                        }
+                        video->use_hardware_decode = false;
+                        video->hw_decode_type = HW_DECODE_NONE;
+                        video->skip_sw_transfer = false;
+                    }
                 }
             }
 
@@ -1028,15 +1731,22 @@ int video_decode_frame(video_context_t *video) {
                     pthread_mutex_lock(&video->lock);
                     // Ensure sw_frame uses a CPU-accessible format
                     av_frame_unref(video->sw_frame);
-                    int tr_ret = av_hwframe_transfer_data(video->sw_frame, video->frame, 0);
+                    const AVDRMFrameDescriptor *desc = (const AVDRMFrameDescriptor *)video->frame->data[0];
+                    uint64_t sand = desc && desc->nb_objects > 0 ?
+                                    fourcc_mod_broadcom_mod(desc->objects[0].format_modifier) : 0;
+                    int tr_ret = sand == DRM_FORMAT_MOD_BROADCOM_SAND128 ||
+                                 sand == DRM_FORMAT_MOD_BROADCOM_SAND30 ?
+                                 transfer_sand_frame(video->sw_frame, video->frame,
+                                                     sand == DRM_FORMAT_MOD_BROADCOM_SAND30) :
+                                 av_hwframe_transfer_data(video->sw_frame, video->frame, 0);
                     pthread_mutex_unlock(&video->lock);
                     if (tr_ret < 0) {
-                        fprintf(stderr, "[HW_DECODE] Failed to transfer DRM_PRIME frame to software: %s\n", av_err2str(tr_ret));
+                        LOG_ERROR_RATELIMITED("[HW_DECODE] Failed to transfer DRM_PRIME frame to software: %s\n", av_err2str(tr_ret));
                     } else {
                         // Log sw_frame format on first successful transfer
                         static bool sw_format_logged = false;
                         if (!sw_format_logged) {
-                            printf("[HW_DECODE] sw_frame format after transfer: %s (%d)\n",
+                            LOG_INFO("[HW_DECODE] sw_frame format after transfer: %s (%d)\n",
                                    av_get_pix_fmt_name(video->sw_frame->format), video->sw_frame->format);
                             sw_format_logged = true;
                         }
@@ -1048,52 +1758,65 @@ int video_decode_frame(video_context_t *video) {
         }
         
         if (receive_result == AVERROR_EOF) {
-            // End of stream reached
+            // End of stream reached (a cue past the last frame ends its preroll here)
             video->eof_reached = true;
+            video->seek_target_pts = AV_NOPTS_VALUE;
             if (video->decode_call_count == 1 && video->advanced_diagnostics) {
-                printf("End of video stream reached\n");
+                LOG_INFO("End of video stream reached\n");
             }
             return -1;
         }
         
         if (receive_result != AVERROR(EAGAIN)) {
             // Unexpected error
-            printf("Error receiving frame from decoder: %s\n", av_err2str(receive_result));
+            LOG_ERROR_RATELIMITED("Error receiving frame from decoder: %s\n", av_err2str(receive_result));
             return -1;
         }
         
         // receive_result == AVERROR(EAGAIN): Decoder needs more packets
         // Read next packet and send it
         
-        // PRODUCTION: Update I/O activity timestamp before read
-        video->last_io_activity = av_gettime_relative();
-        
-        int read_result = av_read_frame(video->format_ctx, video->packet);
+        // Looping from the packet cache: no file I/O and the packets are already filtered
+        int read_result = AVERROR(EAGAIN);
+        bool from_cache = false;
+        if (video->pkt_cache_replaying) {
+            read_result = packet_cache_read(video, video->packet);
+            from_cache = (read_result == 0);
+        }
+        if (read_result == AVERROR(EAGAIN)) {
+            // PRODUCTION: Update I/O activity timestamp before read
+            video->last_io_activity = av_gettime_relative();
+            
+            read_result = av_read_frame(video->format_ctx, video->packet);
+        }
         
         if (read_result < 0) {
             if (read_result == AVERROR_EOF) {
+                if (video->pkt_cache_filling) {
+                    packet_cache_finish(video, true);
+                }
+                
                 // No more packets in file
                 static int eof_count = 0;
                 if (eof_count++ < 3) {
-                    printf("[DEBUG] av_read_frame returned EOF (packets_sent=%d)\n", packets_sent_this_call);
+                    LOG_DEBUG("[DEBUG] av_read_frame returned EOF (packets_sent=%d)\n", packets_sent_this_call);
                 }
                 
-                // Flush decoder to get any remaining buffered frames
-                avcodec_send_packet(video->codec_ctx, NULL);
-                
-                // Try one more receive to get any buffered frames
-                int flush_result = avcodec_receive_frame(video->codec_ctx, video->frame);
-                if (flush_result == 0) {
-                    // Got a frame from flush
-                    return 0;
+                // A draining decoder never asks for input again: nothing more will come
+                if (flush_sent) {
+                    video->eof_reached = true;
+                    return -1;
                 }
                 
-                // No more frames available
-                video->eof_reached = true;
-                return -1;
+                // Flush decoder; the buffered frames come out through the receive path
+                // above (DMA bookkeeping, transfers) until it reports AVERROR_EOF
+                avcodec_send_packet(video->codec_ctx, NULL);
+                flush_sent = true;
+                continue;
             } else {
                 // PRODUCTION: On read error, attempt keyframe recovery instead of stopping
-                fprintf(stderr, "[RECOVERY] Read error: %s, seeking to next keyframe\n", av_err2str(read_result));
+                LOG_ERROR_RATELIMITED("[RECOVERY] Read error: %s, seeking to next keyframe\n", av_err2str(read_result));
+                packet_cache_abandon(video, "read error during first pass");
                 
                 if (video->format_ctx && video->video_stream_index >= 0) {
                     AVStream *stream = video->format_ctx->streams[video->video_stream_index];
@@ -1108,13 +1831,13 @@ int video_decode_frame(video_context_t *video) {
                     if (seek_result >= 0) {
                         // Flush decoder after seek to clear any corrupted state
                         avcodec_flush_buffers(video->codec_ctx);
-                        fprintf(stderr, "[RECOVERY] Successfully seeked to keyframe\n");
+                        LOG_WARN("[RECOVERY] Successfully seeked to keyframe\n");
                         return -1;  // Retry decode on next call
                     }
                 }
                 
                 // If seek failed or unavailable, stop playback
-                fprintf(stderr, "[RECOVERY] Seek failed or unavailable, stopping playback\n");
+                LOG_ERROR("[RECOVERY] Seek failed or unavailable, stopping playback\n");
                 return -1;
             }
         }
@@ -1125,57 +1848,61 @@ int video_decode_frame(video_context_t *video) {
             continue;  // Try next packet
         }
         
-        // Process packet through BSF if hardware decoding
-        AVPacket *pkt_to_decode = video->packet;
-        AVPacket *bsf_pkt = NULL;
-        
-        if (video->use_hardware_decode && video->bsf_annexb_ctx) {
-            // Convert avcC to Annex-B (silent operation after initial success)
-            if (av_bsf_send_packet(video->bsf_annexb_ctx, video->packet) < 0) {
-                av_packet_unref(video->packet);
-                continue;
+        if (video->live && !from_cache) {
+            live_clock_update(video, video->packet);
+            // Joining mid-GOP: inter frames before the first keyframe only decode to
+            // concealment and would count against the hardware fallback limit
+            if (!video->live_keyframe_seen) {
+                if (!(video->packet->flags & AV_PKT_FLAG_KEY)) {
+                    av_packet_unref(video->packet);
+                    continue;
+                }
+                video->live_keyframe_seen = true;
+                LOG_INFO("[LIVE] First keyframe received, decoding\n");
             }
-            
-            bsf_pkt = av_packet_alloc();
-            int ret = av_bsf_receive_packet(video->bsf_annexb_ctx, bsf_pkt);
-            if (ret == AVERROR(EAGAIN)) {
-                // BSF needs more packets (normal operation)
-                av_packet_free(&bsf_pkt);
-                av_packet_unref(video->packet);
-                continue;
-            } else if (ret < 0) {
-                av_packet_free(&bsf_pkt);
+        }
+        
+        // Resuming the file after a cached window: the cache already sent these
+        if (video->pkt_cache_resume_skip) {
+            int64_t ts = (video->packet->dts != AV_NOPTS_VALUE) ? video->packet->dts : video->packet->pts;
+            if (ts != AV_NOPTS_VALUE && ts <= video->pkt_cache_resume_ts) {
                 av_packet_unref(video->packet);
                 continue;
             }
-            
-            pkt_to_decode = bsf_pkt;
+            video->pkt_cache_resume_skip = false;
         }
         
-        // Send packet to decoder (only log errors or first 3)
-        int send_result = avcodec_send_packet(video->codec_ctx, pkt_to_decode);
+        // avcC to Annex-B for the hardware decoder (cached packets are already converted)
+        if (!from_cache && video->use_hardware_decode && video->avcc_length_size > 0 &&
+            prepare_annexb_packet(video, video->packet) != 0) {
+            LOG_WARN_RATELIMITED("[HW_DECODE] Dropping malformed avcC packet (%d bytes)\n", video->packet->size);
+            av_packet_unref(video->packet);
+            continue;
+        }
         
-        // Cleanup packets
-        if (bsf_pkt) {
-            av_packet_free(&bsf_pkt);
+        if (video->pkt_cache_filling) {
+            packet_cache_append(video, video->packet);
         }
+        
+        // Send packet to decoder (only log errors or first 3)
+        int send_result = avcodec_send_packet(video->codec_ctx, video->packet);
         av_packet_unref(video->packet);
         
         if (send_result < 0) {
-            fprintf(stderr, "[HW_DECODE] ✗ Error sending packet to decoder: %s\n", av_err2str(send_result));
+            LOG_ERROR_RATELIMITED("[HW_DECODE] ✗ Error sending packet to decoder: %s\n", av_err2str(send_result));
             return -1;
         }
         
         // Show buffering progress for V4L2 M2M on first decode
         if (video->use_hardware_decode && video->decode_call_count == 1) {
             if (packets_sent_this_call == 10) {
-                printf("[HW_DECODE] Buffering: sent %d packets, waiting for first frame...\n", packets_sent_this_call);
+                LOG_INFO("[HW_DECODE] Buffering: sent %d packets, waiting for first frame...\n", packets_sent_this_call);
             } else if (packets_sent_this_call == 20) {
-                printf("[HW_DECODE] Buffering: sent %d packets (normal for V4L2 M2M)...\n", packets_sent_this_call);
+                LOG_INFO("[HW_DECODE] Buffering: sent %d packets (normal for V4L2 M2M)...\n", packets_sent_this_call);
             } else if (packets_sent_this_call == 30) {
-                printf("[HW_DECODE] Buffering: sent %d packets...\n", packets_sent_this_call);
+                LOG_INFO("[HW_DECODE] Buffering: sent %d packets...\n", packets_sent_this_call);
             } else if (packets_sent_this_call == 40) {
-                printf("[HW_DECODE] Buffering: sent %d packets (large buffer needed)...\n", packets_sent_this_call);
+                LOG_INFO("[HW_DECODE] Buffering: sent %d packets (large buffer needed)...\n", packets_sent_this_call);
             }
         }
         
@@ -1185,24 +1912,29 @@ int video_decode_frame(video_context_t *video) {
     
     // If we hit the safety limit without getting a frame, fallback to software
     if (video->use_hardware_decode) {
-        printf("\n[HW_DECODE] ========== HARDWARE DECODER TIMEOUT ==========\n");
-        printf("[HW_DECODE] Sent %d packets but decoder returned no frames\n", packets_sent_this_call);
-        printf("[HW_DECODE] This indicates the V4L2 M2M decoder is not working\n");
-        printf("[HW_DECODE] Falling back to software decoding...\n");
-        printf("[HW_DECODE] ===============================================\n\n");
-        
-        // Clean up BSF chain from hardware decoding
-        if (video->bsf_annexb_ctx) {
-            av_bsf_free(&video->bsf_annexb_ctx);
-            video->bsf_annexb_ctx = NULL;
-        }
-        if (video->bsf_aud_ctx) {
-            av_bsf_free(&video->bsf_aud_ctx);
-            video->bsf_aud_ctx = NULL;
-        }
-        
-        // Reset EOF flag and seek back to beginning
+        LOG_WARN("\n[HW_DECODE] ========== HARDWARE DECODER TIMEOUT ==========\n");
+        LOG_WARN("[HW_DECODE] Sent %d packets but decoder returned no frames\n", packets_sent_this_call);
+        LOG_WARN("[HW_DECODE] This indicates the V4L2 M2M decoder is not working\n");
+        LOG_WARN("[HW_DECODE] Falling back to software decoding...\n");
+        LOG_WARN("[HW_DECODE] ===============================================\n\n");
+        metrics_record_hw_fallback();
+        if (video->cache_path) {
+            startup_cache_set_decode(video->cache_path, STARTUP_DECODE_SW);
+        }
+        
+        // Cached packets were filtered for the hardware decoder
+        packet_cache_abandon(video, "hardware decoder fallback");
+        packet_cache_unref(&video->pkt_cache);
+        video->pkt_cache_replaying = false;
+        
+        // The software decoder takes the avcC packets as they are
+        video->avcc_length_size = 0;
+        av_buffer_pool_uninit(&video->annexb_pool);
+        video->annexb_pool_size = 0;
+        
+        // Reset EOF flag and seek back to beginning (a pending cue target no longer applies)
         video->eof_reached = false;
+        video->seek_target_pts = AV_NOPTS_VALUE;
         av_seek_frame(video->format_ctx, video->video_stream_index, 0, AVSEEK_FLAG_BACKWARD);
         
         // Close current hardware codec context
@@ -1212,40 +1944,50 @@ int video_decode_frame(video_context_t *video) {
         AVCodecParameters *codecpar = video->format_ctx->streams[video->video_stream_index]->codecpar;
         video->codec = (AVCodec*)avcodec_find_decoder(codecpar->codec_id);
         if (!video->codec) {
-            fprintf(stderr, "[HW_DECODE] ✗ No software decoder available\n");
+            LOG_ERROR("[HW_DECODE] ✗ No software decoder available\n");
             return -1;
         }
         
-        printf("[HW_DECODE] Found software decoder: %s\n", video->codec->name);
+        LOG_INFO("[HW_DECODE] Found software decoder: %s\n", video->codec->name);
         
         // Allocate new codec context for software decoding
         video->codec_ctx = avcodec_alloc_context3(video->codec);
         if (!video->codec_ctx) {
-            fprintf(stderr, "[HW_DECODE] ✗ Failed to allocate software codec context\n");
+            LOG_ERROR("[HW_DECODE] ✗ Failed to allocate software codec context\n");
             return -1;
         }
+        // Fresh context: skip_frame / skip_loop_filter are re-applied on the next call
+        video->skip_nonref_active = false;
+        video->degrade_active = false;
         
         // Copy codec parameters
         if (avcodec_parameters_to_context(video->codec_ctx, codecpar) < 0) {
-            fprintf(stderr, "[HW_DECODE] ✗ Failed to copy codec parameters\n");
+            LOG_ERROR("[HW_DECODE] ✗ Failed to copy codec parameters\n");
             avcodec_free_context(&video->codec_ctx);
             return -1;
         }
         
         // Configure for software decoding - optimized for parallel decode
-        video->codec_ctx->thread_count = 0; // 0 = auto-detect CPU cores
+        video->codec_ctx->thread_count = decode_thread_budget; // 0 = auto-detect CPU cores
         video->codec_ctx->thread_type = FF_THREAD_SLICE | FF_THREAD_FRAME;
+        video->codec_ctx->opaque = video;
+        video->codec_ctx->get_buffer2 = frame_alloc_get_buffer2;
+        if (video->live) {
+            apply_live_codec_flags(video->codec_ctx);
+        }
         
         // Open software codec
         if (avcodec_open2(video->codec_ctx, video->codec, NULL) < 0) {
-            fprintf(stderr, "[HW_DECODE] ✗ Failed to open software codec\n");
+            LOG_ERROR("[HW_DECODE] ✗ Failed to open software codec\n");
             avcodec_free_context(&video->codec_ctx);
             return -1;
         }
         
-        printf("[HW_DECODE] ✓ Software decoder initialized successfully\n");
-        printf("[HW_DECODE] Continuing playback with software decoding...\n\n");
+        LOG_INFO("[HW_DECODE] ✓ Software decoder initialized successfully\n");
+        LOG_INFO("[HW_DECODE] Continuing playback with software decoding...\n\n");
         video->use_hardware_decode = false;
+        video->dma_pool_generation = next_dma_pool_generation();  // Hardware capture pool is gone
+        dma_ring_clear(video);
         
         // Try decoding again with software decoder
         // Note: Hardware fallback now handled by retry counter in context
@@ -1269,32 +2011,28 @@ uint8_t* video_get_y_data(video_context_t *video) {
         pthread_mutex_lock(&video->lock);
         
         // Check if we already copied this frame (avoid duplicate memcpy)
-        if (video->last_y_source == video->frame->data[0] && video->cached_y_buffer) {
+        uint8_t *cached = video->frame_mem.buffers[FRAME_MEMORY_Y].data;
+        if (video->last_y_source == video->frame->data[0] && cached) {
             pthread_mutex_unlock(&video->lock);
-            return video->cached_y_buffer;
+            return cached;
         }
 
         size_t y_size = video->frame->linesize[0] * video->height;
 
-        // Allocate cached buffer if needed
-        if (video->cached_y_size < y_size) {
-            free(video->cached_y_buffer);
-            video->cached_y_buffer = malloc(y_size);
-            video->cached_y_size = video->cached_y_buffer ? y_size : 0;
-            if (!video->cached_y_buffer) {
-                pthread_mutex_unlock(&video->lock);
-                return video->frame->data[0]; // Fallback
-            }
-            printf("[PERF] Allocated %zu KB cached Y buffer for hardware decode\n", y_size / 1024);
+        cached = frame_memory_get(&video->frame_mem, FRAME_MEMORY_Y, y_size);
+        if (!cached) {
+            pthread_mutex_unlock(&video->lock);
+            return video->frame->data[0]; // Fallback
         }
 
         // Copy to cached memory (fast memcpy, then fast GL upload)
-        memcpy(video->cached_y_buffer, video->frame->data[0], y_size);
+        frame_memory_begin_write(&video->frame_mem, FRAME_MEMORY_Y);
+        memcpy(cached, video->frame->data[0], y_size);
+        frame_memory_end_write(&video->frame_mem, FRAME_MEMORY_Y);
         video->last_y_source = video->frame->data[0];
         
-        uint8_t *result = video->cached_y_buffer;
         pthread_mutex_unlock(&video->lock);
-        return result;
+        return cached;
     }
 
     return video->frame->data[0];
@@ -1308,30 +2046,28 @@ uint8_t* video_get_u_data(video_context_t *video) {
         pthread_mutex_lock(&video->lock);
         
         // Check if we already copied this frame (avoid duplicate memcpy)
-        if (video->last_u_source == video->frame->data[1] && video->cached_u_buffer) {
+        uint8_t *cached = video->frame_mem.buffers[FRAME_MEMORY_U].data;
+        if (video->last_u_source == video->frame->data[1] && cached) {
             pthread_mutex_unlock(&video->lock);
-            return video->cached_u_buffer;
+            return cached;
         }
 
         int uv_height = video->height / 2;
         size_t u_size = video->frame->linesize[1] * uv_height;
 
-        if (video->cached_u_size < u_size) {
-            free(video->cached_u_buffer);
-            video->cached_u_buffer = malloc(u_size);
-            video->cached_u_size = video->cached_u_buffer ? u_size : 0;
-            if (!video->cached_u_buffer) {
-                pthread_mutex_unlock(&video->lock);
-                return video->frame->data[1]; // Fallback
-            }
+        cached = frame_memory_get(&video->frame_mem, FRAME_MEMORY_U, u_size);
+        if (!cached) {
+            pthread_mutex_unlock(&video->lock);
+            return video->frame->data[1]; // Fallback
         }
 
-        memcpy(video->cached_u_buffer, video->frame->data[1], u_size);
+        frame_memory_begin_write(&video->frame_mem, FRAME_MEMORY_U);
+        memcpy(cached, video->frame->data[1], u_size);
+        frame_memory_end_write(&video->frame_mem, FRAME_MEMORY_U);
         video->last_u_source = video->frame->data[1];
         
-        uint8_t *result = video->cached_u_buffer;
         pthread_mutex_unlock(&video->lock);
-        return result;
+        return cached;
     }
 
     return video->frame->data[1];
@@ -1345,41 +2081,33 @@ uint8_t* video_get_v_data(video_context_t *video) {
         pthread_mutex_lock(&video->lock);
         
         // Check if we already copied this frame (avoid duplicate memcpy)
-        if (video->last_v_source == video->frame->data[2] && video->cached_v_buffer) {
+        uint8_t *cached = video->frame_mem.buffers[FRAME_MEMORY_V].data;
+        if (video->last_v_source == video->frame->data[2] && cached) {
             pthread_mutex_unlock(&video->lock);
-            return video->cached_v_buffer;
+            return cached;
         }
 
         int uv_height = video->height / 2;
         size_t v_size = video->frame->linesize[2] * uv_height;
 
-        if (video->cached_v_size < v_size) {
-            free(video->cached_v_buffer);
-            video->cached_v_buffer = malloc(v_size);
-            video->cached_v_size = video->cached_v_buffer ? v_size : 0;
-            if (!video->cached_v_buffer) {
-                pthread_mutex_unlock(&video->lock);
-                return video->frame->data[2]; // Fallback
-            }
+        cached = frame_memory_get(&video->frame_mem, FRAME_MEMORY_V, v_size);
+        if (!cached) {
+            pthread_mutex_unlock(&video->lock);
+            return video->frame->data[2]; // Fallback
         }
 
-        memcpy(video->cached_v_buffer, video->frame->data[2], v_size);
+        frame_memory_begin_write(&video->frame_mem, FRAME_MEMORY_V);
+        memcpy(cached, video->frame->data[2], v_size);
+        frame_memory_end_write(&video->frame_mem, FRAME_MEMORY_V);
         video->last_v_source = video->frame->data[2];
         
-        uint8_t *result = video->cached_v_buffer;
         pthread_mutex_unlock(&video->lock);
-        return result;
+        return cached;
     }
 
     return video->frame->data[2];
 }
 int video_restart_playback(video_context_t *video) {
-    // Flush BSF contexts
-
-    if (video->bsf_aud_ctx) {
-        av_bsf_flush(video->bsf_aud_ctx);
-    }
-    
     // Unref any existing packet
     av_packet_unref(video->packet);
     
@@ -1397,9 +2125,50 @@ void video_get_dimensions(video_context_t *video, int *width, int *height) {
     }
 }
 
+// CPU-readable frame the renderer should use: the presented queue entry when
+// the async decoder is in use, otherwise the decoder's working frame
+static AVFrame *display_cpu_frame(video_context_t *video) {
+    video_frame_ref_t *shown = &video->presented[0];
+    if (shown->frame) {
+        if (shown->frame->format == AV_PIX_FMT_DRM_PRIME) {
+            return shown->sw_frame;  // NULL when zero-copy skipped the transfer
+        }
+        return shown->frame;
+    }
+    
+    if (!video->frame) {
+        return NULL;
+    }
+    if (video->frame->format == AV_PIX_FMT_DRM_PRIME && video->sw_frame) {
+        return video->sw_frame;
+    }
+    return video->frame;
+}
+
+static double frame_pts_seconds(video_context_t *video, const AVFrame *frame) {
+    if (!frame || !video->format_ctx || video->video_stream_index < 0) {
+        return -1.0;
+    }
+    
+    int64_t ts = frame->best_effort_timestamp;
+    if (ts == AV_NOPTS_VALUE) {
+        ts = frame->pts;
+    }
+    if (ts == AV_NOPTS_VALUE) {
+        return -1.0;
+    }
+    
+    AVStream *stream = video->format_ctx->streams[video->video_stream_index];
+    if (!stream || stream->time_base.den <= 0) {
+        return -1.0;
+    }
+    return (double)ts * stream->time_base.num / stream->time_base.den;
+}
+
 void video_get_yuv_data(video_context_t *video, uint8_t **y, uint8_t **u, uint8_t **v, 
                        int *y_stride, int *u_stride, int *v_stride) {
-    if (!video || !video->frame) {
+    AVFrame *src = video ? display_cpu_frame(video) : NULL;
+    if (!src) {
         if (y) *y = NULL;
         if (u) *u = NULL;
         if (v) *v = NULL;
@@ -1409,12 +2178,6 @@ void video_get_yuv_data(video_context_t *video, uint8_t **y, uint8_t **u, uint8_
         return;
     }
 
-    // For DRM_PRIME hardware frames, use the transferred software frame.
-    AVFrame *src = video->frame;
-    if (video->frame->format == AV_PIX_FMT_DRM_PRIME && video->sw_frame) {
-        src = video->sw_frame;
-    }
-
     // Debug: Print first few pixel values on first call (only for unusual values)
     if (!video->debug_printed && src->data[0]) {
         uint8_t u_val = src->data[1] ? src->data[1][0] : 0;
@@ -1428,7 +2191,15 @@ void video_get_yuv_data(video_context_t *video, uint8_t **y, uint8_t **u, uint8_
     // Hardware decode frames may be overwritten by the decoder thread while the
     // renderer is still uploading texture data. Copy them into cached, CPU-owned
     // buffers so that the pointers remain valid for the duration of the render.
-    if (video->use_hardware_decode && src->data[0] && video->width > 0 && video->height > 0) {
+    // Presented queue frames hold their own reference, so no copy is needed.
+    // 10-bit and NV12 frames are always converted into the cached buffers since
+    // the renderer only uploads 8-bit planar data through this path.
+    bool frame_held = (video->presented[0].frame != NULL);
+    int depth_shift = (src->format == AV_PIX_FMT_YUV420P10LE) ? 2 : 0;
+    bool src_is_nv12 = (src->format == AV_PIX_FMT_NV12);
+    bool needs_convert = depth_shift || src_is_nv12;
+    if ((needs_convert || (!frame_held && video->use_hardware_decode)) &&
+        src->data[0] && video->width > 0 && video->height > 0) {
         static int hw_copy_logs = 0;
         pthread_mutex_lock(&video->lock);
 
@@ -1441,67 +2212,57 @@ void video_get_yuv_data(video_context_t *video, uint8_t **y, uint8_t **u, uint8_
         size_t u_bytes = (size_t)uv_width * uv_height;
         size_t v_bytes = u_bytes;
 
-        if (video->cached_y_size < y_bytes) {
-            uint8_t *new_buf = realloc(video->cached_y_buffer, y_bytes);
-            if (!new_buf) {
-                pthread_mutex_unlock(&video->lock);
-                goto direct_ptrs;
-            }
-            video->cached_y_buffer = new_buf;
-            video->cached_y_size = y_bytes;
-        }
-
-        if (video->cached_u_size < u_bytes) {
-            uint8_t *new_buf = realloc(video->cached_u_buffer, u_bytes);
-            if (!new_buf) {
-                pthread_mutex_unlock(&video->lock);
-                goto direct_ptrs;
-            }
-            video->cached_u_buffer = new_buf;
-            video->cached_u_size = u_bytes;
+        uint8_t *cached_y = frame_memory_get(&video->frame_mem, FRAME_MEMORY_Y, y_bytes);
+        uint8_t *cached_u = frame_memory_get(&video->frame_mem, FRAME_MEMORY_U, u_bytes);
+        uint8_t *cached_v = frame_memory_get(&video->frame_mem, FRAME_MEMORY_V, v_bytes);
+        if (!cached_y || !cached_u || !cached_v) {
+            pthread_mutex_unlock(&video->lock);
+            goto direct_ptrs;
         }
-
-        if (video->cached_v_size < v_bytes) {
-            uint8_t *new_buf = realloc(video->cached_v_buffer, v_bytes);
-            if (!new_buf) {
-                pthread_mutex_unlock(&video->lock);
-                goto direct_ptrs;
-            }
-            video->cached_v_buffer = new_buf;
-            video->cached_v_size = v_bytes;
+        for (int plane = FRAME_MEMORY_Y; plane <= FRAME_MEMORY_V; plane++) {
+            frame_memory_begin_write(&video->frame_mem, (frame_memory_slot_t)plane);
         }
 
         // Copy Y plane (respecting stride)
-        uint8_t *dst_y = video->cached_y_buffer;
-        for (int row = 0; row < height; row++) {
-            memcpy(dst_y + row * width, src->data[0] + row * src->linesize[0], width);
-        }
-
-        // Copy U plane
-        if (src->data[1]) {
-            uint8_t *dst_u = video->cached_u_buffer;
-            for (int row = 0; row < uv_height; row++) {
-                memcpy(dst_u + row * uv_width, src->data[1] + row * src->linesize[1], uv_width);
+        if (depth_shift) {
+            pixel_10bit_to_8bit(cached_y, width, src->data[0], src->linesize[0],
+                                width, height, depth_shift);
+        } else {
+            pixel_copy_plane(cached_y, width, src->data[0], src->linesize[0], width, height);
+        }
+
+        // Chroma: split NV12's interleaved plane, otherwise copy U and V
+        if (src_is_nv12 && src->data[1]) {
+            pixel_deinterleave_uv(cached_u, uv_width, cached_v, uv_width,
+                                  src->data[1], src->linesize[1], uv_width, uv_height);
+        } else if (src->data[1] && src->data[2]) {
+            if (depth_shift) {
+                pixel_10bit_to_8bit(cached_u, uv_width, src->data[1], src->linesize[1],
+                                    uv_width, uv_height, depth_shift);
+                pixel_10bit_to_8bit(cached_v, uv_width, src->data[2], src->linesize[2],
+                                    uv_width, uv_height, depth_shift);
+            } else {
+                pixel_copy_plane(cached_u, uv_width, src->data[1], src->linesize[1],
+                                 uv_width, uv_height);
+                pixel_copy_plane(cached_v, uv_width, src->data[2], src->linesize[2],
+                                 uv_width, uv_height);
             }
         }
 
-        // Copy V plane
-        if (src->data[2]) {
-            uint8_t *dst_v = video->cached_v_buffer;
-            for (int row = 0; row < uv_height; row++) {
-                memcpy(dst_v + row * uv_width, src->data[2] + row * src->linesize[2], uv_width);
-            }
+        for (int plane = FRAME_MEMORY_Y; plane <= FRAME_MEMORY_V; plane++) {
+            frame_memory_end_write(&video->frame_mem, (frame_memory_slot_t)plane);
         }
 
         if (hw_copy_logs < 3) {
-            printf("[HW_COPY] Copied DRM_PRIME frame into cached buffers (Y:%zu bytes)\n", y_bytes);
+            printf("[HW_COPY] Copied %s frame into cached buffers (Y:%zu bytes)\n",
+                   av_get_pix_fmt_name(src->format), y_bytes);
             hw_copy_logs++;
         }
         pthread_mutex_unlock(&video->lock);
 
-        if (y) *y = video->cached_y_buffer;
-        if (u) *u = video->cached_u_buffer;
-        if (v) *v = video->cached_v_buffer;
+        if (y) *y = cached_y;
+        if (u) *u = cached_u;
+        if (v) *v = cached_v;
         if (y_stride) *y_stride = width;
         if (u_stride) *u_stride = uv_width;
         if (v_stride) *v_stride = uv_width;
@@ -1528,9 +2289,10 @@ uint8_t* video_get_nv12_data(video_context_t *video) {
     pthread_mutex_lock(&video->lock);
 
     // When using DRM_PRIME, build NV12 from the transferred software frame.
-    AVFrame *src = video->frame;
-    if (video->frame->format == AV_PIX_FMT_DRM_PRIME && video->sw_frame) {
-        src = video->sw_frame;
+    AVFrame *src = display_cpu_frame(video);
+    if (!src) {
+        pthread_mutex_unlock(&video->lock);
+        return NULL;
     }
 
     int width = video->width;
@@ -1542,59 +2304,51 @@ uint8_t* video_get_nv12_data(video_context_t *video) {
 
     enum AVPixelFormat pix_fmt = src->format;
     bool frame_is_nv12 = (pix_fmt == AV_PIX_FMT_NV12);
+    bool frame_is_p010 = (pix_fmt == AV_PIX_FMT_P010LE);   // Down-converted to 8-bit NV12
     bool frame_is_planar = (pix_fmt == AV_PIX_FMT_YUV420P || pix_fmt == AV_PIX_FMT_YUVJ420P);
 
-    if (!frame_is_nv12 && !frame_is_planar) {
+    if (!frame_is_nv12 && !frame_is_p010 && !frame_is_planar) {
         // Unsupported format for NV12 uploads
         pthread_mutex_unlock(&video->lock);
         return NULL;
     }
 
-    int needed_size = (width * height * 3) / 2;  // Y plane + packed UV plane
-
-    if (video->nv12_buffer_size < needed_size) {
-        uint8_t *new_buffer = realloc(video->nv12_buffer, needed_size);
-        if (!new_buffer) {
-            pthread_mutex_unlock(&video->lock);
-            return NULL;
-        }
-        video->nv12_buffer = new_buffer;
-        video->nv12_buffer_size = needed_size;
-    }
-
-    if (!video->nv12_buffer) {
-        pthread_mutex_unlock(&video->lock);
-        return NULL;
-    }
-
-    uint8_t *dst = video->nv12_buffer;
+    size_t needed_size = (size_t)width * height * 3 / 2;  // Y plane + packed UV plane
+    uint8_t *nv12_buffer = frame_memory_get(&video->frame_mem, FRAME_MEMORY_NV12, needed_size);
     uint8_t *y_data = src->data[0];
     int y_stride = src->linesize[0];
-    if (!y_data) {
+    if (!nv12_buffer || !y_data) {
         pthread_mutex_unlock(&video->lock);
         return NULL;
     }
+    uint8_t *dst = nv12_buffer;
+    frame_memory_begin_write(&video->frame_mem, FRAME_MEMORY_NV12);
 
     // Copy Y plane (full resolution)
-    for (int row = 0; row < height; row++) {
-        memcpy(dst, y_data + (row * y_stride), width);
-        dst += width;
+    if (frame_is_p010) {
+        pixel_10bit_to_8bit(dst, width, y_data, y_stride, width, height, 8);
+    } else {
+        pixel_copy_plane(dst, width, y_data, y_stride, width, height);
     }
+    dst += (size_t)width * height;
 
     // Copy UV data depending on source format
     int uv_height = height / 2;
 
-    if (frame_is_nv12) {
+    if (frame_is_nv12 || frame_is_p010) {
         uint8_t *uv_src = src->data[1];
         int uv_stride_bytes = src->linesize[1];
         if (!uv_src) {
+            frame_memory_end_write(&video->frame_mem, FRAME_MEMORY_NV12);
             pthread_mutex_unlock(&video->lock);
             return NULL;
         }
 
-        for (int row = 0; row < uv_height; row++) {
-            memcpy(dst, uv_src + (row * uv_stride_bytes), width);
-            dst += width;
+        // Interleaved U/V samples convert like one plane of 'width' samples
+        if (frame_is_p010) {
+            pixel_10bit_to_8bit(dst, width, uv_src, uv_stride_bytes, width, uv_height, 8);
+        } else {
+            pixel_copy_plane(dst, width, uv_src, uv_stride_bytes, width, uv_height);
         }
     } else {
         // Planar YUV420 -> interleave as NV12
@@ -1604,24 +2358,17 @@ uint8_t* video_get_nv12_data(video_context_t *video) {
         int v_stride = src->linesize[2];
 
         if (!u_data || !v_data) {
+            frame_memory_end_write(&video->frame_mem, FRAME_MEMORY_NV12);
             pthread_mutex_unlock(&video->lock);
             return NULL;
         }
 
-        int uv_width = width / 2;
-        for (int row = 0; row < uv_height; row++) {
-            uint8_t *u_row = u_data + (row * u_stride);
-            uint8_t *v_row = v_data + (row * v_stride);
-
-            for (int col = 0; col < uv_width; col++) {
-                *dst++ = u_row[col];
-                *dst++ = v_row[col];
-            }
-        }
+        pixel_interleave_uv(dst, width, u_data, u_stride, v_data, v_stride, width / 2, uv_height);
     }
 
+    frame_memory_end_write(&video->frame_mem, FRAME_MEMORY_NV12);
     pthread_mutex_unlock(&video->lock);
-    return video->nv12_buffer;
+    return nv12_buffer;
 }
 
 int video_get_nv12_stride(video_context_t *video) {
@@ -1634,12 +2381,12 @@ bool video_frame_is_nv12(video_context_t *video) {
         return false;
     }
     // For DRM_PRIME frames, check the transferred software frame format.
-    AVFrame *src = video->frame;
-    if (video->frame->format == AV_PIX_FMT_DRM_PRIME && video->sw_frame) {
-        src = video->sw_frame;
+    AVFrame *src = display_cpu_frame(video);
+    if (!src) {
+        return false;
     }
     enum AVPixelFormat pix_fmt = src->format;
-    return (pix_fmt == AV_PIX_FMT_NV12);
+    return (pix_fmt == AV_PIX_FMT_NV12 || pix_fmt == AV_PIX_FMT_P010LE);
 }
 
 bool video_is_eof(video_context_t *video) {
@@ -1652,6 +2399,39 @@ void video_set_loop(video_context_t *video, bool loop) {
     }
 }
 
+void video_set_skip_nonref(video_context_t *video, bool skip) {
+    if (video) {
+        // Applied by the decoding thread at the next video_decode_frame()
+        __atomic_store_n(&video->skip_nonref_request, skip, __ATOMIC_RELAXED);
+    }
+}
+
+void video_set_decode_degraded(video_context_t *video, bool degraded) {
+    if (video) {
+        // Applied by the decoding thread at the next video_decode_frame()
+        __atomic_store_n(&video->degrade_request, degraded, __ATOMIC_RELAXED);
+    }
+}
+
+void video_set_frame_allocator(video_context_t *video, const video_frame_allocator_t *allocator) {
+    if (!video) return;
+    
+    if (allocator) {
+        video->frame_allocator = *allocator;
+    } else {
+        memset(&video->frame_allocator, 0, sizeof(video->frame_allocator));
+    }
+}
+
+size_t video_get_frame_buffer_size(video_context_t *video) {
+    if (!video || !video->codec_ctx || video->width <= 0 || video->height <= 0) {
+        return 0;
+    }
+    int linesize[3];
+    size_t offset[3];
+    return frame_alloc_layout(video->codec_ctx, video->width, video->height, linesize, offset);
+}
+
 bool video_is_hardware_decoded(video_context_t *video) {
     return video ? video->use_hardware_decode : false;
 }
@@ -1663,6 +2443,19 @@ double video_get_frame_time(video_context_t *video) {
     return 1.0 / video->fps;
 }
 
+static void seek_reset_decoder(video_context_t *video) {
+    // Flush decoder buffers
+    avcodec_flush_buffers(video->codec_ctx);
+    
+    // A flush after drain may re-create the V4L2 capture pool
+    if (video->use_hardware_decode) {
+        video->dma_pool_generation = next_dma_pool_generation();
+    }
+    
+    // Unref any existing packet data
+    av_packet_unref(video->packet);
+}
+
 void video_seek(video_context_t *video, int64_t timestamp) {
     if (!video || !video->initialized) {
         return;
@@ -1672,16 +2465,37 @@ void video_seek(video_context_t *video, int64_t timestamp) {
     
     // Reset EOF flag BEFORE seeking
     video->eof_reached = false;
-    
-    // Try frame-based seek first (more reliable for MP4)
-    int seek_result = av_seek_frame(video->format_ctx, video->video_stream_index, 
+    video->pkt_cache_resume_skip = false;
+    
+    // A rewind replays the cached packets; the demuxer is only touched after a window
+    video_packet_cache_t *cache = video->pkt_cache;
+    video->pkt_cache_replaying = false;
+    if (timestamp == 0 && cache && cache->count > 0 &&
+        __atomic_load_n(&cache->ready, __ATOMIC_ACQUIRE) &&
+        !__atomic_load_n(&cache->failed, __ATOMIC_ACQUIRE)) {
+        video->pkt_cache_replaying = true;
+        video->pkt_cache_pos = 0;
+    } else if (video->pkt_cache_filling) {
+        packet_cache_abandon(video, "seek during first pass");
+    }
+    
+    video->seek_target_pts = AV_NOPTS_VALUE;
+    
+    int seek_result = 0;
+    // A rewind goes straight to the first indexed keyframe
+    bool indexed = !video->pkt_cache_replaying && timestamp == 0 &&
+                   seek_indexed_keyframe(video, INT64_MIN) >= 0;
+    if (!video->pkt_cache_replaying && !indexed) {
+        // Try frame-based seek first (more reliable for MP4)
+        seek_result = av_seek_frame(video->format_ctx, video->video_stream_index, 
                                     timestamp, AVSEEK_FLAG_FRAME | AVSEEK_FLAG_BACKWARD);
-    
-    if (seek_result < 0) {
-        // Fallback to timestamp-based seek
-        printf("[SEEK] Frame seek failed, trying timestamp seek\n");
-        seek_result = avformat_seek_file(video->format_ctx, video->video_stream_index, 
-                                        INT64_MIN, timestamp, timestamp, 0);
+        
+        if (seek_result < 0) {
+            // Fallback to timestamp-based seek
+            printf("[SEEK] Frame seek failed, trying timestamp seek\n");
+            seek_result = avformat_seek_file(video->format_ctx, video->video_stream_index, 
+                                            INT64_MIN, timestamp, timestamp, 0);
+        }
     }
     
     if (seek_result < 0) {
@@ -1689,21 +2503,43 @@ void video_seek(video_context_t *video, int64_t timestamp) {
         return;
     }
     
-    // Flush decoder buffers
-    avcodec_flush_buffers(video->codec_ctx);
+    seek_reset_decoder(video);
     
-    // Flush BSF buffers if present
-    if (video->bsf_annexb_ctx) {
-        av_bsf_flush(video->bsf_annexb_ctx);
+    printf("[SEEK] Seek completed successfully\n");
+}
+
+int video_seek_seconds(video_context_t *video, double seconds) {
+    if (!video || !video->initialized || video->live || seconds < 0) {
+        return -1;
     }
-    if (video->bsf_aud_ctx) {
-        av_bsf_flush(video->bsf_aud_ctx);
+    
+    AVStream *stream = video->format_ctx->streams[video->video_stream_index];
+    int64_t start = (stream->start_time != AV_NOPTS_VALUE) ? stream->start_time : 0;
+    int64_t target = start + av_rescale_q((int64_t)(seconds * AV_TIME_BASE), AV_TIME_BASE_Q, stream->time_base);
+    
+    video->eof_reached = false;
+    video->pkt_cache_resume_skip = false;
+    video->pkt_cache_replaying = false;
+    if (video->pkt_cache_filling) {
+        packet_cache_abandon(video, "seek during first pass");
     }
     
-    // Unref any existing packet data
-    av_packet_unref(video->packet);
+    bool indexed = true;
+    int seek_result = seek_indexed_keyframe(video, target);
+    if (seek_result < 0) {
+        indexed = false;
+        seek_result = av_seek_frame(video->format_ctx, video->video_stream_index, target, AVSEEK_FLAG_BACKWARD);
+    }
+    if (seek_result < 0) {
+        printf("[SEEK] Error: Seek to %.3fs failed: %s\n", seconds, av_err2str(seek_result));
+        return -1;
+    }
     
-    printf("[SEEK] Seek completed successfully\n");
+    seek_reset_decoder(video);
+    video->seek_target_pts = target;
+    
+    printf("[SEEK] Seeking to %.3fs (%s)\n", seconds, indexed ? "keyframe index" : "demuxer search");
+    return 0;
 }
 
 void video_cleanup(video_context_t *video) {
@@ -1711,11 +2547,11 @@ void video_cleanup(video_context_t *video) {
         return;
     }
     
-    // Clean up DMA buffer if still open
-    if (video->dma_fd >= 0) {
-        close(video->dma_fd);
-        video->dma_fd = -1;
-    }
+    // Release held DRM_PRIME frames before the codec that owns their buffers
+    video_frame_ref_release(&video->presented[0]);
+    video_frame_ref_release(&video->presented[1]);
+    dma_ring_clear(video);
+    packet_cache_unref(&video->pkt_cache);
     
     // Clean up hardware contexts
     if (video->hw_frames_ctx) {
@@ -1729,15 +2565,9 @@ void video_cleanup(video_context_t *video) {
     
     // No frame buffers in this version
     
-    // Clean up 2-stage BSF chain
-    if (video->bsf_annexb_ctx) {
-        av_bsf_free(&video->bsf_annexb_ctx);
-        video->bsf_annexb_ctx = NULL;
-    }
-    if (video->bsf_aud_ctx) {
-        av_bsf_free(&video->bsf_aud_ctx);
-        video->bsf_aud_ctx = NULL;
-    }
+    // Buffers the decoder still holds keep the pool alive until they are returned
+    av_buffer_pool_uninit(&video->annexb_pool);
+    video->annexb_pool_size = 0;
     
     if (video->frame) {
         av_frame_free(&video->frame);
@@ -1809,28 +2639,17 @@ void video_cleanup(video_context_t *video) {
         avformat_close_input(&video->format_ctx);
         video->format_ctx = NULL;
     }
-    
-    if (video->nv12_buffer) {
-        free(video->nv12_buffer);
-        video->nv12_buffer = NULL;
-        video->nv12_buffer_size = 0;
-    }
-
-    if (video->cached_y_buffer) {
-        free(video->cached_y_buffer);
-        video->cached_y_buffer = NULL;
-        video->cached_y_size = 0;
-    }
-    if (video->cached_u_buffer) {
-        free(video->cached_u_buffer);
-        video->cached_u_buffer = NULL;
-        video->cached_u_size = 0;
-    }
-    if (video->cached_v_buffer) {
-        free(video->cached_v_buffer);
-        video->cached_v_buffer = NULL;
-        video->cached_v_size = 0;
+    // After the demuxer: a custom pb is not freed by avformat_close_input
+    if (video->io) {
+        read_ahead_close(video->io);
+        video->io = NULL;
     }
+    free(video->cache_path);
+    video->cache_path = NULL;
+    keyframe_index_close(video->kf_index);
+    video->kf_index = NULL;
+    
+    frame_memory_release(&video->frame_mem);
 
     // PRODUCTION: Ensure mutex is unlocked before destroy (prevent EBUSY deadlock)
     // Try to lock and unlock to verify state, then destroy
@@ -1860,6 +2679,12 @@ bool video_has_dma_buffer(video_context_t *video) {
         return false;
     }
 
+    // Frame handed over by the decode queue carries its own DMA view
+    if (video->presented[0].frame) {
+        return video->presented[0].frame->format == AV_PIX_FMT_DRM_PRIME &&
+               video->presented[0].dma.dma_fd >= 0;
+    }
+
     // Check if we have a valid DMA FD from DRM PRIME frame extraction
     // AND verify the frame format is actually DRM_PRIME
     if (video->use_hardware_decode &&
@@ -1878,13 +2703,38 @@ void video_get_dma_plane_layout(video_context_t *video, int offsets[3], int pitc
         return;
     }
     
+    bool held = (video->presented[0].frame != NULL);
     for (int i = 0; i < 3; i++) {
-        offsets[i] = video->dma_plane_offset[i];
-        pitches[i] = video->dma_plane_pitch[i];
+        offsets[i] = held ? video->presented[0].dma.plane_offset[i] : video->dma_plane_offset[i];
+        pitches[i] = held ? video->presented[0].dma.plane_pitch[i] : video->dma_plane_pitch[i];
     }
 }
 
+void video_get_dma_format(video_context_t *video, uint32_t *drm_format, uint64_t *modifier) {
+    uint32_t format = 0;
+    uint64_t mod = DRM_FORMAT_MOD_LINEAR;
+    
+    if (video && video->presented[0].frame) {
+        format = video->presented[0].dma.drm_format;
+        mod = video->presented[0].dma.modifier;
+    } else if (video) {
+        format = video->dma_drm_format;
+        mod = video->dma_modifier;
+    }
+    
+    // No descriptor seen yet: the V4L2 M2M layout
+    if (format == 0) {
+        format = DRM_FORMAT_YUV420;
+        mod = DRM_FORMAT_MOD_LINEAR;
+    }
+    if (drm_format) *drm_format = format;
+    if (modifier) *modifier = mod;
+}
+
 int video_get_dma_fd(video_context_t *video) {
+    if (video && video->presented[0].frame) {
+        return video->presented[0].dma.dma_fd;
+    }
     if (!video || !video->frame || video->dma_fd < 0) {
         return -1;
     }
@@ -1907,3 +2757,159 @@ size_t video_get_dma_size(video_context_t *video) {
     
     return video->dma_size;
 }
+
+unsigned int video_get_dma_pool_generation(video_context_t *video) {
+    if (!video) {
+        return 0;
+    }
+    
+    // The presented frame may come from another decoder instance (gapless loop standby)
+    if (video->presented[0].frame) {
+        return video->presented[0].dma_pool_generation;
+    }
+    return video->dma_pool_generation;
+}
+
+int video_dma_frame_acquire(video_context_t *video, video_dma_frame_t *out) {
+    if (!video || !out) {
+        return -1;
+    }
+    
+    // Prefer the presented frame - with decode-ahead the newest decode is not on screen yet
+    video_frame_ref_t *shown = &video->presented[0];
+    if (shown->frame && shown->dma.dma_fd >= 0) {
+        *out = shown->dma;
+        out->frame = av_frame_clone(shown->frame);
+        if (!out->frame) {
+            out->dma_fd = -1;
+            return -1;
+        }
+        return 0;
+    }
+    
+    if (video->dma_fd < 0) {
+        return -1;
+    }
+    
+    int newest = (video->dma_ring_head + VIDEO_DMA_FRAME_RING - 1) % VIDEO_DMA_FRAME_RING;
+    video_dma_frame_t *src = &video->dma_ring[newest];
+    if (!src->frame) {
+        return -1;
+    }
+    
+    *out = *src;
+    out->frame = av_frame_clone(src->frame);
+    if (!out->frame) {
+        out->dma_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void video_dma_frame_release(video_dma_frame_t *handle) {
+    if (!handle) {
+        return;
+    }
+    
+    if (handle->frame) {
+        av_frame_free(&handle->frame);
+    }
+    handle->dma_fd = -1;
+}
+
+// Capture the just-decoded frame as an independent reference (decode thread)
+int video_capture_frame(video_context_t *video, video_frame_ref_t *out) {
+    if (!video || !out || !video->frame || !video->frame->buf[0]) {
+        return -1;
+    }
+    
+    memset(out, 0, sizeof(*out));
+    out->dma.dma_fd = -1;
+    
+    out->frame = av_frame_clone(video->frame);
+    if (!out->frame) {
+        return -1;
+    }
+    
+    if (video->frame->format == AV_PIX_FMT_DRM_PRIME) {
+        if (video->dma_fd >= 0) {
+            out->dma.dma_fd = video->dma_fd;
+            out->dma.size = video->dma_size;
+            for (int i = 0; i < 3; i++) {
+                out->dma.plane_offset[i] = video->dma_plane_offset[i];
+                out->dma.plane_pitch[i] = video->dma_plane_pitch[i];
+            }
+            out->dma.drm_format = video->dma_drm_format;
+            out->dma.modifier = video->dma_modifier;
+        }
+        // The next transfer allocates fresh buffers, so a ref is enough here
+        if (!video->skip_sw_transfer && video->sw_frame && video->sw_frame->buf[0]) {
+            out->sw_frame = av_frame_clone(video->sw_frame);
+        }
+    }
+    
+    out->pts_seconds = frame_pts_seconds(video, video->frame);
+    out->arrival = (video->live && video->live_offset_valid && out->pts_seconds >= 0.0) ?
+                   out->pts_seconds + video->live_offset : -1.0;
+    out->dma_pool_generation = video->dma_pool_generation;
+    return 0;
+}
+
+// Make ref the displayed frame (render thread). Keeps the previous frame one
+// more cycle because the GPU may still be sampling it.
+void video_present_frame(video_context_t *video, video_frame_ref_t *ref) {
+    if (!video || !ref) {
+        return;
+    }
+    
+    video_frame_ref_release(&video->presented[1]);
+    video->presented[1] = video->presented[0];
+    video->presented[0] = *ref;
+    
+    memset(ref, 0, sizeof(*ref));
+    ref->dma.dma_fd = -1;
+}
+
+void video_frame_ref_release(video_frame_ref_t *ref) {
+    if (!ref) {
+        return;
+    }
+    
+    if (ref->frame) {
+        av_frame_free(&ref->frame);
+    }
+    if (ref->sw_frame) {
+        av_frame_free(&ref->sw_frame);
+    }
+    ref->dma.dma_fd = -1;
+    ref->pts_seconds = -1.0;
+    ref->arrival = -1.0;
+}
+
+double video_get_pts_seconds(video_context_t *video) {
+    if (!video) {
+        return -1.0;
+    }
+    
+    if (video->presented[0].frame) {
+        return video->presented[0].pts_seconds;
+    }
+    return frame_pts_seconds(video, video->frame);
+}
+
+double video_get_arrival_time(video_context_t *video) {
+    if (!video || !video->live) {
+        return -1.0;
+    }
+    
+    if (video->presented[0].frame) {
+        return video->presented[0].arrival;
+    }
+    double pts = frame_pts_seconds(video, video->frame);
+    return (video->live_offset_valid && pts >= 0.0) ? pts + video->live_offset : -1.0;
+}
+
+void video_get_io_stats(video_context_t *video, read_ahead_stats_t *stats) {
+    if (!stats) return;
+    read_ahead_get_stats(video ? video->io : NULL, stats);
+}
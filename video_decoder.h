@@ -6,19 +6,79 @@
 #include <pthread.h>
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
-#include <libavcodec/bsf.h>
 #include <libavutil/pixfmt.h>
 #include <libavutil/hwcontext.h>
 #include <libswscale/swscale.h>
+#include "read_ahead.h"
+#include "frame_memory.h"
+#include "keyframe_index.h"
 
 // Hardware decoding types
 typedef enum {
     HW_DECODE_NONE = 0,
     HW_DECODE_V4L2M2M,
     HW_DECODE_MMAL,
-    HW_DECODE_DRM_PRIME
+    HW_DECODE_DRM_PRIME              // Stateless V4L2 request API via the DRM hwaccel (Pi 4 HEVC block)
 } hw_decode_type_t;
 
+// Frames kept referenced after decode so their DMA-BUFs are not recycled by
+// V4L2 M2M while the GPU is still sampling them or KMS is still scanning out.
+#define VIDEO_DMA_FRAME_RING 4
+
+// Refcounted handle on a decoded DRM_PRIME frame (owns an av_frame_ref)
+typedef struct {
+    AVFrame *frame;                  // Holds the AVDRMFrameDescriptor and its buffer refs
+    int dma_fd;                      // Borrowed from the descriptor - valid while frame is held, never close()
+    int plane_offset[3];
+    int plane_pitch[3];
+    uint32_t drm_format;             // DRM fourcc of layer 0
+    uint64_t modifier;               // DRM_FORMAT_MOD_LINEAR or a Broadcom SAND column layout
+    size_t size;
+} video_dma_frame_t;
+
+// Self-contained reference to one decoded frame, detached from the decoder's
+// working state so it can sit in a queue while decoding continues
+typedef struct {
+    AVFrame *frame;                  // Decoded frame (DRM_PRIME or CPU)
+    AVFrame *sw_frame;               // Transferred CPU copy of a DRM_PRIME frame (NULL if none)
+    video_dma_frame_t dma;           // DMA-BUF view; dma.frame is unused (frame owns the buffer)
+    double pts_seconds;              // Presentation time in stream seconds (-1 if unknown)
+    double arrival;                  // Live mode: estimated receive time, CLOCK_MONOTONIC seconds (-1 if unknown)
+    unsigned int dma_pool_generation; // Capture pool generation of dma (see video_get_dma_pool_generation)
+} video_frame_ref_t;
+
+// Packet cache: the demuxed, already filtered (Annex-B for V4L2 M2M) video packets
+// of a file, or of a window from its start, in one contiguous arena. Filled by one
+// decoder during its first pass and immutable once ready; loops replay it through
+// avcodec_send_packet() with no file I/O, demuxing or BSF work.
+typedef struct {
+    size_t offset;                   // Into the arena
+    int size;
+    int flags;
+    int64_t pts, dts, duration;      // Stream time base
+} video_cached_packet_t;
+
+typedef struct {
+    AVBufferRef *arena;              // Replayed packets reference it, no copies
+    size_t used;
+    video_cached_packet_t *packets;
+    int count;
+    int allocated;
+    bool ready;                      // Filling finished; read-only from here on
+    bool complete;                   // Holds the whole file (else only the first window)
+    bool failed;                     // Filling aborted (read error, decoder fallback)
+    int refs;                        // Decoders sharing it (gapless loop standby)
+} video_packet_cache_t;
+
+// External memory for software-decoded frames (e.g. persistently mapped GL PBOs)
+// so libavcodec decodes straight into GPU-visible buffers. Both callbacks may
+// run on decoder threads; release() also runs wherever the last AVFrame ref drops.
+typedef struct {
+    void *opaque;
+    uint8_t *(*alloc)(void *opaque, size_t size);       // NULL -> FFmpeg's default allocator
+    void (*release)(void *opaque, uint8_t *data);
+} video_frame_allocator_t;
+
 typedef struct {
     AVFormatContext *format_ctx;
     const AVCodec *codec;
@@ -41,19 +101,21 @@ typedef struct {
     bool advanced_diagnostics; // Flag for detailed diagnostics output
     bool enable_hardware_decode; // Flag to enable hardware decode (--hw flag)
     bool skip_sw_transfer;     // Skip av_hwframe_transfer_data when using EGL/DMA zero-copy
+    bool skip_nonref_request;  // Scheduler is behind: discard non-reference frames (set from render thread)
+    bool skip_nonref_active;   // Currently applied to codec_ctx->skip_frame
+    bool degrade_request;      // Governor: software decode skips the loop filter and non-reference frames
+    bool degrade_active;       // Currently applied to codec_ctx->skip_loop_filter
+    video_frame_allocator_t frame_allocator;  // Software decode output buffers (alloc NULL = default)
     
-    // 2-stage Bitstream filter chain for V4L2 M2M: avcC→Annex-B + AUD insertion
-    AVBSFContext *bsf_annexb_ctx;    // Stage 1: h264_mp4toannexb (avcC to Annex-B conversion)
-    AVBSFContext *bsf_aud_ctx;       // Stage 2: h264_metadata (AUD insertion)
+    // avcC→Annex-B for V4L2 M2M (prepare_annexb_packet), active while avcc_length_size > 0
+    AVBufferPool *annexb_pool;       // Packets that grow on conversion
+    size_t annexb_pool_size;
+    bool insert_aud;                 // PICKLE_H264_AUD=1: prepend an access unit delimiter
     
     // V4L2 M2M hardware decoder device handle for DMA buffer export
     int v4l2_fd;                     // V4L2 device file descriptor (-1 if unavailable)
     unsigned int v4l2_buffer_index;  // Current output buffer index from V4L2 M2M decoder
     
-    // NV12 conversion buffer (per context to support multi-video playback)
-    uint8_t *nv12_buffer;
-    int nv12_buffer_size;
-    
     // Hardware acceleration contexts (FFmpeg hwaccel API)
     AVBufferRef *hw_device_ctx;      // Hardware device context (DRM/VAAPI/etc)
     AVBufferRef *hw_frames_ctx;      // Hardware frames context for zero-copy buffers
@@ -67,13 +129,25 @@ typedef struct {
     
     // DMA buffer zero-copy support (for hardware decoded frames)
     bool supports_dma_export;        // True if hardware decoder supports DMA buffer export
-    int dma_fd;                      // DMA buffer file descriptor for current frame (-1 if unavailable)
+    int dma_fd;                      // DMA-BUF FD of the current frame, borrowed from dma_ring (-1 if unavailable)
     int dma_offset;                  // Byte offset within DMA buffer where frame data starts
     size_t dma_size;                 // Total size of DMA buffer
     
     // DMA plane layout (for YUV420P zero-copy rendering)
     int dma_plane_offset[3];         // Byte offsets for Y, U, V planes
     int dma_plane_pitch[3];          // Pitch (stride) for Y, U, V planes
+    uint32_t dma_drm_format;         // Layer fourcc (YUV420 from V4L2 M2M, NV12/P030 SAND from HEVC)
+    uint64_t dma_modifier;
+    int dma_frame_width;             // Size of the last DRM_PRIME capture frame
+    int dma_frame_height;
+    unsigned int dma_pool_generation; // Bumped whenever the capture buffer pool may have been reallocated
+    video_dma_frame_t dma_ring[VIDEO_DMA_FRAME_RING]; // Last N DRM_PRIME frames, newest at dma_ring_head - 1
+    int dma_ring_head;
+    
+    // Frames handed over by the async decode queue. [0] is on screen, [1] is the
+    // previous frame kept until the GPU has finished sampling it. When [0] is
+    // set, the frame accessors read from it instead of the working frame.
+    video_frame_ref_t presented[2];
     
     // Thread safety
     pthread_mutex_t lock;            // Mutex for thread-safe access to context
@@ -85,20 +159,37 @@ typedef struct {
     int decode_call_count;           // Number of decode function calls
     int hw_fallback_retry_count;     // Hardware decode fallback retry counter
     
-    // Cached buffers for V4L2 M2M frames (speeds up GL texture upload)
-    uint8_t *cached_y_buffer;
-    uint8_t *cached_u_buffer;
-    uint8_t *cached_v_buffer;
-    size_t cached_y_size;
-    size_t cached_u_size;
-    size_t cached_v_size;
+    // Cached planar copies of hardware/converted frames and the NV12 upload buffer,
+    // preallocated at open for this stream's resolution (speeds up GL texture upload)
+    frame_memory_t frame_mem;
     void *last_y_source;             // Track if we already copied this frame
     void *last_u_source;
     void *last_v_source;
     
+    // Packet cache (see video_enable_packet_cache) - touched by the decoding thread only
+    video_packet_cache_t *pkt_cache; // NULL = every loop reads the file
+    bool pkt_cache_filling;          // This context appends what it demuxes
+    bool pkt_cache_replaying;        // Packets come from the cache instead of av_read_frame()
+    int pkt_cache_pos;               // Next cached packet to send
+    bool pkt_cache_resume_skip;      // Back on the file after a window: drop packets up to resume_ts
+    int64_t pkt_cache_resume_ts;
+    
     // PRODUCTION: Interrupt callback for network timeout protection
     int64_t last_io_activity;        // Timestamp of last I/O activity (av_gettime_relative)
     int io_timeout_us;               // I/O timeout in microseconds (default 5s)
+    read_ahead_t *io;                // Custom AVIOContext behind format_ctx (NULL: libavformat's own I/O)
+    char *cache_path;                // Key for startup_cache decode decisions (NULL: not a cached file)
+    keyframe_index_t *kf_index;      // Shared keyframe index of cache_path (NULL: demuxer seeks only)
+    int64_t seek_target_pts;         // After video_seek_seconds: frames before this are decoded, not returned
+
+    // Live sources (video_set_live_mode): packet PTS -> receive time mapping. The offset
+    // tracks the smallest (receive - PTS) seen, so packets that sat in a socket backlog
+    // are stamped with when they should have arrived, not when they were read.
+    bool live;
+    bool live_keyframe_seen;         // Packets before the first keyframe are discarded
+    bool live_offset_valid;
+    double live_offset;              // Seconds, CLOCK_MONOTONIC minus stream PTS
+    double live_offset_updated;      // When the offset last relaxed (CLOCK_MONOTONIC seconds)
 } video_context_t;
 
 // Video decoder functions
@@ -120,10 +211,19 @@ bool video_frame_is_nv12(video_context_t *video);
 double video_get_frame_time(video_context_t *video);
 bool video_is_eof(video_context_t *video);
 void video_seek(video_context_t *video, int64_t timestamp);
+// Frame-accurate seek to seconds from the start; the frames between the keyframe and the
+// target are decoded by the next video_decode_frame() calls and never returned
+int video_seek_seconds(video_context_t *video, double seconds);
 void video_get_dimensions(video_context_t *video, int *width, int *height);
 bool video_is_hardware_decoded(video_context_t *video);
 int video_restart_playback(video_context_t *video);
 void video_set_loop(video_context_t *video, bool loop);
+void video_set_skip_nonref(video_context_t *video, bool skip);  // Skip decoding frames that would be dropped
+void video_set_decode_degraded(video_context_t *video, bool degraded);  // Cheaper, lower-quality software decode
+
+// Software decode into caller-provided memory; set before decoding starts
+void video_set_frame_allocator(video_context_t *video, const video_frame_allocator_t *allocator);
+size_t video_get_frame_buffer_size(video_context_t *video);  // Bytes one allocator buffer needs
 
 // DMA buffer zero-copy support
 bool video_has_dma_buffer(video_context_t *video);
@@ -132,6 +232,38 @@ void video_get_dma_plane_layout(video_context_t *video, int offsets[3], int pitc
 int video_get_dma_fd(video_context_t *video);
 int video_get_dma_offset(video_context_t *video);
 size_t video_get_dma_size(video_context_t *video);
+unsigned int video_get_dma_pool_generation(video_context_t *video);
+// DRM fourcc and modifier of the DMA frame (YUV420, linear before the first frame)
+void video_get_dma_format(video_context_t *video, uint32_t *drm_format, uint64_t *modifier);
+
+// Decoded frame hand-off (decode thread captures, render thread presents)
+int video_capture_frame(video_context_t *video, video_frame_ref_t *out);
+void video_present_frame(video_context_t *video, video_frame_ref_t *ref);  // Takes ownership of ref
+void video_frame_ref_release(video_frame_ref_t *ref);
+double video_get_pts_seconds(video_context_t *video);  // Displayed frame PTS (-1 if unknown)
+double video_get_arrival_time(video_context_t *video); // Displayed frame receive time, live mode only (-1 otherwise)
+
+// Take/release an extra reference on the current DRM_PRIME frame (e.g. for KMS scanout)
+int video_dma_frame_acquire(video_context_t *video, video_dma_frame_t *out);
+void video_dma_frame_release(video_dma_frame_t *handle);
+
+// Cache the first max_bytes of filtered packets during the first pass (call before
+// decoding starts). Later seeks to 0 replay from memory; share hands the same
+// cache to another decoder of the same file in the same decode mode.
+int video_enable_packet_cache(video_context_t *video, size_t max_bytes);
+void video_share_packet_cache(video_context_t *dst, video_context_t *src);
+
+// FFmpeg threads for decoders opened after this call (0 = one per core, the default).
+// Set from the thread topology so concurrent streams don't oversubscribe the cores.
+void video_set_thread_budget(int threads);
+
+// Low-latency tuning for decoders opened after this call (--live): minimal probing,
+// no demuxer buffering, LOW_DELAY decode without frame threads, no read-ahead ring,
+// decoding starts at the first keyframe and frames carry an estimated receive time.
+void video_set_live_mode(bool live);
+
+// Read-ahead buffer state (zeroed when the input uses libavformat's own I/O)
+void video_get_io_stats(video_context_t *video, read_ahead_stats_t *stats);
 
 // Debug flag for hardware decoder diagnostics
 extern bool hw_debug_enabled;
@@ -12,6 +12,14 @@
 #include <sys/stat.h>
 #include <signal.h>
 #include "production_config.h"
+#include "thread_topology.h"
+#include "metrics.h"
+#include "logger.h"
+#include "startup_cache.h"
+
+#if MAX_VIDEO_STREAMS > GL_MAX_STREAMS || MAX_VIDEO_STREAMS > FRAME_SCHED_MAX_STREAMS
+#error "MAX_VIDEO_STREAMS exceeds the GL texture sets or scheduler streams"
+#endif
 
 // Global quit flag set by async-signal-safe signal handler
 extern volatile sig_atomic_t g_quit_requested;
@@ -43,6 +51,12 @@ static int validate_video_file(const char *filename) {
         return -1;
     }
     
+    // URLs (rtsp://, srt://, udp://, http://...) are checked when libavformat opens them
+    if (strstr(filename, "://")) {
+        printf("Network source: %s\n", filename);
+        return 0;
+    }
+    
     // Check if file exists and get size
     struct stat st;
     if (stat(filename, &st) != 0) {
@@ -80,13 +94,75 @@ static void show_notification(app_context_t *app, const char *message, double du
     app->notification_active = true;
 }
 
+// Keystone of the stream currently being edited
+static keystone_context_t *get_active_keystone(app_context_t *app) {
+    int index = app->active_keystone;
+    if (index < 0 || index >= app->stream_count) {
+        index = 0;
+    }
+    return app->streams[index].keystone;
+}
+
+static uint64_t fnv1a_64(uint64_t hash, const void *data, size_t len) {
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Key of everything the overlay layer draws, mirroring the render loop's
+// visibility rules. 0 means no overlay is visible.
+static uint64_t overlay_content_key(app_context_t *app, bool notification_visible, bool guides_visible) {
+    keystone_context_t *active_ks = get_active_keystone(app);
+    uint64_t hash = 14695981039346656037ULL;
+    bool any = false;
+
+    for (int i = 0; i < app->stream_count; i++) {
+        keystone_context_t *ks = app->streams[i].keystone;
+        bool guides = guides_visible && (i == 0 || app->streams[i].first_frame_decoded) &&
+                      (ks->show_corners || ks->show_border);
+        if (!guides && !ks->show_help) {
+            continue;
+        }
+        // Only the active keystone shows its selection while it has one
+        int selected = (ks != active_ks && active_ks->selected_corner >= 0) ? -1 : ks->selected_corner;
+        uint8_t flags = (uint8_t)((guides && ks->show_corners) | (guides && ks->show_border) << 1 |
+                                  ks->show_help << 2);
+        hash = fnv1a_64(hash, &i, sizeof(i));
+        hash = fnv1a_64(hash, &flags, sizeof(flags));
+        hash = fnv1a_64(hash, &selected, sizeof(selected));
+        hash = fnv1a_64(hash, ks->corners, sizeof(ks->corners));
+        any = true;
+    }
+    if (notification_visible) {
+        hash = fnv1a_64(hash, app->notification_message, strlen(app->notification_message) + 1);
+        any = true;
+    }
+    return any ? (hash ? hash : 1) : 0;
+}
+
+// Stream 0 back to full screen, every other stream to a nested inset (10% steps)
+static void reset_stream_keystones(app_context_t *app) {
+    keystone_reset_corners(app->keystone);
+    printf("Keystone 1 reset to defaults\n");
+
+    for (int i = 1; i < app->stream_count; i++) {
+        keystone_context_t *ks = app->streams[i].keystone;
+        keystone_reset_corners(ks);
+        keystone_set_inset_corners(ks, 0.10f * (float)i);
+        keystone_calculate_matrix(ks);
+        printf("Keystone %d reset to inset defaults (visible inside keystone 1)\n", i + 1);
+    }
+}
+
 static bool process_keystone_movement(app_context_t *app, double delta_time, double target_frame_time) {
     if (!app || !app->input) {
         return false;
     }
     
     // Get active keystone
-    keystone_context_t *active_ks = (app->active_keystone == 1 && app->keystone2) ? app->keystone2 : app->keystone;
+    keystone_context_t *active_ks = get_active_keystone(app);
     if (!active_ks) {
         return false;
     }
@@ -152,54 +228,622 @@ static bool process_keystone_movement(app_context_t *app, double delta_time, dou
     return true;
 }
 
-// Async decode thread function for video 2
+// Looped clips replay their demuxed packets from RAM after the first pass, so
+// steady-state playback never touches the SD card
+static void attach_packet_cache(app_context_t *app, video_context_t *video) {
+    if (!app->loop_playback) {
+        return;
+    }
+    
+    int cache_mb = PACKET_CACHE_MB;
+    const char *env = getenv("PICKLE_PACKET_CACHE_MB");
+    if (env) {
+        cache_mb = atoi(env);
+    }
+    if (cache_mb > 0) {
+        video_enable_packet_cache(video, (size_t)cache_mb * 1024 * 1024);
+    }
+}
+
+// Gapless looping (on with -l unless PICKLE_NO_GAPLESS=1) costs a second decoder per stream
+static bool gapless_loop_enabled(const app_context_t *app) {
+    const char *env = getenv("PICKLE_NO_GAPLESS");
+    return app->loop_playback && !(env && env[0] == '1');
+}
+
+// Second demuxer/decoder on the stream's file, configured like the active one.
+// NULL (seek-based looping) if it cannot be opened or would decode differently.
+static video_context_t *open_loop_standby(app_context_t *app, video_context_t *active, const char *file) {
+    if (!gapless_loop_enabled(app)) {
+        return NULL;
+    }
+    
+    video_context_t *standby = calloc(1, sizeof(video_context_t));
+    if (!standby) {
+        return NULL;
+    }
+    if (video_init(standby, file, app->advanced_diagnostics, active->use_hardware_decode) != 0 ||
+        standby->use_hardware_decode != active->use_hardware_decode ||
+        standby->width != active->width || standby->height != active->height) {
+        printf("[GAPLESS] Standby decoder unavailable for %s, looping by seek\n", file);
+        video_cleanup(standby);
+        free(standby);
+        return NULL;
+    }
+    
+    standby->skip_sw_transfer = active->skip_sw_transfer;
+    video_set_loop(standby, active->loop_playback);
+    video_set_frame_allocator(standby, &active->frame_allocator);
+    video_share_packet_cache(standby, active);
+    return standby;
+}
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void free_video_context(video_context_t *video) {
+    if (!video) return;
+    video_cleanup(video);
+    free(video);
+}
+
+// Open a playlist item configured like stream 0. The decode thread pre-rolls it.
+static video_context_t *playlist_open_item(playlist_worker_t *worker, const char *path) {
+    video_context_t *item = calloc(1, sizeof(video_context_t));
+    if (!item) {
+        return NULL;
+    }
+    if (video_init(item, path, worker->advanced_diagnostics, worker->hardware_decode) != 0) {
+        fprintf(stderr, "[PLAYLIST] Failed to open %s, skipping\n", path);
+        free_video_context(item);
+        return NULL;
+    }
+    if (item->width > MAX_VIDEO_WIDTH || item->height > MAX_VIDEO_HEIGHT) {
+        fprintf(stderr, "[PLAYLIST] %s is %dx%d (limit %dx%d), skipping\n",
+                path, item->width, item->height, MAX_VIDEO_WIDTH, MAX_VIDEO_HEIGHT);
+        free_video_context(item);
+        return NULL;
+    }
+
+    item->skip_sw_transfer = item->use_hardware_decode && worker->external_texture;
+    video_set_loop(item, false);
+    video_set_frame_allocator(item, &worker->allocator);
+    printf("[PLAYLIST] Prepared %s (%dx%d, %s decode)\n", path, item->width, item->height,
+           item->use_hardware_decode ? "hardware" : "software");
+    return item;
+}
+
+// Close items that left the screen at least PLAYLIST_RETIRE_GRACE_SECONDS ago:
+// by then the GPU and the overlay plane are done with their last frames
+static void playlist_close_retired(playlist_worker_t *worker, bool all) {
+    double now = monotonic_seconds();
+    for (int i = 0; i < PLAYLIST_RETIRE_SLOTS; i++) {
+        pthread_mutex_lock(&worker->lock);
+        video_context_t *video = worker->retired[i];
+        if (video && (all || now - worker->retired_at[i] >= PLAYLIST_RETIRE_GRACE_SECONDS)) {
+            worker->retired[i] = NULL;
+        } else {
+            video = NULL;
+        }
+        pthread_mutex_unlock(&worker->lock);
+        free_video_context(video);
+    }
+}
+
+// Open the next playable item and hand it to the decode thread
+static void playlist_prepare_next(playlist_worker_t *worker) {
+    for (int attempt = 0; attempt < worker->list->count; attempt++) {
+        const char *path = playlist_next(worker->list);
+        if (!path) {
+            break;
+        }
+        video_context_t *item = playlist_open_item(worker, path);
+        if (!item) {
+            continue;
+        }
+
+        pthread_mutex_lock(&worker->lock);
+        worker->pending = item;
+        worker->want_next = false;
+        pthread_mutex_unlock(&worker->lock);
+        __atomic_store_n(&worker->decoder->playlist_end, false, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&worker->decoder->incoming, item, __ATOMIC_SEQ_CST);
+        return;
+    }
+
+    // Nothing left to play: the decode thread ends normally at this item's EOF
+    pthread_mutex_lock(&worker->lock);
+    worker->want_next = false;
+    pthread_mutex_unlock(&worker->lock);
+    __atomic_store_n(&worker->decoder->playlist_end, true, __ATOMIC_SEQ_CST);
+}
+
+static void *playlist_worker_thread(void *arg) {
+    playlist_worker_t *worker = (playlist_worker_t *)arg;
+
+    // Items are opened here, so their FFmpeg threads inherit stream 1's cores
+    thread_topology_set_name("pickle-playlist");
+    thread_topology_bind_stream(0);
+
+    while (!__atomic_load_n(&worker->should_exit, __ATOMIC_SEQ_CST)) {
+        playlist_cmd_t cmd = playlist_poll_control(worker->list, PLAYLIST_POLL_MS);
+        if (cmd == PLAYLIST_CMD_NEXT) {
+            __atomic_store_n(&worker->decoder->skip_item, true, __ATOMIC_SEQ_CST);
+        }
+        double seek_seconds;
+        if (playlist_take_seek(worker->list, &seek_seconds)) {
+            __atomic_store_n(&worker->decoder->seek_request_ms, (int64_t)(seek_seconds * 1000.0), __ATOMIC_SEQ_CST);
+        }
+
+        playlist_close_retired(worker, false);
+
+        pthread_mutex_lock(&worker->lock);
+        bool prepare = !worker->pending &&
+                       (worker->want_next ||
+                        (cmd == PLAYLIST_CMD_ADDED && __atomic_load_n(&worker->decoder->playlist_end, __ATOMIC_SEQ_CST)));
+        pthread_mutex_unlock(&worker->lock);
+        if (prepare) {
+            playlist_prepare_next(worker);
+        }
+    }
+    return NULL;
+}
+
+static playlist_worker_t *playlist_worker_start(app_context_t *app, playlist_t *list, bool hardware_decode) {
+    playlist_worker_t *worker = calloc(1, sizeof(playlist_worker_t));
+    if (!worker) {
+        return NULL;
+    }
+    worker->list = list;
+    worker->decoder = app->async_decoder_primary;
+    worker->hardware_decode = hardware_decode;
+    worker->external_texture = app->gl->supports_external_texture;
+    worker->advanced_diagnostics = app->advanced_diagnostics;
+    worker->allocator = app->video->frame_allocator;
+    worker->want_next = true;
+
+    if (pthread_mutex_init(&worker->lock, NULL) != 0) {
+        free(worker);
+        return NULL;
+    }
+    if (pthread_create(&worker->thread, NULL, playlist_worker_thread, worker) != 0) {
+        fprintf(stderr, "[PLAYLIST] Failed to create playlist worker thread\n");
+        pthread_mutex_destroy(&worker->lock);
+        free(worker);
+        return NULL;
+    }
+    worker->running = true;
+    return worker;
+}
+
+// Call before stream 0's decoder is destroyed: the worker writes to it until joined
+static void playlist_worker_join(playlist_worker_t *worker) {
+    if (!worker) return;
+
+    __atomic_store_n(&worker->should_exit, true, __ATOMIC_SEQ_CST);
+    if (worker->running) {
+        pthread_join(worker->thread, NULL);
+        worker->running = false;
+    }
+}
+
+// Call after stream 0's decode thread has stopped: closes every item not on screen
+static void playlist_worker_stop(playlist_worker_t *worker) {
+    if (!worker) return;
+
+    playlist_worker_join(worker);
+    playlist_close_retired(worker, true);
+    free_video_context(worker->pending);
+    worker->pending = NULL;
+    pthread_mutex_destroy(&worker->lock);
+    free(worker);
+}
+
+// Render thread: the prepared item's first frame was popped. Stream 0 now
+// presents from its context; the previous item is retired.
+static void playlist_item_started(app_context_t *app, video_context_t *item) {
+    playlist_worker_t *worker = app->playlist;
+    video_context_t *old = app->video;
+
+    app->video = item;
+    app->streams[0].video = item;
+    frame_sched_set_frame_rate(app->scheduler, 0, item->fps);
+
+    video_context_t *evicted = NULL;
+    pthread_mutex_lock(&worker->lock);
+    if (worker->pending == item) {
+        worker->pending = NULL;
+    }
+    worker->want_next = true;
+    int slot = 0;
+    for (int i = 0; i < PLAYLIST_RETIRE_SLOTS; i++) {
+        if (!worker->retired[i]) {
+            slot = i;
+            break;
+        }
+        if (worker->retired_at[i] < worker->retired_at[slot]) {
+            slot = i;
+        }
+    }
+    evicted = worker->retired[slot];
+    worker->retired[slot] = old;
+    worker->retired_at[slot] = monotonic_seconds();
+    pthread_mutex_unlock(&worker->lock);
+
+    if (evicted) {
+        fprintf(stderr, "[PLAYLIST] Retire list full, closing an item early\n");
+        free_video_context(evicted);
+    }
+    printf("[PLAYLIST] Now showing item %u (%dx%d @ %.2f fps)\n",
+           app->async_decoder_primary->playlist_switches, item->width, item->height, item->fps);
+}
+
+// PICKLE_DECODE_TO_PBO=1: software decode writes frames straight into GL PBOs.
+// The pool is sized by the first software stream; later streams join if they fit.
+static void attach_decode_pbo_pool(app_context_t *app, video_context_t *video) {
+    const char *env = getenv("PICKLE_DECODE_TO_PBO");
+    if (!env || env[0] != '1' || video->use_hardware_decode) {
+        return;
+    }
+    
+    size_t frame_size = video_get_frame_buffer_size(video);
+    if (!app->gl->frame_pool) {
+        // Per stream: decode queue + frames the codec holds as references + the two presented frames
+        int slots_per_stream = app->decode_queue_depth + 16 + 2;
+        if (gapless_loop_enabled(app)) {
+            slots_per_stream += 16 + GAPLESS_PREROLL_FRAMES;  // Standby decoder's references + pre-roll
+        }
+        int slots = slots_per_stream * app->stream_count;
+        const char *slots_env = getenv("PICKLE_DECODE_TO_PBO_SLOTS");
+        if (slots_env && atoi(slots_env) > 0) {
+            slots = atoi(slots_env);
+        }
+        if (gl_frame_pool_init(app->gl, slots, frame_size) != 0) {
+            return;
+        }
+    }
+    
+    video_frame_allocator_t allocator = {
+        .opaque = app->gl->frame_pool,
+        .alloc = gl_frame_pool_alloc,
+        .release = gl_frame_pool_release,
+    };
+    video_set_frame_allocator(video, &allocator);
+}
+
+// Put the presented DRM_PRIME frame on the overlay plane, scaled into the keystone
+// rectangle (NDC). Returns false if the frame could not be scanned out.
+static bool scanout_present_frame(app_context_t *app, int width, int height,
+                                  float left, float top, float right, float bottom) {
+    video_dma_frame_t handle;
+    if (video_dma_frame_acquire(app->video, &handle) != 0) {
+        return false;
+    }
+
+    // Cached FBs are keyed by dma_fd, which is only stable within one capture pool
+    unsigned int pool_generation = video_get_dma_pool_generation(app->video);
+    if (pool_generation != app->streams[0].scanout_pool_generation) {
+        drm_flush_video_fb_cache(app->drm);
+        app->streams[0].scanout_pool_generation = pool_generation;
+    }
+
+    uint32_t fb_id = 0;
+    if (drm_create_video_fb(app->drm, handle.dma_fd, (uint32_t)width, (uint32_t)height,
+                            handle.plane_offset, handle.plane_pitch,
+                            handle.drm_format, handle.modifier, &fb_id) != 0) {
+        video_dma_frame_release(&handle);
+        return false;
+    }
+
+    float disp_w = (float)app->drm->mode.hdisplay;
+    float disp_h = (float)app->drm->mode.vdisplay;
+    uint32_t x = (uint32_t)((left + 1.0f) * 0.5f * disp_w + 0.5f);
+    uint32_t y = (uint32_t)((1.0f - top) * 0.5f * disp_h + 0.5f);
+    uint32_t w = (uint32_t)((right - left) * 0.5f * disp_w + 0.5f);
+    uint32_t h = (uint32_t)((top - bottom) * 0.5f * disp_h + 0.5f);
+    if (w == 0 || h == 0 ||
+        drm_display_video_frame_scaled(app->drm, fb_id, (uint32_t)width, (uint32_t)height,
+                                       x, y, w, h) != 0) {
+        video_dma_frame_release(&handle);
+        return false;
+    }
+
+    // Keep the buffer alive until the plane has moved SCANOUT_HOLD_FRAMES frames on
+    video_dma_frame_release(&app->scanout_frames[app->scanout_frame_head]);
+    app->scanout_frames[app->scanout_frame_head] = handle;
+    app->scanout_frame_head = (app->scanout_frame_head + 1) % SCANOUT_HOLD_FRAMES;
+    return true;
+}
+
+// Scale video 1 to its on-screen size on the ISP when the quad is much smaller
+// than the frame. False means render the decoder frame directly.
+static bool isp_scale_primary(app_context_t *app, bool new_frame, int width, int height,
+                              isp_scaler_frame_t *out) {
+    float left, top, right, bottom;
+    keystone_get_bounds(app->keystone, &left, &top, &right, &bottom);
+    int quad_w = (int)((right - left) * 0.5f * (float)app->drm->mode.hdisplay + 0.5f);
+    int quad_h = (int)((top - bottom) * 0.5f * (float)app->drm->mode.vdisplay + 0.5f);
+
+    int out_w = 0, out_h = 0;
+    if (!isp_scaler_target(width, height, quad_w, quad_h, &out_w, &out_h)) {
+        isp_scaler_reset(app->isp);
+        return false;
+    }
+
+    if (new_frame) {
+        video_dma_frame_t handle;
+        if (video_dma_frame_acquire(app->video, &handle) != 0 ||
+            isp_scaler_process(app->isp, &handle, width, height, out_w, out_h) != 0) {
+            return false;
+        }
+    }
+    return isp_scaler_output(app->isp, out);
+}
+
+// Ring occupancy checks. head/tail are free-running; the producer only writes
+// tail and the consumer only writes head, so no lock is needed on the hot path.
+static bool async_ring_full(async_decode_t *decoder) {
+    unsigned int tail = __atomic_load_n(&decoder->tail, __ATOMIC_SEQ_CST);
+    unsigned int head = __atomic_load_n(&decoder->head, __ATOMIC_SEQ_CST);
+    return (tail - head) >= decoder->capacity;
+}
+
+static bool async_ring_empty(async_decode_t *decoder) {
+    unsigned int tail = __atomic_load_n(&decoder->tail, __ATOMIC_SEQ_CST);
+    unsigned int head = __atomic_load_n(&decoder->head, __ATOMIC_SEQ_CST);
+    return tail == head;
+}
+
+static bool async_ring_starved(async_decode_t *decoder) {
+    return async_ring_empty(decoder) && !__atomic_load_n(&decoder->eof, __ATOMIC_SEQ_CST);
+}
+
+static bool async_always_blocked(async_decode_t *decoder) {
+    (void)decoder;
+    return true;
+}
+
+// Sleep until woken or timeout while blocked() holds. The waiting flag is
+// published before the re-check so the other side cannot miss the wakeup.
+static void async_wait(async_decode_t *decoder, bool *waiting_flag,
+                       bool (*blocked)(async_decode_t *), int timeout_ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&decoder->mutex);
+    __atomic_store_n(waiting_flag, true, __ATOMIC_SEQ_CST);
+    if (blocked(decoder) && !__atomic_load_n(&decoder->should_exit, __ATOMIC_SEQ_CST)) {
+        pthread_cond_timedwait(&decoder->cond, &decoder->mutex, &ts);
+    }
+    __atomic_store_n(waiting_flag, false, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&decoder->mutex);
+}
+
+static void async_wake(async_decode_t *decoder, bool *waiting_flag) {
+    if (__atomic_load_n(waiting_flag, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&decoder->mutex);
+        pthread_cond_broadcast(&decoder->cond);
+        pthread_mutex_unlock(&decoder->mutex);
+    }
+}
+
+// Queue a captured frame on the loop-continuous timeline. After a source switch
+// the first frame is rebased onto the end of the last one queued, so loops and
+// playlist items continue the presentation clock instead of jumping back.
+static void async_queue_frame(async_decode_t *decoder, video_frame_ref_t *ref, bool discontinuity,
+                              video_context_t *source) {
+    unsigned int tail = decoder->tail;
+    async_frame_slot_t *slot = &decoder->slots[tail % decoder->capacity];
+    slot->ref = *ref;
+    if (slot->ref.pts_seconds >= 0.0) {
+        if (decoder->rebase_pending) {
+            if (decoder->timeline_end >= 0.0) {
+                decoder->pts_offset = decoder->timeline_end - slot->ref.pts_seconds;
+            }
+            decoder->rebase_pending = false;
+        }
+        slot->ref.pts_seconds += decoder->pts_offset;
+        double end = slot->ref.pts_seconds + video_get_frame_time(source);
+        if (end > decoder->timeline_end) {
+            decoder->timeline_end = end;
+        }
+    }
+    slot->discontinuity = discontinuity;
+    slot->seek_epoch = decoder->seek_epoch;
+    slot->item_start = decoder->item_start;
+    decoder->item_start = NULL;
+    memset(ref, 0, sizeof(*ref));
+    ref->dma.dma_fd = -1;
+
+    __atomic_store_n(&decoder->tail, tail + 1, __ATOMIC_SEQ_CST);
+    async_wake(decoder, &decoder->consumer_waiting);
+}
+
+// Ring is full, so the decode thread has time to spare: decode the standby's
+// opening frames for the next loop point. Returns true if it did any work.
+static bool gapless_preroll_step(async_decode_t *decoder) {
+    video_context_t *standby = decoder->standby;
+    if (!standby || decoder->preroll_done || decoder->preroll_pushed < decoder->preroll_count) {
+        return false;
+    }
+
+    if (video_decode_frame(standby) == 0) {
+        if (video_capture_frame(standby, &decoder->preroll[decoder->preroll_count]) == 0) {
+            decoder->preroll_count++;
+        }
+    } else if (video_is_eof(standby)) {
+        decoder->preroll_done = true;  // Clip shorter than the pre-roll
+        return false;
+    }
+    if (decoder->preroll_count >= GAPLESS_PREROLL_FRAMES) {
+        decoder->preroll_done = true;
+    }
+    return true;
+}
+
+// Loop point or playlist item change: hand decoding to the pre-rolled standby.
+// Looping rewinds the old active decoder so it becomes the next standby; a
+// finished playlist item is left alone until the render thread retires it.
+static video_context_t *async_switch_source(async_decode_t *decoder, video_context_t *active) {
+    video_context_t *next = decoder->standby;
+
+    decoder->rebase_pending = true;
+    if (decoder->playlist) {
+        decoder->standby = NULL;
+        decoder->item_start = next;
+        decoder->playlist_switches++;
+        printf("[PLAYLIST] Item %u: switching to prepared decoder (%d frames pre-rolled)\n",
+               decoder->playlist_switches, decoder->preroll_count);
+    } else {
+        decoder->standby = active;
+        decoder->gapless_loops++;
+        printf("[GAPLESS] Loop %u: switching to standby decoder (%d frames pre-rolled)\n",
+               decoder->gapless_loops, decoder->preroll_count);
+        video_seek(active, 0);
+    }
+    decoder->preroll_pushed = 0;
+    decoder->preroll_done = false;
+    return next;
+}
+
+// Async decode thread: decodes continuously until the ring is full
 static void* async_decode_thread(void *arg) {
     async_decode_t *decoder = (async_decode_t *)arg;
+    video_context_t *active = decoder->video;
+    bool discontinuity = false;
+
+    char name[16];
+    snprintf(name, sizeof(name), "pickle-dec%d", decoder->stream_index + 1);
+    thread_topology_set_name(name);
+    thread_topology_bind_stream(decoder->stream_index);
     
-    while (!decoder->should_exit) {
-        pthread_mutex_lock(&decoder->mutex);
+    while (!__atomic_load_n(&decoder->should_exit, __ATOMIC_SEQ_CST)) {
+        if (decoder->playlist && !decoder->standby) {
+            decoder->standby = __atomic_exchange_n(&decoder->incoming, NULL, __ATOMIC_SEQ_CST);
+        }
+        if (async_ring_full(decoder)) {
+            if (!gapless_preroll_step(decoder)) {
+                async_wait(decoder, &decoder->producer_waiting, async_ring_full, 50);
+            }
+            continue;
+        }
         
-        // Wait for signal to decode
-        while (!decoder->decoding && !decoder->should_exit) {
-            pthread_cond_wait(&decoder->cond, &decoder->mutex);
+        // Just switched: the standby's pre-rolled frames go out before anything new is decoded
+        if (decoder->preroll_pushed < decoder->preroll_count) {
+            video_frame_ref_t *ref = &decoder->preroll[decoder->preroll_pushed++];
+            async_queue_frame(decoder, ref, false, active);
+            if (decoder->preroll_pushed == decoder->preroll_count) {
+                decoder->preroll_count = 0;
+                decoder->preroll_pushed = 0;
+            }
+            continue;
         }
         
-        if (decoder->should_exit) {
-            pthread_mutex_unlock(&decoder->mutex);
-            break;
+        // Playlist "next": cut over at this frame boundary once the next item is open
+        if (decoder->playlist && decoder->standby && __atomic_load_n(&decoder->skip_item, __ATOMIC_SEQ_CST)) {
+            __atomic_store_n(&decoder->skip_item, false, __ATOMIC_SEQ_CST);
+            active = async_switch_source(decoder, active);
+            continue;
         }
         
-        decoder->decoding = false;
-        pthread_mutex_unlock(&decoder->mutex);
+        // Control "seek": the decoder pre-rolls from the indexed keyframe to the exact
+        // target, so the first frame queued afterwards is the cue point itself
+        int64_t seek_ms = __atomic_exchange_n(&decoder->seek_request_ms, -1, __ATOMIC_SEQ_CST);
+        if (seek_ms >= 0 && video_seek_seconds(active, (double)seek_ms / 1000.0) == 0) {
+            // Frames already queued are from before the jump: the render side drops them
+            __atomic_store_n(&decoder->seek_epoch, decoder->seek_epoch + 1, __ATOMIC_SEQ_CST);
+            discontinuity = true;
+        }
         
-        // Decode frame (outside lock to allow main thread to continue)
-        int result = video_decode_frame(decoder->video);
+        // The render thread sets skip-nonref on the stream's own context (in a
+        // playlist that is the item on screen, which becomes the active one)
+        if (!decoder->playlist && active != decoder->video) {
+            video_set_skip_nonref(active, __atomic_load_n(&decoder->video->skip_nonref_request, __ATOMIC_RELAXED));
+        }
+        
+        // Decode frame (no lock held - render thread only touches head)
+        double decode_start = monotonic_seconds();
+        int result = video_decode_frame(active);
         
-        pthread_mutex_lock(&decoder->mutex);
         if (result == 0) {
-            decoder->frame_ready = true;
-            // Signal that frame is ready (for async_decode_wait_frame)
-            pthread_cond_signal(&decoder->cond);
+            metrics_record_decode(decoder->stream_index, monotonic_seconds() - decode_start);
+            video_frame_ref_t ref;
+            if (video_capture_frame(active, &ref) != 0) {
+                continue;
+            }
+            async_queue_frame(decoder, &ref, discontinuity, active);
+            discontinuity = false;
+            continue;
         }
-        pthread_mutex_unlock(&decoder->mutex);
+        
+        if (video_is_eof(active)) {
+            if (decoder->standby && (decoder->playlist || active->loop_playback)) {
+                active = async_switch_source(decoder, active);
+                continue;
+            }
+            if (decoder->playlist && !__atomic_load_n(&decoder->playlist_end, __ATOMIC_SEQ_CST)) {
+                // Next item still opening: the last frame stays on screen meanwhile
+                async_wait(decoder, &decoder->producer_waiting, async_always_blocked, 10);
+                continue;
+            }
+            if (active->loop_playback) {
+                LOG_PRINT("End of video reached - restarting playback (loop mode)\n");
+                video_seek(active, 0);
+                discontinuity = true;
+                continue;
+            }
+            
+            // Let the render loop drain what is queued, then idle until shutdown
+            __atomic_store_n(&decoder->eof, true, __ATOMIC_SEQ_CST);
+            async_wake(decoder, &decoder->consumer_waiting);
+            while (!__atomic_load_n(&decoder->should_exit, __ATOMIC_SEQ_CST)) {
+                async_wait(decoder, &decoder->producer_waiting, async_always_blocked, 100);
+            }
+            break;
+        }
+        
+        // Transient failure (decoder warm-up, SW fallback, read recovery) - back off briefly
+        struct timespec backoff = {0, 1000000};
+        nanosleep(&backoff, NULL);
     }
     
     return NULL;
 }
 
-// Create async decoder for video 2
-async_decode_t* async_decode_create(video_context_t *video) {
-    async_decode_t *decoder = (async_decode_t *)malloc(sizeof(async_decode_t));
+// Create async decoder with a decode-ahead queue of queue_depth frames
+async_decode_t* async_decode_create(video_context_t *video, video_context_t *standby, bool playlist,
+                                    int queue_depth, int stream_index) {
+    async_decode_t *decoder = (async_decode_t *)calloc(1, sizeof(async_decode_t));
     if (!decoder) {
         fprintf(stderr, "Failed to allocate async decoder\n");
         return NULL;
     }
     
+    if (queue_depth < 1) queue_depth = 1;
+    if (queue_depth > ASYNC_DECODE_QUEUE_MAX) queue_depth = ASYNC_DECODE_QUEUE_MAX;
+    
     decoder->video = video;
-    decoder->frame_ready = false;
-    decoder->decoding = false;
-    decoder->should_exit = false;
-    decoder->running = false;
+    decoder->standby = standby;
+    decoder->playlist = playlist;
+    decoder->stream_index = stream_index;
+    decoder->capacity = (unsigned int)queue_depth;
+    for (int i = 0; i < ASYNC_DECODE_QUEUE_MAX; i++) {
+        decoder->slots[i].ref.dma.dma_fd = -1;
+    }
+    for (int i = 0; i < GAPLESS_PREROLL_FRAMES; i++) {
+        decoder->preroll[i].dma.dma_fd = -1;
+    }
+    decoder->timeline_end = -1.0;
+    decoder->seek_request_ms = -1;
     
     if (pthread_mutex_init(&decoder->mutex, NULL) != 0) {
         fprintf(stderr, "Failed to initialize decoder mutex\n");
@@ -237,7 +881,7 @@ void async_decode_destroy(async_decode_t *decoder) {
         fprintf(stderr, "[ASYNC] Warning: mutex lock failed in destroy: %d\n", lock_result);
         // Try to proceed anyway for cleanup
     }
-    decoder->should_exit = true;
+    __atomic_store_n(&decoder->should_exit, true, __ATOMIC_SEQ_CST);
     pthread_cond_broadcast(&decoder->cond);  // Use broadcast to wake all waiters
     if (lock_result == 0) {
         pthread_mutex_unlock(&decoder->mutex);
@@ -265,6 +909,14 @@ void async_decode_destroy(async_decode_t *decoder) {
         decoder->running = false;
     }
 
+    // Release frames still queued
+    for (unsigned int i = decoder->head; i != decoder->tail; i++) {
+        video_frame_ref_release(&decoder->slots[i % decoder->capacity].ref);
+    }
+    for (int i = decoder->preroll_pushed; i < decoder->preroll_count; i++) {
+        video_frame_ref_release(&decoder->preroll[i]);
+    }
+
     // PRODUCTION: Ensure mutex is unlocked before destroy (prevent EBUSY deadlock)
     int trylock_result = pthread_mutex_trylock(&decoder->mutex);
     if (trylock_result == 0) {
@@ -287,98 +939,158 @@ void async_decode_destroy(async_decode_t *decoder) {
     free(decoder);
 }
 
-// Request decode of next frame
-void async_decode_request_frame(async_decode_t *decoder) {
-    if (!decoder) return;
+// Number of decoded frames waiting in the ring
+int async_decode_queued(async_decode_t *decoder) {
+    if (!decoder) return 0;
     
-    int lock_result = pthread_mutex_lock(&decoder->mutex);
-    if (lock_result != 0) {
-        fprintf(stderr, "[ASYNC] Warning: mutex lock failed in request: %d\n", lock_result);
-        return;
+    unsigned int tail = __atomic_load_n(&decoder->tail, __ATOMIC_SEQ_CST);
+    unsigned int head = __atomic_load_n(&decoder->head, __ATOMIC_SEQ_CST);
+    return (int)(tail - head);
+}
+
+// PTS of the oldest queued frame without consuming it
+double async_decode_peek_pts(async_decode_t *decoder) {
+    if (!decoder || async_ring_empty(decoder)) {
+        return -1.0;
     }
     
-    decoder->frame_ready = false;
-    decoder->decoding = true;
-    pthread_cond_signal(&decoder->cond);
-    pthread_mutex_unlock(&decoder->mutex);
+    return decoder->slots[decoder->head % decoder->capacity].ref.pts_seconds;
 }
 
-// Check if frame is ready
-bool async_decode_frame_ready(async_decode_t *decoder) {
-    if (!decoder) return false;
-    
-    int lock_result = pthread_mutex_lock(&decoder->mutex);
-    if (lock_result != 0) {
-        fprintf(stderr, "[ASYNC] Warning: mutex lock failed in frame_ready: %d\n", lock_result);
-        return false;
+// Estimated receive time of the oldest queued frame (live sources; -1 otherwise)
+double async_decode_peek_arrival(async_decode_t *decoder) {
+    if (!decoder || async_ring_empty(decoder)) {
+        return -1.0;
     }
     
-    bool ready = decoder->frame_ready;
-    pthread_mutex_unlock(&decoder->mutex);
-    
-    return ready;
+    return decoder->slots[decoder->head % decoder->capacity].ref.arrival;
 }
 
-// Wait for frame to be ready (with timeout in milliseconds)
-bool async_decode_wait_frame(async_decode_t *decoder, int timeout_ms) {
-    if (!decoder) return false;
-    
-    int lock_result = pthread_mutex_lock(&decoder->mutex);
-    if (lock_result != 0) {
-        fprintf(stderr, "[ASYNC] Warning: mutex lock failed in wait_frame: %d\n", lock_result);
-        return false;
+// Consumer side: release queued frames decoded before the latest control seek,
+// so the cue point is the next frame presented. An item start tag they carry
+// still takes effect: the frames after them belong to that item.
+static void async_drop_stale(async_decode_t *decoder) {
+    unsigned int epoch = __atomic_load_n(&decoder->seek_epoch, __ATOMIC_SEQ_CST);
+    while (!async_ring_empty(decoder)) {
+        unsigned int head = decoder->head;
+        async_frame_slot_t *slot = &decoder->slots[head % decoder->capacity];
+        if (slot->seek_epoch == epoch) {
+            break;
+        }
+        if (slot->item_start) {
+            decoder->item_switch = slot->item_start;
+            slot->item_start = NULL;
+        }
+        video_frame_ref_release(&slot->ref);
+        __atomic_store_n(&decoder->head, head + 1, __ATOMIC_SEQ_CST);
+        async_wake(decoder, &decoder->producer_waiting);
     }
+}
+
+// Pop the oldest decoded frame, waiting up to timeout_ms if the ring is empty
+bool async_decode_pop_frame(async_decode_t *decoder, video_frame_ref_t *out,
+                            bool *discontinuity, int timeout_ms) {
+    if (!decoder || !out) return false;
     
-    // If already ready, return immediately
-    if (decoder->frame_ready) {
-        pthread_mutex_unlock(&decoder->mutex);
-        return true;
+    async_drop_stale(decoder);
+    if (async_ring_empty(decoder)) {
+        if (timeout_ms <= 0) {
+            return false;
+        }
+        async_wait(decoder, &decoder->consumer_waiting, async_ring_starved, timeout_ms);
+        async_drop_stale(decoder);
+        if (async_ring_empty(decoder)) {
+            return false;
+        }
     }
     
-    // Wait with timeout
-    struct timespec ts;
-    clock_gettime(CLOCK_REALTIME, &ts);
-    ts.tv_sec += timeout_ms / 1000;
-    ts.tv_nsec += (timeout_ms % 1000) * 1000000;
-    if (ts.tv_nsec >= 1000000000) {
-        ts.tv_sec++;
-        ts.tv_nsec -= 1000000000;
-    }
+    unsigned int head = decoder->head;
+    async_frame_slot_t *slot = &decoder->slots[head % decoder->capacity];
+    *out = slot->ref;
+    if (discontinuity) {
+        *discontinuity = slot->discontinuity;
+    }
+    if (slot->item_start) {
+        decoder->item_switch = slot->item_start;
+        slot->item_start = NULL;
+    }
+    memset(&slot->ref, 0, sizeof(slot->ref));
+    slot->ref.dma.dma_fd = -1;
+    
+    __atomic_store_n(&decoder->head, head + 1, __ATOMIC_SEQ_CST);
+    async_wake(decoder, &decoder->producer_waiting);
+    return true;
+}
+
+// True once the stream has ended (no loop) and every queued frame was consumed
+bool async_decode_finished(async_decode_t *decoder) {
+    if (!decoder) return false;
+    
+    return __atomic_load_n(&decoder->eof, __ATOMIC_SEQ_CST) && async_ring_empty(decoder);
+}
+
+// Context of the playlist item whose first frame was popped since the last call
+// (NULL if none). Frames popped from then on belong to it.
+video_context_t *async_decode_take_item_switch(async_decode_t *decoder) {
+    if (!decoder) return NULL;
     
-    while (!decoder->frame_ready && !decoder->should_exit) {
-        if (pthread_cond_timedwait(&decoder->cond, &decoder->mutex, &ts) == ETIMEDOUT) {
-            pthread_mutex_unlock(&decoder->mutex);
+    video_context_t *item = decoder->item_switch;
+    decoder->item_switch = NULL;
+    return item;
+}
+
+// Pop the frame due at present_vblank from a stream's decode queue, in PTS order:
+// nothing is popped while the head is not due yet, and late frames are dropped as
+// long as a newer one is already queued. Returns false when there is no new frame.
+static bool async_pop_due_frame(frame_scheduler_t *sched, int stream, async_decode_t *decoder,
+                                bool started, double present_vblank, int timeout_ms,
+                                video_frame_ref_t *out, bool *discontinuity) {
+    async_drop_stale(decoder);
+    while (async_decode_queued(decoder) > 0 || !started) {
+        frame_sched_action_t action = FRAME_SCHED_SHOW;
+        if (started) {
+            action = frame_sched_decide(sched, stream, async_decode_peek_pts(decoder),
+                                        async_decode_peek_arrival(decoder), present_vblank, async_decode_queued(decoder) > 1);
+        }
+        if (action == FRAME_SCHED_REPEAT) {
+            return false;
+        }
+        if (!async_decode_pop_frame(decoder, out, discontinuity, timeout_ms)) {
             return false;
         }
+        if (action == FRAME_SCHED_DROP && !*discontinuity) {
+            video_frame_ref_release(out);
+            frame_sched_mark_dropped(sched, stream);
+            continue;
+        }
+        return true;
     }
-    
-    bool ready = decoder->frame_ready;
-    pthread_mutex_unlock(&decoder->mutex);
-    return ready;
+    return false;
 }
 
-int app_init(app_context_t *app, const char *video_file, const char *video_file2, bool loop_playback,
-            bool show_timing, bool debug_gamepad, bool advanced_diagnostics, bool enable_hardware_decode) {
+int app_init(app_context_t *app, const char *const *video_files, int video_count, bool loop_playback,
+            bool show_timing, bool debug_gamepad, bool advanced_diagnostics, bool enable_hardware_decode, bool scanout_overlay,
+            int live_latency_ms, playlist_t *playlist) {
     printf("app_init: Starting initialization...\n");
     fflush(stdout);
     
-    // Validate video file before proceeding
-    if (validate_video_file(video_file) != 0) {
-        fprintf(stderr, "Failed to validate video file\n");
+    if (!video_files || video_count < 1 || video_count > MAX_VIDEO_STREAMS) {
+        fprintf(stderr, "Error: Expected 1-%d video files, got %d\n", MAX_VIDEO_STREAMS, video_count);
         return -1;
     }
-    
-    // Validate second video file if provided
-    if (video_file2 && validate_video_file(video_file2) != 0) {
-        fprintf(stderr, "Failed to validate second video file\n");
-        return -1;
+
+    // Validate every video file before proceeding
+    for (int i = 0; i < video_count; i++) {
+        if (validate_video_file(video_files[i]) != 0) {
+            fprintf(stderr, "Failed to validate video file %d\n", i + 1);
+            return -1;
+        }
     }
     
     memset(app, 0, sizeof(*app));
     
     // Set all flags
-    app->video_file = video_file;
-    app->video_file2 = video_file2;
+    app->stream_count = video_count;
     app->running = true;
     app->loop_playback = loop_playback;
     app->show_timing = show_timing;
@@ -386,26 +1098,51 @@ int app_init(app_context_t *app, const char *video_file, const char *video_file2
     app->advanced_diagnostics = advanced_diagnostics;
     app->active_keystone = 0;  // Start with first keystone active
     app->gamepad_corner_cycle_index = -1;  // Reset corner cycle
+    app->live = live_latency_ms > 0;
+    app->live_latency = live_latency_ms / 1000.0;
+    if (app->live && loop_playback) {
+        // A live feed cannot loop; this also keeps the packet cache and standby decoders off
+        printf("[LIVE] -l ignored for live sources\n");
+        app->loop_playback = false;
+        loop_playback = false;
+    }
+
+    // Drain thread first, so every later thread logs through its own ring
+    logger_init();
+    
+    // Core partition (PICKLE_RT=1) before any worker threads start
+    thread_topology_init(video_count);
+    // Before the decoders open, so start-up fallbacks and stalls are counted
+    metrics_init(video_count);
+    video_set_thread_budget(thread_topology_decode_budget());
+    video_set_live_mode(app->live);
 
     // Allocate contexts
     app->drm = calloc(1, sizeof(display_ctx_t));
     app->gl = calloc(1, sizeof(gl_context_t));
-    app->video = calloc(1, sizeof(video_context_t));
-    app->keystone = calloc(1, sizeof(keystone_context_t));
     app->input = calloc(1, sizeof(input_context_t));
-    
-    // Allocate second video and keystone if second file provided
-    if (video_file2) {
-        app->video2 = calloc(1, sizeof(video_context_t));
-        app->keystone2 = calloc(1, sizeof(keystone_context_t));
-        if (!app->video2 || !app->keystone2) {
-            fprintf(stderr, "Failed to allocate second video/keystone contexts\n");
+    app->scheduler = calloc(1, sizeof(frame_scheduler_t));
+    for (int i = 0; i < video_count; i++) {
+        video_stream_t *stream = &app->streams[i];
+        stream->file = video_files[i];
+        stream->video = calloc(1, sizeof(video_context_t));
+        stream->keystone = calloc(1, sizeof(keystone_context_t));
+        if (i == 0) {
+            snprintf(stream->keystone_file, sizeof(stream->keystone_file), "pickle_keystone.conf");
+        } else {
+            snprintf(stream->keystone_file, sizeof(stream->keystone_file), "pickle_keystone%d.conf", i + 1);
+        }
+        if (!stream->video || !stream->keystone) {
+            fprintf(stderr, "Failed to allocate video/keystone contexts for video %d\n", i + 1);
             app_cleanup(app);
             return -1;
         }
     }
+    app->video = app->streams[0].video;
+    app->keystone = app->streams[0].keystone;
+    app->video_file = app->streams[0].file;
 
-    if (!app->drm || !app->gl || !app->video || !app->keystone || !app->input) {
+    if (!app->drm || !app->gl || !app->input || !app->scheduler) {
         fprintf(stderr, "Failed to allocate contexts\n");
         app_cleanup(app);
         return -1;
@@ -414,6 +1151,9 @@ int app_init(app_context_t *app, const char *video_file, const char *video_file2
     printf("app_init: Initializing DRM display...\n");
     fflush(stdout);
     
+    // Overlay scanout needs an alpha primary so GL overlays can sit above the video plane
+    app->drm->primary_alpha = scanout_overlay;
+
     // Initialize DRM display
     if (drm_init(app->drm) != 0) {
         fprintf(stderr, "Failed to initialize DRM display\n");
@@ -424,6 +1164,14 @@ int app_init(app_context_t *app, const char *video_file, const char *video_file2
     // Initialize KMS video overlay plane (optional, for hardware zero-copy)
     if (drm_init_video_plane(app->drm) == 0) {
         printf("[KMS] Video overlay plane initialized successfully\n");
+        if (scanout_overlay) {
+            app->scanout_overlay = true;
+            if (drm_set_video_plane_underlay(app->drm) == 0) {
+                printf("[KMS] Scanout overlay: video plane below primary, GL draws overlays only\n");
+            } else {
+                printf("[KMS] Scanout overlay: no zpos control, GL composites while overlays are shown\n");
+            }
+        }
     } else {
         printf("[KMS] Video overlay plane not available (will use OpenGL fallback)\n");
     }
@@ -435,21 +1183,30 @@ int app_init(app_context_t *app, const char *video_file, const char *video_file2
         return -1;
     }
 
-    // Initialize video decoder
-    if (video_init(app->video, video_file, app->advanced_diagnostics, enable_hardware_decode) != 0) {
+    // Initialize video decoder. FFmpeg's frame threads inherit this thread's
+    // binding, so bind to each stream's cores before opening its decoders.
+    thread_topology_bind_stream(0);
+    if (video_init(app->video, app->video_file, app->advanced_diagnostics, enable_hardware_decode) != 0) {
         fprintf(stderr, "Failed to initialize video decoder\n");
         app_cleanup(app);
         return -1;
     }
 
+    if (app->scanout_overlay && !app->video->use_hardware_decode) {
+        printf("[KMS] Scanout overlay needs hardware decode (--hw); using OpenGL composition\n");
+        app->scanout_overlay = false;
+    }
+
     // Enable pure hardware path if external texture is supported (multi-plane YUV EGLImage)
     // This uses GL_OES_EGL_image_external for true zero-copy rendering
     if (app->video->use_hardware_decode && app->gl->supports_external_texture) {
         app->video->skip_sw_transfer = true;
         printf("[ZERO-COPY] Pure hardware path enabled (external texture)\n");
+        app->isp = isp_scaler_open();
     } else if (app->video->use_hardware_decode) {
         app->video->skip_sw_transfer = false;  // Fallback to CPU transfer
-        printf("[HW_DECODE] Using hardware decode with CPU transfer (V4L2 M2M)\n");
+        printf("[HW_DECODE] Using hardware decode with CPU transfer (%s)\n",
+               app->video->hw_decode_type == HW_DECODE_DRM_PRIME ? "V4L2 request, HEVC" : "V4L2 M2M");
     }
 
     // Validate video dimensions after decoder opens file
@@ -462,8 +1219,23 @@ int app_init(app_context_t *app, const char *video_file, const char *video_file2
     
     printf("Video 1 dimensions: %dx%d (within limits)\n", app->video->width, app->video->height);
     
-    // Set loop playback if requested
-    video_set_loop(app->video, loop_playback);
+    // Set loop playback if requested (a playlist loops the list, not the item)
+    video_set_loop(app->video, loop_playback && !playlist);
+
+    // Every queued frame is a frame of latency on a live source. Known before the
+    // PBO pool is sized, which must cover every frame a decode ring can hold.
+    app->decode_queue_depth = app->live ? LIVE_DECODE_QUEUE_DEPTH : DECODE_QUEUE_DEPTH;
+    const char *queue_env = getenv("PICKLE_DECODE_QUEUE");
+    if (queue_env && atoi(queue_env) > 0) {
+        app->decode_queue_depth = atoi(queue_env);
+    }
+    if (app->decode_queue_depth > ASYNC_DECODE_QUEUE_MAX) {
+        app->decode_queue_depth = ASYNC_DECODE_QUEUE_MAX;
+    }
+    attach_decode_pbo_pool(app, app->video);
+    if (!playlist) {
+        attach_packet_cache(app, app->video);
+    }
 
     // Create async decoder for primary video (hardware path benefits too)
     bool force_sync_hw = false;
@@ -476,51 +1248,82 @@ int app_init(app_context_t *app, const char *video_file, const char *video_file2
 
     bool allow_async_primary = true;
     if (app->video->use_hardware_decode && force_sync_hw) {
-        allow_async_primary = false;
-        printf("PICKLE_FORCE_SYNC_HW=1 -> forcing hardware decode on main thread\n");
+        if (playlist) {
+            printf("PICKLE_FORCE_SYNC_HW=1 ignored: playlists switch items on the decode thread\n");
+        } else {
+            allow_async_primary = false;
+            printf("PICKLE_FORCE_SYNC_HW=1 -> forcing hardware decode on main thread\n");
+        }
     }
 
     if (allow_async_primary) {
-        app->async_decoder_primary = async_decode_create(app->video);
+        if (!playlist) {
+            app->streams[0].standby = open_loop_standby(app, app->video, app->video_file);
+        }
+        app->async_decoder_primary = async_decode_create(app->video, app->streams[0].standby,
+                                                         playlist != NULL, app->decode_queue_depth, 0);
         if (!app->async_decoder_primary) {
             fprintf(stderr, "Failed to create async decoder for video 1\n");
             app_cleanup(app);
             return -1;
         }
-        printf("Async decoder created for video 1 (%s path)\n",
-               app->video->use_hardware_decode ? "hardware" : "software");
+        app->streams[0].decoder = app->async_decoder_primary;
+        printf("Async decoder created for video 1 (%s path, %d-frame queue%s)\n",
+               app->video->use_hardware_decode ? "hardware" : "software",
+               app->async_decoder_primary->capacity,
+               app->streams[0].standby ? ", gapless loop" : "");
+
+        if (playlist) {
+            app->playlist = playlist_worker_start(app, playlist, enable_hardware_decode);
+            if (!app->playlist) {
+                app_cleanup(app);
+                return -1;
+            }
+            printf("[PLAYLIST] %d items%s, next item prepared while the current one plays\n",
+                   playlist->count, playlist->loop ? " (looping)" : "");
+        }
     }
 
-    // Initialize second video decoder if provided
-    // HYBRID MODE: Video 2 always uses SOFTWARE decode to avoid V4L2 M2M contention
+    // Initialize the remaining streams
+    // HYBRID MODE: Streams 2..N always use SOFTWARE decode to avoid V4L2 M2M contention
     // Pi 4 has single HW decoder - running two HW streams causes poor performance
-    // Video 1 gets HW decode (if --hw), Video 2 uses SW decode (parallel on CPU)
-    if (video_file2) {
-        bool video2_hw_decode = false;  // Always software decode for video 2
+    // Video 1 gets HW decode (if --hw), the others decode on CPU, each on its own thread
+    for (int i = 1; i < app->stream_count; i++) {
+        video_stream_t *stream = &app->streams[i];
         if (enable_hardware_decode) {
-            printf("[HYBRID] Video 2 forced to software decode (V4L2 M2M is single-stream)\n");
+            printf("[HYBRID] Video %d forced to software decode (V4L2 M2M is single-stream)\n", i + 1);
         }
 
-        if (video_init(app->video2, video_file2, app->advanced_diagnostics, video2_hw_decode) != 0) {
-            fprintf(stderr, "Failed to initialize second video decoder\n");
+        thread_topology_bind_stream(i);
+        if (video_init(stream->video, stream->file, app->advanced_diagnostics, false) != 0) {
+            fprintf(stderr, "Failed to initialize video %d decoder\n", i + 1);
             app_cleanup(app);
             return -1;
         }
 
-        if (app->video2->width > MAX_VIDEO_WIDTH || app->video2->height > MAX_VIDEO_HEIGHT) {
-            fprintf(stderr, "Error: Video 2 dimensions %dx%d exceed limits (%dx%d max)\n",
-                    app->video2->width, app->video2->height, MAX_VIDEO_WIDTH, MAX_VIDEO_HEIGHT);
+        if (stream->video->width > MAX_VIDEO_WIDTH || stream->video->height > MAX_VIDEO_HEIGHT) {
+            fprintf(stderr, "Error: Video %d dimensions %dx%d exceed limits (%dx%d max)\n",
+                    i + 1, stream->video->width, stream->video->height, MAX_VIDEO_WIDTH, MAX_VIDEO_HEIGHT);
             app_cleanup(app);
             return -1;
         }
 
-        printf("Video 2 dimensions: %dx%d (within limits)\n", app->video2->width, app->video2->height);
-        video_set_loop(app->video2, loop_playback);
-
-        // Video 2 uses SYNCHRONOUS software decode for stability
-        // Async decode caused flickering due to timing/buffer issues
-        app->async_decoder_secondary = NULL;
-        printf("Video 2 using synchronous software decode\n");
+        printf("Video %d dimensions: %dx%d (within limits)\n", i + 1, stream->video->width, stream->video->height);
+        video_set_loop(stream->video, loop_playback);
+        attach_decode_pbo_pool(app, stream->video);
+        attach_packet_cache(app, stream->video);
+
+        // Decode runs ahead on its own thread; the render loop pops frames by PTS,
+        // so a slow stream can never stall the others' uploads
+        stream->standby = open_loop_standby(app, stream->video, stream->file);
+        stream->decoder = async_decode_create(stream->video, stream->standby, false, app->decode_queue_depth, i);
+        if (!stream->decoder) {
+            fprintf(stderr, "Failed to create async decoder for video %d\n", i + 1);
+            app_cleanup(app);
+            return -1;
+        }
+        printf("Async decoder created for video %d (software path, %d-frame queue%s)\n",
+               i + 1, stream->decoder->capacity, stream->standby ? ", gapless loop" : "");
     }
 
     // Initialize keystone correction
@@ -553,52 +1356,49 @@ int app_init(app_context_t *app, const char *video_file, const char *video_file2
         printf("Keystone 1 reset to correct defaults\n");
     }
     
-    // Initialize second keystone if second video provided
-    if (video_file2) {
-        if (keystone_init(app->keystone2) != 0) {
-            fprintf(stderr, "Failed to initialize second keystone correction\n");
+    // Initialize the other streams' keystones
+    for (int i = 1; i < app->stream_count; i++) {
+        video_stream_t *stream = &app->streams[i];
+        if (keystone_init(stream->keystone) != 0) {
+            fprintf(stderr, "Failed to initialize keystone correction for video %d\n", i + 1);
             app_cleanup(app);
             return -1;
         }
 
-        // Try to load saved keystone2 settings
-        if (keystone_load_from_file(app->keystone2, "pickle_keystone2.conf") == 0) {
-            printf("Loaded saved keystone2 settings from pickle_keystone2.conf\n");
+        if (keystone_load_from_file(stream->keystone, stream->keystone_file) == 0) {
+            printf("Loaded saved keystone %d settings from %s\n", i + 1, stream->keystone_file);
             // Use saved settings as-is (borders off by default)
-            app->keystone2->show_corners = false;
-            app->keystone2->show_border = false;
-        } else {
-            // No keystone2 config found - create default dual-video setup
-            printf("No pickle_keystone2.conf found - creating default dual-video setup\n");
+            stream->keystone->show_corners = false;
+            stream->keystone->show_border = false;
+            continue;
+        }
 
+        // No config for this stream - place it inside keystone 1 so it is visible
+        printf("No %s found - creating default multi-video setup\n", stream->keystone_file);
+        if (i == 1) {
             // Reset keystone 1 to full screen defaults
             keystone_reset_corners(app->keystone);
             printf("  Keystone 1 reset to full screen\n");
-
-            // Set keystone 2 to be inset inside keystone 1 with margin
-            float margin = 0.3f;  // 30% margin on each side
-            keystone_set_inset_corners(app->keystone2, margin);
-            printf("  Keystone 2 positioned inside keystone 1 with %.0f%% margin\n", margin * 100);
-
-            // Enable borders on BOTH keystones so user can see them
             app->keystone->show_border = true;
-            app->keystone2->show_border = true;
-
-            // Disable corners and help overlay on both keystones
             app->keystone->show_corners = false;
             app->keystone->show_help = false;
-            app->keystone2->show_corners = false;
-            app->keystone2->show_help = false;
+            if (keystone_save_to_file(app->keystone, app->streams[0].keystone_file) == 0) {
+                printf("  Saved default keystone 1 to %s\n", app->streams[0].keystone_file);
+            }
+        }
 
-            printf("  Borders enabled on both keystones for visibility\n");
+        // 30% margin for video 2, each further stream nested 10% deeper
+        float margin = 0.3f + 0.1f * (float)(i - 1);
+        keystone_set_inset_corners(stream->keystone, margin);
+        printf("  Keystone %d positioned inside keystone 1 with %.0f%% margin\n", i + 1, margin * 100);
 
-            // Save both configs
-            if (keystone_save_to_file(app->keystone, "pickle_keystone.conf") == 0) {
-                printf("  Saved default keystone 1 to pickle_keystone.conf\n");
-            }
-            if (keystone_save_to_file(app->keystone2, "pickle_keystone2.conf") == 0) {
-                printf("  Created pickle_keystone2.conf with default inset position\n");
-            }
+        // Border on so the user can find it; corners and help stay off
+        stream->keystone->show_border = true;
+        stream->keystone->show_corners = false;
+        stream->keystone->show_help = false;
+
+        if (keystone_save_to_file(stream->keystone, stream->keystone_file) == 0) {
+            printf("  Created %s with default inset position\n", stream->keystone_file);
         }
     }
 
@@ -614,12 +1414,51 @@ int app_init(app_context_t *app, const char *video_file, const char *video_file2
 
     gl_setup_buffers(app->gl);
 
+    // DRM device, program binaries and stream parameters are known by now
+    startup_cache_flush_async();
+
     // Application initialization complete
     return 0;
 }
 
+int app_enable_sync(app_context_t *app, net_sync_role_t role, const char *leader_host) {
+    if (!app || role == NET_SYNC_OFF) {
+        return 0;
+    }
+    if (app->live) {
+        fprintf(stderr, "[SYNC] Multi-node sync needs file sources; --live streams have no shared timeline\n");
+        return -1;
+    }
+    
+    const char *port_env = getenv("PICKLE_SYNC_PORT");
+    int port = port_env ? atoi(port_env) : NET_SYNC_DEFAULT_PORT;
+    app->sync = net_sync_start(role, leader_host, port, app->stream_count);
+    return app->sync ? 0 : -1;
+}
+
+// Exchange the presentation timeline with the sync group once per iteration:
+// the leader publishes each stream's mapping, followers adopt the leader's
+static void sync_timeline(app_context_t *app, double now) {
+    for (int i = 0; i < app->stream_count; i++) {
+        unsigned int epoch = 0;
+        double base = 0.0;
+        if (net_sync_role(app->sync) == NET_SYNC_LEADER) {
+            if (frame_sched_get_timeline(app->scheduler, i, &epoch, &base)) {
+                net_sync_publish(app->sync, i, epoch, base);
+            }
+        } else if (net_sync_get_timeline(app->sync, i, now, &epoch, &base)) {
+            frame_sched_follow(app->scheduler, i, epoch, base, now);
+        }
+    }
+}
+
 void app_run(app_context_t *app) {
     struct timespec current_time, last_time;
+
+    // All decoders are open: the render loop can take its own core now
+    thread_topology_set_name("pickle-render");
+    thread_topology_bind_render();
+    thread_topology_lock_memory();
     clock_gettime(CLOCK_MONOTONIC, &last_time);
 
     // Print app configuration to verify settings
@@ -648,37 +1487,82 @@ void app_run(app_context_t *app) {
         fflush(stdout);
     }
     
+    // Presentation scheduler: PTS of every stream mapped onto the display's vblank clock
+    frame_sched_init(app->scheduler, app->drm->refresh_rate > 0 ? (double)app->drm->refresh_rate : 60.0);
+    for (int i = 0; i < app->stream_count; i++) {
+        frame_sched_set_frame_rate(app->scheduler, i, app->streams[i].video->fps);
+        if (app->live) {
+            frame_sched_set_live_latency(app->scheduler, i, app->live_latency);
+        }
+    }
+    if (app->live) {
+        printf("[LIVE] Target latency %.0fms (receive to vblank); older frames are dropped\n",
+               app->live_latency * 1000.0);
+    }
+    if (app->sync) {
+        // Loops and item switches continue the shared timeline gaplessly on every node.
+        // The leader starts a little in the future so followers have its mapping in time.
+        const char *start_env = getenv("PICKLE_SYNC_START_MS");
+        int start_ms = start_env ? atoi(start_env) : NET_SYNC_START_DELAY_MS;
+        struct timespec sync_now;
+        clock_gettime(CLOCK_MONOTONIC, &sync_now);
+        double start_time = (double)sync_now.tv_sec + sync_now.tv_nsec / 1e9 + (start_ms > 0 ? start_ms : 0) / 1000.0;
+        for (int i = 0; i < app->stream_count; i++) {
+            frame_sched_set_continuous(app->scheduler, i, true);
+            if (net_sync_role(app->sync) == NET_SYNC_LEADER) {
+                frame_sched_set_start(app->scheduler, i, start_time);
+            }
+        }
+    }
+    // Governor: only steps that can make a difference for these streams. The plane
+    // can only take video 1 alone (other streams are composited over it by GL).
+    unsigned int governable = GOVERNOR_HIDE_OVERLAYS;
+    if (!app->scanout_overlay && app->stream_count == 1 && app->drm->video_plane_available &&
+        app->video->use_hardware_decode) {
+        governable |= GOVERNOR_PREFER_SCANOUT;
+    }
+    if (app->stream_count > 1) {
+        governable |= GOVERNOR_CAP_SECONDARY;
+    }
+    // Skipping non-reference frames only saves CPU time in a software decoder
+    for (int i = 0; i < app->stream_count; i++) {
+        if (app->streams[i].video && !app->streams[i].video->use_hardware_decode) {
+            governable |= GOVERNOR_SKIP_DECODE;
+        }
+    }
+    app->governor = governor_start(governable);
+    unsigned int governor_dropped_seen = 0;
+
+    uint64_t sched_flip_count = 0;
+    unsigned int sched_flip_seq = 0;
+    struct timespec last_swap_end = {0, 0};
+    
     // FIXED: VSync handles frame timing - no manual budgets needed
     
     // Frame timing diagnostics
     // Timing measurement variables (render_start/render_end now local to render section)
     struct timespec decode_start, decode_end;
     double total_decode_time = 0, total_render_time = 0;
-    double decode0_time = 0.0, decode1_time = 0.0;  // Track both video streams separately
+    double decode0_time = 0.0;  // Main-thread decode of video 1 (other streams decode on their own threads)
     int diagnostic_frame_count = 0;  // Counts successful decodes
     int render_frame_count = 0;       // Counts every frame rendered (for accurate avg)
-    double nv12_interval_sum[2] = {0.0, 0.0};
-    double nv12_interval_min[2] = {1e9, 1e9};
-    double nv12_interval_max[2] = {0.0, 0.0};
-    int nv12_interval_count[2] = {0, 0};
-    double gl_upload_interval_sum[2] = {0.0, 0.0};
-    double gl_upload_interval_min[2] = {1e9, 1e9};
-    double gl_upload_interval_max[2] = {0.0, 0.0};
-    int gl_upload_interval_count[2] = {0, 0};
-    
-    // Frame timing analysis buffers
-    double *decode_times = malloc(300 * sizeof(double));  // Last 300 frames
-    double *render_times = malloc(300 * sizeof(double));  // Last 300 frames
-    
-    // Critical: Check malloc success before using
-    if (!decode_times || !render_times) {
-        fprintf(stderr, "Failed to allocate timing buffers\n");
-        free(decode_times);
-        free(render_times);
-        decode_times = NULL;
-        render_times = NULL;
+    double nv12_interval_sum[MAX_VIDEO_STREAMS] = {0.0};
+    double nv12_interval_min[MAX_VIDEO_STREAMS];
+    double nv12_interval_max[MAX_VIDEO_STREAMS] = {0.0};
+    int nv12_interval_count[MAX_VIDEO_STREAMS] = {0};
+    double gl_upload_interval_sum[MAX_VIDEO_STREAMS] = {0.0};
+    double gl_upload_interval_min[MAX_VIDEO_STREAMS];
+    double gl_upload_interval_max[MAX_VIDEO_STREAMS] = {0.0};
+    int gl_upload_interval_count[MAX_VIDEO_STREAMS] = {0};
+    for (int i = 0; i < MAX_VIDEO_STREAMS; i++) {
+        nv12_interval_min[i] = 1e9;
+        gl_upload_interval_min[i] = 1e9;
     }
     
+    // Frame timing analysis windows (last TIMING_WINDOW_FRAMES frames)
+    double decode_times[TIMING_WINDOW_FRAMES] = {0};
+    double render_times[TIMING_WINDOW_FRAMES] = {0};
+    
     int timing_buffer_idx = 0;
     int timing_samples = 0;
     
@@ -716,8 +1600,6 @@ void app_run(app_context_t *app) {
     // Main loop starting
     double startup_time = (double)last_time.tv_sec + last_time.tv_nsec / 1e9;
     bool first_decode_attempted = false;
-    bool primary_async_requested = false;
-    bool primary_async_request_pending = false;
     
     while (app->running && !g_quit_requested) {
         clock_gettime(CLOCK_MONOTONIC, &current_time);
@@ -727,19 +1609,34 @@ void app_run(app_context_t *app) {
                            (current_time.tv_nsec - last_time.tv_nsec) / 1e9;
         
         double current_total_time = (double)current_time.tv_sec + current_time.tv_nsec / 1e9;
+        // Vblank this iteration's frame is presented at; drives show/repeat/drop decisions
+        double present_vblank = frame_sched_next_vblank(app->scheduler, current_total_time);
+        if (app->sync) {
+            sync_timeline(app, current_total_time);
+        }
         double decode_time = 0.0, render_time = 0.0;
         decode0_time = 0.0;  // Reset decode0 timing for this frame
-        decode1_time = 0.0;  // Reset decode1 timing for this frame
-        double nv12_frame_time[2] = {-1.0, -1.0};
-        double upload_frame_time[2] = {-1.0, -1.0};
+        double nv12_frame_time[MAX_VIDEO_STREAMS];
+        double upload_frame_time[MAX_VIDEO_STREAMS];
+        for (int i = 0; i < MAX_VIDEO_STREAMS; i++) {
+            nv12_frame_time[i] = -1.0;
+            upload_frame_time[i] = -1.0;
+        }
+
+        // Governor degradation steps in effect for this frame
+        unsigned int governed = governor_actions(app->governor);
+        for (int i = 0; app->governor && i < app->stream_count; i++) {
+            video_set_decode_degraded(app->streams[i].video, (governed & GOVERNOR_SKIP_DECODE) != 0);
+            video_set_decode_degraded(app->streams[i].standby, (governed & GOVERNOR_SKIP_DECODE) != 0);
+        }
+        double secondary_interval = (governed & GOVERNOR_CAP_SECONDARY) ? 1.0 / governor_secondary_fps(app->governor) : 0.0;
         
         // Handle input regardless of video state
         input_update(app->input);
         
         // Check for quit
         if (input_should_quit(app->input)) {
-            printf("Quit requested by user\n");
-            fflush(stdout);
+            LOG_PRINT("Quit requested by user\n");
             app->running = false;
             break;
         }
@@ -760,81 +1657,66 @@ void app_run(app_context_t *app) {
         } else if (input_is_key_just_pressed(app->input, KEY_4)) {
             keystone_select_corner(app->keystone, CORNER_BOTTOM_LEFT);   // Key "4" = BL
             app->active_keystone = 0;
-        } else if (app->keystone2 && input_is_key_just_pressed(app->input, KEY_5)) {
-            keystone_select_corner(app->keystone2, CORNER_TOP_LEFT);     // Key "5" = TL
+        } else if (app->stream_count > 1 && input_is_key_just_pressed(app->input, KEY_5)) {
+            keystone_select_corner(app->streams[1].keystone, CORNER_TOP_LEFT);     // Key "5" = TL
             app->active_keystone = 1;
-        } else if (app->keystone2 && input_is_key_just_pressed(app->input, KEY_6)) {
-            keystone_select_corner(app->keystone2, CORNER_TOP_RIGHT);    // Key "6" = TR
+        } else if (app->stream_count > 1 && input_is_key_just_pressed(app->input, KEY_6)) {
+            keystone_select_corner(app->streams[1].keystone, CORNER_TOP_RIGHT);    // Key "6" = TR
             app->active_keystone = 1;
-        } else if (app->keystone2 && input_is_key_just_pressed(app->input, KEY_7)) {
-            keystone_select_corner(app->keystone2, CORNER_BOTTOM_RIGHT); // Key "7" = BR
+        } else if (app->stream_count > 1 && input_is_key_just_pressed(app->input, KEY_7)) {
+            keystone_select_corner(app->streams[1].keystone, CORNER_BOTTOM_RIGHT); // Key "7" = BR
             app->active_keystone = 1;
-        } else if (app->keystone2 && input_is_key_just_pressed(app->input, KEY_8)) {
-            keystone_select_corner(app->keystone2, CORNER_BOTTOM_LEFT);  // Key "8" = BL
+        } else if (app->stream_count > 1 && input_is_key_just_pressed(app->input, KEY_8)) {
+            keystone_select_corner(app->streams[1].keystone, CORNER_BOTTOM_LEFT);  // Key "8" = BL
             app->active_keystone = 1;
+        } else if (app->stream_count > 1 && input_is_key_just_pressed(app->input, KEY_TAB)) {
+            // TAB: move editing to the next stream's keystone (reaches videos 3 and 4)
+            keystone_context_t *prev_ks = get_active_keystone(app);
+            int corner = prev_ks->selected_corner >= 0 ? prev_ks->selected_corner : CORNER_TOP_LEFT;
+            app->active_keystone = (app->active_keystone + 1) % app->stream_count;
+            keystone_select_corner(get_active_keystone(app), corner);
+            LOG_PRINT("[KEYSTONE] Editing keystone %d\n", app->active_keystone + 1);
         }
         
         // Check for arrow key input (simply helps the corner movement by triggering input_is_key_pressed)
 
         // Get active keystone
-        keystone_context_t *active_ks = (app->active_keystone == 1 && app->keystone2) ? app->keystone2 : app->keystone;
+        keystone_context_t *active_ks = get_active_keystone(app);
         
         // Reset keystone to defaults
         if (input_is_key_just_pressed(app->input, KEY_R)) {
-            // Reset keystone 1 to full screen
-            keystone_reset_corners(app->keystone);
-            printf("Keystone 1 reset to defaults\n");
-            
-            // If second video exists, reset keystone 2 to a smaller inset area
-            if (app->keystone2) {
-                // Reset to defaults first
-                keystone_reset_corners(app->keystone2);
-                
-                // Then adjust to be slightly inset (10% margin on each side)
-                float inset = 0.10f; // 10% inset from edges
-                app->keystone2->corners[CORNER_TOP_LEFT].x = -1.0f + inset;      // TL X
-                app->keystone2->corners[CORNER_TOP_LEFT].y = 1.0f - inset;       // TL Y
-                app->keystone2->corners[CORNER_TOP_RIGHT].x = 1.0f - inset;      // TR X
-                app->keystone2->corners[CORNER_TOP_RIGHT].y = 1.0f - inset;      // TR Y
-                app->keystone2->corners[CORNER_BOTTOM_RIGHT].x = 1.0f - inset;   // BR X
-                app->keystone2->corners[CORNER_BOTTOM_RIGHT].y = -1.0f + inset;  // BR Y
-                app->keystone2->corners[CORNER_BOTTOM_LEFT].x = -1.0f + inset;   // BL X
-                app->keystone2->corners[CORNER_BOTTOM_LEFT].y = -1.0f + inset;   // BL Y
-                
-                keystone_calculate_matrix(app->keystone2);
-                printf("Keystone 2 reset to inset defaults (visible inside keystone 1)\n");
-            }
+            reset_stream_keystones(app);
         }
         
         // Save keystone settings (S key or P key for compatibility)
         if (app->input->save_keystone) {
-            // Save both keystones
-            bool saved1 = false, saved2 = false;
-
-            if (keystone_save_settings(app->keystone) == 0) {
-                printf("Keystone 1 settings saved to pickle_keystone.conf\n");
-                saved1 = true;
-            } else {
-                printf("Failed to save keystone 1 settings\n");
-            }
-
-            if (app->keystone2) {
-                if (keystone_save_to_file(app->keystone2, "pickle_keystone2.conf") == 0) {
-                    printf("Keystone 2 settings saved to pickle_keystone2.conf\n");
-                    saved2 = true;
+            // Save every stream's keystone
+            int saved = 0;
+            int last_saved = -1;
+
+            for (int i = 0; i < app->stream_count; i++) {
+                video_stream_t *stream = &app->streams[i];
+                if (keystone_save_to_file(stream->keystone, stream->keystone_file) == 0) {
+                    LOG_PRINT("Keystone %d settings saved to %s\n", i + 1, stream->keystone_file);
+                    saved++;
+                    last_saved = i;
                 } else {
-                    printf("Failed to save keystone 2 settings\n");
+                    LOG_ERROR("Failed to save keystone %d settings\n", i + 1);
                 }
             }
 
             // Show notification overlay
-            if (saved1 && saved2) {
-                printf("Both keystone configurations saved successfully\n");
+            if (saved == app->stream_count) {
+                if (app->stream_count > 1) {
+                    LOG_PRINT("All %d keystone configurations saved successfully\n", app->stream_count);
+                }
                 show_notification(app, "Settings Saved!", 3.0);
-            } else if (saved1) {
-                show_notification(app, "Keystone 1 Saved!", 3.0);
-            } else if (saved2) {
-                show_notification(app, "Keystone 2 Saved!", 3.0);
+            } else if (saved == 1) {
+                char message[64];
+                snprintf(message, sizeof(message), "Keystone %d Saved!", last_saved + 1);
+                show_notification(app, message, 3.0);
+            } else if (saved > 1) {
+                show_notification(app, "Some Keystones Saved!", 3.0);
             } else {
                 show_notification(app, "Save Failed!", 3.0);
             }
@@ -844,30 +1726,22 @@ void app_run(app_context_t *app) {
         
         // Toggle corner visibility
         if (app->input->toggle_corners) {
-            if (app->keystone2) {
-                // Two videos: toggle BOTH keystones
-                app->keystone->show_corners = !app->keystone->show_corners;
-                app->keystone2->show_corners = !app->keystone2->show_corners;
-                printf("[TOGGLE] Corners: %s (both keystone 1 & 2)\n", 
-                       app->keystone->show_corners ? "ON" : "OFF");
-            } else {
-                // Single video: toggle only keystone 1
-                app->keystone->show_corners = !app->keystone->show_corners;
-                printf("[TOGGLE] Corners: %s (keystone 1 only)\n", 
-                       app->keystone->show_corners ? "ON" : "OFF");
+            // Toggle every stream's keystone together
+            for (int i = 0; i < app->stream_count; i++) {
+                keystone_context_t *ks = app->streams[i].keystone;
+                ks->show_corners = !ks->show_corners;
             }
+            LOG_PRINT("[TOGGLE] Corners: %s (%d keystone%s)\n",
+                   app->keystone->show_corners ? "ON" : "OFF",
+                   app->stream_count, app->stream_count > 1 ? "s" : "");
             app->input->toggle_corners = false;
         }
         
         // Toggle border visibility
         if (app->input->toggle_border) {
-            if (app->keystone2) {
-                // Two videos: toggle BOTH keystones
-                app->keystone->show_border = !app->keystone->show_border;
-                app->keystone2->show_border = !app->keystone2->show_border;
-            } else {
-                // Single video: toggle only keystone 1
-                app->keystone->show_border = !app->keystone->show_border;
+            for (int i = 0; i < app->stream_count; i++) {
+                keystone_context_t *ks = app->streams[i].keystone;
+                ks->show_border = !ks->show_border;
             }
             app->input->toggle_border = false;
         }
@@ -882,43 +1756,31 @@ void app_run(app_context_t *app) {
         if (app->input->gamepad_enabled) {
             // X button: Cycle through corners
             if (app->input->gamepad_cycle_corner) {
-                // If video 2 EXISTS, cycle through all 8 corners (both keystones)
+                // With several videos, cycle through all 4*N corners (every keystone)
                 // Otherwise, cycle through only the 4 corners of the active keystone
                 
-                if (app->keystone2) {
-                    // Dual video mode - cycle through all 8 corners (1-8 mode)
+                if (app->stream_count > 1) {
+                    // Multi-video mode - cycle through all corners of all keystones
                     const char* corner_names[] = {"TL", "TR", "BR", "BL"};
+                    int total_corners = 4 * app->stream_count;
                     
                     // Initialize index if first press
-                    if (app->gamepad_corner_cycle_index < 0 || app->gamepad_corner_cycle_index >= 8) {
+                    if (app->gamepad_corner_cycle_index < 0 || app->gamepad_corner_cycle_index >= total_corners) {
                         app->gamepad_corner_cycle_index = 0;
                     }
                     
-                    // Determine which keystone and corner to select based on current index
+                    // Corners 0-3 belong to video 1, 4-7 to video 2, and so on (TL, TR, BR, BL)
                     int next_index = app->gamepad_corner_cycle_index;  // Cache the index we're about to use
-                    keystone_context_t *target_keystone;
-                    int target_corner;
-                    int target_video;
-                    
-                    if (next_index < 4) {
-                        // Corners 0-3: Video 1 (corners TL, TR, BR, BL)
-                        target_keystone = app->keystone;
-                        target_corner = next_index;  // 0, 1, 2, or 3
-                        target_video = 1;
-                        app->active_keystone = 0;
-                    } else {
-                        // Corners 4-7: Video 2 (corners TL, TR, BR, BL)
-                        target_keystone = app->keystone2;
-                        target_corner = next_index - 4;  // 0, 1, 2, or 3
-                        target_video = 2;
-                        app->active_keystone = 1;
-                    }
+                    int target_video = next_index / 4;
+                    int target_corner = next_index % 4;
+                    keystone_context_t *target_keystone = app->streams[target_video].keystone;
+                    app->active_keystone = target_video;
                     
                     // DEBUG logging BEFORE change
                     static int cycle_debug_count = 0;
                     if (cycle_debug_count < 10) {  // Only log first 10 cycles
-                        printf("[X-CYCLE] Index=%d → Video %d corner %s (enum=%d)\n",
-                               next_index, target_video, corner_names[target_corner], target_corner);
+                        LOG_PRINT("[X-CYCLE] Index=%d → Video %d corner %s (enum=%d)\n",
+                               next_index, target_video + 1, corner_names[target_corner], target_corner);
                         cycle_debug_count++;
                     }
                     
@@ -927,7 +1789,7 @@ void app_run(app_context_t *app) {
                     target_keystone->show_corners = true;
                     
                     // Increment to next position for next button press
-                    app->gamepad_corner_cycle_index = (next_index + 1) % 8;
+                    app->gamepad_corner_cycle_index = (next_index + 1) % total_corners;
                 } else {
                     // Single video mode - cycle through current keystone's 4 corners
                     int current = active_ks->selected_corner;
@@ -955,67 +1817,35 @@ void app_run(app_context_t *app) {
             // L1/R1: Decrease/increase step size
             if (app->input->gamepad_decrease_step) {
                 keystone_decrease_step_size(active_ks);
-                printf("[GAMEPAD] R1 - Step size decreased to %.6f (keystone %d)\n", active_ks->move_step, app->active_keystone + 1);
+                LOG_PRINT("[GAMEPAD] R1 - Step size decreased to %.6f (keystone %d)\n", active_ks->move_step, app->active_keystone + 1);
                 app->input->gamepad_decrease_step = false;
             }
             if (app->input->gamepad_increase_step) {
                 keystone_increase_step_size(active_ks);
-                printf("[GAMEPAD] L1 - Step size increased to %.6f (keystone %d)\n", active_ks->move_step, app->active_keystone + 1);
+                LOG_PRINT("[GAMEPAD] L1 - Step size increased to %.6f (keystone %d)\n", active_ks->move_step, app->active_keystone + 1);
                 app->input->gamepad_increase_step = false;
             }
             
             // SELECT: Reset keystone
             if (app->input->gamepad_reset_keystone) {
-                // Reset keystone 1 to full screen
-                keystone_reset_corners(app->keystone);
-                printf("Keystone 1 reset to defaults (gamepad)\n");
-                
-                // If second video exists, reset keystone 2 to a smaller inset area
-                if (app->keystone2) {
-                    // Reset to defaults first
-                    keystone_reset_corners(app->keystone2);
-                    
-                    // Then adjust to be slightly inset (10% margin on each side)
-                    float inset = 0.10f; // 10% inset from edges
-                    app->keystone2->corners[CORNER_TOP_LEFT].x = -1.0f + inset;      // TL X
-                    app->keystone2->corners[CORNER_TOP_LEFT].y = 1.0f - inset;       // TL Y
-                    app->keystone2->corners[CORNER_TOP_RIGHT].x = 1.0f - inset;      // TR X
-                    app->keystone2->corners[CORNER_TOP_RIGHT].y = 1.0f - inset;      // TR Y
-                    app->keystone2->corners[CORNER_BOTTOM_RIGHT].x = 1.0f - inset;   // BR X
-                    app->keystone2->corners[CORNER_BOTTOM_RIGHT].y = -1.0f + inset;  // BR Y
-                    app->keystone2->corners[CORNER_BOTTOM_LEFT].x = -1.0f + inset;   // BL X
-                    app->keystone2->corners[CORNER_BOTTOM_LEFT].y = -1.0f + inset;   // BL Y
-                    
-                    keystone_calculate_matrix(app->keystone2);
-                    printf("Keystone 2 reset to inset defaults (gamepad)\n");
-                }
-                
+                reset_stream_keystones(app);
                 app->input->gamepad_reset_keystone = false;
             }
             
             // START: Toggle keystone mode (corners visibility)
             if (app->input->gamepad_toggle_mode) {
-                if (app->keystone2) {
-                    // Two videos: toggle BOTH keystones
-                    keystone_toggle_corners(app->keystone);
-                    keystone_toggle_corners(app->keystone2);
-                } else {
-                    // Single video: toggle only keystone 1
-                    keystone_toggle_corners(app->keystone);
+                for (int i = 0; i < app->stream_count; i++) {
+                    keystone_toggle_corners(app->streams[i].keystone);
                 }
                 app->input->gamepad_toggle_mode = false;
             }
             
             // B button: Toggle both corners and borders on all keystones
             if (app->input->gamepad_toggle_corner_border) {
-                if (app->keystone2) {
-                    app->keystone->show_corners = !app->keystone->show_corners;
-                    app->keystone->show_border = !app->keystone->show_border;
-                    app->keystone2->show_corners = !app->keystone2->show_corners;
-                    app->keystone2->show_border = !app->keystone2->show_border;
-                } else {
-                    app->keystone->show_corners = !app->keystone->show_corners;
-                    app->keystone->show_border = !app->keystone->show_border;
+                for (int i = 0; i < app->stream_count; i++) {
+                    keystone_context_t *ks = app->streams[i].keystone;
+                    ks->show_corners = !ks->show_corners;
+                    ks->show_border = !ks->show_border;
                 }
                 app->input->gamepad_toggle_corner_border = false;
             }
@@ -1023,22 +1853,13 @@ void app_run(app_context_t *app) {
 
         // OPTIMIZATION: Pre-decode next frame while rendering current frame
         // This hides decode latency by overlapping decode with render/swap
-        static bool next_frame_ready = false;
-        static bool first_frame_decoded = false;
-        static bool first_frame_decoded2 = false;
+        video_stream_t *primary = &app->streams[0];
         const bool using_async_primary = (app->async_decoder_primary != NULL);
         
         // Decode video frame continuously - vsync will handle timing
         uint8_t *video_data = NULL;
-        // PRODUCTION FIX: Make video2 YUV pointers static to prevent flickering
-        // These hold the last valid frame data even when async decoder isn't ready
-        static uint8_t *y_data2 = NULL, *u_data2 = NULL, *v_data2 = NULL;
-        static int y_stride2 = 0, u_stride2 = 0, v_stride2 = 0;
-        static int frame_count = 0;
-        static int frame_count2 = 0;
-        static uint8_t *last_video_data = NULL;
         bool new_primary_frame_ready = false;
-        bool new_secondary_frame_ready = false;
+        bool new_secondary_frame_ready = false;  // Any of streams 1..N presented a frame
 
         // FIXED: Always decode/render, let vsync handle frame timing
         // Old buggy logic: if (delta_time >= frame_budget) caused stuttering
@@ -1048,19 +1869,34 @@ void app_run(app_context_t *app) {
 
             if (using_async_primary) {
                 decode_time = 0.0; // Decode work happens on background thread
-                if (frame_count == 0 && !first_decode_attempted) {
-                    printf("Attempting first frame decode (async)...\n");
-                    fflush(stdout);
+                if (primary->frame_count == 0 && !first_decode_attempted) {
+                    LOG_INFO("Attempting first frame decode (async)...\n");
                     first_decode_attempted = true;
                 }
 
-                int wait_timeout_ms = first_frame_decoded ? 0 : 100;
-                if (!primary_async_requested) {
-                    async_decode_request_frame(app->async_decoder_primary);
-                    primary_async_requested = true;
-                }
+                int wait_timeout_ms = primary->first_frame_decoded ? 0 : 100;
+                video_frame_ref_t popped;
+                bool discontinuity = false;
+                bool have_frame = async_pop_due_frame(app->scheduler, 0, app->async_decoder_primary,
+                                                      primary->first_frame_decoded, present_vblank, wait_timeout_ms,
+                                                      &popped, &discontinuity);
+                video_set_skip_nonref(app->video, frame_sched_is_behind(app->scheduler, 0, present_vblank));
+
+                if (have_frame) {
+                    video_context_t *item = async_decode_take_item_switch(app->async_decoder_primary);
+                    if (item && app->playlist) {
+                        playlist_item_started(app, item);
+                    }
+                    if (discontinuity) {
+                        // Decode thread looped back to the start
+                        primary->next_frame_ready = false;
+                        primary->first_frame_decoded = false;
+                        primary->frame_count = 0;
+                        frame_sched_reset_stream(app->scheduler, 0);
+                        startup_time = current_total_time;
+                    }
+                    video_present_frame(app->video, &popped);
 
-                if (async_decode_wait_frame(app->async_decoder_primary, wait_timeout_ms)) {
                     // Check for new frame: either YUV data (SW/fallback) or DMA buffer (pure HW)
                     bool frame_available = false;
 
@@ -1079,68 +1915,76 @@ void app_run(app_context_t *app) {
                     }
 
                     if (frame_available) {
-                        last_video_data = video_data;
-                        frame_count++;
+                        primary->last_video_data = video_data;
+                        primary->frame_count++;
                         new_primary_frame_ready = true;
 
-                        if (!first_frame_decoded) {
-                            printf("First frame decoded successfully (async)\n");
-                            first_frame_decoded = true;
-                            fflush(stdout);
+                        frame_sched_mark_shown(app->scheduler, 0, video_get_pts_seconds(app->video),
+                                               video_get_arrival_time(app->video), present_vblank);
+
+                        if (!primary->first_frame_decoded) {
+                            LOG_INFO("First frame decoded successfully (async)\n");
+                            primary->first_frame_decoded = true;
                         }
 
                         diagnostic_frame_count++;
                     }
-
-                    primary_async_requested = false;
-                    primary_async_request_pending = !video_is_eof(app->video);
                 }
 
-                if (video_is_eof(app->video)) {
-                    if (app->loop_playback) {
-                        printf("End of video reached - restarting playback (loop mode)\n");
-                        video_seek(app->video, 0);
-                        next_frame_ready = false;
-                        first_frame_decoded = false;
-                        first_decode_attempted = false;
-                        frame_count = 0;
-                        primary_async_requested = false;
-                        primary_async_request_pending = !video_is_eof(app->video);
-                        clock_gettime(CLOCK_MONOTONIC, &current_time);
-                        startup_time = (double)current_time.tv_sec + current_time.tv_nsec / 1e9;
-                    } else {
-                        printf("Playback finished.\n");
-                        app->running = false;
-                        break;
-                    }
+                if (async_decode_finished(app->async_decoder_primary)) {
+                    LOG_PRINT("Playback finished.\n");
+                    app->running = false;
+                    break;
                 }
             } else {
-                if (frame_count == 0 && !first_decode_attempted) {
-                    printf("Attempting first frame decode...\n");
-                    fflush(stdout);
+                if (primary->frame_count == 0 && !first_decode_attempted) {
+                    LOG_INFO("Attempting first frame decode...\n");
                     first_decode_attempted = true;
                     
                     // Hardware decode: Pre-buffer 2 frames to prime the decoder pipeline
                     // More buffering causes systematic lag (playback appears slower)
                     if (app->video && video_is_hardware_decoded(app->video)) {
-                        printf("[HW_DECODE] Priming decoder pipeline...\n");
+                        LOG_INFO("[HW_DECODE] Priming decoder pipeline...\n");
                         for (int prebuf = 0; prebuf < 2; prebuf++) {
                             int result = video_decode_frame(app->video);
                             if (result != 0) break;
                         }
-                        printf("[HW_DECODE] Decoder ready, starting playback\n");
-                        fflush(stdout);
+                        LOG_INFO("[HW_DECODE] Decoder ready, starting playback\n");
                     }
                 }
 
                 // Add timeout for first decode to prevent hanging
-                if (frame_count == 0 && (current_total_time - startup_time) > 5.0) {
-                    printf("Video decode timeout after 5 seconds, continuing without video...\n");
-                    fflush(stdout);
-                    frame_count = 1; // Skip further decode attempts
+                if (primary->frame_count == 0 && (current_total_time - startup_time) > 5.0) {
+                    LOG_ERROR("Video decode timeout after 5 seconds, continuing without video...\n");
+                    primary->frame_count = 1; // Skip further decode attempts
                 } else {
-                    // OPTIMIZATION: Use pre-decoded frame if available, then decode next
-                    if (next_frame_ready && first_frame_decoded) {
+                    // Hold the pre-decoded frame until its PTS is due; when late,
+                    // decode forward past frames whose display slot already passed
+                    frame_sched_action_t action = FRAME_SCHED_SHOW;
+                    if (primary->next_frame_ready && primary->first_frame_decoded) {
+                        action = frame_sched_decide(app->scheduler, 0, video_get_pts_seconds(app->video),
+                                                    video_get_arrival_time(app->video), present_vblank, true);
+                        int catchup = 0;
+                        while (action == FRAME_SCHED_DROP && catchup < FRAME_SCHED_MAX_CATCHUP) {
+                            video_set_skip_nonref(app->video, true);
+                            if (video_decode_frame(app->video) != 0) {
+                                action = FRAME_SCHED_SHOW;
+                                break;
+                            }
+                            frame_sched_mark_dropped(app->scheduler, 0);
+                            catchup++;
+                            action = frame_sched_decide(app->scheduler, 0, video_get_pts_seconds(app->video),
+                                                        video_get_arrival_time(app->video), present_vblank, true);
+                        }
+                        // A saturated PBO ring means the GPU is the bottleneck: shed decode work too
+                        video_set_skip_nonref(app->video, frame_sched_is_behind(app->scheduler, 0, present_vblank) ||
+                                                          gl_pbo_backpressured(app->gl));
+                    }
+
+                    if (action == FRAME_SCHED_REPEAT) {
+                        // Not due yet - previous frame stays on screen
+                        decode_time = 0.0;
+                    } else if (primary->next_frame_ready && primary->first_frame_decoded) {
                         // Current frame was already decoded - just use it (zero decode time!)
                         decode_time = 0.0;
                         
@@ -1151,20 +1995,18 @@ void app_run(app_context_t *app) {
                         
                         if (y_data != NULL) {
                             video_data = y_data;
-                            last_video_data = video_data;
-                            frame_count++;
+                            primary->last_video_data = video_data;
+                            primary->frame_count++;
                             new_primary_frame_ready = true;
+                            frame_sched_mark_shown(app->scheduler, 0, video_get_pts_seconds(app->video),
+                                                   video_get_arrival_time(app->video), present_vblank);
                             
                             total_decode_time += decode_time;
                             diagnostic_frame_count++;
                             
-                            if (app->show_timing && (frame_count % 10 == 0 || frame_count < 10)) {
-                                fflush(stdout);
-                            }
-                            
                             // Now decode the NEXT frame (during rendering of current frame)
                             // This will be ready for next iteration
-                            next_frame_ready = false;
+                            primary->next_frame_ready = false;
                             // Actual decode happens after rendering (see below)
                         }
                     } else {
@@ -1178,10 +2020,10 @@ void app_run(app_context_t *app) {
                         decode0_time = decode_time;  // Track decode0 timing
                         
                         if (decode_result == 0) {
-                            if (frame_count == 0) {
-                                printf("First frame decoded successfully\n");
-                                first_frame_decoded = true;
-                                fflush(stdout);
+                            metrics_record_decode(0, decode_time);
+                            if (primary->frame_count == 0) {
+                                LOG_INFO("First frame decoded successfully\n");
+                                primary->first_frame_decoded = true;
                             }
                             
                             uint8_t *y_data = NULL, *u_data = NULL, *v_data = NULL;
@@ -1190,74 +2032,91 @@ void app_run(app_context_t *app) {
                             
                             if (y_data != NULL) {
                                 video_data = y_data;
-                                last_video_data = video_data;
-                                frame_count++;
+                                primary->last_video_data = video_data;
+                                primary->frame_count++;
                                 new_primary_frame_ready = true;
+                                frame_sched_mark_shown(app->scheduler, 0, video_get_pts_seconds(app->video),
+                                                       video_get_arrival_time(app->video), present_vblank);
                                 
                                 total_decode_time += decode_time;
                                 diagnostic_frame_count++;
                                 
-                                if (app->show_timing && (frame_count % 10 == 0 || frame_count < 10)) {
-                                    fflush(stdout);
-                                }
-                                
                                 // Mark that we should pre-decode next time
-                                next_frame_ready = true;
+                                primary->next_frame_ready = true;
                             }
                         } else if (video_is_eof(app->video)) {
                             if (app->loop_playback) {
-                                printf("End of video reached - restarting playback (loop mode)\n");
+                                LOG_PRINT("End of video reached - restarting playback (loop mode)\n");
                                 video_seek(app->video, 0);
-                                next_frame_ready = false;
-                                first_frame_decoded = false;
+                                primary->next_frame_ready = false;
+                                primary->first_frame_decoded = false;
                                 first_decode_attempted = false;  // Reset to allow "Attempting first frame" message
-                                frame_count = 0;
+                                primary->frame_count = 0;
+                                frame_sched_reset_stream(app->scheduler, 0);
                                 // Update startup_time to reset the 5-second timeout
                                 clock_gettime(CLOCK_MONOTONIC, &current_time);
                                 startup_time = (double)current_time.tv_sec + current_time.tv_nsec / 1e9;
                             } else {
-                                printf("Playback finished.\n");
+                                LOG_PRINT("Playback finished.\n");
                                 app->running = false;
                                 break;
                             }
                         } else {
-                            if (frame_count < 10) {
-                                printf("Video decode failed: %d\n", decode_result);
-                                fflush(stdout);
+                            if (primary->frame_count < 10) {
+                                LOG_ERROR("Video decode failed: %d\n", decode_result);
                             }
-                            video_data = last_video_data;
-                            next_frame_ready = false;
+                            video_data = primary->last_video_data;
+                            primary->next_frame_ready = false;
                         }
                     }
                 }
             }
         } // End of main decode/render block
 
-        // Decode second video if available
-        // SYNCHRONOUS software decode for stability (async caused flickering)
-        if (app->video2) {
-            int decode_result = video_decode_frame(app->video2);
-
-            if (decode_result == 0) {
-                video_get_yuv_data(app->video2, &y_data2, &u_data2, &v_data2,
-                                   &y_stride2, &u_stride2, &v_stride2);
-
-                if (y_data2 != NULL) {
-                    frame_count2++;
-                    if (!first_frame_decoded2) {
-                        printf("First frame of video 2 decoded successfully (SW sync)\n");
-                        first_frame_decoded2 = true;
-                        fflush(stdout);
+        // Present the other streams' due frames
+        // Each decodes on its own thread; the shared scheduler clock decides when a
+        // frame is due, which keeps every stream lip-locked to video 1 regardless of
+        // their frame rates
+        for (int i = 1; i < app->stream_count; i++) {
+            video_stream_t *stream = &app->streams[i];
+            video_frame_ref_t popped;
+            bool discontinuity = false;
+
+            stream->new_frame_ready = false;
+            // Governor fps cap: keep the current frame up until the interval is over; the
+            // scheduler drops whatever went stale meanwhile
+            bool capped = secondary_interval > 0.0 && stream->first_frame_decoded &&
+                          present_vblank - stream->last_present_vblank <
+                              secondary_interval - app->scheduler->vblank_period * 0.5;
+            if (!capped && async_pop_due_frame(app->scheduler, i, stream->decoder, stream->first_frame_decoded,
+                                               present_vblank, 0, &popped, &discontinuity)) {
+                if (discontinuity) {
+                    // Decode thread looped back to the start
+                    stream->first_frame_decoded = false;
+                    stream->frame_count = 0;
+                    frame_sched_reset_stream(app->scheduler, i);
+                }
+                video_present_frame(stream->video, &popped);
+
+                uint8_t *y_probe = NULL, *u_probe = NULL, *v_probe = NULL;
+                int y_probe_stride = 0, u_probe_stride = 0, v_probe_stride = 0;
+                video_get_yuv_data(stream->video, &y_probe, &u_probe, &v_probe,
+                                   &y_probe_stride, &u_probe_stride, &v_probe_stride);
+                if (y_probe != NULL) {
+                    stream->frame_count++;
+                    if (!stream->first_frame_decoded) {
+                        LOG_INFO("First frame of video %d decoded successfully (async)\n", i + 1);
+                        stream->first_frame_decoded = true;
                     }
+                    stream->new_frame_ready = true;
+                    stream->last_present_vblank = present_vblank;
                     new_secondary_frame_ready = true;
-                }
-            } else if (video_is_eof(app->video2)) {
-                if (app->loop_playback) {
-                    video_seek(app->video2, 0);
-                    first_frame_decoded2 = false;
-                    frame_count2 = 0;
+                    frame_sched_mark_shown(app->scheduler, i, video_get_pts_seconds(stream->video),
+                                           video_get_arrival_time(stream->video), present_vblank);
                 }
             }
+            video_set_skip_nonref(stream->video, frame_sched_is_behind(app->scheduler, i, present_vblank) ||
+                                                 secondary_interval > 0.0);
         }
 
         if (app->keystone->selected_corner < 0) {
@@ -1293,16 +2152,27 @@ void app_run(app_context_t *app) {
         clock_gettime(CLOCK_MONOTONIC, &gl_render_start);
 
         // Initialize overlay visibility flags (needed for goto skip path)
-        bool any_overlay_visible = (app->keystone && (app->keystone->show_corners ||
-                                                     app->keystone->show_border));
-        bool any_overlay_visible2 = (app->keystone2 && (app->keystone2->show_corners ||
-                                                       app->keystone2->show_border));
+        // The governor's last step hides guides and notifications, never help
+        bool guides_allowed = !(governed & GOVERNOR_HIDE_OVERLAYS);
+        bool any_overlay_visible = false;
+        bool help_visible = false;
+        for (int i = 0; i < app->stream_count; i++) {
+            keystone_context_t *ks = app->streams[i].keystone;
+            any_overlay_visible = any_overlay_visible || (guides_allowed && (ks->show_corners || ks->show_border));
+            // OPTIMIZATION: Blank video when help overlay is displayed (cleaner, faster, no flicker)
+            help_visible = help_visible || ks->show_help;
+        }
 
-        // OPTIMIZATION: Blank video when help overlay is displayed (cleaner, faster, no flicker)
-        bool help_visible = (app->keystone && app->keystone->show_help) ||
-                           (app->keystone2 && app->keystone2->show_help);
+        // One composite pass per new frame on any stream: every stream is redrawn
+        // (from its textures if it has nothing new) under a single clear
+        bool compose_pass = new_primary_frame_ready || new_secondary_frame_ready;
 
         if (help_visible) {
+            // An overlay plane above the primary would cover the help text
+            if (app->scanout_active && !app->drm->video_plane_underlay) {
+                drm_clear_video_plane(app->drm);
+                app->scanout_active = false;
+            }
             // Just render black screen when help is up
             glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT);
@@ -1318,26 +2188,99 @@ void app_run(app_context_t *app) {
         struct timespec nv12_cpu_start = {0, 0}, nv12_cpu_end = {0, 0};
         struct timespec gl_upload_start = {0, 0}, gl_upload_end = {0, 0};
 
+        // SCANOUT PATH: DRM_PRIME frame goes straight to the KMS overlay plane and the
+        // GPU never touches the video. Only usable while the keystone is an upright
+        // rectangle the plane scaler can reproduce, and (without zpos control) while
+        // no GL overlay has to be drawn on top of it.
+        bool scanout_wanted = app->scanout_overlay || (governed & GOVERNOR_PREFER_SCANOUT);
+        if (scanout_wanted && has_dma && use_hw_decode) {
+            float left = 0.0f, top = 0.0f, right = 0.0f, bottom = 0.0f;
+            // Other streams are composited by GL on the primary plane, so they count as overlays
+            bool overlays_on_top = any_overlay_visible || (app->notification_active && guides_allowed) ||
+                                   app->stream_count > 1;
+            bool plane_ok = keystone_get_axis_aligned_rect(app->keystone, SCANOUT_KEYSTONE_TOLERANCE,
+                                                           &left, &top, &right, &bottom) &&
+                            (app->drm->video_plane_underlay || !overlays_on_top);
+
+            if (plane_ok && (new_primary_frame_ready || !app->scanout_active)) {
+                plane_ok = scanout_present_frame(app, video_width, video_height, left, top, right, bottom);
+                if (plane_ok && !app->scanout_active) {
+                    LOG_INFO("[Render] Video 1 on KMS overlay plane (zero GPU composition)\n");
+                }
+            }
+
+            if (plane_ok) {
+                // Primary only carries overlays: transparent over an underlay plane
+                glClearColor(0.0f, 0.0f, 0.0f, app->drm->video_plane_underlay ? 0.0f : 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+                app->scanout_active = true;
+                rendered = true;
+            } else if (app->scanout_active) {
+                // Keystone warped or overlay needed: hand the held frame back to GL
+                drm_clear_video_plane(app->drm);
+                LOG_INFO("[Render] Video 1 back to GL composition\n");
+                app->scanout_active = false;
+                new_primary_frame_ready = true;
+            }
+        } else if (app->scanout_active && !scanout_wanted) {
+            // Governor recovered: video 1 goes back to GL composition
+            drm_clear_video_plane(app->drm);
+            LOG_INFO("[Render] Video 1 back to GL composition\n");
+            app->scanout_active = false;
+            new_primary_frame_ready = true;
+        }
+
         // PURE HARDWARE PATH: Zero-copy via external texture (multi-plane YUV EGLImage)
         // GPU imports DMA buffer directly - no CPU copy at all
-        if (has_dma && use_hw_decode && new_primary_frame_ready && app->gl->supports_external_texture) {
+        if (!rendered && has_dma && use_hw_decode && compose_pass && app->gl->supports_external_texture) {
             int dma_fd = video_get_dma_fd(app->video);
             if (dma_fd >= 0) {
                 static bool egl_dma_logged = false;
                 if (!egl_dma_logged) {
-                    printf("[Render] Using external texture zero-copy path (pure hardware)\n");
+                    LOG_INFO("[Render] Using external texture zero-copy path (pure hardware)\n");
                     egl_dma_logged = true;
                 }
 
                 int plane_offsets[3] = {0, 0, 0};
                 int plane_pitches[3] = {0, 0, 0};
                 video_get_dma_plane_layout(app->video, plane_offsets, plane_pitches);
+                uint32_t drm_format;
+                uint64_t modifier;
+                video_get_dma_format(app->video, &drm_format, &modifier);
+                int frame_width = video_width;
+                int frame_height = video_height;
+
+                // Drop cached EGLImages if the decoder reallocated its capture pool
+                gl_stream_t *gl_stream = &app->gl->streams[0];
+                unsigned int pool_generation = video_get_dma_pool_generation(app->video);
+                if (pool_generation != gl_stream->ext_pool_generation) {
+                    gl_invalidate_external_cache(app->gl, 0);
+                    gl_stream->ext_pool_generation = pool_generation;
+                }
 
                 if (app->show_timing) {
                     clock_gettime(CLOCK_MONOTONIC, &gl_upload_start);
                 }
-                gl_render_frame_external(app->gl, dma_fd, video_width, video_height,
-                                        plane_offsets, plane_pitches,
+
+                // Sample the ISP's scaled NV12 copy instead when the frame is far larger than the quad
+                isp_scaler_frame_t isp_frame;
+                if (app->isp && isp_scale_primary(app, new_primary_frame_ready, video_width, video_height,
+                                                  &isp_frame)) {
+                    if (isp_frame.generation != gl_stream->ext_isp_generation) {
+                        gl_invalidate_external_cache(app->gl, 0);
+                        gl_stream->ext_isp_generation = isp_frame.generation;
+                    }
+                    dma_fd = isp_frame.dma_fd;
+                    frame_width = isp_frame.width;
+                    frame_height = isp_frame.height;
+                    memcpy(plane_offsets, isp_frame.plane_offset, sizeof(plane_offsets));
+                    memcpy(plane_pitches, isp_frame.plane_pitch, sizeof(plane_pitches));
+                    drm_format = isp_frame.drm_format;
+                    modifier = isp_frame.modifier;
+                }
+
+                gl_render_frame_external(app->gl, dma_fd, frame_width, frame_height,
+                                        plane_offsets, plane_pitches, drm_format, modifier,
                                         app->drm, app->keystone, true, 0);
                 if (app->show_timing) {
                     clock_gettime(CLOCK_MONOTONIC, &gl_upload_end);
@@ -1348,15 +2291,19 @@ void app_run(app_context_t *app) {
         }
 
         // SOFTWARE DECODE PATH: Direct YUV420P upload (no conversion)
-        if (!rendered && !use_hw_decode && new_primary_frame_ready) {
+        if (!rendered && !use_hw_decode && compose_pass) {
             static bool sw_path_logged = false;
             if (!sw_path_logged) {
-                printf("[Render] Using CPU upload path (software decode)\n");
+                LOG_INFO("[Render] Using CPU upload path (software decode)\n");
                 sw_path_logged = true;
             }
 
             video_get_yuv_data(app->video, &y_data, &u_data, &v_data, &y_stride, &u_stride, &v_stride);
-            if (y_data && u_data && v_data) {
+            if (!new_primary_frame_ready) {
+                // Pass is for another stream's frame: redraw video 1 from its textures
+                y_data = u_data = v_data = NULL;
+            }
+            if ((y_data && u_data && v_data) || !new_primary_frame_ready) {
                 if (app->show_timing) {
                     clock_gettime(CLOCK_MONOTONIC, &gl_upload_start);
                 }
@@ -1371,10 +2318,10 @@ void app_run(app_context_t *app) {
         }
 
         // FALLBACK: HW decode without DMA support - use CPU transfer path
-        if (!rendered && use_hw_decode && new_primary_frame_ready) {
+        if (!rendered && use_hw_decode && compose_pass) {
             static bool fallback_logged = false;
             if (!fallback_logged) {
-                printf("[Render] Using CPU fallback path (HW decode, no EGL/DMA)\n");
+                LOG_INFO("[Render] Using CPU fallback path (HW decode, no EGL/DMA)\n");
                 fallback_logged = true;
             }
 
@@ -1405,23 +2352,39 @@ void app_run(app_context_t *app) {
         // When no new frame is ready, skip rendering - keep previous frame on screen
         // Don't render black (causes flashing). Previous frame stays in GPU texture.
         
-        // Issue deferred async decode request once we finish uploading the frame
-        if (using_async_primary && primary_async_request_pending && !primary_async_requested) {
-            async_decode_request_frame(app->async_decoder_primary);
-            primary_async_requested = true;
-            primary_async_request_pending = false;
-        }
+        // Render the other streams with their own keystones on top of video 1.
+        // Whichever stream draws first clears; gl_render_frame binds the YUV program once.
+        bool pass_cleared = rendered;
+        for (int i = 1; i < app->stream_count && compose_pass; i++) {
+            video_stream_t *stream = &app->streams[i];
+            if (!stream->first_frame_decoded) {
+                continue;
+            }
 
-        // Render second video with second keystone (don't clear screen)
-        if (app->video2 && app->keystone2) {
-            // Get dimensions (safe to call anytime)
-            int video_width2 = app->video2->width;
-            int video_height2 = app->video2->height;
-            bool video2_rendered = false;
-            struct timespec gl_upload_start2 = {0, 0}, gl_upload_end2 = {0, 0};
+            uint8_t *sy = NULL, *su = NULL, *sv = NULL;
+            int sy_stride = 0, su_stride = 0, sv_stride = 0;
+            if (stream->new_frame_ready) {
+                video_get_yuv_data(stream->video, &sy, &su, &sv, &sy_stride, &su_stride, &sv_stride);
+                if (!sy || !su || !sv || sy_stride <= 0) {
+                    sy = su = sv = NULL;  // Redraw the previous frame instead
+                }
+            }
+
+            struct timespec stream_upload_start = {0, 0}, stream_upload_end = {0, 0};
+            if (app->show_timing) {
+                clock_gettime(CLOCK_MONOTONIC, &stream_upload_start);
+            }
+            gl_render_frame(app->gl, sy, su, sv, stream->video->width, stream->video->height,
+                            sy_stride, su_stride, sv_stride, app->drm, stream->keystone, !pass_cleared, i);
+            if (app->show_timing && sy) {
+                clock_gettime(CLOCK_MONOTONIC, &stream_upload_end);
+                upload_frame_time[i] = timespec_diff_seconds(&stream_upload_start, &stream_upload_end);
+            }
+            pass_cleared = true;
+        }
 
         if (app->show_timing) {
-            for (int i = 0; i < 2; ++i) {
+            for (int i = 0; i < app->stream_count; ++i) {
                 if (nv12_frame_time[i] >= 0.0) {
                     nv12_interval_sum[i] += nv12_frame_time[i];
                     if (nv12_frame_time[i] < nv12_interval_min[i]) {
@@ -1445,21 +2408,6 @@ void app_run(app_context_t *app) {
                 }
             }
         }
-
-            // SYNC DECODE: Video 2 always has fresh data when new_secondary_frame_ready is true
-            if (new_secondary_frame_ready && y_data2 && u_data2 && v_data2 && y_stride2 > 0) {
-                if (app->show_timing) {
-                    clock_gettime(CLOCK_MONOTONIC, &gl_upload_start2);
-                }
-                gl_render_frame(app->gl, y_data2, u_data2, v_data2, video_width2, video_height2,
-                              y_stride2, u_stride2, v_stride2, app->drm, app->keystone2, false, 1);
-                if (app->show_timing) {
-                    clock_gettime(CLOCK_MONOTONIC, &gl_upload_end2);
-                    upload_frame_time[1] = timespec_diff_seconds(&gl_upload_start2, &gl_upload_end2);
-                }
-                video2_rendered = true;
-            }
-        }
         
         clock_gettime(CLOCK_MONOTONIC, &gl_render_end);
 
@@ -1468,106 +2416,78 @@ skip_video_render:  // Jump here when help is visible to skip video rendering
         // Time overlay rendering
         clock_gettime(CLOCK_MONOTONIC, &overlay_start);
         
-        // OPTIMIZED: Only render overlays when actually needed
-        // Render overlays for first keystone
-        // NOTE: Overlay visibility was already checked above to determine rendering path
-        if (any_overlay_visible) {
-            // No special GL setup needed - overlays render on top of video
-            // (we already switched to OpenGL path if overlays are visible)
-
-            // PRODUCTION FIX: Only deselect keystone1 if keystone2 is the active one
-            // This ensures only the ACTIVE keystone's corner is highlighted
-            int saved_selected_corner1 = -1;
-            if (app->keystone2 && app->active_keystone == 1 && app->keystone2->selected_corner >= 0) {
-                // Keystone 2 is active, temporarily hide keystone 1's selection
-                saved_selected_corner1 = app->keystone->selected_corner;
-                app->keystone->selected_corner = -1;
+        // Expire the notification before keying the overlay layer
+        if (app->notification_active) {
+            struct timespec current_ts;
+            clock_gettime(CLOCK_MONOTONIC, &current_ts);
+            double current_time = current_ts.tv_sec + current_ts.tv_nsec / 1e9;
+            if (current_time - app->notification_start_time >= app->notification_duration) {
+                app->notification_active = false;
             }
+        }
 
-            // Only render the overlays that are actually visible
-            if (app->keystone->show_corners) {
-                gl_render_corners(app->gl, app->keystone);
-            }
-            if (app->keystone->show_border) {
-                gl_render_border(app->gl, app->keystone);
-                gl_render_display_boundary(app->gl, app->keystone);
-            }
-            if (app->keystone->show_help) {
-                gl_render_help_overlay(app->gl, app->keystone);
-            }
+        // OPTIMIZATION: Overlays are drawn into the cached overlay layer only when
+        // their content changes; otherwise the layer is composited as one quad.
+        // PRODUCTION FIX: Streams other than video 1 only get overlays once they have a
+        // frame, which prevents flickering during startup before the first frame is decoded
+        bool notification_visible = app->notification_active && guides_allowed;
+        uint64_t overlay_key = overlay_content_key(app, notification_visible, guides_allowed);
+        if (overlay_key != 0 && gl_overlay_begin(app->gl, app->drm, overlay_key)) {
+            keystone_context_t *active_ks = get_active_keystone(app);
+
+            for (int i = 0; any_overlay_visible && i < app->stream_count; i++) {
+                video_stream_t *stream = &app->streams[i];
+                keystone_context_t *ks = stream->keystone;
+                if (i > 0 && !stream->first_frame_decoded) {
+                    continue;
+                }
+                if (!ks->show_corners && !ks->show_border) {
+                    continue;
+                }
 
-            // Restore keystone1's selection if it was hidden
-            if (saved_selected_corner1 >= 0) {
-                app->keystone->selected_corner = saved_selected_corner1;
-            }
-            
-            // NOTE: State restoration is now handled by gl_render_frame()
-            // The main video rendering function detects and fixes state corruption
-            
-            // Clear any OpenGL errors from overlay rendering
-            while (glGetError() != GL_NO_ERROR) {
-                // Clear error queue
-            }
-        }
+                // PRODUCTION FIX: Only the ACTIVE keystone's corner is highlighted -
+                // temporarily hide the others' selection while another keystone has one
+                int saved_selected_corner = -1;
+                if (ks != active_ks && active_ks->selected_corner >= 0) {
+                    saved_selected_corner = ks->selected_corner;
+                    ks->selected_corner = -1;
+                }
 
-        // ALWAYS render help overlay if visible (even when other overlays aren't)
-        // This allows help to display on blank screen when video is hidden
-        if (app->keystone && app->keystone->show_help) {
-            gl_render_help_overlay(app->gl, app->keystone);
-        }
-        if (app->keystone2 && app->keystone2->show_help) {
-            gl_render_help_overlay(app->gl, app->keystone2);
-        }
+                // Only render the overlays that are actually visible
+                if (ks->show_corners) {
+                    gl_render_corners(app->gl, ks);
+                }
+                if (ks->show_border) {
+                    gl_render_border(app->gl, ks);
+                    gl_render_display_boundary(app->gl, ks);
+                }
 
-        // Render overlays for second keystone
-        // PRODUCTION FIX: Only render keystone2 overlays when video2 has valid frame data
-        // This prevents flickering during initial startup before first frame is decoded
-        // NOTE: Use first_frame_decoded2 instead of y_data2 for HW decode (y_data2 is NULL in HW path)
-        if (any_overlay_visible2 && first_frame_decoded2) {
-            // PRODUCTION FIX: Only deselect keystone2 if keystone1 is the active one
-            // This ensures only the ACTIVE keystone's corner is highlighted
-            int saved_selected_corner = -1;
-            if (app->active_keystone == 0 && app->keystone->selected_corner >= 0) {
-                // Keystone 1 is active, temporarily hide keystone 2's selection
-                saved_selected_corner = app->keystone2->selected_corner;
-                app->keystone2->selected_corner = -1;
+                // Restore the selection if it was hidden
+                if (saved_selected_corner >= 0) {
+                    ks->selected_corner = saved_selected_corner;
+                }
             }
 
-            if (app->keystone2->show_corners) {
-                gl_render_corners(app->gl, app->keystone2);
-            }
-            if (app->keystone2->show_border) {
-                gl_render_border(app->gl, app->keystone2);
-                gl_render_display_boundary(app->gl, app->keystone2);
-            }
-            if (app->keystone2->show_help) {
-                gl_render_help_overlay(app->gl, app->keystone2);
+            // Help renders even without other overlays, on the blank screen
+            for (int i = 0; i < app->stream_count; i++) {
+                if (app->streams[i].keystone->show_help) {
+                    gl_render_help_overlay(app->gl, app->streams[i].keystone);
+                }
             }
 
-            // Restore the selection
-            if (saved_selected_corner >= 0) {
-                app->keystone2->selected_corner = saved_selected_corner;
+            if (notification_visible) {
+                gl_render_notification_overlay(app->gl, app->notification_message);
             }
 
+            gl_overlay_end(app->gl);
+
+            // Clear any OpenGL errors from overlay rendering
             while (glGetError() != GL_NO_ERROR) {
                 // Clear error queue
             }
         }
-        
-        // Render notification overlay if active
-        if (app->notification_active) {
-            struct timespec current_ts;
-            clock_gettime(CLOCK_MONOTONIC, &current_ts);
-            double current_time = current_ts.tv_sec + current_ts.tv_nsec / 1e9;
-            double elapsed = current_time - app->notification_start_time;
-
-            if (elapsed < app->notification_duration) {
-                // Notification is still active - render it with text
-                gl_render_notification_overlay(app->gl, app->notification_message);
-            } else {
-                // Notification expired
-                app->notification_active = false;
-            }
+        if (overlay_key != 0) {
+            gl_overlay_composite(app->gl);
         }
 
         clock_gettime(CLOCK_MONOTONIC, &overlay_end);
@@ -1580,28 +2500,51 @@ skip_video_render:  // Jump here when help is visible to skip video rendering
 
         clock_gettime(CLOCK_MONOTONIC, &swap_end);
 
+        // Feed completed flips (kernel vblank timestamps) into the scheduler
+        unsigned int deadline_misses = 0;
+        if (app->drm->flip_count != sched_flip_count) {
+            // Vblanks that went by without one of these flips were missed refreshes
+            if (sched_flip_count > 0) {
+                unsigned int vblanks = app->drm->last_flip_seq - sched_flip_seq;
+                uint64_t flips = app->drm->flip_count - sched_flip_count;
+                if (vblanks > flips) {
+                    metrics_record_vblank_misses(vblanks - (unsigned int)flips);
+                    deadline_misses = vblanks - (unsigned int)flips;
+                }
+            }
+            sched_flip_seq = app->drm->last_flip_seq;
+            sched_flip_count = app->drm->flip_count;
+            frame_sched_on_vblank(app->scheduler, app->drm->last_flip_seq,
+                                  (double)app->drm->last_flip_time_us / 1e6);
+        }
+        // Video 1's late drops count too; capped secondary streams drop on purpose
+        unsigned int primary_dropped = app->scheduler->streams[0].dropped;
+        deadline_misses += primary_dropped - governor_dropped_seen;
+        governor_dropped_seen = primary_dropped;
+        governor_note_frame(app->governor, deadline_misses);
+
         // Capture render_end after swap completes
         clock_gettime(CLOCK_MONOTONIC, &render_end);
 
         // OPTIMIZATION: Pre-decode next frame DURING vsync wait (for KMS path)
         // For KMS overlay, the vsync wait happens in drm_display_video_frame (line 1104)
         // We can overlap the next frame's decode with the current frame's display
-        if (!using_async_primary && first_frame_decoded && !next_frame_ready && frame_count > 0) {
+        if (!using_async_primary && primary->first_frame_decoded && !primary->next_frame_ready && primary->frame_count > 0) {
             struct timespec predecode_start, predecode_end;
             clock_gettime(CLOCK_MONOTONIC, &predecode_start);
 
             int predecode_result = video_decode_frame(app->video);
 
             clock_gettime(CLOCK_MONOTONIC, &predecode_end);
-            // Note: predecode timing not currently logged but available if needed
 
             if (predecode_result == 0) {
-                next_frame_ready = true;
+                metrics_record_decode(0, timespec_diff_seconds(&predecode_start, &predecode_end));
+                primary->next_frame_ready = true;
             } else if (video_is_eof(app->video)) {
                 // EOF during pre-decode - will be handled in main decode section next iteration
-                next_frame_ready = false;
+                primary->next_frame_ready = false;
             } else {
-                next_frame_ready = false;
+                primary->next_frame_ready = false;
             }
         }
         
@@ -1614,35 +2557,31 @@ skip_video_render:  // Jump here when help is visible to skip video rendering
         
         total_render_time += render_time;
         render_frame_count++;  // Increment frame counter for every rendered frame
+        if (render_frame_count == STARTUP_CACHE_SETTLE_FRAMES) {
+            startup_cache_flush_async();  // Hardware/software decode decisions have been made
+        }
         
-        // FRAME DROP DETECTION: Track dropped frames for diagnostics
-        static struct timespec last_frame_time = {0, 0};
-        static int frame_drop_count = 0;
+        // FRAME DROP DETECTION: Drops are decided by the scheduler, report new ones
+        static unsigned int frame_drop_count = 0;
         static int frame_drop_reports = 0;
 
-        struct timespec current_time_drop;
-        clock_gettime(CLOCK_MONOTONIC, &current_time_drop);
-
-        if (last_frame_time.tv_sec != 0) {
-            double time_since_last = (current_time_drop.tv_sec - last_frame_time.tv_sec) +
-                                   (current_time_drop.tv_nsec - last_frame_time.tv_nsec) / 1e9;
-
-            // At 60fps, frames should arrive every ~16.7ms
-            // If we see >25ms, we may have dropped a frame
-            if (time_since_last > 0.025 && render_frame_count > 10) {
-                frame_drop_count++;
-                // PRODUCTION: Only report first 5 drops, then summary every 100 frames
-                if (frame_drop_reports < 5) {
-                    printf("⚠ [FRAME DROP] Frame %d: %.1fms since last frame (expected ~16.7ms)\n",
-                           render_frame_count, time_since_last * 1000);
-                    frame_drop_reports++;
-                    if (frame_drop_reports == 5) {
-                        printf("  (Further frame drops will be summarized periodically)\n");
-                    }
+        unsigned int sched_drops = 0;
+        for (int i = 0; i < app->stream_count; i++) {
+            sched_drops += app->scheduler->streams[i].dropped;
+        }
+        if (sched_drops != frame_drop_count) {
+            // PRODUCTION: Only report first 5 drops, then summary every 100 frames
+            if (frame_drop_reports < 5 && render_frame_count > 10) {
+                LOG_WARN("⚠ [FRAME DROP] Frame %d: scheduler dropped %u late frame(s) (vblank %.1fms)\n",
+                       render_frame_count, sched_drops - frame_drop_count,
+                       app->scheduler->vblank_period * 1000);
+                frame_drop_reports++;
+                if (frame_drop_reports == 5) {
+                    LOG_WARN("  (Further frame drops will be summarized periodically)\n");
                 }
             }
+            frame_drop_count = sched_drops;
         }
-        last_frame_time = current_time_drop;
         
         // Per-frame detailed timing breakdown
         double gl_render_time = (gl_render_end.tv_sec - gl_render_start.tv_sec) +
@@ -1653,48 +2592,93 @@ skip_video_render:  // Jump here when help is visible to skip video rendering
                           (swap_end.tv_nsec - swap_start.tv_nsec) / 1e9;
         double upload_time = gl_render_time; // Upload happens during gl_render_frame calls
         double warp_draw_time = overlay_time; // Warp+draw is overlay rendering
-        double total_stage_time = decode0_time + decode1_time + upload_time + warp_draw_time + swap_time;
+        double total_stage_time = decode0_time + upload_time + warp_draw_time + swap_time;
+        
+        double frame_interval = last_swap_end.tv_sec ? timespec_diff_seconds(&last_swap_end, &swap_end) : 0.0;
+        last_swap_end = swap_end;
+        metrics_record_render(upload_time, warp_draw_time, swap_time, frame_interval);
+        for (int i = 0; i < app->stream_count; i++) {
+            const frame_sched_stream_t *sched_stream = &app->scheduler->streams[i];
+            metrics_set_frames(i, sched_stream->shown, sched_stream->dropped, sched_stream->repeated);
+            if (app->streams[i].decoder) {
+                metrics_set_queue(i, async_decode_queued(app->streams[i].decoder),
+                                  (int)app->streams[i].decoder->capacity);
+            }
+        }
         
         // Per-frame output (every 6 frames to reduce spam, ~10 fps @ 60fps capture)
-        if (app->show_timing && frame_count > 0 && frame_count % 6 == 0) {
-            printf("[PERF] Frame %d: decode0=%.2fms decode1=%.2fms upload=%.2fms warp+draw=%.2fms swap=%.2fms total=%.2fms\n",
-                   frame_count,
+        if (app->show_timing && primary->frame_count > 0 && primary->frame_count % 6 == 0) {
+            LOG_PRINT("[PERF] Frame %d: decode0=%.2fms upload=%.2fms warp+draw=%.2fms swap=%.2fms total=%.2fms\n",
+                   primary->frame_count,
                    decode0_time * 1000,
-                   decode1_time * 1000,
                    upload_time * 1000,
                    warp_draw_time * 1000,
                    swap_time * 1000,
                    total_stage_time * 1000);
-             // Only log NV12 conversion time if using hardware decode
-             if (app->video->use_hardware_decode || (app->video2 && app->video2->use_hardware_decode)) {
-                 char nv12_ms[2][16];
-                 char upload_ms[2][16];
-                 format_metric_ms(nv12_frame_time[0], nv12_ms[0], sizeof(nv12_ms[0]));
-                 format_metric_ms(nv12_frame_time[1], nv12_ms[1], sizeof(nv12_ms[1]));
-                 format_metric_ms(upload_frame_time[0], upload_ms[0], sizeof(upload_ms[0]));
-                 format_metric_ms(upload_frame_time[1], upload_ms[1], sizeof(upload_ms[1]));
-                 printf("          nv12_cpu(ms)=%s/%s gl_upload(ms)=%s/%s\n",
-                     nv12_ms[0], nv12_ms[1], upload_ms[0], upload_ms[1]);
+             // Only log NV12 conversion time if using hardware decode (video 1 only)
+             if (app->video->use_hardware_decode) {
+                 char nv12_ms[16];
+                 char upload_ms[MAX_VIDEO_STREAMS * 16];
+                 size_t upload_len = 0;
+                 format_metric_ms(nv12_frame_time[0], nv12_ms, sizeof(nv12_ms));
+                 for (int i = 0; i < app->stream_count; i++) {
+                     char stream_ms[16];
+                     format_metric_ms(upload_frame_time[i], stream_ms, sizeof(stream_ms));
+                     upload_len += snprintf(upload_ms + upload_len, sizeof(upload_ms) - upload_len,
+                                            "%s%s", i ? "/" : "", stream_ms);
+                 }
+                 LOG_PRINT("          nv12_cpu(ms)=%s gl_upload(ms)=%s\n", nv12_ms, upload_ms);
              }
-            fflush(stdout);
+            // Threaded read-ahead only: mmap inputs have nothing to report
+            for (int i = 0; i < app->stream_count; i++) {
+                read_ahead_stats_t io;
+                video_get_io_stats(app->streams[i].video, &io);
+                if (io.mode == READ_AHEAD_MODE_THREAD && io.capacity > 0) {
+                    LOG_PRINT("          io%d: %s %.1f/%.0fMB underruns=%u last_stall=%.0fms\n", i + 1,
+                           read_ahead_state_name(io.state), (double)io.buffered / (1024.0 * 1024.0),
+                           (double)io.capacity / (1024.0 * 1024.0), io.underruns, io.last_stall_ms);
+                }
+            }
+            if (app->sync) {
+                net_sync_stats_t sync_stats;
+                net_sync_get_stats(app->sync, &sync_stats);
+                if (sync_stats.role == NET_SYNC_LEADER) {
+                    LOG_PRINT("          sync: leader, %d follower(s)\n", sync_stats.followers);
+                } else {
+                    LOG_PRINT("          sync: %s offset=%.3fms drift=%.1fppm rtt=%.3fms\n",
+                           sync_stats.locked ? "locked" : "free-running", sync_stats.offset * 1000.0,
+                           sync_stats.drift_ppm, sync_stats.rtt * 1000.0);
+                }
+            }
+            if (app->governor) {
+                governor_stats_t gov_stats;
+                governor_get_stats(app->governor, &gov_stats);
+                LOG_PRINT("          governor: level %d/%d temp=%.1fC throttled=0x%x arm=%u/%uMHz miss=%.1f%%\n",
+                       gov_stats.level, gov_stats.level_count, gov_stats.temp_c,
+                       gov_stats.throttled < 0 ? 0 : (unsigned int)gov_stats.throttled,
+                       gov_stats.arm_mhz, gov_stats.arm_max_mhz, gov_stats.miss_rate * 100.0);
+            }
+            // Live sources: measured receive-to-vblank latency since the last report
+            for (int i = 0; app->live && i < app->stream_count; i++) {
+                double latency_avg = 0.0, latency_max = 0.0;
+                if (frame_sched_take_latency(app->scheduler, i, &latency_avg, &latency_max) > 0) {
+                    LOG_PRINT("          live%d: latency avg=%.1fms max=%.1fms target=%.0fms stale_dropped=%u\n",
+                           i + 1, latency_avg * 1000.0, latency_max * 1000.0, app->live_latency * 1000.0,
+                           app->scheduler->streams[i].stale_dropped);
+                }
+            }
         }
         
-        // Store timing samples for analysis (only if buffers allocated successfully)
-        if (decode_times && render_times) {
-            if (timing_samples < 300) {
-                decode_times[timing_buffer_idx] = decode_time;
-                render_times[timing_buffer_idx] = render_time;
-                timing_buffer_idx = (timing_buffer_idx + 1) % 300;
-                timing_samples++;
-            } else {
-                decode_times[timing_buffer_idx] = decode_time;
-                render_times[timing_buffer_idx] = render_time;
-                timing_buffer_idx = (timing_buffer_idx + 1) % 300;
-            }
+        // Store timing samples for analysis
+        decode_times[timing_buffer_idx] = decode_time;
+        render_times[timing_buffer_idx] = render_time;
+        timing_buffer_idx = (timing_buffer_idx + 1) % TIMING_WINDOW_FRAMES;
+        if (timing_samples < TIMING_WINDOW_FRAMES) {
+            timing_samples++;
         }
         
         // Detailed frame timing analysis every 30 frames
-        if (app->show_timing && diagnostic_frame_count % 30 == 0 && diagnostic_frame_count > 0 && decode_times && render_times) {
+        if (app->show_timing && diagnostic_frame_count % 30 == 0 && diagnostic_frame_count > 0) {
             static int last_reported_frame = -1;
             
             // Only print once per unique frame milestone
@@ -1703,7 +2687,7 @@ skip_video_render:  // Jump here when help is visible to skip video rendering
                 
                 double avg_decode = 0, min_decode = 999, max_decode = 0;
                 double avg_render = 0, min_render = 999, max_render = 0;
-                int samples = timing_samples < 300 ? timing_samples : 300;
+                int samples = timing_samples;
                 
                 for (int i = 0; i < samples; i++) {
                     avg_decode += decode_times[i];
@@ -1717,22 +2701,19 @@ skip_video_render:  // Jump here when help is visible to skip video rendering
                 avg_decode /= samples;
                 avg_render /= samples;
                 
-                printf("\n[TIMING ANALYSIS - Frame %d]\n", diagnostic_frame_count);
-                printf("  DECODE:  Avg: %.3fms, Min: %.3fms, Max: %.3fms (samples: %d)\n",
+                LOG_PRINT("\n[TIMING ANALYSIS - Frame %d]\n", diagnostic_frame_count);
+                LOG_PRINT("  DECODE:  Avg: %.3fms, Min: %.3fms, Max: %.3fms (samples: %d)\n",
                        avg_decode * 1000, min_decode * 1000, max_decode * 1000, samples);
-                printf("  RENDER:  Avg: %.3fms, Min: %.3fms, Max: %.3fms\n",
+                LOG_PRINT("  RENDER:  Avg: %.3fms, Min: %.3fms, Max: %.3fms\n",
                        avg_render * 1000, min_render * 1000, max_render * 1000);
-                printf("  Target frame time: %.2fms\n", target_frame_time * 1000);
-                printf("  Hardware decode: %s\n", video_is_hardware_decoded(app->video) ? "YES" : "NO");
-                printf("  Total time: %.3fms (decode + render)\n", (avg_decode + avg_render) * 1000);
-                printf("  Note: Low times indicate worker thread and pre-decode optimizations working\n");
-
-                // Only report NV12 stats when hardware decode is enabled
-                bool hw_v1 = video_is_hardware_decoded(app->video);
-                bool hw_v2 = app->video2 && video_is_hardware_decoded(app->video2);
-
-                if (hw_v1 || hw_v2) {
-                    for (int vid = 0; vid < 2; ++vid) {
+                LOG_PRINT("  Target frame time: %.2fms\n", target_frame_time * 1000);
+                LOG_PRINT("  Hardware decode: %s\n", video_is_hardware_decoded(app->video) ? "YES" : "NO");
+                LOG_PRINT("  Total time: %.3fms (decode + render)\n", (avg_decode + avg_render) * 1000);
+                LOG_PRINT("  Note: Low times indicate worker thread and pre-decode optimizations working\n");
+
+                // Only report NV12 stats when hardware decode is enabled (video 1 only)
+                if (video_is_hardware_decoded(app->video)) {
+                    for (int vid = 0; vid < app->stream_count; ++vid) {
                         if (nv12_interval_count[vid] == 0) {
                             nv12_interval_min[vid] = 0.0;
                         }
@@ -1741,34 +2722,36 @@ skip_video_render:  // Jump here when help is visible to skip video rendering
                         }
                     }
 
-                    printf("  NV12 CPU:  V1 Avg: %.2fms (min: %.2fms, max: %.2fms, samples: %d) | V2 Avg: %.2fms (min: %.2fms, max: %.2fms, samples: %d)\n",
+                    LOG_PRINT("  NV12 CPU:  V1 Avg: %.2fms (min: %.2fms, max: %.2fms, samples: %d)\n",
                            nv12_interval_count[0] ? (nv12_interval_sum[0] / nv12_interval_count[0]) * 1000.0 : 0.0,
                            nv12_interval_min[0] * 1000.0,
                            nv12_interval_max[0] * 1000.0,
-                           nv12_interval_count[0],
-                           nv12_interval_count[1] ? (nv12_interval_sum[1] / nv12_interval_count[1]) * 1000.0 : 0.0,
-                           nv12_interval_min[1] * 1000.0,
-                           nv12_interval_max[1] * 1000.0,
-                           nv12_interval_count[1]);
-
-                    printf("  GL Upload: V1 Avg: %.2fms (min: %.2fms, max: %.2fms, samples: %d) | V2 Avg: %.2fms (min: %.2fms, max: %.2fms, samples: %d)\n",
-                           gl_upload_interval_count[0] ? (gl_upload_interval_sum[0] / gl_upload_interval_count[0]) * 1000.0 : 0.0,
-                           gl_upload_interval_min[0] * 1000.0,
-                           gl_upload_interval_max[0] * 1000.0,
-                           gl_upload_interval_count[0],
-                           gl_upload_interval_count[1] ? (gl_upload_interval_sum[1] / gl_upload_interval_count[1]) * 1000.0 : 0.0,
-                           gl_upload_interval_min[1] * 1000.0,
-                           gl_upload_interval_max[1] * 1000.0,
-                           gl_upload_interval_count[1]);
+                           nv12_interval_count[0]);
+
+                    for (int vid = 0; vid < app->stream_count; ++vid) {
+                        LOG_PRINT("  GL Upload: V%d Avg: %.2fms (min: %.2fms, max: %.2fms, samples: %d)\n",
+                               vid + 1,
+                               gl_upload_interval_count[vid] ? (gl_upload_interval_sum[vid] / gl_upload_interval_count[vid]) * 1000.0 : 0.0,
+                               gl_upload_interval_min[vid] * 1000.0,
+                               gl_upload_interval_max[vid] * 1000.0,
+                               gl_upload_interval_count[vid]);
+                    }
+                }
+                
+                if (app->gl->use_pbo) {
+                    gl_pbo_stats_t pbo_stats;
+                    gl_get_pbo_stats(app->gl, &pbo_stats);
+                    LOG_PRINT("  PBO ring: %d slots, %u staged, %u backpressured, retire avg %.2fms (max %.2fms)\n",
+                           app->gl->pbo_ring_count, pbo_stats.uploads, pbo_stats.backpressure,
+                           pbo_stats.retire_ms_avg, pbo_stats.retire_ms_max);
                 }
                 
                 if (avg_decode + avg_render > target_frame_time * 1.1) {
-                    printf("  ⚠ WARNING: Frame taking %.0f%% of budget!\n", 
+                    LOG_PRINT("  ⚠ WARNING: Frame taking %.0f%% of budget!\n", 
                            ((avg_decode + avg_render) / target_frame_time) * 100);
                 }
-                fflush(stdout);
 
-                for (int vid = 0; vid < 2; ++vid) {
+                for (int vid = 0; vid < app->stream_count; ++vid) {
                     nv12_interval_sum[vid] = 0.0;
                     nv12_interval_min[vid] = 1e9;
                     nv12_interval_max[vid] = 0.0;
@@ -1787,43 +2770,20 @@ skip_video_render:  // Jump here when help is visible to skip video rendering
         // FIXED: For KMS overlay, drmModeSetPlane doesn't reliably wait for vsync on RPi
         // Must manually pace frames to avoid overwhelming the worker thread
         double total_frame_time = decode_time + render_time;
-        double remaining_time = target_frame_time - total_frame_time;
         
-        // PRODUCTION: PTS-based drift compensation to prevent timing skew over long playback
-        // Check if current wall-clock time matches where video playback should be
-        static double first_frame_wall_time = -1.0;
-        static double first_frame_pts_time = -1.0;
-        
-        if (app->video && app->video->frame && app->video->frame->pts != AV_NOPTS_VALUE) {
-            AVStream *stream = app->video->format_ctx->streams[app->video->video_stream_index];
-            if (stream && stream->time_base.den > 0) {
-                // Calculate video PTS in seconds
-                double frame_pts_seconds = (double)app->video->frame->pts * stream->time_base.num / stream->time_base.den;
-                
-                // Initialize baseline on first frame
-                if (first_frame_wall_time < 0) {
-                    first_frame_wall_time = current_total_time;
-                    first_frame_pts_time = frame_pts_seconds;
-                }
-                
-                // Calculate how far into playback we should be
-                double intended_wall_time = first_frame_wall_time + (frame_pts_seconds - first_frame_pts_time);
-                double wall_drift = current_total_time - intended_wall_time;
-                
-                // If we're significantly ahead or behind, adjust sleep time
-                // Max adjustment is +/- 20ms per frame to avoid jitter
-                if (fabs(wall_drift) > 0.001) {  // More than 1ms drift
-                    double drift_correction = wall_drift * 0.05;  // Smooth correction (5% per frame)
-                    drift_correction = (drift_correction > 0.020) ? 0.020 : drift_correction;
-                    drift_correction = (drift_correction < -0.020) ? -0.020 : drift_correction;
-                    remaining_time -= drift_correction;
-                    
-                    if (app->advanced_diagnostics && fabs(wall_drift) > 0.050) {
-                        fprintf(stderr, "[TIMING] Drift correction: %.1fms (total drift: %.1fms)\n",
-                               drift_correction * 1000, wall_drift * 1000);
-                    }
-                }
-            }
+        // PRODUCTION: Pace to the display, not to 1/fps - wake up one frame's worth of
+        // work before the next vblank so every vblank gets a show/repeat/drop decision.
+        // PTS map onto absolute vblank times, so there is no drift to correct.
+        struct timespec pace_now_ts;
+        clock_gettime(CLOCK_MONOTONIC, &pace_now_ts);
+        double pace_now = (double)pace_now_ts.tv_sec + pace_now_ts.tv_nsec / 1e9;
+        double remaining_time;
+        if (app->scheduler->last_vblank >= 0.0) {
+            double wake_time = frame_sched_next_vblank(app->scheduler, pace_now) - total_frame_time - 0.002;
+            remaining_time = wake_time - pace_now;
+        } else {
+            // No flip timestamps yet (e.g. overlay-only path): fall back to the mode period
+            remaining_time = app->scheduler->vblank_period - total_frame_time;
         }
 
         // PRODUCTION FIX: Frame pacing to prevent jumpiness
@@ -1838,15 +2798,10 @@ skip_video_render:  // Jump here when help is visible to skip video rendering
         }
 
         if (app->show_timing && total_frame_time > target_frame_time * 1.5) {
-            printf("⚠ Frame processing slow: %.1fms (target: %.1fms)\n",
+            LOG_WARN_RATELIMITED("⚠ Frame processing slow: %.1fms (target: %.1fms)\n",
                    total_frame_time * 1000, target_frame_time * 1000);
-            fflush(stdout);
         }
     }  // End while (app->running)
-    
-    // Cleanup timing buffers
-    if (decode_times) free(decode_times);
-    if (render_times) free(render_times);
 }
 
 void app_cleanup(app_context_t *app) {
@@ -1854,14 +2809,40 @@ void app_cleanup(app_context_t *app) {
         return;
     }
     
+    if (app->sync) {
+        net_sync_stop(app->sync);
+        app->sync = NULL;
+    }
+    governor_stop(app->governor);
+    app->governor = NULL;
+    
+    // The playlist worker hands items to stream 0's decoder: stop it before that goes away
+    playlist_worker_join(app->playlist);
+    
     // Stop async decoders first before cleaning up videos
-    if (app->async_decoder_primary) {
-        async_decode_destroy(app->async_decoder_primary);
-        app->async_decoder_primary = NULL;
+    for (int i = 0; i < MAX_VIDEO_STREAMS; i++) {
+        if (app->streams[i].decoder) {
+            async_decode_destroy(app->streams[i].decoder);
+            app->streams[i].decoder = NULL;
+        }
+    }
+    app->async_decoder_primary = NULL;
+    
+    // Take the video plane down before releasing the frames it may still scan out
+    if (app->drm) {
+        drm_hide_video_plane(app->drm);
+    }
+    for (int i = 0; i < SCANOUT_HOLD_FRAMES; i++) {
+        video_dma_frame_release(&app->scanout_frames[i]);
+    }
+    if (app->isp) {
+        isp_scaler_close(app->isp);
+        app->isp = NULL;
     }
-    if (app->async_decoder_secondary) {
-        async_decode_destroy(app->async_decoder_secondary);
-        app->async_decoder_secondary = NULL;
+    // Prepared and retired playlist items; the one on screen is stream 0's video
+    if (app->playlist) {
+        playlist_worker_stop(app->playlist);
+        app->playlist = NULL;
     }
     
     if (app->input) {
@@ -1869,40 +2850,50 @@ void app_cleanup(app_context_t *app) {
         free(app->input);
         app->input = NULL;
     }
-    if (app->keystone) {
-        // Don't auto-save on exit - only save when user presses S key
-        keystone_cleanup(app->keystone);
-        free(app->keystone);
-        app->keystone = NULL;
-    }
-    if (app->keystone2) {
-        keystone_cleanup(app->keystone2);
-        free(app->keystone2);
-        app->keystone2 = NULL;
+    // Don't auto-save on exit - only save when user presses S key
+    for (int i = 0; i < MAX_VIDEO_STREAMS; i++) {
+        if (app->streams[i].keystone) {
+            keystone_cleanup(app->streams[i].keystone);
+            free(app->streams[i].keystone);
+            app->streams[i].keystone = NULL;
+        }
     }
-    if (app->video) {
-        video_cleanup(app->video);
-        free(app->video);
-        app->video = NULL;
+    app->keystone = NULL;
+    if (app->scheduler) {
+        free(app->scheduler);
+        app->scheduler = NULL;
     }
-    if (app->video2) {
-        video_cleanup(app->video2);
-        free(app->video2);
-        app->video2 = NULL;
+    for (int i = 0; i < MAX_VIDEO_STREAMS; i++) {
+        if (app->streams[i].video) {
+            video_cleanup(app->streams[i].video);
+            free(app->streams[i].video);
+            app->streams[i].video = NULL;
+        }
+        // After the stream's own context: its presented frames may come from the standby
+        if (app->streams[i].standby) {
+            video_cleanup(app->streams[i].standby);
+            free(app->streams[i].standby);
+            app->streams[i].standby = NULL;
+        }
     }
+    app->video = NULL;
     if (app->gl) {
         gl_cleanup(app->gl);
         free(app->gl);
         app->gl = NULL;
     }
     if (app->drm) {
-        // Clean up KMS video overlay before general DRM cleanup
-        drm_hide_video_plane(app->drm);
         drm_cleanup(app->drm);
         free(app->drm);
         app->drm = NULL;
     }
 
+    startup_cache_flush();
+
+    // Every thread that records or logs has been joined by now
+    metrics_shutdown();
+    logger_shutdown();
+
     memset(app, 0, sizeof(*app));
     printf("Application cleanup complete\n");
 }
@@ -11,40 +11,171 @@
 #include "video_decoder.h"
 #include "keystone.h"
 #include "input_handler.h"
+#include "frame_scheduler.h"
+#include "playlist.h"
+#include "net_sync.h"
+#include "isp_scaler.h"
+#include "governor.h"
+#include "production_config.h"
+
+// Async decode: the decode thread runs ahead into a bounded single-producer/
+// single-consumer ring, the render loop pops the frame whose PTS is due
+#define ASYNC_DECODE_QUEUE_MAX 8
+
+// Gapless loop: frames the standby decoder decodes from the file start ahead of
+// the loop point. Covers the ring while the standby's pipeline keeps running.
+#define GAPLESS_PREROLL_FRAMES 4
+
+typedef struct {
+    video_frame_ref_t ref;
+    bool discontinuity;      // First frame after a loop restart (timeline jumps back)
+    video_context_t *item_start;  // Playlist: first frame of this item's context (else NULL)
+    unsigned int seek_epoch;      // Decoder's seek_epoch when queued; older slots are stale
+} async_frame_slot_t;
 
-// Async decode context for video 2
 typedef struct {
     pthread_t thread;
-    pthread_mutex_t mutex;
+    pthread_mutex_t mutex;   // Only used to sleep when the ring is full/empty
     pthread_cond_t cond;
     bool running;
     bool should_exit;
     video_context_t *video;
-    bool frame_ready;
-    bool decoding;
+    int stream_index;        // Core share and thread name (thread_topology)
+
+    // SPSC ring: producer owns tail, consumer owns head (free-running counters)
+    async_frame_slot_t slots[ASYNC_DECODE_QUEUE_MAX];
+    unsigned int capacity;
+    unsigned int head;
+    unsigned int tail;
+    bool producer_waiting;
+    bool consumer_waiting;
+    bool eof;                // Stream ended without looping; no more frames will be queued
+
+    // Gapless loop (decode thread only): standby is a second decoder on the same
+    // file that pre-rolls the opening frames while the active one plays the tail.
+    // At EOF the two swap roles instead of seek + flush + refill.
+    video_context_t *standby;                 // Borrowed; NULL loops by seeking
+    video_frame_ref_t preroll[GAPLESS_PREROLL_FRAMES];
+    int preroll_count;
+    int preroll_pushed;                       // < preroll_count: draining into the ring
+    bool preroll_done;                        // Standby has its opening frames (or reached EOF)
+    bool rebase_pending;                      // Next queued PTS continues the timeline
+    double timeline_end;                      // End of the last queued frame (-1 until one is queued)
+    double pts_offset;                        // Added to queued PTS so the timeline never jumps back
+    unsigned int gapless_loops;
+
+    // Playlist: the standby is the next item, handed over by the playlist worker.
+    // At EOF (or on skip_item) decoding moves on to it and the old context is left
+    // to the render thread, which retires it once the new item reaches the screen.
+    bool playlist;
+    video_context_t *incoming;                // Worker -> decode thread handoff (atomic)
+    video_context_t *item_start;              // Decode thread: tag the next queued frame
+    video_context_t *item_switch;             // Render thread: popped item start, not yet taken
+    bool skip_item;                           // Cut over as soon as a standby is ready (atomic)
+    bool playlist_end;                        // No further item will arrive (atomic)
+    int64_t seek_request_ms;                  // Control "seek": target in the active item, -1 none (atomic)
+    unsigned int seek_epoch;                  // Bumped per completed seek; the render side drops older slots (atomic)
+    unsigned int playlist_switches;
 } async_decode_t;
 
+// Overlay scanout keeps this many recent frames referenced: one on screen, one in
+// the plane worker's blocking SetPlane, one pending in its mailbox, plus one spare
+#define SCANOUT_HOLD_FRAMES 4
+
+// Playlist worker: opens the next item while the current one plays, hands it to
+// stream 0's decode thread and closes items that went off screen after a grace period
+#define PLAYLIST_RETIRE_SLOTS 4
+#define PLAYLIST_RETIRE_GRACE_SECONDS 0.25
+#define PLAYLIST_POLL_MS 50
+
+// --timing: decode/render analysis window, fixed arrays in app_run
+#define TIMING_WINDOW_FRAMES 300
+
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;        // Guards pending, want_next and the retire list
+    bool running;
+    bool should_exit;
+    playlist_t *list;            // Borrowed; only the worker thread touches it after start
+    async_decode_t *decoder;
+
+    // How items are opened, copied from stream 0 at start
+    bool hardware_decode;
+    bool external_texture;
+    bool advanced_diagnostics;
+    video_frame_allocator_t allocator;
+
+    video_context_t *pending;    // Opened, not on screen yet (owned by the worker)
+    bool want_next;              // Open the following item
+    video_context_t *retired[PLAYLIST_RETIRE_SLOTS];
+    double retired_at[PLAYLIST_RETIRE_SLOTS];
+} playlist_worker_t;
+
+// One composited video: its own decoder, decode thread, keystone quad and
+// (via video_index) GL texture set. Stream 0 is the primary and may use
+// hardware decode and overlay scanout; the rest always decode in software.
+typedef struct {
+    video_context_t *video;
+    video_context_t *standby;    // Gapless loop decoder on the same file (NULL if off)
+    async_decode_t *decoder;
+    keystone_context_t *keystone;
+    const char *file;
+    char keystone_file[32];      // pickle_keystone.conf, pickle_keystone2.conf, ...
+    bool first_frame_decoded;
+    bool new_frame_ready;        // A frame was presented this iteration (textures need upload)
+    bool next_frame_ready;       // Synchronous decode (no decode thread): next frame already decoded
+    int frame_count;
+    uint8_t *last_video_data;    // Synchronous decode: buffer re-shown when no new frame came out
+    double last_present_vblank;  // Governor secondary fps cap: vblank the last frame was shown at
+    unsigned int scanout_pool_generation;  // Capture pool the overlay plane's cached FBs belong to
+} video_stream_t;
+
 // Main application context
 typedef struct {
+    video_stream_t streams[MAX_VIDEO_STREAMS];
+    int stream_count;
+
+    // Stream 0 shorthands (HW decode, scanout and sync decode only apply to it)
     video_context_t *video;
-    video_context_t *video2;     // Second video decoder
-    async_decode_t *async_decoder_primary;   // Async decode thread for video 1 (software path)
-    async_decode_t *async_decoder_secondary; // Async decode thread for video 2
+    async_decode_t *async_decoder_primary;   // Async decode thread for video 1
+    keystone_context_t *keystone;
+    const char *video_file;
+    playlist_worker_t *playlist;   // --playlist: stream 0 plays the list's items back-to-back
+
     display_ctx_t *drm;
     gl_context_t *gl;
     input_context_t *input;
-    keystone_context_t *keystone;
-    keystone_context_t *keystone2; // Second keystone for second video
+    frame_scheduler_t *scheduler;  // PTS-to-vblank presentation clock shared by all streams
     bool running;
     bool loop_playback;
-    const char *video_file;
-    const char *video_file2;     // Second video file path
     bool needs_redraw;       // Flag to indicate frame needs redrawing
     bool show_timing;        // Flag to show frame timing information
     bool debug_gamepad;      // Flag to log gamepad button presses
     bool advanced_diagnostics; // Flag to enable detailed hardware decoder diagnostics
-    int active_keystone;     // 0 for first keystone, 1 for second
-    int gamepad_corner_cycle_index; // Track position in corner cycling (1-8 mode)
+    int active_keystone;     // Index of the stream whose keystone is being edited
+    int gamepad_corner_cycle_index; // Track position in corner cycling (4 corners per stream)
+
+    // --scanout overlay: video 1 DRM_PRIME frames go straight to the KMS overlay plane
+    bool scanout_overlay;
+    bool scanout_active;             // Video currently on the plane (GL skips drawing it)
+    video_dma_frame_t scanout_frames[SCANOUT_HOLD_FRAMES];
+    int scanout_frame_head;
+
+    // PICKLE_ISP_SCALE=1: oversized video 1 frames are downscaled by the ISP before GL samples them
+    isp_scaler_t *isp;
+
+    // Frames each decode thread runs ahead (the ring capacity every async decoder gets)
+    int decode_queue_depth;
+
+    // --live: network sources tuned for latency instead of smoothness
+    bool live;
+    double live_latency;             // Receive-to-glass target in seconds (stale frames are dropped)
+
+    // --sync-leader / --sync-follow: presentation timeline shared with other nodes
+    net_sync_t *sync;
+
+    // Thermal/throttle governor (PICKLE_GOVERNOR); NULL when disabled
+    governor_t *governor;
 
     // Notification message overlay
     char notification_message[256];  // Message to display
@@ -54,15 +185,21 @@ typedef struct {
 } app_context_t;
 
 // Main application functions
-int app_init(app_context_t *app, const char *video_file, const char *video_file2, bool loop_playback, bool show_timing, bool debug_gamepad, bool advanced_diagnostics, bool enable_hardware_decode);
+int app_init(app_context_t *app, const char *const *video_files, int video_count, bool loop_playback, bool show_timing, bool debug_gamepad, bool advanced_diagnostics, bool enable_hardware_decode, bool scanout_overlay, int live_latency_ms, playlist_t *playlist);
+// Join a multi-node sync group (after app_init, before app_run)
+int app_enable_sync(app_context_t *app, net_sync_role_t role, const char *leader_host);
 void app_run(app_context_t *app);
 void app_cleanup(app_context_t *app);
 
 // Async decode functions
-async_decode_t* async_decode_create(video_context_t *video);
+async_decode_t* async_decode_create(video_context_t *video, video_context_t *standby, bool playlist, int queue_depth,
+                                    int stream_index);
 void async_decode_destroy(async_decode_t *decoder);
-void async_decode_request_frame(async_decode_t *decoder);
-bool async_decode_frame_ready(async_decode_t *decoder);
-bool async_decode_wait_frame(async_decode_t *decoder, int timeout_ms);
+int async_decode_queued(async_decode_t *decoder);
+double async_decode_peek_pts(async_decode_t *decoder);  // Head frame PTS (-1 if empty/unknown)
+double async_decode_peek_arrival(async_decode_t *decoder);  // Head frame receive time (-1 if not live)
+bool async_decode_pop_frame(async_decode_t *decoder, video_frame_ref_t *out, bool *discontinuity, int timeout_ms);
+bool async_decode_finished(async_decode_t *decoder);    // EOF reached and queue drained
+video_context_t *async_decode_take_item_switch(async_decode_t *decoder);  // Playlist item now on screen
 
 #endif // VIDEO_PLAYER_H
\ No newline at end of file